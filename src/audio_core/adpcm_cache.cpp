@@ -0,0 +1,83 @@
+// Copyright 2018 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "audio_core/adpcm_cache.h"
+#include "common/hash.h"
+#include "common/microprofile.h"
+#include "core/memory.h"
+
+namespace AudioCore::Codec {
+
+std::size_t ADPCMCache::KeyHash::operator()(const Key& key) const {
+    const u64 state = (static_cast<u64>(static_cast<u16>(key.state.yn1)) << 16) |
+                      static_cast<u16>(key.state.yn2);
+    return static_cast<std::size_t>(key.addr ^ (key.size << 32) ^ key.coeff_hash ^
+                                    (state * 0x9E3779B97F4A7C15ULL));
+}
+
+ADPCMCache::ADPCMCache(std::size_t memory_budget) : memory_budget(memory_budget) {}
+
+ADPCMCache::~ADPCMCache() = default;
+
+MICROPROFILE_DEFINE(Audio_DecodeADPCM, "Audio", "Decode ADPCM", MP_RGB(100, 200, 100));
+std::shared_ptr<const std::vector<s16>> ADPCMCache::Decode(VAddr addr, std::size_t size,
+                                                           const ADPCM_Coeff& coeff,
+                                                           ADPCMState& state) {
+    // Hashing and decoding run outside of the lock, as the voices of a block can be processed by
+    // several threads at once
+    std::vector<u8> read_buffer;
+    const u8* data = Memory::GetContiguousPointer(addr, size);
+    if (data == nullptr) {
+        read_buffer.resize(size);
+        Memory::ReadBlock(addr, read_buffer.data(), size);
+        data = read_buffer.data();
+    }
+
+    const u64 data_hash = Common::ComputeHash64(data, size);
+    const Key key{addr, size, Common::ComputeHash64(coeff.data(), sizeof(coeff)), state};
+
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        auto iter = entries.find(key);
+        if (iter != entries.end()) {
+            if (iter->second.data_hash == data_hash) {
+                ++hits;
+                lru.splice(lru.begin(), lru, iter->second.lru_position);
+                state = iter->second.final_state;
+                return iter->second.samples;
+            }
+
+            // The guest wrote new data to the buffer
+            Erase(iter);
+        }
+        ++misses;
+    }
+
+    MICROPROFILE_SCOPE(Audio_DecodeADPCM);
+    auto samples = std::make_shared<const std::vector<s16>>(DecodeADPCM(data, size, coeff, state));
+
+    std::lock_guard<std::mutex> lock{mutex};
+    // Another thread may have decoded the same data in the meantime
+    if (entries.find(key) == entries.end()) {
+        lru.push_front(key);
+        entries.emplace(key, Entry{data_hash, samples, state, lru.begin()});
+        memory_used += samples->size() * sizeof(s16);
+        EvictToBudget();
+    }
+    return samples;
+}
+
+void ADPCMCache::Erase(std::unordered_map<Key, Entry, KeyHash>::iterator iter) {
+    memory_used -= iter->second.samples->size() * sizeof(s16);
+    lru.erase(iter->second.lru_position);
+    entries.erase(iter);
+}
+
+void ADPCMCache::EvictToBudget() {
+    while (memory_used > memory_budget && !lru.empty()) {
+        Erase(entries.find(lru.back()));
+    }
+}
+
+} // namespace AudioCore::Codec
@@ -0,0 +1,99 @@
+// Copyright 2018 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "audio_core/codec.h"
+#include "common/common_types.h"
+
+namespace AudioCore::Codec {
+
+/**
+ * Cache of decoded ADPCM wave buffers, so that looping tracks and sound banks are decoded once
+ * instead of every time they are played.
+ *
+ * Entries are keyed by the guest address and size of the encoded data, the coefficients and the
+ * decoder state the data is decoded from. The audio core can't observe guest writes, so an entry
+ * is only reused while the hash of the encoded data still matches, which is much cheaper than
+ * decoding it again. The least recently used entries are evicted beyond the memory budget.
+ */
+class ADPCMCache {
+public:
+    static constexpr std::size_t DEFAULT_MEMORY_BUDGET = 0x4000000;
+
+    explicit ADPCMCache(std::size_t memory_budget = DEFAULT_MEMORY_BUDGET);
+    ~ADPCMCache();
+
+    /**
+     * Returns the ADPCM data at the given guest address decoded, from the cache when possible.
+     * Thread-safe.
+     * @param addr Guest address of the encoded data
+     * @param size Size of the encoded data in bytes
+     * @param coeff ADPCM coefficients
+     * @param state ADPCM state, this is updated with new state
+     * @return Decoded signed PCM16 data, see Codec::DecodeADPCM
+     */
+    std::shared_ptr<const std::vector<s16>> Decode(VAddr addr, std::size_t size,
+                                                   const ADPCM_Coeff& coeff, ADPCMState& state);
+
+    /// Returns the number of decodes served from the cache and the number of actual decodes
+    u64 GetHits() const {
+        return hits;
+    }
+    u64 GetMisses() const {
+        return misses;
+    }
+
+private:
+    struct Key {
+        VAddr addr;
+        u64 size;
+        u64 coeff_hash;
+        ADPCMState state;
+
+        bool operator==(const Key& other) const {
+            return addr == other.addr && size == other.size && coeff_hash == other.coeff_hash &&
+                   state.yn1 == other.state.yn1 && state.yn2 == other.state.yn2;
+        }
+    };
+
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const;
+    };
+
+    struct Entry {
+        /// Hash of the encoded data the samples were decoded from
+        u64 data_hash;
+        std::shared_ptr<const std::vector<s16>> samples;
+        /// Decoder state after the samples
+        ADPCMState final_state;
+        std::list<Key>::iterator lru_position;
+    };
+
+    /// Removes the given entry from the cache
+    void Erase(std::unordered_map<Key, Entry, KeyHash>::iterator iter);
+
+    /// Evicts the least recently used entries until the cache fits in its budget
+    void EvictToBudget();
+
+    std::size_t memory_budget;
+    std::size_t memory_used = 0;
+
+    std::unordered_map<Key, Entry, KeyHash> entries;
+    /// Keys of the entries from the most to the least recently used
+    std::list<Key> lru;
+
+    /// Guards the entries, so that Decode can be called from several threads at once
+    std::mutex mutex;
+
+    u64 hits = 0;
+    u64 misses = 0;
+};
+
+} // namespace AudioCore::Codec
@@ -51,6 +51,29 @@ void Filter::Process(std::vector<s16>& signal) {
     }
 }
 
+void Filter::Process(float* signal, std::size_t frame_count) {
+    // The history is kept in locals for the whole block
+    for (std::size_t ch = 0; ch < channel_count; ch++) {
+        double in1 = in[0][ch];
+        double in2 = in[1][ch];
+        double out1 = out[0][ch];
+        double out2 = out[1][ch];
+        for (std::size_t i = 0; i < frame_count; i++) {
+            const double input = signal[i * channel_count + ch];
+            const double output = b0 * input + b1 * in1 + b2 * in2 - a1 * out1 - a2 * out2;
+            in2 = in1;
+            in1 = input;
+            out2 = out1;
+            out1 = output;
+            signal[i * channel_count + ch] = static_cast<float>(output);
+        }
+        in[0][ch] = in1;
+        in[1][ch] = in2;
+        out[0][ch] = out1;
+        out[1][ch] = out2;
+    }
+}
+
 /// Calculates the appropriate Q for each biquad in a cascading filter.
 /// @param total_count The total number of biquads to be cascaded.
 /// @param index 0-index of the biquad to calculate the Q value for.
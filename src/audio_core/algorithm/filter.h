@@ -29,15 +29,18 @@ public:
 
     void Process(std::vector<s16>& signal);
 
+    /// Filters a block of interleaved stereo frames in place, without saturating them.
+    void Process(float* signal, std::size_t frame_count);
+
 private:
     static constexpr std::size_t channel_count = 2;
 
     /// Coefficients are in normalized form (a0 = 1.0).
     double a1, a2, b0, b1, b2;
     /// Input History
-    std::array<std::array<double, channel_count>, 3> in;
+    std::array<std::array<double, channel_count>, 3> in{};
     /// Output History
-    std::array<std::array<double, channel_count>, 3> out;
+    std::array<std::array<double, channel_count>, 3> out{};
 };
 
 /// Cascade filters to build up higher-order filters from lower-order ones.
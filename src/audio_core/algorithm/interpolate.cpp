@@ -6,66 +6,104 @@
 
 #include <algorithm>
 #include <cmath>
-#include <vector>
 #include "audio_core/algorithm/interpolate.h"
-#include "common/common_types.h"
 #include "common/logging/log.h"
 
 namespace AudioCore {
 
-/// The Lanczos kernel
-static double Lanczos(std::size_t a, double x) {
+/// Normalized sinc function
+static double Sinc(double x) {
     if (x == 0.0)
         return 1.0;
     const double px = M_PI * x;
-    return a * std::sin(px) * std::sin(px / a) / (px * px);
+    return std::sin(px) / px;
 }
 
-std::vector<s16> Interpolate(InterpolationState& state, std::vector<s16> input, double ratio) {
-    if (input.size() < 2)
-        return {};
+PolyphaseResampler::PolyphaseResampler() {
+    Reset();
+}
 
-    if (ratio <= 0) {
-        LOG_CRITICAL(Audio, "Nonsensical interpolation ratio {}", ratio);
-        ratio = 1.0;
+std::size_t PolyphaseResampler::GetRequiredInputFrames(std::size_t output_frames,
+                                                       double ratio) const {
+    if (output_frames == 0) {
+        return 0;
     }
+    // The last output frame reads NUM_TAPS frames starting at the frame before its position
+    const auto last_frame = static_cast<std::size_t>(position + (output_frames - 1) * ratio);
+    const std::size_t needed_frames = last_frame + NUM_TAPS;
+    const std::size_t buffered_frames = history.size() / NUM_CHANNELS;
+    return needed_frames > buffered_frames ? needed_frames - buffered_frames : 0;
+}
 
-    if (ratio != state.current_ratio) {
-        const double cutoff_frequency = std::min(0.5 / ratio, 0.5 * ratio);
-        state.nyquist = CascadingFilter::LowPass(std::clamp(cutoff_frequency, 0.0, 0.4), 3);
-        state.current_ratio = ratio;
+void PolyphaseResampler::Process(const float* input, float* output, std::size_t output_frames,
+                                 double ratio) {
+    if (ratio <= 0.0) {
+        LOG_CRITICAL(Audio, "Nonsensical resampling ratio {}", ratio);
+        ratio = 1.0;
+    }
+    if (ratio != current_ratio) {
+        BuildFilter(ratio);
     }
-    state.nyquist.Process(input);
-
-    constexpr std::size_t taps = InterpolationState::lanczos_taps;
-    const std::size_t num_frames = input.size() / 2;
-
-    std::vector<s16> output;
-    output.reserve(static_cast<std::size_t>(input.size() / ratio + 4));
-
-    double& pos = state.position;
-    auto& h = state.history;
-    for (std::size_t i = 0; i < num_frames; ++i) {
-        std::rotate(h.begin(), h.end() - 1, h.end());
-        h[0][0] = input[i * 2 + 0];
-        h[0][1] = input[i * 2 + 1];
-
-        while (pos <= 1.0) {
-            double l = 0.0;
-            double r = 0.0;
-            for (std::size_t j = 0; j < h.size(); j++) {
-                l += Lanczos(taps, pos + j - taps + 1) * h[j][0];
-                r += Lanczos(taps, pos + j - taps + 1) * h[j][1];
-            }
-            output.emplace_back(static_cast<s16>(std::clamp(l, -32768.0, 32767.0)));
-            output.emplace_back(static_cast<s16>(std::clamp(r, -32768.0, 32767.0)));
-
-            pos += ratio;
+
+    const std::size_t input_frames = GetRequiredInputFrames(output_frames, ratio);
+    history.insert(history.end(), input, input + input_frames * NUM_CHANNELS);
+
+    for (std::size_t frame = 0; frame < output_frames; ++frame) {
+        const double frame_position = position + frame * ratio;
+        const auto base = static_cast<std::size_t>(frame_position);
+        const auto phase = static_cast<std::size_t>((frame_position - base) * NUM_PHASES);
+        const float* const taps = coefficients.data() + phase * NUM_TAPS;
+        const float* const samples = history.data() + base * NUM_CHANNELS;
+
+        float left = 0.0f;
+        float right = 0.0f;
+        for (std::size_t tap = 0; tap < NUM_TAPS; ++tap) {
+            left += taps[tap] * samples[tap * NUM_CHANNELS];
+            right += taps[tap] * samples[tap * NUM_CHANNELS + 1];
         }
-        pos -= 1.0;
+        output[frame * NUM_CHANNELS] = left;
+        output[frame * NUM_CHANNELS + 1] = right;
     }
 
-    return output;
+    // Drop the frames no later output frame reads from
+    position += output_frames * ratio;
+    const std::size_t consumed_frames =
+        std::min(static_cast<std::size_t>(position), history.size() / NUM_CHANNELS);
+    history.erase(history.begin(), history.begin() + consumed_frames * NUM_CHANNELS);
+    position -= consumed_frames;
+}
+
+void PolyphaseResampler::Reset() {
+    // The history starts with silence, so the first frames have a full window to read from
+    history.assign((NUM_TAPS - 1) * NUM_CHANNELS, 0.0f);
+    position = 0.0;
+}
+
+void PolyphaseResampler::BuildFilter(double ratio) {
+    // Lanczos windowed sinc, with its cutoff lowered below the output Nyquist rate when
+    // downsampling. Each output frame lies between the middle taps of its window.
+    constexpr double half_width = NUM_TAPS / 2;
+    const double cutoff = std::min(1.0, 1.0 / ratio);
+
+    coefficients.resize(NUM_PHASES * NUM_TAPS);
+    for (std::size_t phase = 0; phase < NUM_PHASES; ++phase) {
+        const double fraction = static_cast<double>(phase) / NUM_PHASES;
+        float* const taps = coefficients.data() + phase * NUM_TAPS;
+
+        double sum = 0.0;
+        for (std::size_t tap = 0; tap < NUM_TAPS; ++tap) {
+            const double x = static_cast<double>(tap) - (half_width - 1) - fraction;
+            const double value = cutoff * Sinc(cutoff * x) * Sinc(x / half_width);
+            taps[tap] = static_cast<float>(value);
+            sum += value;
+        }
+
+        // Normalize each phase so that a constant signal keeps its level
+        for (std::size_t tap = 0; tap < NUM_TAPS; ++tap) {
+            taps[tap] = static_cast<float>(taps[tap] / sum);
+        }
+    }
+    current_ratio = ratio;
 }
 
 } // namespace AudioCore
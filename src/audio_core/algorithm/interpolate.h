@@ -4,40 +4,47 @@
 
 #pragma once
 
-#include <array>
+#include <cstddef>
 #include <vector>
-#include "audio_core/algorithm/filter.h"
 #include "common/common_types.h"
 
 namespace AudioCore {
 
-struct InterpolationState {
-    static constexpr std::size_t lanczos_taps = 4;
-    static constexpr std::size_t history_size = lanczos_taps * 2 - 1;
+/// Resamples an interleaved stereo signal with a polyphase windowed-sinc filter, producing a
+/// block of output at a time. The filter is rebuilt whenever the resampling ratio changes.
+class PolyphaseResampler {
+public:
+    static constexpr std::size_t NUM_TAPS = 8;
+    static constexpr std::size_t NUM_PHASES = 128;
+    static constexpr std::size_t NUM_CHANNELS = 2;
 
+    PolyphaseResampler();
+
+    /// Returns how many input frames Process needs to produce the given number of output frames.
+    /// @param ratio Input sample rate divided by the output sample rate.
+    std::size_t GetRequiredInputFrames(std::size_t output_frames, double ratio) const;
+
+    /// Resamples input into output.
+    /// @param input Input frames, as many as GetRequiredInputFrames returned for these arguments.
+    /// @param output Buffer for output_frames frames of output.
+    /// @param ratio Input sample rate divided by the output sample rate.
+    void Process(const float* input, float* output, std::size_t output_frames, double ratio);
+
+    /// Clears the history of the signal, for when a new one starts.
+    void Reset();
+
+private:
+    /// Builds the filter of each phase, low-passed for the given ratio when downsampling
+    void BuildFilter(double ratio);
+
+    /// NUM_TAPS coefficients for each of the NUM_PHASES fractional positions
+    std::vector<float> coefficients;
     double current_ratio = 0.0;
-    CascadingFilter nyquist;
-    std::array<std::array<s16, 2>, history_size> history = {};
-    double position = 0;
-};
 
-/// Interpolates input signal to produce output signal.
-/// @param input The signal to interpolate.
-/// @param ratio Interpolation ratio.
-///              ratio > 1.0 results in fewer output samples.
-///              ratio < 1.0 results in more output samples.
-/// @returns Output signal.
-std::vector<s16> Interpolate(InterpolationState& state, std::vector<s16> input, double ratio);
-
-/// Interpolates input signal to produce output signal.
-/// @param input The signal to interpolate.
-/// @param input_rate The sample rate of input.
-/// @param output_rate The desired sample rate of the output.
-/// @returns Output signal.
-inline std::vector<s16> Interpolate(InterpolationState& state, std::vector<s16> input,
-                                    u32 input_rate, u32 output_rate) {
-    const double ratio = static_cast<double>(input_rate) / static_cast<double>(output_rate);
-    return Interpolate(state, std::move(input), ratio);
-}
+    /// Input frames that are still needed, interleaved
+    std::vector<float> history;
+    /// Position of the next output frame, in input frames from the start of the history
+    double position = 0.0;
+};
 
 } // namespace AudioCore
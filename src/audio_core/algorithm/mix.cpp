@@ -0,0 +1,109 @@
+// Copyright 2018 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cmath>
+#include "audio_core/algorithm/mix.h"
+#include "common/cpu_dispatch.h"
+
+#ifdef ARCHITECTURE_x86_64
+#include <immintrin.h>
+#endif
+
+namespace AudioCore {
+
+namespace {
+
+void MixSamplesScalar(float* accumulator, const float* samples, std::size_t count, float volume) {
+    for (std::size_t index = 0; index < count; ++index) {
+        accumulator[index] += samples[index] * volume;
+    }
+}
+
+#ifdef ARCHITECTURE_x86_64
+void MixSamplesSSE2(float* accumulator, const float* samples, std::size_t count, float volume) {
+    // Eight samples are mixed at a time
+    std::size_t index = 0;
+    const __m128 volume_vector = _mm_set1_ps(volume);
+    for (; index + 8 <= count; index += 8) {
+        const __m128 low = _mm_mul_ps(_mm_loadu_ps(samples + index), volume_vector);
+        const __m128 high = _mm_mul_ps(_mm_loadu_ps(samples + index + 4), volume_vector);
+        _mm_storeu_ps(accumulator + index, _mm_add_ps(_mm_loadu_ps(accumulator + index), low));
+        _mm_storeu_ps(accumulator + index + 4,
+                      _mm_add_ps(_mm_loadu_ps(accumulator + index + 4), high));
+    }
+    MixSamplesScalar(accumulator + index, samples + index, count - index, volume);
+}
+
+SIMD_TARGET("avx2")
+void MixSamplesAVX2(float* accumulator, const float* samples, std::size_t count, float volume) {
+    // Sixteen samples are mixed at a time
+    std::size_t index = 0;
+    const __m256 volume_vector = _mm256_set1_ps(volume);
+    for (; index + 16 <= count; index += 16) {
+        const __m256 low = _mm256_mul_ps(_mm256_loadu_ps(samples + index), volume_vector);
+        const __m256 high = _mm256_mul_ps(_mm256_loadu_ps(samples + index + 8), volume_vector);
+        _mm256_storeu_ps(accumulator + index,
+                         _mm256_add_ps(_mm256_loadu_ps(accumulator + index), low));
+        _mm256_storeu_ps(accumulator + index + 8,
+                         _mm256_add_ps(_mm256_loadu_ps(accumulator + index + 8), high));
+    }
+    MixSamplesSSE2(accumulator + index, samples + index, count - index, volume);
+}
+#endif
+
+Common::DispatchedFunction<void(float*, const float*, std::size_t, float)> mix_samples{
+    "MixSamples",
+    {
+        {Common::SIMDLevel::Scalar, MixSamplesScalar},
+#ifdef ARCHITECTURE_x86_64
+        {Common::SIMDLevel::SSE2, MixSamplesSSE2},
+        {Common::SIMDLevel::AVX2, MixSamplesAVX2},
+#endif
+    }};
+
+} // Anonymous namespace
+
+void MixSamples(float* accumulator, const float* samples, std::size_t count, float volume) {
+    mix_samples(accumulator, samples, count, volume);
+}
+
+void DeinterleaveSamples(float* left, float* right, const float* frames, std::size_t count) {
+    for (std::size_t index = 0; index < count; ++index) {
+        left[index] = frames[index * 2];
+        right[index] = frames[index * 2 + 1];
+    }
+}
+
+void SaturateSamples(s16* output, const float* left, const float* right, std::size_t count) {
+    std::size_t index = 0;
+
+#ifdef ARCHITECTURE_x86_64
+    // Out of range floats convert to INT_MIN, so they are clamped before the conversion
+    const __m128 min = _mm_set1_ps(-32768.0f);
+    const __m128 max = _mm_set1_ps(32767.0f);
+    const auto Convert = [&min, &max](const float* samples) {
+        const __m128 low = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(samples), min), max);
+        const __m128 high = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(samples + 4), min), max);
+        return _mm_packs_epi32(_mm_cvtps_epi32(low), _mm_cvtps_epi32(high));
+    };
+    for (; index + 8 <= count; index += 8) {
+        const __m128i left_samples = Convert(left + index);
+        const __m128i right_samples = Convert(right + index);
+        __m128i* const frames = reinterpret_cast<__m128i*>(output + index * 2);
+        _mm_storeu_si128(frames, _mm_unpacklo_epi16(left_samples, right_samples));
+        _mm_storeu_si128(frames + 1, _mm_unpackhi_epi16(left_samples, right_samples));
+    }
+#endif
+
+    const auto Saturate = [](float sample) {
+        return static_cast<s16>(std::clamp(std::nearbyint(sample), -32768.0f, 32767.0f));
+    };
+    for (; index < count; ++index) {
+        output[index * 2] = Saturate(left[index]);
+        output[index * 2 + 1] = Saturate(right[index]);
+    }
+}
+
+} // namespace AudioCore
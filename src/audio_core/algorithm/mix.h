@@ -0,0 +1,33 @@
+// Copyright 2018 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include "common/common_types.h"
+
+namespace AudioCore {
+
+/// Adds samples scaled by a volume to an accumulation buffer.
+/// @param accumulator Buffer the scaled samples are added to, at least count samples long.
+/// @param samples The samples to mix.
+/// @param count Number of samples to mix.
+/// @param volume Volume the samples are scaled by.
+void MixSamples(float* accumulator, const float* samples, std::size_t count, float volume);
+
+/// Splits interleaved stereo frames into a buffer per channel.
+/// @param left Buffer the left channel is written to, at least count samples long.
+/// @param right Buffer the right channel is written to, at least count samples long.
+/// @param frames The interleaved frames.
+/// @param count Number of frames to split.
+void DeinterleaveSamples(float* left, float* right, const float* frames, std::size_t count);
+
+/// Rounds and saturates the two channels of a mix to interleaved s16 frames.
+/// @param output Buffer the frames are written to, at least count frames long.
+/// @param left The left channel of the mix.
+/// @param right The right channel of the mix.
+/// @param count Number of frames to write.
+void SaturateSamples(s16* output, const float* left, const float* right, std::size_t count);
+
+} // namespace AudioCore
@@ -0,0 +1,199 @@
+// Copyright 2018 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include "audio_core/algorithm/wsola.h"
+
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
+
+namespace AudioCore {
+
+/// Step of the coarse pass of the seek, the best coarse offset is then refined around it
+constexpr std::size_t SeekStep = 4;
+
+/// Returns the dot product of two buffers, along with the energy of the second one
+static float Correlate(const float* reference, const float* samples, std::size_t count,
+                       float& energy) {
+    std::size_t index = 0;
+    float dot = 0.0f;
+    energy = 0.0f;
+
+#ifdef ARCHITECTURE_x86_64
+    // SSE2 is always available on x86_64, four samples are correlated at a time
+    __m128 dot_vector = _mm_setzero_ps();
+    __m128 energy_vector = _mm_setzero_ps();
+    for (; index + 4 <= count; index += 4) {
+        const __m128 reference_samples = _mm_loadu_ps(reference + index);
+        const __m128 input_samples = _mm_loadu_ps(samples + index);
+        dot_vector = _mm_add_ps(dot_vector, _mm_mul_ps(reference_samples, input_samples));
+        energy_vector = _mm_add_ps(energy_vector, _mm_mul_ps(input_samples, input_samples));
+    }
+    alignas(16) float dot_lanes[4];
+    alignas(16) float energy_lanes[4];
+    _mm_store_ps(dot_lanes, dot_vector);
+    _mm_store_ps(energy_lanes, energy_vector);
+    dot = dot_lanes[0] + dot_lanes[1] + dot_lanes[2] + dot_lanes[3];
+    energy = energy_lanes[0] + energy_lanes[1] + energy_lanes[2] + energy_lanes[3];
+#endif
+
+    for (; index < count; ++index) {
+        dot += reference[index] * samples[index];
+        energy += samples[index] * samples[index];
+    }
+    return dot;
+}
+
+static s16 ToSample(float sample) {
+    return static_cast<s16>(std::clamp(std::nearbyint(sample), -32768.0f, 32767.0f));
+}
+
+WSOLA::WSOLA(u32 sample_rate, u32 channel_count, u32 sequence_ms, u32 seek_window_ms,
+             u32 overlap_ms)
+    : channel_count{channel_count}, sequence_frames{sample_rate * sequence_ms / 1000},
+      seek_frames{std::max<std::size_t>(sample_rate * seek_window_ms / 1000, 1)},
+      overlap_frames{std::max<std::size_t>(sample_rate * overlap_ms / 1000, 1)} {
+    // Each sequence is cross-faded with both of its neighbours
+    sequence_frames = std::max(sequence_frames, overlap_frames * 2 + 1);
+}
+
+void WSOLA::SetTempo(double new_tempo) {
+    tempo = new_tempo;
+}
+
+void WSOLA::PutSamples(const s16* in, std::size_t num_frames) {
+    input.insert(input.end(), in, in + num_frames * channel_count);
+    ProcessSequences();
+}
+
+std::size_t WSOLA::ReceiveSamples(s16* out, std::size_t max_frames) {
+    const std::size_t num_frames = std::min(max_frames, GetOutputFrames());
+    const auto begin = output.begin() + output_begin * channel_count;
+    std::copy(begin, begin + num_frames * channel_count, out);
+    output_begin += num_frames;
+
+    // Consumed frames are only erased once they make up most of the buffer, so that erasing
+    // doesn't move the same frames over and over
+    if (output_begin * 2 >= GetOutputFrames() + output_begin) {
+        output.erase(output.begin(), output.begin() + output_begin * channel_count);
+        output_begin = 0;
+    }
+    return num_frames;
+}
+
+std::size_t WSOLA::GetOutputFrames() const {
+    return output.size() / channel_count - output_begin;
+}
+
+void WSOLA::Clear() {
+    input.clear();
+    input_begin = 0;
+    has_overlap = false;
+    overlap_end = 0;
+    skip_remainder = 0.0;
+    output.clear();
+    output_begin = 0;
+}
+
+void WSOLA::Flush() {
+    if (has_overlap) {
+        std::transform(overlap.begin(), overlap.end(), std::back_inserter(output), ToSample);
+    }
+    const std::size_t input_frames = input.size() / channel_count - input_begin;
+    const std::size_t remaining_begin = input_begin + std::min(overlap_end, input_frames);
+    std::transform(input.begin() + remaining_begin * channel_count, input.end(),
+                   std::back_inserter(output), ToSample);
+
+    input.clear();
+    input_begin = 0;
+    has_overlap = false;
+    overlap_end = 0;
+    skip_remainder = 0.0;
+}
+
+void WSOLA::ProcessSequences() {
+    const double nominal_skip = tempo * static_cast<double>(sequence_frames - overlap_frames);
+    const std::size_t required_frames =
+        std::max(static_cast<std::size_t>(nominal_skip) + 1, sequence_frames + seek_frames);
+
+    while (input.size() / channel_count - input_begin >= required_frames) {
+        const float* const in = input.data() + input_begin * channel_count;
+        std::size_t offset = 0;
+        if (has_overlap) {
+            offset = SeekBestOffset();
+        } else {
+            // The first sequence is cross-faded with itself
+            overlap.assign(in, in + overlap_frames * channel_count);
+            has_overlap = true;
+        }
+
+        const float* const sequence = in + offset * channel_count;
+        for (std::size_t frame = 0; frame < overlap_frames; ++frame) {
+            const float fade_in = static_cast<float>(frame) / overlap_frames;
+            for (std::size_t channel = 0; channel < channel_count; ++channel) {
+                const std::size_t index = frame * channel_count + channel;
+                output.push_back(
+                    ToSample(overlap[index] + (sequence[index] - overlap[index]) * fade_in));
+            }
+        }
+        const std::size_t overlap_start = sequence_frames - overlap_frames;
+        std::transform(sequence + overlap_frames * channel_count,
+                       sequence + overlap_start * channel_count, std::back_inserter(output),
+                       ToSample);
+        overlap.assign(sequence + overlap_start * channel_count,
+                       sequence + sequence_frames * channel_count);
+
+        skip_remainder += nominal_skip;
+        const auto skip = static_cast<std::size_t>(skip_remainder);
+        skip_remainder -= static_cast<double>(skip);
+        overlap_end = offset + sequence_frames > skip ? offset + sequence_frames - skip : 0;
+        SkipInput(skip);
+    }
+}
+
+std::size_t WSOLA::SeekBestOffset() const {
+    const float* const in = input.data() + input_begin * channel_count;
+    const std::size_t count = overlap_frames * channel_count;
+    const auto Score = [this, in, count](std::size_t offset) {
+        float energy;
+        const float dot = Correlate(overlap.data(), in + offset * channel_count, count, energy);
+        return dot / std::sqrt(std::max(energy, 1.0f));
+    };
+
+    std::size_t best_offset = 0;
+    float best_score = Score(0);
+    const auto Try = [&](std::size_t offset) {
+        const float score = Score(offset);
+        if (score > best_score) {
+            best_score = score;
+            best_offset = offset;
+        }
+    };
+
+    for (std::size_t offset = SeekStep; offset < seek_frames; offset += SeekStep) {
+        Try(offset);
+    }
+    const std::size_t coarse_offset = best_offset;
+    const std::size_t refine_begin = coarse_offset > SeekStep ? coarse_offset - SeekStep + 1 : 0;
+    const std::size_t refine_end = std::min(coarse_offset + SeekStep, seek_frames);
+    for (std::size_t offset = refine_begin; offset < refine_end; ++offset) {
+        if (offset != coarse_offset) {
+            Try(offset);
+        }
+    }
+    return best_offset;
+}
+
+void WSOLA::SkipInput(std::size_t num_frames) {
+    input_begin += num_frames;
+    if (input_begin * 2 >= input.size() / channel_count) {
+        input.erase(input.begin(), input.begin() + input_begin * channel_count);
+        input_begin = 0;
+    }
+}
+
+} // namespace AudioCore
@@ -0,0 +1,82 @@
+// Copyright 2018 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "common/common_types.h"
+
+namespace AudioCore {
+
+/**
+ * Changes the tempo of interleaved audio without changing its pitch, with WSOLA (waveform
+ * similarity overlap-add). The input is cut in overlapping sequences, each one placed where it
+ * best matches the end of the previous one within a seek window, then cross-faded with it.
+ *
+ * This is the algorithm SoundTouch uses for tempo changes, trimmed down to what TimeStretcher
+ * needs, which makes it cheaper on slow CPUs.
+ */
+class WSOLA {
+public:
+    /// @param sample_rate     Sample rate of the audio
+    /// @param channel_count   Number of interleaved channels
+    /// @param sequence_ms     Length of each sequence
+    /// @param seek_window_ms  Length of the range searched for the best overlap position
+    /// @param overlap_ms      Length of the cross-fade between sequences
+    WSOLA(u32 sample_rate, u32 channel_count, u32 sequence_ms, u32 seek_window_ms,
+          u32 overlap_ms);
+
+    /// Sets the ratio of the input length to the output length
+    void SetTempo(double new_tempo);
+
+    /// Adds frames to be stretched
+    void PutSamples(const s16* in, std::size_t num_frames);
+
+    /// Takes stretched frames, returns the number of frames written to `out`
+    std::size_t ReceiveSamples(s16* out, std::size_t max_frames);
+
+    /// Returns the number of stretched frames ready to be received
+    std::size_t GetOutputFrames() const;
+
+    /// Drops all the frames, stretched or not
+    void Clear();
+
+    /// Moves the frames that weren't stretched yet to the output as they are
+    void Flush();
+
+private:
+    /// Stretches as many sequences as the input allows
+    void ProcessSequences();
+
+    /// Returns the offset in the input where the start of a sequence best matches the overlap
+    std::size_t SeekBestOffset() const;
+
+    /// Drops frames from the start of the input
+    void SkipInput(std::size_t num_frames);
+
+    u32 channel_count;
+    std::size_t sequence_frames;
+    std::size_t seek_frames;
+    std::size_t overlap_frames;
+
+    double tempo = 1.0;
+    /// Fraction of a frame left over by the previous skips
+    double skip_remainder = 0.0;
+
+    /// Interleaved frames that weren't stretched yet, starting at input_begin
+    std::vector<float> input;
+    std::size_t input_begin = 0;
+    /// End of the previous sequence, to be cross-faded with the start of the next one
+    std::vector<float> overlap;
+    bool has_overlap = false;
+    /// Offset in the input of the frame following the overlap
+    std::size_t overlap_end = 0;
+
+    /// Interleaved stretched frames, starting at output_begin
+    std::vector<s16> output;
+    std::size_t output_begin = 0;
+};
+
+} // namespace AudioCore
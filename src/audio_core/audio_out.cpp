@@ -39,9 +39,9 @@ StreamPtr AudioOut::OpenStream(u32 sample_rate, u32 num_channels, std::string&&
         sink->AcquireSinkStream(sample_rate, num_channels, name), std::move(name));
 }
 
-std::vector<Buffer::Tag> AudioOut::GetTagsAndReleaseBuffers(StreamPtr stream,
-                                                            std::size_t max_count) {
-    return stream->GetTagsAndReleaseBuffers(max_count);
+std::size_t AudioOut::GetTagsAndReleaseBuffers(StreamPtr stream, Buffer::Tag* tags,
+                                               std::size_t max_count) {
+    return stream->GetTagsAndReleaseBuffers(tags, max_count);
 }
 
 void AudioOut::StartStream(StreamPtr stream) {
@@ -52,8 +52,12 @@ void AudioOut::StopStream(StreamPtr stream) {
     stream->Stop();
 }
 
-bool AudioOut::QueueBuffer(StreamPtr stream, Buffer::Tag tag, std::vector<s16>&& data) {
-    return stream->QueueBuffer(std::make_shared<Buffer>(tag, std::move(data)));
+Buffer* AudioOut::AcquireBuffer(StreamPtr stream, Buffer::Tag tag) {
+    return stream->AcquireBuffer(tag);
+}
+
+void AudioOut::QueueBuffer(StreamPtr stream, Buffer* buffer) {
+    stream->QueueBuffer(buffer);
 }
 
 } // namespace AudioCore
@@ -24,8 +24,9 @@ public:
     StreamPtr OpenStream(u32 sample_rate, u32 num_channels, std::string&& name,
                          Stream::ReleaseCallback&& release_callback);
 
-    /// Returns a vector of recently released buffers specified by tag for the specified stream
-    std::vector<Buffer::Tag> GetTagsAndReleaseBuffers(StreamPtr stream, std::size_t max_count);
+    /// Writes the tags of recently released buffers of the specified stream, returns their count
+    std::size_t GetTagsAndReleaseBuffers(StreamPtr stream, Buffer::Tag* tags,
+                                         std::size_t max_count);
 
     /// Starts an audio stream for playback
     void StartStream(StreamPtr stream);
@@ -33,8 +34,11 @@ public:
     /// Stops an audio stream that is currently playing
     void StopStream(StreamPtr stream);
 
-    /// Queues a buffer into the specified audio stream, returns true on success
-    bool QueueBuffer(StreamPtr stream, Buffer::Tag tag, std::vector<s16>&& data);
+    /// Takes a free buffer of the specified stream to be filled, returns nullptr if there is none
+    Buffer* AcquireBuffer(StreamPtr stream, Buffer::Tag tag);
+
+    /// Queues a buffer taken with AcquireBuffer into the specified audio stream
+    void QueueBuffer(StreamPtr stream, Buffer* buffer);
 
 private:
     SinkPtr sink;
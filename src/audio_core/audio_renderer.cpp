@@ -2,19 +2,45 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iterator>
+#include "audio_core/algorithm/filter.h"
 #include "audio_core/algorithm/interpolate.h"
+#include "audio_core/algorithm/mix.h"
+#include "audio_core/adpcm_cache.h"
 #include "audio_core/audio_out.h"
 #include "audio_core/audio_renderer.h"
 #include "audio_core/codec.h"
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "common/thread_pool.h"
+#include "common/tracing.h"
+#include "core/core.h"
 #include "core/hle/kernel/event.h"
 #include "core/memory.h"
+#include "core/perf_stats.h"
 
 namespace AudioCore {
 
 constexpr u32 STREAM_SAMPLE_RATE{48000};
 constexpr u32 STREAM_NUM_CHANNELS{2};
+/// The mix graph runs on blocks of this many frames
+constexpr std::size_t BLOCK_SIZE{240};
+/// Number of blocks in each buffer queued to the stream
+constexpr std::size_t BLOCKS_PER_BUFFER{2};
+/// Voices are processed on the thread pool from this many playing voices, fewer aren't worth
+/// the cost of waking the workers
+constexpr std::size_t PARALLEL_VOICE_THRESHOLD{32};
+constexpr u32 PERFORMANCE_FRAME_MAGIC{Common::MakeMagic('P', 'E', 'R', 'F')};
+
+using Clock = Core::PerfStats::Clock;
+
+static u32 ToMicroseconds(Clock::duration duration) {
+    return static_cast<u32>(
+        std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+}
 
 class AudioRenderer::VoiceState {
 public:
@@ -34,26 +60,52 @@ public:
         return info;
     }
 
+    /// Returns the interleaved stereo frames of the last processed block
+    const float* GetBlock() const {
+        return block.data();
+    }
+
     void SetWaveIndex(std::size_t index);
-    std::vector<s16> DequeueSamples(std::size_t sample_count);
+
+    /// Resamples and filters the next block of the voice, returns false when it isn't playing
+    bool ProcessBlock(Codec::ADPCMCache& adpcm_cache);
     void UpdateState();
-    void RefreshBuffer();
+    void RefreshBuffer(Codec::ADPCMCache& adpcm_cache);
 
 private:
+    /// Reads frames from the wave buffers at the voice sample rate, silence once playback stops
+    void ReadFrames(float* output, std::size_t frame_count, Codec::ADPCMCache& adpcm_cache);
+
+    /// Rebuilds the biquad filters whose coefficients changed
+    void UpdateBiquads();
+
     bool is_in_use{};
     bool is_refresh_pending{};
     std::size_t wave_index{};
     std::size_t offset{};
     Codec::ADPCMState adpcm_state{};
-    InterpolationState interp_state{};
+    /// Decoded stereo frames of the current wave buffer, at the voice sample rate
     std::vector<s16> samples;
+    /// PCM16 samples read from the current wave buffer
+    std::vector<s16> pcm_samples;
     VoiceOutStatus out_status{};
     VoiceInfo info{};
+
+    PolyphaseResampler resampler;
+    std::array<BiquadFilter, 2> biquad_params{};
+    std::array<Filter, 2> biquads;
+    std::vector<float> input_frames;
+    std::array<float, BLOCK_SIZE * STREAM_NUM_CHANNELS> block{};
 };
 
 AudioRenderer::AudioRenderer(AudioRendererParameter params,
                              Kernel::SharedPtr<Kernel::Event> buffer_event)
-    : worker_params{params}, buffer_event{buffer_event}, voices(params.voice_count) {
+    : worker_params{params}, buffer_event{buffer_event}, voices(params.voice_count),
+      voice_results(params.voice_count),
+      mix_buffers(std::max<std::size_t>(params.mix_buffer_count, STREAM_NUM_CHANNELS) * BLOCK_SIZE),
+      voice_left(BLOCK_SIZE), voice_right(BLOCK_SIZE),
+      adpcm_cache(std::make_unique<Codec::ADPCMCache>()) {
+    UpdateMixes({});
 
     audio_out = std::make_unique<AudioCore::AudioOut>();
     stream = audio_out->OpenStream(STREAM_SAMPLE_RATE, STREAM_NUM_CHANNELS, "AudioRenderer",
@@ -79,7 +131,8 @@ u32 AudioRenderer::GetMixBufferCount() const {
     return worker_params.mix_buffer_count;
 }
 
-std::vector<u8> AudioRenderer::UpdateAudioRenderer(const std::vector<u8>& input_params) {
+std::vector<u8> AudioRenderer::UpdateAudioRenderer(const std::vector<u8>& input_params,
+                                                   std::vector<u8>& performance_output) {
     // Copy UpdateDataHeader struct
     UpdateDataHeader config{};
     std::memcpy(&config, input_params.data(), sizeof(UpdateDataHeader));
@@ -91,14 +144,38 @@ std::vector<u8> AudioRenderer::UpdateAudioRenderer(const std::vector<u8>& input_
                 input_params.data() + sizeof(UpdateDataHeader) + config.behavior_size,
                 memory_pool_count * sizeof(MemoryPoolInfo));
 
+    // Copy VoiceChannelResource structs
+    const std::size_t voice_resources_offset{sizeof(UpdateDataHeader) + config.behavior_size +
+                                             config.memory_pools_size};
+    voice_resources.resize(config.voice_resource_size / sizeof(VoiceChannelResource));
+    if (voice_resources_offset + voice_resources.size() * sizeof(VoiceChannelResource) <=
+        input_params.size()) {
+        std::memcpy(voice_resources.data(), input_params.data() + voice_resources_offset,
+                    voice_resources.size() * sizeof(VoiceChannelResource));
+    } else {
+        voice_resources.clear();
+    }
+
     // Copy VoiceInfo structs
-    std::size_t offset{sizeof(UpdateDataHeader) + config.behavior_size + config.memory_pools_size +
-                       config.voice_resource_size};
+    std::size_t offset{voice_resources_offset + config.voice_resource_size};
     for (auto& voice : voices) {
         std::memcpy(&voice.Info(), input_params.data() + offset, sizeof(VoiceInfo));
         offset += sizeof(VoiceInfo);
     }
 
+    // Copy MixInfo structs, effects aren't processed so they're skipped
+    const std::size_t mixes_offset{voice_resources_offset + config.voice_resource_size +
+                                   config.voices_size + config.effects_size};
+    std::vector<MixInfo> mix_infos(
+        std::min<std::size_t>(worker_params.submix_count + 1, config.mixes_size / sizeof(MixInfo)));
+    if (mixes_offset + mix_infos.size() * sizeof(MixInfo) <= input_params.size()) {
+        std::memcpy(mix_infos.data(), input_params.data() + mixes_offset,
+                    mix_infos.size() * sizeof(MixInfo));
+    } else {
+        mix_infos.clear();
+    }
+    UpdateMixes(mix_infos);
+
     // Update voices
     for (auto& voice : voices) {
         voice.UpdateState();
@@ -140,37 +217,101 @@ std::vector<u8> AudioRenderer::UpdateAudioRenderer(const std::vector<u8>& input_
         voice_out_status_offset += sizeof(VoiceOutStatus);
     }
 
+    // Copy the performance frames rendered since the last update, and their size
+    const PerformanceOutStatus performance_status{
+        static_cast<u32>(WritePerformanceFrames(performance_output))};
+    const std::size_t performance_status_offset{
+        sizeof(UpdateDataHeader) + response_data.memory_pools_size + response_data.voices_size +
+        response_data.effects_size + response_data.sinks_size};
+    std::memcpy(output_params.data() + performance_status_offset, &performance_status,
+                sizeof(PerformanceOutStatus));
+    performance_frames.clear();
+
     return output_params;
 }
 
+std::size_t AudioRenderer::WritePerformanceFrames(std::vector<u8>& output) const {
+    const auto frame_size = [](const PerformanceFrame& frame) {
+        return sizeof(PerformanceFrameHeader) + frame.entries.size() * sizeof(PerformanceEntry);
+    };
+
+    // The oldest frames are dropped when they don't all fit
+    std::size_t size{};
+    auto first{performance_frames.end()};
+    while (first != performance_frames.begin() &&
+           size + frame_size(*std::prev(first)) <= output.size()) {
+        --first;
+        size += frame_size(*first);
+    }
+
+    std::size_t offset{};
+    for (auto frame{first}; frame != performance_frames.end(); ++frame) {
+        PerformanceFrameHeader header{};
+        header.magic = PERFORMANCE_FRAME_MAGIC;
+        header.entry_count = static_cast<u32>(frame->entries.size());
+        header.next_offset = static_cast<u32>(frame_size(*frame));
+        header.total_processing_time = frame->total_processing_time;
+        std::memcpy(output.data() + offset, &header, sizeof(header));
+        std::memcpy(output.data() + offset + sizeof(header), frame->entries.data(),
+                    frame->entries.size() * sizeof(PerformanceEntry));
+        offset += frame_size(*frame);
+    }
+
+    output.resize(size);
+    return size;
+}
+
 void AudioRenderer::VoiceState::SetWaveIndex(std::size_t index) {
     wave_index = index & 3;
     is_refresh_pending = true;
 }
 
-std::vector<s16> AudioRenderer::VoiceState::DequeueSamples(std::size_t sample_count) {
+bool AudioRenderer::VoiceState::ProcessBlock(Codec::ADPCMCache& adpcm_cache) {
     if (!IsPlaying()) {
-        return {};
+        return false;
     }
 
-    if (is_refresh_pending) {
-        RefreshBuffer();
-    }
+    const u32 sample_rate{info.sample_rate != 0 ? static_cast<u32>(info.sample_rate)
+                                                 : STREAM_SAMPLE_RATE};
+    const float pitch{info.pitch > 0.0f ? static_cast<float>(info.pitch) : 1.0f};
+    const double ratio{sample_rate * pitch / STREAM_SAMPLE_RATE};
+
+    const std::size_t frame_count{resampler.GetRequiredInputFrames(BLOCK_SIZE, ratio)};
+    input_frames.resize(frame_count * STREAM_NUM_CHANNELS);
+    ReadFrames(input_frames.data(), frame_count, adpcm_cache);
+    resampler.Process(input_frames.data(), block.data(), BLOCK_SIZE, ratio);
 
-    const std::size_t max_size{samples.size() - offset};
-    const std::size_t dequeue_offset{offset};
-    std::size_t size{sample_count * STREAM_NUM_CHANNELS};
-    if (size > max_size) {
-        size = max_size;
+    UpdateBiquads();
+    for (std::size_t index = 0; index < biquads.size(); ++index) {
+        if (biquad_params[index].enable) {
+            biquads[index].Process(block.data(), BLOCK_SIZE);
+        }
     }
+    return true;
+}
+
+void AudioRenderer::VoiceState::ReadFrames(float* output, std::size_t frame_count,
+                                           Codec::ADPCMCache& adpcm_cache) {
+    std::size_t frame{};
+    while (frame < frame_count && IsPlaying()) {
+        if (is_refresh_pending) {
+            RefreshBuffer(adpcm_cache);
+        }
 
-    out_status.played_sample_count += size / STREAM_NUM_CHANNELS;
-    offset += size;
+        const std::size_t available{(samples.size() - offset) / STREAM_NUM_CHANNELS};
+        const std::size_t count{std::min(available, frame_count - frame)};
+        std::copy_n(samples.begin() + offset, count * STREAM_NUM_CHANNELS,
+                    output + frame * STREAM_NUM_CHANNELS);
+        offset += count * STREAM_NUM_CHANNELS;
+        frame += count;
+        out_status.played_sample_count += count;
 
-    const auto& wave_buffer{info.wave_buffer[wave_index]};
-    if (offset == samples.size()) {
+        if (offset < samples.size()) {
+            continue;
+        }
         offset = 0;
 
+        const auto& wave_buffer{info.wave_buffer[wave_index]};
         if (!wave_buffer.is_looping) {
             SetWaveIndex(wave_index + 1);
         }
@@ -180,9 +321,31 @@ std::vector<s16> AudioRenderer::VoiceState::DequeueSamples(std::size_t sample_co
         if (wave_buffer.end_of_stream) {
             info.play_state = PlayState::Paused;
         }
+
+        // An empty wave buffer ends the block, so that looping over it can't hang the mixer
+        if (count == 0) {
+            break;
+        }
     }
 
-    return {samples.begin() + dequeue_offset, samples.begin() + dequeue_offset + size};
+    std::fill(output + frame * STREAM_NUM_CHANNELS, output + frame_count * STREAM_NUM_CHANNELS,
+              0.0f);
+}
+
+void AudioRenderer::VoiceState::UpdateBiquads() {
+    for (std::size_t index = 0; index < biquads.size(); ++index) {
+        const BiquadFilter& params{info.biquad_filter[index]};
+        if (std::memcmp(&params, &biquad_params[index], sizeof(BiquadFilter)) == 0) {
+            continue;
+        }
+        biquad_params[index] = params;
+
+        // The coefficients are in Q14 fixed point, with an implicit a0 of 1
+        constexpr double scale{1.0 / (1 << 14)};
+        biquads[index] = Filter(1.0, params.denominator[0] * scale,
+                                params.denominator[1] * scale, params.numerator[0] * scale,
+                                params.numerator[1] * scale, params.numerator[2] * scale);
+    }
 }
 
 void AudioRenderer::VoiceState::UpdateState() {
@@ -192,26 +355,31 @@ void AudioRenderer::VoiceState::UpdateState() {
         wave_index = 0;
         offset = 0;
         out_status = {};
+        resampler.Reset();
     }
     is_in_use = info.is_in_use;
 }
 
-void AudioRenderer::VoiceState::RefreshBuffer() {
-    std::vector<s16> new_samples(info.wave_buffer[wave_index].buffer_sz / sizeof(s16));
-    Memory::ReadBlock(info.wave_buffer[wave_index].buffer_addr, new_samples.data(),
-                      info.wave_buffer[wave_index].buffer_sz);
+void AudioRenderer::VoiceState::RefreshBuffer(Codec::ADPCMCache& adpcm_cache) {
+    const auto& wave_buffer{info.wave_buffer[wave_index]};
+    std::shared_ptr<const std::vector<s16>> decoded_samples;
+    const std::vector<s16>* new_samples{&pcm_samples};
 
     switch (static_cast<Codec::PcmFormat>(info.sample_format)) {
     case Codec::PcmFormat::Int16: {
         // PCM16 is played as-is
+        pcm_samples.resize(wave_buffer.buffer_sz / sizeof(s16));
+        Memory::ReadBlock(wave_buffer.buffer_addr, pcm_samples.data(),
+                          pcm_samples.size() * sizeof(s16));
         break;
     }
     case Codec::PcmFormat::Adpcm: {
-        // Decode ADPCM to PCM16
+        // Decode ADPCM to PCM16, looped and replayed buffers are only decoded once
         Codec::ADPCM_Coeff coeffs;
         Memory::ReadBlock(info.additional_params_addr, coeffs.data(), sizeof(Codec::ADPCM_Coeff));
-        new_samples = Codec::DecodeADPCM(reinterpret_cast<u8*>(new_samples.data()),
-                                         new_samples.size() * sizeof(s16), coeffs, adpcm_state);
+        decoded_samples = adpcm_cache.Decode(wave_buffer.buffer_addr, wave_buffer.buffer_sz,
+                                             coeffs, adpcm_state);
+        new_samples = decoded_samples.get();
         break;
     }
     default:
@@ -223,15 +391,15 @@ void AudioRenderer::VoiceState::RefreshBuffer() {
     switch (info.channel_count) {
     case 1:
         // 1 channel is upsampled to 2 channel
-        samples.resize(new_samples.size() * 2);
-        for (std::size_t index = 0; index < new_samples.size(); ++index) {
-            samples[index * 2] = new_samples[index];
-            samples[index * 2 + 1] = new_samples[index];
+        samples.resize(new_samples->size() * 2);
+        for (std::size_t index = 0; index < new_samples->size(); ++index) {
+            samples[index * 2] = (*new_samples)[index];
+            samples[index * 2 + 1] = (*new_samples)[index];
         }
         break;
     case 2: {
         // 2 channel is played as is
-        samples = std::move(new_samples);
+        samples.assign(new_samples->begin(), new_samples->end());
         break;
     }
     default:
@@ -240,49 +408,235 @@ void AudioRenderer::VoiceState::RefreshBuffer() {
         break;
     }
 
-    samples = Interpolate(interp_state, std::move(samples), Info().sample_rate, STREAM_SAMPLE_RATE);
-
     is_refresh_pending = false;
 }
 
-static constexpr s16 ClampToS16(s32 value) {
-    return static_cast<s16>(std::clamp(value, -32768, 32767));
+void AudioRenderer::UpdateMixes(const std::vector<MixInfo>& mix_infos) {
+    const std::size_t num_buffers{mix_buffers.size() / BLOCK_SIZE};
+    mixes.assign(std::max<std::size_t>(mix_infos.size(), 1), {});
+
+    // Each mix in use takes the next buffers, the final mix plays the first two in stereo when
+    // the guest didn't send it
+    std::size_t buffer_offset{};
+    for (std::size_t index = 0; index < mixes.size(); ++index) {
+        MixState& mix{mixes[index]};
+        if (index >= mix_infos.size() || !mix_infos[index].in_use) {
+            if (index == 0) {
+                mix.buffer_count = STREAM_NUM_CHANNELS;
+                buffer_offset = mix.buffer_count;
+            }
+            continue;
+        }
+
+        const MixInfo& info{mix_infos[index]};
+        mix.node_id = info.node_id;
+        mix.volume = info.volume;
+        mix.buffer_offset = buffer_offset;
+        mix.buffer_count = std::min<std::size_t>({info.buffer_count, MAX_MIX_BUFFERS,
+                                                  num_buffers - buffer_offset});
+        buffer_offset += mix.buffer_count;
+        for (std::size_t source = 0; source < MAX_MIX_BUFFERS; ++source) {
+            std::copy(info.mix_volume[source].begin(), info.mix_volume[source].end(),
+                      mix.mix_volume[source].begin());
+        }
+        if (index != 0 && info.dest_mix_id < mix_infos.size() && info.dest_mix_id != index) {
+            mix.dest_mix = info.dest_mix_id;
+        }
+    }
+
+    // Submixes are applied by decreasing distance to the final mix, so that each one has received
+    // all of its sources when it's sent. Submixes that never reach the final mix aren't heard.
+    std::vector<std::pair<std::size_t, std::size_t>> distances;
+    for (std::size_t index = 1; index < mixes.size(); ++index) {
+        std::size_t distance{};
+        boost::optional<std::size_t> current{index};
+        while (current && *current != 0 && distance <= mixes.size()) {
+            current = mixes[*current].dest_mix;
+            ++distance;
+        }
+        if (current && *current == 0) {
+            distances.emplace_back(distance, index);
+        }
+    }
+    std::sort(distances.begin(), distances.end(), std::greater<>());
+
+    submix_order.clear();
+    for (const auto& [distance, index] : distances) {
+        submix_order.push_back(index);
+    }
 }
 
-void AudioRenderer::QueueMixedBuffer(Buffer::Tag tag) {
-    constexpr std::size_t BUFFER_SIZE{512};
-    std::vector<s16> buffer(BUFFER_SIZE * stream->GetNumChannels());
+void AudioRenderer::RenderBlock(PerformanceFrame& frame, Clock::time_point frame_start) {
+    YUZU_TRACE_ZONE("RenderBlock");
+    std::fill(mix_buffers.begin(), mix_buffers.end(), 0.0f);
+
+    const auto add_entry = [&frame, frame_start](u32 node_id, PerformanceEntryType type,
+                                                 Clock::time_point start,
+                                                 Clock::duration processing_time) {
+        PerformanceEntry entry{};
+        entry.node_id = node_id;
+        entry.start_time = ToMicroseconds(start - frame_start);
+        entry.processing_time = ToMicroseconds(processing_time);
+        entry.entry_type = type;
+        frame.entries.push_back(entry);
+    };
+
+    // Decoding, resampling and filtering only touch the state of each voice, so they can run on
+    // several threads. The voices are then mixed one at a time in order, which keeps the output
+    // the same whichever threads processed them.
+    const auto process_voice = [this](std::size_t index) {
+        VoiceResult& result{voice_results[index]};
+        result.is_processed = false;
+        if (!voices[index].IsPlaying()) {
+            return;
+        }
+        result.start = Clock::now();
+        result.is_processed = voices[index].ProcessBlock(*adpcm_cache);
+        result.processing_time = Clock::now() - result.start;
+    };
+    const auto playing_count{static_cast<std::size_t>(std::count_if(
+        voices.begin(), voices.end(), [](const VoiceState& voice) { return voice.IsPlaying(); }))};
+    if (playing_count >= PARALLEL_VOICE_THRESHOLD) {
+        Common::ThreadPool::GetInstance().ParallelFor(0, voices.size(), process_voice, 4);
+    } else {
+        for (std::size_t index = 0; index < voices.size(); ++index) {
+            process_voice(index);
+        }
+    }
 
-    for (auto& voice : voices) {
-        if (!voice.IsPlaying()) {
+    u64 voice_count{};
+    for (std::size_t index = 0; index < voices.size(); ++index) {
+        const VoiceResult& result{voice_results[index]};
+        if (!result.is_processed) {
             continue;
         }
+        const auto mix_start{Clock::now()};
+        MixVoice(voices[index]);
+        // The entry covers the processing of the voice, on whichever thread it ran, and its mix
+        add_entry(voices[index].GetInfo().node_id, PerformanceEntryType::Voice, result.start,
+                  result.processing_time + (Clock::now() - mix_start));
+        ++voice_count;
+    }
+    Core::System::GetInstance().GetPerfStats().AddCounter(Core::PerfCounter::AudioVoices,
+                                                          voice_count);
+
+    for (const std::size_t index : submix_order) {
+        const auto start{Clock::now()};
+        const MixState& source{mixes[index]};
+        const MixState& destination{mixes[*source.dest_mix]};
+        for (std::size_t from = 0; from < source.buffer_count; ++from) {
+            for (std::size_t to = 0; to < destination.buffer_count; ++to) {
+                const float volume{source.volume * source.mix_volume[from][to]};
+                if (volume != 0.0f) {
+                    MixSamples(MixBuffer(destination.buffer_offset + to),
+                               MixBuffer(source.buffer_offset + from), BLOCK_SIZE, volume);
+                }
+            }
+        }
+        add_entry(source.node_id, PerformanceEntryType::SubMix, start, Clock::now() - start);
+    }
+}
 
-        std::size_t offset{};
-        s64 samples_remaining{BUFFER_SIZE};
-        while (samples_remaining > 0) {
-            const std::vector<s16> samples{voice.DequeueSamples(samples_remaining)};
-
-            if (samples.empty()) {
-                break;
+void AudioRenderer::MixVoice(const VoiceState& voice) {
+    DeinterleaveSamples(voice_left.data(), voice_right.data(), voice.GetBlock(), BLOCK_SIZE);
+
+    const VoiceInfo& info{voice.GetInfo()};
+    const std::array<const float*, STREAM_NUM_CHANNELS> channels{voice_left.data(),
+                                                                 voice_right.data()};
+
+    // Each channel is sent to the destination mix with the volumes of its channel resource
+    if (info.mix_id < mixes.size() && mixes[info.mix_id].buffer_count != 0) {
+        const MixState& destination{mixes[info.mix_id]};
+        const std::size_t channel_count{
+            std::min<std::size_t>(info.channel_count, STREAM_NUM_CHANNELS)};
+        bool is_routed{};
+        for (std::size_t channel = 0; channel < channel_count; ++channel) {
+            const u32 resource_id{info.voice_channel_resource_ids[channel]};
+            if (resource_id >= voice_resources.size() || !voice_resources[resource_id].in_use) {
+                continue;
             }
+            is_routed = true;
+
+            const VoiceChannelResource& resource{voice_resources[resource_id]};
+            for (std::size_t buffer = 0; buffer < destination.buffer_count; ++buffer) {
+                const float volume{info.volume * resource.mix_volume[buffer]};
+                if (volume != 0.0f) {
+                    MixSamples(MixBuffer(destination.buffer_offset + buffer), channels[channel],
+                               BLOCK_SIZE, volume);
+                }
+            }
+        }
+        if (is_routed) {
+            return;
+        }
+    }
 
-            samples_remaining -= samples.size() / stream->GetNumChannels();
+    // Voices without any routing are played in stereo
+    const MixState& final_mix{mixes[0]};
+    for (std::size_t channel = 0; channel < std::min(final_mix.buffer_count, channels.size());
+         ++channel) {
+        MixSamples(MixBuffer(final_mix.buffer_offset + channel), channels[channel], BLOCK_SIZE,
+                   info.volume);
+    }
+}
 
-            for (const auto& sample : samples) {
-                const s32 buffer_sample{buffer[offset]};
-                buffer[offset++] =
-                    ClampToS16(buffer_sample + static_cast<s32>(sample * voice.GetInfo().volume));
-            }
+float* AudioRenderer::MixBuffer(std::size_t index) {
+    return mix_buffers.data() + index * BLOCK_SIZE;
+}
+
+void AudioRenderer::QueueMixedBuffer(Buffer::Tag tag) {
+    Buffer* const output{audio_out->AcquireBuffer(stream, tag)};
+    if (output == nullptr) {
+        LOG_ERROR(Audio, "No free buffer to render into");
+        return;
+    }
+    auto& buffer{output->Samples()};
+    buffer.resize(BLOCK_SIZE * BLOCKS_PER_BUFFER * STREAM_NUM_CHANNELS);
+
+    auto& perf_stats{Core::System::GetInstance().GetPerfStats()};
+    for (std::size_t block = 0; block < BLOCKS_PER_BUFFER; ++block) {
+        // Each block is an audio frame of the guest, timed for its performance buffer
+        const auto frame_start{Clock::now()};
+        PerformanceFrame& frame{performance_frames.emplace_back()};
+        RenderBlock(frame, frame_start);
+
+        // Only the first two buffers of the final mix are played, a mono mix on both channels
+        const auto final_mix_start{Clock::now()};
+        const MixState& final_mix{mixes[0]};
+        float* const left{MixBuffer(final_mix.buffer_offset)};
+        float* const right{final_mix.buffer_count > 1 ? left + BLOCK_SIZE : left};
+        if (final_mix.volume != 1.0f) {
+            std::fill(voice_left.begin(), voice_left.end(), 0.0f);
+            std::fill(voice_right.begin(), voice_right.end(), 0.0f);
+            MixSamples(voice_left.data(), left, BLOCK_SIZE, final_mix.volume);
+            MixSamples(voice_right.data(), right, BLOCK_SIZE, final_mix.volume);
+            SaturateSamples(buffer.data() + block * BLOCK_SIZE * STREAM_NUM_CHANNELS,
+                            voice_left.data(), voice_right.data(), BLOCK_SIZE);
+        } else {
+            SaturateSamples(buffer.data() + block * BLOCK_SIZE * STREAM_NUM_CHANNELS, left, right,
+                            BLOCK_SIZE);
         }
+
+        const auto frame_end{Clock::now()};
+        PerformanceEntry final_mix_entry{};
+        final_mix_entry.node_id = final_mix.node_id;
+        final_mix_entry.start_time = ToMicroseconds(final_mix_start - frame_start);
+        final_mix_entry.processing_time = ToMicroseconds(frame_end - final_mix_start);
+        final_mix_entry.entry_type = PerformanceEntryType::FinalMix;
+        frame.entries.push_back(final_mix_entry);
+        frame.total_processing_time = ToMicroseconds(frame_end - frame_start);
+        perf_stats.AddStageTime(Core::PerfStage::Audio, frame_end - frame_start);
     }
-    audio_out->QueueBuffer(stream, tag, std::move(buffer));
+
+    audio_out->QueueBuffer(stream, output);
 }
 
 void AudioRenderer::ReleaseAndQueueBuffers() {
-    const auto released_buffers{audio_out->GetTagsAndReleaseBuffers(stream, 2)};
-    for (const auto& tag : released_buffers) {
-        QueueMixedBuffer(tag);
+    std::array<Buffer::Tag, 2> tags;
+    const std::size_t released_count{
+        audio_out->GetTagsAndReleaseBuffers(stream, tags.data(), tags.size())};
+    for (std::size_t index = 0; index < released_count; ++index) {
+        QueueMixedBuffer(tags[index]);
     }
 }
 
@@ -7,12 +7,14 @@
 #include <array>
 #include <memory>
 #include <vector>
+#include <boost/optional.hpp>
 
 #include "audio_core/stream.h"
 #include "common/common_funcs.h"
 #include "common/common_types.h"
 #include "common/swap.h"
 #include "core/hle/kernel/object.h"
+#include "core/perf_stats.h"
 
 namespace Kernel {
 class Event;
@@ -22,6 +24,10 @@ namespace AudioCore {
 
 class AudioOut;
 
+namespace Codec {
+class ADPCMCache;
+}
+
 enum class PlayState : u8 {
     Started = 0,
     Stopped = 1,
@@ -32,7 +38,7 @@ struct AudioRendererParameter {
     u32_le sample_rate;
     u32_le sample_count;
     u32_le mix_buffer_count;
-    u32_le unknown_c;
+    u32_le submix_count;
     u32_le voice_count;
     u32_le sink_count;
     u32_le effect_count;
@@ -121,6 +127,37 @@ struct VoiceInfo {
 };
 static_assert(sizeof(VoiceInfo) == 0x170, "VoiceInfo is wrong size");
 
+/// Maximum number of mix buffers a voice channel or a mix can send to
+constexpr std::size_t MAX_MIX_BUFFERS = 24;
+
+/// Volumes a voice channel is mixed into the buffers of the voice's destination mix with
+struct VoiceChannelResource {
+    u32_le id;
+    std::array<float_le, MAX_MIX_BUFFERS> mix_volume;
+    u8 in_use;
+    INSERT_PADDING_BYTES(11);
+};
+static_assert(sizeof(VoiceChannelResource) == 0x70, "VoiceChannelResource has wrong size");
+
+/// The final mix (id 0) and the submixes, which each own buffer_count consecutive mix buffers
+struct MixInfo {
+    float_le volume;
+    u32_le sample_rate;
+    u32_le buffer_count;
+    u8 in_use;
+    INSERT_PADDING_BYTES(3);
+    u32_le mix_id;
+    u32_le effect_count;
+    u32_le node_id;
+    INSERT_PADDING_WORDS(2);
+    /// Volume each buffer of this mix is sent to each buffer of the destination mix with
+    std::array<std::array<float_le, MAX_MIX_BUFFERS>, MAX_MIX_BUFFERS> mix_volume;
+    u32_le dest_mix_id;
+    u32_le splitter_id;
+    INSERT_PADDING_WORDS(1);
+};
+static_assert(sizeof(MixInfo) == 0x930, "MixInfo has wrong size");
+
 struct VoiceOutStatus {
     u64_le played_sample_count;
     u32_le wave_buffer_consumed;
@@ -128,6 +165,45 @@ struct VoiceOutStatus {
 };
 static_assert(sizeof(VoiceOutStatus) == 0x10, "VoiceOutStatus has wrong size");
 
+/// Kind of node a performance entry measures
+enum class PerformanceEntryType : u8 {
+    Invalid = 0,
+    Voice = 1,
+    SubMix = 2,
+    FinalMix = 3,
+    Sink = 4,
+};
+
+/// Header of an audio frame in the performance buffer, which its entries directly follow
+struct PerformanceFrameHeader {
+    u32_le magic;
+    u32_le entry_count;
+    u32_le entry_detail_count;
+    /// Offset of the next frame from this header
+    u32_le next_offset;
+    /// Processing time of the whole frame, in microseconds
+    u32_le total_processing_time;
+    u32_le voice_drop_count;
+};
+static_assert(sizeof(PerformanceFrameHeader) == 0x18, "PerformanceFrameHeader has wrong size");
+
+/// Processing time of a node during an audio frame, in microseconds from the start of the frame
+struct PerformanceEntry {
+    u32_le node_id;
+    u32_le start_time;
+    u32_le processing_time;
+    PerformanceEntryType entry_type;
+    INSERT_PADDING_BYTES(3);
+};
+static_assert(sizeof(PerformanceEntry) == 0x10, "PerformanceEntry has wrong size");
+
+struct PerformanceOutStatus {
+    /// Size of the frames written to the performance buffer
+    u32_le history_size;
+    INSERT_PADDING_WORDS(3);
+};
+static_assert(sizeof(PerformanceOutStatus) == 0x10, "PerformanceOutStatus has wrong size");
+
 struct UpdateDataHeader {
     UpdateDataHeader() {}
 
@@ -164,7 +240,15 @@ public:
     AudioRenderer(AudioRendererParameter params, Kernel::SharedPtr<Kernel::Event> buffer_event);
     ~AudioRenderer();
 
-    std::vector<u8> UpdateAudioRenderer(const std::vector<u8>& input_params);
+    /**
+     * Applies the parameters sent by the guest, renders the buffers the stream released and
+     * returns the output parameters.
+     * @param performance_output Sized by the caller to the capacity of the performance buffer of
+     *     the guest, receives the performance frames rendered since the last update and is shrunk
+     *     to the size they take.
+     */
+    std::vector<u8> UpdateAudioRenderer(const std::vector<u8>& input_params,
+                                        std::vector<u8>& performance_output);
     void QueueMixedBuffer(Buffer::Tag tag);
     void ReleaseAndQueueBuffers();
     u32 GetSampleRate() const;
@@ -174,9 +258,66 @@ public:
 private:
     class VoiceState;
 
+    /// Mix buffers owned by a mix and where they are sent to
+    struct MixState {
+        u32 node_id = 0;
+        float volume = 1.0f;
+        std::size_t buffer_offset = 0;
+        std::size_t buffer_count = 0;
+        /// Index of the destination mix, unset for the final mix or when it isn't valid
+        boost::optional<std::size_t> dest_mix;
+        std::array<std::array<float, MAX_MIX_BUFFERS>, MAX_MIX_BUFFERS> mix_volume{};
+    };
+
+    /// Builds the mix graph from the mixes sent by the guest, or a stereo final mix without them
+    void UpdateMixes(const std::vector<MixInfo>& mix_infos);
+
+    /// Processing times of the nodes during an audio frame, as reported to the guest
+    struct PerformanceFrame {
+        u32 total_processing_time = 0;
+        std::vector<PerformanceEntry> entries;
+    };
+
+    /// Runs the voices and mixes of one block, leaving the output in the final mix buffers
+    void RenderBlock(PerformanceFrame& frame, Core::PerfStats::Clock::time_point frame_start);
+
+    /// Writes the most recent performance frames that fit, returns the size they take
+    std::size_t WritePerformanceFrames(std::vector<u8>& output) const;
+
+    /// Mixes the last processed block of a voice into the buffers of its destination mix
+    void MixVoice(const VoiceState& voice);
+
+    /// Returns the mix buffer of the given index
+    float* MixBuffer(std::size_t index);
+
+    /// Outcome of processing a voice for the current block
+    struct VoiceResult {
+        bool is_processed = false;
+        Core::PerfStats::Clock::time_point start;
+        Core::PerfStats::Clock::duration processing_time{};
+    };
+
     AudioRendererParameter worker_params;
     Kernel::SharedPtr<Kernel::Event> buffer_event;
     std::vector<VoiceState> voices;
+    /// Indexed like voices, written by the threads processing them
+    std::vector<VoiceResult> voice_results;
+    std::vector<VoiceChannelResource> voice_resources;
+
+    /// Mixes indexed by mix id, with the final mix first
+    std::vector<MixState> mixes;
+    /// Indices of the submixes in the order they are applied, sources before destinations
+    std::vector<std::size_t> submix_order;
+    /// Planar mix buffers of BLOCK_SIZE samples each, reused across blocks
+    std::vector<float> mix_buffers;
+    /// Channels of the voice being mixed, split from its interleaved output
+    std::vector<float> voice_left;
+    std::vector<float> voice_right;
+    /// Audio frames rendered since the last update
+    std::vector<PerformanceFrame> performance_frames;
+    /// Decoded wave buffers shared by all the voices
+    std::unique_ptr<Codec::ADPCMCache> adpcm_cache;
+
     std::unique_ptr<AudioOut> audio_out;
     AudioCore::StreamPtr stream;
 };
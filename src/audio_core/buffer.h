@@ -4,7 +4,6 @@
 
 #pragma once
 
-#include <memory>
 #include <vector>
 
 #include "common/common_types.h"
@@ -12,14 +11,13 @@
 namespace AudioCore {
 
 /**
- * Represents a buffer of audio samples to be played in an audio stream
+ * Represents a buffer of audio samples to be played in an audio stream. Buffers are owned by the
+ * pool of their stream and reused, so their samples keep their capacity from one use to the next.
  */
 class Buffer {
 public:
     using Tag = u64;
 
-    Buffer(Tag tag, std::vector<s16>&& samples) : tag{tag}, samples{std::move(samples)} {}
-
     /// Returns the raw audio data for the buffer
     std::vector<s16>& Samples() {
         return samples;
@@ -35,11 +33,14 @@ public:
         return tag;
     }
 
+    /// Sets the buffer tag
+    void SetTag(Tag new_tag) {
+        tag = new_tag;
+    }
+
 private:
-    Tag tag;
+    Tag tag{};
     std::vector<s16> samples;
 };
 
-using BufferPtr = std::shared_ptr<Buffer>;
-
 } // namespace AudioCore
@@ -10,16 +10,29 @@
 #include "audio_core/time_stretch.h"
 #include "common/logging/log.h"
 #include "common/ring_buffer.h"
+#include "core/core.h"
+#include "core/perf_stats.h"
 #include "core/settings.h"
 
 namespace AudioCore {
 
+/// Latency requested from cubeb when it can't tell the minimum one, in frames
+constexpr u32 DefaultLatencyFrames{512};
+/// Time without underruns after which the extra buffering they caused is halved, in seconds
+constexpr u32 HeadroomDecayTime{5};
+
+static TimeStretcher::Quality GetStretchQuality() {
+    return static_cast<TimeStretcher::Quality>(std::clamp(
+        Settings::values.audio_stretch_quality, static_cast<int>(TimeStretcher::Quality::Fast),
+        static_cast<int>(TimeStretcher::Quality::High)));
+}
+
 class CubebSinkStream final : public SinkStream {
 public:
     CubebSinkStream(cubeb* ctx, u32 sample_rate, u32 num_channels_, cubeb_devid output_device,
                     const std::string& name)
-        : ctx{ctx}, num_channels{std::min(num_channels_, 2u)}, time_stretch{sample_rate,
-                                                                            num_channels} {
+        : ctx{ctx}, sample_rate{sample_rate}, num_channels{std::min(num_channels_, 2u)},
+          time_stretch{sample_rate, num_channels, GetStretchQuality()} {
 
         cubeb_stream_params params{};
         params.rate = sample_rate;
@@ -27,15 +40,17 @@ public:
         params.format = CUBEB_SAMPLE_S16NE;
         params.layout = num_channels == 1 ? CUBEB_LAYOUT_MONO : CUBEB_LAYOUT_STEREO;
 
+        // Underruns are rather handled by buffering more on our side, so the device is always
+        // opened with the lowest latency it supports
         u32 minimum_latency{};
         if (cubeb_get_min_latency(ctx, &params, &minimum_latency) != CUBEB_OK) {
-            LOG_CRITICAL(Audio_Sink, "Error getting minimum latency");
+            LOG_ERROR(Audio_Sink, "Error getting minimum latency");
+            minimum_latency = DefaultLatencyFrames;
         }
 
         if (cubeb_stream_init(ctx, &stream_backend, name.c_str(), nullptr, nullptr, output_device,
-                              &params, std::max(512u, minimum_latency),
-                              &CubebSinkStream::DataCallback, &CubebSinkStream::StateCallback,
-                              this) != CUBEB_OK) {
+                              &params, minimum_latency, &CubebSinkStream::DataCallback,
+                              &CubebSinkStream::StateCallback, this) != CUBEB_OK) {
             LOG_CRITICAL(Audio_Sink, "Error initializing cubeb stream");
             return;
         }
@@ -44,6 +59,14 @@ public:
             LOG_CRITICAL(Audio_Sink, "Error starting cubeb stream");
             return;
         }
+
+        u32 stream_latency{};
+        if (cubeb_stream_get_latency(stream_backend, &stream_latency) != CUBEB_OK) {
+            stream_latency = minimum_latency;
+        }
+        device_latency_frames = stream_latency;
+        LOG_INFO(Audio_Sink, "Opened cubeb stream {} with a latency of {} frames", name,
+                 stream_latency);
     }
 
     ~CubebSinkStream() {
@@ -60,19 +83,23 @@ public:
 
     void EnqueueSamples(u32 source_num_channels, const std::vector<s16>& samples) override {
         if (source_num_channels > num_channels) {
-            // Downsample 6 channels to 2
-            std::vector<s16> buf;
-            buf.reserve(samples.size() * num_channels / source_num_channels);
-            for (std::size_t i = 0; i < samples.size(); i += source_num_channels) {
-                for (std::size_t ch = 0; ch < num_channels; ch++) {
-                    buf.push_back(samples[i + ch]);
+            // Downsample 6 channels to 2, straight into the queue
+            const std::size_t num_frames{samples.size() / source_num_channels};
+            const auto spans{queue.ReserveWrite(num_frames * num_channels)};
+            std::size_t frame{};
+            for (auto [out, count] : {std::make_pair(spans.first, spans.first_count),
+                                      std::make_pair(spans.second, spans.second_count)}) {
+                for (std::size_t i = 0; i + num_channels <= count; i += num_channels, frame++) {
+                    std::copy_n(samples.begin() + frame * source_num_channels, num_channels,
+                                out + i);
                 }
             }
-            queue.Push(buf);
-            return;
+            // Only whole frames were written, the queue never holds part of one
+            queue.CommitWrite(frame * num_channels);
+        } else {
+            queue.Push(samples);
         }
-
-        queue.Push(samples);
+        is_idle = false;
     }
 
     std::size_t SamplesInQueue(u32 num_channels) const override {
@@ -84,23 +111,113 @@ public:
 
     void Flush() override {
         should_flush = true;
+        is_idle = true;
     }
 
     u32 GetNumChannels() const {
         return num_channels;
     }
 
+    /**
+     * Pops frames from the queue. When audio stretching is enabled, the frames are stretched once
+     * the queue runs low, until it's back at the latency target plus the headroom underruns added.
+     * @returns The number of frames written to `out`
+     */
+    std::size_t PopFrames(s16* out, std::size_t num_frames) {
+        if (!Settings::values.enable_audio_stretching) {
+            return queue.Pop(out, num_frames * num_channels) / num_channels;
+        }
+
+        const std::size_t target_frames{sample_rate * Settings::values.audio_latency / 1000 +
+                                        headroom_frames};
+        const std::size_t buffered_frames{queue.Size() / num_channels +
+                                          time_stretch.GetBackloggedFrames()};
+        if (!is_stretching && buffered_frames < std::max(num_frames, target_frames / 4)) {
+            // The emulated audio isn't keeping up, stretch it to cover the gap
+            is_stretching = true;
+        } else if (is_stretching && buffered_frames >= target_frames) {
+            // Play the queue as-is again once the stretched audio runs out
+            time_stretch.Flush();
+            is_stretching = false;
+        }
+
+        std::size_t frames_written;
+        if (is_stretching) {
+            // The queued samples are stretched in place, unless they wrap around the end of it
+            const auto spans{queue.Peek()};
+            const s16* in{spans.first};
+            if (spans.second_count != 0) {
+                stretch_buffer.assign(spans.first, spans.first + spans.first_count);
+                stretch_buffer.insert(stretch_buffer.end(), spans.second,
+                                      spans.second + spans.second_count);
+                in = stretch_buffer.data();
+            }
+            frames_written = time_stretch.Process(in, spans.Size() / num_channels, out, num_frames);
+            queue.Consume(spans.Size());
+        } else {
+            frames_written = time_stretch.Receive(out, num_frames);
+            frames_written += queue.Pop(out + frames_written * num_channels,
+                                        (num_frames - frames_written) * num_channels) /
+                              num_channels;
+        }
+
+        if (should_flush) {
+            time_stretch.Flush();
+            should_flush = false;
+        }
+        return frames_written;
+    }
+
+    /// Updates the underrun and latency counters after the output was given `num_written` frames
+    /// out of the `num_frames` it requested
+    void UpdateStats(std::size_t num_written, std::size_t num_frames) {
+        auto& perf_stats{Core::System::GetInstance().GetPerfStats()};
+        const std::size_t configured_frames{sample_rate * Settings::values.audio_latency / 1000};
+
+        if (num_written < num_frames && !is_idle) {
+            // Each underrun makes the sink wait for more audio before it stops stretching
+            perf_stats.AddAudioUnderrun();
+            headroom_frames = std::min(headroom_frames + configured_frames / 4,
+                                       configured_frames * 3);
+            frames_since_underrun = 0;
+        } else {
+            frames_since_underrun += num_frames;
+            if (frames_since_underrun >= sample_rate * HeadroomDecayTime) {
+                headroom_frames /= 2;
+                frames_since_underrun = 0;
+            }
+        }
+
+        const std::size_t queued_frames{queue.Size() / num_channels +
+                                        time_stretch.GetBackloggedFrames()};
+        perf_stats.SetAudioLatency(std::chrono::microseconds(
+            (queued_frames + device_latency_frames) * 1000000 / sample_rate));
+    }
+
 private:
     std::vector<std::string> device_list;
 
     cubeb* ctx{};
     cubeb_stream* stream_backend{};
+    u32 sample_rate{};
     u32 num_channels{};
 
     Common::RingBuffer<s16, 0x10000> queue;
+    /// Scratch buffer for the queued samples that wrap around the end of the queue
+    std::vector<s16> stretch_buffer;
     std::array<s16, 2> last_frame;
     std::atomic<bool> should_flush{};
+    /// Whether the stream stopped providing samples, so running out of them isn't an underrun
+    std::atomic<bool> is_idle{true};
     TimeStretcher time_stretch;
+    bool is_stretching{};
+
+    /// Latency of the output device, in frames
+    u32 device_latency_frames{};
+    /// Frames buffered on top of the latency target, grown by underruns
+    std::size_t headroom_frames{};
+    /// Frames output since the last underrun
+    std::size_t frames_since_underrun{};
 
     static long DataCallback(cubeb_stream* stream, void* user_data, const void* input_buffer,
                              void* output_buffer, long num_frames);
@@ -161,23 +278,9 @@ long CubebSinkStream::DataCallback(cubeb_stream* stream, void* user_data, const
 
     const std::size_t num_channels = impl->GetNumChannels();
     const std::size_t samples_to_write = num_channels * num_frames;
-    std::size_t samples_written;
-
-    if (Settings::values.enable_audio_stretching) {
-        const std::vector<s16> in{impl->queue.Pop()};
-        const std::size_t num_in{in.size() / num_channels};
-        s16* const out{reinterpret_cast<s16*>(buffer)};
-        const std::size_t out_frames =
-            impl->time_stretch.Process(in.data(), num_in, out, num_frames);
-        samples_written = out_frames * num_channels;
-
-        if (impl->should_flush) {
-            impl->time_stretch.Flush();
-            impl->should_flush = false;
-        }
-    } else {
-        samples_written = impl->queue.Pop(buffer, samples_to_write);
-    }
+    const std::size_t frames_written = impl->PopFrames(reinterpret_cast<s16*>(buffer), num_frames);
+    const std::size_t samples_written = frames_written * num_channels;
+    impl->UpdateStats(frames_written, num_frames);
 
     if (samples_written >= num_channels) {
         std::memcpy(&impl->last_frame[0], buffer + (samples_written - num_channels) * sizeof(s16),
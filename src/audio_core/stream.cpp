@@ -12,13 +12,14 @@
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
+#include "common/thread.h"
 #include "core/core_timing.h"
-#include "core/core_timing_util.h"
 #include "core/settings.h"
 
 namespace AudioCore {
 
-constexpr std::size_t MaxAudioBufferCount{32};
+/// Longest time the audio thread sleeps, so that latency changes are picked up
+constexpr std::chrono::milliseconds AudioThreadInterval{5};
 
 u32 Stream::GetNumChannels() const {
     switch (format) {
@@ -39,22 +40,42 @@ Stream::Stream(u32 sample_rate, Format format, ReleaseCallback&& release_callbac
     : sample_rate{sample_rate}, format{format}, release_callback{std::move(release_callback)},
       sink_stream{sink_stream}, name{std::move(name_)} {
 
+    for (auto& buffer : buffer_pool) {
+        free_buffers[free_buffer_count++] = &buffer;
+    }
+
+    // Buffers are released on the audio thread, but the guest is notified on the CPU thread
     release_event = CoreTiming::RegisterEvent(
-        name, [this](u64 userdata, int cycles_late) { ReleaseActiveBuffer(); });
+        name, [this](u64 userdata, int cycles_late) { this->release_callback(); });
+}
+
+Stream::~Stream() {
+    if (audio_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock{wake_mutex};
+            stop_requested = true;
+        }
+        buffer_queued.notify_one();
+        audio_thread.join();
+    }
+    CoreTiming::UnscheduleEventThreadsafe(release_event, {});
 }
 
 void Stream::Play() {
     state = State::Playing;
-    PlayNextBuffer();
+    if (!audio_thread.joinable()) {
+        audio_thread = std::thread(&Stream::AudioThread, this);
+    }
 }
 
 void Stream::Stop() {
     ASSERT_MSG(false, "Unimplemented");
 }
 
-s64 Stream::GetBufferReleaseCycles(const Buffer& buffer) const {
+Stream::Clock::duration Stream::GetBufferDuration(const Buffer& buffer) const {
     const std::size_t num_samples{buffer.GetSamples().size() / GetNumChannels()};
-    return CoreTiming::usToCycles((static_cast<u64>(num_samples) * 1000000) / sample_rate);
+    return std::chrono::duration_cast<Clock::duration>(
+        std::chrono::microseconds((static_cast<u64>(num_samples) * 1000000) / sample_rate));
 }
 
 static void VolumeAdjustSamples(std::vector<s16>& samples) {
@@ -71,51 +92,94 @@ static void VolumeAdjustSamples(std::vector<s16>& samples) {
     }
 }
 
-void Stream::PlayNextBuffer() {
-    if (!IsPlaying()) {
-        // Ensure we are in playing state before playing the next buffer
-        sink_stream.Flush();
-        return;
-    }
-
-    if (active_buffer) {
-        // Do not queue a new buffer if we are already playing a buffer
-        return;
+void Stream::AudioThread() {
+    Common::SetCurrentThreadName("yuzu:Audio");
+    // Audio stutters the moment this thread misses its interval, unlike the emulation threads
+    Common::SetCurrentThreadPriority(Common::ThreadPriority::Critical);
+
+    std::unique_lock<std::mutex> lock{wake_mutex};
+    while (!stop_requested) {
+        const auto now{Clock::now()};
+        const bool any_released{ReleasePlayedBuffers(now)};
+        SubmitQueuedBuffers(now);
+        if (any_released) {
+            CoreTiming::ScheduleEventThreadsafe(0, release_event, {});
+        }
+
+        // Buffers are queued without taking the mutex, so a wakeup may be missed. The thread
+        // wakes up on its own soon enough for that not to matter.
+        auto wake_time{now + AudioThreadInterval};
+        if (playing_count != 0) {
+            wake_time = std::min(wake_time, playing_buffers[playing_begin].end_time);
+        }
+        buffer_queued.wait_until(lock, wake_time);
     }
+}
 
-    if (queued_buffers.empty()) {
-        // No queued buffers - we are effectively paused
-        sink_stream.Flush();
-        return;
+bool Stream::ReleasePlayedBuffers(Clock::time_point now) {
+    bool any_released{};
+    while (playing_count != 0 && playing_buffers[playing_begin].end_time <= now) {
+        released_buffers.Push(&playing_buffers[playing_begin].buffer, 1);
+        playing_begin = (playing_begin + 1) % MaxAudioBufferCount;
+        --playing_count;
+        any_released = true;
     }
+    return any_released;
+}
 
-    active_buffer = queued_buffers.front();
-    queued_buffers.pop();
-
-    VolumeAdjustSamples(active_buffer->Samples());
+MICROPROFILE_DEFINE(AudioOutput, "Audio", "SubmitQueuedBuffers", MP_RGB(100, 100, 255));
 
-    sink_stream.EnqueueSamples(GetNumChannels(), active_buffer->GetSamples());
+void Stream::SubmitQueuedBuffers(Clock::time_point now) {
+    MICROPROFILE_SCOPE(AudioOutput);
+    const std::chrono::milliseconds latency{Settings::values.audio_latency};
+
+    while (true) {
+        // After an underrun, playback starts over from the current time
+        const std::size_t playing_end{(playing_begin + playing_count) % MaxAudioBufferCount};
+        const std::size_t playing_back{(playing_end + MaxAudioBufferCount - 1) %
+                                       MaxAudioBufferCount};
+        const auto start_time{playing_count == 0 ? now : playing_buffers[playing_back].end_time};
+        if (playing_count != 0 && start_time - now >= latency) {
+            break;
+        }
+
+        Buffer* buffer;
+        if (queued_buffers.Pop(&buffer, 1) == 0) {
+            break;
+        }
+
+        VolumeAdjustSamples(buffer->Samples());
+        sink_stream.EnqueueSamples(GetNumChannels(), buffer->GetSamples());
+
+        playing_buffers[playing_end] = {buffer, start_time + GetBufferDuration(*buffer)};
+        ++playing_count;
+        underrun = false;
+    }
 
-    CoreTiming::ScheduleEventThreadsafe(GetBufferReleaseCycles(*active_buffer), release_event, {});
+    if (playing_count == 0 && !underrun) {
+        // No buffers left to play - we are effectively paused
+        sink_stream.Flush();
+        underrun = true;
+    }
 }
 
-MICROPROFILE_DEFINE(AudioOutput, "Audio", "ReleaseActiveBuffer", MP_RGB(100, 100, 255));
+Buffer* Stream::AcquireBuffer(Buffer::Tag tag) {
+    if (free_buffer_count == 0) {
+        return nullptr;
+    }
+    Buffer* const buffer{free_buffers[--free_buffer_count]};
+    buffer->SetTag(tag);
+    return buffer;
+}
 
-void Stream::ReleaseActiveBuffer() {
-    MICROPROFILE_SCOPE(AudioOutput);
-    ASSERT(active_buffer);
-    released_buffers.push(std::move(active_buffer));
-    release_callback();
-    PlayNextBuffer();
+void Stream::QueueBuffer(Buffer* buffer) {
+    // There are as many slots as buffers in the pool, so this can't fail
+    queued_buffers.Push(&buffer, 1);
+    buffer_queued.notify_one();
 }
 
-bool Stream::QueueBuffer(BufferPtr&& buffer) {
-    if (queued_buffers.size() < MaxAudioBufferCount) {
-        queued_buffers.push(std::move(buffer));
-        PlayNextBuffer();
-        return true;
-    }
-    return false;
+std::size_t Stream::GetQueueSize() const {
+    return MaxAudioBufferCount - free_buffer_count - released_buffers.Size();
 }
 
 bool Stream::ContainsBuffer(Buffer::Tag tag) const {
@@ -123,13 +187,14 @@ bool Stream::ContainsBuffer(Buffer::Tag tag) const {
     return {};
 }
 
-std::vector<Buffer::Tag> Stream::GetTagsAndReleaseBuffers(std::size_t max_count) {
-    std::vector<Buffer::Tag> tags;
-    for (std::size_t count = 0; count < max_count && !released_buffers.empty(); ++count) {
-        tags.push_back(released_buffers.front()->GetTag());
-        released_buffers.pop();
+std::size_t Stream::GetTagsAndReleaseBuffers(Buffer::Tag* tags, std::size_t max_count) {
+    std::size_t count{};
+    Buffer* buffer;
+    while (count < max_count && released_buffers.Pop(&buffer, 1) != 0) {
+        tags[count++] = buffer->GetTag();
+        free_buffers[free_buffer_count++] = buffer;
     }
-    return tags;
+    return count;
 }
 
 } // namespace AudioCore
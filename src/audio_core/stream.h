@@ -4,14 +4,19 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
-#include <vector>
-#include <queue>
+#include <thread>
 
 #include "audio_core/buffer.h"
 #include "common/common_types.h"
+#include "common/ring_buffer.h"
 
 namespace CoreTiming {
 struct EventType;
@@ -21,8 +26,20 @@ namespace AudioCore {
 
 class SinkStream;
 
+/// Number of buffers in the pool of each stream
+constexpr std::size_t MaxAudioBufferCount{32};
+
 /**
  * Represents an audio stream, which is a sequence of queued buffers, to be outputed by AudioOut
+ *
+ * Buffers are fed to the sink by an audio thread, which keeps up to the configured latency of
+ * audio submitted ahead of playback and releases buffers as they are played in host time. This
+ * way playback doesn't depend on emulation speed, and short stalls are covered by the audio
+ * already in the sink.
+ *
+ * The buffers come from a fixed pool and are handed between the guest thread and the audio thread
+ * through lock-free single producer, single consumer queues, so playing audio doesn't allocate.
+ * All the functions but the constructor and the destructor must be called from the guest thread.
  */
 class Stream {
 public:
@@ -38,6 +55,7 @@ public:
 
     Stream(u32 sample_rate, Format format, ReleaseCallback&& release_callback,
            SinkStream& sink_stream, std::string&& name_);
+    ~Stream();
 
     /// Plays the audio stream
     void Play();
@@ -45,14 +63,25 @@ public:
     /// Stops the audio stream
     void Stop();
 
-    /// Queues a buffer into the audio stream, returns true on success
-    bool QueueBuffer(BufferPtr&& buffer);
+    /**
+     * Takes a buffer from the pool of the stream, to be filled with samples and queued
+     * @returns The buffer, or nullptr when all the buffers of the pool are in use
+     */
+    Buffer* AcquireBuffer(Buffer::Tag tag);
+
+    /// Queues a buffer taken with AcquireBuffer into the audio stream
+    void QueueBuffer(Buffer* buffer);
 
     /// Returns true if the audio stream contains a buffer with the specified tag
     bool ContainsBuffer(Buffer::Tag tag) const;
 
-    /// Returns a vector of recently released buffers specified by tag
-    std::vector<Buffer::Tag> GetTagsAndReleaseBuffers(std::size_t max_count);
+    /**
+     * Returns recently released buffers to the pool
+     * @param tags       Where to write the tags of the released buffers
+     * @param max_count  Maximum number of buffers to release
+     * @returns The number of buffers released
+     */
+    std::size_t GetTagsAndReleaseBuffers(Buffer::Tag* tags, std::size_t max_count);
 
     /// Returns true if the stream is currently playing
     bool IsPlaying() const {
@@ -60,9 +89,7 @@ public:
     }
 
     /// Returns the number of queued buffers
-    std::size_t GetQueueSize() const {
-        return queued_buffers.size();
-    }
+    std::size_t GetQueueSize() const;
 
     /// Gets the sample rate
     u32 GetSampleRate() const {
@@ -79,25 +106,53 @@ private:
         Playing,
     };
 
-    /// Plays the next queued buffer in the audio stream, starting playback if necessary
-    void PlayNextBuffer();
+    using Clock = std::chrono::steady_clock;
+
+    /// Buffer submitted to the sink, along with the time its playback ends
+    struct PlayingBuffer {
+        Buffer* buffer;
+        Clock::time_point end_time;
+    };
+
+    /// Feeds the sink and releases played buffers until the stream is destroyed
+    void AudioThread();
 
-    /// Releases the actively playing buffer, signalling that it has been completed
-    void ReleaseActiveBuffer();
+    /// Moves the buffers whose playback ended to the released ones, returns true if any was
+    bool ReleasePlayedBuffers(Clock::time_point now);
 
-    /// Gets the number of core cycles when the specified buffer will be released
-    s64 GetBufferReleaseCycles(const Buffer& buffer) const;
+    /// Submits queued buffers to the sink until the latency target is reached
+    void SubmitQueuedBuffers(Clock::time_point now);
 
-    u32 sample_rate;                        ///< Sample rate of the stream
-    Format format;                          ///< Format of the stream
-    ReleaseCallback release_callback;       ///< Buffer release callback for the stream
-    State state{State::Stopped};            ///< Playback state of the stream
+    /// Gets the host time it takes to play the specified buffer
+    Clock::duration GetBufferDuration(const Buffer& buffer) const;
+
+    u32 sample_rate;                           ///< Sample rate of the stream
+    Format format;                             ///< Format of the stream
+    ReleaseCallback release_callback;          ///< Buffer release callback for the stream
+    State state{State::Stopped};               ///< Playback state of the stream
     CoreTiming::EventType* release_event{}; ///< Core timing release event for the stream
-    BufferPtr active_buffer;                ///< Actively playing buffer in the stream
-    std::queue<BufferPtr> queued_buffers;   ///< Buffers queued to be played in the stream
-    std::queue<BufferPtr> released_buffers; ///< Buffers recently released from the stream
     SinkStream& sink_stream;                ///< Output sink for the stream
     std::string name;                       ///< Name of the stream, must be unique
+
+    std::array<Buffer, MaxAudioBufferCount> buffer_pool;   ///< Buffers of the stream
+    std::array<Buffer*, MaxAudioBufferCount> free_buffers; ///< Unused buffers of the pool
+    std::size_t free_buffer_count{};                       ///< Number of unused buffers
+
+    /// Buffers queued to be played in the stream, from the guest thread to the audio thread
+    Common::RingBuffer<Buffer*, MaxAudioBufferCount> queued_buffers;
+    /// Buffers recently released from the stream, from the audio thread to the guest thread
+    Common::RingBuffer<Buffer*, MaxAudioBufferCount> released_buffers;
+
+    /// Buffers submitted to the sink in playback order, only used by the audio thread
+    std::array<PlayingBuffer, MaxAudioBufferCount> playing_buffers{};
+    std::size_t playing_begin{}; ///< Index of the first playing buffer
+    std::size_t playing_count{}; ///< Number of playing buffers
+
+    std::mutex wake_mutex;                 ///< Mutex the audio thread sleeps on
+    std::condition_variable buffer_queued; ///< Wakes the audio thread when a buffer is queued
+    std::atomic<bool> stop_requested{};    ///< Whether the audio thread should exit
+    bool underrun{true};                   ///< Whether the sink ran out of submitted buffers
+    std::thread audio_thread;              ///< Thread feeding the sink
 };
 
 using StreamPtr = std::shared_ptr<Stream>;
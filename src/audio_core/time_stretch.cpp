@@ -5,25 +5,53 @@
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include "audio_core/algorithm/wsola.h"
 #include "audio_core/time_stretch.h"
 #include "common/logging/log.h"
 
 namespace AudioCore {
 
-TimeStretcher::TimeStretcher(u32 sample_rate, u32 channel_count)
+/// Distance of the ratio from 1.0 below which the frames are passed through
+constexpr double BypassEnterThreshold = 0.02;
+/// Distance of the ratio from 1.0 above which stretching resumes, larger so it doesn't flap
+constexpr double BypassLeaveThreshold = 0.025;
+
+TimeStretcher::TimeStretcher(u32 sample_rate, u32 channel_count, Quality quality)
     : m_sample_rate(sample_rate), m_channel_count(channel_count) {
     m_sound_touch.setChannels(channel_count);
     m_sound_touch.setSampleRate(sample_rate);
     m_sound_touch.setPitch(1.0);
     m_sound_touch.setTempo(1.0);
+
+    switch (quality) {
+    case Quality::Fast:
+        m_wsola = std::make_unique<WSOLA>(sample_rate, channel_count, 50, 10, 4);
+        break;
+    case Quality::Balanced:
+        m_sound_touch.setSetting(SETTING_SEQUENCE_MS, 40);
+        m_sound_touch.setSetting(SETTING_SEEKWINDOW_MS, 15);
+        m_sound_touch.setSetting(SETTING_OVERLAP_MS, 8);
+        m_sound_touch.setSetting(SETTING_USE_QUICKSEEK, 1);
+        break;
+    case Quality::High:
+        m_sound_touch.setSetting(SETTING_SEQUENCE_MS, 60);
+        m_sound_touch.setSetting(SETTING_SEEKWINDOW_MS, 25);
+        m_sound_touch.setSetting(SETTING_OVERLAP_MS, 12);
+        m_sound_touch.setSetting(SETTING_USE_QUICKSEEK, 0);
+        break;
+    }
 }
 
+TimeStretcher::~TimeStretcher() = default;
+
 void TimeStretcher::Clear() {
-    m_sound_touch.clear();
+    ClearBackend();
+    m_bypass_buffer.clear();
+    m_bypass_begin = 0;
 }
 
 void TimeStretcher::Flush() {
-    m_sound_touch.flush();
+    FlushBackend();
 }
 
 std::size_t TimeStretcher::Process(const s16* in, std::size_t num_in, s16* out,
@@ -35,7 +63,7 @@ std::size_t TimeStretcher::Process(const s16* in, std::size_t num_in, s16* out,
 
     const double max_latency = 1.0; // seconds
     const double max_backlog = m_sample_rate * max_latency;
-    const double backlog_fullness = m_sound_touch.numSamples() / max_backlog;
+    const double backlog_fullness = GetBackloggedFrames() / max_backlog;
     if (backlog_fullness > 5.0) {
         // Too many samples in backlog: Don't push anymore on
         num_in = 0;
@@ -57,13 +85,107 @@ std::size_t TimeStretcher::Process(const s16* in, std::size_t num_in, s16* out,
     // Place a lower limit of 5% speed.  When a game boots up, there will be
     // many silence samples.  These do not need to be timestretched.
     m_stretch_ratio = std::max(m_stretch_ratio, 0.05);
-    m_sound_touch.setTempo(m_stretch_ratio);
+    SetBackendTempo(m_stretch_ratio);
+    UpdateBypass();
+
+    LOG_DEBUG(Audio, "{:5}/{:5} ratio:{:0.6f} backlog:{:0.6f} bypass:{}", num_in, num_out,
+              m_stretch_ratio, backlog_fullness, m_bypass);
 
-    LOG_DEBUG(Audio, "{:5}/{:5} ratio:{:0.6f} backlog:{:0.6f}", num_in, num_out, m_stretch_ratio,
-              backlog_fullness);
+    if (m_bypass) {
+        m_bypass_buffer.insert(m_bypass_buffer.end(), in, in + num_in * m_channel_count);
+    } else {
+        PutBackendSamples(in, num_in);
+    }
+    return Receive(out, num_out);
+}
+
+std::size_t TimeStretcher::Receive(s16* out, std::size_t num_out) {
+    if (!m_bypass) {
+        return ReceiveBackendSamples(out, num_out);
+    }
+
+    const std::size_t num_frames =
+        std::min(num_out, m_bypass_buffer.size() / m_channel_count - m_bypass_begin);
+    const auto begin = m_bypass_buffer.begin() + m_bypass_begin * m_channel_count;
+    std::copy(begin, begin + num_frames * m_channel_count, out);
+    m_bypass_begin += num_frames;
+    if (m_bypass_begin * m_channel_count * 2 >= m_bypass_buffer.size()) {
+        m_bypass_buffer.erase(m_bypass_buffer.begin(),
+                              m_bypass_buffer.begin() + m_bypass_begin * m_channel_count);
+        m_bypass_begin = 0;
+    }
+    return num_frames;
+}
+
+std::size_t TimeStretcher::GetBackloggedFrames() const {
+    return GetBackendBackloggedFrames() + m_bypass_buffer.size() / m_channel_count -
+           m_bypass_begin;
+}
+
+void TimeStretcher::UpdateBypass() {
+    const double distance = std::abs(m_stretch_ratio - 1.0);
+    if (!m_bypass && distance < BypassEnterThreshold) {
+        // The frames still in the backend are played before the ones passed through
+        FlushBackend();
+        const std::size_t num_frames = GetBackendBackloggedFrames();
+        const std::size_t old_size = m_bypass_buffer.size();
+        m_bypass_buffer.resize(old_size + num_frames * m_channel_count);
+        ReceiveBackendSamples(m_bypass_buffer.data() + old_size, num_frames);
+        ClearBackend();
+        m_bypass = true;
+    } else if (m_bypass && distance > BypassLeaveThreshold) {
+        PutBackendSamples(m_bypass_buffer.data() + m_bypass_begin * m_channel_count,
+                          m_bypass_buffer.size() / m_channel_count - m_bypass_begin);
+        m_bypass_buffer.clear();
+        m_bypass_begin = 0;
+        m_bypass = false;
+    }
+}
 
-    m_sound_touch.putSamples(in, static_cast<u32>(num_in));
+void TimeStretcher::PutBackendSamples(const s16* in, std::size_t num_in) {
+    if (m_wsola) {
+        m_wsola->PutSamples(in, num_in);
+    } else {
+        m_sound_touch.putSamples(in, static_cast<u32>(num_in));
+    }
+}
+
+std::size_t TimeStretcher::ReceiveBackendSamples(s16* out, std::size_t num_out) {
+    if (m_wsola) {
+        return m_wsola->ReceiveSamples(out, num_out);
+    }
     return m_sound_touch.receiveSamples(out, static_cast<u32>(num_out));
 }
 
+std::size_t TimeStretcher::GetBackendBackloggedFrames() const {
+    if (m_wsola) {
+        return m_wsola->GetOutputFrames();
+    }
+    return m_sound_touch.numSamples();
+}
+
+void TimeStretcher::SetBackendTempo(double tempo) {
+    if (m_wsola) {
+        m_wsola->SetTempo(tempo);
+    } else {
+        m_sound_touch.setTempo(tempo);
+    }
+}
+
+void TimeStretcher::ClearBackend() {
+    if (m_wsola) {
+        m_wsola->Clear();
+    } else {
+        m_sound_touch.clear();
+    }
+}
+
+void TimeStretcher::FlushBackend() {
+    if (m_wsola) {
+        m_wsola->Flush();
+    } else {
+        m_sound_touch.flush();
+    }
+}
+
 } // namespace AudioCore
@@ -5,14 +5,26 @@
 #pragma once
 
 #include <cstddef>
+#include <memory>
+#include <vector>
 #include <SoundTouch.h>
 #include "common/common_types.h"
 
 namespace AudioCore {
 
+class WSOLA;
+
 class TimeStretcher {
 public:
-    TimeStretcher(u32 sample_rate, u32 channel_count);
+    /// Trade-off between the CPU time spent stretching and the quality of the stretched audio
+    enum class Quality {
+        Fast,     ///< Own WSOLA with short sequences and a coarse seek, for slow CPUs
+        Balanced, ///< SoundTouch with its quick seek
+        High,     ///< SoundTouch with long sequences and a full seek
+    };
+
+    TimeStretcher(u32 sample_rate, u32 channel_count, Quality quality = Quality::Balanced);
+    ~TimeStretcher();
 
     /// @param in       Input sample buffer
     /// @param num_in   Number of input frames in `in`
@@ -21,15 +33,42 @@ public:
     /// @returns Actual number of frames written to `out`
     std::size_t Process(const s16* in, std::size_t num_in, s16* out, std::size_t num_out);
 
+    /// Takes already stretched frames without providing new ones
+    /// @param out      Output sample buffer
+    /// @param num_out  Maximum number of output frames in `out`
+    /// @returns Actual number of frames written to `out`
+    std::size_t Receive(s16* out, std::size_t num_out);
+
+    /// @returns Number of stretched frames ready to be output
+    std::size_t GetBackloggedFrames() const;
+
     void Clear();
 
     void Flush();
 
 private:
+    /// Switches between stretching and passing the frames through as the ratio nears 1.0
+    void UpdateBypass();
+
+    void PutBackendSamples(const s16* in, std::size_t num_in);
+    std::size_t ReceiveBackendSamples(s16* out, std::size_t num_out);
+    std::size_t GetBackendBackloggedFrames() const;
+    void SetBackendTempo(double tempo);
+    void ClearBackend();
+    void FlushBackend();
+
     u32 m_sample_rate;
     u32 m_channel_count;
     soundtouch::SoundTouch m_sound_touch;
+    /// Used instead of SoundTouch with the fast quality
+    std::unique_ptr<WSOLA> m_wsola;
     double m_stretch_ratio = 1.0;
+
+    /// Whether the frames are passed through as they are, as stretching them wouldn't be audible
+    bool m_bypass = false;
+    /// Interleaved frames passed through, starting at m_bypass_begin
+    std::vector<s16> m_bypass_buffer;
+    std::size_t m_bypass_begin = 0;
 };
 
 } // namespace AudioCore
@@ -156,6 +156,17 @@ public:
         }
     }
 
+    /**
+     * Extracts the field from each of count consecutive storage values, such as the words of a
+     * table of packed entries. Unlike reading the entries one at a time through their unions, this
+     * loop over plain storage values can be vectorized by the compiler.
+     */
+    static void ExtractValues(T* values, const StorageType* storage, std::size_t count) {
+        for (std::size_t index = 0; index < count; ++index) {
+            values[index] = ExtractValue(storage[index]);
+        }
+    }
+
     // This constructor and assignment operator might be considered ambiguous:
     // Would they initialize the storage or just the bitfield?
     // Hence, delete them. Use the Assign method to set bitfield values!
@@ -34,6 +34,7 @@
 #define SYSDATA_DIR "sysdata"
 #define KEYS_DIR "keys"
 #define LOG_DIR "log"
+#define LOAD_DIR "load"
 
 // Filenames
 // Files in the directory returned by GetUserPath(UserPath::ConfigDir)
@@ -45,4 +46,5 @@
 
 // Sys files
 #define SHARED_FONT "shared_font.bin"
+#define SHARED_FONT_CACHE "shared_font_cache.bin"
 #define AES_KEYS "aes_keys.txt"
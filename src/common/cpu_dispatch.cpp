@@ -0,0 +1,83 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/cpu_dispatch.h"
+#include "common/logging/log.h"
+#ifdef ARCHITECTURE_x86_64
+#include "common/x64/cpu_detect.h"
+#endif
+
+namespace Common {
+
+namespace {
+std::atomic<SIMDLevel> simd_level_limit{MAX_SIMD_LEVEL};
+} // Anonymous namespace
+
+namespace Detail {
+std::atomic<u32> simd_dispatch_generation{0};
+
+void LogSIMDVariant(const char* name, SIMDLevel level) {
+    LOG_DEBUG(Common, "{} uses its {} variant", name, GetSIMDLevelName(level));
+}
+} // namespace Detail
+
+bool IsSIMDLevelSupported(SIMDLevel level) {
+    switch (level) {
+    case SIMDLevel::Scalar:
+        return true;
+#ifdef ARCHITECTURE_x86_64
+    case SIMDLevel::SSE2:
+        return GetCPUCaps().sse2;
+    case SIMDLevel::SSSE3:
+        return GetCPUCaps().ssse3;
+    case SIMDLevel::AVX2:
+        return GetCPUCaps().avx2;
+    case SIMDLevel::AVX512:
+        return GetCPUCaps().avx512f && GetCPUCaps().avx512bw;
+#endif
+#ifdef ARCHITECTURE_ARM64
+    case SIMDLevel::NEON:
+        // NEON is part of the base AArch64 instruction set
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+bool IsSIMDLevelEnabled(SIMDLevel level) {
+    return level == SIMDLevel::Scalar ||
+           (level <= simd_level_limit.load(std::memory_order_relaxed) &&
+            IsSIMDLevelSupported(level));
+}
+
+const char* GetSIMDLevelName(SIMDLevel level) {
+    switch (level) {
+    case SIMDLevel::Scalar:
+        return "Scalar";
+    case SIMDLevel::SSE2:
+        return "SSE2";
+    case SIMDLevel::SSSE3:
+        return "SSSE3";
+    case SIMDLevel::AVX2:
+        return "AVX2";
+    case SIMDLevel::AVX512:
+        return "AVX-512";
+    case SIMDLevel::NEON:
+        return "NEON";
+    }
+    return "Unknown";
+}
+
+void SetSIMDLevelLimit(SIMDLevel level) {
+    if (simd_level_limit.exchange(level) != level) {
+        ++Detail::simd_dispatch_generation;
+    }
+}
+
+SIMDLevel GetSIMDLevelLimit() {
+    return simd_level_limit.load(std::memory_order_relaxed);
+}
+
+} // namespace Common
@@ -0,0 +1,129 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <initializer_list>
+#include <vector>
+#include "common/assert.h"
+#include "common/common_types.h"
+
+// Compiles a variant for an instruction set extension that the rest of the build doesn't target.
+// MSVC accepts the intrinsics of any extension without it.
+#if defined(__GNUC__) || defined(__clang__)
+#define SIMD_TARGET(extension) __attribute__((target(extension)))
+#else
+#define SIMD_TARGET(extension)
+#endif
+
+namespace Common {
+
+/// Instruction set extensions a SIMD kernel can have a variant for, from the least capable one
+enum class SIMDLevel : u32 {
+    Scalar = 0,
+    SSE2 = 1,
+    SSSE3 = 2,
+    AVX2 = 3,
+    AVX512 = 4,
+    NEON = 5,
+};
+
+/// The highest level, as a limit it lets every kernel use all that the host CPU supports
+constexpr SIMDLevel MAX_SIMD_LEVEL = SIMDLevel::NEON;
+
+/// Returns whether the host CPU supports the given level, Scalar is always supported
+bool IsSIMDLevelSupported(SIMDLevel level);
+
+/// Returns whether variants of the given level are supported and allowed by the current limit
+bool IsSIMDLevelEnabled(SIMDLevel level);
+
+/// Returns the name of the given level, as shown in the logs
+const char* GetSIMDLevelName(SIMDLevel level);
+
+/**
+ * Prevents the dispatched functions from using variants above the given level, so that the
+ * variants can be compared against each other on the same machine. The functions are resolved
+ * again on their next call.
+ */
+void SetSIMDLevelLimit(SIMDLevel level);
+
+SIMDLevel GetSIMDLevelLimit();
+
+namespace Detail {
+/// Incremented each time the limit changes
+extern std::atomic<u32> simd_dispatch_generation;
+
+void LogSIMDVariant(const char* name, SIMDLevel level);
+} // namespace Detail
+
+template <typename Signature>
+class DispatchedFunction;
+
+/**
+ * A function with variants for several SIMD levels, called through a pointer to the best variant
+ * that is enabled. The pointer is resolved on the first call and once more after each change of
+ * the limit, calls otherwise only cost an indirect call. Concurrent first calls resolve the same
+ * variant, so they may race without harm.
+ *
+ * A Scalar variant must always be provided. Variants for other levels are only registered where
+ * the target architecture has them, with SIMD_TARGET enabling the extension for their definition.
+ */
+template <typename Result, typename... Args>
+class DispatchedFunction<Result(Args...)> {
+public:
+    using Pointer = Result (*)(Args...);
+
+    struct Variant {
+        SIMDLevel level;
+        Pointer function;
+    };
+
+    DispatchedFunction(const char* name, std::initializer_list<Variant> variants)
+        : name{name}, variants{variants} {}
+
+    Result operator()(Args... args) {
+        const u32 generation = Detail::simd_dispatch_generation.load(std::memory_order_relaxed);
+        Pointer function = resolved_function.load(std::memory_order_relaxed);
+        if (function == nullptr ||
+            resolved_generation.load(std::memory_order_relaxed) != generation) {
+            function = Resolve(generation);
+        }
+        return function(args...);
+    }
+
+    /// Returns the level of the variant calls resolve to under the current limit
+    SIMDLevel GetResolvedLevel() const {
+        return SelectVariant().level;
+    }
+
+private:
+    const Variant& SelectVariant() const {
+        const Variant* best = nullptr;
+        for (const Variant& variant : variants) {
+            if (IsSIMDLevelEnabled(variant.level) &&
+                (best == nullptr || variant.level > best->level)) {
+                best = &variant;
+            }
+        }
+        ASSERT_MSG(best != nullptr, "{} has no Scalar variant", name);
+        return *best;
+    }
+
+    Pointer Resolve(u32 generation) {
+        const Variant& variant = SelectVariant();
+        Detail::LogSIMDVariant(name, variant.level);
+        resolved_function.store(variant.function, std::memory_order_relaxed);
+        resolved_generation.store(generation, std::memory_order_relaxed);
+        return variant.function;
+    }
+
+    const char* name;
+    std::vector<Variant> variants;
+    std::atomic<Pointer> resolved_function{nullptr};
+    std::atomic<u32> resolved_generation{0};
+};
+
+} // namespace Common
@@ -0,0 +1,126 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <map>
+#include <utility>
+#include "common/cpu_topology.h"
+#include "common/logging/log.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <fstream>
+#include <string>
+#include <sched.h>
+#endif
+
+namespace Common {
+
+/// Number of logical CPUs an affinity mask can hold
+constexpr u32 MaxCpus = 32;
+
+#ifdef _WIN32
+
+static std::vector<PhysicalCore> DetectPhysicalCores() {
+    DWORD length = 0;
+    GetLogicalProcessorInformationEx(RelationProcessorCore, nullptr, &length);
+    std::vector<u8> buffer(length);
+    auto* const info = reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data());
+    if (length == 0 || !GetLogicalProcessorInformationEx(RelationProcessorCore, info, &length)) {
+        return {};
+    }
+
+    std::vector<PhysicalCore> cores;
+    for (DWORD offset = 0; offset < length;) {
+        const auto& core =
+            *reinterpret_cast<const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(&buffer[offset]);
+        offset += core.Size;
+        // Only the first processor group is used, like SetThreadAffinity does
+        if (core.Processor.GroupMask[0].Group != 0) {
+            continue;
+        }
+        const auto mask = static_cast<u32>(core.Processor.GroupMask[0].Mask);
+        if (mask != 0) {
+            cores.push_back({mask, core.Processor.EfficiencyClass});
+        }
+    }
+    return cores;
+}
+
+#elif defined(__linux__)
+
+/// Reads a number from a sysfs file, returns false when it doesn't exist
+static bool ReadSysfsValue(u32 cpu, const char* name, u32& value) {
+    std::ifstream file("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/" + name);
+    return static_cast<bool>(file >> value);
+}
+
+static std::vector<PhysicalCore> DetectPhysicalCores() {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        return {};
+    }
+
+    // The logical CPUs are grouped by package and core identifiers
+    std::map<std::pair<u32, u32>, PhysicalCore> cores;
+    for (u32 cpu = 0; cpu < MaxCpus; ++cpu) {
+        u32 package;
+        u32 core_id;
+        if (!CPU_ISSET(cpu, &allowed) ||
+            !ReadSysfsValue(cpu, "topology/physical_package_id", package) ||
+            !ReadSysfsValue(cpu, "topology/core_id", core_id)) {
+            continue;
+        }
+        // The capacity tells the cores of hybrid ARM CPUs apart, the maximum frequency the others
+        u32 performance = 0;
+        if (!ReadSysfsValue(cpu, "cpu_capacity", performance)) {
+            ReadSysfsValue(cpu, "cpufreq/cpuinfo_max_freq", performance);
+        }
+        PhysicalCore& core = cores[{package, core_id}];
+        core.cpu_mask |= 1U << cpu;
+        core.efficiency_class = std::max(core.efficiency_class, performance);
+    }
+
+    std::vector<PhysicalCore> result;
+    for (const auto& [key, core] : cores) {
+        result.push_back(core);
+    }
+    return result;
+}
+
+#else
+
+static std::vector<PhysicalCore> DetectPhysicalCores() {
+    return {};
+}
+
+#endif
+
+const std::vector<PhysicalCore>& GetPhysicalCores() {
+    static const std::vector<PhysicalCore> cores = [] {
+        std::vector<PhysicalCore> cores = DetectPhysicalCores();
+        std::stable_sort(cores.begin(), cores.end(),
+                         [](const PhysicalCore& lhs, const PhysicalCore& rhs) {
+                             return lhs.efficiency_class > rhs.efficiency_class;
+                         });
+        for (const PhysicalCore& core : cores) {
+            LOG_DEBUG(Common, "Physical core cpu_mask=0x{:08X} efficiency_class={}", core.cpu_mask,
+                      core.efficiency_class);
+        }
+        return cores;
+    }();
+    return cores;
+}
+
+u32 GetPhysicalCoreMask(std::size_t index) {
+    const auto& cores = GetPhysicalCores();
+    if (cores.empty()) {
+        return 0;
+    }
+    return cores[index % cores.size()].cpu_mask;
+}
+
+} // namespace Common
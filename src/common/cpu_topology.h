@@ -0,0 +1,32 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Common {
+
+/// A physical core of the host
+struct PhysicalCore {
+    u32 cpu_mask;         ///< Affinity mask of the logical CPUs of the core, its SMT siblings
+    u32 efficiency_class; ///< Higher for faster cores on hybrid CPUs, the same for all otherwise
+};
+
+/**
+ * Returns the physical cores the process may run on, fastest first. Only the first 32 logical
+ * CPUs are considered, as affinity masks are 32 bits wide. Empty when the topology is unknown.
+ */
+const std::vector<PhysicalCore>& GetPhysicalCores();
+
+/**
+ * Returns the affinity mask pinning a thread to its own physical core, so that the threads given
+ * different indices don't share one while there are enough of them. 0 when it's unknown.
+ * @param index  Index of the thread among the ones pinned this way
+ */
+u32 GetPhysicalCoreMask(std::size_t index);
+
+} // namespace Common
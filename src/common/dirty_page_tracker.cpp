@@ -0,0 +1,207 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include "common/alignment.h"
+#include "common/dirty_page_tracker.h"
+#include "common/logging/log.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <csignal>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace Common {
+
+namespace {
+
+constexpr std::size_t MAX_TRACKERS = 64;
+
+/// Trackers the fault handler looks the faulting address up in, nullptr for the free slots
+std::array<std::atomic<DirtyPageTracker*>, MAX_TRACKERS> registered_trackers{};
+
+std::size_t GetHostPageSize() {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return static_cast<std::size_t>(info.dwPageSize);
+#else
+    return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+const std::size_t host_page_size = GetHostPageSize();
+
+bool ProtectPages(std::uintptr_t address, std::size_t size, bool writable) {
+    void* const pointer = reinterpret_cast<void*>(address);
+#ifdef _WIN32
+    DWORD old_protect;
+    return VirtualProtect(pointer, size, writable ? PAGE_READWRITE : PAGE_READONLY,
+                          &old_protect) != 0;
+#else
+    return mprotect(pointer, size, writable ? PROT_READ | PROT_WRITE : PROT_READ) == 0;
+#endif
+}
+
+/// Returns true if the write fault was caused by a tracked page, which is now writable again
+bool HandleWriteFault(std::uintptr_t address) {
+    // A host page may hold the ends of two buffers, each of them has to see the write
+    bool is_tracked = false;
+    for (auto& slot : registered_trackers) {
+        DirtyPageTracker* const tracker = slot.load(std::memory_order_acquire);
+        if (tracker != nullptr) {
+            is_tracked |= tracker->MarkDirty(address);
+        }
+    }
+    if (is_tracked) {
+        ProtectPages(address & ~(host_page_size - 1), host_page_size, true);
+    }
+    return is_tracked;
+}
+
+#ifdef _WIN32
+
+LONG CALLBACK VectoredExceptionHandler(PEXCEPTION_POINTERS exception) {
+    const EXCEPTION_RECORD& record = *exception->ExceptionRecord;
+    // The first parameter is 1 for write accesses, the second one the address
+    if (record.ExceptionCode == EXCEPTION_ACCESS_VIOLATION && record.NumberParameters >= 2 &&
+        record.ExceptionInformation[0] == 1 &&
+        HandleWriteFault(static_cast<std::uintptr_t>(record.ExceptionInformation[1]))) {
+        return EXCEPTION_CONTINUE_EXECUTION;
+    }
+    return EXCEPTION_CONTINUE_SEARCH;
+}
+
+void InstallFaultHandler() {
+    AddVectoredExceptionHandler(1, VectoredExceptionHandler);
+}
+
+#else
+
+struct sigaction previous_segv_action;
+struct sigaction previous_bus_action;
+
+void FaultHandler(int signal, siginfo_t* info, void* context) {
+    if (HandleWriteFault(reinterpret_cast<std::uintptr_t>(info->si_addr))) {
+        return;
+    }
+
+    // Not one of ours, hand it to whoever was handling it before
+    const struct sigaction& previous =
+        signal == SIGSEGV ? previous_segv_action : previous_bus_action;
+    if (previous.sa_flags & SA_SIGINFO) {
+        previous.sa_sigaction(signal, info, context);
+    } else if (previous.sa_handler == SIG_DFL || previous.sa_handler == SIG_IGN) {
+        // The faulting instruction runs again once this returns, and then gets the default action
+        sigaction(signal, &previous, nullptr);
+    } else {
+        previous.sa_handler(signal);
+    }
+}
+
+void InstallFaultHandler() {
+    struct sigaction action {};
+    action.sa_sigaction = FaultHandler;
+    action.sa_flags = SA_SIGINFO | SA_NODEFER;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGSEGV, &action, &previous_segv_action);
+    // macOS reports write faults on protected pages as SIGBUS
+    sigaction(SIGBUS, &action, &previous_bus_action);
+}
+
+#endif
+
+} // Anonymous namespace
+
+DirtyPageTracker::DirtyPageTracker(u8* base, std::size_t size)
+    : base{base}, size{size},
+      first_page{AlignDown(reinterpret_cast<std::uintptr_t>(base), host_page_size)},
+      end_page{AlignUp(reinterpret_cast<std::uintptr_t>(base) + size, host_page_size)},
+      dirty_pages((end_page - first_page) / host_page_size) {
+    for (auto& dirty : dirty_pages) {
+        dirty.store(true, std::memory_order_relaxed);
+    }
+
+    static std::once_flag handler_installed;
+    std::call_once(handler_installed, InstallFaultHandler);
+
+    for (auto& slot : registered_trackers) {
+        DirtyPageTracker* expected = nullptr;
+        if (slot.compare_exchange_strong(expected, this, std::memory_order_release)) {
+            is_registered = true;
+            return;
+        }
+    }
+    LOG_WARNING(Common_Memory, "Too many dirty page trackers, the buffer will always be dirty");
+}
+
+DirtyPageTracker::~DirtyPageTracker() {
+    if (!is_registered) {
+        return;
+    }
+    ProtectPages(first_page, end_page - first_page, true);
+    Abandon();
+}
+
+std::vector<DirtyPageTracker::Range> DirtyPageTracker::CollectDirtyRanges() {
+    const auto buffer_start = reinterpret_cast<std::uintptr_t>(base);
+    const auto buffer_end = buffer_start + size;
+
+    std::vector<Range> ranges;
+    for (std::size_t page = 0; page < dirty_pages.size();) {
+        if (!dirty_pages[page].load(std::memory_order_relaxed)) {
+            ++page;
+            continue;
+        }
+        std::size_t last_page = page + 1;
+        while (last_page < dirty_pages.size() &&
+               dirty_pages[last_page].load(std::memory_order_relaxed)) {
+            ++last_page;
+        }
+
+        const std::uintptr_t run_start = first_page + page * host_page_size;
+        const std::uintptr_t run_end = first_page + last_page * host_page_size;
+        if (is_registered) {
+            // Protecting before clearing, a write in between marks the pages dirty once more
+            ProtectPages(run_start, run_end - run_start, false);
+            for (std::size_t i = page; i < last_page; ++i) {
+                dirty_pages[i].store(false, std::memory_order_relaxed);
+            }
+        }
+
+        const std::uintptr_t start = std::max(run_start, buffer_start);
+        const std::uintptr_t end = std::min(run_end, buffer_end);
+        ranges.emplace_back(start - buffer_start, end - start);
+        page = last_page;
+    }
+    return ranges;
+}
+
+void DirtyPageTracker::Abandon() {
+    if (!is_registered) {
+        return;
+    }
+    for (auto& slot : registered_trackers) {
+        DirtyPageTracker* expected = this;
+        if (slot.compare_exchange_strong(expected, nullptr, std::memory_order_release)) {
+            break;
+        }
+    }
+    is_registered = false;
+}
+
+bool DirtyPageTracker::MarkDirty(std::uintptr_t address) {
+    if (address < first_page || address >= end_page) {
+        return false;
+    }
+    dirty_pages[(address - first_page) / host_page_size].store(true, std::memory_order_relaxed);
+    return true;
+}
+
+} // namespace Common
@@ -0,0 +1,72 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Common {
+
+/**
+ * Tracks the host pages of a buffer written to since they were last collected. The pages are
+ * write-protected, and the first write to each one faults into a handler which marks it dirty and
+ * makes it writable again, so unmodified memory costs nothing to track.
+ *
+ * Every page starts dirty. Writes made by the host kernel on behalf of a system call (e.g. read()
+ * into the buffer) fail instead of faulting, so the buffer must only be written to by user code.
+ */
+class DirtyPageTracker {
+public:
+    /// Byte range of the tracked buffer, as an offset from its start and a size
+    using Range = std::pair<std::size_t, std::size_t>;
+
+    DirtyPageTracker(u8* base, std::size_t size);
+    ~DirtyPageTracker();
+
+    DirtyPageTracker(const DirtyPageTracker&) = delete;
+    DirtyPageTracker& operator=(const DirtyPageTracker&) = delete;
+
+    u8* GetBase() const {
+        return base;
+    }
+
+    std::size_t GetSize() const {
+        return size;
+    }
+
+    /**
+     * Returns the ranges written to since the previous call, merged and in ascending order, and
+     * write-protects them again. Writes racing with the call may be missed, so other threads must
+     * not be writing to the buffer.
+     */
+    std::vector<Range> CollectDirtyRanges();
+
+    /// Stops tracking without restoring write access, for a buffer which was already freed.
+    void Abandon();
+
+    /**
+     * Marks the page containing the address dirty if it is tracked, called by the fault handler.
+     * @returns Whether the address belongs to the tracked pages.
+     */
+    bool MarkDirty(std::uintptr_t address);
+
+private:
+    u8* base;
+    std::size_t size;
+
+    /// Tracked host pages, which include the partial pages at both ends of the buffer
+    std::uintptr_t first_page;
+    std::uintptr_t end_page;
+    std::vector<std::atomic<bool>> dirty_pages;
+
+    /// False when every tracker slot is taken, the pages are then always reported as dirty
+    bool is_registered = false;
+};
+
+} // namespace Common
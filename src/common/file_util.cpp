@@ -39,8 +39,10 @@
 #include <cstdlib>
 #include <cstring>
 #include <dirent.h>
+#include <fcntl.h>
 #include <pwd.h>
 #include <unistd.h>
+#include <sys/mman.h>
 #endif
 
 #if defined(__APPLE__)
@@ -707,6 +709,7 @@ const std::string& GetUserPath(UserPath path, const std::string& new_path) {
         paths.emplace(UserPath::NANDDir, user_path + NAND_DIR DIR_SEP);
         paths.emplace(UserPath::SysDataDir, user_path + SYSDATA_DIR DIR_SEP);
         paths.emplace(UserPath::KeysDir, user_path + KEYS_DIR DIR_SEP);
+        paths.emplace(UserPath::LoadDir, user_path + LOAD_DIR DIR_SEP);
         // TODO: Put the logs in a better location for each OS
         paths.emplace(UserPath::LogDir, user_path + LOG_DIR DIR_SEP);
     }
@@ -730,6 +733,7 @@ const std::string& GetUserPath(UserPath path, const std::string& new_path) {
             paths[UserPath::CacheDir] = user_path + CACHE_DIR DIR_SEP;
             paths[UserPath::SDMCDir] = user_path + SDMC_DIR DIR_SEP;
             paths[UserPath::NANDDir] = user_path + NAND_DIR DIR_SEP;
+            paths[UserPath::LoadDir] = user_path + LOAD_DIR DIR_SEP;
             break;
         }
     }
@@ -992,4 +996,65 @@ bool IOFile::Resize(u64 size) {
         ;
 }
 
+MappedFile::MappedFile(const std::string& filename) {
+#ifdef _WIN32
+    const HANDLE file = CreateFileW(Common::UTF8ToUTF16W(filename).c_str(), GENERIC_READ,
+                                    FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+                                    FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return;
+    }
+
+    LARGE_INTEGER file_size;
+    if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+        // The mapping keeps its own reference to the file
+        mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping != nullptr) {
+            data = static_cast<const u8*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            size = static_cast<std::size_t>(file_size.QuadPart);
+        }
+    }
+    CloseHandle(file);
+
+    if (data == nullptr && mapping != nullptr) {
+        CloseHandle(mapping);
+        mapping = nullptr;
+    }
+#else
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+
+    struct stat file_info;
+    if (fstat(fd, &file_info) == 0 && file_info.st_size > 0) {
+        void* const view = mmap(nullptr, static_cast<std::size_t>(file_info.st_size), PROT_READ,
+                                MAP_SHARED, fd, 0);
+        if (view != MAP_FAILED) {
+            data = static_cast<const u8*>(view);
+            size = static_cast<std::size_t>(file_info.st_size);
+        }
+    }
+    // The mapping keeps its own reference to the file
+    close(fd);
+#endif
+
+    if (data == nullptr) {
+        size = 0;
+        LOG_DEBUG(Common_Filesystem, "Failed to map {}", filename);
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (data == nullptr) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle(mapping);
+#else
+    munmap(const_cast<u8*>(data), size);
+#endif
+}
+
 } // namespace FileUtil
@@ -25,6 +25,7 @@ enum class UserPath {
     CacheDir,
     ConfigDir,
     KeysDir,
+    LoadDir,
     LogDir,
     NANDDir,
     RootDir,
@@ -277,6 +278,33 @@ private:
     std::FILE* m_file = nullptr;
 };
 
+// A read-only view of a whole file mapped in memory. Reads are served by the OS page cache, and
+// the data stays valid for the lifetime of the object.
+class MappedFile : public NonCopyable {
+public:
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    bool IsOpen() const {
+        return data != nullptr;
+    }
+
+    const u8* GetData() const {
+        return data;
+    }
+
+    std::size_t GetSize() const {
+        return size;
+    }
+
+private:
+    const u8* data = nullptr;
+    std::size_t size = 0;
+#ifdef _WIN32
+    void* mapping = nullptr;
+#endif
+};
+
 } // namespace FileUtil
 
 // To deal with Windows being dumb at unicode:
@@ -0,0 +1,242 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#include "common/assert.h"
+#include "common/hash.h"
+
+namespace Common {
+
+namespace {
+
+constexpr std::size_t STRIPE_SIZE = HashStream64::STRIPE_SIZE;
+constexpr std::size_t BLOCK_SIZE = WIDE_HASH_THRESHOLD;
+constexpr std::size_t STRIPES_PER_BLOCK = BLOCK_SIZE / STRIPE_SIZE;
+constexpr std::size_t NUM_LANES = STRIPE_SIZE / sizeof(u64);
+
+using Accumulators = std::array<u64, NUM_LANES>;
+
+constexpr u64 PRIME32_1 = 0x9E3779B1;
+constexpr u64 PRIME64_1 = 0x9E3779B185EBCA87;
+
+constexpr Accumulators INITIAL_ACCUMULATORS{
+    0xEED940DAD9E9C06D, 0x8977E93646524825, 0xA9897F0A62A51616, 0xA35D4250C53F2B3A,
+    0x4072542A94B9C33E, 0x3154A7A62447E8AB, 0x686865712A1A245E, 0x0FBA67727D7B3B98,
+};
+
+/// Keys mixed into the lanes, each stripe of a block uses the ones starting at its index
+constexpr std::array<u64, STRIPES_PER_BLOCK + NUM_LANES> STRIPE_KEYS{
+    0x2CB0F69F4ABEA221, 0x9417034723148989, 0xDD555950609DFE03, 0xDBAFB150DEB12800,
+    0x7E789B2E6C442CB6, 0xF41E5636C7E4F8C4, 0x0959D150F8FBA7E4, 0xA97316F13CDB9EEA,
+    0x74CD8258F9520068, 0x55C74A62E116868B, 0xD2F4C799A2023CBD, 0xDF98CB79A37B51B9,
+    0x396F5885524F3905, 0xAF1D56386CA3B276, 0xA9FFBE6B5104E85A, 0x6BD0C51B9FD533B3,
+    0x980CE91C50AB4B56, 0x28AC395780FE62C5, 0x768912E3A6BCEDC7, 0x50B3E8C9332C7C88,
+    0xCE3BBFE520BD47DA, 0xCBA6C8E8E0BB7C4F, 0xBF194DB8434A346D, 0x7D8F2A7B60416D7F,
+};
+
+/// Keys of the last stripe of the input, which overlaps the stripes before it
+constexpr std::size_t LAST_STRIPE_KEYS = 7;
+
+constexpr Accumulators SCRAMBLE_KEYS{
+    0x0849D1F6E0E10A5E, 0x7654B590D064E22F, 0x16D1DA9507DF3AF2, 0xF63AEF1089EA30E4,
+    0x9ADE6673CC6C522B, 0x4C75BC274E37087C, 0xD35E12B49F51F27B, 0x22DDF2FFCEE481EA,
+};
+
+constexpr Accumulators MERGE_KEYS{
+    0x06007FB13C59A1F1, 0x8966A38C651EA4DA, 0x25242F018FC01AC6, 0xA73EC74FA31B717C,
+    0x7EE0ABDD9797D3A2, 0x5C06FF7DC4AC1880, 0x8434E41042C28A7D, 0x770A372D64327351,
+};
+
+#ifdef ARCHITECTURE_x86_64
+/// Adds 16 bytes of a stripe to a pair of lanes
+inline __m128i AccumulatePair(__m128i lanes, const u8* data, const u64* keys) {
+    const __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    const __m128i keyed =
+        _mm_xor_si128(input, _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys)));
+    const __m128i product =
+        _mm_mul_epu32(keyed, _mm_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1)));
+    const __m128i swapped = _mm_shuffle_epi32(input, _MM_SHUFFLE(1, 0, 3, 2));
+    return _mm_add_epi64(lanes, _mm_add_epi64(product, swapped));
+}
+#else
+u64 Read64(const u8* data) {
+    u64 value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+#endif
+
+/**
+ * Adds consecutive stripes to the accumulators, the first one keyed with the keys starting at
+ * first_key. Each lane multiplies the halves of its keyed input, and the input itself is added to
+ * the neighbouring lane so that no input bit is lost to the multiply.
+ */
+void AccumulateStripes(Accumulators& acc, const u8* data, std::size_t num_stripes,
+                       std::size_t first_key = 0) {
+#ifdef ARCHITECTURE_x86_64
+    // The lanes are kept in registers, as the input could alias the accumulators otherwise
+    __m128i* const pairs = reinterpret_cast<__m128i*>(acc.data());
+    __m128i lanes_01 = _mm_loadu_si128(pairs + 0);
+    __m128i lanes_23 = _mm_loadu_si128(pairs + 1);
+    __m128i lanes_45 = _mm_loadu_si128(pairs + 2);
+    __m128i lanes_67 = _mm_loadu_si128(pairs + 3);
+    for (std::size_t stripe = 0; stripe < num_stripes; ++stripe) {
+        const u8* const stripe_data = data + stripe * STRIPE_SIZE;
+        const u64* const keys = &STRIPE_KEYS[first_key + stripe];
+        lanes_01 = AccumulatePair(lanes_01, stripe_data + 0, keys + 0);
+        lanes_23 = AccumulatePair(lanes_23, stripe_data + 16, keys + 2);
+        lanes_45 = AccumulatePair(lanes_45, stripe_data + 32, keys + 4);
+        lanes_67 = AccumulatePair(lanes_67, stripe_data + 48, keys + 6);
+    }
+    _mm_storeu_si128(pairs + 0, lanes_01);
+    _mm_storeu_si128(pairs + 1, lanes_23);
+    _mm_storeu_si128(pairs + 2, lanes_45);
+    _mm_storeu_si128(pairs + 3, lanes_67);
+#else
+    Accumulators lanes = acc;
+    for (std::size_t stripe = 0; stripe < num_stripes; ++stripe) {
+        const u8* const stripe_data = data + stripe * STRIPE_SIZE;
+        const u64* const keys = &STRIPE_KEYS[first_key + stripe];
+        for (std::size_t lane = 0; lane < NUM_LANES; ++lane) {
+            const u64 input = Read64(stripe_data + lane * 8);
+            const u64 keyed = input ^ keys[lane];
+            lanes[lane ^ 1] += input;
+            lanes[lane] += (keyed & 0xFFFFFFFF) * (keyed >> 32);
+        }
+    }
+    acc = lanes;
+#endif
+}
+
+/// Folds the high bits of the accumulators back into the low ones after each block
+void ScrambleAccumulators(Accumulators& acc) {
+    for (std::size_t lane = 0; lane < NUM_LANES; ++lane) {
+        u64 value = acc[lane];
+        value ^= value >> 47;
+        value ^= SCRAMBLE_KEYS[lane];
+        acc[lane] = value * PRIME32_1;
+    }
+}
+
+void AccumulateBlock(Accumulators& acc, const u8* data) {
+    AccumulateStripes(acc, data, STRIPES_PER_BLOCK);
+    ScrambleAccumulators(acc);
+}
+
+/// Multiplies two 64-bit values into 128 bits and xors both halves of the product
+u64 Mul128Fold64(u64 a, u64 b) {
+#if defined(_MSC_VER) && defined(ARCHITECTURE_x86_64)
+    u64 high;
+    const u64 low = _umul128(a, b, &high);
+    return low ^ high;
+#elif defined(__SIZEOF_INT128__)
+    const unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+    return static_cast<u64>(product) ^ static_cast<u64>(product >> 64);
+#else
+    const u64 a_low = a & 0xFFFFFFFF;
+    const u64 a_high = a >> 32;
+    const u64 b_low = b & 0xFFFFFFFF;
+    const u64 b_high = b >> 32;
+    const u64 low_low = a_low * b_low;
+    const u64 high_low = a_high * b_low;
+    const u64 cross = (low_low >> 32) + (high_low & 0xFFFFFFFF) + a_low * b_high;
+    const u64 high = (high_low >> 32) + (cross >> 32) + a_high * b_high;
+    const u64 low = (cross << 32) | (low_low & 0xFFFFFFFF);
+    return low ^ high;
+#endif
+}
+
+/**
+ * Adds the tail of the input to a copy of the accumulators and merges them into the hash
+ * @param tail The input after the last whole block that was accumulated, 1 to BLOCK_SIZE bytes
+ * @param last_stripe The last STRIPE_SIZE bytes of the input, which may start before the tail
+ */
+u64 Finalize(Accumulators acc, const u8* tail, std::size_t tail_size, const u8* last_stripe,
+             u64 total_size) {
+    AccumulateStripes(acc, tail, (tail_size - 1) / STRIPE_SIZE);
+    AccumulateStripes(acc, last_stripe, 1, LAST_STRIPE_KEYS);
+
+    u64 hash = total_size * PRIME64_1;
+    for (std::size_t lane = 0; lane < NUM_LANES; lane += 2) {
+        hash += Mul128Fold64(acc[lane] ^ MERGE_KEYS[lane], acc[lane + 1] ^ MERGE_KEYS[lane + 1]);
+    }
+    hash ^= hash >> 37;
+    hash *= 0x165667919E3779F9;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+} // Anonymous namespace
+
+u64 ComputeWideHash64(const void* data, std::size_t len) {
+    ASSERT(len >= WIDE_HASH_THRESHOLD);
+    const u8* const bytes = static_cast<const u8*>(data);
+
+    // The last block is finalized as the tail, which is what HashStream64 does as well since it
+    // can't tell whether more input follows a whole block until it's given some
+    Accumulators acc = INITIAL_ACCUMULATORS;
+    const std::size_t num_blocks = (len - 1) / BLOCK_SIZE;
+    for (std::size_t block = 0; block < num_blocks; ++block) {
+        AccumulateBlock(acc, bytes + block * BLOCK_SIZE);
+    }
+    const std::size_t tail_offset = num_blocks * BLOCK_SIZE;
+    return Finalize(acc, bytes + tail_offset, len - tail_offset, bytes + len - STRIPE_SIZE, len);
+}
+
+HashStream64::HashStream64() {
+    Reset();
+}
+
+void HashStream64::Reset() {
+    accumulators = INITIAL_ACCUMULATORS;
+    buffered = 0;
+    total_size = 0;
+}
+
+void HashStream64::Update(const void* data, std::size_t len) {
+    const u8* bytes = static_cast<const u8*>(data);
+    total_size += len;
+
+    while (len > 0) {
+        if (buffered == BLOCK_SIZE) {
+            // More input follows the buffered block, so it isn't the tail
+            AccumulateBlock(accumulators, buffer.data() + STRIPE_SIZE);
+            std::memcpy(buffer.data(), buffer.data() + BLOCK_SIZE, STRIPE_SIZE);
+            buffered = 0;
+        }
+        if (buffered == 0 && len > BLOCK_SIZE) {
+            // Whole blocks are accumulated straight from the input, without copying them
+            do {
+                AccumulateBlock(accumulators, bytes);
+                bytes += BLOCK_SIZE;
+                len -= BLOCK_SIZE;
+            } while (len > BLOCK_SIZE);
+            std::memcpy(buffer.data(), bytes - STRIPE_SIZE, STRIPE_SIZE);
+        }
+
+        const std::size_t copy_size = std::min(len, BLOCK_SIZE - buffered);
+        std::memcpy(buffer.data() + STRIPE_SIZE + buffered, bytes, copy_size);
+        buffered += copy_size;
+        bytes += copy_size;
+        len -= copy_size;
+    }
+}
+
+u64 HashStream64::Digest() const {
+    const u8* const tail = buffer.data() + STRIPE_SIZE;
+    if (total_size < WIDE_HASH_THRESHOLD) {
+        // Nothing was accumulated yet, the whole input is buffered
+        return CityHash64(reinterpret_cast<const char*>(tail), buffered);
+    }
+    return Finalize(accumulators, tail, buffered, tail + buffered - STRIPE_SIZE, total_size);
+}
+
+} // namespace Common
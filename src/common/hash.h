@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <array>
 #include <cstddef>
 #include <cstring>
 #include "common/cityhash.h"
@@ -11,6 +12,16 @@
 
 namespace Common {
 
+/// Inputs of at least this many bytes are hashed with ComputeWideHash64 instead of CityHash64
+constexpr std::size_t WIDE_HASH_THRESHOLD = 1024;
+
+/**
+ * Computes a 64-bit hash of a large block of data, at least WIDE_HASH_THRESHOLD bytes long. The
+ * data is read 64 bytes at a time into eight independent lanes, which the compiler or SSE2 can
+ * process side by side, making it several times faster than CityHash64 on large data.
+ */
+u64 ComputeWideHash64(const void* data, std::size_t len);
+
 /**
  * Computes a 64-bit hash over the specified block of data
  * @param data Block of data to compute hash over
@@ -18,9 +29,41 @@ namespace Common {
  * @returns 64-bit hash value that was computed over the data block
  */
 static inline u64 ComputeHash64(const void* data, std::size_t len) {
+    if (len >= WIDE_HASH_THRESHOLD) {
+        return ComputeWideHash64(data, len);
+    }
     return CityHash64(static_cast<const char*>(data), len);
 }
 
+/**
+ * Computes the same hash as ComputeHash64 over data given in pieces, so that large data such as
+ * textures can be hashed as it's read, without gathering it in a single buffer first.
+ */
+class HashStream64 {
+public:
+    static constexpr std::size_t STRIPE_SIZE = 64;
+
+    HashStream64();
+
+    /// Appends data to the hashed input
+    void Update(const void* data, std::size_t len);
+
+    /// Returns the hash of the input given so far, more of it can be appended afterwards
+    u64 Digest() const;
+
+    /// Starts hashing a new input
+    void Reset();
+
+private:
+    std::array<u64, STRIPE_SIZE / sizeof(u64)> accumulators;
+    /// The last stripe of the previously accumulated block, followed by the block being filled.
+    /// A full block is only accumulated once more input follows it, as the last one is hashed
+    /// differently.
+    std::array<u8, STRIPE_SIZE + WIDE_HASH_THRESHOLD> buffer;
+    std::size_t buffered;
+    u64 total_size;
+};
+
 /**
  * Computes a 64-bit hash of a struct. In addition to being trivially copyable, it is also critical
  * that either the struct includes no padding, or that any padding is initialized to a known value
@@ -7,9 +7,11 @@
 #include <chrono>
 #include <climits>
 #include <condition_variable>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <utility>
 #include <vector>
 #ifdef _WIN32
 #include <share.h> // For _SH_DENYWR
@@ -25,6 +27,114 @@
 
 namespace Log {
 
+/**
+ * A message that wasn't formatted yet. Everything costly to build an Entry, like formatting the
+ * message or trimming the source path, is left to the logging thread.
+ */
+struct PendingEntry {
+    std::chrono::microseconds timestamp;
+    Class log_class;
+    Level log_level;
+    const char* filename;
+    unsigned int line_num;
+    const char* function;
+    const char* format;
+    std::unique_ptr<FormatArguments> args;
+};
+
+static std::chrono::microseconds GetTimestamp() {
+    using std::chrono::duration_cast;
+    using std::chrono::steady_clock;
+
+    static steady_clock::time_point time_origin = steady_clock::now();
+    return duration_cast<std::chrono::microseconds>(steady_clock::now() - time_origin);
+}
+
+/// Formats a pending message into an entry
+static Entry ResolveEntry(const PendingEntry& pending) {
+    std::string message;
+    try {
+        message = pending.args->Format(pending.format);
+    } catch (const fmt::format_error& error) {
+        message = fmt::format("Failed to format \"{}\": {}", pending.format, error.what());
+    }
+
+    Entry entry;
+    entry.timestamp = pending.timestamp;
+    entry.log_class = pending.log_class;
+    entry.log_level = pending.log_level;
+    entry.filename = Common::TrimSourcePath(pending.filename);
+    entry.line_num = pending.line_num;
+    entry.function = pending.function;
+    entry.message = std::move(message);
+    return entry;
+}
+
+/**
+ * Drops the messages of call sites that log too often, and replaces them with a count of how many
+ * were dropped once the call site calms down.
+ */
+class RateLimiter {
+public:
+    /// Returns whether the message should be written, writes the summary of the messages
+    /// previously dropped from the same call site if there are any
+    template <typename WriteFunc>
+    bool Check(const PendingEntry& entry, WriteFunc&& write) {
+        CallSite& site = call_sites[{entry.filename, entry.line_num}];
+        if (entry.timestamp - site.window_start >= Window) {
+            WriteSummary(site, write);
+            site.window_start = entry.timestamp;
+            site.count = 0;
+        }
+        if (++site.count <= MaxMessagesPerWindow) {
+            return true;
+        }
+        site.dropped++;
+        site.last = {entry.timestamp, entry.log_class, entry.log_level, entry.filename,
+                     entry.line_num,  entry.function,  nullptr,         nullptr};
+        return false;
+    }
+
+    /// Writes the summaries of the call sites whose window ended, or all of them when `all` is set
+    template <typename WriteFunc>
+    void WriteSummaries(std::chrono::microseconds now, bool all, WriteFunc&& write) {
+        for (auto& [key, site] : call_sites) {
+            if (all || now - site.window_start >= Window) {
+                WriteSummary(site, write);
+            }
+        }
+    }
+
+private:
+    static constexpr std::chrono::microseconds Window{std::chrono::seconds{1}};
+    static constexpr u32 MaxMessagesPerWindow = 20;
+
+    struct CallSite {
+        std::chrono::microseconds window_start{};
+        /// Messages logged since the window started
+        u32 count = 0;
+        u32 dropped = 0;
+        /// The last dropped message, without its arguments
+        PendingEntry last{};
+    };
+
+    template <typename WriteFunc>
+    static void WriteSummary(CallSite& site, WriteFunc&& write) {
+        if (site.dropped == 0) {
+            return;
+        }
+        const PendingEntry& last = site.last;
+        Entry entry = CreateEntry(last.log_class, last.log_level, last.filename, last.line_num,
+                                  last.function,
+                                  fmt::format("Previous message repeated {} times", site.dropped));
+        entry.timestamp = last.timestamp;
+        write(entry);
+        site.dropped = 0;
+    }
+
+    std::map<std::pair<const char*, unsigned int>, CallSite> call_sites;
+};
+
 /**
  * Static state as a singleton.
  */
@@ -38,10 +148,16 @@ public:
     Impl(Impl const&) = delete;
     const Impl& operator=(Impl const&) = delete;
 
-    void PushEntry(Entry e) {
-        std::lock_guard<std::mutex> lock(message_mutex);
+    void PushEntry(PendingEntry e) {
         message_queue.Push(std::move(e));
-        message_cv.notify_one();
+        // The logging thread drains the whole queue whenever it wakes up, so it only has to be
+        // woken when it's waiting. Pairs with the fence in the logging thread, either it sees the
+        // new entry or this sees it waiting.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (consumer_waiting.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(message_mutex);
+            message_cv.notify_one();
+        }
     }
 
     void AddBackend(std::unique_ptr<Backend> backend) {
@@ -77,45 +193,83 @@ public:
 private:
     Impl() {
         backend_thread = std::thread([&] {
-            Entry entry;
-            auto write_logs = [&](Entry& e) {
-                std::lock_guard<std::mutex> lock(writing_mutex);
+            PendingEntry entry;
+            RateLimiter rate_limiter;
+            // These are called with writing_mutex held
+            auto write_entry = [&](const Entry& e) {
                 for (const auto& backend : backends) {
                     backend->Write(e);
                 }
             };
+            auto write_logs = [&](const PendingEntry& pending) {
+                if (rate_limiter.Check(pending, write_entry)) {
+                    write_entry(ResolveEntry(pending));
+                }
+            };
+            auto flush_backends = [&] {
+                for (const auto& backend : backends) {
+                    backend->Flush();
+                }
+            };
             while (true) {
+                bool has_entry = false;
                 {
                     std::unique_lock<std::mutex> lock(message_mutex);
-                    message_cv.wait(lock, [&] { return !running || message_queue.Pop(entry); });
+                    consumer_waiting.store(true, std::memory_order_relaxed);
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    // Wakes up regularly even without messages, to write the summaries of the
+                    // call sites that stopped logging
+                    message_cv.wait_for(lock, std::chrono::seconds{1}, [&] {
+                        has_entry = message_queue.Pop(entry);
+                        return has_entry || !running;
+                    });
+                    consumer_waiting.store(false, std::memory_order_relaxed);
+                }
+
+                // Everything queued is written at once under a single lock, then the backends are
+                // flushed, so a burst of messages costs a single wake up and a single flush
+                std::lock_guard<std::mutex> lock(writing_mutex);
+                if (has_entry) {
+                    do {
+                        write_logs(entry);
+                    } while (running && message_queue.Pop(entry));
                 }
                 if (!running) {
                     break;
                 }
-                write_logs(entry);
+                rate_limiter.WriteSummaries(GetTimestamp(), false, write_entry);
+                flush_backends();
             }
             // Drain the logging queue. Only writes out up to MAX_LOGS_TO_WRITE to prevent a case
             // where a system is repeatedly spamming logs even on close.
+            std::lock_guard<std::mutex> lock(writing_mutex);
             const int MAX_LOGS_TO_WRITE = filter.IsDebug() ? INT_MAX : 100;
             int logs_written = 0;
             while (logs_written++ < MAX_LOGS_TO_WRITE && message_queue.Pop(entry)) {
                 write_logs(entry);
             }
+            rate_limiter.WriteSummaries(GetTimestamp(), true, write_entry);
+            flush_backends();
         });
     }
 
     ~Impl() {
-        running = false;
+        {
+            std::lock_guard<std::mutex> lock(message_mutex);
+            running = false;
+        }
         message_cv.notify_one();
         backend_thread.join();
     }
 
     std::atomic_bool running{true};
+    /// Whether the logging thread is waiting for messages and needs to be notified
+    std::atomic_bool consumer_waiting{false};
     std::mutex message_mutex, writing_mutex;
     std::condition_variable message_cv;
     std::thread backend_thread;
     std::vector<std::unique_ptr<Backend>> backends;
-    Common::MPSCQueue<Log::Entry> message_queue;
+    Common::MPSCQueue<PendingEntry> message_queue;
     Filter filter;
 };
 
@@ -140,7 +294,10 @@ void FileBackend::Write(const Entry& entry) {
         return;
     }
     bytes_written += file.WriteString(FormatLogMessage(entry) + '\n');
-    if (entry.log_level >= Level::Error) {
+}
+
+void FileBackend::Flush() {
+    if (file.IsOpen()) {
         file.Flush();
     }
 }
@@ -266,13 +423,8 @@ const char* GetLevelName(Level log_level) {
 
 Entry CreateEntry(Class log_class, Level log_level, const char* filename, unsigned int line_nr,
                   const char* function, std::string message) {
-    using std::chrono::duration_cast;
-    using std::chrono::steady_clock;
-
-    static steady_clock::time_point time_origin = steady_clock::now();
-
     Entry entry;
-    entry.timestamp = duration_cast<std::chrono::microseconds>(steady_clock::now() - time_origin);
+    entry.timestamp = GetTimestamp();
     entry.log_class = log_class;
     entry.log_level = log_level;
     entry.filename = Common::TrimSourcePath(filename);
@@ -299,17 +451,14 @@ Backend* GetBackend(std::string_view backend_name) {
     return Impl::Instance().GetBackend(backend_name);
 }
 
-void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
-                       unsigned int line_num, const char* function, const char* format,
-                       const fmt::format_args& args) {
-    auto& instance = Impl::Instance();
-    const auto& filter = instance.GetGlobalFilter();
-    if (!filter.CheckMessage(log_class, log_level))
-        return;
-
-    Entry entry =
-        CreateEntry(log_class, log_level, filename, line_num, function, fmt::vformat(format, args));
+bool IsLogEnabled(Class log_class, Level log_level) {
+    return Impl::Instance().GetGlobalFilter().CheckMessage(log_class, log_level);
+}
 
-    instance.PushEntry(std::move(entry));
+void DeferredLogMessageImpl(Class log_class, Level log_level, const char* filename,
+                            unsigned int line_num, const char* function, const char* format,
+                            std::unique_ptr<FormatArguments> args) {
+    Impl::Instance().PushEntry({GetTimestamp(), log_class, log_level, filename, line_num, function,
+                                format, std::move(args)});
 }
 } // namespace Log
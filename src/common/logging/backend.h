@@ -47,6 +47,8 @@ public:
     }
     virtual const char* GetName() const = 0;
     virtual void Write(const Entry& entry) = 0;
+    /// Called once the queued entries were written, so that writes can be batched
+    virtual void Flush() {}
 
 private:
     Filter filter;
@@ -97,6 +99,7 @@ public:
     }
 
     void Write(const Entry& entry) override;
+    void Flush() override;
 
 private:
     FileUtil::IOFile file;
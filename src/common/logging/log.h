@@ -4,6 +4,11 @@
 
 #pragma once
 
+#include <memory>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
 #include <fmt/format.h>
 #include "common/common_types.h"
 
@@ -119,16 +124,86 @@ enum class Class : ClassType {
     Count              ///< Total number of logging classes
 };
 
-/// Logs a message to the global logger, using fmt
-void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
-                       unsigned int line_num, const char* function, const char* format,
-                       const fmt::format_args& args);
+/// Arguments of a log message, kept until the logging thread formats the message
+class FormatArguments {
+public:
+    virtual ~FormatArguments() = default;
+    virtual std::string Format(const char* format) const = 0;
+};
+
+namespace Detail {
+
+/// Type an argument is kept as. Strings are copied, as what they point to may not outlive the call.
+template <typename T>
+struct StoredArgument {
+    using Type = std::decay_t<T>;
+};
+template <>
+struct StoredArgument<char*> {
+    using Type = std::string;
+};
+template <>
+struct StoredArgument<const char*> {
+    using Type = std::string;
+};
+template <>
+struct StoredArgument<std::string_view> {
+    using Type = std::string;
+};
+template <>
+struct StoredArgument<unsigned char*> {
+    using Type = std::string;
+};
+template <>
+struct StoredArgument<const unsigned char*> {
+    using Type = std::string;
+};
+
+/// Converts an argument to the type it's kept as, byte strings are formatted as C strings
+template <typename T>
+const T& StoreArgument(const T& value) {
+    return value;
+}
+inline std::string StoreArgument(const unsigned char* value) {
+    return reinterpret_cast<const char*>(value);
+}
+inline std::string StoreArgument(unsigned char* value) {
+    return reinterpret_cast<const char*>(value);
+}
+
+template <typename... Args>
+class FormatArgumentsImpl final : public FormatArguments {
+public:
+    explicit FormatArgumentsImpl(const Args&... args) : args{StoreArgument(args)...} {}
+
+    std::string Format(const char* format) const override {
+        return std::apply([format](const auto&... args) { return fmt::format(format, args...); },
+                          args);
+    }
+
+private:
+    std::tuple<typename StoredArgument<std::decay_t<Args>>::Type...> args;
+};
+
+} // namespace Detail
+
+/// Returns whether the global filter lets messages of the given class and level through
+bool IsLogEnabled(Class log_class, Level log_level);
+
+/// Logs a message to the global logger, which formats it on the logging thread
+void DeferredLogMessageImpl(Class log_class, Level log_level, const char* filename,
+                            unsigned int line_num, const char* function, const char* format,
+                            std::unique_ptr<FormatArguments> args);
 
+/// Logs a message to the global logger, using fmt. Formatting the message is left to the logging
+/// thread, only the arguments are copied here.
 template <typename... Args>
 void FmtLogMessage(Class log_class, Level log_level, const char* filename, unsigned int line_num,
                    const char* function, const char* format, const Args&... args) {
-    FmtLogMessageImpl(log_class, log_level, filename, line_num, function, format,
-                      fmt::make_format_args(args...));
+    if (!IsLogEnabled(log_class, log_level))
+        return;
+    DeferredLogMessageImpl(log_class, log_level, filename, line_num, function, format,
+                           std::make_unique<Detail::FormatArgumentsImpl<Args...>>(args...));
 }
 
 } // namespace Log
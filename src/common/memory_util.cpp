@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <cstdlib>
 #include "common/logging/log.h"
 #include "common/memory_util.h"
 
@@ -12,7 +13,6 @@
 #include "common/common_funcs.h"
 #include "common/string_util.h"
 #else
-#include <cstdlib>
 #include <sys/mman.h>
 #endif
 
@@ -152,6 +152,49 @@ void UnWriteProtectMemory(void* ptr, std::size_t size, bool allowExecute) {
 #endif
 }
 
+namespace Common {
+
+namespace {
+/// Allocations from this size on get their own host mapping
+constexpr std::size_t HOST_MAPPING_THRESHOLD = 0x10000;
+} // Anonymous namespace
+
+void* AllocateZeroedMemory(std::size_t size) {
+    if (size < HOST_MAPPING_THRESHOLD) {
+        // calloc(0) may return nullptr, which would look like a failure
+        return std::calloc(size == 0 ? 1 : size, 1);
+    }
+#ifdef _WIN32
+    // Committed pages only get physical memory and are zeroed when they are first accessed
+    return VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+    int flags = MAP_ANON | MAP_PRIVATE;
+#ifdef MAP_NORESERVE
+    // Don't count the whole mapping against the overcommit limit, most of it is never touched
+    flags |= MAP_NORESERVE;
+#endif
+    void* const ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+    return ptr == MAP_FAILED ? nullptr : ptr;
+#endif
+}
+
+void FreeZeroedMemory(void* ptr, std::size_t size) {
+    if (ptr == nullptr) {
+        return;
+    }
+    if (size < HOST_MAPPING_THRESHOLD) {
+        std::free(ptr);
+        return;
+    }
+#ifdef _WIN32
+    VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+    munmap(ptr, size);
+#endif
+}
+
+} // namespace Common
+
 std::string MemUsage() {
 #ifdef _WIN32
 #pragma comment(lib, "psapi")
@@ -5,7 +5,11 @@
 #pragma once
 
 #include <cstddef>
+#include <new>
 #include <string>
+#include <utility>
+#include <vector>
+#include "common/common_types.h"
 
 void* AllocateExecutableMemory(std::size_t size, bool low = true);
 void* AllocateMemoryPages(std::size_t size);
@@ -19,3 +23,67 @@ std::string MemUsage();
 inline int GetPageSize() {
     return 4096;
 }
+
+namespace Common {
+
+/**
+ * Allocates zero-filled memory. Large allocations are mapped straight from the host, whose pages
+ * are only backed by physical memory once they are first touched.
+ */
+void* AllocateZeroedMemory(std::size_t size);
+void FreeZeroedMemory(void* ptr, std::size_t size);
+
+/**
+ * Allocator for the buffers backing guest memory, which can be gigabytes large but are mostly
+ * never touched. The memory is zero-filled on demand by the host and default constructing the
+ * elements doesn't write to it, so creating or growing a buffer with resize() doesn't commit it.
+ * Shrinking a buffer and growing it back keeps the old contents of the elements in between.
+ */
+template <typename T>
+class DemandZeroAllocator {
+public:
+    using value_type = T;
+
+    DemandZeroAllocator() = default;
+
+    template <typename U>
+    DemandZeroAllocator(const DemandZeroAllocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        void* const ptr = AllocateZeroedMemory(n * sizeof(T));
+        if (ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T* ptr, std::size_t n) noexcept {
+        FreeZeroedMemory(ptr, n * sizeof(T));
+    }
+
+    /// Default initialization, so the memory keeps the zeroes it was allocated with
+    template <typename U>
+    void construct(U* ptr) {
+        ::new (static_cast<void*>(ptr)) U;
+    }
+
+    template <typename U, typename... Args>
+    void construct(U* ptr, Args&&... args) {
+        ::new (static_cast<void*>(ptr)) U(std::forward<Args>(args)...);
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const DemandZeroAllocator<T>&, const DemandZeroAllocator<U>&) {
+    return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const DemandZeroAllocator<T>&, const DemandZeroAllocator<U>&) {
+    return false;
+}
+
+/// Byte buffer backing guest memory
+using DemandZeroBuffer = std::vector<u8, DemandZeroAllocator<u8>>;
+
+} // namespace Common
@@ -32,27 +32,65 @@ class RingBuffer {
     static_assert(std::atomic<std::size_t>::is_always_lock_free);
 
 public:
+    /// Slots accessed in place. They are contiguous unless they wrap around the end of the buffer,
+    /// in which case the rest of them is at the start of it.
+    template <typename Pointer>
+    struct Spans {
+        Pointer first;
+        std::size_t first_count;  ///< Number of slots at `first`
+        Pointer second;
+        std::size_t second_count; ///< Number of slots at `second`
+
+        std::size_t Size() const {
+            return first_count + second_count;
+        }
+    };
+
+    /// Reserves free slots to be written in place, they are pushed by CommitWrite
+    /// @param max_slots  Maximum number of slots to reserve
+    /// @returns The reserved slots, there may be less of them than requested
+    Spans<T*> ReserveWrite(std::size_t max_slots = ~std::size_t(0)) {
+        const std::size_t write_index = m_write_index.load();
+        const std::size_t slots_free = capacity + m_read_index.load() - write_index;
+        return MakeSpans(m_data.data(), write_index, std::min(max_slots, slots_free));
+    }
+
+    /// Pushes slots written in place, which must have been reserved by ReserveWrite
+    /// @param slot_count  Number of slots to push
+    void CommitWrite(std::size_t slot_count) {
+        m_write_index.store(m_write_index.load() + slot_count);
+    }
+
+    /// Peeks at filled slots to read them in place, they are popped by Consume
+    /// @param max_slots  Maximum number of slots to peek at
+    /// @returns The filled slots, there may be less of them than requested
+    Spans<const T*> Peek(std::size_t max_slots = ~std::size_t(0)) const {
+        const std::size_t read_index = m_read_index.load();
+        const std::size_t slots_filled = m_write_index.load() - read_index;
+        return MakeSpans(m_data.data(), read_index, std::min(max_slots, slots_filled));
+    }
+
+    /// Pops slots read in place, which must have been returned by Peek
+    /// @param slot_count  Number of slots to pop
+    void Consume(std::size_t slot_count) {
+        m_read_index.store(m_read_index.load() + slot_count);
+    }
+
     /// Pushes slots into the ring buffer
     /// @param new_slots   Pointer to the slots to push
     /// @param slot_count  Number of slots to push
     /// @returns The number of slots actually pushed
     std::size_t Push(const void* new_slots, std::size_t slot_count) {
-        const std::size_t write_index = m_write_index.load();
-        const std::size_t slots_free = capacity + m_read_index.load() - write_index;
-        const std::size_t push_count = std::min(slot_count, slots_free);
-
-        const std::size_t pos = write_index % capacity;
-        const std::size_t first_copy = std::min(capacity - pos, push_count);
-        const std::size_t second_copy = push_count - first_copy;
+        const Spans<T*> spans = ReserveWrite(slot_count);
 
         const char* in = static_cast<const char*>(new_slots);
-        std::memcpy(m_data.data() + pos * granularity, in, first_copy * slot_size);
-        in += first_copy * slot_size;
-        std::memcpy(m_data.data(), in, second_copy * slot_size);
+        std::memcpy(spans.first, in, spans.first_count * slot_size);
+        in += spans.first_count * slot_size;
+        std::memcpy(spans.second, in, spans.second_count * slot_size);
 
-        m_write_index.store(write_index + push_count);
+        CommitWrite(spans.Size());
 
-        return push_count;
+        return spans.Size();
     }
 
     std::size_t Push(const std::vector<T>& input) {
@@ -64,22 +102,16 @@ public:
     /// @param max_slots  Maximum number of slots to pop
     /// @returns The number of slots actually popped
     std::size_t Pop(void* output, std::size_t max_slots = ~std::size_t(0)) {
-        const std::size_t read_index = m_read_index.load();
-        const std::size_t slots_filled = m_write_index.load() - read_index;
-        const std::size_t pop_count = std::min(slots_filled, max_slots);
-
-        const std::size_t pos = read_index % capacity;
-        const std::size_t first_copy = std::min(capacity - pos, pop_count);
-        const std::size_t second_copy = pop_count - first_copy;
+        const Spans<const T*> spans = Peek(max_slots);
 
         char* out = static_cast<char*>(output);
-        std::memcpy(out, m_data.data() + pos * granularity, first_copy * slot_size);
-        out += first_copy * slot_size;
-        std::memcpy(out, m_data.data(), second_copy * slot_size);
+        std::memcpy(out, spans.first, spans.first_count * slot_size);
+        out += spans.first_count * slot_size;
+        std::memcpy(out, spans.second, spans.second_count * slot_size);
 
-        m_read_index.store(read_index + pop_count);
+        Consume(spans.Size());
 
-        return pop_count;
+        return spans.Size();
     }
 
     std::vector<T> Pop(std::size_t max_slots = ~std::size_t(0)) {
@@ -100,6 +132,14 @@ public:
     }
 
 private:
+    /// Returns the spans of `count` slots of `data` starting at the given index
+    template <typename Pointer>
+    static Spans<Pointer> MakeSpans(Pointer data, std::size_t index, std::size_t count) {
+        const std::size_t pos = index % capacity;
+        const std::size_t first_count = std::min(capacity - pos, count);
+        return {data + pos * granularity, first_count, data, count - first_count};
+    }
+
     // It is important to align the below variables for performance reasons:
     // Having them on the same cache-line would result in false-sharing between them.
     alignas(128) std::atomic<std::size_t> m_read_index{0};
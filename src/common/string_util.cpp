@@ -8,12 +8,14 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
 #include "common/common_paths.h"
 #include "common/logging/log.h"
 #include "common/string_util.h"
 
 #ifdef _WIN32
-#include <codecvt>
 #include <windows.h>
 #include "common/common_funcs.h"
 #else
@@ -195,32 +197,153 @@ std::string ReplaceAll(std::string result, const std::string& src, const std::st
     return result;
 }
 
-#ifdef _WIN32
+/// U+FFFD, which replaces the invalid sequences of the input
+constexpr char16_t REPLACEMENT_CHARACTER = 0xFFFD;
 
-std::string UTF16ToUTF8(const std::u16string& input) {
-#if _MSC_VER >= 1900
-    // Workaround for missing char16_t/char32_t instantiations in MSVC2015
-    std::wstring_convert<std::codecvt_utf8_utf16<__int16>, __int16> convert;
-    std::basic_string<__int16> tmp_buffer(input.cbegin(), input.cend());
-    return convert.to_bytes(tmp_buffer);
-#else
-    std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t> convert;
-    return convert.to_bytes(input);
+std::size_t UTF8ToUTF16(std::string_view input, char16_t* output) {
+    const char* const data = input.data();
+    const std::size_t size = input.size();
+    char16_t* out = output;
+    std::size_t i = 0;
+    while (i < size) {
+#ifdef ARCHITECTURE_x86_64
+        // Runs of ASCII are widened 16 characters at a time
+        const __m128i zero = _mm_setzero_si128();
+        while (i + 16 <= size) {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            if (_mm_movemask_epi8(chunk) != 0) {
+                break;
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi8(chunk, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), _mm_unpackhi_epi8(chunk, zero));
+            i += 16;
+            out += 16;
+        }
+        if (i == size) {
+            break;
+        }
 #endif
+        const u8 lead = static_cast<u8>(data[i]);
+        if (lead < 0x80) {
+            *out++ = lead;
+            ++i;
+            continue;
+        }
+
+        std::size_t length;
+        char32_t code_point;
+        char32_t min_code_point;
+        if ((lead & 0xE0) == 0xC0) {
+            length = 2;
+            code_point = lead & 0x1F;
+            min_code_point = 0x80;
+        } else if ((lead & 0xF0) == 0xE0) {
+            length = 3;
+            code_point = lead & 0x0F;
+            min_code_point = 0x800;
+        } else if ((lead & 0xF8) == 0xF0) {
+            length = 4;
+            code_point = lead & 0x07;
+            min_code_point = 0x10000;
+        } else {
+            *out++ = REPLACEMENT_CHARACTER;
+            ++i;
+            continue;
+        }
+
+        std::size_t consumed = 1;
+        for (; consumed < length && i + consumed < size; ++consumed) {
+            const u8 continuation = static_cast<u8>(data[i + consumed]);
+            if ((continuation & 0xC0) != 0x80) {
+                break;
+            }
+            code_point = (code_point << 6) | (continuation & 0x3F);
+        }
+        i += consumed;
+
+        // Truncated and overlong sequences, and encoded surrogates are all invalid
+        if (consumed != length || code_point < min_code_point || code_point > 0x10FFFF ||
+            (code_point >= 0xD800 && code_point <= 0xDFFF)) {
+            *out++ = REPLACEMENT_CHARACTER;
+        } else if (code_point >= 0x10000) {
+            code_point -= 0x10000;
+            *out++ = static_cast<char16_t>(0xD800 + (code_point >> 10));
+            *out++ = static_cast<char16_t>(0xDC00 + (code_point & 0x3FF));
+        } else {
+            *out++ = static_cast<char16_t>(code_point);
+        }
+    }
+    return static_cast<std::size_t>(out - output);
 }
 
-std::u16string UTF8ToUTF16(const std::string& input) {
-#if _MSC_VER >= 1900
-    // Workaround for missing char16_t/char32_t instantiations in MSVC2015
-    std::wstring_convert<std::codecvt_utf8_utf16<__int16>, __int16> convert;
-    auto tmp_buffer = convert.from_bytes(input);
-    return std::u16string(tmp_buffer.cbegin(), tmp_buffer.cend());
-#else
-    std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t> convert;
-    return convert.from_bytes(input);
+std::size_t UTF16ToUTF8(std::u16string_view input, char* output) {
+    const char16_t* const data = input.data();
+    const std::size_t size = input.size();
+    char* out = output;
+    std::size_t i = 0;
+    while (i < size) {
+#ifdef ARCHITECTURE_x86_64
+        // Runs of ASCII are narrowed 16 characters at a time
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i non_ascii_bits = _mm_set1_epi16(static_cast<s16>(0xFF80));
+        while (i + 16 <= size) {
+            const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 8));
+            const __m128i non_ascii = _mm_and_si128(_mm_or_si128(low, high), non_ascii_bits);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(non_ascii, zero)) != 0xFFFF) {
+                break;
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(low, high));
+            i += 16;
+            out += 16;
+        }
+        if (i == size) {
+            break;
+        }
 #endif
+        char32_t code_point = data[i++];
+        if (code_point < 0x80) {
+            *out++ = static_cast<char>(code_point);
+            continue;
+        }
+
+        if (code_point >= 0xD800 && code_point <= 0xDBFF && i < size && data[i] >= 0xDC00 &&
+            data[i] <= 0xDFFF) {
+            code_point = 0x10000 + ((code_point - 0xD800) << 10) + (data[i++] - 0xDC00);
+        } else if (code_point >= 0xD800 && code_point <= 0xDFFF) {
+            // Unpaired surrogates can't be encoded
+            code_point = REPLACEMENT_CHARACTER;
+        }
+
+        if (code_point < 0x800) {
+            *out++ = static_cast<char>(0xC0 | (code_point >> 6));
+        } else if (code_point < 0x10000) {
+            *out++ = static_cast<char>(0xE0 | (code_point >> 12));
+            *out++ = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        } else {
+            *out++ = static_cast<char>(0xF0 | (code_point >> 18));
+            *out++ = static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+            *out++ = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        }
+        *out++ = static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+    return static_cast<std::size_t>(out - output);
 }
 
+std::string UTF16ToUTF8(std::u16string_view input) {
+    std::string output(input.size() * MAX_UTF8_UNITS_PER_UTF16_UNIT, '\0');
+    output.resize(UTF16ToUTF8(input, output.data()));
+    return output;
+}
+
+std::u16string UTF8ToUTF16(std::string_view input) {
+    std::u16string output(input.size(), u'\0');
+    output.resize(UTF8ToUTF16(input, output.data()));
+    return output;
+}
+
+#ifdef _WIN32
+
 static std::wstring CPToUTF16(u32 code_page, const std::string& input) {
     const auto size =
         MultiByteToWideChar(code_page, 0, input.data(), static_cast<int>(input.size()), nullptr, 0);
@@ -318,56 +441,6 @@ static std::string CodeToUTF8(const char* fromcode, const std::basic_string<T>&
     return result;
 }
 
-std::u16string UTF8ToUTF16(const std::string& input) {
-    iconv_t const conv_desc = iconv_open("UTF-16LE", "UTF-8");
-    if ((iconv_t)(-1) == conv_desc) {
-        LOG_ERROR(Common, "Iconv initialization failure [UTF-8]: {}", strerror(errno));
-        iconv_close(conv_desc);
-        return {};
-    }
-
-    const std::size_t in_bytes = sizeof(char) * input.size();
-    // Multiply by 4, which is the max number of bytes to encode a codepoint
-    const std::size_t out_buffer_size = 4 * sizeof(char16_t) * in_bytes;
-
-    std::u16string out_buffer(out_buffer_size, char16_t{});
-
-    char* src_buffer = const_cast<char*>(&input[0]);
-    std::size_t src_bytes = in_bytes;
-    char* dst_buffer = (char*)(&out_buffer[0]);
-    std::size_t dst_bytes = out_buffer.size();
-
-    while (0 != src_bytes) {
-        std::size_t const iconv_result =
-            iconv(conv_desc, &src_buffer, &src_bytes, &dst_buffer, &dst_bytes);
-
-        if (static_cast<std::size_t>(-1) == iconv_result) {
-            if (EILSEQ == errno || EINVAL == errno) {
-                // Try to skip the bad character
-                if (0 != src_bytes) {
-                    --src_bytes;
-                    ++src_buffer;
-                }
-            } else {
-                LOG_ERROR(Common, "iconv failure [UTF-8]: {}", strerror(errno));
-                break;
-            }
-        }
-    }
-
-    std::u16string result;
-    out_buffer.resize(out_buffer_size - dst_bytes);
-    out_buffer.swap(result);
-
-    iconv_close(conv_desc);
-
-    return result;
-}
-
-std::string UTF16ToUTF8(const std::u16string& input) {
-    return CodeToUTF8("UTF-16LE", input);
-}
-
 std::string CP1252ToUTF8(const std::string& input) {
     // return CodeToUTF8("CP1252//TRANSLIT", input);
     // return CodeToUTF8("CP1252//IGNORE", input);
@@ -8,6 +8,7 @@
 #include <iomanip>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include "common/common_types.h"
 
@@ -69,8 +70,27 @@ void BuildCompleteFilename(std::string& _CompleteFilename, const std::string& _P
                            const std::string& _Filename);
 std::string ReplaceAll(std::string result, const std::string& src, const std::string& dest);
 
-std::string UTF16ToUTF8(const std::u16string& input);
-std::u16string UTF8ToUTF16(const std::string& input);
+/// Number of UTF-8 code units a single UTF-16 code unit converts to at most
+constexpr std::size_t MAX_UTF8_UNITS_PER_UTF16_UNIT = 3;
+
+/**
+ * Converts UTF-16 to UTF-8 into a buffer of the caller, with runs of ASCII converted with SIMD.
+ * Unpaired surrogates are replaced by U+FFFD.
+ * @param output Buffer of at least input.size() * MAX_UTF8_UNITS_PER_UTF16_UNIT characters
+ * @returns Number of characters written to the output
+ */
+std::size_t UTF16ToUTF8(std::u16string_view input, char* output);
+
+/**
+ * Converts UTF-8 to UTF-16 into a buffer of the caller, with runs of ASCII converted with SIMD.
+ * Invalid, overlong and truncated sequences are replaced by U+FFFD.
+ * @param output Buffer of at least input.size() characters
+ * @returns Number of characters written to the output
+ */
+std::size_t UTF8ToUTF16(std::string_view input, char16_t* output);
+
+std::string UTF16ToUTF8(std::u16string_view input);
+std::u16string UTF8ToUTF16(std::string_view input);
 
 std::string CP1252ToUTF8(const std::string& str);
 std::string SHIFTJISToUTF8(const std::string& str);
@@ -0,0 +1,170 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+#include "common/cpu_dispatch.h"
+#include "common/swap.h"
+
+#ifdef ARCHITECTURE_x86_64
+#include <immintrin.h>
+#endif
+#ifdef ARCHITECTURE_ARM64
+#include <arm_neon.h>
+#endif
+
+namespace Common {
+
+namespace {
+
+u16 Swap(u16 value) {
+    return swap16(value);
+}
+
+u32 Swap(u32 value) {
+    return swap32(value);
+}
+
+u64 Swap(u64 value) {
+    return swap64(value);
+}
+
+template <typename T>
+void SwapBlockScalar(void* dst, const void* src, std::size_t count) {
+    u8* const out = static_cast<u8*>(dst);
+    const u8* const in = static_cast<const u8*>(src);
+    for (std::size_t index = 0; index < count; ++index) {
+        T value;
+        std::memcpy(&value, in + index * sizeof(T), sizeof(T));
+        value = Swap(value);
+        std::memcpy(out + index * sizeof(T), &value, sizeof(T));
+    }
+}
+
+/// Byte order that reverses each value of the given size within a 16 byte lane
+template <std::size_t Size>
+constexpr std::array<u8, 16> MakeShuffle() {
+    std::array<u8, 16> shuffle{};
+    for (std::size_t i = 0; i < shuffle.size(); ++i) {
+        shuffle[i] = static_cast<u8>(i - i % Size + Size - 1 - i % Size);
+    }
+    return shuffle;
+}
+
+template <std::size_t Size>
+constexpr std::array<u8, 16> Shuffle = MakeShuffle<Size>();
+
+#ifdef ARCHITECTURE_x86_64
+template <typename T>
+SIMD_TARGET("ssse3")
+void SwapBlockSSSE3(void* dst, const void* src, std::size_t count) {
+    // 32 bytes are swapped at a time
+    constexpr std::size_t per_vector = 16 / sizeof(T);
+    u8* const out = static_cast<u8*>(dst);
+    const u8* const in = static_cast<const u8*>(src);
+    const __m128i shuffle =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(Shuffle<sizeof(T)>.data()));
+    std::size_t index = 0;
+    for (; index + 2 * per_vector <= count; index += 2 * per_vector) {
+        const u8* const input = in + index * sizeof(T);
+        u8* const output = out + index * sizeof(T);
+        const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+        const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 16));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_shuffle_epi8(low, shuffle));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 16),
+                         _mm_shuffle_epi8(high, shuffle));
+    }
+    SwapBlockScalar<T>(out + index * sizeof(T), in + index * sizeof(T), count - index);
+}
+
+template <typename T>
+SIMD_TARGET("avx2")
+void SwapBlockAVX2(void* dst, const void* src, std::size_t count) {
+    // 64 bytes are swapped at a time, the shuffle works within each 16 byte lane
+    constexpr std::size_t per_vector = 32 / sizeof(T);
+    u8* const out = static_cast<u8*>(dst);
+    const u8* const in = static_cast<const u8*>(src);
+    const __m256i shuffle = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(Shuffle<sizeof(T)>.data())));
+    std::size_t index = 0;
+    for (; index + 2 * per_vector <= count; index += 2 * per_vector) {
+        const u8* const input = in + index * sizeof(T);
+        u8* const output = out + index * sizeof(T);
+        const __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input));
+        const __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + 32));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output),
+                            _mm256_shuffle_epi8(low, shuffle));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + 32),
+                            _mm256_shuffle_epi8(high, shuffle));
+    }
+    SwapBlockSSSE3<T>(out + index * sizeof(T), in + index * sizeof(T), count - index);
+}
+#endif
+
+#ifdef ARCHITECTURE_ARM64
+template <typename T>
+void SwapBlockNEON(void* dst, const void* src, std::size_t count) {
+    // 32 bytes are swapped at a time
+    constexpr std::size_t per_vector = 16 / sizeof(T);
+    u8* const out = static_cast<u8*>(dst);
+    const u8* const in = static_cast<const u8*>(src);
+    std::size_t index = 0;
+    for (; index + 2 * per_vector <= count; index += 2 * per_vector) {
+        const u8* const input = in + index * sizeof(T);
+        u8* const output = out + index * sizeof(T);
+        uint8x16_t low = vld1q_u8(input);
+        uint8x16_t high = vld1q_u8(input + 16);
+        if constexpr (sizeof(T) == 2) {
+            low = vrev16q_u8(low);
+            high = vrev16q_u8(high);
+        } else if constexpr (sizeof(T) == 4) {
+            low = vrev32q_u8(low);
+            high = vrev32q_u8(high);
+        } else {
+            low = vrev64q_u8(low);
+            high = vrev64q_u8(high);
+        }
+        vst1q_u8(output, low);
+        vst1q_u8(output + 16, high);
+    }
+    SwapBlockScalar<T>(out + index * sizeof(T), in + index * sizeof(T), count - index);
+}
+#endif
+
+using SwapBlockFunction = DispatchedFunction<void(void*, const void*, std::size_t)>;
+
+template <typename T>
+SwapBlockFunction MakeSwapBlock(const char* name) {
+    return {name,
+            {
+                {SIMDLevel::Scalar, SwapBlockScalar<T>},
+#ifdef ARCHITECTURE_x86_64
+                {SIMDLevel::SSSE3, SwapBlockSSSE3<T>},
+                {SIMDLevel::AVX2, SwapBlockAVX2<T>},
+#endif
+#ifdef ARCHITECTURE_ARM64
+                {SIMDLevel::NEON, SwapBlockNEON<T>},
+#endif
+            }};
+}
+
+SwapBlockFunction swap_block_16{MakeSwapBlock<u16>("SwapBlock16")};
+SwapBlockFunction swap_block_32{MakeSwapBlock<u32>("SwapBlock32")};
+SwapBlockFunction swap_block_64{MakeSwapBlock<u64>("SwapBlock64")};
+
+} // Anonymous namespace
+
+void SwapBlock16(void* dst, const void* src, std::size_t count) {
+    swap_block_16(dst, src, count);
+}
+
+void SwapBlock32(void* dst, const void* src, std::size_t count) {
+    swap_block_32(dst, src, count);
+}
+
+void SwapBlock64(void* dst, const void* src, std::size_t count) {
+    swap_block_64(dst, src, count);
+}
+
+} // namespace Common
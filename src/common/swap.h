@@ -163,6 +163,15 @@ inline double swapd(double f) {
     return f;
 }
 
+/**
+ * Byte swaps count consecutive 16, 32 or 64-bit values from src to dst, such as a table of big
+ * endian values. Neither pointer has to be aligned, and dst may be the same as src to swap the
+ * values in place, but the ranges may not otherwise overlap.
+ */
+void SwapBlock16(void* dst, const void* src, std::size_t count);
+void SwapBlock32(void* dst, const void* src, std::size_t count);
+void SwapBlock64(void* dst, const void* src, std::size_t count);
+
 } // Namespace Common
 
 template <typename T, typename F>
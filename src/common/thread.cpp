@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include "common/thread.h"
+#include "common/tracing.h"
 #ifdef __APPLE__
 #include <mach/mach.h>
 #elif defined(_WIN32)
@@ -18,6 +19,10 @@
 #ifndef _WIN32
 #include <unistd.h>
 #endif
+#ifdef __linux__
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
 
 #ifdef __FreeBSD__
 #define cpu_set_t cpuset_t
@@ -35,6 +40,19 @@ int CurrentThreadId() {
 #endif
 }
 
+void SetCurrentThreadPriority(ThreadPriority priority) {
+#ifdef _WIN32
+    static constexpr int priorities[] = {THREAD_PRIORITY_BELOW_NORMAL, THREAD_PRIORITY_NORMAL,
+                                         THREAD_PRIORITY_ABOVE_NORMAL, THREAD_PRIORITY_HIGHEST};
+    SetThreadPriority(GetCurrentThread(), priorities[static_cast<int>(priority)]);
+#elif defined(__linux__)
+    // On Linux, a nice value set for a thread id only applies to that thread
+    static constexpr int nice_values[] = {5, 0, -5, -10};
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)),
+                nice_values[static_cast<int>(priority)]);
+#endif
+}
+
 #ifdef _WIN32
 // Supporting functions
 void SleepCurrentThread(int ms) {
@@ -63,6 +81,8 @@ void SwitchCurrentThread() {
 // This is implemented much nicer in upcoming msvc++, see:
 // http://msdn.microsoft.com/en-us/library/xcb2z8hs(VS.100).aspx
 void SetCurrentThreadName(const char* szThreadName) {
+    Tracing::SetCurrentThreadName(szThreadName);
+
     static const DWORD MS_VC_EXCEPTION = 0x406D1388;
 
 #pragma pack(push, 8)
@@ -119,6 +139,8 @@ void SwitchCurrentThread() {
 // MinGW with the POSIX threading model does not support pthread_setname_np
 #if !defined(_WIN32) || defined(_MSC_VER)
 void SetCurrentThreadName(const char* szThreadName) {
+    Tracing::SetCurrentThreadName(szThreadName);
+
 #ifdef __APPLE__
     pthread_setname_np(szThreadName);
 #elif defined(__Bitrig__) || defined(__DragonFly__) || defined(__FreeBSD__) || defined(__OpenBSD__)
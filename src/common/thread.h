@@ -18,6 +18,17 @@ int CurrentThreadId();
 void SetThreadAffinity(std::thread::native_handle_type thread, u32 mask);
 void SetCurrentThreadAffinity(u32 mask);
 
+enum class ThreadPriority {
+    Low,
+    Normal,
+    High,     ///< Threads whose delays show up as stutter, like presenting frames
+    Critical, ///< Threads that must never miss a deadline, like feeding the audio device
+};
+
+/// Sets the host scheduling priority of the current thread. Raising it may need privileges the
+/// process lacks, in which case it's left unchanged.
+void SetCurrentThreadPriority(ThreadPriority priority);
+
 class Event {
 public:
     Event() : is_set(false) {}
@@ -0,0 +1,164 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <string>
+#include "common/thread.h"
+#include "common/thread_pool.h"
+
+namespace Common {
+
+/// Pool the current thread is a worker of, and its index in it
+static thread_local ThreadPool* current_pool = nullptr;
+static thread_local std::size_t current_worker = 0;
+
+ThreadPool::ThreadPool(std::size_t num_threads, u32 affinity_mask) {
+    if (num_threads == 0) {
+        num_threads = std::max(std::thread::hardware_concurrency(), 1U);
+    }
+
+    std::vector<u32> cpus;
+    for (u32 cpu = 0; cpu < 32; ++cpu) {
+        if ((affinity_mask >> cpu) & 1) {
+            cpus.push_back(cpu);
+        }
+    }
+
+    workers.reserve(num_threads);
+    for (std::size_t i = 0; i < num_threads; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    // The workers are only started once all of them exist, as they steal from each other
+    for (std::size_t i = 0; i < num_threads; ++i) {
+        Worker& worker = *workers[i];
+        worker.thread = std::thread([this, i] { WorkerLoop(i); });
+        if (!cpus.empty()) {
+            SetThreadAffinity(worker.thread.native_handle(), 1U << cpus[i % cpus.size()]);
+        }
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(idle_mutex);
+        stop = true;
+    }
+    idle_cv.notify_all();
+    for (const auto& worker : workers) {
+        worker->thread.join();
+    }
+}
+
+ThreadPool& ThreadPool::GetInstance() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::Enqueue(Task task, TaskPriority priority) {
+    // Tasks submitted by a worker are queued to it, as they likely work on the same data
+    const std::size_t worker_index = current_pool == this
+                                         ? current_worker
+                                         : next_worker.fetch_add(1) % workers.size();
+    Worker& worker = *workers[worker_index];
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks[static_cast<std::size_t>(priority)].push_back(std::move(task));
+        ++queued_tasks;
+    }
+    {
+        // Taking the lock makes sure a worker going idle sees the task or gets notified
+        std::lock_guard<std::mutex> lock(idle_mutex);
+    }
+    idle_cv.notify_one();
+}
+
+bool ThreadPool::PopTask(std::size_t worker_index, Task& task) {
+    for (std::size_t priority = 0; priority < static_cast<std::size_t>(TaskPriority::Count);
+         ++priority) {
+        // The newest task of the worker's own queue first, then the oldest one of the others
+        for (std::size_t offset = 0; offset < workers.size(); ++offset) {
+            Worker& worker = *workers[(worker_index + offset) % workers.size()];
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            auto& tasks = worker.tasks[priority];
+            if (tasks.empty()) {
+                continue;
+            }
+            if (offset == 0) {
+                task = std::move(tasks.back());
+                tasks.pop_back();
+            } else {
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            --queued_tasks;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::WorkerLoop(std::size_t worker_index) {
+    current_pool = this;
+    current_worker = worker_index;
+    const std::string name = "yuzu:Worker" + std::to_string(worker_index);
+    SetCurrentThreadName(name.c_str());
+
+    Task task;
+    while (true) {
+        if (PopTask(worker_index, task)) {
+            task();
+            task = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(idle_mutex);
+        idle_cv.wait(lock, [this] { return stop || queued_tasks > 0; });
+        if (stop && queued_tasks == 0) {
+            return;
+        }
+    }
+}
+
+void ThreadPool::ParallelForImpl(std::size_t begin, std::size_t end, std::size_t chunk_size,
+                                 const ChunkFunc& func) {
+    // Helpers may only start after this returned, so the state they use is shared with them
+    struct State {
+        std::atomic<std::size_t> next;
+        std::atomic<std::size_t> remaining_chunks;
+        std::size_t end;
+        std::size_t chunk_size;
+        const ChunkFunc* func;
+        std::mutex mutex;
+        std::condition_variable done_cv;
+    };
+    const std::size_t num_chunks = (end - begin + chunk_size - 1) / chunk_size;
+    const auto state = std::make_shared<State>();
+    state->next = begin;
+    state->remaining_chunks = num_chunks;
+    state->end = end;
+    state->chunk_size = chunk_size;
+    state->func = &func;
+
+    const auto run_chunks = [](State& state) {
+        std::size_t first;
+        while ((first = state.next.fetch_add(state.chunk_size)) < state.end) {
+            (*state.func)(first, std::min(first + state.chunk_size, state.end));
+            if (state.remaining_chunks.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(state.mutex);
+                state.done_cv.notify_all();
+            }
+        }
+    };
+
+    const std::size_t num_helpers = std::min(num_chunks - 1, GetThreadCount());
+    for (std::size_t i = 0; i < num_helpers; ++i) {
+        Enqueue([state, run_chunks] { run_chunks(*state); }, TaskPriority::High);
+    }
+    run_chunks(*state);
+
+    // The chunks still running were taken by threads that are already running them
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done_cv.wait(lock, [&state] { return state->remaining_chunks == 0; });
+}
+
+} // namespace Common
@@ -0,0 +1,124 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Common {
+
+/// Order in which the queued tasks are run, regardless of when they were submitted
+enum class TaskPriority {
+    High,
+    Normal,
+    Low,
+    Count,
+};
+
+/**
+ * Pool of worker threads running short tasks. Each worker has its own queue, which it runs the
+ * newest tasks of first. Idle workers steal the oldest tasks of the others.
+ *
+ * Tasks must not wait on the futures of other tasks, as every worker could end up waiting. Split
+ * the work with ParallelFor instead, which also runs it on the calling thread.
+ */
+class ThreadPool {
+public:
+    /**
+     * @param num_threads    Number of worker threads, 0 for one per host thread
+     * @param affinity_mask  Host CPUs the workers may run on, each one is pinned to one of them in
+     *                       turn. 0 leaves the scheduling to the OS.
+     */
+    explicit ThreadPool(std::size_t num_threads = 0, u32 affinity_mask = 0);
+
+    /// Runs the tasks already submitted, then stops the workers
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// Returns the pool shared by the whole emulator, with one worker per host thread
+    static ThreadPool& GetInstance();
+
+    std::size_t GetThreadCount() const {
+        return workers.size();
+    }
+
+    /// Queues a task, the returned future holds its result
+    template <typename Func>
+    auto Submit(Func&& func, TaskPriority priority = TaskPriority::Normal)
+        -> std::future<std::invoke_result_t<std::decay_t<Func>>> {
+        using Result = std::invoke_result_t<std::decay_t<Func>>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Func>(func));
+        std::future<Result> future = task->get_future();
+        Enqueue([task] { (*task)(); }, priority);
+        return future;
+    }
+
+    /**
+     * Calls func(index) for each index in [begin, end), spread between the workers and the calling
+     * thread, and returns once all the calls returned. It can be called from a task.
+     * @param min_chunk  Minimum number of indices handed to a thread at once, for small work items
+     */
+    template <typename Func>
+    void ParallelFor(std::size_t begin, std::size_t end, Func&& func, std::size_t min_chunk = 1) {
+        if (begin >= end) {
+            return;
+        }
+        // A few chunks per thread, so that threads finishing early take over some of the work
+        const std::size_t num_parts = (GetThreadCount() + 1) * 4;
+        const std::size_t chunk_size = std::max((end - begin + num_parts - 1) / num_parts,
+                                                std::max<std::size_t>(min_chunk, 1));
+        ParallelForImpl(begin, end, chunk_size, [&func](std::size_t first, std::size_t last) {
+            for (std::size_t index = first; index < last; ++index) {
+                func(index);
+            }
+        });
+    }
+
+private:
+    using Task = std::function<void()>;
+    using ChunkFunc = std::function<void(std::size_t, std::size_t)>;
+
+    struct Worker {
+        std::thread thread;
+        std::mutex mutex;
+        std::array<std::deque<Task>, static_cast<std::size_t>(TaskPriority::Count)> tasks;
+    };
+
+    void Enqueue(Task task, TaskPriority priority);
+
+    /// Takes the next task to run, from the given worker's queue or stolen from another one
+    bool PopTask(std::size_t worker_index, Task& task);
+
+    void WorkerLoop(std::size_t worker_index);
+
+    void ParallelForImpl(std::size_t begin, std::size_t end, std::size_t chunk_size,
+                         const ChunkFunc& func);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    /// Worker the next task submitted from outside the pool is queued to
+    std::atomic<std::size_t> next_worker{0};
+    /// Number of tasks in all the queues
+    std::atomic<std::size_t> queued_tasks{0};
+
+    std::mutex idle_mutex;
+    std::condition_variable idle_cv;
+    bool stop = false; ///< Guarded by idle_mutex
+};
+
+} // namespace Common
@@ -5,7 +5,7 @@
 #pragma once
 
 // a simple lockless thread-safe,
-// single reader, single writer queue
+// single reader, single writer queue, which reuses the memory of the popped elements
 
 #include <algorithm>
 #include <atomic>
@@ -18,11 +18,11 @@ template <typename T, bool NeedSize = true>
 class SPSCQueue {
 public:
     SPSCQueue() : size(0) {
-        write_ptr = read_ptr = new ElementPtr();
+        write_ptr = read_ptr = first_free = last_free = new ElementPtr();
     }
     ~SPSCQueue() {
-        // this will empty out the whole queue
-        delete read_ptr;
+        // the consumed elements are still linked before read_ptr, so this frees everything
+        DeleteElements();
     }
 
     u32 Size() const {
@@ -31,20 +31,19 @@ public:
     }
 
     bool Empty() const {
-        return !read_ptr->next.load();
+        return !read_ptr.load(std::memory_order_relaxed)->next.load();
     }
 
     T& Front() const {
-        return read_ptr->current;
+        return read_ptr.load(std::memory_order_relaxed)->next.load()->current;
     }
 
     template <typename Arg>
     void Push(Arg&& t) {
         // create the element, add it to the queue
-        write_ptr->current = std::forward<Arg>(t);
-        // set the next pointer to a new element ptr
-        // then advance the write pointer
-        ElementPtr* new_ptr = new ElementPtr();
+        ElementPtr* new_ptr = AllocateElement();
+        new_ptr->current = std::forward<Arg>(t);
+        // then link it after the last element and advance the write pointer
         write_ptr->next.store(new_ptr, std::memory_order_release);
         write_ptr = new_ptr;
         if (NeedSize)
@@ -54,12 +53,11 @@ public:
     void Pop() {
         if (NeedSize)
             size--;
-        ElementPtr* tmpptr = read_ptr;
-        // advance the read pointer
-        read_ptr = tmpptr->next.load();
-        // set the next element to nullptr to stop the recursive deletion
-        tmpptr->next.store(nullptr);
-        delete tmpptr; // this also deletes the element
+        ElementPtr* next_ptr = read_ptr.load(std::memory_order_relaxed)->next.load();
+        // drop what the element holds now rather than when its node is reused
+        next_ptr->current = T{};
+        // advance the read pointer, the previous element can now be reused by the writer
+        read_ptr.store(next_ptr, std::memory_order_release);
     }
 
     bool Pop(T& t) {
@@ -69,40 +67,68 @@ public:
         if (NeedSize)
             size--;
 
-        ElementPtr* tmpptr = read_ptr;
-        read_ptr = tmpptr->next.load(std::memory_order_acquire);
-        t = std::move(tmpptr->current);
-        tmpptr->next.store(nullptr);
-        delete tmpptr;
+        ElementPtr* next_ptr =
+            read_ptr.load(std::memory_order_relaxed)->next.load(std::memory_order_acquire);
+        t = std::move(next_ptr->current);
+        read_ptr.store(next_ptr, std::memory_order_release);
         return true;
     }
 
     // not thread-safe
     void Clear() {
         size.store(0);
-        delete read_ptr;
-        write_ptr = read_ptr = new ElementPtr();
+        DeleteElements();
+        write_ptr = first_free = last_free = new ElementPtr();
+        read_ptr.store(write_ptr);
     }
 
 private:
-    // stores a pointer to element
+    // stores an element
     // and a pointer to the next ElementPtr
     class ElementPtr {
     public:
         ElementPtr() : next(nullptr) {}
-        ~ElementPtr() {
-            ElementPtr* next_ptr = next.load();
 
-            if (next_ptr)
-                delete next_ptr;
-        }
-
-        T current;
+        T current{};
         std::atomic<ElementPtr*> next;
     };
 
+    /**
+     * Returns an element to write to. Elements are never freed while the queue is alive, the ones
+     * the reader is done with are reused instead, so pushing only allocates while the queue grows.
+     * Only called by the writer.
+     */
+    ElementPtr* AllocateElement() {
+        if (first_free == last_free) {
+            // everything up to the element the reader is at was consumed
+            last_free = read_ptr.load(std::memory_order_acquire);
+        }
+        if (first_free == last_free) {
+            return new ElementPtr();
+        }
+        ElementPtr* element = first_free;
+        first_free = element->next.load(std::memory_order_relaxed);
+        element->next.store(nullptr, std::memory_order_relaxed);
+        return element;
+    }
+
+    void DeleteElements() {
+        ElementPtr* element = first_free;
+        while (element) {
+            ElementPtr* next_element = element->next.load();
+            delete element;
+            element = next_element;
+        }
+    }
+
+    // written by the writer only
     ElementPtr* write_ptr;
-    ElementPtr* read_ptr;
+    // oldest consumed element, the writer reuses the elements from there up to last_free
+    ElementPtr* first_free;
+    // read_ptr as last seen by the writer
+    ElementPtr* last_free;
+    // last consumed element, the next one is the front of the queue, written by the reader only
+    std::atomic<ElementPtr*> read_ptr;
     std::atomic<u32> size;
 };
 
@@ -127,7 +153,7 @@ public:
     template <typename Arg>
     void Push(Arg&& t) {
         std::lock_guard<std::mutex> lock(write_lock);
-        spsc_queue.Push(t);
+        spsc_queue.Push(std::forward<Arg>(t));
     }
 
     void Pop() {
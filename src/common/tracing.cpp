@@ -0,0 +1,37 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/tracing.h"
+
+#if defined(YUZU_TRACING_PERFETTO)
+PERFETTO_TRACK_EVENT_STATIC_STORAGE();
+#endif
+
+namespace Common::Tracing {
+
+void Initialize() {
+#if defined(YUZU_TRACING_PERFETTO)
+    // Traces are recorded by the system service, started with the perfetto command line tool, so
+    // that capturing doesn't need any support from the frontends
+    perfetto::TracingInitArgs args;
+    args.backends = perfetto::kSystemBackend;
+    perfetto::Tracing::Initialize(args);
+    perfetto::TrackEvent::Register();
+#endif
+    // Tracy starts its profiler along with the process and has nothing to initialize
+}
+
+void SetCurrentThreadName(const char* name) {
+#if defined(YUZU_TRACING_TRACY)
+    tracy::SetThreadName(name);
+#elif defined(YUZU_TRACING_PERFETTO)
+    auto descriptor = perfetto::ThreadTrack::Current().Serialize();
+    descriptor.mutable_thread()->set_thread_name(name);
+    perfetto::TrackEvent::SetTrackDescriptor(perfetto::ThreadTrack::Current(), descriptor);
+#else
+    static_cast<void>(name);
+#endif
+}
+
+} // namespace Common::Tracing
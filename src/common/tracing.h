@@ -0,0 +1,45 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+// Facade over the tracing profiler chosen with the YUZU_TRACING CMake option, for the hot paths
+// that are too fine grained for MicroProfile. Without a backend, every macro compiles to nothing.
+//
+// YUZU_TRACE_ZONE(name)             Traces the rest of the enclosing scope as a zone. The name must
+//                                   be a string literal.
+// YUZU_TRACE_COUNTER(name, value)   Samples a counter track. The name must be a string literal.
+
+#if defined(YUZU_TRACING_TRACY)
+
+#include <Tracy.hpp>
+
+#define YUZU_TRACE_ZONE(name) ZoneScopedN(name)
+#define YUZU_TRACE_COUNTER(name, value) TracyPlot(name, static_cast<int64_t>(value))
+
+#elif defined(YUZU_TRACING_PERFETTO)
+
+#include <perfetto.h>
+
+PERFETTO_DEFINE_CATEGORIES(perfetto::Category("yuzu").SetDescription("yuzu hot paths"));
+
+#define YUZU_TRACE_ZONE(name) TRACE_EVENT("yuzu", name)
+#define YUZU_TRACE_COUNTER(name, value) TRACE_COUNTER("yuzu", name, static_cast<int64_t>(value))
+
+#else
+
+#define YUZU_TRACE_ZONE(name) static_cast<void>(0)
+#define YUZU_TRACE_COUNTER(name, value) static_cast<void>(0)
+
+#endif
+
+namespace Common::Tracing {
+
+/// Connects to the tracing backend, called once at startup before any thread is traced
+void Initialize();
+
+/// Names the current thread in traces, called by Common::SetCurrentThreadName
+void SetCurrentThreadName(const char* name);
+
+} // namespace Common::Tracing
@@ -0,0 +1,82 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include "common/memory_util.h"
+
+namespace Common {
+
+/**
+ * Fixed size array allocated straight from the OS. Its pages are zero filled on demand, so a large
+ * buffer that is mostly left zeroed only costs the memory of the pages that were written to.
+ * @tparam T Element type, for which all bits zero must be a valid value
+ */
+template <typename T>
+class VirtualBuffer final {
+    static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>,
+                  "T must not need to be constructed or destroyed");
+
+public:
+    VirtualBuffer() = default;
+    explicit VirtualBuffer(std::size_t count)
+        : base_ptr{static_cast<T*>(AllocateMemoryPages(count * sizeof(T)))}, count{count} {}
+
+    ~VirtualBuffer() {
+        FreeMemoryPages(base_ptr, count * sizeof(T));
+    }
+
+    VirtualBuffer(const VirtualBuffer&) = delete;
+    VirtualBuffer& operator=(const VirtualBuffer&) = delete;
+
+    VirtualBuffer(VirtualBuffer&& other) noexcept
+        : base_ptr{std::exchange(other.base_ptr, nullptr)}, count{std::exchange(other.count, 0)} {}
+
+    VirtualBuffer& operator=(VirtualBuffer&& other) noexcept {
+        FreeMemoryPages(base_ptr, count * sizeof(T));
+        base_ptr = std::exchange(other.base_ptr, nullptr);
+        count = std::exchange(other.count, 0);
+        return *this;
+    }
+
+    T& operator[](std::size_t index) {
+        return base_ptr[index];
+    }
+    const T& operator[](std::size_t index) const {
+        return base_ptr[index];
+    }
+
+    T* data() {
+        return base_ptr;
+    }
+    const T* data() const {
+        return base_ptr;
+    }
+
+    T* begin() {
+        return base_ptr;
+    }
+    const T* begin() const {
+        return base_ptr;
+    }
+    T* end() {
+        return base_ptr + count;
+    }
+    const T* end() const {
+        return base_ptr + count;
+    }
+
+    std::size_t size() const {
+        return count;
+    }
+
+private:
+    T* base_ptr = nullptr;
+    std::size_t count = 0;
+};
+
+} // namespace Common
@@ -109,12 +109,16 @@ static CPUCaps Detect() {
         //  - Is the AVX bit set in CPUID?
         //  - Is the XSAVE bit set in CPUID?
         //  - XGETBV result has the XCR bit set.
+        bool os_saves_avx512_state = false;
         if (((cpu_id[2] >> 28) & 1) && ((cpu_id[2] >> 27) & 1)) {
-            if ((_xgetbv(_XCR_XFEATURE_ENABLED_MASK) & 0x6) == 0x6) {
+            const u64 xcr0 = _xgetbv(_XCR_XFEATURE_ENABLED_MASK);
+            if ((xcr0 & 0x6) == 0x6) {
                 caps.avx = true;
                 if ((cpu_id[2] >> 12) & 1)
                     caps.fma = true;
             }
+            // The opmask registers and the upper halves of all 32 ZMM registers
+            os_saves_avx512_state = (xcr0 & 0xE6) == 0xE6;
         }
 
         if (max_std_fn >= 7) {
@@ -126,6 +130,10 @@ static CPUCaps Detect() {
                 caps.bmi1 = true;
             if ((cpu_id[1] >> 8) & 1)
                 caps.bmi2 = true;
+            if ((cpu_id[1] >> 16) & 1)
+                caps.avx512f = os_saves_avx512_state;
+            if ((cpu_id[1] >> 30) & 1)
+                caps.avx512bw = os_saves_avx512_state;
         }
     }
 
@@ -190,6 +198,10 @@ std::string GetCPUCapsString() {
         sum += ", AVX";
     if (caps.avx2)
         sum += ", AVX2";
+    if (caps.avx512f)
+        sum += ", AVX-512F";
+    if (caps.avx512bw)
+        sum += ", AVX-512BW";
     if (caps.bmi1)
         sum += ", BMI1";
     if (caps.bmi2)
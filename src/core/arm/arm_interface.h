@@ -40,6 +40,9 @@ public:
     /// Clear all instruction cache
     virtual void ClearInstructionCache() = 0;
 
+    /// Clear the instruction cache of the code in the given range, keeping the rest of it
+    virtual void InvalidateCacheRange(VAddr address, std::size_t size) = 0;
+
     /// Notify CPU emulation that page tables have changed
     virtual void PageTableChanged() = 0;
 
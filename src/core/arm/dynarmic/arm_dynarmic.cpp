@@ -2,7 +2,9 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cinttypes>
+#include <cstring>
 #include <memory>
 #include <dynarmic/A64/a64.h>
 #include <dynarmic/A64/config.h>
@@ -16,6 +18,7 @@
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/svc.h"
 #include "core/memory.h"
+#include "core/perf_stats.h"
 
 namespace Core {
 
@@ -39,6 +42,11 @@ public:
         return Memory::Read64(vaddr);
     }
     Vector MemoryRead128(u64 vaddr) override {
+        if (const u8* pointer = GetFastmemPointer(vaddr, sizeof(Vector))) {
+            Vector value;
+            std::memcpy(value.data(), pointer, sizeof(Vector));
+            return value;
+        }
         return {Memory::Read64(vaddr), Memory::Read64(vaddr + 8)};
     }
 
@@ -55,10 +63,30 @@ public:
         Memory::Write64(vaddr, value);
     }
     void MemoryWrite128(u64 vaddr, Vector value) override {
+        if (u8* pointer = GetFastmemPointer(vaddr, sizeof(Vector))) {
+            std::memcpy(pointer, value.data(), sizeof(Vector));
+            return;
+        }
         Memory::Write64(vaddr, value[0]);
         Memory::Write64(vaddr + 8, value[1]);
     }
 
+    /**
+     * Returns a host pointer for an access of the given size if it lies entirely within a single
+     * page that is directly backed by host memory, or nullptr if it must go through the regular
+     * (locked) memory accessors instead.
+     */
+    u8* GetFastmemPointer(u64 vaddr, std::size_t size) const {
+        if ((vaddr & Memory::PAGE_MASK) + size > Memory::PAGE_SIZE) {
+            return nullptr;
+        }
+        u8* const page_pointer = parent.current_page_table->pointers[vaddr >> Memory::PAGE_BITS];
+        if (page_pointer == nullptr) {
+            return nullptr;
+        }
+        return page_pointer + (vaddr & Memory::PAGE_MASK);
+    }
+
     void InterpreterFallback(u64 pc, std::size_t num_instructions) override {
         LOG_INFO(Core_ARM, "Unicorn fallback @ 0x{:X} for {} instructions (instr = {:08X})", pc,
                  num_instructions, MemoryReadCode(pc));
@@ -101,6 +129,9 @@ public:
         Kernel::CallSVC(swi);
     }
 
+    // Dynarmic keeps the cycle budget of a run in its JIT state and counts it down at block
+    // exits itself. It only asks for the budget when Run() starts and reports the cycles it used
+    // when Run() returns, so both calls happen once per timing slice rather than once per block.
     void AddTicks(u64 ticks) override {
         // Divide the number of ticks by the amount of CPU cores. TODO(Subv): This yields only a
         // rough approximation of the amount of executed ticks in the system, it may be thrown off
@@ -160,9 +191,18 @@ MICROPROFILE_DEFINE(ARM_Jit_Dynarmic, "ARM JIT", "Dynarmic", MP_RGB(255, 64, 64)
 
 void ARM_Dynarmic::Run() {
     MICROPROFILE_SCOPE(ARM_Jit_Dynarmic);
+    const Core::ScopedStageTimer stage_timer{Core::System::GetInstance().GetPerfStats(),
+                                             Core::PerfStage::CPU};
     ASSERT(Memory::GetCurrentPageTable() == current_page_table);
 
     jit->Run();
+
+    // A watchpoint hit halts the JIT, report it now that the thread context is consistent
+    if (GDBStub::IsServerEnabled()) {
+        Kernel::Thread* thread = Kernel::GetCurrentThread();
+        SaveContext(thread->context);
+        GDBStub::SendTrap(thread, 5);
+    }
 }
 
 void ARM_Dynarmic::Step() {
@@ -268,9 +308,53 @@ void ARM_Dynarmic::ClearExclusiveState() {
     jit->ClearExclusiveState();
 }
 
+void ARM_Dynarmic::InvalidateCacheRange(VAddr address, std::size_t size) {
+    jit->InvalidateCacheRange(address, size);
+    // The range may belong to a process that isn't running, so the kept JITs drop it as well. This
+    // only queues the range, which is looked up the next time each JIT runs.
+    for (auto& inactive : inactive_jits) {
+        inactive.jit->InvalidateCacheRange(address, size);
+    }
+}
+
 void ARM_Dynarmic::PageTableChanged() {
-    jit = MakeJit();
-    current_page_table = Memory::GetCurrentPageTable();
+    Memory::PageTable* const page_table = Memory::GetCurrentPageTable();
+    const u32 process_id = Core::CurrentProcess()->process_id;
+    if (jit && page_table == current_page_table && process_id == current_process_id) {
+        return;
+    }
+
+    // Rather than translating the code of a process again each time it's switched back to, the
+    // JITs of the last processes are kept. Process ids are never reused, so a page table freed
+    // and reallocated for another process can't match the JIT of the previous one.
+    ThreadContext ctx;
+    const bool has_context = jit != nullptr;
+    if (has_context) {
+        SaveContext(ctx);
+        inactive_jits.insert(inactive_jits.begin(),
+                             {current_page_table, current_process_id, std::move(jit)});
+    }
+
+    const auto cached = std::find_if(inactive_jits.begin(), inactive_jits.end(),
+                                     [&](const InactiveJit& inactive) {
+                                         return inactive.page_table == page_table &&
+                                                inactive.process_id == process_id;
+                                     });
+    if (cached != inactive_jits.end()) {
+        jit = std::move(cached->jit);
+        inactive_jits.erase(cached);
+    } else {
+        jit = MakeJit();
+    }
+    if (inactive_jits.size() > MAX_INACTIVE_JITS) {
+        inactive_jits.pop_back();
+    }
+
+    current_page_table = page_table;
+    current_process_id = process_id;
+    if (has_context) {
+        LoadContext(ctx);
+    }
 }
 
 DynarmicExclusiveMonitor::DynarmicExclusiveMonitor(std::size_t core_count) : monitor(core_count) {}
@@ -307,6 +391,14 @@ bool DynarmicExclusiveMonitor::ExclusiveWrite64(std::size_t core_index, VAddr va
 
 bool DynarmicExclusiveMonitor::ExclusiveWrite128(std::size_t core_index, VAddr vaddr, u128 value) {
     return monitor.DoExclusiveOperation(core_index, vaddr, 16, [&] {
+        // Exclusive accesses are aligned and never cross a page, so a directly mapped value is
+        // stored in one copy instead of two halves that each look the page up again
+        const Memory::PageTable& page_table = *Memory::GetCurrentPageTable();
+        u8* const page_pointer = page_table.pointers[vaddr >> Memory::PAGE_BITS];
+        if (page_pointer != nullptr) {
+            std::memcpy(page_pointer + (vaddr & Memory::PAGE_MASK), value.data(), sizeof(u128));
+            return;
+        }
         Memory::Write64(vaddr + 0, value[0]);
         Memory::Write64(vaddr + 8, value[1]);
     });
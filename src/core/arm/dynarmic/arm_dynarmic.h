@@ -5,6 +5,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include <dynarmic/A64/a64.h>
 #include <dynarmic/A64/exclusive_monitor.h>
 #include "common/common_types.h"
@@ -47,9 +48,20 @@ public:
     void ClearExclusiveState() override;
 
     void ClearInstructionCache() override;
+    void InvalidateCacheRange(VAddr address, std::size_t size) override;
     void PageTableChanged() override;
 
 private:
+    /// A JIT of a process that isn't the current one, along with the code it translated
+    struct InactiveJit {
+        Memory::PageTable* page_table;
+        u32 process_id;
+        std::unique_ptr<Dynarmic::A64::Jit> jit;
+    };
+
+    /// Number of JITs of other processes kept, enough for the applets run next to a game
+    static constexpr std::size_t MAX_INACTIVE_JITS = 3;
+
     std::unique_ptr<Dynarmic::A64::Jit> MakeJit() const;
 
     friend class ARM_Dynarmic_Callbacks;
@@ -61,6 +73,9 @@ private:
     std::shared_ptr<DynarmicExclusiveMonitor> exclusive_monitor;
 
     Memory::PageTable* current_page_table = nullptr;
+    u32 current_process_id = 0;
+    /// JITs of the processes that ran most recently, most recent first
+    std::vector<InactiveJit> inactive_jits;
 };
 
 class DynarmicExclusiveMonitor final : public ExclusiveMonitor {
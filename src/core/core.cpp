@@ -2,33 +2,47 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <thread>
 #include <utility>
+#include <vector>
 
+#include "common/cpu_topology.h"
 #include "common/logging/log.h"
 #include "common/string_util.h"
+#include "common/thread.h"
+#include "common/thread_pool.h"
 #include "core/arm/exclusive_monitor.h"
 #include "core/core.h"
 #include "core/core_cpu.h"
 #include "core/core_timing.h"
+#include "core/crypto/key_manager.h"
 #include "core/file_sys/mode.h"
 #include "core/file_sys/vfs_concat.h"
 #include "core/file_sys/vfs_real.h"
 #include "core/gdbstub/gdbstub.h"
+#include "core/guest_profiler.h"
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/scheduler.h"
+#include "core/hle/kernel/svc_profiler.h"
 #include "core/hle/kernel/thread.h"
 #include "core/hle/service/service.h"
 #include "core/hle/service/sm/sm.h"
 #include "core/loader/loader.h"
+#include "core/memory.h"
+#include "core/memory_stats.h"
 #include "core/perf_stats.h"
+#include "core/savestate.h"
 #include "core/settings.h"
 #include "core/telemetry_session.h"
+#include "core/tracer/player.h"
 #include "video_core/debug_utils/debug_utils.h"
 #include "video_core/gpu.h"
 #include "video_core/renderer_base.h"
@@ -70,15 +84,97 @@ FileSys::VirtualFile GetGameFileFromPath(const FileSys::VirtualFilesystem& vfs,
     return vfs->OpenFile(path, FileSys::Mode::Read);
 }
 
+/// Pins the current host thread to the physical core of the given emulated CPU core, if enabled
+void PinToPhysicalCore(std::size_t core_index) {
+    if (!Settings::values.pin_emulation_threads) {
+        return;
+    }
+    const u32 mask{Common::GetPhysicalCoreMask(core_index)};
+    if (mask != 0) {
+        Common::SetCurrentThreadAffinity(mask);
+    }
+}
+
 /// Runs a CPU core while the system is powered on
 void RunCpuCore(std::shared_ptr<Cpu> cpu_state) {
+    Common::SetCurrentThreadName(fmt::format("yuzu:CPUCore_{}", cpu_state->CoreIndex()).c_str());
+    PinToPhysicalCore(cpu_state->CoreIndex());
+    Common::SetCurrentThreadPriority(Common::ThreadPriority::High);
     while (Core::System::GetInstance().IsPoweredOn()) {
         cpu_state->RunLoop(true);
     }
 }
+
+/// Records when each phase of the boot ran and on which thread, to log the boot timeline
+class BootTimeline {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// Records the phase from its creation until it goes out of scope
+    class Phase {
+    public:
+        Phase(BootTimeline& timeline, const char* name)
+            : timeline{timeline}, name{name}, begin{Clock::now()} {}
+
+        ~Phase() {
+            timeline.Add(name, begin, Clock::now());
+        }
+
+    private:
+        BootTimeline& timeline;
+        const char* name;
+        Clock::time_point begin;
+    };
+
+    Phase Begin(const char* name) {
+        return Phase{*this, name};
+    }
+
+    void Log() const {
+        using Milliseconds = std::chrono::duration<double, std::milli>;
+        std::lock_guard<std::mutex> lock(mutex);
+        LOG_INFO(Core, "Boot timeline, {:.2f} ms in total:",
+                 Milliseconds(Clock::now() - start).count());
+
+        std::vector<std::thread::id> threads;
+        for (const Record& record : records) {
+            auto thread = std::find(threads.begin(), threads.end(), record.thread);
+            if (thread == threads.end()) {
+                thread = threads.insert(threads.end(), record.thread);
+            }
+            LOG_INFO(Core, "  {:>9.2f} - {:>9.2f} ms  thread {}  {}",
+                     Milliseconds(record.begin - start).count(),
+                     Milliseconds(record.end - start).count(), thread - threads.begin(),
+                     record.name);
+        }
+    }
+
+private:
+    struct Record {
+        const char* name;
+        std::thread::id thread;
+        Clock::time_point begin;
+        Clock::time_point end;
+    };
+
+    void Add(const char* name, Clock::time_point begin, Clock::time_point end) {
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto position =
+            std::find_if(records.begin(), records.end(),
+                         [begin](const Record& other) { return other.begin > begin; });
+        records.insert(position, {name, std::this_thread::get_id(), begin, end});
+    }
+
+    const Clock::time_point start = Clock::now();
+    mutable std::mutex mutex;
+    /// Sorted by beginning
+    std::vector<Record> records;
+};
 } // Anonymous namespace
 
 struct System::Impl {
+    explicit Impl(System& system) : system{system} {}
+
     Cpu& CurrentCpuCore() {
         if (Settings::values.use_multi_core) {
             const auto& search = thread_to_cpu.find(std::this_thread::get_id());
@@ -94,8 +190,23 @@ struct System::Impl {
     ResultStatus RunLoop(bool tight_loop) {
         status = ResultStatus::Success;
 
+        // Replaying a GPU trace doesn't involve the CPU at all
+        if (gpu_trace_player) {
+            gpu_trace_player->ReplayFrame(*gpu_core, *kernel.CurrentProcess());
+            return status;
+        }
+
         // Update thread_to_cpu in case Core 0 is run from a different host thread
-        thread_to_cpu[std::this_thread::get_id()] = cpu_cores[0];
+        const auto thread_id{std::this_thread::get_id()};
+        thread_to_cpu[thread_id] = cpu_cores[0];
+        if (thread_id != core_0_thread_id) {
+            core_0_thread_id = thread_id;
+            PinToPhysicalCore(0);
+            Common::SetCurrentThreadPriority(Common::ThreadPriority::High);
+        }
+
+        // The cores are between two slices, so their state can be captured or replaced
+        savestates.ProcessRequests();
 
         if (GDBStub::IsServerEnabled()) {
             GDBStub::HandlePacket();
@@ -126,10 +237,14 @@ struct System::Impl {
         return status;
     }
 
-    ResultStatus Init(Frontend::EmuWindow& emu_window) {
+    ResultStatus Init(Frontend::EmuWindow& emu_window, BootTimeline& timeline) {
         LOG_DEBUG(HW_Memory, "initialized OK");
 
         CoreTiming::Init();
+        if (Settings::values.use_host_timing) {
+            const bool is_limited{Settings::values.use_frame_limit};
+            CoreTiming::SetHostTiming(true, is_limited ? Settings::values.frame_limit : 100);
+        }
         kernel.Initialize();
 
         // Create a default fs if one doesn't already exist.
@@ -147,15 +262,30 @@ struct System::Impl {
         telemetry_session = std::make_unique<Core::TelemetrySession>();
         service_manager = std::make_shared<Service::SM::ServiceManager>();
 
-        Service::Init(service_manager, virtual_filesystem);
-        GDBStub::Init();
+        // The services don't use the renderer until the guest runs, and the renderer has to be
+        // initialized on this thread, which owns the graphics context, so both run at once
+        auto services_ready = Common::ThreadPool::GetInstance().Submit([this, &timeline] {
+            const auto phase = timeline.Begin("Services");
+            Service::Init(service_manager, virtual_filesystem);
+        });
 
-        renderer = VideoCore::CreateRenderer(emu_window);
-        if (!renderer->Init()) {
+        // A renderer kept by ShutdownForRestart is only reused for the window it was made for
+        if (renderer != nullptr && &renderer->GetRenderWindow() != &emu_window) {
+            renderer.reset();
+        }
+        bool is_renderer_ready = true;
+        if (renderer == nullptr) {
+            const auto phase = timeline.Begin("Renderer");
+            renderer = VideoCore::CreateRenderer(emu_window, system);
+            is_renderer_ready = renderer->Init();
+        }
+        services_ready.get();
+        if (!is_renderer_ready) {
             return ResultStatus::ErrorVideoCore;
         }
 
-        gpu_core = std::make_unique<Tegra::GPU>(renderer->Rasterizer());
+        GDBStub::Init();
+        gpu_core = std::make_unique<Tegra::GPU>(system, *renderer);
 
         // Create threads for CPU cores 1-3, and build thread_to_cpu map
         // CPU core 0 is run on the main thread
@@ -178,7 +308,31 @@ struct System::Impl {
     }
 
     ResultStatus Load(Frontend::EmuWindow& emu_window, const std::string& filepath) {
-        app_loader = Loader::GetLoader(GetGameFileFromPath(virtual_filesystem, filepath));
+        BootTimeline timeline;
+
+        // The key files are parsed once and shared by every NCA opened from then on, so that
+        // starts right away instead of when the loader opens the first NCA
+        auto keys_ready = Common::ThreadPool::GetInstance().Submit([&timeline] {
+            const auto phase = timeline.Begin("Keys");
+            const Crypto::KeyManager keys;
+        });
+
+        const ResultStatus result = LoadApplication(emu_window, filepath, timeline);
+        if (result != ResultStatus::Success) {
+            // Also releases a renderer kept for this load when it failed before Init
+            renderer.reset();
+        }
+        keys_ready.get();
+        timeline.Log();
+        return result;
+    }
+
+    ResultStatus LoadApplication(Frontend::EmuWindow& emu_window, const std::string& filepath,
+                                 BootTimeline& timeline) {
+        {
+            const auto phase = timeline.Begin("Loader");
+            app_loader = Loader::GetLoader(GetGameFileFromPath(virtual_filesystem, filepath));
+        }
 
         if (!app_loader) {
             LOG_CRITICAL(Core, "Failed to obtain loader for {}!", filepath);
@@ -194,7 +348,7 @@ struct System::Impl {
             return ResultStatus::ErrorSystemMode;
         }
 
-        ResultStatus init_result{Init(emu_window)};
+        ResultStatus init_result{Init(emu_window, timeline)};
         if (init_result != ResultStatus::Success) {
             LOG_CRITICAL(Core, "Failed to initialize system (Error {})!",
                          static_cast<int>(init_result));
@@ -202,7 +356,11 @@ struct System::Impl {
             return init_result;
         }
 
-        const Loader::ResultStatus load_result{app_loader->Load(kernel.CurrentProcess())};
+        Loader::ResultStatus load_result;
+        {
+            const auto phase = timeline.Begin("Application");
+            load_result = app_loader->Load(kernel.CurrentProcess());
+        }
         if (load_result != Loader::ResultStatus::Success) {
             LOG_CRITICAL(Core, "Failed to load ROM (Error {})!", static_cast<int>(load_result));
             Shutdown();
@@ -214,7 +372,32 @@ struct System::Impl {
         return status;
     }
 
-    void Shutdown() {
+    ResultStatus LoadGPUTrace(Frontend::EmuWindow& emu_window, const std::string& filepath) {
+        auto player = std::make_unique<GPUTrace::Player>(filepath);
+        if (!player->IsValid()) {
+            LOG_CRITICAL(Core, "Failed to load GPU trace {}!", filepath);
+            renderer.reset();
+            return ResultStatus::ErrorGPUTrace;
+        }
+
+        BootTimeline timeline;
+        ResultStatus init_result{Init(emu_window, timeline)};
+        if (init_result != ResultStatus::Success) {
+            LOG_CRITICAL(Core, "Failed to initialize system (Error {})!",
+                         static_cast<int>(init_result));
+            Shutdown();
+            return init_result;
+        }
+        timeline.Log();
+
+        // No guest thread is ever scheduled, so the page table the replay writes to is set here
+        Memory::SetCurrentPageTable(&kernel.CurrentProcess()->vm_manager.page_table);
+        gpu_trace_player = std::move(player);
+        status = ResultStatus::Success;
+        return status;
+    }
+
+    void Shutdown(bool keep_renderer = false) {
         // Log last frame performance stats
         auto perf_results = GetAndResetPerfStats();
         Telemetry().AddField(Telemetry::FieldType::Performance, "Shutdown_EmulationSpeed",
@@ -224,13 +407,36 @@ struct System::Impl {
         Telemetry().AddField(Telemetry::FieldType::Performance, "Shutdown_Frametime",
                              perf_results.frametime * 1000.0);
 
-        // Shutdown emulation session
-        renderer.reset();
+        if (Settings::values.profile_svcs) {
+            Kernel::SVCProfiler::LogTotals();
+            Kernel::SVCProfiler::Reset();
+        }
+        if (Settings::values.record_memory_stats) {
+            Memory::AccessStats::LogTotals();
+            Memory::AccessStats::Reset();
+        }
+        if (Settings::values.profile_guest) {
+            GuestProfiler::LogTotals();
+            GuestProfiler::Reset();
+        }
+        GuestProfiler::ClearModules();
+
+        // Release the tracked guest memory before the process is destroyed
+        savestates.Reset();
+
+        // Shutdown emulation session, the GPU may still be using the renderer
+        gpu_trace_player.reset();
+        if (keep_renderer && gpu_core != nullptr) {
+            gpu_core->ResetGuestState();
+        }
+        gpu_core.reset();
+        if (!keep_renderer) {
+            renderer.reset();
+        }
         GDBStub::Shutdown();
         Service::Shutdown();
         service_manager.reset();
         telemetry_session.reset();
-        gpu_core.reset();
 
         // Close all CPU/threading state
         cpu_barrier->NotifyEnd();
@@ -273,6 +479,8 @@ struct System::Impl {
         return perf_stats.GetAndResetStats(CoreTiming::GetGlobalTimeUs());
     }
 
+    System& system;
+
     Kernel::KernelCore kernel;
     /// RealVfsFilesystem instance
     FileSys::VirtualFilesystem virtual_filesystem;
@@ -280,6 +488,8 @@ struct System::Impl {
     std::unique_ptr<Loader::AppLoader> app_loader;
     std::unique_ptr<VideoCore::RendererBase> renderer;
     std::unique_ptr<Tegra::GPU> gpu_core;
+    /// Player of the GPU trace replayed instead of an application, if any
+    std::unique_ptr<GPUTrace::Player> gpu_trace_player;
     std::shared_ptr<Tegra::DebugContext> debug_context;
     std::shared_ptr<ExclusiveMonitor> cpu_exclusive_monitor;
     std::shared_ptr<CpuBarrier> cpu_barrier;
@@ -298,12 +508,15 @@ struct System::Impl {
 
     /// Map of guest threads to CPU cores
     std::map<std::thread::id, std::shared_ptr<Cpu>> thread_to_cpu;
+    /// Host thread core 0 was last run from, to only set its affinity and priority once
+    std::thread::id core_0_thread_id;
 
     Core::PerfStats perf_stats;
     Core::FrameLimiter frame_limiter;
+    Core::SaveStateManager savestates;
 };
 
-System::System() : impl{std::make_unique<Impl>()} {}
+System::System() : impl{std::make_unique<Impl>(*this)} {}
 System::~System() = default;
 
 Cpu& System::CurrentCpuCore() {
@@ -324,10 +537,21 @@ void System::InvalidateCpuInstructionCaches() {
     }
 }
 
+void System::InvalidateCpuInstructionCacheRange(VAddr address, std::size_t size) {
+    for (auto& cpu : impl->cpu_cores) {
+        cpu->ArmInterface().InvalidateCacheRange(address, size);
+    }
+}
+
 System::ResultStatus System::Load(Frontend::EmuWindow& emu_window, const std::string& filepath) {
     return impl->Load(emu_window, filepath);
 }
 
+System::ResultStatus System::LoadGPUTrace(Frontend::EmuWindow& emu_window,
+                                          const std::string& filepath) {
+    return impl->LoadGPUTrace(emu_window, filepath);
+}
+
 bool System::IsPoweredOn() const {
     return impl->cpu_barrier && impl->cpu_barrier->IsAlive();
 }
@@ -415,6 +639,10 @@ const Core::PerfStats& System::GetPerfStats() const {
     return impl->perf_stats;
 }
 
+Core::SaveStateManager& System::SaveStates() {
+    return impl->savestates;
+}
+
 Core::FrameLimiter& System::FrameLimiter() {
     return impl->frame_limiter;
 }
@@ -456,13 +684,22 @@ std::shared_ptr<FileSys::VfsFilesystem> System::GetFilesystem() const {
 }
 
 System::ResultStatus System::Init(Frontend::EmuWindow& emu_window) {
-    return impl->Init(emu_window);
+    BootTimeline timeline;
+    return impl->Init(emu_window, timeline);
 }
 
 void System::Shutdown() {
     impl->Shutdown();
 }
 
+void System::ShutdownForRestart() {
+    impl->Shutdown(true);
+}
+
+bool System::HasKeptRenderer() const {
+    return impl->renderer != nullptr && impl->gpu_core == nullptr;
+}
+
 Service::SM::ServiceManager& System::ServiceManager() {
     return *impl->service_manager;
 }
@@ -50,6 +50,7 @@ class Cpu;
 class ExclusiveMonitor;
 class FrameLimiter;
 class PerfStats;
+class SaveStateManager;
 class TelemetrySession;
 
 struct PerfStatsResults;
@@ -81,6 +82,7 @@ public:
         ErrorSystemFiles,    ///< Error in finding system files
         ErrorSharedFont,     ///< Error in finding shared font
         ErrorVideoCore,      ///< Error in the video core
+        ErrorGPUTrace,       ///< Error loading a GPU trace
         ErrorUnknown,        ///< Any other error
         ErrorLoader,         ///< The base for loader errors (too many to repeat)
     };
@@ -105,14 +107,27 @@ public:
 
     /**
      * Invalidate the CPU instruction caches
-     * This function should only be used by GDB Stub to support breakpoints, memory updates and
-     * step/continue commands.
+     * This function should only be used by GDB Stub to support step/continue commands, memory
+     * updates only invalidate the range they modify.
      */
     void InvalidateCpuInstructionCaches();
 
+    /// Invalidates the translated code of the given range on all CPU cores, after it's modified
+    void InvalidateCpuInstructionCacheRange(VAddr address, std::size_t size);
+
     /// Shutdown the emulated system.
     void Shutdown();
 
+    /**
+     * Shuts down the emulated system, but keeps the renderer along with its graphics context and
+     * the shader programs it built. The next Load into the same window reuses it, so restarting
+     * only rebuilds the state of the title. Must be called from the thread Shutdown would be.
+     */
+    void ShutdownForRestart();
+
+    /// Returns whether ShutdownForRestart kept a renderer for the next Load
+    bool HasKeptRenderer() const;
+
     /**
      * Load an executable application.
      * @param emu_window Reference to the host-system window used for video output and keyboard
@@ -122,6 +137,14 @@ public:
      */
     ResultStatus Load(Frontend::EmuWindow& emu_window, const std::string& filepath);
 
+    /**
+     * Load a GPU trace, which RunLoop then replays a frame at a time without running the CPU.
+     * @param emu_window Reference to the host-system window used for video output.
+     * @param filepath String path to the trace recorded with GPU::StartTraceRecording.
+     * @returns ResultStatus code, indicating if the operation succeeded.
+     */
+    ResultStatus LoadGPUTrace(Frontend::EmuWindow& emu_window, const std::string& filepath);
+
     /**
      * Indicates if the emulated system is powered on (all subsystems initialized and able to run an
      * application).
@@ -192,6 +215,9 @@ public:
     /// Provides a constant reference to the internal PerfStats instance.
     const Core::PerfStats& GetPerfStats() const;
 
+    /// Provides a reference to the savestate manager
+    Core::SaveStateManager& SaveStates();
+
     /// Provides a reference to the frame limiter;
     Core::FrameLimiter& FrameLimiter();
 
@@ -11,8 +11,10 @@
 #endif
 #include "core/arm/exclusive_monitor.h"
 #include "core/arm/unicorn/arm_unicorn.h"
+#include "core/core.h"
 #include "core/core_cpu.h"
 #include "core/core_timing.h"
+#include "core/guest_profiler.h"
 #include "core/hle/kernel/scheduler.h"
 #include "core/hle/kernel/thread.h"
 #include "core/hle/lock.h"
@@ -20,6 +22,18 @@
 
 namespace Core {
 
+/// Returns whether none of the CPU cores has a thread that is running or ready to run.
+static bool AreAllCoresIdle() {
+    auto& system = System::GetInstance();
+    for (std::size_t core_index = 0; core_index < NUM_CPU_CORES; ++core_index) {
+        const auto& scheduler = system.Scheduler(core_index);
+        if (scheduler->GetCurrentThread() != nullptr || scheduler->HaveReadyThreads()) {
+            return false;
+        }
+    }
+    return true;
+}
+
 void CpuBarrier::NotifyEnd() {
     std::unique_lock<std::mutex> lock(mutex);
     end = true;
@@ -37,18 +51,53 @@ bool CpuBarrier::Rendezvous() {
 
         --cores_waiting;
         if (!cores_waiting) {
-            cores_waiting = NUM_CPU_CORES;
+            cores_waiting = cores_active;
+            ++generation;
             condition.notify_all();
             return true;
         }
 
-        condition.wait(lock);
+        const u64 current_generation = generation;
+        condition.wait(lock, [&] { return current_generation != generation || end; });
         return true;
     }
 
     return false;
 }
 
+void CpuBarrier::Park(std::size_t core_index, const std::atomic<bool>& work_pending) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (end || work_pending) {
+        return;
+    }
+
+    parked[core_index] = true;
+    --cores_active;
+
+    // This core has not arrived for the current slice yet, so leaving may complete it
+    --cores_waiting;
+    if (!cores_waiting) {
+        cores_waiting = cores_active;
+        ++generation;
+        condition.notify_all();
+    }
+
+    condition.wait(lock, [&] { return !parked[core_index] || end; });
+}
+
+void CpuBarrier::Unpark(std::size_t core_index) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!parked[core_index]) {
+        return;
+    }
+
+    // Rejoin the slice currently in progress, the woken core rendezvouses next
+    parked[core_index] = false;
+    ++cores_active;
+    ++cores_waiting;
+    condition.notify_all();
+}
+
 Cpu::Cpu(std::shared_ptr<ExclusiveMonitor> exclusive_monitor,
          std::shared_ptr<CpuBarrier> cpu_barrier, std::size_t core_index)
     : cpu_barrier{std::move(cpu_barrier)}, core_index{core_index} {
@@ -94,9 +143,17 @@ void Cpu::RunLoop(bool tight_loop) {
         LOG_TRACE(Core, "Core-{} idling", core_index);
 
         if (IsMainCore()) {
-            // TODO(Subv): Only let CoreTiming idle if all 4 cores are idling.
-            CoreTiming::Idle();
+            // When no core has anything to run, nothing can happen until the next event fires,
+            // so jump straight to it instead of idling through every slice in between.
+            if (AreAllCoresIdle()) {
+                CoreTiming::IdleUntilNextEvent();
+            } else {
+                CoreTiming::Idle();
+            }
             CoreTiming::Advance();
+        } else if (Settings::values.use_multi_core) {
+            // Stop holding back the other cores until a thread is scheduled onto this one
+            cpu_barrier->Park(core_index, reschedule_pending);
         }
 
         PrepareReschedule();
@@ -110,6 +167,10 @@ void Cpu::RunLoop(bool tight_loop) {
         } else {
             arm_interface->Step();
         }
+
+        if (Settings::values.profile_guest) {
+            GuestProfiler::Sample(core_index, *arm_interface);
+        }
     }
 
     Reschedule();
@@ -122,6 +183,10 @@ void Cpu::SingleStep() {
 void Cpu::PrepareReschedule() {
     arm_interface->PrepareReschedule();
     reschedule_pending = true;
+
+    if (Settings::values.use_multi_core && !IsMainCore()) {
+        cpu_barrier->Unpark(core_index);
+    }
 }
 
 void Cpu::Reschedule() {
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <condition_variable>
 #include <cstddef>
@@ -32,8 +33,21 @@ public:
 
     bool Rendezvous();
 
+    /**
+     * Removes a core without any runnable threads from the rendezvous set, so that the remaining
+     * cores no longer wait on it every slice. Blocks until the core is woken with Unpark() or the
+     * barrier ends. Returns immediately if `work_pending` is already set.
+     */
+    void Park(std::size_t core_index, const std::atomic<bool>& work_pending);
+
+    /// Wakes a parked core and adds it back to the rendezvous set.
+    void Unpark(std::size_t core_index);
+
 private:
+    unsigned cores_active{NUM_CPU_CORES};
     unsigned cores_waiting{NUM_CPU_CORES};
+    u64 generation{};
+    std::array<bool, NUM_CPU_CORES> parked{};
     std::mutex mutex;
     std::condition_variable condition;
     std::atomic<bool> end{};
@@ -5,10 +5,14 @@
 #include "core/core_timing.h"
 
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <limits>
 #include <mutex>
 #include <string>
 #include <tuple>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include "common/assert.h"
 #include "common/thread.h"
@@ -28,7 +32,7 @@ struct EventType {
 
 struct Event {
     s64 time;
-    u64 fifo_order;
+    EventHandle fifo_order;
     u64 userdata;
     const EventType* type;
 };
@@ -51,7 +55,14 @@ static std::unordered_map<std::string, EventType> event_types;
 // erase arbitrary events (RemoveEvent()) regardless of the queue order. These aren't accomodated
 // by the standard adaptor class.
 static std::vector<Event> event_queue;
-static u64 event_fifo_id;
+// The fifo order of an event doubles as its handle, so it has to be unique across all threads.
+static std::atomic<EventHandle> event_fifo_id;
+
+// Handles of the events in event_queue that are still live. Cancelling an event only removes it
+// from this set, the stale heap entry is dropped once it reaches the front of the queue (or when
+// the queue is compacted), so no cancellation has to re-establish the heap invariant.
+static std::unordered_set<EventHandle> pending_events;
+
 // the queue for storing the events from other threads threadsafe until they will be added
 // to the event_queue by the emu thread
 static Common::MPSCQueue<Event, false> ts_queue;
@@ -59,6 +70,12 @@ static Common::MPSCQueue<Event, false> ts_queue;
 // the queue for unscheduling the events from other threads threadsafe
 static Common::MPSCQueue<std::pair<const EventType*, u64>, false> unschedule_queue;
 
+// the queue for unscheduling events by handle from other threads threadsafe
+static Common::MPSCQueue<EventHandle, false> unschedule_handle_queue;
+
+// Don't bother compacting the queue until it holds at least this many cancelled entries.
+constexpr std::size_t MIN_COMPACTION_SIZE = 64;
+
 constexpr int MAX_SLICE_LENGTH = 20000;
 
 static s64 idled_cycles;
@@ -70,6 +87,35 @@ static bool is_global_timer_sane;
 
 static EventType* ev_lost = nullptr;
 
+// Host clock guest time follows when host timing is enabled. The guest tick count at the epoch is
+// moved forward when the emulation stalls, so that time resumes from where it stopped.
+static bool use_host_timing;
+static std::chrono::steady_clock::time_point host_epoch;
+static std::atomic<s64> host_epoch_ticks;
+static u32 host_speed_percent;
+
+// Lag behind the host clock guest time catches up with at once, anything longer is a stall
+constexpr s64 MAX_HOST_CATCH_UP = static_cast<s64>(BASE_CLOCK_RATE / 10);
+// Longest wait on the host while idling, so that a missed wake up is never noticeable
+constexpr s64 MAX_HOST_WAIT = static_cast<s64>(BASE_CLOCK_RATE / 1000);
+
+// Wakes the emu thread up when another thread schedules an event while it waits on the host
+static std::mutex host_wait_mutex;
+static std::condition_variable host_wait_cv;
+
+/// Returns the guest tick count matching the current host time, with host timing enabled
+static s64 GetHostTicks() {
+    constexpr s64 NS_PER_SECOND = 1000000000;
+    constexpr s64 CLOCK_RATE = static_cast<s64>(BASE_CLOCK_RATE);
+    const s64 elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                               std::chrono::steady_clock::now() - host_epoch)
+                               .count() *
+                           host_speed_percent / 100;
+    // Split in whole seconds, multiplying the nanoseconds right away would overflow in seconds
+    return host_epoch_ticks + elapsed_ns / NS_PER_SECOND * CLOCK_RATE +
+           elapsed_ns % NS_PER_SECOND * CLOCK_RATE / NS_PER_SECOND;
+}
+
 static void EmptyTimedCallback(u64 userdata, s64 cyclesLate) {}
 
 EventType* RegisterEvent(const std::string& name, TimedCallback callback) {
@@ -103,19 +149,37 @@ void Init() {
     // that slice.
     is_global_timer_sane = true;
 
-    event_fifo_id = 0;
+    event_fifo_id = INVALID_EVENT_HANDLE;
     ev_lost = RegisterEvent("_lost_event", &EmptyTimedCallback);
+
+    use_host_timing = false;
 }
 
 void Shutdown() {
     MoveEvents();
     ClearPendingEvents();
+    unschedule_queue.Clear();
+    unschedule_handle_queue.Clear();
     UnregisterAllEvents();
 }
 
+void SetHostTiming(bool enabled, u32 speed_percent) {
+    // Guest time carries on from its current value, only what drives it changes
+    host_epoch = std::chrono::steady_clock::now();
+    host_epoch_ticks = static_cast<s64>(GetTicks());
+    host_speed_percent = std::max(speed_percent, 1U);
+    use_host_timing = enabled;
+}
+
 // This should only be called from the CPU thread. If you are calling
 // it from any other thread, you are doing something evil
 u64 GetTicks() {
+    if (use_host_timing) {
+        // Bounded like in Advance(), so that the time never goes back once a stall is handled
+        const s64 host_ticks = std::min(GetHostTicks(), global_timer + MAX_HOST_CATCH_UP);
+        return static_cast<u64>(std::max(global_timer, host_ticks));
+    }
+
     u64 ticks = static_cast<u64>(global_timer);
     if (!is_global_timer_sane) {
         ticks += slice_length - downcount;
@@ -127,53 +191,116 @@ void AddTicks(u64 ticks) {
     downcount -= static_cast<int>(ticks);
 }
 
+void RestoreTicks(u64 ticks) {
+    MoveEvents();
+    const s64 delta = static_cast<s64>(ticks) - static_cast<s64>(GetTicks());
+    global_timer += delta;
+    host_epoch_ticks += delta;
+    // Shifting every event by the same amount keeps the heap ordered
+    for (Event& event : event_queue) {
+        event.time += delta;
+    }
+}
+
 u64 GetIdleTicks() {
     return static_cast<u64>(idled_cycles);
 }
 
 void ClearPendingEvents() {
     event_queue.clear();
+    pending_events.clear();
+}
+
+static bool IsEventPending(const Event& event) {
+    return pending_events.count(event.fifo_order) != 0;
+}
+
+static void PushEvent(Event event) {
+    pending_events.insert(event.fifo_order);
+    event_queue.emplace_back(std::move(event));
+    std::push_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+}
+
+/// Drops cancelled events from the front of the queue, so they can't shorten the next slice.
+static void PopCancelledEvents() {
+    while (!event_queue.empty() && !IsEventPending(event_queue.front())) {
+        std::pop_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+        event_queue.pop_back();
+    }
+}
+
+/// Rebuilds the queue without its cancelled entries once they make up the majority of it.
+static void CompactEventQueue() {
+    const std::size_t cancelled_events = event_queue.size() - pending_events.size();
+    if (cancelled_events < MIN_COMPACTION_SIZE || cancelled_events < pending_events.size()) {
+        return;
+    }
+
+    const auto itr = std::remove_if(event_queue.begin(), event_queue.end(),
+                                    [](const Event& e) { return !IsEventPending(e); });
+    event_queue.erase(itr, event_queue.end());
+    std::make_heap(event_queue.begin(), event_queue.end(), std::greater<>());
 }
 
-void ScheduleEvent(s64 cycles_into_future, const EventType* event_type, u64 userdata) {
+EventHandle ScheduleEvent(s64 cycles_into_future, const EventType* event_type, u64 userdata) {
     ASSERT(event_type != nullptr);
     s64 timeout = GetTicks() + cycles_into_future;
     // If this event needs to be scheduled before the next advance(), force one early
     if (!is_global_timer_sane)
         ForceExceptionCheck(cycles_into_future);
-    event_queue.emplace_back(Event{timeout, event_fifo_id++, userdata, event_type});
-    std::push_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+    const EventHandle handle = ++event_fifo_id;
+    PushEvent(Event{timeout, handle, userdata, event_type});
+    return handle;
 }
 
-void ScheduleEventThreadsafe(s64 cycles_into_future, const EventType* event_type, u64 userdata) {
-    ts_queue.Push(Event{global_timer + cycles_into_future, 0, userdata, event_type});
+EventHandle ScheduleEventThreadsafe(s64 cycles_into_future, const EventType* event_type,
+                                    u64 userdata) {
+    const EventHandle handle = ++event_fifo_id;
+    const s64 current_time = use_host_timing ? GetHostTicks() : global_timer;
+    ts_queue.Push(Event{current_time + cycles_into_future, handle, userdata, event_type});
+    if (use_host_timing) {
+        // Taking the lock orders the push before the emu thread checks the queue and waits
+        { std::lock_guard<std::mutex> lock{host_wait_mutex}; }
+        host_wait_cv.notify_one();
+    }
+    return handle;
 }
 
 void UnscheduleEvent(const EventType* event_type, u64 userdata) {
-    auto itr = std::remove_if(event_queue.begin(), event_queue.end(), [&](const Event& e) {
-        return e.type == event_type && e.userdata == userdata;
-    });
-
-    // Removing random items breaks the invariant so we have to re-establish it.
-    if (itr != event_queue.end()) {
-        event_queue.erase(itr, event_queue.end());
-        std::make_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+    for (const Event& e : event_queue) {
+        if (e.type == event_type && e.userdata == userdata) {
+            pending_events.erase(e.fifo_order);
+        }
     }
+    CompactEventQueue();
 }
 
 void UnscheduleEventThreadsafe(const EventType* event_type, u64 userdata) {
     unschedule_queue.Push(std::make_pair(event_type, userdata));
 }
 
-void RemoveEvent(const EventType* event_type) {
-    auto itr = std::remove_if(event_queue.begin(), event_queue.end(),
-                              [&](const Event& e) { return e.type == event_type; });
+void UnscheduleEvent(EventHandle handle) {
+    if (handle == INVALID_EVENT_HANDLE) {
+        return;
+    }
+    pending_events.erase(handle);
+    CompactEventQueue();
+}
 
-    // Removing random items breaks the invariant so we have to re-establish it.
-    if (itr != event_queue.end()) {
-        event_queue.erase(itr, event_queue.end());
-        std::make_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+void UnscheduleEventThreadsafe(EventHandle handle) {
+    if (handle == INVALID_EVENT_HANDLE) {
+        return;
     }
+    unschedule_handle_queue.Push(handle);
+}
+
+void RemoveEvent(const EventType* event_type) {
+    for (const Event& e : event_queue) {
+        if (e.type == event_type) {
+            pending_events.erase(e.fifo_order);
+        }
+    }
+    CompactEventQueue();
 }
 
 void RemoveNormalAndThreadsafeEvent(const EventType* event_type) {
@@ -193,9 +320,7 @@ void ForceExceptionCheck(s64 cycles) {
 
 void MoveEvents() {
     for (Event ev; ts_queue.Pop(ev);) {
-        ev.fifo_order = event_fifo_id++;
-        event_queue.emplace_back(std::move(ev));
-        std::push_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+        PushEvent(std::move(ev));
     }
 }
 
@@ -204,9 +329,24 @@ void Advance() {
     for (std::pair<const EventType*, u64> ev; unschedule_queue.Pop(ev);) {
         UnscheduleEvent(ev.first, ev.second);
     }
+    for (EventHandle handle; unschedule_handle_queue.Pop(handle);) {
+        UnscheduleEvent(handle);
+    }
 
-    int cycles_executed = slice_length - downcount;
-    global_timer += cycles_executed;
+    if (use_host_timing) {
+        // The executed cycles only end the slice, time itself comes from the host clock
+        const s64 lag = GetHostTicks() - global_timer;
+        if (lag > 0) {
+            // When the emulation stalled, firing everything that was due in the meantime at once
+            // would only make it stutter further, so the rest of the lag is dropped
+            const s64 caught_up = std::min(lag, MAX_HOST_CATCH_UP);
+            host_epoch_ticks -= lag - caught_up;
+            global_timer += caught_up;
+        }
+    } else {
+        int cycles_executed = slice_length - downcount;
+        global_timer += cycles_executed;
+    }
     slice_length = MAX_SLICE_LENGTH;
 
     is_global_timer_sane = true;
@@ -215,10 +355,15 @@ void Advance() {
         Event evt = std::move(event_queue.front());
         std::pop_heap(event_queue.begin(), event_queue.end(), std::greater<>());
         event_queue.pop_back();
+        if (pending_events.erase(evt.fifo_order) == 0) {
+            // The event was cancelled after being scheduled
+            continue;
+        }
         evt.type->callback(evt.userdata, static_cast<int>(global_timer - evt.time));
     }
 
     is_global_timer_sane = false;
+    PopCancelledEvents();
 
     // Still events left (scheduled in the future)
     if (!event_queue.empty()) {
@@ -234,6 +379,47 @@ void Idle() {
     downcount = 0;
 }
 
+/// Waits on the host until the next event is due or another thread schedules one
+static void WaitForNextEvent() {
+    const s64 start_ticks = GetHostTicks();
+    const s64 ticks_until_event =
+        event_queue.empty() ? MAX_HOST_WAIT : event_queue.front().time - start_ticks;
+    if (ticks_until_event > 0) {
+        const std::chrono::nanoseconds timeout{
+            cyclesToNs(std::min(ticks_until_event, MAX_HOST_WAIT))};
+        std::unique_lock<std::mutex> lock{host_wait_mutex};
+        host_wait_cv.wait_for(lock, timeout, [] { return !ts_queue.Empty(); });
+    }
+    idled_cycles += GetHostTicks() - start_ticks;
+    downcount = 0;
+}
+
+void IdleUntilNextEvent() {
+    MoveEvents();
+    PopCancelledEvents();
+
+    if (use_host_timing) {
+        WaitForNextEvent();
+        return;
+    }
+
+    const int cycles_executed = slice_length - downcount;
+    const s64 cycles_until_event =
+        event_queue.empty() ? 0 : event_queue.front().time - global_timer;
+    if (cycles_until_event <= cycles_executed) {
+        // Nothing to skip to, just finish the current slice
+        Idle();
+        return;
+    }
+
+    // Stretch the slice so that the next Advance() lands exactly on the event
+    const int skipped_slice_length = static_cast<int>(
+        std::min<s64>(cycles_until_event, std::numeric_limits<int>::max()));
+    idled_cycles += skipped_slice_length - cycles_executed;
+    slice_length = skipped_slice_length;
+    downcount = 0;
+}
+
 std::chrono::microseconds GetGlobalTimeUs() {
     return std::chrono::microseconds{GetTicks() * 1000000 / BASE_CLOCK_RATE};
 }
@@ -28,6 +28,12 @@ struct EventType;
 
 using TimedCallback = std::function<void(u64 userdata, int cycles_late)>;
 
+/// Uniquely identifies a single scheduled event, allowing it to be cancelled in constant time.
+using EventHandle = u64;
+
+/// Handle value that never refers to a scheduled event.
+constexpr EventHandle INVALID_EVENT_HANDLE = 0;
+
 /**
  * CoreTiming begins at the boundary of timing slice -1. An initial call to Advance() is
  * required to end slice -1 and start slice 0 before the first cycle of code is executed.
@@ -35,6 +41,13 @@ using TimedCallback = std::function<void(u64 userdata, int cycles_late)>;
 void Init();
 void Shutdown();
 
+/**
+ * Makes guest time follow the host clock, running at the given speed in percent, instead of the
+ * cycles executed by the CPU. Events then fire once the host time they are due at is reached, and
+ * idling waits for it on the host. Init() switches back to cycle based timing.
+ */
+void SetHostTiming(bool enabled, u32 speed_percent = 100);
+
 /**
  * This should only be called from the emu thread, if you are calling it any other thread, you are
  * doing something evil
@@ -43,6 +56,12 @@ u64 GetTicks();
 u64 GetIdleTicks();
 void AddTicks(u64 ticks);
 
+/**
+ * Moves the current time to the given tick count, keeping every scheduled event at the same
+ * distance from it. Used when restoring a savestate.
+ */
+void RestoreTicks(u64 ticks);
+
 /**
  * Returns the event_type identifier. if name is not unique, it will assert.
  */
@@ -54,7 +73,7 @@ void UnregisterAllEvents();
  * is scheduled earlier than the current values.
  * Scheduling from a callback will not update the downcount until the Advance() completes.
  */
-void ScheduleEvent(s64 cycles_into_future, const EventType* event_type, u64 userdata = 0);
+EventHandle ScheduleEvent(s64 cycles_into_future, const EventType* event_type, u64 userdata = 0);
 
 /**
  * This is to be called when outside of hle threads, such as the graphics thread, wants to
@@ -62,11 +81,19 @@ void ScheduleEvent(s64 cycles_into_future, const EventType* event_type, u64 user
  * Not that this doesn't change slice_length and thus events scheduled by this might be called
  * with a delay of up to MAX_SLICE_LENGTH
  */
-void ScheduleEventThreadsafe(s64 cycles_into_future, const EventType* event_type, u64 userdata);
+EventHandle ScheduleEventThreadsafe(s64 cycles_into_future, const EventType* event_type,
+                                    u64 userdata);
 
 void UnscheduleEvent(const EventType* event_type, u64 userdata);
 void UnscheduleEventThreadsafe(const EventType* event_type, u64 userdata);
 
+/**
+ * Cancels the single event identified by the given handle, without searching the queue.
+ * Cancelling an event that has already fired or been cancelled does nothing.
+ */
+void UnscheduleEvent(EventHandle handle);
+void UnscheduleEventThreadsafe(EventHandle handle);
+
 /// We only permit one event of each type in the queue at a time.
 void RemoveEvent(const EventType* event_type);
 void RemoveNormalAndThreadsafeEvent(const EventType* event_type);
@@ -80,9 +107,16 @@ void RemoveNormalAndThreadsafeEvent(const EventType* event_type);
 void Advance();
 void MoveEvents();
 
-/// Pretend that the main CPU has executed enough cycles to reach the next event.
+/// Pretend that the main CPU has executed enough cycles to reach the end of the current slice.
 void Idle();
 
+/**
+ * Pretend that the main CPU has executed enough cycles to reach the next scheduled event, skipping
+ * any slices in between. This must only be used when none of the cores have anything to run, as
+ * the skipped time is not given to any of them.
+ */
+void IdleUntilNextEvent();
+
 /// Clear all pending events. This should ONLY be done on exit.
 void ClearPendingEvents();
 
@@ -0,0 +1,254 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include "common/assert.h"
+#include "core/crypto/aes_ni.h"
+
+#ifdef ARCHITECTURE_x86_64
+#include <wmmintrin.h>
+#include "common/swap.h"
+#include "common/x64/cpu_detect.h"
+#endif
+
+namespace Core::Crypto::AESNI {
+
+#ifdef ARCHITECTURE_x86_64
+
+#if defined(__GNUC__) || defined(__clang__)
+#define AESNI_TARGET __attribute__((target("aes,sse2")))
+#else
+#define AESNI_TARGET
+#endif
+
+namespace {
+
+// Number of blocks transcoded at once, so that the latency of the AES instructions is hidden
+constexpr std::size_t PIPELINE_BLOCKS = 4;
+constexpr std::size_t BLOCK_SIZE = 0x10;
+constexpr std::size_t NUM_ROUNDS = 10;
+
+AESNI_TARGET inline __m128i LoadKey(const RoundKeys& keys, std::size_t round) {
+    return _mm_load_si128(reinterpret_cast<const __m128i*>(keys.data.data() + round * BLOCK_SIZE));
+}
+
+AESNI_TARGET inline void StoreKey(RoundKeys& keys, std::size_t round, __m128i value) {
+    _mm_store_si128(reinterpret_cast<__m128i*>(keys.data.data() + round * BLOCK_SIZE), value);
+}
+
+AESNI_TARGET inline __m128i ExpandKeyStep(__m128i key, __m128i generated) {
+    generated = _mm_shuffle_epi32(generated, 0xFF);
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    return _mm_xor_si128(key, generated);
+}
+
+template <std::size_t N>
+AESNI_TARGET inline void EncryptBlocks(const RoundKeys& keys, __m128i (&blocks)[N]) {
+    const __m128i first_key{LoadKey(keys, 0)};
+    for (std::size_t i = 0; i < N; ++i) {
+        blocks[i] = _mm_xor_si128(blocks[i], first_key);
+    }
+    for (std::size_t round = 1; round < NUM_ROUNDS; ++round) {
+        const __m128i key{LoadKey(keys, round)};
+        for (std::size_t i = 0; i < N; ++i) {
+            blocks[i] = _mm_aesenc_si128(blocks[i], key);
+        }
+    }
+    const __m128i last_key{LoadKey(keys, NUM_ROUNDS)};
+    for (std::size_t i = 0; i < N; ++i) {
+        blocks[i] = _mm_aesenclast_si128(blocks[i], last_key);
+    }
+}
+
+template <std::size_t N>
+AESNI_TARGET inline void DecryptBlocks(const RoundKeys& keys, __m128i (&blocks)[N]) {
+    const __m128i first_key{LoadKey(keys, 0)};
+    for (std::size_t i = 0; i < N; ++i) {
+        blocks[i] = _mm_xor_si128(blocks[i], first_key);
+    }
+    for (std::size_t round = 1; round < NUM_ROUNDS; ++round) {
+        const __m128i key{LoadKey(keys, round)};
+        for (std::size_t i = 0; i < N; ++i) {
+            blocks[i] = _mm_aesdec_si128(blocks[i], key);
+        }
+    }
+    const __m128i last_key{LoadKey(keys, NUM_ROUNDS)};
+    for (std::size_t i = 0; i < N; ++i) {
+        blocks[i] = _mm_aesdeclast_si128(blocks[i], last_key);
+    }
+}
+
+/// Big endian 128-bit counter used by CTR mode
+struct Counter {
+    u64 high;
+    u64 low;
+
+    AESNI_TARGET __m128i GetAndIncrement() {
+        const __m128i block{_mm_set_epi64x(static_cast<s64>(Common::swap64(low)),
+                                           static_cast<s64>(Common::swap64(high)))};
+        if (++low == 0) {
+            ++high;
+        }
+        return block;
+    }
+};
+
+/// Multiplies an XTS tweak by the primitive element of GF(2^128)
+AESNI_TARGET inline __m128i MultiplyTweak(__m128i tweak) {
+    alignas(16) u64 halves[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(halves), tweak);
+    const u64 carry{halves[1] >> 63};
+    halves[1] = (halves[1] << 1) | (halves[0] >> 63);
+    halves[0] = (halves[0] << 1) ^ (carry * 0x87);
+    return _mm_load_si128(reinterpret_cast<const __m128i*>(halves));
+}
+
+/// Transcodes N consecutive XTS blocks, advancing the tweak past them
+template <std::size_t N>
+AESNI_TARGET inline void XTSTranscodeBlocks(const RoundKeys& data_keys, __m128i& tweak,
+                                            const u8* src, u8* dest, bool decrypt) {
+    __m128i blocks[N];
+    __m128i tweaks[N];
+    for (std::size_t i = 0; i < N; ++i) {
+        const auto* const in = reinterpret_cast<const __m128i*>(src + i * BLOCK_SIZE);
+        tweaks[i] = tweak;
+        blocks[i] = _mm_xor_si128(_mm_loadu_si128(in), tweaks[i]);
+        tweak = MultiplyTweak(tweak);
+    }
+    if (decrypt) {
+        DecryptBlocks(data_keys, blocks);
+    } else {
+        EncryptBlocks(data_keys, blocks);
+    }
+    for (std::size_t i = 0; i < N; ++i) {
+        auto* const out = reinterpret_cast<__m128i*>(dest + i * BLOCK_SIZE);
+        _mm_storeu_si128(out, _mm_xor_si128(blocks[i], tweaks[i]));
+    }
+}
+
+} // Anonymous namespace
+
+bool IsSupported() {
+    return Common::GetCPUCaps().aes;
+}
+
+AESNI_TARGET void ExpandKey(const u8* key, RoundKeys& encrypt_keys, RoundKeys* decrypt_keys) {
+    __m128i round_key{_mm_loadu_si128(reinterpret_cast<const __m128i*>(key))};
+    StoreKey(encrypt_keys, 0, round_key);
+
+    // The round constant has to be an immediate
+#define EXPAND_ROUND(round, rcon)                                                                  \
+    round_key = ExpandKeyStep(round_key, _mm_aeskeygenassist_si128(round_key, rcon));              \
+    StoreKey(encrypt_keys, round, round_key)
+    EXPAND_ROUND(1, 0x01);
+    EXPAND_ROUND(2, 0x02);
+    EXPAND_ROUND(3, 0x04);
+    EXPAND_ROUND(4, 0x08);
+    EXPAND_ROUND(5, 0x10);
+    EXPAND_ROUND(6, 0x20);
+    EXPAND_ROUND(7, 0x40);
+    EXPAND_ROUND(8, 0x80);
+    EXPAND_ROUND(9, 0x1B);
+    EXPAND_ROUND(10, 0x36);
+#undef EXPAND_ROUND
+
+    if (decrypt_keys == nullptr) {
+        return;
+    }
+
+    // The equivalent inverse cipher uses the encryption keys in reverse order
+    StoreKey(*decrypt_keys, 0, LoadKey(encrypt_keys, NUM_ROUNDS));
+    for (std::size_t round = 1; round < NUM_ROUNDS; ++round) {
+        StoreKey(*decrypt_keys, round, _mm_aesimc_si128(LoadKey(encrypt_keys, NUM_ROUNDS - round)));
+    }
+    StoreKey(*decrypt_keys, NUM_ROUNDS, LoadKey(encrypt_keys, 0));
+}
+
+AESNI_TARGET void CTRTranscode(const RoundKeys& keys, u8* iv, const u8* src, std::size_t size,
+                               u8* dest) {
+    Counter counter;
+    std::memcpy(&counter.high, iv, sizeof(u64));
+    std::memcpy(&counter.low, iv + sizeof(u64), sizeof(u64));
+    counter.high = Common::swap64(counter.high);
+    counter.low = Common::swap64(counter.low);
+
+    std::size_t offset = 0;
+    for (; offset + PIPELINE_BLOCKS * BLOCK_SIZE <= size; offset += PIPELINE_BLOCKS * BLOCK_SIZE) {
+        __m128i blocks[PIPELINE_BLOCKS];
+        for (auto& block : blocks) {
+            block = counter.GetAndIncrement();
+        }
+        EncryptBlocks(keys, blocks);
+        for (std::size_t i = 0; i < PIPELINE_BLOCKS; ++i) {
+            const auto* const in = reinterpret_cast<const __m128i*>(src + offset + i * BLOCK_SIZE);
+            auto* const out = reinterpret_cast<__m128i*>(dest + offset + i * BLOCK_SIZE);
+            _mm_storeu_si128(out, _mm_xor_si128(blocks[i], _mm_loadu_si128(in)));
+        }
+    }
+
+    for (; offset < size; offset += BLOCK_SIZE) {
+        __m128i blocks[1]{counter.GetAndIncrement()};
+        EncryptBlocks(keys, blocks);
+
+        // CTR is a stream mode, the last block may be partial
+        alignas(16) u8 key_stream[BLOCK_SIZE];
+        _mm_store_si128(reinterpret_cast<__m128i*>(key_stream), blocks[0]);
+        const std::size_t length{std::min(BLOCK_SIZE, size - offset)};
+        for (std::size_t i = 0; i < length; ++i) {
+            dest[offset + i] = src[offset + i] ^ key_stream[i];
+        }
+    }
+
+    counter.high = Common::swap64(counter.high);
+    counter.low = Common::swap64(counter.low);
+    std::memcpy(iv, &counter.high, sizeof(u64));
+    std::memcpy(iv + sizeof(u64), &counter.low, sizeof(u64));
+}
+
+AESNI_TARGET void XTSTranscode(const RoundKeys& data_keys, const RoundKeys& tweak_keys,
+                               const u8* tweak, const u8* src, std::size_t size, u8* dest,
+                               bool decrypt) {
+    ASSERT(size % BLOCK_SIZE == 0);
+
+    __m128i encrypted_tweak[1]{_mm_loadu_si128(reinterpret_cast<const __m128i*>(tweak))};
+    EncryptBlocks(tweak_keys, encrypted_tweak);
+    __m128i current_tweak{encrypted_tweak[0]};
+
+    std::size_t offset = 0;
+    for (; offset + PIPELINE_BLOCKS * BLOCK_SIZE <= size; offset += PIPELINE_BLOCKS * BLOCK_SIZE) {
+        XTSTranscodeBlocks<PIPELINE_BLOCKS>(data_keys, current_tweak, src + offset, dest + offset,
+                                            decrypt);
+    }
+    for (; offset < size; offset += BLOCK_SIZE) {
+        XTSTranscodeBlocks<1>(data_keys, current_tweak, src + offset, dest + offset, decrypt);
+    }
+}
+
+#undef AESNI_TARGET
+
+#else
+
+bool IsSupported() {
+    return false;
+}
+
+void ExpandKey(const u8* key, RoundKeys& encrypt_keys, RoundKeys* decrypt_keys) {
+    UNREACHABLE();
+}
+
+void CTRTranscode(const RoundKeys& keys, u8* iv, const u8* src, std::size_t size, u8* dest) {
+    UNREACHABLE();
+}
+
+void XTSTranscode(const RoundKeys& data_keys, const RoundKeys& tweak_keys, const u8* tweak,
+                  const u8* src, std::size_t size, u8* dest, bool decrypt) {
+    UNREACHABLE();
+}
+
+#endif
+
+} // namespace Core::Crypto::AESNI
@@ -0,0 +1,49 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include "common/common_types.h"
+
+namespace Core::Crypto::AESNI {
+
+/// Expanded round keys of an AES-128 key schedule, stored as they are consumed by AES-NI
+struct alignas(16) RoundKeys {
+    std::array<u8, 11 * 0x10> data;
+};
+
+/// Returns whether the host CPU supports the AES-NI instructions
+bool IsSupported();
+
+/**
+ * Expands an AES-128 key into the round keys used for encryption and decryption.
+ * @param key The 16 byte key to expand
+ * @param encrypt_keys Round keys used to encrypt blocks
+ * @param decrypt_keys Round keys used to decrypt blocks, these may be null when not required
+ */
+void ExpandKey(const u8* key, RoundKeys& encrypt_keys, RoundKeys* decrypt_keys);
+
+/**
+ * Transcodes data in CTR mode. Encryption and decryption are the same operation.
+ * @param keys Encryption round keys
+ * @param iv The 16 byte counter, incremented as a big endian integer for each block. It's left
+ * past the last block, partial or not, as mbedtls does.
+ * @param size Size of the data in bytes, the last block may be partial
+ */
+void CTRTranscode(const RoundKeys& keys, u8* iv, const u8* src, std::size_t size, u8* dest);
+
+/**
+ * Transcodes a single XTS data unit.
+ * @param data_keys Round keys used on the data, the decryption ones when decrypting
+ * @param tweak_keys Encryption round keys of the tweak key
+ * @param tweak The 16 byte tweak of the data unit
+ * @param size Size of the data in bytes, it must be a multiple of 16
+ * @param decrypt Whether to decrypt the data instead of encrypting it
+ */
+void XTSTranscode(const RoundKeys& data_keys, const RoundKeys& tweak_keys, const u8* tweak,
+                  const u8* src, std::size_t size, u8* dest, bool decrypt);
+
+} // namespace Core::Crypto::AESNI
@@ -2,21 +2,22 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
 #include <mbedtls/cipher.h>
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "core/crypto/aes_ni.h"
 #include "core/crypto/aes_util.h"
 #include "core/crypto/key_manager.h"
 
 namespace Core::Crypto {
 namespace {
-std::vector<u8> CalculateNintendoTweak(std::size_t sector_id) {
-    std::vector<u8> out(0x10);
+void CalculateNintendoTweak(std::vector<u8>& out, std::size_t sector_id) {
     for (std::size_t i = 0xF; i <= 0xF; --i) {
         out[i] = sector_id & 0xFF;
         sector_id >>= 8;
     }
-    return out;
 }
 } // Anonymous namespace
 
@@ -34,6 +35,13 @@ static_assert(static_cast<std::size_t>(Mode::XTS) ==
 struct CipherContext {
     mbedtls_cipher_context_t encryption_context;
     mbedtls_cipher_context_t decryption_context;
+
+    // AES-NI implementation of the CTR and XTS modes, used instead of mbedtls when supported
+    bool use_aes_ni = false;
+    AESNI::RoundKeys encrypt_keys;
+    AESNI::RoundKeys decrypt_keys;
+    AESNI::RoundKeys tweak_keys;
+    std::array<u8, 0x10> iv{};
 };
 
 template <typename Key, std::size_t KeySize>
@@ -55,6 +63,19 @@ Crypto::AESCipher<Key, KeySize>::AESCipher(Key key, Mode mode)
     ASSERT(
         !mbedtls_cipher_setkey(&ctx->decryption_context, key.data(), KeySize * 8, MBEDTLS_DECRYPT));
     //"Failed to set key on mbedtls ciphers.");
+
+    if (!AESNI::IsSupported()) {
+        return;
+    }
+    if (mode == Mode::CTR && KeySize == 0x10) {
+        AESNI::ExpandKey(key.data(), ctx->encrypt_keys, nullptr);
+        ctx->use_aes_ni = true;
+    } else if (mode == Mode::XTS && KeySize == 0x20) {
+        // The first half of the key encrypts the data and the second one the tweak
+        AESNI::ExpandKey(key.data(), ctx->encrypt_keys, &ctx->decrypt_keys);
+        AESNI::ExpandKey(key.data() + 0x10, ctx->tweak_keys, nullptr);
+        ctx->use_aes_ni = true;
+    }
 }
 
 template <typename Key, std::size_t KeySize>
@@ -64,16 +85,34 @@ AESCipher<Key, KeySize>::~AESCipher() {
 }
 
 template <typename Key, std::size_t KeySize>
-void AESCipher<Key, KeySize>::SetIV(std::vector<u8> iv) {
+void AESCipher<Key, KeySize>::SetIV(const std::vector<u8>& iv) {
     ASSERT_MSG((mbedtls_cipher_set_iv(&ctx->encryption_context, iv.data(), iv.size()) ||
                 mbedtls_cipher_set_iv(&ctx->decryption_context, iv.data(), iv.size())) == 0,
                "Failed to set IV on mbedtls ciphers.");
+
+    ctx->iv.fill(0);
+    std::copy_n(iv.begin(), std::min(iv.size(), ctx->iv.size()), ctx->iv.begin());
 }
 
 template <typename Key, std::size_t KeySize>
 void AESCipher<Key, KeySize>::Transcode(const u8* src, std::size_t size, u8* dest, Op op) const {
     auto* const context = op == Op::Encrypt ? &ctx->encryption_context : &ctx->decryption_context;
 
+    if (ctx->use_aes_ni) {
+        const auto cipher_mode = mbedtls_cipher_get_cipher_mode(context);
+        if (cipher_mode == MBEDTLS_MODE_CTR) {
+            AESNI::CTRTranscode(ctx->encrypt_keys, ctx->iv.data(), src, size, dest);
+            return;
+        }
+        // Ciphertext stealing is left to mbedtls
+        if (cipher_mode == MBEDTLS_MODE_XTS && size % 0x10 == 0) {
+            const auto& data_keys = op == Op::Encrypt ? ctx->encrypt_keys : ctx->decrypt_keys;
+            AESNI::XTSTranscode(data_keys, ctx->tweak_keys, ctx->iv.data(), src, size, dest,
+                                op == Op::Decrypt);
+            return;
+        }
+    }
+
     mbedtls_cipher_reset(context);
 
     std::size_t written = 0;
@@ -118,8 +157,10 @@ void AESCipher<Key, KeySize>::XTSTranscode(const u8* src, std::size_t size, u8*
                                            std::size_t sector_id, std::size_t sector_size, Op op) {
     ASSERT_MSG(size % sector_size == 0, "XTS decryption size must be a multiple of sector size.");
 
+    std::vector<u8> tweak(0x10);
     for (std::size_t i = 0; i < size; i += sector_size) {
-        SetIV(CalculateNintendoTweak(sector_id++));
+        CalculateNintendoTweak(tweak, sector_id++);
+        SetIV(tweak);
         Transcode<u8, u8>(src + i, sector_size, dest + i, op);
     }
 }
@@ -4,9 +4,12 @@
 
 #include <algorithm>
 #include <array>
+#include <cctype>
+#include <cstring>
 #include <fstream>
+#include <iterator>
 #include <locale>
-#include <sstream>
+#include <mutex>
 #include <string_view>
 #include <tuple>
 #include <vector>
@@ -121,70 +124,182 @@ Loader::ResultStatus DeriveSDKeys(std::array<Key256, 2>& sd_keys, const KeyManag
     return Loader::ResultStatus::Success;
 }
 
+namespace {
+
+/// A key file that was found, and its size when it was parsed
+struct KeyFileInfo {
+    std::string path;
+    u64 size;
+    bool is_title_keys;
+
+    bool operator==(const KeyFileInfo& other) const {
+        return std::tie(path, size, is_title_keys) ==
+               std::tie(other.path, other.size, other.is_title_keys);
+    }
+};
+
+/**
+ * Keys parsed from the key files. Every NCA has a KeyManager of its own, so without this the key
+ * files would be parsed again for each of them. The files are parsed again when they change.
+ */
+struct KeyFileCache {
+    std::vector<KeyFileInfo> files;
+    boost::container::flat_map<KeyIndex<S128KeyType>, Key128> s128_keys;
+    boost::container::flat_map<KeyIndex<S256KeyType>, Key256> s256_keys;
+};
+
+std::mutex key_file_cache_mutex;
+boost::optional<KeyFileCache> key_file_cache;
+
+/// Adds the file to the list if it exists in the first directory, or else in the second one
+void FindKeyFile(std::vector<KeyFileInfo>& files, const std::string& dir1,
+                 const std::string& dir2, const std::string& filename, bool title) {
+    for (const std::string* dir : {&dir1, &dir2}) {
+        const std::string path = *dir + DIR_SEP + filename;
+        if (FileUtil::Exists(path)) {
+            files.push_back({path, FileUtil::GetSize(path), title});
+            return;
+        }
+    }
+}
+
+} // Anonymous namespace
+
 KeyManager::KeyManager() {
     // Initialize keys
     const std::string hactool_keys_dir = FileUtil::GetHactoolConfigurationPath();
     const std::string yuzu_keys_dir = FileUtil::GetUserPath(FileUtil::UserPath::KeysDir);
-    if (Settings::values.use_dev_keys) {
-        dev_mode = true;
-        AttemptLoadKeyFile(yuzu_keys_dir, hactool_keys_dir, "dev.keys", false);
-        AttemptLoadKeyFile(yuzu_keys_dir, yuzu_keys_dir, "dev.keys_autogenerated", false);
+    dev_mode = Settings::values.use_dev_keys;
+
+    std::vector<KeyFileInfo> files;
+    if (dev_mode) {
+        FindKeyFile(files, yuzu_keys_dir, hactool_keys_dir, "dev.keys", false);
+        FindKeyFile(files, yuzu_keys_dir, yuzu_keys_dir, "dev.keys_autogenerated", false);
     } else {
-        dev_mode = false;
-        AttemptLoadKeyFile(yuzu_keys_dir, hactool_keys_dir, "prod.keys", false);
-        AttemptLoadKeyFile(yuzu_keys_dir, yuzu_keys_dir, "prod.keys_autogenerated", false);
+        FindKeyFile(files, yuzu_keys_dir, hactool_keys_dir, "prod.keys", false);
+        FindKeyFile(files, yuzu_keys_dir, yuzu_keys_dir, "prod.keys_autogenerated", false);
+    }
+
+    FindKeyFile(files, yuzu_keys_dir, hactool_keys_dir, "title.keys", true);
+    FindKeyFile(files, yuzu_keys_dir, yuzu_keys_dir, "title.keys_autogenerated", true);
+
+    std::lock_guard<std::mutex> lock(key_file_cache_mutex);
+    if (key_file_cache && key_file_cache->files == files) {
+        s128_keys = key_file_cache->s128_keys;
+        s256_keys = key_file_cache->s256_keys;
+        return;
+    }
+
+    for (const KeyFileInfo& file : files) {
+        LoadFromFile(file.path, file.is_title_keys);
+    }
+    key_file_cache = KeyFileCache{std::move(files), s128_keys, s256_keys};
+}
+
+namespace {
+
+/// Removes the whitespace around a key name or value, including the CR of CRLF line endings
+std::string_view TrimKeyField(std::string_view field) {
+    constexpr std::string_view whitespace = " \t\r";
+    const std::size_t begin = field.find_first_not_of(whitespace);
+    if (begin == std::string_view::npos)
+        return {};
+    return field.substr(begin, field.find_last_not_of(whitespace) - begin + 1);
+}
+
+/// Decodes a key written in hex, returns false if the text isn't a key of that size
+template <std::size_t Size>
+bool ParseHexKey(std::string_view text, std::array<u8, Size>& key) {
+    if (text.size() < Size * 2)
+        return false;
+    for (std::size_t i = 0; i < Size * 2; ++i) {
+        if (!std::isxdigit(static_cast<unsigned char>(text[i])))
+            return false;
+    }
+    key = Common::HexStringToArray<Size>(text);
+    return true;
+}
+
+/**
+ * Adds the keys loaded from a file to the keys already known, in a single pass instead of one
+ * insertion into the sorted map per key. When a key appears more than once, the last one wins.
+ */
+template <typename Map>
+void MergeKeys(Map& keys, std::vector<typename Map::value_type>& new_keys) {
+    using Entry = typename Map::value_type;
+    const auto by_index = [](const Entry& lhs, const Entry& rhs) { return lhs.first < rhs.first; };
+    std::stable_sort(new_keys.begin(), new_keys.end(), by_index);
+
+    // Keep the last of the entries with the same index, and drop the replaced ones from keys
+    std::vector<Entry> unique_keys;
+    unique_keys.reserve(new_keys.size());
+    for (std::size_t i = 0; i < new_keys.size(); ++i) {
+        if (i + 1 == new_keys.size() || by_index(new_keys[i], new_keys[i + 1]))
+            unique_keys.push_back(new_keys[i]);
     }
 
-    AttemptLoadKeyFile(yuzu_keys_dir, hactool_keys_dir, "title.keys", true);
-    AttemptLoadKeyFile(yuzu_keys_dir, yuzu_keys_dir, "title.keys_autogenerated", true);
+    std::vector<Entry> merged;
+    merged.reserve(keys.size() + unique_keys.size());
+    std::set_union(unique_keys.begin(), unique_keys.end(), keys.begin(), keys.end(),
+                   std::back_inserter(merged), by_index);
+    keys = Map(boost::container::ordered_unique_range, merged.begin(), merged.end());
 }
 
+} // Anonymous namespace
+
 void KeyManager::LoadFromFile(const std::string& filename, bool is_title_keys) {
-    std::ifstream file(filename);
-    if (!file.is_open())
+    const FileUtil::MappedFile file(filename);
+    if (!file.IsOpen())
         return;
 
-    std::string line;
-    while (std::getline(file, line)) {
-        std::vector<std::string> out;
-        std::stringstream stream(line);
-        std::string item;
-        while (std::getline(stream, item, '='))
-            out.push_back(std::move(item));
-
-        if (out.size() != 2)
+    std::vector<std::pair<KeyIndex<S128KeyType>, Key128>> new_s128_keys;
+    std::vector<std::pair<KeyIndex<S256KeyType>, Key256>> new_s256_keys;
+
+    const std::string_view contents{reinterpret_cast<const char*>(file.GetData()),
+                                    file.GetSize()};
+    std::string name;
+    for (std::size_t line_begin = 0; line_begin < contents.size();) {
+        std::size_t line_end = contents.find('\n', line_begin);
+        if (line_end == std::string_view::npos)
+            line_end = contents.size();
+        const auto line = contents.substr(line_begin, line_end - line_begin);
+        line_begin = line_end + 1;
+
+        const std::size_t separator = line.find('=');
+        if (separator == std::string_view::npos ||
+            line.find('=', separator + 1) != std::string_view::npos) {
             continue;
-
-        out[0].erase(std::remove(out[0].begin(), out[0].end(), ' '), out[0].end());
-        out[1].erase(std::remove(out[1].begin(), out[1].end(), ' '), out[1].end());
+        }
+        const auto key_name = TrimKeyField(line.substr(0, separator));
+        const auto key_value = TrimKeyField(line.substr(separator + 1));
 
         if (is_title_keys) {
-            auto rights_id_raw = Common::HexStringToArray<16>(out[0]);
+            Key128 rights_id_raw;
+            Key128 key;
+            if (!ParseHexKey(key_name, rights_id_raw) || !ParseHexKey(key_value, key))
+                continue;
             u128 rights_id{};
             std::memcpy(rights_id.data(), rights_id_raw.data(), rights_id_raw.size());
-            Key128 key = Common::HexStringToArray<16>(out[1]);
-            s128_keys[{S128KeyType::Titlekey, rights_id[1], rights_id[0]}] = key;
-        } else {
-            std::transform(out[0].begin(), out[0].end(), out[0].begin(), ::tolower);
-            if (s128_file_id.find(out[0]) != s128_file_id.end()) {
-                const auto index = s128_file_id.at(out[0]);
-                Key128 key = Common::HexStringToArray<16>(out[1]);
-                s128_keys[{index.type, index.field1, index.field2}] = key;
-            } else if (s256_file_id.find(out[0]) != s256_file_id.end()) {
-                const auto index = s256_file_id.at(out[0]);
-                Key256 key = Common::HexStringToArray<32>(out[1]);
-                s256_keys[{index.type, index.field1, index.field2}] = key;
-            }
+            new_s128_keys.emplace_back(
+                KeyIndex<S128KeyType>{S128KeyType::Titlekey, rights_id[1], rights_id[0]}, key);
+            continue;
+        }
+
+        name.assign(key_name);
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        if (const auto iter = s128_file_id.find(name); iter != s128_file_id.end()) {
+            Key128 key;
+            if (ParseHexKey(key_value, key))
+                new_s128_keys.emplace_back(iter->second, key);
+        } else if (const auto iter = s256_file_id.find(name); iter != s256_file_id.end()) {
+            Key256 key;
+            if (ParseHexKey(key_value, key))
+                new_s256_keys.emplace_back(iter->second, key);
         }
     }
-}
 
-void KeyManager::AttemptLoadKeyFile(const std::string& dir1, const std::string& dir2,
-                                    const std::string& filename, bool title) {
-    if (FileUtil::Exists(dir1 + DIR_SEP + filename))
-        LoadFromFile(dir1 + DIR_SEP + filename, title);
-    else if (FileUtil::Exists(dir2 + DIR_SEP + filename))
-        LoadFromFile(dir2 + DIR_SEP + filename, title);
+    MergeKeys(s128_keys, new_s128_keys);
+    MergeKeys(s256_keys, new_s256_keys);
 }
 
 bool KeyManager::HasKey(S128KeyType id, u64 field1, u64 field2) const {
@@ -227,7 +342,6 @@ void KeyManager::WriteKeyToFile(bool title_key, std::string_view keyname,
     }
 
     file << fmt::format("\n{} = {}", keyname, Common::HexArrayToString(key));
-    AttemptLoadKeyFile(yuzu_keys_dir, yuzu_keys_dir, filename, title_key);
 }
 
 void KeyManager::SetKey(S128KeyType id, Key128 key, u64 field1, u64 field2) {
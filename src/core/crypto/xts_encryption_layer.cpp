@@ -3,56 +3,67 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
 #include <cstring>
 #include "common/assert.h"
 #include "core/crypto/xts_encryption_layer.h"
 
 namespace Core::Crypto {
 
-constexpr u64 XTS_SECTOR_SIZE = 0x4000;
+constexpr std::size_t XTS_SECTOR_SIZE = 0x4000;
 
 XTSEncryptionLayer::XTSEncryptionLayer(FileSys::VirtualFile base_, Key256 key_)
     : EncryptionLayer(std::move(base_)), cipher(key_, Mode::XTS) {}
 
 std::size_t XTSEncryptionLayer::Read(u8* data, std::size_t length, std::size_t offset) const {
-    if (length == 0)
-        return 0;
-
-    const auto sector_offset = offset & 0x3FFF;
-    if (sector_offset == 0) {
-        if (length % XTS_SECTOR_SIZE == 0) {
-            std::vector<u8> raw = base->ReadBytes(length, offset);
-            cipher.XTSTranscode(raw.data(), raw.size(), data, offset / XTS_SECTOR_SIZE,
-                                XTS_SECTOR_SIZE, Op::Decrypt);
-            return raw.size();
+    std::size_t total_read = 0;
+    while (length > 0) {
+        const std::size_t sector_offset = offset % XTS_SECTOR_SIZE;
+        std::size_t read = 0;
+        if (sector_offset == 0 && length >= XTS_SECTOR_SIZE) {
+            read = ReadSectors(data, length - length % XTS_SECTOR_SIZE, offset);
         }
-        if (length > XTS_SECTOR_SIZE) {
-            const auto rem = length % XTS_SECTOR_SIZE;
-            const auto read = length - rem;
-            return Read(data, read, offset) + Read(data + read, rem, offset + read);
+        // Unaligned heads and tails, or a sector cut short by the end of the file
+        if (read == 0) {
+            const std::size_t sector_length{std::min(length, XTS_SECTOR_SIZE - sector_offset)};
+            read = ReadPartialSector(data, sector_length, offset);
         }
-        std::vector<u8> buffer = base->ReadBytes(XTS_SECTOR_SIZE, offset);
-        if (buffer.size() < XTS_SECTOR_SIZE)
-            buffer.resize(XTS_SECTOR_SIZE);
-        cipher.XTSTranscode(buffer.data(), buffer.size(), buffer.data(), offset / XTS_SECTOR_SIZE,
-                            XTS_SECTOR_SIZE, Op::Decrypt);
-        std::memcpy(data, buffer.data(), std::min(buffer.size(), length));
-        return std::min(buffer.size(), length);
-    }
+        if (read == 0)
+            break;
 
-    // offset does not fall on block boundary (0x4000)
-    std::vector<u8> block = base->ReadBytes(0x4000, offset - sector_offset);
-    if (block.size() < XTS_SECTOR_SIZE)
-        block.resize(XTS_SECTOR_SIZE);
-    cipher.XTSTranscode(block.data(), block.size(), block.data(),
-                        (offset - sector_offset) / XTS_SECTOR_SIZE, XTS_SECTOR_SIZE, Op::Decrypt);
-    const std::size_t read = XTS_SECTOR_SIZE - sector_offset;
-
-    if (length + sector_offset < XTS_SECTOR_SIZE) {
-        std::memcpy(data, block.data() + sector_offset, std::min<u64>(length, read));
-        return std::min<u64>(length, read);
+        total_read += read;
+        data += read;
+        offset += read;
+        length -= read;
     }
-    std::memcpy(data, block.data() + sector_offset, read);
-    return read + Read(data + read, length - read, offset + read);
+    return total_read;
+}
+
+std::size_t XTSEncryptionLayer::ReadSectors(u8* data, std::size_t length,
+                                            std::size_t offset) const {
+    // Whole sectors are decrypted in place in the caller's buffer
+    const std::size_t read = base->Read(data, length, offset);
+    const std::size_t sectors_read = read - read % XTS_SECTOR_SIZE;
+    cipher.XTSTranscode(data, sectors_read, data, offset / XTS_SECTOR_SIZE, XTS_SECTOR_SIZE,
+                        Op::Decrypt);
+    return sectors_read;
+}
+
+std::size_t XTSEncryptionLayer::ReadPartialSector(u8* data, std::size_t length,
+                                                  std::size_t offset) const {
+    const std::size_t sector_offset = offset % XTS_SECTOR_SIZE;
+    const std::size_t sector_start = offset - sector_offset;
+
+    // Sectors cut short by the end of the file are decrypted as if they were zero padded
+    std::array<u8, XTS_SECTOR_SIZE> sector{};
+    const std::size_t read = base->Read(sector.data(), sector.size(), sector_start);
+    if (read <= sector_offset)
+        return 0;
+    cipher.XTSTranscode(sector.data(), sector.size(), sector.data(),
+                        sector_start / XTS_SECTOR_SIZE, XTS_SECTOR_SIZE, Op::Decrypt);
+
+    const std::size_t copied = std::min(length, read - sector_offset);
+    std::memcpy(data, sector.data() + sector_offset, copied);
+    return copied;
 }
 } // namespace Core::Crypto
@@ -18,6 +18,12 @@ public:
     std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override;
 
 private:
+    /// Reads and decrypts whole sectors, returns the size of the sectors that could be read.
+    std::size_t ReadSectors(u8* data, std::size_t length, std::size_t offset) const;
+
+    /// Reads part of a single sector by decrypting all of it in a temporary buffer.
+    std::size_t ReadPartialSector(u8* data, std::size_t length, std::size_t offset) const;
+
     // Must be mutable as operations modify cipher contexts.
     mutable AESCipher<Key256> cipher;
 };
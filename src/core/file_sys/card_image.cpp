@@ -20,7 +20,7 @@ namespace FileSys {
 
 constexpr std::array<const char*, 0x4> partition_names = {"update", "normal", "secure", "logo"};
 
-XCI::XCI(VirtualFile file_) : file(std::move(file_)), partitions(0x4) {
+XCI::XCI(VirtualFile file_) : file(std::move(file_)) {
     if (file->ReadObject(&header) != sizeof(GamecardHeader)) {
         status = Loader::ResultStatus::ErrorBadXCIHeader;
         return;
@@ -41,14 +41,14 @@ XCI::XCI(VirtualFile file_) : file(std::move(file_)), partitions(0x4) {
 
     for (XCIPartition partition :
          {XCIPartition::Update, XCIPartition::Normal, XCIPartition::Secure, XCIPartition::Logo}) {
-        auto raw = main_hfs.GetFile(partition_names[static_cast<std::size_t>(partition)]);
-        if (raw != nullptr)
-            partitions[static_cast<std::size_t>(partition)] =
-                std::make_shared<PartitionFilesystem>(raw);
+        raw_partitions[static_cast<std::size_t>(partition)] =
+            main_hfs.GetFile(partition_names[static_cast<std::size_t>(partition)]);
     }
 
+    // Only the secure partition holds the NCAs of the title itself, the update partition alone
+    // holds dozens of system NCAs whose headers would have to be decrypted
     secure_partition = std::make_shared<NSP>(
-        main_hfs.GetFile(partition_names[static_cast<std::size_t>(XCIPartition::Secure)]));
+        raw_partitions[static_cast<std::size_t>(XCIPartition::Secure)]);
 
     const auto secure_ncas = secure_partition->GetNCAsCollapsed();
     std::copy(secure_ncas.begin(), secure_ncas.end(), std::back_inserter(ncas));
@@ -59,26 +59,12 @@ XCI::XCI(VirtualFile file_) : file(std::move(file_)), partitions(0x4) {
     if (program_nca_status == Loader::ResultStatus::ErrorNSPMissingProgramNCA)
         program_nca_status = Loader::ResultStatus::ErrorXCIMissingProgramNCA;
 
-    auto result = AddNCAFromPartition(XCIPartition::Update);
-    if (result != Loader::ResultStatus::Success) {
-        status = result;
+    if (raw_partitions[static_cast<std::size_t>(XCIPartition::Update)] == nullptr ||
+        raw_partitions[static_cast<std::size_t>(XCIPartition::Normal)] == nullptr) {
+        status = Loader::ResultStatus::ErrorXCIMissingPartition;
         return;
     }
 
-    result = AddNCAFromPartition(XCIPartition::Normal);
-    if (result != Loader::ResultStatus::Success) {
-        status = result;
-        return;
-    }
-
-    if (GetFormatVersion() >= 0x2) {
-        result = AddNCAFromPartition(XCIPartition::Logo);
-        if (result != Loader::ResultStatus::Success) {
-            status = result;
-            return;
-        }
-    }
-
     status = Loader::ResultStatus::Success;
 }
 
@@ -93,7 +79,11 @@ Loader::ResultStatus XCI::GetProgramNCAStatus() const {
 }
 
 VirtualDir XCI::GetPartition(XCIPartition partition) const {
-    return partitions[static_cast<std::size_t>(partition)];
+    const auto index = static_cast<std::size_t>(partition);
+    if (partitions[index] == nullptr && raw_partitions[index] != nullptr) {
+        partitions[index] = std::make_shared<PartitionFilesystem>(raw_partitions[index]);
+    }
+    return partitions[index];
 }
 
 std::shared_ptr<NSP> XCI::GetSecurePartitionNSP() const {
@@ -131,14 +121,24 @@ VirtualFile XCI::GetProgramNCAFile() const {
 }
 
 const std::vector<std::shared_ptr<NCA>>& XCI::GetNCAs() const {
+    LoadNonSecureNCAs();
     return ncas;
 }
 
 std::shared_ptr<NCA> XCI::GetNCAByType(NCAContentType type) const {
-    const auto iter =
-        std::find_if(ncas.begin(), ncas.end(),
-                     [type](const std::shared_ptr<NCA>& nca) { return nca->GetType() == type; });
-    return iter == ncas.end() ? nullptr : *iter;
+    const auto find = [this, type] {
+        const auto iter = std::find_if(
+            ncas.begin(), ncas.end(),
+            [type](const std::shared_ptr<NCA>& nca) { return nca->GetType() == type; });
+        return iter == ncas.end() ? nullptr : *iter;
+    };
+
+    // The program and control NCAs are found in the secure partition, without the other ones
+    if (auto nca = find(); nca != nullptr || are_non_secure_ncas_loaded) {
+        return nca;
+    }
+    LoadNonSecureNCAs();
+    return find();
 }
 
 VirtualFile XCI::GetNCAFileByType(NCAContentType type) const {
@@ -168,21 +168,27 @@ bool XCI::ReplaceFileWithSubdirectory(VirtualFile file, VirtualDir dir) {
     return false;
 }
 
-Loader::ResultStatus XCI::AddNCAFromPartition(XCIPartition part) {
-    if (partitions[static_cast<std::size_t>(part)] == nullptr) {
-        return Loader::ResultStatus::ErrorXCIMissingPartition;
+void XCI::LoadNonSecureNCAs() const {
+    if (are_non_secure_ncas_loaded || status != Loader::ResultStatus::Success) {
+        return;
+    }
+    are_non_secure_ncas_loaded = true;
+
+    AddNCAFromPartition(XCIPartition::Update);
+    AddNCAFromPartition(XCIPartition::Normal);
+    if (GetFormatVersion() >= 0x2) {
+        AddNCAFromPartition(XCIPartition::Logo);
     }
+}
 
-    for (const VirtualFile& file : partitions[static_cast<std::size_t>(part)]->GetFiles()) {
+void XCI::AddNCAFromPartition(XCIPartition part) const {
+    for (const VirtualFile& file : GetPartition(part)->GetFiles()) {
         if (file->GetExtension() != "nca")
             continue;
         auto nca = std::make_shared<NCA>(file);
         // TODO(DarkLordZach): Add proper Rev1+ Support
         if (nca->IsUpdate())
             continue;
-        if (nca->GetType() == NCAContentType::Program) {
-            program_nca_status = nca->GetStatus();
-        }
         if (nca->GetStatus() == Loader::ResultStatus::Success) {
             ncas.push_back(std::move(nca));
         } else {
@@ -192,11 +198,9 @@ Loader::ResultStatus XCI::AddNCAFromPartition(XCIPartition part) {
                          nca->GetStatus());
         }
     }
-
-    return Loader::ResultStatus::Success;
 }
 
 u8 XCI::GetFormatVersion() const {
-    return GetLogoPartition() == nullptr ? 0x1 : 0x2;
+    return raw_partitions[static_cast<std::size_t>(XCIPartition::Logo)] == nullptr ? 0x1 : 0x2;
 }
 } // namespace FileSys
@@ -98,7 +98,9 @@ protected:
     bool ReplaceFileWithSubdirectory(VirtualFile file, VirtualDir dir) override;
 
 private:
-    Loader::ResultStatus AddNCAFromPartition(XCIPartition part);
+    /// Adds the NCAs of the partitions besides the secure one, which are only parsed on demand
+    void LoadNonSecureNCAs() const;
+    void AddNCAFromPartition(XCIPartition part) const;
 
     VirtualFile file;
     GamecardHeader header{};
@@ -106,9 +108,14 @@ private:
     Loader::ResultStatus status;
     Loader::ResultStatus program_nca_status;
 
-    std::vector<VirtualDir> partitions;
+    /// Partition files of the root HFS0, they are parsed on their first access
+    std::array<VirtualFile, 4> raw_partitions;
+    mutable std::array<VirtualDir, 4> partitions;
+
     std::shared_ptr<NSP> secure_partition;
     std::shared_ptr<NCA> program;
-    std::vector<std::shared_ptr<NCA>> ncas;
+    /// NCAs of the secure partition, followed by the other ones once they are loaded
+    mutable std::vector<std::shared_ptr<NCA>> ncas;
+    mutable bool are_non_secure_ncas_loaded = false;
 };
 } // namespace FileSys
@@ -15,6 +15,7 @@
 #include "core/file_sys/nca_patch.h"
 #include "core/file_sys/partition_filesystem.h"
 #include "core/file_sys/romfs.h"
+#include "core/file_sys/vfs_cached.h"
 #include "core/file_sys/vfs_offset.h"
 #include "core/loader/loader.h"
 
@@ -204,7 +205,7 @@ VirtualFile NCA::Decrypt(NCASectionHeader s_header, VirtualFile in, u64 starting
             for (u8 i = 0; i < 8; ++i)
                 iv[i] = s_header.raw.section_ctr[0x8 - i - 1];
             out->SetIV(iv);
-            return std::static_pointer_cast<VfsFile>(out);
+            return std::make_shared<CachedVfsFile>(std::move(out), GetDecryptedBlockCache());
         }
     case NCASectionCryptoType::XTS:
         // TODO(DarkLordZach): Find a test case for XTS-encrypted NCAs
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 
@@ -11,6 +12,7 @@
 #include "core/file_sys/patch_manager.h"
 #include "core/file_sys/registered_cache.h"
 #include "core/file_sys/romfs.h"
+#include "core/file_sys/vfs_layered.h"
 #include "core/hle/service/filesystem/filesystem.h"
 #include "core/loader/loader.h"
 
@@ -31,8 +33,9 @@ std::string FormatTitleVersion(u32 version, TitleVersionFormat format) {
     return fmt::format("v{}.{}.{}", bytes[3], bytes[2], bytes[1]);
 }
 
-constexpr std::array<const char*, 1> PATCH_TYPE_NAMES{
+constexpr std::array<const char*, 2> PATCH_TYPE_NAMES{
     "Update",
+    "LayeredFS",
 };
 
 std::string FormatPatchTypeName(PatchType type) {
@@ -87,9 +90,58 @@ VirtualFile PatchManager::PatchRomFS(VirtualFile romfs, u64 ivfc_offset,
         }
     }
 
+    // LayeredFS
+    if (type == ContentRecordType::Program) {
+        const auto mod_dirs = GetRomFSModDirectories();
+        if (!mod_dirs.empty()) {
+            romfs = ApplyLayeredFS(std::move(romfs), mod_dirs);
+        }
+    }
+
     return romfs;
 }
 
+std::vector<VirtualDir> PatchManager::GetRomFSModDirectories() const {
+    const auto load_dir = Service::FileSystem::GetModificationLoadRoot(title_id);
+    if (load_dir == nullptr)
+        return {};
+
+    // Mods are layered in the order of their names, the first one being on top
+    auto mods = load_dir->GetSubdirectories();
+    std::sort(mods.begin(), mods.end(), [](const VirtualDir& lhs, const VirtualDir& rhs) {
+        return lhs->GetName() < rhs->GetName();
+    });
+
+    std::vector<VirtualDir> romfs_dirs;
+    for (const auto& mod : mods) {
+        auto romfs_dir = mod->GetSubdirectory("romfs");
+        if (romfs_dir != nullptr)
+            romfs_dirs.push_back(std::move(romfs_dir));
+    }
+    return romfs_dirs;
+}
+
+VirtualFile PatchManager::ApplyLayeredFS(VirtualFile romfs,
+                                         std::vector<VirtualDir> mod_dirs) const {
+    const auto extracted = ExtractRomFS(romfs);
+    if (extracted == nullptr) {
+        LOG_ERROR(Loader, "    RomFS: Could not extract the RomFS to apply LayeredFS");
+        return romfs;
+    }
+
+    const std::size_t num_mods = mod_dirs.size();
+    mod_dirs.push_back(extracted);
+    const auto layered = LayeredVfsDirectory::MakeLayeredDirectory(std::move(mod_dirs));
+    auto packed = CreateRomFS(layered, romfs->GetName());
+    if (packed == nullptr) {
+        LOG_ERROR(Loader, "    RomFS: Could not rebuild the RomFS to apply LayeredFS");
+        return romfs;
+    }
+
+    LOG_INFO(Loader, "    RomFS: LayeredFS patches applied successfully ({} mods)", num_mods);
+    return packed;
+}
+
 std::map<PatchType, std::string> PatchManager::GetPatchVersionNames() const {
     std::map<PatchType, std::string> out;
     const auto installed = Service::FileSystem::GetUnionContents();
@@ -112,6 +164,9 @@ std::map<PatchType, std::string> PatchManager::GetPatchVersionNames() const {
         }
     }
 
+    if (!GetRomFSModDirectories().empty())
+        out[PatchType::LayeredFS] = "";
+
     return out;
 }
 
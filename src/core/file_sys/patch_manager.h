@@ -7,6 +7,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 #include "common/common_types.h"
 #include "core/file_sys/nca_metadata.h"
 #include "core/file_sys/vfs.h"
@@ -26,6 +27,7 @@ std::string FormatTitleVersion(u32 version,
 
 enum class PatchType {
     Update,
+    LayeredFS,
 };
 
 std::string FormatPatchTypeName(PatchType type);
@@ -41,6 +43,7 @@ public:
 
     // Currently tracked RomFS patches:
     // - Game Updates
+    // - LayeredFS
     VirtualFile PatchRomFS(VirtualFile base, u64 ivfc_offset,
                            ContentRecordType type = ContentRecordType::Program) const;
 
@@ -57,6 +60,12 @@ public:
         const std::shared_ptr<NCA>& nca) const;
 
 private:
+    // Returns the romfs directories of the mods installed for the title, uppermost layer first
+    std::vector<VirtualDir> GetRomFSModDirectories() const;
+
+    // Rebuilds the RomFS with the files of the mod directories replacing or adding to its own
+    VirtualFile ApplyLayeredFS(VirtualFile romfs, std::vector<VirtualDir> mod_dirs) const;
+
     u64 title_id;
 };
 
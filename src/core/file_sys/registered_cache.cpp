@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <chrono>
 #include <regex>
 #include <mbedtls/sha256.h>
 #include "common/assert.h"
@@ -245,12 +246,27 @@ void RegisteredCache::AccumulateYuzuMeta() {
     }
 }
 
+void RegisteredCache::RebuildIndex() {
+    std::vector<std::pair<RegisteredCacheEntry, TitleType>> entries;
+    IterateAllMetadata<std::pair<RegisteredCacheEntry, TitleType>>(
+        entries,
+        [](const CNMT& c, const ContentRecord& r) {
+            return std::make_pair(RegisteredCacheEntry{c.GetTitleID(), r.type}, c.GetType());
+        },
+        [](const CNMT& c, const ContentRecord& r) { return true; });
+
+    index.clear();
+    index.insert(entries.begin(), entries.end());
+    ++index_generation;
+}
+
 void RegisteredCache::Refresh() {
     if (dir == nullptr)
         return;
     const auto ids = AccumulateFiles();
     ProcessFiles(ids);
     AccumulateYuzuMeta();
+    RebuildIndex();
 }
 
 RegisteredCache::RegisteredCache(VirtualDir dir_, RegisteredCacheParsingFunction parsing_function)
@@ -268,6 +284,10 @@ bool RegisteredCache::HasEntry(RegisteredCacheEntry entry) const {
     return GetEntryRaw(entry) != nullptr;
 }
 
+boost::optional<NcaID> RegisteredCache::GetEntryNcaID(u64 title_id, ContentRecordType type) const {
+    return GetNcaIDFromMetadata(title_id, type);
+}
+
 VirtualFile RegisteredCache::GetEntryUnparsed(u64 title_id, ContentRecordType type) const {
     const auto id = GetNcaIDFromMetadata(title_id, type);
     if (id == boost::none)
@@ -371,6 +391,81 @@ std::vector<RegisteredCacheEntry> RegisteredCache::ListEntriesFilter(
     return out;
 }
 
+namespace {
+// Passes reads through to the wrapped file, hashing them as long as they're sequential. Copies read
+// the source from start to end, so this verifies an NCA in the same pass that installs it.
+class HashingVfsFile : public VfsFile {
+public:
+    explicit HashingVfsFile(VirtualFile base) : base(std::move(base)) {
+        mbedtls_sha256_init(&context);
+        mbedtls_sha256_starts(&context, 0);
+    }
+
+    ~HashingVfsFile() override {
+        mbedtls_sha256_free(&context);
+    }
+
+    std::string GetName() const override {
+        return base->GetName();
+    }
+
+    std::size_t GetSize() const override {
+        return base->GetSize();
+    }
+
+    bool Resize(std::size_t new_size) override {
+        return false;
+    }
+
+    std::shared_ptr<VfsDirectory> GetContainingDirectory() const override {
+        return base->GetContainingDirectory();
+    }
+
+    bool IsWritable() const override {
+        return false;
+    }
+
+    bool IsReadable() const override {
+        return base->IsReadable();
+    }
+
+    std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override {
+        const std::size_t read = base->Read(data, length, offset);
+        if (offset == hashed_size && !out_of_order) {
+            mbedtls_sha256_update(&context, data, read);
+            hashed_size += read;
+        } else if (offset > hashed_size) {
+            // Skipping ahead leaves a gap in the hash, reading earlier data again doesn't.
+            out_of_order = true;
+        }
+        return read;
+    }
+
+    std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override {
+        return 0;
+    }
+
+    bool Rename(std::string_view name) override {
+        return false;
+    }
+
+    /// Returns the hash of the whole file, or none if it wasn't read sequentially up to its end
+    boost::optional<Core::Crypto::SHA256Hash> GetHash() const {
+        if (out_of_order || hashed_size != base->GetSize())
+            return boost::none;
+        Core::Crypto::SHA256Hash hash{};
+        mbedtls_sha256_finish(&context, hash.data());
+        return hash;
+    }
+
+private:
+    VirtualFile base;
+    mutable mbedtls_sha256_context context;
+    mutable std::size_t hashed_size = 0;
+    mutable bool out_of_order = false;
+};
+} // Anonymous namespace
+
 static std::shared_ptr<NCA> GetNCAFromNSPForID(std::shared_ptr<NSP> nsp, const NcaID& id) {
     const auto file = nsp->GetFile(fmt::format("{}.nca", Common::HexArrayToString(id, false)));
     if (file == nullptr)
@@ -412,7 +507,8 @@ InstallResult RegisteredCache::InstallEntry(std::shared_ptr<NSP> nsp, bool overw
         const auto nca = GetNCAFromNSPForID(nsp, record.nca_id);
         if (nca == nullptr)
             return InstallResult::ErrorCopyFailed;
-        const auto res2 = RawInstallNCA(nca, copy, overwrite_if_exists, record.nca_id);
+        const auto res2 =
+            RawInstallNCA(nca, copy, overwrite_if_exists, record.nca_id, record.hash);
         if (res2 != InstallResult::Success)
             return res2;
     }
@@ -441,12 +537,19 @@ InstallResult RegisteredCache::InstallEntry(std::shared_ptr<NCA> nca, TitleType
     const CNMT new_cnmt(header, opt_header, {c_rec}, {});
     if (!RawInstallYuzuMeta(new_cnmt))
         return InstallResult::ErrorMetaFailed;
-    return RawInstallNCA(nca, copy, overwrite_if_exists, c_rec.nca_id);
+    const auto result = RawInstallNCA(nca, copy, overwrite_if_exists, c_rec.nca_id);
+    if (result == InstallResult::Success) {
+        // The metadata was refreshed before the NCA was there, only its entry is missing
+        index.insert_or_assign(RegisteredCacheEntry{nca->GetTitleId(), c_rec.type}, type);
+        ++index_generation;
+    }
+    return result;
 }
 
 InstallResult RegisteredCache::RawInstallNCA(std::shared_ptr<NCA> nca, const VfsCopyFunction& copy,
                                              bool overwrite_if_exists,
-                                             boost::optional<NcaID> override_id) {
+                                             boost::optional<NcaID> override_id,
+                                             boost::optional<Core::Crypto::SHA256Hash> hash_check) {
     const auto in = nca->GetBaseFile();
     Core::Crypto::SHA256Hash hash{};
 
@@ -480,7 +583,30 @@ InstallResult RegisteredCache::RawInstallNCA(std::shared_ptr<NCA> nca, const Vfs
     auto out = dir->CreateFileRelative(path);
     if (out == nullptr)
         return InstallResult::ErrorCopyFailed;
-    return copy(in, out) ? InstallResult::Success : InstallResult::ErrorCopyFailed;
+
+    const auto hashing_in = hash_check ? std::make_shared<HashingVfsFile>(in) : nullptr;
+    const auto start = std::chrono::steady_clock::now();
+    if (!copy(hashing_in != nullptr ? hashing_in : in, out))
+        return InstallResult::ErrorCopyFailed;
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    const double size_mib = in->GetSize() / (1024.0 * 1024.0);
+    LOG_INFO(Loader, "Installed {} ({:.1f} MiB in {:.2f}s, {:.1f} MiB/s)", path, size_mib,
+             elapsed.count(), size_mib / std::max(elapsed.count(), 1e-6));
+
+    if (hashing_in != nullptr) {
+        const auto actual_hash = hashing_in->GetHash();
+        if (actual_hash == boost::none) {
+            LOG_WARNING(Loader, "The copy didn't read {} sequentially, skipping verification.",
+                        path);
+        } else if (*actual_hash != *hash_check) {
+            LOG_ERROR(Loader, "The hash of {} doesn't match its content record.", path);
+            out->GetContainingDirectory()->DeleteFile(out->GetName());
+            return InstallResult::ErrorHashMismatch;
+        }
+    }
+
+    return InstallResult::Success;
 }
 
 bool RegisteredCache::RawInstallYuzuMeta(const CNMT& cnmt) {
@@ -519,10 +645,37 @@ void RegisteredCacheUnion::Refresh() {
         c->Refresh();
 }
 
+void RegisteredCacheUnion::UpdateIndex() const {
+    std::vector<u64> generations;
+    generations.reserve(caches.size());
+    for (const auto& c : caches)
+        generations.push_back(c == nullptr ? 0 : c->index_generation);
+    if (generations == index_generations)
+        return;
+
+    // Each cache's index is already sorted, with the first cache taking precedence on conflicts
+    index.clear();
+    for (std::size_t i = 0; i < caches.size(); ++i) {
+        if (caches[i] == nullptr)
+            continue;
+        for (const auto& [entry, title_type] : caches[i]->index)
+            index.emplace(entry, UnionEntry{i, title_type});
+    }
+    index_generations = std::move(generations);
+}
+
+const RegisteredCache* RegisteredCacheUnion::FindCache(u64 title_id,
+                                                       ContentRecordType type) const {
+    std::lock_guard<std::mutex> lock{index_mutex};
+    UpdateIndex();
+    const auto iter = index.find(RegisteredCacheEntry{title_id, type});
+    if (iter == index.end())
+        return nullptr;
+    return caches[iter->second.cache_index].get();
+}
+
 bool RegisteredCacheUnion::HasEntry(u64 title_id, ContentRecordType type) const {
-    return std::any_of(caches.begin(), caches.end(), [title_id, type](const auto& cache) {
-        return cache->HasEntry(title_id, type);
-    });
+    return FindCache(title_id, type) != nullptr;
 }
 
 bool RegisteredCacheUnion::HasEntry(RegisteredCacheEntry entry) const {
@@ -540,13 +693,10 @@ boost::optional<u32> RegisteredCacheUnion::GetEntryVersion(u64 title_id) const {
 }
 
 VirtualFile RegisteredCacheUnion::GetEntryUnparsed(u64 title_id, ContentRecordType type) const {
-    for (const auto& c : caches) {
-        const auto res = c->GetEntryUnparsed(title_id, type);
-        if (res != nullptr)
-            return res;
-    }
-
-    return nullptr;
+    const auto cache = FindCache(title_id, type);
+    if (cache == nullptr)
+        return nullptr;
+    return cache->GetEntryUnparsed(title_id, type);
 }
 
 VirtualFile RegisteredCacheUnion::GetEntryUnparsed(RegisteredCacheEntry entry) const {
@@ -554,13 +704,10 @@ VirtualFile RegisteredCacheUnion::GetEntryUnparsed(RegisteredCacheEntry entry) c
 }
 
 VirtualFile RegisteredCacheUnion::GetEntryRaw(u64 title_id, ContentRecordType type) const {
-    for (const auto& c : caches) {
-        const auto res = c->GetEntryRaw(title_id, type);
-        if (res != nullptr)
-            return res;
-    }
-
-    return nullptr;
+    const auto cache = FindCache(title_id, type);
+    if (cache == nullptr)
+        return nullptr;
+    return cache->GetEntryRaw(title_id, type);
 }
 
 VirtualFile RegisteredCacheUnion::GetEntryRaw(RegisteredCacheEntry entry) const {
@@ -579,37 +726,31 @@ std::shared_ptr<NCA> RegisteredCacheUnion::GetEntry(RegisteredCacheEntry entry)
 }
 
 std::vector<RegisteredCacheEntry> RegisteredCacheUnion::ListEntries() const {
-    std::vector<RegisteredCacheEntry> out;
-    for (const auto& c : caches) {
-        c->IterateAllMetadata<RegisteredCacheEntry>(
-            out,
-            [](const CNMT& c, const ContentRecord& r) {
-                return RegisteredCacheEntry{c.GetTitleID(), r.type};
-            },
-            [](const CNMT& c, const ContentRecord& r) { return true; });
-    }
-    return out;
+    return ListEntriesFilter();
 }
 
 std::vector<RegisteredCacheEntry> RegisteredCacheUnion::ListEntriesFilter(
     boost::optional<TitleType> title_type, boost::optional<ContentRecordType> record_type,
     boost::optional<u64> title_id) const {
+    std::lock_guard<std::mutex> lock{index_mutex};
+    UpdateIndex();
+
+    // The index is sorted by title ID, so a title's entries are looked up without a full scan
+    auto begin = index.begin();
+    auto end = index.end();
+    if (title_id != boost::none) {
+        begin = index.lower_bound(RegisteredCacheEntry{title_id.get(), ContentRecordType{}});
+        end = index.lower_bound(RegisteredCacheEntry{title_id.get() + 1, ContentRecordType{}});
+    }
+
     std::vector<RegisteredCacheEntry> out;
-    for (const auto& c : caches) {
-        c->IterateAllMetadata<RegisteredCacheEntry>(
-            out,
-            [](const CNMT& c, const ContentRecord& r) {
-                return RegisteredCacheEntry{c.GetTitleID(), r.type};
-            },
-            [&title_type, &record_type, &title_id](const CNMT& c, const ContentRecord& r) {
-                if (title_type != boost::none && title_type.get() != c.GetType())
-                    return false;
-                if (record_type != boost::none && record_type.get() != r.type)
-                    return false;
-                if (title_id != boost::none && title_id.get() != c.GetTitleID())
-                    return false;
-                return true;
-            });
+    for (auto iter = begin; iter != end; ++iter) {
+        const auto& [entry, union_entry] = *iter;
+        if (title_type != boost::none && title_type.get() != union_entry.title_type)
+            continue;
+        if (record_type != boost::none && record_type.get() != entry.type)
+            continue;
+        out.push_back(entry);
     }
     return out;
 }
@@ -8,6 +8,7 @@
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <boost/container/flat_map.hpp>
@@ -34,6 +35,7 @@ enum class InstallResult {
     ErrorAlreadyExists,
     ErrorCopyFailed,
     ErrorMetaFailed,
+    ErrorHashMismatch,
 };
 
 struct RegisteredCacheEntry {
@@ -82,6 +84,10 @@ public:
 
     boost::optional<u32> GetEntryVersion(u64 title_id) const;
 
+    // The NcaID is derived from the SHA-256 of the NCA, so it identifies its contents without
+    // having to read it.
+    boost::optional<NcaID> GetEntryNcaID(u64 title_id, ContentRecordType type) const;
+
     VirtualFile GetEntryUnparsed(u64 title_id, ContentRecordType type) const;
     VirtualFile GetEntryUnparsed(RegisteredCacheEntry entry) const;
 
@@ -121,12 +127,14 @@ private:
     std::vector<NcaID> AccumulateFiles() const;
     void ProcessFiles(const std::vector<NcaID>& ids);
     void AccumulateYuzuMeta();
+    void RebuildIndex();
     boost::optional<NcaID> GetNcaIDFromMetadata(u64 title_id, ContentRecordType type) const;
     VirtualFile GetFileAtID(NcaID id) const;
     VirtualFile OpenFileOrDirectoryConcat(const VirtualDir& dir, std::string_view path) const;
     InstallResult RawInstallNCA(std::shared_ptr<NCA> nca, const VfsCopyFunction& copy,
                                 bool overwrite_if_exists,
-                                boost::optional<NcaID> override_id = boost::none);
+                                boost::optional<NcaID> override_id = boost::none,
+                                boost::optional<std::array<u8, 0x20>> hash_check = boost::none);
     bool RawInstallYuzuMeta(const CNMT& cnmt);
 
     VirtualDir dir;
@@ -137,6 +145,10 @@ private:
     boost::container::flat_map<u64, CNMT> meta;
     // maps tid -> meta for CNMT in yuzu_meta
     boost::container::flat_map<u64, CNMT> yuzu_meta;
+    // maps the content whose NCA is present -> type of the title it belongs to
+    boost::container::flat_map<RegisteredCacheEntry, TitleType> index;
+    // incremented whenever the index changes, so that the unions merge it again
+    u64 index_generation = 0;
 };
 
 // Combines multiple RegisteredCaches (i.e. SysNAND, UserNAND, SDMC) into one interface.
@@ -168,7 +180,21 @@ public:
         boost::optional<u64> title_id = boost::none) const;
 
 private:
+    struct UnionEntry {
+        // index in caches of the first cache holding the content
+        std::size_t cache_index;
+        TitleType title_type;
+    };
+
+    // Merges the indices of the caches again if any of them changed since the last merge
+    void UpdateIndex() const;
+    const RegisteredCache* FindCache(u64 title_id, ContentRecordType type) const;
+
     std::vector<std::shared_ptr<RegisteredCache>> caches;
+
+    mutable std::mutex index_mutex;
+    mutable boost::container::flat_map<RegisteredCacheEntry, UnionEntry> index;
+    mutable std::vector<u64> index_generations;
 };
 
 } // namespace FileSys
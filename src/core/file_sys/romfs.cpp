@@ -2,10 +2,17 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <utility>
+#include <boost/optional.hpp>
+#include "common/alignment.h"
 #include "common/common_types.h"
 #include "common/swap.h"
 #include "core/file_sys/romfs.h"
 #include "core/file_sys/vfs.h"
+#include "core/file_sys/vfs_concat.h"
 #include "core/file_sys/vfs_offset.h"
 #include "core/file_sys/vfs_vector.h"
 
@@ -13,6 +20,11 @@ namespace FileSys {
 
 constexpr u32 ROMFS_ENTRY_EMPTY = 0xFFFFFFFF;
 
+// Offset of the file data in the RomFS images that are built, right after the padded header
+constexpr u64 ROMFS_DATA_OFFSET = 0x200;
+constexpr u64 ROMFS_FILE_ALIGNMENT = 0x10;
+constexpr u64 ROMFS_ENTRY_ALIGNMENT = 4;
+
 struct TableLocation {
     u64_le offset;
     u64_le size;
@@ -48,54 +60,383 @@ struct FileEntry {
 };
 static_assert(sizeof(FileEntry) == 0x20, "FileEntry has incorrect size.");
 
+namespace {
+
+// The directory and file tables of a RomFS, read once. Directories and files are only created
+// when they are looked up, instead of building the whole tree upfront.
+struct RomFSIndex {
+    VirtualFile file;
+    u64 data_offset;
+    std::vector<u8> directory_meta;
+    std::vector<u8> file_meta;
+};
+
+// Directory entries are preceded by the offset of their parent, which isn't used
+constexpr std::size_t DIRECTORY_ENTRY_OFFSET = sizeof(u32);
+
 template <typename Entry>
-static std::pair<Entry, std::string> GetEntry(const VirtualFile& file, std::size_t offset) {
-    Entry entry{};
-    if (file->ReadObject(&entry, offset) != sizeof(Entry))
-        return {};
-    std::string string(entry.name_length, '\0');
-    if (file->ReadArray(&string[0], string.size(), offset + sizeof(Entry)) != string.size())
-        return {};
-    return {entry, string};
+boost::optional<std::pair<Entry, std::string_view>> GetEntry(const std::vector<u8>& table,
+                                                             std::size_t offset) {
+    if (offset > table.size() || table.size() - offset < sizeof(Entry))
+        return boost::none;
+    Entry entry;
+    std::memcpy(&entry, table.data() + offset, sizeof(Entry));
+    if (table.size() - offset - sizeof(Entry) < entry.name_length)
+        return boost::none;
+    const auto* const name = reinterpret_cast<const char*>(table.data() + offset + sizeof(Entry));
+    return std::make_pair(entry, std::string_view{name, entry.name_length});
 }
 
-void ProcessFile(VirtualFile file, std::size_t file_offset, std::size_t data_offset,
-                 u32 this_file_offset, std::shared_ptr<VectorVfsDirectory> parent) {
-    while (true) {
-        auto entry = GetEntry<FileEntry>(file, file_offset + this_file_offset);
+boost::optional<std::pair<DirectoryEntry, std::string_view>> GetDirectoryEntry(
+    const RomFSIndex& index, u32 offset) {
+    return GetEntry<DirectoryEntry>(index.directory_meta, offset + DIRECTORY_ENTRY_OFFSET);
+}
+
+boost::optional<std::pair<FileEntry, std::string_view>> GetFileEntry(const RomFSIndex& index,
+                                                                     u32 offset) {
+    return GetEntry<FileEntry>(index.file_meta, offset);
+}
+
+// An implementation of VfsDirectory that represents a directory of a RomFSIndex.
+class RomFSDirectory : public VfsDirectory {
+public:
+    RomFSDirectory(std::shared_ptr<const RomFSIndex> index, u32 dir_offset, std::string name,
+                   VirtualDir parent)
+        : index(std::move(index)), dir_offset(dir_offset), name(std::move(name)),
+          parent(std::move(parent)) {}
+
+    std::vector<std::shared_ptr<VfsFile>> GetFiles() const override {
+        std::vector<VirtualFile> files;
+        ForEachFile([&](const FileEntry& entry, std::string_view file_name) {
+            files.push_back(MakeFile(entry, file_name));
+            return false;
+        });
+        return files;
+    }
+
+    std::shared_ptr<VfsFile> GetFile(std::string_view file_name) const override {
+        VirtualFile file;
+        ForEachFile([&](const FileEntry& entry, std::string_view entry_name) {
+            if (entry_name != file_name)
+                return false;
+            file = MakeFile(entry, entry_name);
+            return true;
+        });
+        return file;
+    }
+
+    std::vector<std::shared_ptr<VfsDirectory>> GetSubdirectories() const override {
+        std::vector<VirtualDir> dirs;
+        ForEachSubdirectory([&](u32 offset, std::string_view dir_name) {
+            dirs.push_back(MakeSubdirectory(offset, dir_name));
+            return false;
+        });
+        return dirs;
+    }
+
+    std::shared_ptr<VfsDirectory> GetSubdirectory(std::string_view dir_name) const override {
+        VirtualDir dir;
+        ForEachSubdirectory([&](u32 offset, std::string_view entry_name) {
+            if (entry_name != dir_name)
+                return false;
+            dir = MakeSubdirectory(offset, entry_name);
+            return true;
+        });
+        return dir;
+    }
+
+    bool IsWritable() const override {
+        return false;
+    }
+
+    bool IsReadable() const override {
+        return true;
+    }
+
+    std::string GetName() const override {
+        return name;
+    }
 
-        parent->AddFile(std::make_shared<OffsetVfsFile>(
-            file, entry.first.size, entry.first.offset + data_offset, entry.second));
+    std::shared_ptr<VfsDirectory> GetParentDirectory() const override {
+        return parent;
+    }
 
-        if (entry.first.sibling == ROMFS_ENTRY_EMPTY)
-            break;
+    std::shared_ptr<VfsDirectory> CreateSubdirectory(std::string_view name) override {
+        return nullptr;
+    }
 
-        this_file_offset = entry.first.sibling;
+    std::shared_ptr<VfsFile> CreateFile(std::string_view name) override {
+        return nullptr;
     }
+
+    bool DeleteSubdirectory(std::string_view name) override {
+        return false;
+    }
+
+    bool DeleteFile(std::string_view name) override {
+        return false;
+    }
+
+    bool Rename(std::string_view name) override {
+        return false;
+    }
+
+protected:
+    bool ReplaceFileWithSubdirectory(VirtualFile file, VirtualDir dir) override {
+        return false;
+    }
+
+private:
+    /// Calls func for each file in the directory until it returns true
+    template <typename Func>
+    void ForEachFile(Func&& func) const {
+        const auto dir = GetDirectoryEntry(*index, dir_offset);
+        if (!dir)
+            return;
+        for (u32 offset = dir->first.child_file; offset != ROMFS_ENTRY_EMPTY;) {
+            const auto entry = GetFileEntry(*index, offset);
+            if (!entry || func(entry->first, entry->second))
+                return;
+            offset = entry->first.sibling;
+        }
+    }
+
+    /// Calls func for each subdirectory of the directory until it returns true
+    template <typename Func>
+    void ForEachSubdirectory(Func&& func) const {
+        const auto dir = GetDirectoryEntry(*index, dir_offset);
+        if (!dir)
+            return;
+        for (u32 offset = dir->first.child_dir; offset != ROMFS_ENTRY_EMPTY;) {
+            const auto entry = GetDirectoryEntry(*index, offset);
+            if (!entry || func(offset, entry->second))
+                return;
+            offset = entry->first.sibling;
+        }
+    }
+
+    VirtualFile MakeFile(const FileEntry& entry, std::string_view file_name) const {
+        return std::make_shared<OffsetVfsFile>(index->file, entry.size,
+                                               entry.offset + index->data_offset,
+                                               std::string(file_name));
+    }
+
+    VirtualDir MakeSubdirectory(u32 offset, std::string_view dir_name) const {
+        return std::make_shared<RomFSDirectory>(index, offset, std::string(dir_name), nullptr);
+    }
+
+    std::shared_ptr<const RomFSIndex> index;
+    u32 dir_offset;
+    std::string name;
+    VirtualDir parent;
+};
+
+// Hash of an entry name used by the hash tables of a RomFS, salted with the offset of its parent
+u32 CalculatePathHash(u32 parent, std::string_view name) {
+    u32 hash = parent ^ 123456789;
+    for (const char c : name) {
+        hash = (hash >> 5) | (hash << 27);
+        hash ^= static_cast<u32>(static_cast<s32>(static_cast<s8>(c)));
+    }
+    return hash;
+}
+
+// Number of buckets of a hash table, a number with no small prime factors
+u32 GetHashTableCount(u32 num_entries) {
+    if (num_entries < 3)
+        return 3;
+    if (num_entries < 19)
+        return num_entries | 1;
+
+    u32 count = num_entries;
+    while (count % 2 == 0 || count % 3 == 0 || count % 5 == 0 || count % 7 == 0 ||
+           count % 11 == 0 || count % 13 == 0 || count % 17 == 0) {
+        ++count;
+    }
+    return count;
+}
+
+struct BuildDirectory {
+    VirtualDir dir;
+    std::string name;
+    std::size_t parent;
+    std::vector<std::size_t> subdirectories;
+    std::vector<std::size_t> files;
+    u32 offset;
+};
+
+struct BuildFile {
+    VirtualFile file;
+    std::string name;
+    std::size_t parent;
+    u32 offset;
+    u64 data_offset;
+};
+
+template <typename T>
+void AppendObject(std::vector<u8>& table, const T& object) {
+    const auto* const bytes = reinterpret_cast<const u8*>(&object);
+    table.insert(table.end(), bytes, bytes + sizeof(T));
+}
+
+void AppendName(std::vector<u8>& table, std::string_view name) {
+    table.insert(table.end(), name.begin(), name.end());
+    table.resize(Common::AlignUp(table.size(), ROMFS_ENTRY_ALIGNMENT));
+}
+
+/// Inserts the entry at offset into the bucket of its hash, returns the previous head of the bucket
+u32 InsertIntoHashTable(std::vector<u32_le>& table, u32 hash, u32 offset) {
+    const u32 previous = table[hash % table.size()];
+    table[hash % table.size()] = offset;
+    return previous;
 }
 
-void ProcessDirectory(VirtualFile file, std::size_t dir_offset, std::size_t file_offset,
-                      std::size_t data_offset, u32 this_dir_offset,
-                      std::shared_ptr<VectorVfsDirectory> parent) {
-    while (true) {
-        auto entry = GetEntry<DirectoryEntry>(file, dir_offset + this_dir_offset);
-        auto current = std::make_shared<VectorVfsDirectory>(
-            std::vector<VirtualFile>{}, std::vector<VirtualDir>{}, entry.second);
+} // Anonymous namespace
 
-        if (entry.first.child_file != ROMFS_ENTRY_EMPTY) {
-            ProcessFile(file, file_offset, data_offset, entry.first.child_file, current);
+VirtualFile CreateRomFS(VirtualDir dir, std::string name) {
+    if (dir == nullptr)
+        return nullptr;
+
+    // Lay out the tree breadth first, with the entries of each directory sorted by name
+    std::vector<BuildDirectory> directories{{dir, "", 0, {}, {}, 0}};
+    std::vector<BuildFile> files;
+    for (std::size_t i = 0; i < directories.size(); ++i) {
+        const auto by_name = [](const auto& lhs, const auto& rhs) {
+            return lhs->GetName() < rhs->GetName();
+        };
+        auto subdirectories = directories[i].dir->GetSubdirectories();
+        std::sort(subdirectories.begin(), subdirectories.end(), by_name);
+        for (auto& subdirectory : subdirectories) {
+            directories[i].subdirectories.push_back(directories.size());
+            auto subdirectory_name = subdirectory->GetName();
+            directories.push_back(
+                {std::move(subdirectory), std::move(subdirectory_name), i, {}, {}, 0});
         }
 
-        if (entry.first.child_dir != ROMFS_ENTRY_EMPTY) {
-            ProcessDirectory(file, dir_offset, file_offset, data_offset, entry.first.child_dir,
-                             current);
+        auto dir_files = directories[i].dir->GetFiles();
+        std::sort(dir_files.begin(), dir_files.end(), by_name);
+        for (auto& file : dir_files) {
+            directories[i].files.push_back(files.size());
+            auto file_name = file->GetName();
+            files.push_back({std::move(file), std::move(file_name), i, 0, 0});
         }
+    }
+
+    u32 directory_meta_size = 0;
+    for (auto& directory : directories) {
+        directory.offset = directory_meta_size;
+        directory_meta_size += static_cast<u32>(
+            sizeof(u32) + sizeof(DirectoryEntry) +
+            Common::AlignUp(directory.name.size(), ROMFS_ENTRY_ALIGNMENT));
+    }
+    u32 file_meta_size = 0;
+    u64 data_size = 0;
+    for (auto& file : files) {
+        file.offset = file_meta_size;
+        file_meta_size += static_cast<u32>(
+            sizeof(FileEntry) + Common::AlignUp(file.name.size(), ROMFS_ENTRY_ALIGNMENT));
+        data_size = Common::AlignUp(data_size, ROMFS_FILE_ALIGNMENT);
+        file.data_offset = data_size;
+        data_size += file.file->GetSize();
+    }
+
+    // Build the entry tables, chaining the entries of each bucket through their hash field
+    std::vector<u32_le> directory_hash(GetHashTableCount(static_cast<u32>(directories.size())),
+                                       ROMFS_ENTRY_EMPTY);
+    std::vector<u32_le> file_hash(GetHashTableCount(static_cast<u32>(files.size())),
+                                  ROMFS_ENTRY_EMPTY);
+    const auto next_offset = [](const auto& list, const auto& indices, std::size_t position) {
+        return position + 1 < indices.size() ? list[indices[position + 1]].offset
+                                             : ROMFS_ENTRY_EMPTY;
+    };
+
+    std::vector<u8> directory_meta;
+    directory_meta.reserve(directory_meta_size);
+    for (const auto& directory : directories) {
+        const auto& parent = directories[directory.parent];
+        const auto& siblings = parent.subdirectories;
+        const auto position = static_cast<std::size_t>(
+            std::find(siblings.begin(), siblings.end(), &directory - directories.data()) -
+            siblings.begin());
+
+        DirectoryEntry entry{};
+        entry.sibling = &directory == &parent ? ROMFS_ENTRY_EMPTY
+                                              : next_offset(directories, siblings, position);
+        entry.child_dir = directory.subdirectories.empty()
+                              ? ROMFS_ENTRY_EMPTY
+                              : directories[directory.subdirectories[0]].offset;
+        entry.child_file =
+            directory.files.empty() ? ROMFS_ENTRY_EMPTY : files[directory.files[0]].offset;
+        entry.hash = InsertIntoHashTable(
+            directory_hash, CalculatePathHash(parent.offset, directory.name), directory.offset);
+        entry.name_length = static_cast<u32>(directory.name.size());
+
+        AppendObject(directory_meta, u32_le{parent.offset});
+        AppendObject(directory_meta, entry);
+        AppendName(directory_meta, directory.name);
+    }
+
+    std::vector<u8> file_meta;
+    file_meta.reserve(file_meta_size);
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        const auto& file = files[i];
+        const auto& parent = directories[file.parent];
+        const auto position = static_cast<std::size_t>(
+            std::find(parent.files.begin(), parent.files.end(), i) - parent.files.begin());
+
+        FileEntry entry{};
+        entry.parent = parent.offset;
+        entry.sibling = next_offset(files, parent.files, position);
+        entry.offset = file.data_offset;
+        entry.size = file.file->GetSize();
+        entry.hash = InsertIntoHashTable(file_hash, CalculatePathHash(parent.offset, file.name),
+                                         file.offset);
+        entry.name_length = static_cast<u32>(file.name.size());
+
+        AppendObject(file_meta, entry);
+        AppendName(file_meta, file.name);
+    }
 
-        parent->AddDirectory(current);
-        if (entry.first.sibling == ROMFS_ENTRY_EMPTY)
-            break;
-        this_dir_offset = entry.first.sibling;
+    // The tables follow the file data
+    const u64 tables_offset = Common::AlignUp(ROMFS_DATA_OFFSET + data_size, ROMFS_ENTRY_ALIGNMENT);
+    std::vector<u8> tables;
+    RomFSHeader header{};
+    header.header_size = sizeof(RomFSHeader);
+    const auto append_table = [&](TableLocation& location, const auto* data, std::size_t size) {
+        location.offset = tables_offset + tables.size();
+        location.size = size;
+        const auto* const bytes = reinterpret_cast<const u8*>(data);
+        tables.insert(tables.end(), bytes, bytes + size);
+    };
+    append_table(header.directory_hash, directory_hash.data(),
+                 directory_hash.size() * sizeof(u32_le));
+    append_table(header.directory_meta, directory_meta.data(), directory_meta.size());
+    append_table(header.file_hash, file_hash.data(), file_hash.size() * sizeof(u32_le));
+    append_table(header.file_meta, file_meta.data(), file_meta.size());
+    header.data_offset = ROMFS_DATA_OFFSET;
+
+    // The files themselves aren't copied, the image reads them where they are
+    std::vector<u8> header_data(ROMFS_DATA_OFFSET);
+    std::memcpy(header_data.data(), &header, sizeof(RomFSHeader));
+    std::vector<VirtualFile> parts{std::make_shared<VectorVfsFile>(std::move(header_data))};
+    u64 position = 0;
+    const auto pad_to = [&](u64 offset) {
+        if (offset > position)
+            parts.push_back(std::make_shared<VectorVfsFile>(std::vector<u8>(offset - position)));
+        position = offset;
+    };
+    for (const auto& file : files) {
+        const u64 size = file.file->GetSize();
+        if (size == 0)
+            continue;
+        pad_to(file.data_offset);
+        parts.push_back(file.file);
+        position += size;
     }
+    pad_to(tables_offset - ROMFS_DATA_OFFSET);
+    parts.push_back(std::make_shared<VectorVfsFile>(std::move(tables)));
+
+    return ConcatenateFiles(std::move(parts), std::move(name));
 }
 
 VirtualDir ExtractRomFS(VirtualFile file) {
@@ -106,16 +447,19 @@ VirtualDir ExtractRomFS(VirtualFile file) {
     if (header.header_size != sizeof(RomFSHeader))
         return nullptr;
 
-    const u64 file_offset = header.file_meta.offset;
-    const u64 dir_offset = header.directory_meta.offset + 4;
+    auto index = std::make_shared<RomFSIndex>();
+    index->file = file;
+    index->data_offset = header.data_offset;
+    index->directory_meta =
+        file->ReadBytes(header.directory_meta.size, header.directory_meta.offset);
+    index->file_meta = file->ReadBytes(header.file_meta.size, header.file_meta.offset);
 
-    auto root =
-        std::make_shared<VectorVfsDirectory>(std::vector<VirtualFile>{}, std::vector<VirtualDir>{},
-                                             file->GetName(), file->GetContainingDirectory());
-
-    ProcessDirectory(file, dir_offset, file_offset, header.data_offset, 0, root);
+    const auto root_entry = GetDirectoryEntry(*index, 0);
+    if (!root_entry)
+        return nullptr;
 
-    VirtualDir out = std::move(root);
+    VirtualDir out = std::make_shared<RomFSDirectory>(std::move(index), 0,
+                                                      std::string(root_entry->second), nullptr);
 
     while (out->GetSubdirectory("") != nullptr)
         out = out->GetSubdirectory("");
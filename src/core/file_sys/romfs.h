@@ -5,6 +5,7 @@
 #pragma once
 
 #include <array>
+#include <string>
 #include "common/common_funcs.h"
 #include "common/common_types.h"
 #include "common/swap.h"
@@ -33,4 +34,9 @@ static_assert(sizeof(IVFCHeader) == 0xE0, "IVFCHeader has incorrect size.");
 // Returns nullptr on failure
 VirtualDir ExtractRomFS(VirtualFile file);
 
+// Converts a VFS filesystem into a RomFS binary, the inverse of ExtractRomFS. The contents of the
+// files aren't copied, the returned file reads them from the directory when it is read.
+// Returns nullptr on failure
+VirtualFile CreateRomFS(VirtualDir dir, std::string name = "");
+
 } // namespace FileSys
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <future>
 #include <numeric>
 #include <string>
 #include "common/common_paths.h"
@@ -176,6 +177,10 @@ boost::optional<u8> VfsFile::ReadByte(std::size_t offset) const {
     return boost::none;
 }
 
+const u8* VfsFile::GetPointer(std::size_t length, std::size_t offset) const {
+    return nullptr;
+}
+
 std::vector<u8> VfsFile::ReadBytes(std::size_t size, std::size_t offset) const {
     std::vector<u8> out(size);
     std::size_t read_size = Read(out.data(), size, offset);
@@ -282,6 +287,21 @@ std::shared_ptr<VfsDirectory> VfsDirectory::GetSubdirectory(std::string_view nam
     return iter == subs.end() ? nullptr : *iter;
 }
 
+std::vector<VfsDirectoryEntry> VfsDirectory::GetEntries() const {
+    const auto files = GetFiles();
+    const auto subdirectories = GetSubdirectories();
+
+    std::vector<VfsDirectoryEntry> entries;
+    entries.reserve(files.size() + subdirectories.size());
+    for (const auto& file : files) {
+        entries.push_back({file->GetName(), VfsEntryType::File, file->GetSize()});
+    }
+    for (const auto& subdirectory : subdirectories) {
+        entries.push_back({subdirectory->GetName(), VfsEntryType::Directory, 0});
+    }
+    return entries;
+}
+
 bool VfsDirectory::IsRoot() const {
     return GetParentDirectory() == nullptr;
 }
@@ -457,10 +477,52 @@ bool DeepEquals(const VirtualFile& file1, const VirtualFile& file2, std::size_t
 bool VfsRawCopy(VirtualFile src, VirtualFile dest) {
     if (src == nullptr || dest == nullptr)
         return false;
-    if (!dest->Resize(src->GetSize()))
+    return VfsPipelinedCopy(src, dest);
+}
+
+bool VfsPipelinedCopy(const VirtualFile& src, const VirtualFile& dest,
+                      const VfsCopyProgressCallback& progress, std::size_t block_size) {
+    if (src == nullptr || dest == nullptr)
         return false;
-    std::vector<u8> data = src->ReadAllBytes();
-    return dest->WriteBytes(data, 0) == data.size();
+    const std::size_t size = src->GetSize();
+    if (!dest->Resize(size))
+        return false;
+
+    // src and dest are distinct files, so the read of a block can run alongside the write of the
+    // previous one.
+    std::vector<u8> current(std::min(size, block_size));
+    std::vector<u8> next(current.size());
+    const auto read_block = [&src](std::vector<u8>& buffer, std::size_t offset) {
+        return src->Read(buffer.data(), buffer.size(), offset);
+    };
+
+    std::size_t current_size = read_block(current, 0);
+    for (std::size_t offset = 0; offset < size;) {
+        if (current_size == 0)
+            return false;
+
+        const std::size_t next_offset = offset + current_size;
+        std::future<std::size_t> next_read;
+        if (next_offset < size) {
+            next_read = std::async(std::launch::async, read_block, std::ref(next), next_offset);
+        }
+
+        const std::size_t written = dest->Write(current.data(), current_size, offset);
+        const std::size_t next_size = next_read.valid() ? next_read.get() : 0;
+        if (written != current_size)
+            return false;
+
+        offset = next_offset;
+        if (progress && !progress(offset, size)) {
+            dest->Resize(0);
+            return false;
+        }
+
+        std::swap(current, next);
+        current_size = next_size;
+    }
+
+    return true;
 }
 
 VirtualDir GetOrCreateDirectoryRelative(const VirtualDir& rel, std::string_view path) {
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -32,6 +33,14 @@ enum class VfsEntryType {
     Directory,
 };
 
+// An entry of a directory listing, describing a file or subdirectory without opening it
+struct VfsDirectoryEntry {
+    std::string name;
+    VfsEntryType type;
+    // The size of the file, directories have a size of 0.
+    std::size_t size;
+};
+
 // A class representing an abstract filesystem. A default implementation given the root VirtualDir
 // is provided for convenience, but if the Vfs implementation has any additional state or
 // functionality, they will need to override.
@@ -110,6 +119,11 @@ public:
     // into file. Returns number of bytes successfully written.
     virtual std::size_t Write(const u8* data, std::size_t length, std::size_t offset = 0) = 0;
 
+    // Returns a pointer to length bytes of the file starting at offset, which stays valid for the
+    // lifetime of the file, without copying them. Returns nullptr if the file isn't mapped in
+    // memory or the range doesn't fit in the file, in which case Read has to be used instead.
+    virtual const u8* GetPointer(std::size_t length, std::size_t offset = 0) const;
+
     // Reads exactly one byte at the offset provided, returning boost::none on error.
     virtual boost::optional<u8> ReadByte(std::size_t offset = 0) const;
     // Reads size bytes starting at offset in file into a vector.
@@ -210,6 +224,10 @@ public:
     // directory with name.
     virtual std::shared_ptr<VfsDirectory> GetSubdirectory(std::string_view name) const;
 
+    // Returns the names, types and sizes of the files in this directory followed by those of its
+    // subdirectories. Implementations can override this to list them without opening each one.
+    virtual std::vector<VfsDirectoryEntry> GetEntries() const;
+
     // Returns whether or not the directory can be written to.
     virtual bool IsWritable() const = 0;
     // Returns whether of not the directory can be read from.
@@ -318,6 +336,16 @@ bool DeepEquals(const VirtualFile& file1, const VirtualFile& file2, std::size_t
 // directory of src/dest.
 bool VfsRawCopy(VirtualFile src, VirtualFile dest);
 
+// Called with the number of bytes copied so far and the total, returning false cancels the copy.
+using VfsCopyProgressCallback = std::function<bool(std::size_t, std::size_t)>;
+
+// A VfsRawCopy that streams the data in blocks of block_size, reading the next block on a worker
+// thread while the current one is written, and reporting progress after each block. A cancelled
+// copy leaves dest empty.
+bool VfsPipelinedCopy(const VirtualFile& src, const VirtualFile& dest,
+                      const VfsCopyProgressCallback& progress = {},
+                      std::size_t block_size = 0x800000);
+
 // Checks if the directory at path relative to rel exists. If it does, returns that. If it does not
 // it attempts to create it and returns the new dir or nullptr on failure.
 VirtualDir GetOrCreateDirectoryRelative(const VirtualDir& rel, std::string_view path);
@@ -0,0 +1,143 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/microprofile.h"
+#include "core/file_sys/vfs_cached.h"
+
+namespace FileSys {
+
+BlockCache::BlockCache(std::size_t memory_budget) : memory_budget(memory_budget) {}
+
+u64 BlockCache::RegisterFile() {
+    std::lock_guard<std::mutex> lock{mutex};
+    return next_file_id++;
+}
+
+boost::optional<std::size_t> BlockCache::Read(u64 file_id, std::size_t block_offset, u8* data,
+                                              std::size_t length, std::size_t offset_in_block) {
+    std::lock_guard<std::mutex> lock{mutex};
+    const auto iter = block_map.find({file_id, block_offset});
+    if (iter == block_map.end()) {
+        ++misses;
+        return boost::none;
+    }
+    ++hits;
+
+    blocks.splice(blocks.begin(), blocks, iter->second);
+    const auto& block = iter->second->data;
+    if (offset_in_block >= block.size()) {
+        return 0;
+    }
+    const std::size_t read = std::min(length, block.size() - offset_in_block);
+    std::memcpy(data, block.data() + offset_in_block, read);
+    return read;
+}
+
+void BlockCache::Insert(u64 file_id, std::size_t block_offset, std::vector<u8> block) {
+    std::lock_guard<std::mutex> lock{mutex};
+    const Key key{file_id, block_offset};
+    if (block_map.find(key) != block_map.end()) {
+        return;
+    }
+
+    memory_used += block.size();
+    blocks.push_front({key, std::move(block)});
+    block_map.emplace(key, blocks.begin());
+    EvictToBudget();
+}
+
+void BlockCache::SetMemoryBudget(std::size_t memory_budget_) {
+    std::lock_guard<std::mutex> lock{mutex};
+    memory_budget = memory_budget_;
+    EvictToBudget();
+}
+
+void BlockCache::EvictToBudget() {
+    while (memory_used > memory_budget && !blocks.empty()) {
+        const Entry& entry = blocks.back();
+        memory_used -= entry.data.size();
+        block_map.erase(entry.key);
+        blocks.pop_back();
+    }
+}
+
+std::shared_ptr<BlockCache> GetDecryptedBlockCache() {
+    static const auto cache = std::make_shared<BlockCache>();
+    return cache;
+}
+
+CachedVfsFile::CachedVfsFile(VirtualFile base_, std::shared_ptr<BlockCache> cache_)
+    : base(std::move(base_)), cache(std::move(cache_)), file_id(cache->RegisterFile()) {}
+
+std::string CachedVfsFile::GetName() const {
+    return base->GetName();
+}
+
+std::size_t CachedVfsFile::GetSize() const {
+    return base->GetSize();
+}
+
+bool CachedVfsFile::Resize(std::size_t new_size) {
+    return false;
+}
+
+std::shared_ptr<VfsDirectory> CachedVfsFile::GetContainingDirectory() const {
+    return base->GetContainingDirectory();
+}
+
+bool CachedVfsFile::IsWritable() const {
+    return false;
+}
+
+bool CachedVfsFile::IsReadable() const {
+    return base->IsReadable();
+}
+
+MICROPROFILE_DEFINE(FileSys_BlockCacheMiss, "FileSys", "Block Cache Miss", MP_RGB(200, 100, 50));
+std::size_t CachedVfsFile::Read(u8* data, std::size_t length, std::size_t offset) const {
+    if (length >= MAX_CACHED_READ_SIZE) {
+        return base->Read(data, length, offset);
+    }
+
+    std::size_t total_read = 0;
+    while (length > 0) {
+        const std::size_t offset_in_block = offset % BlockCache::BLOCK_SIZE;
+        const std::size_t block_offset = offset - offset_in_block;
+        const std::size_t block_length = std::min(length, BlockCache::BLOCK_SIZE - offset_in_block);
+
+        auto read = cache->Read(file_id, block_offset, data, block_length, offset_in_block);
+        if (!read) {
+            MICROPROFILE_SCOPE(FileSys_BlockCacheMiss);
+            std::vector<u8> block(BlockCache::BLOCK_SIZE);
+            block.resize(base->Read(block.data(), block.size(), block_offset));
+            read = std::min(block_length, block.size() - std::min(block.size(), offset_in_block));
+            if (*read > 0) {
+                std::memcpy(data, block.data() + offset_in_block, *read);
+            }
+            cache->Insert(file_id, block_offset, std::move(block));
+        }
+        if (*read == 0) {
+            break;
+        }
+
+        total_read += *read;
+        data += *read;
+        offset += *read;
+        length -= *read;
+    }
+    return total_read;
+}
+
+std::size_t CachedVfsFile::Write(const u8* data, std::size_t length, std::size_t offset) {
+    return 0;
+}
+
+bool CachedVfsFile::Rename(std::string_view name) {
+    return false;
+}
+
+} // namespace FileSys
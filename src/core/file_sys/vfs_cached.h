@@ -0,0 +1,112 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <boost/optional.hpp>
+
+#include "core/file_sys/vfs.h"
+
+namespace FileSys {
+
+// A bounded LRU cache of fixed size blocks read from VfsFiles. It's shared by the CachedVfsFiles
+// wrapping files that are expensive to read, such as decryption layers.
+class BlockCache {
+public:
+    /// Size of the cached blocks, a multiple of the XTS sector and CTR block sizes
+    static constexpr std::size_t BLOCK_SIZE = 0x4000;
+    static constexpr std::size_t DEFAULT_MEMORY_BUDGET = 64 * 1024 * 1024;
+
+    explicit BlockCache(std::size_t memory_budget = DEFAULT_MEMORY_BUDGET);
+
+    /// Returns an identifier that is unique to each file using the cache
+    u64 RegisterFile();
+
+    /**
+     * Copies part of a cached block, marking it as the most recently used one.
+     * @returns The number of bytes copied, or none when the block isn't cached
+     */
+    boost::optional<std::size_t> Read(u64 file_id, std::size_t block_offset, u8* data,
+                                      std::size_t length, std::size_t offset_in_block);
+
+    /// Inserts a block, evicting the least recently used ones until the cache fits its budget
+    void Insert(u64 file_id, std::size_t block_offset, std::vector<u8> block);
+
+    /// Changes the memory budget, evicting blocks when it shrinks
+    void SetMemoryBudget(std::size_t memory_budget);
+
+    u64 GetHits() const {
+        return hits;
+    }
+
+    u64 GetMisses() const {
+        return misses;
+    }
+
+private:
+    using Key = std::pair<u64, std::size_t>;
+
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const {
+            return std::hash<u64>()(key.first * 0x9E3779B97F4A7C15ULL ^ key.second);
+        }
+    };
+
+    struct Entry {
+        Key key;
+        std::vector<u8> data;
+    };
+
+    /// Evicts the least recently used blocks until the cache fits its budget
+    void EvictToBudget();
+
+    std::mutex mutex;
+    /// Cached blocks, the most recently used one first
+    std::list<Entry> blocks;
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> block_map;
+    std::size_t memory_budget;
+    std::size_t memory_used = 0;
+
+    u64 next_file_id = 0;
+    std::atomic<u64> hits{};
+    std::atomic<u64> misses{};
+};
+
+/// Returns the cache shared by the decrypted views of NCA and NAX files
+std::shared_ptr<BlockCache> GetDecryptedBlockCache();
+
+// An implementation of VfsFile that keeps the blocks read from a read-only file in a BlockCache,
+// so that reading the same region again doesn't read it from the wrapped file.
+class CachedVfsFile : public VfsFile {
+public:
+    CachedVfsFile(VirtualFile base, std::shared_ptr<BlockCache> cache);
+
+    std::string GetName() const override;
+    std::size_t GetSize() const override;
+    bool Resize(std::size_t new_size) override;
+    std::shared_ptr<VfsDirectory> GetContainingDirectory() const override;
+    bool IsWritable() const override;
+    bool IsReadable() const override;
+    std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override;
+    std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override;
+    bool Rename(std::string_view name) override;
+
+private:
+    /// Reads larger than this are streamed from the base file instead of filling the cache
+    static constexpr std::size_t MAX_CACHED_READ_SIZE = 0x100000;
+
+    VirtualFile base;
+    std::shared_ptr<BlockCache> cache;
+    u64 file_id;
+};
+
+} // namespace FileSys
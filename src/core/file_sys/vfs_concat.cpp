@@ -60,28 +60,28 @@ bool ConcatenatedVfsFile::IsReadable() const {
 }
 
 std::size_t ConcatenatedVfsFile::Read(u8* data, std::size_t length, std::size_t offset) const {
-    auto entry = files.end();
-    for (auto iter = files.begin(); iter != files.end(); ++iter) {
-        if (iter->first > offset) {
-            entry = --iter;
-            break;
-        }
-    }
-
-    // Check if the entry should be the last one. The loop above will make it end().
-    if (entry == files.end() && offset < files.rbegin()->first + files.rbegin()->second->GetSize())
-        --entry;
-
-    if (entry == files.end())
+    if (files.empty())
         return 0;
 
-    const auto remaining = entry->second->GetSize() + offset - entry->first;
-    if (length > remaining) {
-        return entry->second->Read(data, remaining, offset - entry->first) +
-               Read(data + remaining, length - remaining, offset + remaining);
+    // The file containing the offset is the last one starting at or before it.
+    auto entry = files.upper_bound(offset);
+    --entry;
+
+    std::size_t read = 0;
+    for (; entry != files.end() && read < length; ++entry) {
+        const std::size_t file_offset = offset + read - entry->first;
+        const std::size_t file_size = entry->second->GetSize();
+        if (file_offset >= file_size)
+            continue;
+
+        const std::size_t chunk = std::min(length - read, file_size - file_offset);
+        const std::size_t chunk_read = entry->second->Read(data + read, chunk, file_offset);
+        read += chunk_read;
+        if (chunk_read < chunk)
+            break;
     }
 
-    return entry->second->Read(data, length, offset - entry->first);
+    return read;
 }
 
 std::size_t ConcatenatedVfsFile::Write(const u8* data, std::size_t length, std::size_t offset) {
@@ -0,0 +1,151 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <utility>
+
+#include "common/file_util.h"
+#include "core/file_sys/vfs_layered.h"
+
+namespace FileSys {
+
+VirtualDir LayeredVfsDirectory::MakeLayeredDirectory(std::vector<VirtualDir> dirs,
+                                                     std::string name) {
+    if (dirs.empty())
+        return nullptr;
+    if (dirs.size() == 1)
+        return dirs[0];
+
+    return std::shared_ptr<VfsDirectory>(new LayeredVfsDirectory(std::move(dirs), std::move(name)));
+}
+
+LayeredVfsDirectory::LayeredVfsDirectory(std::vector<VirtualDir> dirs, std::string name)
+    : dirs(std::move(dirs)), name(std::move(name)) {}
+
+LayeredVfsDirectory::~LayeredVfsDirectory() = default;
+
+std::shared_ptr<VfsFile> LayeredVfsDirectory::GetFileRelative(std::string_view path) const {
+    const auto parent_path = FileUtil::GetParentPath(path);
+    const auto file_name = FileUtil::GetFilename(path);
+    if (parent_path.empty())
+        return GetFile(file_name);
+
+    const auto dir = GetDirectoryRelative(parent_path);
+    return dir == nullptr ? nullptr : dir->GetFile(file_name);
+}
+
+std::shared_ptr<VfsDirectory> LayeredVfsDirectory::GetDirectoryRelative(
+    std::string_view path) const {
+    // Walk down the merged subdirectories, each step being a single lookup in their index
+    VirtualDir dir = nullptr;
+    for (const auto& component : FileUtil::SplitPathComponents(path)) {
+        if (component.empty())
+            continue;
+        dir = dir == nullptr ? GetSubdirectory(component) : dir->GetSubdirectory(component);
+        if (dir == nullptr)
+            return nullptr;
+    }
+    return dir;
+}
+
+std::shared_ptr<VfsFile> LayeredVfsDirectory::GetFile(std::string_view file_name) const {
+    BuildIndex();
+    const auto iter = file_index.find(std::string(file_name));
+    return iter == file_index.end() ? nullptr : files[iter->second];
+}
+
+std::shared_ptr<VfsDirectory> LayeredVfsDirectory::GetSubdirectory(
+    std::string_view dir_name) const {
+    BuildIndex();
+    const auto iter = subdirectory_index.find(std::string(dir_name));
+    return iter == subdirectory_index.end() ? nullptr : subdirectories[iter->second];
+}
+
+std::vector<std::shared_ptr<VfsFile>> LayeredVfsDirectory::GetFiles() const {
+    BuildIndex();
+    return files;
+}
+
+std::vector<std::shared_ptr<VfsDirectory>> LayeredVfsDirectory::GetSubdirectories() const {
+    BuildIndex();
+    return subdirectories;
+}
+
+bool LayeredVfsDirectory::IsWritable() const {
+    return false;
+}
+
+bool LayeredVfsDirectory::IsReadable() const {
+    return true;
+}
+
+std::string LayeredVfsDirectory::GetName() const {
+    return name.empty() ? dirs[0]->GetName() : name;
+}
+
+std::shared_ptr<VfsDirectory> LayeredVfsDirectory::GetParentDirectory() const {
+    return dirs[0]->GetParentDirectory();
+}
+
+std::shared_ptr<VfsDirectory> LayeredVfsDirectory::CreateSubdirectory(std::string_view name) {
+    return nullptr;
+}
+
+std::shared_ptr<VfsFile> LayeredVfsDirectory::CreateFile(std::string_view name) {
+    return nullptr;
+}
+
+bool LayeredVfsDirectory::DeleteSubdirectory(std::string_view name) {
+    return false;
+}
+
+bool LayeredVfsDirectory::DeleteFile(std::string_view name) {
+    return false;
+}
+
+bool LayeredVfsDirectory::Rename(std::string_view name_) {
+    name = name_;
+    return true;
+}
+
+bool LayeredVfsDirectory::ReplaceFileWithSubdirectory(VirtualFile file, VirtualDir dir) {
+    return false;
+}
+
+void LayeredVfsDirectory::BuildIndex() const {
+    if (is_indexed)
+        return;
+    is_indexed = true;
+
+    // An entry of an upper layer hides the entries with the same name below it, unless both are
+    // directories, in which case their contents are merged as well.
+    std::vector<std::vector<VirtualDir>> subdirectory_layers;
+    for (const auto& layer : dirs) {
+        for (auto& file : layer->GetFiles()) {
+            auto file_name = file->GetName();
+            if (file_index.count(file_name) != 0 || subdirectory_index.count(file_name) != 0)
+                continue;
+            file_index.emplace(std::move(file_name), files.size());
+            files.push_back(std::move(file));
+        }
+
+        for (auto& subdirectory : layer->GetSubdirectories()) {
+            auto subdirectory_name = subdirectory->GetName();
+            if (file_index.count(subdirectory_name) != 0)
+                continue;
+            const auto [iter, is_new] = subdirectory_index.emplace(std::move(subdirectory_name),
+                                                                   subdirectory_layers.size());
+            if (is_new)
+                subdirectory_layers.emplace_back();
+            subdirectory_layers[iter->second].push_back(std::move(subdirectory));
+        }
+    }
+
+    subdirectories.reserve(subdirectory_layers.size());
+    for (auto& layers : subdirectory_layers) {
+        auto subdirectory_name = layers[0]->GetName();
+        subdirectories.push_back(MakeLayeredDirectory(std::move(layers), subdirectory_name));
+    }
+}
+
+} // namespace FileSys
@@ -0,0 +1,100 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/microprofile.h"
+#include "core/file_sys/vfs_read_ahead.h"
+
+namespace FileSys {
+
+ReadAheadVfsFile::ReadAheadVfsFile(VirtualFile base_) : base(std::move(base_)) {}
+
+std::string ReadAheadVfsFile::GetName() const {
+    return base->GetName();
+}
+
+std::size_t ReadAheadVfsFile::GetSize() const {
+    return base->GetSize();
+}
+
+bool ReadAheadVfsFile::Resize(std::size_t new_size) {
+    return false;
+}
+
+std::shared_ptr<VfsDirectory> ReadAheadVfsFile::GetContainingDirectory() const {
+    return base->GetContainingDirectory();
+}
+
+bool ReadAheadVfsFile::IsWritable() const {
+    return false;
+}
+
+bool ReadAheadVfsFile::IsReadable() const {
+    return base->IsReadable();
+}
+
+MICROPROFILE_DEFINE(FileSys_ReadAhead, "FileSys", "Read Ahead", MP_RGB(100, 150, 200));
+std::size_t ReadAheadVfsFile::Read(u8* data, std::size_t length, std::size_t offset) const {
+    if (offset == last_read_end) {
+        ++sequential_reads;
+    } else {
+        sequential_reads = 0;
+    }
+
+    const std::size_t total_read = [&] {
+        // Mapped files are already read from memory
+        if (const u8* const pointer = base->GetPointer(length, offset)) {
+            std::memcpy(data, pointer, length);
+            return length;
+        }
+
+        const std::size_t buffered = ReadFromBuffer(data, length, offset);
+        const std::size_t remaining = length - buffered;
+        if (remaining == 0) {
+            return buffered;
+        }
+
+        const std::size_t read_offset = offset + buffered;
+        const std::size_t read_ahead_size{std::clamp(remaining * READ_AHEAD_FACTOR,
+                                                     MIN_READ_AHEAD_SIZE, MAX_READ_AHEAD_SIZE)};
+        if (sequential_reads < SEQUENTIAL_READS_THRESHOLD || remaining >= read_ahead_size) {
+            return buffered + base->Read(data + buffered, remaining, read_offset);
+        }
+
+        MICROPROFILE_SCOPE(FileSys_ReadAhead);
+        buffer.resize(read_ahead_size);
+        buffer.resize(base->Read(buffer.data(), buffer.size(), read_offset));
+        buffer_offset = read_offset;
+        return buffered + ReadFromBuffer(data + buffered, remaining, read_offset);
+    }();
+
+    last_read_end = offset + total_read;
+    return total_read;
+}
+
+std::size_t ReadAheadVfsFile::Write(const u8* data, std::size_t length, std::size_t offset) {
+    return 0;
+}
+
+const u8* ReadAheadVfsFile::GetPointer(std::size_t length, std::size_t offset) const {
+    return base->GetPointer(length, offset);
+}
+
+bool ReadAheadVfsFile::Rename(std::string_view name) {
+    return false;
+}
+
+std::size_t ReadAheadVfsFile::ReadFromBuffer(u8* data, std::size_t length,
+                                             std::size_t offset) const {
+    if (offset < buffer_offset || offset >= buffer_offset + buffer.size()) {
+        return 0;
+    }
+    const std::size_t read = std::min(length, buffer_offset + buffer.size() - offset);
+    std::memcpy(data, buffer.data() + (offset - buffer_offset), read);
+    return read;
+}
+
+} // namespace FileSys
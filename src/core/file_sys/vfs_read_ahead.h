@@ -0,0 +1,52 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+#include "core/file_sys/vfs.h"
+
+namespace FileSys {
+
+// An implementation of VfsFile that detects sequential reads of a read-only file and serves them
+// from a read-ahead buffer, so that streaming small chunks doesn't hit the wrapped file for each
+// of them.
+class ReadAheadVfsFile : public VfsFile {
+public:
+    explicit ReadAheadVfsFile(VirtualFile base);
+
+    std::string GetName() const override;
+    std::size_t GetSize() const override;
+    bool Resize(std::size_t new_size) override;
+    std::shared_ptr<VfsDirectory> GetContainingDirectory() const override;
+    bool IsWritable() const override;
+    bool IsReadable() const override;
+    std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override;
+    std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override;
+    const u8* GetPointer(std::size_t length, std::size_t offset) const override;
+    bool Rename(std::string_view name) override;
+
+private:
+    /// Number of consecutive sequential reads after which reading ahead starts
+    static constexpr u32 SEQUENTIAL_READS_THRESHOLD = 2;
+    /// The read-ahead window is a multiple of the size of the last read, within these bounds
+    static constexpr std::size_t MIN_READ_AHEAD_SIZE = 0x10000;
+    static constexpr std::size_t MAX_READ_AHEAD_SIZE = 0x400000;
+    static constexpr std::size_t READ_AHEAD_FACTOR = 4;
+
+    /// Copies the part of the read-ahead buffer that starts at offset, returns the amount copied
+    std::size_t ReadFromBuffer(u8* data, std::size_t length, std::size_t offset) const;
+
+    VirtualFile base;
+
+    mutable std::vector<u8> buffer;
+    mutable std::size_t buffer_offset = 0;
+    /// Offset right after the end of the last read, used to detect sequential access
+    mutable std::size_t last_read_end = 0;
+    mutable u32 sequential_reads = 0;
+};
+
+} // namespace FileSys
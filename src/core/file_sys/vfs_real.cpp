@@ -4,12 +4,15 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstring>
 #include <iterator>
 #include <utility>
 #include "common/assert.h"
 #include "common/common_paths.h"
 #include "common/file_util.h"
 #include "common/logging/log.h"
+#include "common/string_util.h"
+#include "common/tracing.h"
 #include "core/file_sys/vfs_real.h"
 
 namespace FileSys {
@@ -248,6 +251,15 @@ bool RealVfsFile::IsReadable() const {
 }
 
 std::size_t RealVfsFile::Read(u8* data, std::size_t length, std::size_t offset) const {
+    YUZU_TRACE_ZONE("RealVfsFile::Read");
+    if (const auto* const mapped = GetMapping()) {
+        if (offset >= mapped->GetSize())
+            return 0;
+        const std::size_t read = std::min(length, mapped->GetSize() - offset);
+        std::memcpy(data, mapped->GetData() + offset, read);
+        return read;
+    }
+
     if (!backing->Seek(offset, SEEK_SET))
         return 0;
     return backing->ReadBytes(data, length);
@@ -259,14 +271,42 @@ std::size_t RealVfsFile::Write(const u8* data, std::size_t length, std::size_t o
     return backing->WriteBytes(data, length);
 }
 
+const u8* RealVfsFile::GetPointer(std::size_t length, std::size_t offset) const {
+    const auto* const mapped = GetMapping();
+    if (mapped == nullptr || offset > mapped->GetSize() || length > mapped->GetSize() - offset)
+        return nullptr;
+    return mapped->GetData() + offset;
+}
+
 bool RealVfsFile::Rename(std::string_view name) {
     return base.MoveFile(path, parent_path + DIR_SEP + std::string(name)) != nullptr;
 }
 
 bool RealVfsFile::Close() {
+    mapping.reset();
     return backing->Close();
 }
 
+const FileUtil::MappedFile* RealVfsFile::GetMapping() const {
+    if (!is_mapping_attempted) {
+        is_mapping_attempted = true;
+
+        // Only game images are mapped, they are large, read often and never modified while open.
+        // Other files could be truncated through another handle while they are mapped.
+        const std::string extension{
+            Common::ToLower(std::string(FileUtil::GetExtensionFromFilename(path)))};
+        const bool is_game_image = extension == "xci" || extension == "nsp" ||
+                                   extension == "nca" || extension == "nax";
+        if (perms == Mode::Read && is_game_image) {
+            auto mapped = std::make_unique<FileUtil::MappedFile>(path);
+            if (mapped->IsOpen()) {
+                mapping = std::move(mapped);
+            }
+        }
+    }
+    return mapping.get();
+}
+
 // TODO(DarkLordZach): MSVC would not let me combine the following two functions using 'if
 // constexpr' because there is a compile error in the branch not used.
 
@@ -363,6 +403,30 @@ std::vector<std::shared_ptr<VfsDirectory>> RealVfsDirectory::GetSubdirectories()
     return IterateEntries<RealVfsDirectory, VfsDirectory>();
 }
 
+std::vector<VfsDirectoryEntry> RealVfsDirectory::GetEntries() const {
+    if (perms == Mode::Append)
+        return {};
+
+    // Only the host directory is scanned, none of the entries are opened.
+    std::vector<VfsDirectoryEntry> files;
+    std::vector<VfsDirectoryEntry> subdirectories;
+    FileUtil::ForeachDirectoryEntry(
+        nullptr, path,
+        [&](u64* entries_out, const std::string& directory, const std::string& filename) {
+            const std::string full_path = directory + DIR_SEP + filename;
+            if (FileUtil::IsDirectory(full_path)) {
+                subdirectories.push_back({filename, VfsEntryType::Directory, 0});
+            } else {
+                files.push_back({filename, VfsEntryType::File, FileUtil::GetSize(full_path)});
+            }
+            return true;
+        });
+
+    files.insert(files.end(), std::make_move_iterator(subdirectories.begin()),
+                 std::make_move_iterator(subdirectories.end()));
+    return files;
+}
+
 bool RealVfsDirectory::IsWritable() const {
     return (perms & Mode::WriteAppend) != 0;
 }
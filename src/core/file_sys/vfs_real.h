@@ -11,6 +11,7 @@
 
 namespace FileUtil {
 class IOFile;
+class MappedFile;
 }
 
 namespace FileSys {
@@ -55,6 +56,7 @@ public:
     bool IsReadable() const override;
     std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override;
     std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override;
+    const u8* GetPointer(std::size_t length, std::size_t offset) const override;
     bool Rename(std::string_view name) override;
 
 private:
@@ -63,8 +65,13 @@ private:
 
     bool Close();
 
+    // Returns the mapping of the file when it's a read-only game image, mapping it on first use.
+    const FileUtil::MappedFile* GetMapping() const;
+
     RealVfsFilesystem& base;
     std::shared_ptr<FileUtil::IOFile> backing;
+    mutable std::unique_ptr<FileUtil::MappedFile> mapping;
+    mutable bool is_mapping_attempted = false;
     std::string path;
     std::string parent_path;
     std::vector<std::string> path_components;
@@ -88,6 +95,7 @@ public:
     bool DeleteSubdirectoryRecursive(std::string_view name) override;
     std::vector<std::shared_ptr<VfsFile>> GetFiles() const override;
     std::vector<std::shared_ptr<VfsDirectory>> GetSubdirectories() const override;
+    std::vector<VfsDirectoryEntry> GetEntries() const override;
     bool IsWritable() const override;
     bool IsReadable() const override;
     std::string GetName() const override;
@@ -0,0 +1,199 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "common/logging/log.h"
+#include "core/file_sys/vfs_write_back.h"
+
+namespace FileSys {
+
+WriteBackVfsFile::WriteBackVfsFile(VirtualFile base_) : base(std::move(base_)) {}
+
+WriteBackVfsFile::~WriteBackVfsFile() {
+    Commit();
+}
+
+std::string WriteBackVfsFile::GetName() const {
+    return base->GetName();
+}
+
+std::size_t WriteBackVfsFile::GetSize() const {
+    return loaded ? contents.size() : base->GetSize();
+}
+
+bool WriteBackVfsFile::Resize(std::size_t new_size) {
+    LoadContents();
+    contents.resize(new_size);
+    dirty = true;
+    return true;
+}
+
+std::shared_ptr<VfsDirectory> WriteBackVfsFile::GetContainingDirectory() const {
+    return base->GetContainingDirectory();
+}
+
+bool WriteBackVfsFile::IsWritable() const {
+    return base->IsWritable();
+}
+
+bool WriteBackVfsFile::IsReadable() const {
+    return base->IsReadable();
+}
+
+std::size_t WriteBackVfsFile::Read(u8* data, std::size_t length, std::size_t offset) const {
+    if (!loaded) {
+        return base->Read(data, length, offset);
+    }
+    if (offset >= contents.size()) {
+        return 0;
+    }
+
+    const std::size_t read_size = std::min(length, contents.size() - offset);
+    std::memcpy(data, contents.data() + offset, read_size);
+    return read_size;
+}
+
+std::size_t WriteBackVfsFile::Write(const u8* data, std::size_t length, std::size_t offset) {
+    if (!base->IsWritable()) {
+        return 0;
+    }
+
+    LoadContents();
+    if (offset + length > contents.size()) {
+        contents.resize(offset + length);
+    }
+    std::memcpy(contents.data() + offset, data, length);
+    dirty = true;
+    return length;
+}
+
+bool WriteBackVfsFile::Rename(std::string_view name) {
+    return Commit() && base->Rename(name);
+}
+
+bool WriteBackVfsFile::Commit() {
+    if (!dirty) {
+        return true;
+    }
+
+    const auto dir = base->GetContainingDirectory();
+    if (dir == nullptr) {
+        return CommitInPlace();
+    }
+
+    const std::string name = base->GetName();
+    const std::string temp_name = '.' + name + ".writeback";
+    if (dir->GetFile(temp_name) != nullptr) {
+        dir->DeleteFile(temp_name);
+    }
+
+    auto temp = dir->CreateFile(temp_name);
+    if (temp == nullptr) {
+        return CommitInPlace();
+    }
+    if (!temp->Resize(contents.size()) ||
+        temp->Write(contents.data(), contents.size(), 0) != contents.size()) {
+        LOG_ERROR(Service_FS, "Could not write the new contents of {}", name);
+        temp = nullptr;
+        dir->DeleteFile(temp_name);
+        return false;
+    }
+
+    // The old file is only removed once the new contents are safely stored
+    if (!dir->DeleteFile(name) || !temp->Rename(name)) {
+        LOG_CRITICAL(Service_FS, "Could not replace {}, its contents are left in {}", name,
+                     temp_name);
+        return false;
+    }
+
+    auto new_base = dir->GetFile(name);
+    if (new_base == nullptr) {
+        LOG_CRITICAL(Service_FS, "Could not reopen {} after replacing it", name);
+        return false;
+    }
+
+    base = std::move(new_base);
+    dirty = false;
+    return true;
+}
+
+void WriteBackVfsFile::Discard() {
+    contents.clear();
+    contents.shrink_to_fit();
+    loaded = false;
+    dirty = false;
+}
+
+void WriteBackVfsFile::LoadContents() {
+    if (loaded) {
+        return;
+    }
+
+    contents = base->ReadAllBytes();
+    loaded = true;
+}
+
+bool WriteBackVfsFile::CommitInPlace() {
+    if (!base->Resize(contents.size()) ||
+        base->Write(contents.data(), contents.size(), 0) != contents.size()) {
+        LOG_ERROR(Service_FS, "Could not write the contents of {}", base->GetName());
+        return false;
+    }
+
+    dirty = false;
+    return true;
+}
+
+WriteBackCache::~WriteBackCache() {
+    Commit();
+}
+
+VirtualFile WriteBackCache::Open(const std::string& path, VirtualFile file) {
+    auto& cached = files[path];
+    if (cached == nullptr) {
+        cached = std::make_shared<WriteBackVfsFile>(std::move(file));
+    }
+    return cached;
+}
+
+bool WriteBackCache::Release(const std::string& path) {
+    const auto iter = files.find(path);
+    if (iter == files.end()) {
+        return true;
+    }
+
+    const bool committed = iter->second->Commit();
+    files.erase(iter);
+    return committed;
+}
+
+void WriteBackCache::Discard(const std::string& path) {
+    const auto iter = files.find(path);
+    if (iter == files.end()) {
+        return;
+    }
+
+    iter->second->Discard();
+    files.erase(iter);
+}
+
+bool WriteBackCache::Commit() {
+    bool committed = true;
+    for (auto iter = files.begin(); iter != files.end();) {
+        committed &= iter->second->Commit();
+
+        // Files that no handle refers to anymore don't need to stay cached once committed
+        if (iter->second.use_count() == 1 && !iter->second->IsDirty()) {
+            iter = files.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+    return committed;
+}
+
+} // namespace FileSys
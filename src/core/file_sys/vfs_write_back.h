@@ -0,0 +1,84 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/file_sys/vfs.h"
+
+namespace FileSys {
+
+// An implementation of VfsFile that keeps the writes made to a file in memory until they are
+// committed, so that a file written in many small chunks is written to the wrapped file at once.
+class WriteBackVfsFile : public VfsFile {
+public:
+    explicit WriteBackVfsFile(VirtualFile base);
+    ~WriteBackVfsFile() override;
+
+    std::string GetName() const override;
+    std::size_t GetSize() const override;
+    bool Resize(std::size_t new_size) override;
+    std::shared_ptr<VfsDirectory> GetContainingDirectory() const override;
+    bool IsWritable() const override;
+    bool IsReadable() const override;
+    std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override;
+    std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override;
+    bool Rename(std::string_view name) override;
+
+    /// Returns whether there are writes that haven't been committed yet
+    bool IsDirty() const {
+        return dirty;
+    }
+
+    /**
+     * Writes the contents of the file to the wrapped file. They are first written to a temporary
+     * file next to it, which then replaces it, so that the old contents survive a failed commit.
+     * @returns Whether the contents could be written
+     */
+    bool Commit();
+
+    /// Drops the uncommitted writes, used when the wrapped file is deleted
+    void Discard();
+
+private:
+    /// Reads the wrapped file into memory before the first write
+    void LoadContents();
+
+    /// Writes the contents straight to the wrapped file, when it can't be replaced by another one
+    bool CommitInPlace();
+
+    VirtualFile base;
+    std::vector<u8> contents;
+    bool loaded = false;
+    bool dirty = false;
+};
+
+// The write-back views of the files opened in a filesystem, which are shared by all the handles to
+// the same file. Committing the cache commits each of its files, and so does destroying it.
+class WriteBackCache {
+public:
+    ~WriteBackCache();
+
+    /// Returns the write-back view of the file at path, wrapping the file if it isn't cached yet
+    VirtualFile Open(const std::string& path, VirtualFile file);
+
+    /// Commits the writes made to the file at path and stops caching it
+    bool Release(const std::string& path);
+
+    /// Drops the writes made to the file at path and stops caching it
+    void Discard(const std::string& path);
+
+    /// Commits the writes made to every file, returns whether they all succeeded
+    bool Commit();
+
+private:
+    std::map<std::string, std::shared_ptr<WriteBackVfsFile>> files;
+};
+
+} // namespace FileSys
@@ -16,6 +16,7 @@
 #include "core/crypto/aes_util.h"
 #include "core/crypto/xts_encryption_layer.h"
 #include "core/file_sys/partition_filesystem.h"
+#include "core/file_sys/vfs_cached.h"
 #include "core/file_sys/vfs_offset.h"
 #include "core/file_sys/xts_archive.h"
 #include "core/loader/loader.h"
@@ -122,7 +123,9 @@ Loader::ResultStatus NAX::Parse(std::string_view path) {
     std::memcpy(final_key.data(), &header->key_area, final_key.size());
     const auto enc_file =
         std::make_shared<OffsetVfsFile>(file, header->file_size, NAX_HEADER_PADDING_SIZE);
-    dec_file = std::make_shared<Core::Crypto::XTSEncryptionLayer>(enc_file, final_key);
+    dec_file = std::make_shared<CachedVfsFile>(
+        std::make_shared<Core::Crypto::XTSEncryptionLayer>(enc_file, final_key),
+        GetDecryptedBlockCache());
 
     return Loader::ResultStatus::Success;
 }
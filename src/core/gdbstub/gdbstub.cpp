@@ -11,8 +11,12 @@
 #include <cstdarg>
 #include <cstdio>
 #include <cstring>
+#include <deque>
 #include <map>
+#include <mutex>
 #include <numeric>
+#include <string_view>
+#include <thread>
 #include <fcntl.h>
 
 #ifdef _WIN32
@@ -58,10 +62,6 @@ constexpr u32 SIGTRAP = 5;
 constexpr u32 SIGTERM = 15;
 #endif
 
-#ifndef MSG_WAITALL
-constexpr u32 MSG_WAITALL = 8;
-#endif
-
 constexpr u32 LR_REGISTER = 30;
 constexpr u32 SP_REGISTER = 31;
 constexpr u32 PC_REGISTER = 32;
@@ -74,10 +74,9 @@ constexpr u32 TODO_DUMMY_REG_997 = 997;
 constexpr u32 TODO_DUMMY_REG_998 = 998;
 
 // For sample XML files see the GDB source /gdb/features
-// GDB also wants the l character at the start
 // This XML defines what the registers are for this specific ARM device
 constexpr char target_xml[] =
-    R"(l<?xml version="1.0"?>
+    R"(<?xml version="1.0"?>
 <!DOCTYPE target SYSTEM "gdb-target.dtd">
 <target version="1.0">
   <feature name="org.gnu.gdb.aarch64.core">
@@ -144,12 +143,26 @@ constexpr char target_xml[] =
 
 int gdbserver_socket = -1;
 
+// The socket is read by its own thread, which acknowledges the packets and queues the complete ones
+// for the emulation thread, so that the CPU loop never waits for or polls the socket.
+std::thread receive_thread;
+std::mutex received_packets_mutex;
+std::deque<std::vector<u8>> received_packets;
+std::atomic<bool> connection_lost{false};
+
+// Replies of the emulation thread and acknowledgements of the receive thread share the socket
+std::mutex send_mutex;
+
 u8 command_buffer[GDB_BUFFER_SIZE];
 u32 command_length;
 
 u32 latest_signal = 0;
 bool memory_break = false;
 
+// Access that hit a watchpoint, reported to the client along with the memory break
+VAddr watchpoint_address = 0;
+BreakpointType watchpoint_type = BreakpointType::None;
+
 Kernel::Thread* current_thread = nullptr;
 u32 current_core = 0;
 
@@ -403,18 +416,6 @@ static u64 GdbHexToLong(const u8* src) {
     return output;
 }
 
-/// Read a byte from the gdb client.
-static u8 ReadByte() {
-    u8 c;
-    std::size_t received_size = recv(gdbserver_socket, reinterpret_cast<char*>(&c), 1, MSG_WAITALL);
-    if (received_size != 1) {
-        LOG_ERROR(Debug_GDBStub, "recv failed: {}", received_size);
-        Shutdown();
-    }
-
-    return c;
-}
-
 /// Calculate the checksum of the current command buffer.
 static u8 CalculateChecksum(const u8* buffer, std::size_t length) {
     return static_cast<u8>(std::accumulate(buffer, buffer + length, 0, std::plus<u8>()));
@@ -454,8 +455,13 @@ static void RemoveBreakpoint(BreakpointType type, VAddr addr) {
 
     LOG_DEBUG(Debug_GDBStub, "gdb: removed a breakpoint: {:016X} bytes at {:016X} of type {}",
               bp->second.len, bp->second.addr, static_cast<int>(type));
-    Memory::WriteBlock(bp->second.addr, bp->second.inst.data(), bp->second.inst.size());
-    Core::System::GetInstance().InvalidateCpuInstructionCaches();
+    if (type == BreakpointType::Execute) {
+        Memory::WriteBlock(bp->second.addr, bp->second.inst.data(), bp->second.inst.size());
+        Core::System::GetInstance().InvalidateCpuInstructionCacheRange(bp->second.addr,
+                                                                       bp->second.inst.size());
+    } else {
+        Memory::MarkRegionWatched(bp->second.addr, bp->second.len, false);
+    }
     p.erase(addr);
 }
 
@@ -512,16 +518,54 @@ bool CheckBreakpoint(VAddr addr, BreakpointType type) {
     return false;
 }
 
+void CheckWatchpoint(VAddr addr, std::size_t size, BreakpointType type) {
+    if (!IsConnected() || memory_break) {
+        return;
+    }
+
+    // Watchpoints starting before the end of the access hit it if they also end after its start
+    const BreakpointMap& p = GetBreakpointMap(type);
+    const auto end = p.lower_bound(addr + size);
+    const auto hit = std::find_if(p.begin(), end, [addr](const auto& entry) {
+        const Breakpoint& bp = entry.second;
+        return bp.active && addr < bp.addr + bp.len;
+    });
+    if (hit == end) {
+        return;
+    }
+
+    LOG_DEBUG(Debug_GDBStub, "Hit watchpoint type {} @ {:016X} ({} bytes)", static_cast<int>(type),
+              addr, size);
+    watchpoint_address = std::max(addr, hit->second.addr);
+    watchpoint_type = type;
+    Break(true);
+
+    // The access completes, and the CPU stops once it leaves the current block
+    Core::CurrentArmInterface().PrepareReschedule();
+}
+
+/// Sends a block of data to the gdb client, returning false if the connection failed.
+static bool SendAll(const char* data, std::size_t size) {
+    std::lock_guard<std::mutex> lock{send_mutex};
+    while (size > 0) {
+        const int sent_size = send(gdbserver_socket, data, static_cast<int>(size), 0);
+        if (sent_size < 0) {
+            LOG_ERROR(Debug_GDBStub, "gdb: send failed");
+            return false;
+        }
+        data += sent_size;
+        size -= sent_size;
+    }
+    return true;
+}
+
 /**
  * Send packet to gdb client.
  *
  * @param packet Packet to be sent to client.
  */
 static void SendPacket(const char packet) {
-    std::size_t sent_size = send(gdbserver_socket, &packet, 1, 0);
-    if (sent_size != 1) {
-        LOG_ERROR(Debug_GDBStub, "send failed");
-    }
+    SendAll(&packet, 1);
 }
 
 /**
@@ -529,41 +573,70 @@ static void SendPacket(const char packet) {
  *
  * @param reply Reply to be sent to client.
  */
-static void SendReply(const char* reply) {
+static void SendReply(std::string_view reply) {
     if (!IsConnected()) {
         return;
     }
 
     LOG_DEBUG(Debug_GDBStub, "Reply: {}", reply);
 
-    memset(command_buffer, 0, sizeof(command_buffer));
-
-    command_length = static_cast<u32>(strlen(reply));
-    if (command_length + 4 > sizeof(command_buffer)) {
-        LOG_ERROR(Debug_GDBStub, "command_buffer overflow in SendReply");
+    if (reply.size() + 4 > GDB_BUFFER_SIZE) {
+        LOG_ERROR(Debug_GDBStub, "Reply of {} bytes is too large", reply.size());
         return;
     }
 
-    memcpy(command_buffer + 1, reply, command_length);
+    // Build the whole packet so that it goes out in a single send
+    const u8 checksum =
+        CalculateChecksum(reinterpret_cast<const u8*>(reply.data()), reply.size());
+    std::string packet;
+    packet.reserve(reply.size() + 4);
+    packet += GDB_STUB_START;
+    packet += reply;
+    packet += GDB_STUB_END;
+    packet += static_cast<char>(NibbleToHex(checksum >> 4));
+    packet += static_cast<char>(NibbleToHex(checksum));
 
-    u8 checksum = CalculateChecksum(command_buffer, command_length + 1);
-    command_buffer[0] = GDB_STUB_START;
-    command_buffer[command_length + 1] = GDB_STUB_END;
-    command_buffer[command_length + 2] = NibbleToHex(checksum >> 4);
-    command_buffer[command_length + 3] = NibbleToHex(checksum);
+    if (!SendAll(packet.data(), packet.size())) {
+        Shutdown();
+    }
+}
 
-    u8* ptr = command_buffer;
-    u32 left = command_length + 4;
-    while (left > 0) {
-        int sent_size = send(gdbserver_socket, reinterpret_cast<char*>(ptr), left, 0);
-        if (sent_size < 0) {
-            LOG_ERROR(Debug_GDBStub, "gdb: send failed");
-            return Shutdown();
+/// Escapes the characters that have a meaning in the protocol from binary data.
+static std::string EscapeBinary(std::string_view data) {
+    std::string escaped;
+    escaped.reserve(data.size());
+    for (const char c : data) {
+        if (c == '#' || c == '$' || c == '}' || c == '*') {
+            escaped += '}';
+            escaped += static_cast<char>(c ^ 0x20);
+        } else {
+            escaped += c;
         }
+    }
+    return escaped;
+}
 
-        left -= sent_size;
-        ptr += sent_size;
+/**
+ * Replies to a qXfer read with the part of the object that was asked for.
+ *
+ * @param object Whole object being transferred.
+ * @param annex_end Position in the command buffer of the ':' before the offset and length.
+ */
+static void SendXferReply(std::string_view object, const u8* annex_end) {
+    const u8* const end = command_buffer + command_length;
+    const u8* const offset_end = std::find(annex_end + 1, end, ',');
+    if (offset_end == end) {
+        return SendReply("E01");
     }
+    const u64 offset = HexToLong(annex_end + 1, static_cast<u64>(offset_end - annex_end - 1));
+    const u64 length = HexToLong(offset_end + 1, static_cast<u64>(end - offset_end - 1));
+
+    if (offset >= object.size()) {
+        return SendReply("l");
+    }
+    const std::string_view part = object.substr(offset, length);
+    const char type = offset + part.size() >= object.size() ? 'l' : 'm';
+    SendReply(type + EscapeBinary(part));
 }
 
 /// Handle query command from gdb client.
@@ -583,7 +656,7 @@ static void HandleQuery() {
         SendReply(buffer.c_str());
     } else if (strncmp(query, "Xfer:features:read:target.xml:",
                        strlen("Xfer:features:read:target.xml:")) == 0) {
-        SendReply(target_xml);
+        SendXferReply(target_xml, command_buffer + strlen("qXfer:features:read:target.xml"));
     } else if (strncmp(query, "Offsets", strlen("Offsets")) == 0) {
         std::string buffer = fmt::format("TextSeg={:0x}", Memory::PROCESS_IMAGE_VADDR);
         SendReply(buffer.c_str());
@@ -600,9 +673,9 @@ static void HandleQuery() {
         SendReply(val.c_str());
     } else if (strncmp(query, "sThreadInfo", strlen("sThreadInfo")) == 0) {
         SendReply("l");
-    } else if (strncmp(query, "Xfer:threads:read", strlen("Xfer:threads:read")) == 0) {
+    } else if (strncmp(query, "Xfer:threads:read::", strlen("Xfer:threads:read::")) == 0) {
         std::string buffer;
-        buffer += "l<?xml version=\"1.0\"?>";
+        buffer += "<?xml version=\"1.0\"?>";
         buffer += "<threads>";
         for (u32 core = 0; core < Core::NUM_CPU_CORES; core++) {
             const auto& threads = Core::System::GetInstance().Scheduler(core)->GetThreadList();
@@ -613,18 +686,18 @@ static void HandleQuery() {
             }
         }
         buffer += "</threads>";
-        SendReply(buffer.c_str());
-    } else if (strncmp(query, "Xfer:libraries:read", strlen("Xfer:libraries:read")) == 0) {
+        SendXferReply(buffer, command_buffer + strlen("qXfer:threads:read:"));
+    } else if (strncmp(query, "Xfer:libraries:read::", strlen("Xfer:libraries:read::")) == 0) {
         std::string buffer;
-        buffer += "l<?xml version=\"1.0\"?>";
+        buffer += "<?xml version=\"1.0\"?>";
         buffer += "<library-list>";
         for (const auto& module : modules) {
             buffer +=
-                fmt::format(R"*("<library name = "{}"><segment address = "0x{:x}"/></library>)*",
+                fmt::format(R"*(<library name = "{}"><segment address = "0x{:x}"/></library>)*",
                             module.name, module.beg);
         }
         buffer += "</library-list>";
-        SendReply(buffer.c_str());
+        SendXferReply(buffer, command_buffer + strlen("qXfer:libraries:read:"));
     } else {
         SendReply("");
     }
@@ -679,14 +752,16 @@ static void SendSignal(Kernel::Thread* thread, u32 signal, bool full = true) {
         full = false;
     }
 
-    std::string buffer;
+    std::string buffer = fmt::format("T{:02x}", latest_signal);
+    if (memory_break) {
+        const char* reason = watchpoint_type == BreakpointType::Write ? "watch" : "rwatch";
+        buffer += fmt::format("{}:{:x};", reason, watchpoint_address);
+    }
     if (full) {
-        buffer = fmt::format("T{:02x}{:02x}:{:016x};{:02x}:{:016x};{:02x}:{:016x}", latest_signal,
-                             PC_REGISTER, Common::swap64(RegRead(PC_REGISTER, thread)), SP_REGISTER,
-                             Common::swap64(RegRead(SP_REGISTER, thread)), LR_REGISTER,
-                             Common::swap64(RegRead(LR_REGISTER, thread)));
-    } else {
-        buffer = fmt::format("T{:02x}", latest_signal);
+        buffer += fmt::format("{:02x}:{:016x};{:02x}:{:016x};{:02x}:{:016x}", PC_REGISTER,
+                              Common::swap64(RegRead(PC_REGISTER, thread)), SP_REGISTER,
+                              Common::swap64(RegRead(SP_REGISTER, thread)), LR_REGISTER,
+                              Common::swap64(RegRead(LR_REGISTER, thread)));
     }
 
     if (thread) {
@@ -696,74 +771,102 @@ static void SendSignal(Kernel::Thread* thread, u32 signal, bool full = true) {
     SendReply(buffer.c_str());
 }
 
-/// Read command from gdb client.
-static void ReadCommand() {
-    command_length = 0;
-    memset(command_buffer, 0, sizeof(command_buffer));
+/**
+ * Splits the complete packets off the data received from the gdb client, acknowledging and
+ * queueing them. Incomplete packets are left at the end of the data.
+ */
+static void ParsePackets(std::vector<u8>& data) {
+    auto position = data.begin();
+    while (position != data.end()) {
+        const u8 c = *position;
+        if (c == GDB_STUB_ACK || c == GDB_STUB_NACK) {
+            // Replies are never resent, so acknowledgements are ignored
+            ++position;
+            continue;
+        }
+        if (c == 0x03) {
+            std::lock_guard<std::mutex> lock{received_packets_mutex};
+            received_packets.push_back({c});
+            ++position;
+            continue;
+        }
+        if (c != GDB_STUB_START) {
+            LOG_DEBUG(Debug_GDBStub, "gdb: read invalid byte {:02X}", c);
+            ++position;
+            continue;
+        }
 
-    u8 c = ReadByte();
-    if (c == '+') {
-        // ignore ack
-        return;
-    } else if (c == 0x03) {
-        LOG_INFO(Debug_GDBStub, "gdb: found break command");
-        halt_loop = true;
-        SendSignal(current_thread, SIGTRAP);
-        return;
-    } else if (c != GDB_STUB_START) {
-        LOG_DEBUG(Debug_GDBStub, "gdb: read invalid byte {:02X}", c);
-        return;
-    }
+        // The packet is complete once its end and both checksum digits have arrived
+        const auto end = std::find(position + 1, data.end(), GDB_STUB_END);
+        if (std::distance(end, data.end()) < 3) {
+            break;
+        }
+        const auto payload_begin = position + 1;
+        const auto payload_size = static_cast<std::size_t>(std::distance(payload_begin, end));
+        position = end + 3;
 
-    while ((c = ReadByte()) != GDB_STUB_END) {
-        if (command_length >= sizeof(command_buffer)) {
+        if (payload_size >= GDB_BUFFER_SIZE) {
             LOG_ERROR(Debug_GDBStub, "gdb: command_buffer overflow");
             SendPacket(GDB_STUB_NACK);
-            return;
+            continue;
         }
-        command_buffer[command_length++] = c;
-    }
 
-    u8 checksum_received = HexCharToValue(ReadByte()) << 4;
-    checksum_received |= HexCharToValue(ReadByte());
-
-    u8 checksum_calculated = CalculateChecksum(command_buffer, command_length);
-
-    if (checksum_received != checksum_calculated) {
-        LOG_ERROR(Debug_GDBStub,
-                  "gdb: invalid checksum: calculated {:02X} and read {:02X} for ${}# (length: {})",
-                  checksum_calculated, checksum_received, command_buffer, command_length);
-
-        command_length = 0;
+        const u8 checksum_received = (HexCharToValue(end[1]) << 4) | HexCharToValue(end[2]);
+        const u8 checksum_calculated = CalculateChecksum(&*payload_begin, payload_size);
+        if (checksum_received != checksum_calculated) {
+            LOG_ERROR(Debug_GDBStub,
+                      "gdb: invalid checksum: calculated {:02X} and read {:02X} (length: {})",
+                      checksum_calculated, checksum_received, payload_size);
+            SendPacket(GDB_STUB_NACK);
+            continue;
+        }
 
-        SendPacket(GDB_STUB_NACK);
-        return;
+        SendPacket(GDB_STUB_ACK);
+        std::lock_guard<std::mutex> lock{received_packets_mutex};
+        received_packets.emplace_back(payload_begin, end);
     }
-
-    SendPacket(GDB_STUB_ACK);
+    data.erase(data.begin(), position);
 }
 
-/// Check if there is data to be read from the gdb client.
-static bool IsDataAvailable() {
-    if (!IsConnected()) {
-        return false;
+/// Reads the socket of the gdb client in large chunks until the connection is closed.
+static void ReceiveLoop() {
+    std::vector<u8> data;
+    std::array<char, 0x1000> chunk;
+    while (true) {
+        const int received_size = recv(gdbserver_socket, chunk.data(), chunk.size(), 0);
+        if (received_size <= 0) {
+            connection_lost = true;
+            return;
+        }
+        data.insert(data.end(), chunk.begin(), chunk.begin() + received_size);
+        ParsePackets(data);
     }
+}
 
-    fd_set fd_socket;
-
-    FD_ZERO(&fd_socket);
-    FD_SET(static_cast<u32>(gdbserver_socket), &fd_socket);
-
-    struct timeval t;
-    t.tv_sec = 0;
-    t.tv_usec = 0;
+/// Takes the next command received from the gdb client, returning false if there is none.
+static bool ReadCommand() {
+    std::vector<u8> packet;
+    {
+        std::lock_guard<std::mutex> lock{received_packets_mutex};
+        if (received_packets.empty()) {
+            return false;
+        }
+        packet = std::move(received_packets.front());
+        received_packets.pop_front();
+    }
 
-    if (select(gdbserver_socket + 1, &fd_socket, nullptr, nullptr, &t) < 0) {
-        LOG_ERROR(Debug_GDBStub, "select failed");
+    if (packet.size() == 1 && packet[0] == 0x03) {
+        LOG_INFO(Debug_GDBStub, "gdb: found break command");
+        halt_loop = true;
+        SendSignal(current_thread, SIGTRAP);
         return false;
     }
 
-    return FD_ISSET(gdbserver_socket, &fd_socket) != 0;
+    // Handlers parse some commands as strings, keep the buffer null terminated
+    memset(command_buffer, 0, sizeof(command_buffer));
+    std::copy(packet.begin(), packet.end(), command_buffer);
+    command_length = static_cast<u32>(packet.size());
+    return true;
 }
 
 /// Send requested register to gdb client.
@@ -903,7 +1006,7 @@ static void ReadMemory() {
     LOG_DEBUG(Debug_GDBStub, "gdb: addr: {:016X} len: {:016X}", addr, len);
 
     if (len * 2 > sizeof(reply)) {
-        SendReply("E01");
+        return SendReply("E01");
     }
 
     if (addr < Memory::PROCESS_IMAGE_VADDR || addr >= Memory::MAP_REGION_VADDR_END) {
@@ -940,7 +1043,40 @@ static void WriteMemory() {
 
     GdbHexToMem(data.data(), len_pos + 1, len);
     Memory::WriteBlock(addr, data.data(), len);
-    Core::System::GetInstance().InvalidateCpuInstructionCaches();
+    Core::System::GetInstance().InvalidateCpuInstructionCacheRange(addr, len);
+    SendReply("OK");
+}
+
+/// Modify location in memory with binary data received from the gdb client.
+static void WriteMemoryBinary() {
+    auto start_offset = command_buffer + 1;
+    auto addr_pos = std::find(start_offset, command_buffer + command_length, ',');
+    VAddr addr = HexToLong(start_offset, static_cast<u64>(addr_pos - start_offset));
+
+    start_offset = addr_pos + 1;
+    auto len_pos = std::find(start_offset, command_buffer + command_length, ':');
+    u64 len = HexToLong(start_offset, static_cast<u64>(len_pos - start_offset));
+
+    // gdb probes for support of this packet with an empty write
+    if (len == 0) {
+        return SendReply("OK");
+    }
+
+    if (!Memory::IsValidVirtualAddress(addr)) {
+        return SendReply("E00");
+    }
+
+    std::vector<u8> data;
+    data.reserve(len);
+    for (auto c = len_pos + 1; c < command_buffer + command_length && data.size() < len; ++c) {
+        data.push_back(*c == '}' ? *++c ^ 0x20 : *c);
+    }
+    if (data.size() != len) {
+        return SendReply("E01");
+    }
+
+    Memory::WriteBlock(addr, data.data(), len);
+    Core::System::GetInstance().InvalidateCpuInstructionCacheRange(addr, len);
     SendReply("OK");
 }
 
@@ -960,7 +1096,6 @@ static void Step() {
     step_loop = true;
     halt_loop = true;
     send_trap = true;
-    Core::System::GetInstance().InvalidateCpuInstructionCaches();
 }
 
 /// Tell the CPU if we hit a memory breakpoint.
@@ -977,7 +1112,6 @@ static void Continue() {
     memory_break = false;
     step_loop = false;
     halt_loop = false;
-    Core::System::GetInstance().InvalidateCpuInstructionCaches();
 }
 
 /**
@@ -994,10 +1128,16 @@ static bool CommitBreakpoint(BreakpointType type, VAddr addr, u64 len) {
     breakpoint.active = true;
     breakpoint.addr = addr;
     breakpoint.len = len;
-    Memory::ReadBlock(addr, breakpoint.inst.data(), breakpoint.inst.size());
-    static constexpr std::array<u8, 4> btrap{{0x00, 0x7d, 0x20, 0xd4}};
-    Memory::WriteBlock(addr, btrap.data(), btrap.size());
-    Core::System::GetInstance().InvalidateCpuInstructionCaches();
+    if (type == BreakpointType::Execute) {
+        // Patching in a BRK lets the JIT run at full speed until it reaches the breakpoint
+        Memory::ReadBlock(addr, breakpoint.inst.data(), breakpoint.inst.size());
+        static constexpr std::array<u8, 4> btrap{{0x00, 0x7d, 0x20, 0xd4}};
+        Memory::WriteBlock(addr, btrap.data(), btrap.size());
+        Core::System::GetInstance().InvalidateCpuInstructionCacheRange(addr, btrap.size());
+    } else {
+        // Only the accesses to the watched pages leave the JIT's fast path
+        Memory::MarkRegionWatched(addr, len, true);
+    }
     p.insert({addr, breakpoint});
 
     LOG_DEBUG(Debug_GDBStub, "gdb: added {} breakpoint: {:016X} bytes at {:016X}",
@@ -1099,12 +1239,13 @@ void HandlePacket() {
         return;
     }
 
-    if (!IsDataAvailable()) {
+    if (connection_lost) {
+        LOG_ERROR(Debug_GDBStub, "gdb: connection lost");
+        Shutdown();
         return;
     }
 
-    ReadCommand();
-    if (command_length == 0) {
+    if (!ReadCommand()) {
         return;
     }
 
@@ -1142,6 +1283,9 @@ void HandlePacket() {
     case 'M':
         WriteMemory();
         break;
+    case 'X':
+        WriteMemoryBinary();
+        break;
     case 's':
         Step();
         return;
@@ -1255,6 +1399,8 @@ static void Init(u16 port) {
     } else {
         LOG_INFO(Debug_GDBStub, "Client connected.");
         saddr_client.sin_addr.s_addr = ntohl(saddr_client.sin_addr.s_addr);
+        connection_lost = false;
+        receive_thread = std::thread{ReceiveLoop};
     }
 
     // Clean up temporary socket if it's still alive at this point.
@@ -1274,9 +1420,14 @@ void Shutdown() {
 
     LOG_INFO(Debug_GDBStub, "Stopping GDB ...");
     if (gdbserver_socket != -1) {
+        // This also ends the receive loop, which is blocked reading the socket
         shutdown(gdbserver_socket, SHUT_RDWR);
+        if (receive_thread.joinable()) {
+            receive_thread.join();
+        }
         gdbserver_socket = -1;
     }
+    received_packets.clear();
 
 #ifdef _WIN32
     WSACleanup();
@@ -84,6 +84,15 @@ BreakpointAddress GetNextBreakpointFromAddress(VAddr addr, GDBStub::BreakpointTy
  */
 bool CheckBreakpoint(VAddr addr, GDBStub::BreakpointType type);
 
+/**
+ * Check if a memory access hits a watchpoint, and if so halt the CPU and report the access.
+ *
+ * @param addr Address of the access.
+ * @param size Size of the access in bytes.
+ * @param type Type of the access, Read or Write.
+ */
+void CheckWatchpoint(VAddr addr, std::size_t size, GDBStub::BreakpointType type);
+
 /// If set to true, the CPU will halt at the beginning of the next CPU loop.
 bool GetCpuHaltFlag();
 
@@ -0,0 +1,256 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <map>
+#include <mutex>
+#include <set>
+#include <utility>
+#include <fmt/format.h>
+#include "common/logging/log.h"
+#include "core/arm/arm_interface.h"
+#include "core/core_cpu.h"
+#include "core/core_timing.h"
+#include "core/core_timing_util.h"
+#include "core/guest_profiler.h"
+#include "core/memory.h"
+
+namespace Core::GuestProfiler {
+namespace {
+/// The cores are sampled a thousand times per second of emulated time
+constexpr u64 SAMPLE_INTERVAL_TICKS = CoreTiming::BASE_CLOCK_RATE / 1000;
+
+/// Deepest call stack walked, the outermost callers of deeper stacks are left out
+constexpr std::size_t MAX_STACK_DEPTH = 64;
+
+/// Number of functions listed by LogTotals
+constexpr std::size_t NUM_LOGGED_FUNCTIONS = 16;
+
+/// Size of an A64 instruction, return addresses point right after the call
+constexpr VAddr INSTRUCTION_SIZE = 4;
+
+struct Module {
+    std::string name;
+    VAddr end;
+};
+
+struct Symbol {
+    std::string name;
+    u64 size;
+};
+
+std::mutex mutex;
+// Keyed by base address, guarded by mutex
+std::map<VAddr, Module> modules;
+// Keyed by address, guarded by mutex
+std::map<VAddr, Symbol> symbols;
+// Sample count of each stack, from the sampled PC to the outermost return address, guarded by
+// mutex
+std::map<std::vector<VAddr>, u64> stack_samples;
+u64 sample_count = 0;
+
+// Each entry is only accessed from the host thread running its core
+std::array<u64, NUM_CPU_CORES> last_sample_ticks{};
+
+/// Names the function containing the given address, must be called with the mutex held
+std::string Symbolize(VAddr address) {
+    auto symbol = symbols.upper_bound(address);
+    if (symbol != symbols.begin()) {
+        --symbol;
+        if (address - symbol->first < std::max<u64>(symbol->second.size, 1)) {
+            return symbol->second.name;
+        }
+    }
+
+    auto module = modules.upper_bound(address);
+    if (module != modules.begin()) {
+        --module;
+        if (address < module->second.end) {
+            return fmt::format("{}+0x{:X}", module->second.name, address - module->first);
+        }
+    }
+    return fmt::format("0x{:016X}", address);
+}
+
+/// Names each frame of a sampled stack, must be called with the mutex held
+std::vector<std::string> SymbolizeStack(const std::vector<VAddr>& stack) {
+    std::vector<std::string> frames;
+    frames.reserve(stack.size());
+    for (std::size_t i = 0; i < stack.size(); ++i) {
+        // Return addresses are looked up at the call, which may be the last instruction of its
+        // function
+        frames.push_back(Symbolize(i == 0 ? stack[i] : stack[i] - INSTRUCTION_SIZE));
+    }
+    return frames;
+}
+
+bool IsValidFrameRecord(VAddr frame) {
+    return frame != 0 && frame % sizeof(u64) == 0 && Memory::IsValidVirtualAddress(frame) &&
+           Memory::IsValidVirtualAddress(frame + sizeof(u64));
+}
+
+std::vector<VAddr> WalkStack(const ARM_Interface& arm_interface) {
+    std::vector<VAddr> stack{arm_interface.GetPC()};
+
+    // A leaf function may not push a frame record at all, and any function is sampled before it
+    // pushed its own at times. Its caller is then only known from the link register, which is
+    // otherwise the return address saved in the first record.
+    const VAddr link_register = arm_interface.GetReg(30);
+    VAddr frame = arm_interface.GetReg(29);
+    bool is_first_record = true;
+    while (stack.size() < MAX_STACK_DEPTH && IsValidFrameRecord(frame)) {
+        const VAddr next_frame = Memory::Read64(frame);
+        const VAddr return_address = Memory::Read64(frame + sizeof(u64));
+        if (is_first_record && return_address != link_register && link_register != 0) {
+            stack.push_back(link_register);
+        }
+        is_first_record = false;
+
+        if (return_address == 0) {
+            break;
+        }
+        stack.push_back(return_address);
+
+        // The stack grows down, so the records of the callers are at higher addresses. Anything
+        // else is a corrupted chain that could loop forever.
+        if (next_frame <= frame) {
+            break;
+        }
+        frame = next_frame;
+    }
+    if (is_first_record && link_register != 0) {
+        stack.push_back(link_register);
+    }
+    if (stack.size() > MAX_STACK_DEPTH) {
+        stack.resize(MAX_STACK_DEPTH);
+    }
+    return stack;
+}
+} // Anonymous namespace
+
+void RegisterModule(std::string name, VAddr base, VAddr end) {
+    std::lock_guard<std::mutex> lock(mutex);
+    modules.insert_or_assign(base, Module{std::move(name), end});
+}
+
+void RegisterSymbol(std::string name, VAddr address, u64 size) {
+    std::lock_guard<std::mutex> lock(mutex);
+    symbols.insert_or_assign(address, Symbol{std::move(name), size});
+}
+
+void Sample(std::size_t core_index, const ARM_Interface& arm_interface) {
+    // The ticks go back to zero when emulation restarts
+    const u64 ticks = CoreTiming::GetTicks();
+    u64& last_ticks = last_sample_ticks[core_index];
+    if (ticks >= last_ticks && ticks - last_ticks < SAMPLE_INTERVAL_TICKS) {
+        return;
+    }
+    last_ticks = ticks;
+
+    std::vector<VAddr> stack = WalkStack(arm_interface);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ++stack_samples[std::move(stack)];
+    ++sample_count;
+}
+
+u64 GetSampleCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return sample_count;
+}
+
+std::vector<GuestFunctionEntry> GetFlatProfile() {
+    std::map<std::string, GuestFunctionEntry> functions;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& [stack, samples] : stack_samples) {
+            const std::vector<std::string> frames = SymbolizeStack(stack);
+            functions[frames.front()].self_samples += samples;
+
+            // Recursive functions are only counted once per stack
+            const std::set<std::string> unique_frames(frames.begin(), frames.end());
+            for (const std::string& frame : unique_frames) {
+                functions[frame].total_samples += samples;
+            }
+        }
+    }
+
+    std::vector<GuestFunctionEntry> entries;
+    entries.reserve(functions.size());
+    for (auto& [name, entry] : functions) {
+        entry.name = name;
+        entries.push_back(std::move(entry));
+    }
+    std::sort(entries.begin(), entries.end(), [](const auto& lhs, const auto& rhs) {
+        if (lhs.self_samples != rhs.self_samples) {
+            return lhs.self_samples > rhs.self_samples;
+        }
+        return lhs.total_samples > rhs.total_samples;
+    });
+    return entries;
+}
+
+std::string FormatFlatCSV(const std::vector<GuestFunctionEntry>& entries) {
+    std::string csv = "function,self_samples,total_samples\n";
+    for (const GuestFunctionEntry& entry : entries) {
+        csv += fmt::format("\"{}\",{},{}\n", entry.name, entry.self_samples, entry.total_samples);
+    }
+    return csv;
+}
+
+std::string FormatFoldedStacks() {
+    // Different addresses in the same functions fold into the same line
+    std::map<std::string, u64> folded_stacks;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& [stack, samples] : stack_samples) {
+            const std::vector<std::string> frames = SymbolizeStack(stack);
+            std::string folded;
+            for (auto frame = frames.rbegin(); frame != frames.rend(); ++frame) {
+                if (!folded.empty()) {
+                    folded += ';';
+                }
+                folded += *frame;
+            }
+            folded_stacks[folded] += samples;
+        }
+    }
+
+    std::string output;
+    for (const auto& [folded, samples] : folded_stacks) {
+        output += fmt::format("{} {}\n", folded, samples);
+    }
+    return output;
+}
+
+void Reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    stack_samples.clear();
+    sample_count = 0;
+}
+
+void ClearModules() {
+    std::lock_guard<std::mutex> lock(mutex);
+    modules.clear();
+    symbols.clear();
+}
+
+void LogTotals() {
+    const std::vector<GuestFunctionEntry> entries = GetFlatProfile();
+    const u64 total_samples = GetSampleCount();
+    if (entries.empty() || total_samples == 0) {
+        return;
+    }
+
+    LOG_INFO(Core, "Guest functions with the most samples, out of {}:", total_samples);
+    for (std::size_t i = 0; i < std::min(entries.size(), NUM_LOGGED_FUNCTIONS); ++i) {
+        const GuestFunctionEntry& entry = entries[i];
+        LOG_INFO(Core, "  {:5.1f}% self {:5.1f}% total  {}",
+                 100.0 * entry.self_samples / total_samples,
+                 100.0 * entry.total_samples / total_samples, entry.name);
+    }
+}
+
+} // namespace Core::GuestProfiler
@@ -0,0 +1,72 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Core {
+
+class ARM_Interface;
+
+/// Samples attributed to one guest function, or to one address when it has no symbol
+struct GuestFunctionEntry {
+    std::string name;
+    /// Samples taken while the function was running
+    u64 self_samples = 0;
+    /// Samples taken while the function was running or was one of the callers on the stack
+    u64 total_samples = 0;
+};
+
+/**
+ * Finds the guest functions the emulated CPU spends its time in when
+ * Settings::values.profile_guest is set. Each core samples its PC and call stack at a fixed
+ * interval of emulated time, between two of its slices. The call stack is walked through the
+ * frame records pointed to by the frame pointer, which the Switch SDK keeps.
+ *
+ * The samples are symbolized when they're read, against the modules registered by the loaders and
+ * the functions of their dynamic symbol tables. Addresses outside of any symbol are shown as an
+ * offset into their module.
+ */
+namespace GuestProfiler {
+
+/// Registers a module loaded at [base, end), must be called before any of its symbols
+void RegisterModule(std::string name, VAddr base, VAddr end);
+
+/// Registers a function of the module containing its address
+void RegisterSymbol(std::string name, VAddr address, u64 size);
+
+/// Samples the given core if the sampling interval elapsed, must be called from its host thread
+void Sample(std::size_t core_index, const ARM_Interface& arm_interface);
+
+/// Returns the number of samples taken since the last reset
+u64 GetSampleCount();
+
+/// Returns the samples of each function, sorted by decreasing self samples
+std::vector<GuestFunctionEntry> GetFlatProfile();
+
+/// Formats the flat profile as a CSV table with a header row
+std::string FormatFlatCSV(const std::vector<GuestFunctionEntry>& entries);
+
+/**
+ * Formats the sampled call stacks in the folded format, one line per distinct stack with its
+ * frames from the outermost caller to the sampled function, followed by its sample count. This is
+ * what stackcollapse-perf.pl produces from perf script, which flamegraph.pl and speedscope import.
+ */
+std::string FormatFoldedStacks();
+
+/// Clears the samples taken so far
+void Reset();
+
+/// Forgets the registered modules and symbols, when the process they belong to is destroyed
+void ClearModules();
+
+/// Logs the functions with the most samples
+void LogTotals();
+
+} // namespace GuestProfiler
+} // namespace Core
@@ -0,0 +1,122 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <vector>
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "core/arm/arm_interface.h"
+#include "core/core.h"
+#include "core/hle/function_replacement.h"
+#include "core/memory.h"
+
+namespace HLE::FunctionReplacement {
+namespace {
+/// Size of the chunks read by the functions that stop at the first difference or terminator
+constexpr std::size_t CHUNK_SIZE = Memory::PAGE_SIZE;
+
+u64 Memcpy(VAddr dest, VAddr src, u64 size) {
+    Memory::CopyBlock(dest, src, size);
+    return dest;
+}
+
+u64 Memmove(VAddr dest, VAddr src, u64 size) {
+    // CopyBlock copies forward one host run at a time, which overlapping ranges would corrupt
+    if (dest < src + size && src < dest + size) {
+        std::vector<u8> buffer(size);
+        Memory::ReadBlock(src, buffer.data(), size);
+        Memory::WriteBlock(dest, buffer.data(), size);
+    } else {
+        Memory::CopyBlock(dest, src, size);
+    }
+    return dest;
+}
+
+u64 Memset(VAddr dest, u64 value, u64 size) {
+    Memory::FillBlock(*Core::CurrentProcess(), dest, static_cast<u8>(value), size);
+    return dest;
+}
+
+u64 Memcmp(VAddr lhs, VAddr rhs, u64 size) {
+    std::array<u8, CHUNK_SIZE> lhs_chunk;
+    std::array<u8, CHUNK_SIZE> rhs_chunk;
+    for (u64 offset = 0; offset < size; offset += CHUNK_SIZE) {
+        const auto chunk_size = static_cast<std::size_t>(std::min<u64>(size - offset, CHUNK_SIZE));
+        Memory::ReadBlock(lhs + offset, lhs_chunk.data(), chunk_size);
+        Memory::ReadBlock(rhs + offset, rhs_chunk.data(), chunk_size);
+        const auto mismatch = std::mismatch(lhs_chunk.begin(), lhs_chunk.begin() + chunk_size,
+                                            rhs_chunk.begin());
+        if (mismatch.first != lhs_chunk.begin() + chunk_size) {
+            // The result is an int, sign extended to the whole register
+            return static_cast<u64>(static_cast<s64>(*mismatch.first - *mismatch.second));
+        }
+    }
+    return 0;
+}
+
+u64 Strlen(VAddr string, u64, u64) {
+    std::array<u8, CHUNK_SIZE> chunk;
+    u64 length = 0;
+    while (true) {
+        // Reads stop at page boundaries, as the pages after the terminator may not be mapped
+        const VAddr address = string + length;
+        const std::size_t chunk_size = CHUNK_SIZE - (address & Memory::PAGE_MASK);
+        Memory::ReadBlock(address, chunk.data(), chunk_size);
+        const auto terminator = std::find(chunk.begin(), chunk.begin() + chunk_size, u8{0});
+        length += std::distance(chunk.begin(), terminator);
+        if (terminator != chunk.begin() + chunk_size) {
+            return length;
+        }
+    }
+}
+
+struct FunctionDef {
+    const char* name;
+    /// Takes the first three argument registers and returns the result register
+    u64 (*func)(u64, u64, u64);
+};
+
+constexpr FunctionDef FUNCTIONS[] = {
+    {"memcpy", Memcpy}, {"memmove", Memmove}, {"memset", Memset},
+    {"memcmp", Memcmp}, {"strlen", Strlen},
+};
+
+constexpr u32 EncodeSVC(u32 immediate) {
+    return 0xD4000001 | (immediate << 5);
+}
+
+constexpr u32 RET = 0xD65F03C0;
+} // Anonymous namespace
+
+std::optional<ReplacementCode> GetReplacementCode(std::string_view name) {
+    const auto function = std::find_if(std::begin(FUNCTIONS), std::end(FUNCTIONS),
+                                       [name](const FunctionDef& def) { return def.name == name; });
+    if (function == std::end(FUNCTIONS)) {
+        return std::nullopt;
+    }
+    const u32 index = static_cast<u32>(std::distance(std::begin(FUNCTIONS), function));
+    return ReplacementCode{EncodeSVC(SVC_BASE + index), RET};
+}
+
+bool IsReplacementSVC(u32 immediate) {
+    return immediate >= SVC_BASE && immediate - SVC_BASE < std::size(FUNCTIONS);
+}
+
+MICROPROFILE_DEFINE(HLE_FunctionReplacement, "HLE", "Replaced Functions", MP_RGB(70, 150, 200));
+
+void CallReplacement(u32 immediate) {
+    MICROPROFILE_SCOPE(HLE_FunctionReplacement);
+    ASSERT(IsReplacementSVC(immediate));
+
+    Core::ARM_Interface& cpu = Core::CurrentArmInterface();
+    const FunctionDef& function = FUNCTIONS[immediate - SVC_BASE];
+    LOG_TRACE(Kernel_SVC, "{}(0x{:X}, 0x{:X}, 0x{:X})", function.name, cpu.GetReg(0),
+              cpu.GetReg(1), cpu.GetReg(2));
+    cpu.SetReg(0, function.func(cpu.GetReg(0), cpu.GetReg(1), cpu.GetReg(2)));
+}
+
+} // namespace HLE::FunctionReplacement
@@ -0,0 +1,36 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <optional>
+#include <string_view>
+#include "common/common_types.h"
+
+/**
+ * Replaces hot guest library functions with host implementations when
+ * Settings::values.use_hle_libc is set. The loaders overwrite the entry of each replaced function
+ * with an SVC and a return, so the JIT leaves the guest code once per call instead of running the
+ * byte loops of the guest libc. The host implementations access guest memory through the block
+ * functions of Memory, which keep the rasterizer caches coherent like guest accesses do.
+ */
+namespace HLE::FunctionReplacement {
+
+/// SVC immediates at or above this one call a replaced function, the kernel only uses 0x0-0x7F
+constexpr u32 SVC_BASE = 0xF000;
+
+/// Code written over the entry of a replaced function
+using ReplacementCode = std::array<u32, 2>;
+
+/// Returns the code that replaces the function with the given symbol, if it's replaced
+std::optional<ReplacementCode> GetReplacementCode(std::string_view name);
+
+/// Returns whether the SVC immediate calls a replaced function
+bool IsReplacementSVC(u32 immediate);
+
+/// Runs the host implementation of a replaced function on the registers of the current core
+void CallReplacement(u32 immediate);
+
+} // namespace HLE::FunctionReplacement
@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <vector>
+#include <boost/container/small_vector.hpp>
 
 #include "common/assert.h"
 #include "common/common_types.h"
@@ -24,6 +25,8 @@ namespace AddressArbiter {
 static ResultCode WaitForAddress(VAddr address, s64 timeout) {
     SharedPtr<Thread> current_thread = GetCurrentThread();
     current_thread->arb_wait_address = address;
+    current_thread->owner_process->arbiter_waiting_threads[address].push_back(
+        current_thread.get());
     current_thread->status = ThreadStatus::WaitArb;
     current_thread->wakeup_callback = nullptr;
 
@@ -33,38 +36,41 @@ static ResultCode WaitForAddress(VAddr address, s64 timeout) {
     return RESULT_TIMEOUT;
 }
 
-// Gets the threads waiting on an address.
-static std::vector<SharedPtr<Thread>> GetThreadsWaitingOnAddress(VAddr address) {
-    const auto RetrieveWaitingThreads = [](std::size_t core_index,
-                                           std::vector<SharedPtr<Thread>>& waiting_threads,
-                                           VAddr arb_addr) {
-        const auto& scheduler = Core::System::GetInstance().Scheduler(core_index);
-        auto& thread_list = scheduler->GetThreadList();
-
-        for (auto& thread : thread_list) {
-            if (thread->arb_wait_address == arb_addr)
-                waiting_threads.push_back(thread);
-        }
-    };
-
-    // Retrieve all threads that are waiting for this address.
-    std::vector<SharedPtr<Thread>> threads;
-    RetrieveWaitingThreads(0, threads, address);
-    RetrieveWaitingThreads(1, threads, address);
-    RetrieveWaitingThreads(2, threads, address);
-    RetrieveWaitingThreads(3, threads, address);
+// The schedulers keep the threads alive, so plain pointers avoid reference count updates
+using WaitingThreads = boost::container::small_vector<Thread*, 16>;
 
-    // Sort them by priority, such that the highest priority ones come first.
-    std::sort(threads.begin(), threads.end(),
-              [](const SharedPtr<Thread>& lhs, const SharedPtr<Thread>& rhs) {
-                  return lhs->current_priority < rhs->current_priority;
-              });
+// Gets the threads waiting on an address.
+static WaitingThreads GetThreadsWaitingOnAddress(VAddr address) {
+    const auto& waiting_threads = Core::CurrentProcess()->arbiter_waiting_threads;
+    const auto iter = waiting_threads.find(address);
+    if (iter == waiting_threads.end())
+        return {};
+
+    // Sort them by priority, such that the highest priority ones come first. Priorities may have
+    // changed while waiting, so this is done here rather than when the threads start waiting.
+    WaitingThreads threads(iter->second.begin(), iter->second.end());
+    std::stable_sort(threads.begin(), threads.end(), [](const Thread* lhs, const Thread* rhs) {
+        return lhs->current_priority < rhs->current_priority;
+    });
 
     return threads;
 }
 
+void RemoveWaitingThread(Thread* thread) {
+    auto& waiting_threads = thread->owner_process->arbiter_waiting_threads;
+    const auto iter = waiting_threads.find(thread->arb_wait_address);
+    thread->arb_wait_address = 0;
+    if (iter == waiting_threads.end())
+        return;
+
+    auto& threads = iter->second;
+    threads.erase(std::find(threads.begin(), threads.end(), thread));
+    if (threads.empty())
+        waiting_threads.erase(iter);
+}
+
 // Wake up num_to_wake (or all) threads in a vector.
-static void WakeThreads(std::vector<SharedPtr<Thread>>& waiting_threads, s32 num_to_wake) {
+static void WakeThreads(const WaitingThreads& waiting_threads, s32 num_to_wake) {
     // Only process up to 'target' threads, unless 'target' is <= 0, in which case process
     // them all.
     std::size_t last = waiting_threads.size();
@@ -75,14 +81,14 @@ static void WakeThreads(std::vector<SharedPtr<Thread>>& waiting_threads, s32 num
     for (std::size_t i = 0; i < last; i++) {
         ASSERT(waiting_threads[i]->status == ThreadStatus::WaitArb);
         waiting_threads[i]->SetWaitSynchronizationResult(RESULT_SUCCESS);
-        waiting_threads[i]->arb_wait_address = 0;
+        RemoveWaitingThread(waiting_threads[i]);
         waiting_threads[i]->ResumeFromWait();
     }
 }
 
 // Signals an address being waited on.
 ResultCode SignalToAddress(VAddr address, s32 num_to_wake) {
-    std::vector<SharedPtr<Thread>> waiting_threads = GetThreadsWaitingOnAddress(address);
+    const WaitingThreads waiting_threads = GetThreadsWaitingOnAddress(address);
 
     WakeThreads(waiting_threads, num_to_wake);
     return RESULT_SUCCESS;
@@ -114,7 +120,7 @@ ResultCode ModifyByWaitingCountAndSignalToAddressIfEqual(VAddr address, s32 valu
     }
 
     // Get threads waiting on the address.
-    std::vector<SharedPtr<Thread>> waiting_threads = GetThreadsWaitingOnAddress(address);
+    const WaitingThreads waiting_threads = GetThreadsWaitingOnAddress(address);
 
     // Determine the modified value depending on the waiting count.
     s32 updated_value;
@@ -10,6 +10,8 @@ union ResultCode;
 
 namespace Kernel {
 
+class Thread;
+
 namespace AddressArbiter {
 enum class ArbitrationType {
     WaitIfLessThan = 0,
@@ -29,6 +31,9 @@ ResultCode ModifyByWaitingCountAndSignalToAddressIfEqual(VAddr address, s32 valu
 
 ResultCode WaitForAddressIfLessThan(VAddr address, s32 value, s64 timeout, bool should_decrement);
 ResultCode WaitForAddressIfEqual(VAddr address, s32 value, s64 timeout);
+
+/// Removes a thread from the waiters of the address it is waiting on, e.g. when it times out.
+void RemoveWaitingThread(Thread* thread);
 } // namespace AddressArbiter
 
 } // namespace Kernel
@@ -22,11 +22,11 @@ ResultVal<Handle> HandleTable::Create(SharedPtr<Object> obj) {
     DEBUG_ASSERT(obj != nullptr);
 
     u16 slot = next_free_slot;
-    if (slot >= generations.size()) {
+    if (slot >= slots.size()) {
         LOG_ERROR(Kernel, "Unable to allocate Handle, too many slots in use.");
         return ERR_HANDLE_TABLE_FULL;
     }
-    next_free_slot = generations[slot];
+    next_free_slot = slots[slot].generation;
 
     u16 generation = next_generation++;
 
@@ -35,8 +35,9 @@ ResultVal<Handle> HandleTable::Create(SharedPtr<Object> obj) {
     if (next_generation >= (1 << 15))
         next_generation = 1;
 
-    generations[slot] = generation;
-    objects[slot] = std::move(obj);
+    slots[slot].generation = generation;
+    slots[slot].type = obj->GetHandleType();
+    slots[slot].object = std::move(obj);
 
     Handle handle = generation | (slot << 15);
     return MakeResult<Handle>(handle);
@@ -55,20 +56,17 @@ ResultCode HandleTable::Close(Handle handle) {
     if (!IsValid(handle))
         return ERR_INVALID_HANDLE;
 
-    u16 slot = GetSlot(handle);
+    const u32 slot = GetSlot(handle);
 
-    objects[slot] = nullptr;
+    slots[slot].object = nullptr;
 
-    generations[slot] = next_free_slot;
-    next_free_slot = slot;
+    slots[slot].generation = next_free_slot;
+    next_free_slot = static_cast<u16>(slot);
     return RESULT_SUCCESS;
 }
 
 bool HandleTable::IsValid(Handle handle) const {
-    std::size_t slot = GetSlot(handle);
-    u16 generation = GetGeneration(handle);
-
-    return slot < MAX_COUNT && objects[slot] != nullptr && generations[slot] == generation;
+    return FindSlot(handle) != nullptr;
 }
 
 SharedPtr<Object> HandleTable::GetGeneric(Handle handle) const {
@@ -78,16 +76,17 @@ SharedPtr<Object> HandleTable::GetGeneric(Handle handle) const {
         return Core::CurrentProcess();
     }
 
-    if (!IsValid(handle)) {
+    const Slot* const slot = FindSlot(handle);
+    if (slot == nullptr) {
         return nullptr;
     }
-    return objects[GetSlot(handle)];
+    return slot->object;
 }
 
 void HandleTable::Clear() {
     for (u16 i = 0; i < MAX_COUNT; ++i) {
-        generations[i] = i + 1;
-        objects[i] = nullptr;
+        slots[i].generation = i + 1;
+        slots[i].object = nullptr;
     }
     next_free_slot = 0;
 }
@@ -8,6 +8,7 @@
 #include <cstddef>
 #include "common/common_types.h"
 #include "core/hle/kernel/object.h"
+#include "core/hle/kernel/wait_object.h"
 #include "core/hle/result.h"
 
 namespace Kernel {
@@ -39,6 +40,10 @@ enum KernelHandle : Handle {
  * is destroyed, it is again pushed onto the list to be re-used by the next allocation. It is
  * likely that this allocation strategy differs from the one used in CTR-OS, but this hasn't been
  * verified and isn't likely to cause any problems.
+ *
+ * Each slot keeps the type of its object next to the object pointer and generation, so that typed
+ * lookups, which happen on nearly every SVC, only touch a single slot and compare its type tag
+ * without calling into the object.
  */
 class HandleTable final : NonCopyable {
 public:
@@ -82,7 +87,15 @@ public:
      */
     template <class T>
     SharedPtr<T> Get(Handle handle) const {
-        return DynamicObjectCast<T>(GetGeneric(handle));
+        if (handle == CurrentThread || handle == CurrentProcess) {
+            return DynamicObjectCast<T>(GetGeneric(handle));
+        }
+
+        const Slot* const slot = FindSlot(handle);
+        if (slot == nullptr || slot->type != T::HANDLE_TYPE) {
+            return nullptr;
+        }
+        return boost::static_pointer_cast<T>(slot->object);
     }
 
     /// Closes all handles held in this table.
@@ -95,21 +108,42 @@ private:
      */
     static const std::size_t MAX_COUNT = 4096;
 
-    static u16 GetSlot(Handle handle) {
+    struct Slot {
+        /// Stores the Object referenced by the handle or null if the slot is empty.
+        SharedPtr<Object> object;
+
+        /**
+         * The value of `next_generation` when the handle was created, used to check for validity.
+         * For empty slots, contains the index of the next free slot in the list.
+         */
+        u16 generation;
+
+        /// Type of the object, cached so that typed lookups don't have to ask the object.
+        HandleType type;
+    };
+
+    static u32 GetSlot(Handle handle) {
         return handle >> 15;
     }
     static u16 GetGeneration(Handle handle) {
         return handle & 0x7FFF;
     }
 
-    /// Stores the Object referenced by the handle or null if the slot is empty.
-    std::array<SharedPtr<Object>, MAX_COUNT> objects;
+    /// Returns the slot the handle refers to, or null if the handle is not valid.
+    const Slot* FindSlot(Handle handle) const {
+        const u32 index = GetSlot(handle);
+        if (index >= MAX_COUNT) {
+            return nullptr;
+        }
+
+        const Slot& slot = slots[index];
+        if (slot.object == nullptr || slot.generation != GetGeneration(handle)) {
+            return nullptr;
+        }
+        return &slot;
+    }
 
-    /**
-     * The value of `next_generation` when the handle was created, used to check for validity. For
-     * empty slots, contains the index of the next free slot in the list.
-     */
-    std::array<u16, MAX_COUNT> generations;
+    std::array<Slot, MAX_COUNT> slots;
 
     /**
      * Global counter of the number of created handles. Stored in `generations` when a handle is
@@ -121,4 +155,10 @@ private:
     u16 next_free_slot;
 };
 
+// WaitObject covers several handle types, so those lookups ask the object whether it's waitable.
+template <>
+inline SharedPtr<WaitObject> HandleTable::Get<WaitObject>(Handle handle) const {
+    return DynamicObjectCast<WaitObject>(GetGeneric(handle));
+}
+
 } // namespace Kernel
@@ -70,6 +70,13 @@ SharedPtr<Event> HLERequestContext::SleepClientThread(SharedPtr<Thread> thread,
     return event;
 }
 
+void HLERequestContext::RunAsync(SharedPtr<Thread> thread, const std::string& reason,
+                                 std::function<void()>&& work, WakeupCallback&& callback) {
+    auto& kernel = Core::System::GetInstance().Kernel();
+    auto event = SleepClientThread(std::move(thread), reason, 0, std::move(callback));
+    kernel.RunAsyncRequest(std::move(event), std::move(work));
+}
+
 HLERequestContext::HLERequestContext(SharedPtr<Kernel::ServerSession> server_session)
     : server_session(std::move(server_session)) {
     cmd_buf[0] = 0;
@@ -212,6 +219,20 @@ ResultCode HLERequestContext::WriteToOutgoingCommandBuffer(const Thread& thread)
     Memory::ReadBlock(*thread.owner_process, thread.GetTLSAddress(), dst_cmdbuf.data(),
                       dst_cmdbuf.size() * sizeof(u32));
 
+    auto& handle_table = Core::System::GetInstance().Kernel().HandleTable();
+    const ResultCode result =
+        WriteToOutgoingCommandBuffer(dst_cmdbuf.data(), *thread.owner_process, handle_table);
+
+    // Copy the translated command buffer back into the thread's command buffer area.
+    Memory::WriteBlock(*thread.owner_process, thread.GetTLSAddress(), dst_cmdbuf.data(),
+                       dst_cmdbuf.size() * sizeof(u32));
+
+    return result;
+}
+
+ResultCode HLERequestContext::WriteToOutgoingCommandBuffer(u32_le* dst_cmdbuf,
+                                                           Process& dst_process,
+                                                           HandleTable& dst_table) {
     // The header was already built in the internal command buffer. Attempt to parse it to verify
     // the integrity and then copy it over to the target command buffer.
     ParseCommandBuffer(cmd_buf.data(), false);
@@ -222,7 +243,7 @@ ResultCode HLERequestContext::WriteToOutgoingCommandBuffer(const Thread& thread)
     if (domain_message_header)
         size -= sizeof(IPC::DomainMessageHeader) / sizeof(u32);
 
-    std::copy_n(cmd_buf.begin(), size, dst_cmdbuf.data());
+    std::copy_n(cmd_buf.begin(), size, dst_cmdbuf);
 
     if (command_header->enable_handle_descriptor) {
         ASSERT_MSG(!move_objects.empty() || !copy_objects.empty(),
@@ -236,19 +257,17 @@ ResultCode HLERequestContext::WriteToOutgoingCommandBuffer(const Thread& thread)
         ASSERT(copy_objects.size() == handle_descriptor_header->num_handles_to_copy);
         ASSERT(move_objects.size() == handle_descriptor_header->num_handles_to_move);
 
-        auto& handle_table = Core::System::GetInstance().Kernel().HandleTable();
-
         // We don't make a distinction between copy and move handles when translating since HLE
         // services don't deal with handles directly. However, the guest applications might check
         // for specific values in each of these descriptors.
         for (auto& object : copy_objects) {
             ASSERT(object != nullptr);
-            dst_cmdbuf[current_offset++] = handle_table.Create(object).Unwrap();
+            dst_cmdbuf[current_offset++] = dst_table.Create(object).Unwrap();
         }
 
         for (auto& object : move_objects) {
             ASSERT(object != nullptr);
-            dst_cmdbuf[current_offset++] = handle_table.Create(object).Unwrap();
+            dst_cmdbuf[current_offset++] = dst_table.Create(object).Unwrap();
         }
     }
 
@@ -267,10 +286,6 @@ ResultCode HLERequestContext::WriteToOutgoingCommandBuffer(const Thread& thread)
         }
     }
 
-    // Copy the translated command buffer back into the thread's command buffer area.
-    Memory::WriteBlock(*thread.owner_process, thread.GetTLSAddress(), dst_cmdbuf.data(),
-                       dst_cmdbuf.size() * sizeof(u32));
-
     return RESULT_SUCCESS;
 }
 
@@ -315,6 +330,24 @@ std::size_t HLERequestContext::WriteBuffer(const void* buffer, std::size_t size,
     return size;
 }
 
+const u8* HLERequestContext::GetReadBufferPointer(int buffer_index) const {
+    const bool is_buffer_a{BufferDescriptorA().size() && BufferDescriptorA()[buffer_index].Size()};
+    const VAddr address{is_buffer_a ? BufferDescriptorA()[buffer_index].Address()
+                                    : BufferDescriptorX()[buffer_index].Address()};
+    return Memory::GetContiguousPointer(address, GetReadBufferSize(buffer_index));
+}
+
+u8* HLERequestContext::GetWriteBufferPointer(int buffer_index) const {
+    return Memory::GetContiguousPointer(GetWriteBufferAddress(buffer_index),
+                                        GetWriteBufferSize(buffer_index));
+}
+
+VAddr HLERequestContext::GetWriteBufferAddress(int buffer_index) const {
+    const bool is_buffer_b{BufferDescriptorB().size() && BufferDescriptorB()[buffer_index].Size()};
+    return is_buffer_b ? BufferDescriptorB()[buffer_index].Address()
+                       : BufferDescriptorC()[buffer_index].Address();
+}
+
 std::size_t HLERequestContext::GetReadBufferSize(int buffer_index) const {
     const bool is_buffer_a{BufferDescriptorA().size() && BufferDescriptorA()[buffer_index].Size()};
     return is_buffer_a ? BufferDescriptorA()[buffer_index].Size()
@@ -126,6 +126,21 @@ public:
                                        u64 timeout, WakeupCallback&& callback,
                                        Kernel::SharedPtr<Kernel::Event> event = nullptr);
 
+    /**
+     * Puts the specified guest thread to sleep while the given work runs on a host thread, so that
+     * the emulated core can run other guest threads in the meantime.
+     * @param thread Thread to be put to sleep.
+     * @param reason Reason for pausing the thread, to be used for debugging purposes.
+     * @param work Work to run on the host thread. It must not access guest memory, the request
+     * context or kernel objects, and it must not share state with the other requests of the
+     * service that are handled synchronously.
+     * @param callback Callback to be invoked on the emulated core when the thread is resumed after
+     * the work has finished. It has the same requirements as the one of SleepClientThread, and is
+     * where the results of the work are written back to the guest.
+     */
+    void RunAsync(SharedPtr<Thread> thread, const std::string& reason, std::function<void()>&& work,
+                  WakeupCallback&& callback);
+
     void ParseCommandBuffer(u32_le* src_cmdbuf, bool incoming);
 
     /// Populates this context with data from the requesting process/thread.
@@ -133,6 +148,9 @@ public:
                                                  HandleTable& src_table);
     /// Writes data from this context back to the requesting process/thread.
     ResultCode WriteToOutgoingCommandBuffer(const Thread& thread);
+    /// Writes data from this context to a command buffer of the requesting process.
+    ResultCode WriteToOutgoingCommandBuffer(u32_le* dst_cmdbuf, Process& dst_process,
+                                            HandleTable& dst_table);
 
     u32_le GetCommand() const {
         return command;
@@ -192,6 +210,23 @@ public:
                            buffer_index);
     }
 
+    /**
+     * Helper function to get a host view of the input buffer, avoiding the copy made by
+     * ReadBuffer. The view covers GetReadBufferSize() bytes.
+     * @returns nullptr if the buffer isn't contiguous host memory, ReadBuffer must be used then
+     */
+    const u8* GetReadBufferPointer(int buffer_index = 0) const;
+
+    /**
+     * Helper function to get a host view of the output buffer, so that it can be filled in place
+     * instead of through WriteBuffer. The view covers GetWriteBufferSize() bytes.
+     * @returns nullptr if the buffer isn't contiguous host memory, WriteBuffer must be used then
+     */
+    u8* GetWriteBufferPointer(int buffer_index = 0) const;
+
+    /// Helper function to get the guest address of the output buffer
+    VAddr GetWriteBufferAddress(int buffer_index = 0) const;
+
     /// Helper function to get the size of the input buffer
     std::size_t GetReadBufferSize(int buffer_index = 0) const;
 
@@ -4,16 +4,22 @@
 
 #include <array>
 #include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <memory>
 #include <mutex>
+#include <thread>
 #include <utility>
 
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "common/thread.h"
 
 #include "core/core.h"
 #include "core/core_timing.h"
+#include "core/hle/kernel/address_arbiter.h"
 #include "core/hle/kernel/client_port.h"
+#include "core/hle/kernel/event.h"
 #include "core/hle/kernel/handle_table.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/process.h"
@@ -44,6 +50,9 @@ static void ThreadWakeupCallback(u64 thread_handle, [[maybe_unused]] int cycles_
         return;
     }
 
+    // The wakeup event has fired, so there is nothing left to cancel
+    thread->wakeup_event_handle = CoreTiming::INVALID_EVENT_HANDLE;
+
     bool resume = true;
 
     if (thread->status == ThreadStatus::WaitSynchAny ||
@@ -79,7 +88,7 @@ static void ThreadWakeupCallback(u64 thread_handle, [[maybe_unused]] int cycles_
 
     if (thread->arb_wait_address != 0) {
         ASSERT(thread->status == ThreadStatus::WaitArb);
-        thread->arb_wait_address = 0;
+        AddressArbiter::RemoveWaitingThread(thread.get());
     }
 
     if (resume) {
@@ -101,6 +110,66 @@ static void TimerCallback(u64 timer_handle, int cycles_late) {
     timer->Signal(cycles_late);
 }
 
+/// Host thread that runs the work of asynchronous HLE requests in submission order
+class AsyncRequestWorker {
+public:
+    explicit AsyncRequestWorker(const CoreTiming::EventType* completion_event_type)
+        : completion_event_type{completion_event_type}, thread{&AsyncRequestWorker::Run, this} {}
+
+    /// Stops the worker once the work item being run finishes, dropping the queued ones
+    ~AsyncRequestWorker() {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            stop = true;
+        }
+        cv.notify_one();
+        thread.join();
+    }
+
+    /// Queues work, scheduling the completion event with the given handle once it has finished
+    void Submit(Handle event_handle, std::function<void()> work) {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            queue.push_back({event_handle, std::move(work)});
+        }
+        cv.notify_one();
+    }
+
+private:
+    struct Request {
+        Handle event_handle;
+        std::function<void()> work;
+    };
+
+    void Run() {
+        Common::SetCurrentThreadName("yuzu:HLEAsync");
+        while (true) {
+            Request request;
+            {
+                std::unique_lock<std::mutex> lock{mutex};
+                cv.wait(lock, [this] { return stop || !queue.empty(); });
+                if (stop) {
+                    return;
+                }
+                request = std::move(queue.front());
+                queue.pop_front();
+            }
+
+            request.work();
+            CoreTiming::ScheduleEventThreadsafe(0, completion_event_type, request.event_handle);
+        }
+    }
+
+    const CoreTiming::EventType* completion_event_type;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<Request> queue;
+    bool stop = false;
+
+    std::thread thread;
+};
+
 struct KernelCore::Impl {
     void Initialize(KernelCore& kernel) {
         Shutdown();
@@ -108,9 +177,15 @@ struct KernelCore::Impl {
         InitializeResourceLimits(kernel);
         InitializeThreads();
         InitializeTimers();
+        InitializeAsyncRequests();
     }
 
     void Shutdown() {
+        // Stop the worker first, its queued work may refer to the objects released below
+        async_request_worker.reset();
+        async_request_handle_table.Clear();
+        async_request_event_type = nullptr;
+
         next_object_id = 0;
         next_process_id = 10;
         next_thread_id = 1;
@@ -199,6 +274,29 @@ struct KernelCore::Impl {
         timer_callback_event_type = CoreTiming::RegisterEvent("TimerCallback", TimerCallback);
     }
 
+    void InitializeAsyncRequests() {
+        async_request_handle_table.Clear();
+        async_request_event_type =
+            CoreTiming::RegisterEvent("AsyncRequestCallback", [this](u64 event_handle, int) {
+                SignalAsyncRequest(static_cast<Handle>(event_handle));
+            });
+        async_request_worker = std::make_unique<AsyncRequestWorker>(async_request_event_type);
+    }
+
+    /// Signals the event of an asynchronous request whose work has finished
+    void SignalAsyncRequest(Handle event_handle) {
+        // Lock the global kernel mutex when we enter the kernel HLE.
+        std::lock_guard<std::recursive_mutex> lock(HLE::g_hle_lock);
+
+        const SharedPtr<Event> event = async_request_handle_table.Get<Event>(event_handle);
+        if (event == nullptr) {
+            LOG_CRITICAL(Kernel, "Callback fired for invalid async request {:08X}", event_handle);
+            return;
+        }
+        async_request_handle_table.Close(event_handle);
+        event->Signal();
+    }
+
     std::atomic<u32> next_object_id{0};
     // TODO(Subv): Start the process ids from 10 for now, as lower PIDs are
     // reserved for low-level services
@@ -223,6 +321,13 @@ struct KernelCore::Impl {
     // allowing us to simply use a pool index or similar.
     Kernel::HandleTable thread_wakeup_callback_handle_table;
 
+    /// The event type signaling the completion of asynchronous HLE requests
+    CoreTiming::EventType* async_request_event_type = nullptr;
+    /// Holds the events of the asynchronous requests until their work has finished, the worker
+    /// only refers to them by handle as it can't touch kernel objects from its host thread.
+    Kernel::HandleTable async_request_handle_table;
+    std::unique_ptr<AsyncRequestWorker> async_request_worker;
+
     /// Map of named ports managed by the kernel, which can be retrieved using
     /// the ConnectToPort SVC.
     NamedPortTable named_ports;
@@ -295,6 +400,21 @@ bool KernelCore::IsValidNamedPort(NamedPortTable::const_iterator port) const {
     return port != impl->named_ports.cend();
 }
 
+void KernelCore::RunAsyncRequest(SharedPtr<Event> event, std::function<void()> work) {
+    impl->async_request_worker->Submit(CreateThreadsafeEventHandle(std::move(event)),
+                                       std::move(work));
+}
+
+Handle KernelCore::CreateThreadsafeEventHandle(SharedPtr<Event> event) {
+    const ResultVal<Handle> event_handle = impl->async_request_handle_table.Create(event);
+    ASSERT_MSG(event_handle.Succeeded(), "Too many pending async requests");
+    return *event_handle;
+}
+
+void KernelCore::SignalEventThreadsafe(Handle event_handle) {
+    CoreTiming::ScheduleEventThreadsafe(0, impl->async_request_event_type, event_handle);
+}
+
 u32 KernelCore::CreateNewObjectID() {
     return impl->next_object_id++;
 }
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <functional>
 #include <string>
 #include <unordered_map>
 #include "core/hle/kernel/object.h"
@@ -18,6 +19,7 @@ struct EventType;
 namespace Kernel {
 
 class ClientPort;
+class Event;
 class HandleTable;
 class Process;
 class ResourceLimit;
@@ -86,6 +88,24 @@ public:
     /// Determines whether or not the given port is a valid named port.
     bool IsValidNamedPort(NamedPortTable::const_iterator port) const;
 
+    /**
+     * Runs the given work on the host thread that serves asynchronous HLE requests, then signals
+     * the given event on the emulated core once the work has finished. Work items run one at a
+     * time in submission order, so they don't need to synchronize with each other.
+     */
+    void RunAsyncRequest(SharedPtr<Event> event, std::function<void()> work);
+
+    /**
+     * Registers an event so that a host thread can signal it with SignalEventThreadsafe. Host
+     * threads can't touch kernel objects, so they refer to the event by the returned handle, which
+     * is released once the event has been signaled.
+     */
+    Handle CreateThreadsafeEventHandle(SharedPtr<Event> event);
+
+    /// Signals an event registered with CreateThreadsafeEventHandle on the emulated core. This can
+    /// be called from any thread.
+    void SignalEventThreadsafe(Handle event_handle);
+
 private:
     friend class Object;
     friend class Process;
@@ -24,10 +24,10 @@ namespace Kernel {
 static std::pair<SharedPtr<Thread>, u32> GetHighestPriorityMutexWaitingThread(
     const SharedPtr<Thread>& current_thread, VAddr mutex_addr) {
 
-    SharedPtr<Thread> highest_priority_thread;
+    Thread* highest_priority_thread = nullptr;
     u32 num_waiters = 0;
 
-    for (auto& thread : current_thread->wait_mutex_threads) {
+    for (const auto& thread : current_thread->wait_mutex_threads) {
         if (thread->mutex_wait_address != mutex_addr)
             continue;
 
@@ -36,7 +36,7 @@ static std::pair<SharedPtr<Thread>, u32> GetHighestPriorityMutexWaitingThread(
         ++num_waiters;
         if (highest_priority_thread == nullptr ||
             thread->GetPriority() < highest_priority_thread->GetPriority()) {
-            highest_priority_thread = thread;
+            highest_priority_thread = thread.get();
         }
     }
 
@@ -46,10 +46,15 @@ static std::pair<SharedPtr<Thread>, u32> GetHighestPriorityMutexWaitingThread(
 /// Update the mutex owner field of all threads waiting on the mutex to point to the new owner.
 static void TransferMutexOwnership(VAddr mutex_addr, SharedPtr<Thread> current_thread,
                                    SharedPtr<Thread> new_owner) {
-    auto threads = current_thread->wait_mutex_threads;
-    for (auto& thread : threads) {
-        if (thread->mutex_wait_address != mutex_addr)
+    // Walk the list in place rather than iterating over a copy of it, removing a waiter erases
+    // it from the list so the next one takes its index.
+    auto& threads = current_thread->wait_mutex_threads;
+    for (std::size_t index = 0; index < threads.size();) {
+        SharedPtr<Thread> thread = threads[index];
+        if (thread->mutex_wait_address != mutex_addr) {
+            ++index;
             continue;
+        }
 
         ASSERT(thread->lock_owner == current_thread);
         current_thread->RemoveMutexWaiter(thread);
@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <memory>
 #include "common/assert.h"
+#include "common/bit_set.h"
 #include "common/common_funcs.h"
 #include "common/logging/log.h"
 #include "core/hle/kernel/errors.h"
@@ -118,7 +119,7 @@ void Process::Run(VAddr entry_point, s32 main_thread_priority, u32 stack_size) {
     // of the user address space.
     vm_manager
         .MapMemoryBlock(Memory::STACK_AREA_VADDR_END - stack_size,
-                        std::make_shared<std::vector<u8>>(stack_size, 0), 0, stack_size,
+                        std::make_shared<Common::DemandZeroBuffer>(stack_size), 0, stack_size,
                         MemoryState::Mapped)
         .Unwrap();
 
@@ -152,7 +153,7 @@ ResultVal<VAddr> Process::HeapAllocate(VAddr target, u64 size, VMAPermission per
 
     if (heap_memory == nullptr) {
         // Initialize heap
-        heap_memory = std::make_shared<std::vector<u8>>();
+        heap_memory = std::make_shared<Common::DemandZeroBuffer>();
         heap_start = heap_end = target;
     } else {
         vm_manager.UnmapRange(heap_start, heap_end - heap_start);
@@ -165,7 +166,7 @@ ResultVal<VAddr> Process::HeapAllocate(VAddr target, u64 size, VMAPermission per
         vm_manager.RefreshMemoryBlockMappings(heap_memory.get());
     }
     if (target + size > heap_end) {
-        heap_memory->insert(end(*heap_memory), (target + size) - heap_end, 0);
+        heap_memory->resize(heap_memory->size() + ((target + size) - heap_end));
         heap_end = target + size;
         vm_manager.RefreshMemoryBlockMappings(heap_memory.get());
     }
@@ -210,7 +211,7 @@ ResultCode Process::MirrorMemory(VAddr dst_addr, VAddr src_addr, u64 size) {
     ASSERT_MSG(vma_offset + size <= vma->second.size,
                "Shared memory exceeds bounds of mapped block");
 
-    const std::shared_ptr<std::vector<u8>>& backing_block = vma->second.backing_block;
+    const std::shared_ptr<Common::DemandZeroBuffer>& backing_block = vma->second.backing_block;
     std::size_t backing_block_offset = vma->second.offset + vma_offset;
 
     CASCADE_RESULT(auto new_vma,
@@ -229,6 +230,54 @@ ResultCode Process::UnmapMemory(VAddr dst_addr, VAddr /*src_addr*/, u64 size) {
 }
 
 Kernel::Process::Process(KernelCore& kernel) : Object{kernel} {}
+VAddr Process::MarkNextAvailableTLSSlotAsUsed() {
+    while (tls_free_pages_hint < tls_free_pages.size() &&
+           tls_free_pages[tls_free_pages_hint] == 0) {
+        ++tls_free_pages_hint;
+    }
+
+    std::size_t page;
+    if (tls_free_pages_hint == tls_free_pages.size()) {
+        page = MapTLSPage();
+    } else {
+        page = tls_free_pages_hint * 64 +
+               Common::LeastSignificantSetBit(tls_free_pages[tls_free_pages_hint]);
+    }
+
+    const std::size_t slot = Common::LeastSignificantSetBit(static_cast<u8>(~tls_slots[page]));
+    tls_slots[page] |= static_cast<u8>(1U << slot);
+    if (tls_slots[page] == 0xFF) {
+        tls_free_pages[page / 64] &= ~(1ULL << (page % 64));
+    }
+
+    return Memory::TLS_AREA_VADDR + page * Memory::PAGE_SIZE + slot * Memory::TLS_ENTRY_SIZE;
+}
+
+void Process::FreeTLSSlot(VAddr tls_address) {
+    const VAddr offset = tls_address - Memory::TLS_AREA_VADDR;
+    const std::size_t page = offset / Memory::PAGE_SIZE;
+    const std::size_t slot = (offset % Memory::PAGE_SIZE) / Memory::TLS_ENTRY_SIZE;
+
+    tls_slots[page] &= static_cast<u8>(~(1U << slot));
+    tls_free_pages[page / 64] |= 1ULL << (page % 64);
+    tls_free_pages_hint = std::min(tls_free_pages_hint, page / 64);
+}
+
+std::size_t Process::MapTLSPage() {
+    const std::size_t page = tls_slots.size();
+    tls_slots.push_back(0); // The page is completely available at the start
+    if (page % 64 == 0) {
+        tls_free_pages.push_back(0);
+    }
+    tls_free_pages[page / 64] |= 1ULL << (page % 64);
+    tls_free_pages_hint = std::min(tls_free_pages_hint, page / 64);
+
+    const auto memory = std::make_shared<Common::DemandZeroBuffer>(Memory::PAGE_SIZE);
+    vm_manager.MapMemoryBlock(Memory::TLS_AREA_VADDR + page * Memory::PAGE_SIZE, memory, 0,
+                              Memory::PAGE_SIZE, MemoryState::ThreadLocal);
+    return page;
+}
+
 Kernel::Process::~Process() {}
 
 } // namespace Kernel
@@ -9,6 +9,7 @@
 #include <cstddef>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <boost/container/static_vector.hpp>
 #include "common/bit_field.h"
@@ -102,7 +103,7 @@ struct CodeSet final : public Object {
         return segments[2];
     }
 
-    std::shared_ptr<std::vector<u8>> memory;
+    std::shared_ptr<Common::DemandZeroBuffer> memory;
 
     std::array<Segment, 3> segments;
     VAddr entrypoint;
@@ -182,19 +183,16 @@ public:
     // the entire virtual address space extents that bound the allocations, including any holes.
     // This makes deallocation and reallocation of holes fast and keeps process memory contiguous
     // in the emulator address space, allowing Memory::GetPointer to be reasonably safe.
-    std::shared_ptr<std::vector<u8>> heap_memory;
+    std::shared_ptr<Common::DemandZeroBuffer> heap_memory;
 
     // The left/right bounds of the address space covered by heap_memory.
     VAddr heap_start = 0;
     VAddr heap_end = 0;
     u64 heap_used = 0;
 
-    /// The Thread Local Storage area is allocated as processes create threads,
-    /// each TLS area is 0x200 bytes, so one page (0x1000) is split up in 8 parts, and each part
-    /// holds the TLS for a specific thread. This vector contains which parts are in use for each
-    /// page as a bitmask.
-    /// This vector will grow as more pages are allocated for new threads.
-    std::vector<std::bitset<8>> tls_slots;
+    /// Threads waiting on an address arbiter, grouped by address in the order they started
+    /// waiting. The schedulers keep the threads alive, and stopping a thread removes it.
+    std::unordered_map<VAddr, std::vector<Thread*>> arbiter_waiting_threads;
 
     std::string name;
 
@@ -205,9 +203,35 @@ public:
 
     ResultCode UnmapMemory(VAddr dst_addr, VAddr src_addr, u64 size);
 
+    /**
+     * Marks the first free Thread Local Storage slot as used, mapping a new TLS page when all the
+     * mapped ones are full.
+     * @returns The address of the slot
+     */
+    VAddr MarkNextAvailableTLSSlotAsUsed();
+
+    /// Marks the TLS slot at the given address as free, its page stays mapped for the next threads
+    void FreeTLSSlot(VAddr tls_address);
+
 private:
     explicit Process(KernelCore& kernel);
     ~Process() override;
+
+    /// Maps a new page at the end of the TLS area, returns its index
+    std::size_t MapTLSPage();
+
+    /// The Thread Local Storage area is allocated as processes create threads, each TLS area is
+    /// 0x200 bytes, so one page (0x1000) is split up in 8 slots, and each slot holds the TLS for
+    /// a specific thread. This vector contains which slots are in use for each page as a bitmask.
+    /// Pages are never unmapped, so it only grows when more threads are alive than ever before.
+    std::vector<u8> tls_slots;
+
+    /// One bit for each page of tls_slots, set while the page has a free slot
+    std::vector<u64> tls_free_pages;
+
+    /// Index of the first word of tls_free_pages which may have a bit set, the words below it are
+    /// all zero
+    std::size_t tls_free_pages_hint = 0;
 };
 
 } // namespace Kernel
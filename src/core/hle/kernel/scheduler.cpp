@@ -12,11 +12,11 @@
 #include "core/core_timing.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/scheduler.h"
+#include "core/hle/kernel/svc_profiler.h"
+#include "core/settings.h"
 
 namespace Kernel {
 
-std::mutex Scheduler::scheduler_mutex;
-
 Scheduler::Scheduler(Core::ARM_Interface* cpu_core) : cpu_core(cpu_core) {}
 
 Scheduler::~Scheduler() {
@@ -86,6 +86,10 @@ void Scheduler::SwitchContext(Thread* new_thread) {
         ready_queue.remove(new_thread->current_priority, new_thread);
         new_thread->status = ThreadStatus::Running;
 
+        if (Settings::values.profile_svcs) {
+            SVCProfiler::RecordResume(*new_thread);
+        }
+
         if (previous_process != current_thread->owner_process) {
             Core::CurrentProcess() = current_thread->owner_process;
             SetCurrentPageTable(&Core::CurrentProcess()->vm_manager.page_table);
@@ -123,7 +127,6 @@ void Scheduler::AddThread(SharedPtr<Thread> thread, u32 priority) {
     std::lock_guard<std::mutex> lock(scheduler_mutex);
 
     thread_list.push_back(std::move(thread));
-    ready_queue.prepare(priority);
 }
 
 void Scheduler::RemoveThread(Thread* thread) {
@@ -153,8 +156,6 @@ void Scheduler::SetThreadPriority(Thread* thread, u32 priority) {
     // If thread was ready, adjust queues
     if (thread->status == ThreadStatus::Ready)
         ready_queue.move(thread, thread->current_priority, priority);
-    else
-        ready_queue.prepare(priority);
 }
 
 } // namespace Kernel
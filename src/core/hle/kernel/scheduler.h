@@ -74,7 +74,9 @@ private:
 
     Core::ARM_Interface* cpu_core;
 
-    static std::mutex scheduler_mutex;
+    /// Guards the state of this core's scheduler. Threads migrating between cores take the lock
+    /// of each scheduler in turn, so cores checking for ready threads don't contend on one lock.
+    mutable std::mutex scheduler_mutex;
 };
 
 } // namespace Kernel
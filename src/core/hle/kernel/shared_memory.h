@@ -62,12 +62,10 @@ public:
      * block.
      * @param name Optional object name, used for debugging purposes.
      */
-    static SharedPtr<SharedMemory> CreateForApplet(KernelCore& kernel,
-                                                   std::shared_ptr<std::vector<u8>> heap_block,
-                                                   u32 offset, u32 size,
-                                                   MemoryPermission permissions,
-                                                   MemoryPermission other_permissions,
-                                                   std::string name = "Unknown Applet");
+    static SharedPtr<SharedMemory> CreateForApplet(
+        KernelCore& kernel, std::shared_ptr<Common::DemandZeroBuffer> heap_block, u32 offset,
+        u32 size, MemoryPermission permissions, MemoryPermission other_permissions,
+        std::string name = "Unknown Applet");
 
     std::string GetTypeName() const override {
         return "SharedMemory";
@@ -117,7 +115,7 @@ public:
     /// Address of shared memory block in the owner process if specified.
     VAddr base_address;
     /// Backing memory for this shared memory block.
-    std::shared_ptr<std::vector<u8>> backing_block;
+    std::shared_ptr<Common::DemandZeroBuffer> backing_block;
     /// Offset into the backing block for this shared memory.
     std::size_t backing_block_offset;
     /// Size of the memory block. Page-aligned.
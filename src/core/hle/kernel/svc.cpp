@@ -3,19 +3,24 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
+#include <chrono>
 #include <cinttypes>
 #include <iterator>
 #include <mutex>
 #include <vector>
+#include <boost/container/small_vector.hpp>
 
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "common/string_util.h"
+#include "common/tracing.h"
 #include "core/arm/exclusive_monitor.h"
 #include "core/core.h"
 #include "core/core_cpu.h"
 #include "core/core_timing.h"
+#include "core/hle/function_replacement.h"
 #include "core/hle/kernel/address_arbiter.h"
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/client_session.h"
@@ -28,11 +33,14 @@
 #include "core/hle/kernel/scheduler.h"
 #include "core/hle/kernel/shared_memory.h"
 #include "core/hle/kernel/svc.h"
+#include "core/hle/kernel/svc_profiler.h"
 #include "core/hle/kernel/svc_wrap.h"
 #include "core/hle/kernel/thread.h"
 #include "core/hle/lock.h"
 #include "core/hle/result.h"
 #include "core/hle/service/service.h"
+#include "core/perf_stats.h"
+#include "core/settings.h"
 
 namespace Kernel {
 namespace {
@@ -206,7 +214,7 @@ static ResultCode WaitSynchronization(Handle* index, VAddr handles_address, u64
     auto thread = GetCurrentThread();
 
     using ObjectPtr = SharedPtr<WaitObject>;
-    std::vector<ObjectPtr> objects(handle_count);
+    Thread::ThreadWaitObjects objects(handle_count);
     auto& kernel = Core::System::GetInstance().Kernel();
 
     for (u64 i = 0; i < handle_count; ++i) {
@@ -692,27 +700,28 @@ static ResultCode SignalProcessWideKey(VAddr condition_variable_addr, s32 target
     LOG_TRACE(Kernel_SVC, "called, condition_variable_addr=0x{:X}, target=0x{:08X}",
               condition_variable_addr, target);
 
-    auto RetrieveWaitingThreads = [](std::size_t core_index,
-                                     std::vector<SharedPtr<Thread>>& waiting_threads,
+    // The schedulers keep the threads alive, so plain pointers avoid reference count updates
+    using WaitingThreads = boost::container::small_vector<Thread*, 16>;
+    auto RetrieveWaitingThreads = [](std::size_t core_index, WaitingThreads& waiting_threads,
                                      VAddr condvar_addr) {
         const auto& scheduler = Core::System::GetInstance().Scheduler(core_index);
         auto& thread_list = scheduler->GetThreadList();
 
         for (auto& thread : thread_list) {
             if (thread->condvar_wait_address == condvar_addr)
-                waiting_threads.push_back(thread);
+                waiting_threads.push_back(thread.get());
         }
     };
 
     // Retrieve a list of all threads that are waiting for this condition variable.
-    std::vector<SharedPtr<Thread>> waiting_threads;
+    WaitingThreads waiting_threads;
     RetrieveWaitingThreads(0, waiting_threads, condition_variable_addr);
     RetrieveWaitingThreads(1, waiting_threads, condition_variable_addr);
     RetrieveWaitingThreads(2, waiting_threads, condition_variable_addr);
     RetrieveWaitingThreads(3, waiting_threads, condition_variable_addr);
     // Sort them by priority, such that the highest priority ones come first.
     std::sort(waiting_threads.begin(), waiting_threads.end(),
-              [](const SharedPtr<Thread>& lhs, const SharedPtr<Thread>& rhs) {
+              [](const Thread* lhs, const Thread* rhs) {
                   return lhs->current_priority < rhs->current_priority;
               });
 
@@ -727,7 +736,7 @@ static ResultCode SignalProcessWideKey(VAddr condition_variable_addr, s32 target
         return RESULT_SUCCESS;
 
     for (std::size_t index = 0; index < last; ++index) {
-        auto& thread = waiting_threads[index];
+        Thread* const thread = waiting_threads[index];
 
         ASSERT(thread->condvar_wait_address == condition_variable_addr);
 
@@ -1131,14 +1140,8 @@ static const FunctionDef* GetSVCInfo(u32 func_num) {
     return &SVC_Table[func_num];
 }
 
-MICROPROFILE_DEFINE(Kernel_SVC, "Kernel", "SVC", MP_RGB(70, 200, 70));
-
-void CallSVC(u32 immediate) {
-    MICROPROFILE_SCOPE(Kernel_SVC);
-
-    // Lock the global kernel mutex when we enter the kernel HLE.
-    std::lock_guard<std::recursive_mutex> lock(HLE::g_hle_lock);
-
+namespace {
+void DispatchSVC(u32 immediate) {
     const FunctionDef* info = GetSVCInfo(immediate);
     if (info) {
         if (info->func) {
@@ -1150,5 +1153,42 @@ void CallSVC(u32 immediate) {
         LOG_CRITICAL(Kernel_SVC, "Unknown SVC function 0x{:X}", immediate);
     }
 }
+} // Anonymous namespace
+
+MICROPROFILE_DEFINE(Kernel_SVC, "Kernel", "SVC", MP_RGB(70, 200, 70));
+
+void CallSVC(u32 immediate) {
+    // Replaced guest functions only access guest memory, like the code they replace
+    if (HLE::FunctionReplacement::IsReplacementSVC(immediate)) {
+        HLE::FunctionReplacement::CallReplacement(immediate);
+        return;
+    }
+
+    MICROPROFILE_SCOPE(Kernel_SVC);
+    YUZU_TRACE_ZONE("CallSVC");
+    const Core::ScopedStageTimer stage_timer{Core::System::GetInstance().GetPerfStats(),
+                                             Core::PerfStage::HLE};
+
+    if (!Settings::values.profile_svcs) {
+        // Lock the global kernel mutex when we enter the kernel HLE.
+        std::lock_guard<std::recursive_mutex> lock(HLE::g_hle_lock);
+        DispatchSVC(immediate);
+        return;
+    }
+
+    using Clock = std::chrono::steady_clock;
+    const auto wait_start = Clock::now();
+    std::lock_guard<std::recursive_mutex> lock(HLE::g_hle_lock);
+    const auto run_start = Clock::now();
+
+    // The SVC may switch the current thread, so keep the one that made the call
+    const SharedPtr<Thread> thread = GetCurrentThread();
+    DispatchSVC(immediate);
+
+    if (immediate < std::size(SVC_Table)) {
+        SVCProfiler::RecordCall(immediate, SVC_Table[immediate].name, *thread,
+                                run_start - wait_start, Clock::now() - run_start);
+    }
+}
 
 } // namespace Kernel
@@ -0,0 +1,257 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <fmt/format.h>
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "core/core_timing.h"
+#include "core/core_timing_util.h"
+#include "core/hle/kernel/svc_profiler.h"
+#include "core/hle/kernel/thread.h"
+#include "core/hle/lock.h"
+
+namespace Kernel::SVCProfiler {
+namespace {
+constexpr std::size_t NUM_SVCS = 0x80;
+
+struct Counters {
+    u64 calls = 0;
+    std::chrono::nanoseconds lock_wait_time{};
+    std::chrono::nanoseconds run_time{};
+    std::chrono::nanoseconds blocked_time{};
+};
+
+struct ThreadProfile {
+    std::string name;
+    std::array<Counters, NUM_SVCS> svcs{};
+
+    /// SVC that made the thread leave the CPU, and the ticks at which it did
+    u32 blocking_svc = 0;
+    u64 blocked_since = 0;
+    bool blocked = false;
+};
+
+struct RequestCounters {
+    const char* command_name = nullptr;
+    u64 calls = 0;
+    std::chrono::nanoseconds run_time{};
+};
+
+/// Number of service commands listed by LogTotals
+constexpr std::size_t NUM_LOGGED_REQUESTS = 16;
+
+// Keyed by thread id, only accessed with the HLE lock held
+std::map<u32, ThreadProfile> thread_profiles;
+std::array<const char*, NUM_SVCS> svc_names{};
+// Keyed by service name and command id, only accessed with the HLE lock held
+std::map<std::pair<std::string, u32>, RequestCounters> request_counters;
+
+using Milliseconds = std::chrono::duration<double, std::milli>;
+
+std::string EscapeJSON(const std::string& text) {
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (const char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            escaped += fmt::format("\\u{:04x}", static_cast<int>(c));
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+} // Anonymous namespace
+
+void RecordCall(u32 svc_id, const char* svc_name, const Thread& thread,
+                std::chrono::nanoseconds lock_wait_time, std::chrono::nanoseconds run_time) {
+    ASSERT(svc_id < NUM_SVCS);
+    svc_names[svc_id] = svc_name;
+
+    ThreadProfile& profile = thread_profiles[thread.GetThreadId()];
+    if (profile.name.empty()) {
+        profile.name = thread.GetName();
+    }
+
+    Counters& counters = profile.svcs[svc_id];
+    ++counters.calls;
+    counters.lock_wait_time += lock_wait_time;
+    counters.run_time += run_time;
+
+    // The SVC made the thread wait or yield, account for the time until it runs again
+    if (thread.status != ThreadStatus::Running) {
+        profile.blocking_svc = svc_id;
+        profile.blocked_since = CoreTiming::GetTicks();
+        profile.blocked = true;
+    }
+}
+
+void RecordRequest(const std::string& service_name, u32 command, const char* command_name,
+                   std::chrono::nanoseconds run_time) {
+    RequestCounters& counters = request_counters[{service_name, command}];
+    counters.command_name = command_name;
+    ++counters.calls;
+    counters.run_time += run_time;
+}
+
+void RecordResume(const Thread& thread) {
+    const auto iter = thread_profiles.find(thread.GetThreadId());
+    if (iter == thread_profiles.end() || !iter->second.blocked) {
+        return;
+    }
+
+    ThreadProfile& profile = iter->second;
+    const u64 elapsed_ticks = CoreTiming::GetTicks() - profile.blocked_since;
+    profile.svcs[profile.blocking_svc].blocked_time +=
+        std::chrono::nanoseconds(CoreTiming::cyclesToNs(static_cast<s64>(elapsed_ticks)));
+    profile.blocked = false;
+}
+
+std::vector<SVCProfileEntry> GetEntries() {
+    std::lock_guard<std::recursive_mutex> lock(HLE::g_hle_lock);
+
+    std::vector<SVCProfileEntry> entries;
+    for (u32 svc_id = 0; svc_id < NUM_SVCS; ++svc_id) {
+        for (const auto& [thread_id, profile] : thread_profiles) {
+            const Counters& counters = profile.svcs[svc_id];
+            if (counters.calls == 0) {
+                continue;
+            }
+
+            SVCProfileEntry entry;
+            entry.svc_id = svc_id;
+            entry.svc_name = svc_names[svc_id];
+            entry.thread_id = thread_id;
+            entry.thread_name = profile.name;
+            entry.calls = counters.calls;
+            entry.lock_wait_time = counters.lock_wait_time;
+            entry.run_time = counters.run_time;
+            entry.blocked_time = counters.blocked_time;
+            entries.push_back(std::move(entry));
+        }
+    }
+    return entries;
+}
+
+std::vector<SVCProfileEntry> GetTotals(const std::vector<SVCProfileEntry>& entries) {
+    std::vector<SVCProfileEntry> totals;
+    for (const SVCProfileEntry& entry : entries) {
+        auto total = std::find_if(totals.begin(), totals.end(), [&entry](const auto& total) {
+            return total.svc_id == entry.svc_id;
+        });
+        if (total == totals.end()) {
+            SVCProfileEntry new_total;
+            new_total.svc_id = entry.svc_id;
+            new_total.svc_name = entry.svc_name;
+            total = totals.insert(totals.end(), std::move(new_total));
+        }
+
+        total->calls += entry.calls;
+        total->lock_wait_time += entry.lock_wait_time;
+        total->run_time += entry.run_time;
+        total->blocked_time += entry.blocked_time;
+    }
+
+    std::sort(totals.begin(), totals.end(),
+              [](const auto& lhs, const auto& rhs) { return lhs.run_time > rhs.run_time; });
+    return totals;
+}
+
+std::vector<IPCRequestProfileEntry> GetRequestEntries() {
+    std::lock_guard<std::recursive_mutex> lock(HLE::g_hle_lock);
+
+    std::vector<IPCRequestProfileEntry> entries;
+    entries.reserve(request_counters.size());
+    for (const auto& [key, counters] : request_counters) {
+        IPCRequestProfileEntry entry;
+        entry.service_name = key.first;
+        entry.command = key.second;
+        entry.command_name = counters.command_name;
+        entry.calls = counters.calls;
+        entry.run_time = counters.run_time;
+        entries.push_back(std::move(entry));
+    }
+
+    std::sort(entries.begin(), entries.end(),
+              [](const auto& lhs, const auto& rhs) { return lhs.run_time > rhs.run_time; });
+    return entries;
+}
+
+void Reset() {
+    std::lock_guard<std::recursive_mutex> lock(HLE::g_hle_lock);
+    thread_profiles.clear();
+    request_counters.clear();
+}
+
+void LogTotals() {
+    const std::vector<SVCProfileEntry> totals = GetTotals(GetEntries());
+    if (totals.empty()) {
+        return;
+    }
+
+    LOG_INFO(Kernel_SVC, "SVC statistics, by decreasing run time:");
+    for (const SVCProfileEntry& total : totals) {
+        LOG_INFO(Kernel_SVC,
+                 "  {:<28} calls={:<10} run={:.3f}ms lock_wait={:.3f}ms blocked={:.3f}ms",
+                 total.svc_name, total.calls, Milliseconds(total.run_time).count(),
+                 Milliseconds(total.lock_wait_time).count(),
+                 Milliseconds(total.blocked_time).count());
+    }
+
+    const std::vector<IPCRequestProfileEntry> requests = GetRequestEntries();
+    const std::size_t num_logged = std::min(requests.size(), NUM_LOGGED_REQUESTS);
+    if (num_logged == 0) {
+        return;
+    }
+
+    LOG_INFO(Kernel_SVC, "Most expensive service commands:");
+    for (std::size_t i = 0; i < num_logged; ++i) {
+        const IPCRequestProfileEntry& request = requests[i];
+        LOG_INFO(Kernel_SVC, "  {}::{} ({}) calls={} run={:.3f}ms", request.service_name,
+                 request.command_name, request.command, request.calls,
+                 Milliseconds(request.run_time).count());
+    }
+}
+
+std::string FormatCSV(const std::vector<SVCProfileEntry>& entries) {
+    std::string csv =
+        "svc_id,svc_name,thread_id,thread_name,calls,run_ms,lock_wait_ms,blocked_ms\n";
+    for (const SVCProfileEntry& entry : entries) {
+        std::string thread_name = entry.thread_name;
+        std::replace(thread_name.begin(), thread_name.end(), '"', '\'');
+        csv += fmt::format("0x{:02X},{},{},\"{}\",{},{:.6f},{:.6f},{:.6f}\n", entry.svc_id,
+                           entry.svc_name, entry.thread_id, thread_name, entry.calls,
+                           Milliseconds(entry.run_time).count(),
+                           Milliseconds(entry.lock_wait_time).count(),
+                           Milliseconds(entry.blocked_time).count());
+    }
+    return csv;
+}
+
+std::string FormatJSON(const std::vector<SVCProfileEntry>& entries) {
+    std::string json = "[\n";
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        const SVCProfileEntry& entry = entries[i];
+        json += fmt::format("  {{\"svc_id\": {}, \"svc_name\": \"{}\", \"thread_id\": {}, "
+                            "\"thread_name\": \"{}\", \"calls\": {}, \"run_ms\": {:.6f}, "
+                            "\"lock_wait_ms\": {:.6f}, \"blocked_ms\": {:.6f}}}{}\n",
+                            entry.svc_id, entry.svc_name, entry.thread_id,
+                            EscapeJSON(entry.thread_name), entry.calls,
+                            Milliseconds(entry.run_time).count(),
+                            Milliseconds(entry.lock_wait_time).count(),
+                            Milliseconds(entry.blocked_time).count(),
+                            i + 1 < entries.size() ? "," : "");
+    }
+    json += "]\n";
+    return json;
+}
+
+} // namespace Kernel::SVCProfiler
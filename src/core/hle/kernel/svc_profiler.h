@@ -0,0 +1,86 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Kernel {
+
+class Thread;
+
+/// Statistics of the calls made to one SVC, by one guest thread or by all of them
+struct SVCProfileEntry {
+    u32 svc_id = 0;
+    std::string svc_name;
+    /// Guest thread that made the calls, unset in totals
+    u32 thread_id = 0;
+    std::string thread_name;
+
+    u64 calls = 0;
+    /// Host time spent waiting to acquire the HLE lock before running the SVC
+    std::chrono::nanoseconds lock_wait_time{};
+    /// Host time spent running the SVC with the HLE lock held
+    std::chrono::nanoseconds run_time{};
+    /// Emulated time the calling thread spent off the CPU, from the moment the SVC made it wait or
+    /// yield until it was scheduled again
+    std::chrono::nanoseconds blocked_time{};
+};
+
+/// Statistics of the IPC requests made to one command of a service, by all guest threads
+struct IPCRequestProfileEntry {
+    std::string service_name;
+    u32 command = 0;
+    std::string command_name;
+
+    u64 calls = 0;
+    /// Host time spent running the service handler
+    std::chrono::nanoseconds run_time{};
+};
+
+/**
+ * Gathers statistics of the SVCs made by each guest thread when Settings::values.profile_svcs is
+ * set, telling apart the time spent in HLE from the time the guest spends waiting. All the
+ * statistics are only accessed with the HLE lock held, which every SVC holds already, so they
+ * don't need any synchronization of their own.
+ */
+namespace SVCProfiler {
+
+/// Records a call to an SVC made by the given thread, must be called with the HLE lock held
+void RecordCall(u32 svc_id, const char* svc_name, const Thread& thread,
+                std::chrono::nanoseconds lock_wait_time, std::chrono::nanoseconds run_time);
+
+/// Records a request handled by a service, must be called with the HLE lock held
+void RecordRequest(const std::string& service_name, u32 command, const char* command_name,
+                   std::chrono::nanoseconds run_time);
+
+/// Accounts the time a thread was blocked by its last SVC when it's scheduled again
+void RecordResume(const Thread& thread);
+
+/// Returns the statistics of each SVC called by each guest thread, sorted by SVC and thread id
+std::vector<SVCProfileEntry> GetEntries();
+
+/// Sums the given entries per SVC, sorted by decreasing run time
+std::vector<SVCProfileEntry> GetTotals(const std::vector<SVCProfileEntry>& entries);
+
+/// Returns the statistics of each service command that was requested, by decreasing run time
+std::vector<IPCRequestProfileEntry> GetRequestEntries();
+
+/// Clears all the gathered statistics
+void Reset();
+
+/// Logs the totals per SVC and the most expensive service commands
+void LogTotals();
+
+/// Formats the given entries as a CSV table with a header row
+std::string FormatCSV(const std::vector<SVCProfileEntry>& entries);
+
+/// Formats the given entries as a JSON array of objects
+std::string FormatJSON(const std::vector<SVCProfileEntry>& entries);
+
+} // namespace SVCProfiler
+} // namespace Kernel
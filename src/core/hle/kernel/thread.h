@@ -8,9 +8,11 @@
 #include <memory>
 #include <string>
 #include <vector>
-
+#include <boost/container/small_vector.hpp>
 #include "common/common_types.h"
+#include "common/memory_util.h"
 #include "core/arm/arm_interface.h"
+#include "core/core_timing.h"
 #include "core/hle/kernel/object.h"
 #include "core/hle/kernel/wait_object.h"
 #include "core/hle/result.h"
@@ -62,6 +64,9 @@ enum class ThreadWakeupReason {
 
 class Thread final : public WaitObject {
 public:
+    /// Most waits are on a handful of objects, those are stored inline without allocating
+    using ThreadWaitObjects = boost::container::small_vector<SharedPtr<WaitObject>, 4>;
+
     /**
      * Creates and returns a new thread. The new thread is immediately scheduled
      * @param kernel The kernel instance this thread will be created under.
@@ -229,7 +234,7 @@ public:
 
     /// Objects that the thread is waiting on, in the same order as they were
     // passed to WaitSynchronization1/N.
-    std::vector<SharedPtr<WaitObject>> wait_objects;
+    ThreadWaitObjects wait_objects;
 
     /// List of threads that are waiting for a mutex that is held by this thread.
     std::vector<SharedPtr<Thread>> wait_mutex_threads;
@@ -253,6 +258,9 @@ public:
     /// Handle used as userdata to reference this object when inserting into the CoreTiming queue.
     Handle callback_handle;
 
+    /// CoreTiming handle of the pending wakeup event of this thread, if any.
+    CoreTiming::EventHandle wakeup_event_handle = CoreTiming::INVALID_EVENT_HANDLE;
+
     using WakeupCallback = bool(ThreadWakeupReason reason, SharedPtr<Thread> thread,
                                 SharedPtr<WaitObject> object, std::size_t index);
     // Callback that will be invoked when the thread is resumed from a waiting state. If the thread
@@ -268,8 +276,6 @@ public:
 private:
     explicit Thread(KernelCore& kernel);
     ~Thread() override;
-
-    std::shared_ptr<std::vector<u8>> tls_memory = std::make_shared<std::vector<u8>>();
 };
 
 /**
@@ -69,9 +69,10 @@ void VMManager::Reset() {
     initial_vma.size = MAX_ADDRESS;
     vma_map.emplace(initial_vma.base, initial_vma);
 
-    page_table.pointers.fill(nullptr);
+    // Fresh arrays are zero filled on demand, rather than writing every entry of the old ones
+    page_table.pointers = Common::VirtualBuffer<u8*>(Memory::PAGE_TABLE_NUM_ENTRIES);
     page_table.special_regions.clear();
-    page_table.attributes.fill(Memory::PageType::Unmapped);
+    page_table.attributes = Common::VirtualBuffer<Memory::PageType>(Memory::PAGE_TABLE_NUM_ENTRIES);
 
     UpdatePageTableForVMA(initial_vma);
 }
@@ -84,10 +85,9 @@ VMManager::VMAHandle VMManager::FindVMA(VAddr target) const {
     }
 }
 
-ResultVal<VMManager::VMAHandle> VMManager::MapMemoryBlock(VAddr target,
-                                                          std::shared_ptr<std::vector<u8>> block,
-                                                          std::size_t offset, u64 size,
-                                                          MemoryState state) {
+ResultVal<VMManager::VMAHandle> VMManager::MapMemoryBlock(
+    VAddr target, std::shared_ptr<Common::DemandZeroBuffer> block, std::size_t offset, u64 size,
+    MemoryState state) {
     ASSERT(block != nullptr);
     ASSERT(offset + size <= block->size());
 
@@ -193,6 +193,9 @@ ResultCode VMManager::UnmapRange(VAddr target, u64 size) {
     system.ArmInterface(2).UnmapMemory(target, size);
     system.ArmInterface(3).UnmapMemory(target, size);
 
+    // Only the code translated from the unmapped range is stale, the rest of it is kept
+    system.InvalidateCpuInstructionCacheRange(target, size);
+
     return RESULT_SUCCESS;
 }
 
@@ -220,7 +223,7 @@ ResultCode VMManager::ReprotectRange(VAddr target, u64 size, VMAPermission new_p
     return RESULT_SUCCESS;
 }
 
-void VMManager::RefreshMemoryBlockMappings(const std::vector<u8>* block) {
+void VMManager::RefreshMemoryBlockMappings(const Common::DemandZeroBuffer* block) {
     // If this ever proves to have a noticeable performance impact, allow users of the function to
     // specify a specific range of addresses to limit the scan to.
     for (const auto& p : vma_map) {
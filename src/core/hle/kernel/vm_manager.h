@@ -8,6 +8,7 @@
 #include <memory>
 #include <vector>
 #include "common/common_types.h"
+#include "common/memory_util.h"
 #include "core/hle/result.h"
 #include "core/memory.h"
 #include "core/memory_hook.h"
@@ -79,7 +80,7 @@ struct VirtualMemoryArea {
 
     // Settings for type = AllocatedMemoryBlock
     /// Memory block backing this VMA.
-    std::shared_ptr<std::vector<u8>> backing_block = nullptr;
+    std::shared_ptr<Common::DemandZeroBuffer> backing_block = nullptr;
     /// Offset into the backing_memory the mapping starts from.
     std::size_t offset = 0;
 
@@ -146,7 +147,8 @@ public:
      * @param size Size of the mapping.
      * @param state MemoryState tag to attach to the VMA.
      */
-    ResultVal<VMAHandle> MapMemoryBlock(VAddr target, std::shared_ptr<std::vector<u8>> block,
+    ResultVal<VMAHandle> MapMemoryBlock(VAddr target,
+                                        std::shared_ptr<Common::DemandZeroBuffer> block,
                                         std::size_t offset, u64 size, MemoryState state);
 
     /**
@@ -184,7 +186,7 @@ public:
      * Scans all VMAs and updates the page table range of any that use the given vector as backing
      * memory. This should be called after any operation that causes reallocation of the vector.
      */
-    void RefreshMemoryBlockMappings(const std::vector<u8>* block);
+    void RefreshMemoryBlockMappings(const Common::DemandZeroBuffer* block);
 
     /// Dumps the address space layout to the log, for debugging
     void LogLayout() const;
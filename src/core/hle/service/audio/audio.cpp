@@ -15,27 +15,27 @@
 #include "core/hle/service/audio/audren_u.h"
 #include "core/hle/service/audio/codecctl.h"
 #include "core/hle/service/audio/hwopus.h"
-#include "core/hle/service/service.h"
+#include "core/hle/service/sm/sm.h"
 
 namespace Service::Audio {
 
 void InstallInterfaces(SM::ServiceManager& service_manager) {
-    std::make_shared<AudCtl>()->InstallAsService(service_manager);
-    std::make_shared<AudOutA>()->InstallAsService(service_manager);
-    std::make_shared<AudOutU>()->InstallAsService(service_manager);
-    std::make_shared<AudInA>()->InstallAsService(service_manager);
-    std::make_shared<AudInU>()->InstallAsService(service_manager);
-    std::make_shared<AudRecA>()->InstallAsService(service_manager);
-    std::make_shared<AudRecU>()->InstallAsService(service_manager);
-    std::make_shared<AudRenA>()->InstallAsService(service_manager);
-    std::make_shared<AudRenU>()->InstallAsService(service_manager);
-    std::make_shared<CodecCtl>()->InstallAsService(service_manager);
-    std::make_shared<HwOpus>()->InstallAsService(service_manager);
+    service_manager.InstallLazyService<AudCtl>("audctl");
+    service_manager.InstallLazyService<AudOutA>("audout:a");
+    service_manager.InstallLazyService<AudOutU>("audout:u");
+    service_manager.InstallLazyService<AudInA>("audin:a");
+    service_manager.InstallLazyService<AudInU>("audin:u");
+    service_manager.InstallLazyService<AudRecA>("audrec:a");
+    service_manager.InstallLazyService<AudRecU>("audrec:u");
+    service_manager.InstallLazyService<AudRenA>("audren:a");
+    service_manager.InstallLazyService<AudRenU>("audren:u");
+    service_manager.InstallLazyService<CodecCtl>("codecctl");
+    service_manager.InstallLazyService<HwOpus>("hwopus");
 
-    std::make_shared<AudDbg>("audin:d")->InstallAsService(service_manager);
-    std::make_shared<AudDbg>("audout:d")->InstallAsService(service_manager);
-    std::make_shared<AudDbg>("audrec:d")->InstallAsService(service_manager);
-    std::make_shared<AudDbg>("audren:d")->InstallAsService(service_manager);
+    service_manager.InstallLazyService<AudDbg>("audin:d", "audin:d");
+    service_manager.InstallLazyService<AudDbg>("audout:d", "audout:d");
+    service_manager.InstallLazyService<AudDbg>("audrec:d", "audrec:d");
+    service_manager.InstallLazyService<AudDbg>("audren:d", "audren:d");
 }
 
 } // namespace Service::Audio
@@ -132,14 +132,19 @@ private:
         std::memcpy(&audio_buffer, input_buffer.data(), sizeof(AudioBuffer));
         const u64 tag{rp.Pop<u64>()};
 
-        std::vector<s16> samples(audio_buffer.buffer_size / sizeof(s16));
-        Memory::ReadBlock(audio_buffer.buffer, samples.data(), audio_buffer.buffer_size);
-
-        if (!audio_core.QueueBuffer(stream, tag, std::move(samples))) {
+        AudioCore::Buffer* const buffer{audio_core.AcquireBuffer(stream, tag)};
+        if (buffer == nullptr) {
             IPC::ResponseBuilder rb{ctx, 2};
             rb.Push(ResultCode(ErrorModule::Audio, ErrCodes::BufferCountExceeded));
+            return;
         }
 
+        // Pooled buffers keep their capacity, so this only allocates the first few times
+        auto& samples{buffer->Samples()};
+        samples.resize(audio_buffer.buffer_size / sizeof(s16));
+        Memory::ReadBlock(audio_buffer.buffer, samples.data(), samples.size() * sizeof(s16));
+        audio_core.QueueBuffer(stream, buffer);
+
         IPC::ResponseBuilder rb{ctx, 2};
         rb.Push(RESULT_SUCCESS);
     }
@@ -147,16 +152,16 @@ private:
     void GetReleasedAudioOutBufferImpl(Kernel::HLERequestContext& ctx) {
         LOG_DEBUG(Service_Audio, "called {}", ctx.Description());
         IPC::RequestParser rp{ctx};
-        const u64 max_count{ctx.GetWriteBufferSize() / sizeof(u64)};
-        const auto released_buffers{audio_core.GetTagsAndReleaseBuffers(stream, max_count)};
-
-        std::vector<u64> tags{released_buffers};
-        tags.resize(max_count);
-        ctx.WriteBuffer(tags);
+        std::array<u64, AudioCore::MaxAudioBufferCount> tags{};
+        const std::size_t max_count{
+            std::min(ctx.GetWriteBufferSize() / sizeof(u64), tags.size())};
+        const std::size_t released_count{
+            audio_core.GetTagsAndReleaseBuffers(stream, tags.data(), max_count)};
+        ctx.WriteBuffer(tags.data(), max_count * sizeof(u64));
 
         IPC::ResponseBuilder rb{ctx, 3};
         rb.Push(RESULT_SUCCESS);
-        rb.Push<u32>(static_cast<u32>(released_buffers.size()));
+        rb.Push<u32>(static_cast<u32>(released_count));
     }
 
     void ContainsAudioOutBuffer(Kernel::HLERequestContext& ctx) {
@@ -2,16 +2,24 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstring>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 #include <opus.h>
+#include <opus_multistream.h>
 
 #include "common/common_funcs.h"
 #include "common/logging/log.h"
+#include "common/thread_pool.h"
 #include "core/hle/ipc_helpers.h"
 #include "core/hle/kernel/hle_ipc.h"
+#include "core/hle/kernel/thread.h"
 #include "core/hle/service/audio/hwopus.h"
 
 namespace Service::Audio {
@@ -22,16 +30,171 @@ struct OpusDeleter {
     }
 };
 
+using OpusDecoderPtr = std::unique_ptr<OpusDecoder, OpusDeleter>;
+
+struct OpusHeader {
+    u32_be sz; // Needs to be BE for some odd reason
+    INSERT_PADDING_WORDS(1);
+};
+static_assert(sizeof(OpusHeader) == 0x8, "OpusHeader is an invalid size");
+
+struct OpusMultiStreamParameters {
+    u32 sample_rate;
+    u32 channel_count;
+    u32 stream_count;
+    u32 stereo_stream_count;
+    std::array<u8, 0x100> channel_mappings;
+};
+static_assert(sizeof(OpusMultiStreamParameters) == 0x110,
+              "OpusMultiStreamParameters is an invalid size");
+
+/// Maximum number of packets following the requested one that are decoded in the same request
+constexpr std::size_t MaxPacketsDecodedAhead = 8;
+/// Maximum number of input bytes read past the requested packet to find the packets to decode
+constexpr std::size_t MaxDecodeAheadInputSize = 0x4000;
+
+/**
+ * Reads a frame length of an Opus packet (RFC 6716 section 3.2.1)
+ * @returns The number of bytes the length is coded on, or 0 if the packet is truncated
+ */
+static std::size_t ReadFrameLength(const u8* data, std::size_t size, std::size_t& length) {
+    if (size < 1) {
+        return 0;
+    }
+    if (data[0] < 252) {
+        length = data[0];
+        return 1;
+    }
+    if (size < 2) {
+        return 0;
+    }
+    length = data[0] + 4 * static_cast<std::size_t>(data[1]);
+    return 2;
+}
+
+/**
+ * Converts the self-delimited packet of a stream at the start of a multistream packet into a
+ * regular Opus packet, by removing its extra length field (RFC 6716 appendix B).
+ * @returns The size of the self-delimited packet, or 0 if it's invalid
+ */
+static std::size_t UndelimitPacket(const u8* data, std::size_t size, std::vector<u8>& packet) {
+    if (size < 1) {
+        return 0;
+    }
+    packet.assign(data, data + 1);
+    std::size_t position = 1;
+    std::size_t frames_size = 0;
+    std::size_t padding_size = 0;
+
+    // Copies a length that is kept in the regular packet
+    const auto KeepLength = [&](std::size_t& length) {
+        const std::size_t bytes = ReadFrameLength(data + position, size - position, length);
+        packet.insert(packet.end(), data + position, data + position + bytes);
+        position += bytes;
+        return bytes != 0;
+    };
+    // Skips the self-delimiting length
+    const auto SkipLength = [&](std::size_t& length) {
+        const std::size_t bytes = ReadFrameLength(data + position, size - position, length);
+        position += bytes;
+        return bytes != 0;
+    };
+
+    std::size_t length;
+    switch (data[0] & 3) {
+    case 0:
+        // A single frame
+        if (!SkipLength(length)) {
+            return 0;
+        }
+        frames_size = length;
+        break;
+    case 1:
+        // Two frames of the same size
+        if (!SkipLength(length)) {
+            return 0;
+        }
+        frames_size = length * 2;
+        break;
+    case 2: {
+        // Two frames, the length of the second one is the self-delimiting one
+        std::size_t first_length;
+        if (!KeepLength(first_length) || !SkipLength(length)) {
+            return 0;
+        }
+        frames_size = first_length + length;
+        break;
+    }
+    case 3: {
+        // An arbitrary number of frames, the last length is the self-delimiting one
+        if (position >= size) {
+            return 0;
+        }
+        const u8 frame_count_byte = data[position++];
+        packet.push_back(frame_count_byte);
+        const std::size_t frame_count = frame_count_byte & 0x3F;
+        const bool is_vbr = (frame_count_byte & 0x80) != 0;
+        const bool is_padded = (frame_count_byte & 0x40) != 0;
+        if (frame_count == 0) {
+            return 0;
+        }
+
+        while (is_padded) {
+            if (position >= size) {
+                return 0;
+            }
+            const u8 padding_byte = data[position++];
+            packet.push_back(padding_byte);
+            padding_size += padding_byte == 255 ? 254 : padding_byte;
+            if (padding_byte != 255) {
+                break;
+            }
+        }
+
+        if (is_vbr) {
+            for (std::size_t frame = 0; frame < frame_count - 1; ++frame) {
+                if (!KeepLength(length)) {
+                    return 0;
+                }
+                frames_size += length;
+            }
+            if (!SkipLength(length)) {
+                return 0;
+            }
+            frames_size += length;
+        } else {
+            if (!SkipLength(length)) {
+                return 0;
+            }
+            frames_size = length * frame_count;
+        }
+        break;
+    }
+    }
+
+    if (frames_size + padding_size > size - position) {
+        return 0;
+    }
+    packet.insert(packet.end(), data + position, data + position + frames_size + padding_size);
+    return position + frames_size + padding_size;
+}
+
 class IHardwareOpusDecoderManager final : public ServiceFramework<IHardwareOpusDecoderManager> {
 public:
-    IHardwareOpusDecoderManager(std::unique_ptr<OpusDecoder, OpusDeleter> decoder, u32 sample_rate,
-                                u32 channel_count)
-        : ServiceFramework("IHardwareOpusDecoderManager"), decoder(std::move(decoder)),
-          sample_rate(sample_rate), channel_count(channel_count) {
+    /**
+     * Creates a decoder session. A session decodes either a single Opus stream or the streams of
+     * a multistream, in which case `decoders` holds the decoders of the stereo streams first.
+     */
+    IHardwareOpusDecoderManager(std::vector<OpusDecoderPtr> decoders, u32 sample_rate,
+                                u32 channel_count, u32 stereo_stream_count,
+                                const std::array<u8, 0x100>& channel_mappings)
+        : ServiceFramework("IHardwareOpusDecoderManager"), decoders(std::move(decoders)),
+          sample_rate(sample_rate), channel_count(channel_count),
+          stereo_stream_count(stereo_stream_count), channel_mappings(channel_mappings) {
         static const FunctionInfo functions[] = {
             {0, &IHardwareOpusDecoderManager::DecodeInterleaved, "DecodeInterleaved"},
             {1, nullptr, "SetContext"},
-            {2, nullptr, "DecodeInterleavedForMultiStream"},
+            {2, &IHardwareOpusDecoderManager::DecodeInterleaved, "DecodeInterleavedForMultiStream"},
             {3, nullptr, "SetContextForMultiStream"},
             {4, nullptr, "Unknown4"},
             {5, nullptr, "Unknown5"},
@@ -39,75 +202,330 @@ public:
             {7, nullptr, "Unknown7"},
         };
         RegisterHandlers(functions);
+
+        for (std::size_t stream = 0; stream < this->decoders.size(); ++stream) {
+            decoder_sizes.push_back(opus_decoder_get_size(GetStreamChannelCount(stream)));
+        }
     }
 
 private:
-    void DecodeInterleaved(Kernel::HLERequestContext& ctx) {
-        u32 consumed = 0;
+    /// Packet decoded ahead of the request for it, along with the decoder state it leads to
+    struct DecodedPacket {
+        std::vector<u8> packet;
+        std::vector<opus_int16> samples;
         u32 sample_count = 0;
-        std::vector<opus_int16> samples(ctx.GetWriteBufferSize() / sizeof(opus_int16));
-        if (!Decoder_DecodeInterleaved(consumed, sample_count, ctx.ReadBuffer(), samples)) {
-            IPC::ResponseBuilder rb{ctx, 2};
-            // TODO(ogniK): Use correct error code
-            rb.Push(ResultCode(-1));
+        std::vector<u8> decoder_state;
+    };
+
+    /// Multistreams are decoded the same way as single streams, only the packet format differs
+    void DecodeInterleaved(Kernel::HLERequestContext& ctx) {
+        struct DecodeState {
+            std::vector<u8> input;
+            std::vector<opus_int16> samples;
+            u32 consumed = 0;
+            u32 sample_count = 0;
+            bool success = false;
+        };
+
+        std::vector<u8> input_copy;
+        const u8* input = ctx.GetReadBufferPointer();
+        if (input == nullptr) {
+            input_copy = ctx.ReadBuffer();
+            input = input_copy.data();
+        }
+        const std::size_t input_size = ctx.GetReadBufferSize();
+        const std::size_t output_size = ctx.GetWriteBufferSize();
+
+        // The packet was decoded along with a previous one, so there is no need to wait
+        if (const auto decoded = TakeDecodedPacket(input, input_size, output_size)) {
+            IPC::ResponseBuilder rb{ctx, 4};
+            rb.Push(RESULT_SUCCESS);
+            rb.Push<u32>(static_cast<u32>(decoded->packet.size()));
+            rb.Push<u32>(decoded->sample_count);
+            ctx.WriteBuffer(decoded->samples.data(),
+                            decoded->sample_count * channel_count * sizeof(s16));
             return;
         }
-        IPC::ResponseBuilder rb{ctx, 4};
-        rb.Push(RESULT_SUCCESS);
-        rb.Push<u32>(consumed);
-        rb.Push<u32>(sample_count);
-        ctx.WriteBuffer(samples.data(), samples.size() * sizeof(s16));
+
+        // The worker can't access guest memory, so the packets it may decode ahead are copied
+        std::size_t copy_size = input_size;
+        if (input_size >= sizeof(OpusHeader)) {
+            OpusHeader hdr{};
+            std::memcpy(&hdr, input, sizeof(OpusHeader));
+            copy_size = std::min<std::size_t>(
+                input_size, sizeof(OpusHeader) + hdr.sz + MaxDecodeAheadInputSize);
+        }
+
+        auto state = std::make_shared<DecodeState>();
+        state->input.assign(input, input + copy_size);
+        state->samples.resize(output_size / sizeof(opus_int16));
+
+        // Decode on the host worker while the guest thread waits
+        const auto self = std::static_pointer_cast<IHardwareOpusDecoderManager>(shared_from_this());
+        ctx.RunAsync(
+            Kernel::GetCurrentThread(), "IHardwareOpusDecoderManager::DecodeInterleaved",
+            [self, state] {
+                state->success = self->Decoder_DecodeInterleaved(
+                    state->consumed, state->sample_count, state->input, state->samples);
+            },
+            [state](Kernel::SharedPtr<Kernel::Thread> thread, Kernel::HLERequestContext& ctx,
+                    Kernel::ThreadWakeupReason reason) {
+                if (!state->success) {
+                    IPC::ResponseBuilder rb{ctx, 2};
+                    // TODO(ogniK): Use correct error code
+                    rb.Push(ResultCode(-1));
+                    return;
+                }
+                IPC::ResponseBuilder rb{ctx, 4};
+                rb.Push(RESULT_SUCCESS);
+                rb.Push<u32>(state->consumed);
+                rb.Push<u32>(state->sample_count);
+                ctx.WriteBuffer(state->samples.data(), state->samples.size() * sizeof(s16));
+            });
+    }
+
+    /**
+     * Returns the next packet decoded ahead if it's the one at the start of the input, and moves
+     * the decoders past it. Otherwise, the packets decoded ahead are dropped.
+     */
+    std::unique_ptr<DecodedPacket> TakeDecodedPacket(const u8* input, std::size_t input_size,
+                                                     std::size_t output_size) {
+        std::lock_guard<std::mutex> lock{mutex};
+        if (decoded_ahead.empty()) {
+            return nullptr;
+        }
+
+        auto& next = decoded_ahead.front();
+        const bool matches = next.packet.size() <= input_size &&
+                             std::equal(next.packet.begin(), next.packet.end(), input) &&
+                             next.sample_count * channel_count * sizeof(s16) <= output_size;
+        if (!matches) {
+            LOG_DEBUG(Audio, "Dropping {} Opus packets decoded ahead", decoded_ahead.size());
+            decoded_ahead.clear();
+            return nullptr;
+        }
+
+        auto decoded = std::make_unique<DecodedPacket>(std::move(next));
+        decoded_ahead.pop_front();
+        RestoreState(decoded->decoder_state);
+        return decoded;
     }
 
     bool Decoder_DecodeInterleaved(u32& consumed, u32& sample_count, const std::vector<u8>& input,
                                    std::vector<opus_int16>& output) {
-        std::size_t raw_output_sz = output.size() * sizeof(opus_int16);
-        if (sizeof(OpusHeader) > input.size())
+        std::lock_guard<std::mutex> lock{mutex};
+        decoded_ahead.clear();
+        if (!DecodePacket(consumed, sample_count, input.data(), input.size(), output)) {
+            return false;
+        }
+
+        // Games that stream their audio usually pass the rest of their buffer along with the
+        // packet, the following packets are decoded now so that decoding them doesn't need a trip
+        // through the worker. The decoders are then put back to their state after this packet.
+        const std::vector<u8> committed_state = SaveState();
+        std::size_t offset = consumed;
+        while (decoded_ahead.size() < MaxPacketsDecodedAhead && offset < input.size()) {
+            DecodedPacket decoded;
+            decoded.samples.resize(output.size());
+            u32 packet_size;
+            if (!DecodePacket(packet_size, decoded.sample_count, input.data() + offset,
+                              input.size() - offset, decoded.samples)) {
+                break;
+            }
+            decoded.packet.assign(input.begin() + offset, input.begin() + offset + packet_size);
+            decoded.decoder_state = SaveState();
+            decoded_ahead.push_back(std::move(decoded));
+            offset += packet_size;
+        }
+        RestoreState(committed_state);
+        return true;
+    }
+
+    bool DecodePacket(u32& consumed, u32& sample_count, const u8* input, std::size_t input_size,
+                      std::vector<opus_int16>& output) {
+        if (sizeof(OpusHeader) > input_size)
             return false;
         OpusHeader hdr{};
-        std::memcpy(&hdr, input.data(), sizeof(OpusHeader));
-        if (sizeof(OpusHeader) + static_cast<u32>(hdr.sz) > input.size()) {
+        std::memcpy(&hdr, input, sizeof(OpusHeader));
+        if (sizeof(OpusHeader) + static_cast<u32>(hdr.sz) > input_size) {
+            return false;
+        }
+        const u8* const frame = input + sizeof(OpusHeader);
+        const bool success = decoders.size() == 1
+                                 ? DecodeSingleStream(sample_count, frame, hdr.sz, output)
+                                 : DecodeMultiStream(sample_count, frame, hdr.sz, output);
+        if (!success) {
             return false;
         }
-        auto frame = input.data() + sizeof(OpusHeader);
+        consumed = static_cast<u32>(sizeof(OpusHeader) + hdr.sz);
+        return true;
+    }
+
+    bool DecodeSingleStream(u32& sample_count, const u8* frame, std::size_t frame_size,
+                            std::vector<opus_int16>& output) {
+        std::size_t raw_output_sz = output.size() * sizeof(opus_int16);
         auto decoded_sample_count = opus_packet_get_nb_samples(
-            frame, static_cast<opus_int32>(input.size() - sizeof(OpusHeader)),
-            static_cast<opus_int32>(sample_rate));
-        if (decoded_sample_count * channel_count * sizeof(u16) > raw_output_sz)
+            frame, static_cast<opus_int32>(frame_size), static_cast<opus_int32>(sample_rate));
+        if (decoded_sample_count < 0 ||
+            decoded_sample_count * channel_count * sizeof(u16) > raw_output_sz)
             return false;
-        auto out_sample_count =
-            opus_decode(decoder.get(), frame, hdr.sz, output.data(),
-                        (static_cast<int>(raw_output_sz / sizeof(s16) / channel_count)), 0);
+        auto out_sample_count = opus_decode(
+            decoders[0].get(), frame, static_cast<opus_int32>(frame_size), output.data(),
+            (static_cast<int>(raw_output_sz / sizeof(s16) / channel_count)), 0);
         if (out_sample_count < 0)
             return false;
         sample_count = out_sample_count;
-        consumed = static_cast<u32>(sizeof(OpusHeader) + hdr.sz);
         return true;
     }
 
-    struct OpusHeader {
-        u32_be sz; // Needs to be BE for some odd reason
-        INSERT_PADDING_WORDS(1);
-    };
-    static_assert(sizeof(OpusHeader) == 0x8, "OpusHeader is an invalid size");
+    /// Decodes the streams of a multistream packet in parallel, then maps their channels
+    bool DecodeMultiStream(u32& sample_count, const u8* frame, std::size_t frame_size,
+                           std::vector<opus_int16>& output) {
+        const std::size_t stream_count = decoders.size();
+        stream_packets.resize(stream_count);
+        stream_samples.resize(stream_count);
+
+        // All the streams but the last one use the self-delimiting framing
+        std::size_t position = 0;
+        for (std::size_t stream = 0; stream < stream_count - 1; ++stream) {
+            const std::size_t packet_size =
+                UndelimitPacket(frame + position, frame_size - position, stream_packets[stream]);
+            if (packet_size == 0) {
+                return false;
+            }
+            position += packet_size;
+        }
+        stream_packets.back().assign(frame + position, frame + frame_size);
+
+        const int frame_count =
+            opus_packet_get_nb_samples(stream_packets[0].data(),
+                                       static_cast<opus_int32>(stream_packets[0].size()),
+                                       static_cast<opus_int32>(sample_rate));
+        if (frame_count <= 0 ||
+            static_cast<std::size_t>(frame_count) * channel_count > output.size()) {
+            return false;
+        }
+
+        const auto DecodeStream = [this, frame_count](std::size_t stream) {
+            const auto& packet = stream_packets[stream];
+            auto& samples = stream_samples[stream];
+            samples.resize(static_cast<std::size_t>(frame_count) * GetStreamChannelCount(stream));
+            return opus_decode(decoders[stream].get(), packet.data(),
+                               static_cast<opus_int32>(packet.size()), samples.data(),
+                               frame_count, 0) == frame_count;
+        };
 
-    std::unique_ptr<OpusDecoder, OpusDeleter> decoder;
+        // Each stream has its own decoder, so they can be decoded at the same time
+        std::atomic<bool> success{true};
+        Common::ThreadPool::GetInstance().ParallelFor(0, stream_count, [&](std::size_t stream) {
+            if (!DecodeStream(stream)) {
+                success = false;
+            }
+        });
+        if (!success) {
+            return false;
+        }
+
+        for (std::size_t channel = 0; channel < channel_count; ++channel) {
+            const u8 mapping = channel_mappings[channel];
+            for (int sample = 0; sample < frame_count; ++sample) {
+                output[sample * channel_count + channel] = GetMappedSample(mapping, sample);
+            }
+        }
+        sample_count = static_cast<u32>(frame_count);
+        return true;
+    }
+
+    /// Gets a decoded sample from the stream channel a mapping refers to, 255 is silence
+    opus_int16 GetMappedSample(u8 mapping, int sample) const {
+        if (mapping == 255) {
+            return 0;
+        }
+        if (mapping < stereo_stream_count * 2) {
+            return stream_samples[mapping / 2][sample * 2 + mapping % 2];
+        }
+        return stream_samples[mapping - stereo_stream_count][sample];
+    }
+
+    int GetStreamChannelCount(std::size_t stream) const {
+        if (decoders.size() == 1) {
+            return static_cast<int>(channel_count);
+        }
+        return stream < stereo_stream_count ? 2 : 1;
+    }
+
+    /// Copies the state of the decoders, which don't hold any pointer to themselves
+    std::vector<u8> SaveState() const {
+        std::vector<u8> state;
+        for (std::size_t stream = 0; stream < decoders.size(); ++stream) {
+            const auto* data = reinterpret_cast<const u8*>(decoders[stream].get());
+            state.insert(state.end(), data, data + decoder_sizes[stream]);
+        }
+        return state;
+    }
+
+    void RestoreState(const std::vector<u8>& state) {
+        std::size_t offset = 0;
+        for (std::size_t stream = 0; stream < decoders.size(); ++stream) {
+            std::memcpy(decoders[stream].get(), state.data() + offset, decoder_sizes[stream]);
+            offset += decoder_sizes[stream];
+        }
+    }
+
+    std::vector<OpusDecoderPtr> decoders;
+    std::vector<std::size_t> decoder_sizes;
     u32 sample_rate;
     u32 channel_count;
+    u32 stereo_stream_count;
+    std::array<u8, 0x100> channel_mappings;
+
+    /// Protects the decoders, which are used by the worker as well as by the guest thread
+    std::mutex mutex;
+    std::deque<DecodedPacket> decoded_ahead;
+
+    /// Scratch buffers of the streams of a multistream packet
+    std::vector<std::vector<u8>> stream_packets;
+    std::vector<std::vector<opus_int16>> stream_samples;
 };
 
+static bool IsValidSampleRate(u32 sample_rate) {
+    return sample_rate == 48000 || sample_rate == 24000 || sample_rate == 16000 ||
+           sample_rate == 12000 || sample_rate == 8000;
+}
+
 static std::size_t WorkerBufferSize(u32 channel_count) {
     ASSERT_MSG(channel_count == 1 || channel_count == 2, "Invalid channel count");
     return opus_decoder_get_size(static_cast<int>(channel_count));
 }
 
+/// Reads the multistream parameters from the input buffer, returns false if they are invalid
+static bool ReadMultiStreamParameters(Kernel::HLERequestContext& ctx,
+                                      OpusMultiStreamParameters& params) {
+    const auto input = ctx.ReadBuffer();
+    if (input.size() < sizeof(OpusMultiStreamParameters)) {
+        return false;
+    }
+    std::memcpy(&params, input.data(), sizeof(OpusMultiStreamParameters));
+
+    if (!IsValidSampleRate(params.sample_rate) || params.channel_count == 0 ||
+        params.channel_count > 255 || params.stream_count == 0 ||
+        params.stereo_stream_count > params.stream_count ||
+        params.stream_count + params.stereo_stream_count > 255) {
+        return false;
+    }
+    const u32 stream_channel_count = params.stream_count + params.stereo_stream_count;
+    return std::all_of(params.channel_mappings.begin(),
+                       params.channel_mappings.begin() + params.channel_count,
+                       [stream_channel_count](u8 mapping) {
+                           return mapping < stream_channel_count || mapping == 255;
+                       });
+}
+
 void HwOpus::GetWorkBufferSize(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp{ctx};
     auto sample_rate = rp.Pop<u32>();
     auto channel_count = rp.Pop<u32>();
-    ASSERT_MSG(sample_rate == 48000 || sample_rate == 24000 || sample_rate == 16000 ||
-                   sample_rate == 12000 || sample_rate == 8000,
-               "Invalid sample rate");
+    ASSERT_MSG(IsValidSampleRate(sample_rate), "Invalid sample rate");
     ASSERT_MSG(channel_count == 1 || channel_count == 2, "Invalid channel count");
     u32 worker_buffer_sz = static_cast<u32>(WorkerBufferSize(channel_count));
     LOG_DEBUG(Audio, "called worker_buffer_sz={}", worker_buffer_sz);
@@ -124,15 +542,12 @@ void HwOpus::OpenOpusDecoder(Kernel::HLERequestContext& ctx) {
     auto buffer_sz = rp.Pop<u32>();
     LOG_DEBUG(Audio, "called sample_rate={}, channel_count={}, buffer_size={}", sample_rate,
               channel_count, buffer_sz);
-    ASSERT_MSG(sample_rate == 48000 || sample_rate == 24000 || sample_rate == 16000 ||
-                   sample_rate == 12000 || sample_rate == 8000,
-               "Invalid sample rate");
+    ASSERT_MSG(IsValidSampleRate(sample_rate), "Invalid sample rate");
     ASSERT_MSG(channel_count == 1 || channel_count == 2, "Invalid channel count");
 
     std::size_t worker_sz = WorkerBufferSize(channel_count);
     ASSERT_MSG(buffer_sz < worker_sz, "Worker buffer too large");
-    std::unique_ptr<OpusDecoder, OpusDeleter> decoder{
-        static_cast<OpusDecoder*>(operator new(worker_sz))};
+    OpusDecoderPtr decoder{static_cast<OpusDecoder*>(operator new(worker_sz))};
     if (opus_decoder_init(decoder.get(), sample_rate, channel_count)) {
         IPC::ResponseBuilder rb{ctx, 2};
         // TODO(ogniK): Use correct error code
@@ -140,18 +555,80 @@ void HwOpus::OpenOpusDecoder(Kernel::HLERequestContext& ctx) {
         return;
     }
 
+    std::vector<OpusDecoderPtr> decoders;
+    decoders.push_back(std::move(decoder));
+    std::array<u8, 0x100> channel_mappings{};
+    channel_mappings[1] = 1;
+
     IPC::ResponseBuilder rb{ctx, 2, 0, 1};
     rb.Push(RESULT_SUCCESS);
-    rb.PushIpcInterface<IHardwareOpusDecoderManager>(std::move(decoder), sample_rate,
-                                                     channel_count);
+    rb.PushIpcInterface<IHardwareOpusDecoderManager>(std::move(decoders), sample_rate,
+                                                     channel_count, channel_count == 2 ? 1 : 0,
+                                                     channel_mappings);
+}
+
+void HwOpus::OpenOpusDecoderForMultiStream(Kernel::HLERequestContext& ctx) {
+    OpusMultiStreamParameters params;
+    if (!ReadMultiStreamParameters(ctx, params)) {
+        LOG_ERROR(Audio, "Invalid multistream parameters");
+        IPC::ResponseBuilder rb{ctx, 2};
+        // TODO(ogniK): Use correct error code
+        rb.Push(ResultCode(-1));
+        return;
+    }
+    LOG_DEBUG(Audio, "called sample_rate={}, channel_count={}, stream_count={}, stereo_streams={}",
+              params.sample_rate, params.channel_count, params.stream_count,
+              params.stereo_stream_count);
+
+    // The streams are decoded with a decoder each rather than with a multistream decoder, so that
+    // they can be decoded in parallel
+    std::vector<OpusDecoderPtr> decoders;
+    for (u32 stream = 0; stream < params.stream_count; ++stream) {
+        const int stream_channels = stream < params.stereo_stream_count ? 2 : 1;
+        OpusDecoderPtr decoder{
+            static_cast<OpusDecoder*>(operator new(opus_decoder_get_size(stream_channels)))};
+        if (opus_decoder_init(decoder.get(), params.sample_rate, stream_channels)) {
+            IPC::ResponseBuilder rb{ctx, 2};
+            // TODO(ogniK): Use correct error code
+            rb.Push(ResultCode(-1));
+            return;
+        }
+        decoders.push_back(std::move(decoder));
+    }
+
+    IPC::ResponseBuilder rb{ctx, 2, 0, 1};
+    rb.Push(RESULT_SUCCESS);
+    rb.PushIpcInterface<IHardwareOpusDecoderManager>(std::move(decoders), params.sample_rate,
+                                                     params.channel_count,
+                                                     params.stereo_stream_count,
+                                                     params.channel_mappings);
+}
+
+void HwOpus::GetWorkBufferSizeForMultiStream(Kernel::HLERequestContext& ctx) {
+    OpusMultiStreamParameters params;
+    if (!ReadMultiStreamParameters(ctx, params)) {
+        LOG_ERROR(Audio, "Invalid multistream parameters");
+        IPC::ResponseBuilder rb{ctx, 2};
+        // TODO(ogniK): Use correct error code
+        rb.Push(ResultCode(-1));
+        return;
+    }
+
+    const u32 worker_buffer_sz = static_cast<u32>(opus_multistream_decoder_get_size(
+        static_cast<int>(params.stream_count), static_cast<int>(params.stereo_stream_count)));
+    LOG_DEBUG(Audio, "called worker_buffer_sz={}", worker_buffer_sz);
+
+    IPC::ResponseBuilder rb{ctx, 3};
+    rb.Push(RESULT_SUCCESS);
+    rb.Push<u32>(worker_buffer_sz);
 }
 
 HwOpus::HwOpus() : ServiceFramework("hwopus") {
     static const FunctionInfo functions[] = {
         {0, &HwOpus::OpenOpusDecoder, "OpenOpusDecoder"},
         {1, &HwOpus::GetWorkBufferSize, "GetWorkBufferSize"},
-        {2, nullptr, "OpenOpusDecoderForMultiStream"},
-        {3, nullptr, "GetWorkBufferSizeForMultiStream"},
+        {2, &HwOpus::OpenOpusDecoderForMultiStream, "OpenOpusDecoderForMultiStream"},
+        {3, &HwOpus::GetWorkBufferSizeForMultiStream, "GetWorkBufferSizeForMultiStream"},
     };
     RegisterHandlers(functions);
 }
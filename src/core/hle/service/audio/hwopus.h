@@ -16,6 +16,8 @@ public:
 private:
     void OpenOpusDecoder(Kernel::HLERequestContext& ctx);
     void GetWorkBufferSize(Kernel::HLERequestContext& ctx);
+    void OpenOpusDecoderForMultiStream(Kernel::HLERequestContext& ctx);
+    void GetWorkBufferSizeForMultiStream(Kernel::HLERequestContext& ctx);
 };
 
 } // namespace Service::Audio
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <mutex>
 #include <utility>
 
 #include "common/assert.h"
@@ -235,6 +236,7 @@ static std::unique_ptr<FileSys::RomFSFactory> romfs_factory;
 static std::unique_ptr<FileSys::SaveDataFactory> save_data_factory;
 static std::unique_ptr<FileSys::SDMCFactory> sdmc_factory;
 static std::unique_ptr<FileSys::BISFactory> bis_factory;
+static FileSys::VirtualDir load_directory;
 
 ResultCode RegisterRomFS(std::unique_ptr<FileSys::RomFSFactory>&& factory) {
     ASSERT_MSG(romfs_factory == nullptr, "Tried to register a second RomFS");
@@ -311,9 +313,20 @@ ResultVal<FileSys::VirtualDir> OpenSDMC() {
 }
 
 std::shared_ptr<FileSys::RegisteredCacheUnion> GetUnionContents() {
-    return std::make_shared<FileSys::RegisteredCacheUnion>(
-        std::vector<std::shared_ptr<FileSys::RegisteredCache>>{
-            GetSystemNANDContents(), GetUserNANDContents(), GetSDMCContents()});
+    // The union keeps its index between calls, it's only recreated when the caches it combines are
+    static std::mutex union_mutex;
+    static std::vector<std::shared_ptr<FileSys::RegisteredCache>> union_caches;
+    static std::shared_ptr<FileSys::RegisteredCacheUnion> union_contents;
+
+    std::vector<std::shared_ptr<FileSys::RegisteredCache>> caches{
+        GetSystemNANDContents(), GetUserNANDContents(), GetSDMCContents()};
+
+    std::lock_guard<std::mutex> lock{union_mutex};
+    if (union_contents == nullptr || caches != union_caches) {
+        union_contents = std::make_shared<FileSys::RegisteredCacheUnion>(caches);
+        union_caches = std::move(caches);
+    }
+    return union_contents;
 }
 
 std::shared_ptr<FileSys::RegisteredCache> GetSystemNANDContents() {
@@ -343,11 +356,21 @@ std::shared_ptr<FileSys::RegisteredCache> GetSDMCContents() {
     return sdmc_factory->GetSDMCContents();
 }
 
+FileSys::VirtualDir GetModificationLoadRoot(u64 title_id) {
+    LOG_TRACE(Service_FS, "Opening mod load root for tid={:016X}", title_id);
+
+    if (load_directory == nullptr)
+        return nullptr;
+
+    return load_directory->GetSubdirectory(fmt::format("{:016X}", title_id));
+}
+
 void CreateFactories(const FileSys::VirtualFilesystem& vfs, bool overwrite) {
     if (overwrite) {
         bis_factory = nullptr;
         save_data_factory = nullptr;
         sdmc_factory = nullptr;
+        load_directory = nullptr;
     }
 
     auto nand_directory = vfs->OpenDirectory(FileUtil::GetUserPath(FileUtil::UserPath::NANDDir),
@@ -361,6 +384,9 @@ void CreateFactories(const FileSys::VirtualFilesystem& vfs, bool overwrite) {
         save_data_factory = std::make_unique<FileSys::SaveDataFactory>(std::move(nand_directory));
     if (sdmc_factory == nullptr)
         sdmc_factory = std::make_unique<FileSys::SDMCFactory>(std::move(sd_directory));
+    if (load_directory == nullptr)
+        load_directory = vfs->OpenDirectory(FileUtil::GetUserPath(FileUtil::UserPath::LoadDir),
+                                            FileSys::Mode::ReadWrite);
 }
 
 void InstallInterfaces(SM::ServiceManager& service_manager, const FileSys::VirtualFilesystem& vfs) {
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cinttypes>
 #include <cstring>
 #include <iterator>
@@ -11,6 +12,7 @@
 
 #include "common/assert.h"
 #include "common/common_types.h"
+#include "common/file_util.h"
 #include "common/logging/log.h"
 #include "common/string_util.h"
 #include "core/file_sys/directory.h"
@@ -19,10 +21,14 @@
 #include "core/file_sys/nca_metadata.h"
 #include "core/file_sys/savedata_factory.h"
 #include "core/file_sys/vfs.h"
+#include "core/file_sys/vfs_offset.h"
+#include "core/file_sys/vfs_read_ahead.h"
+#include "core/file_sys/vfs_write_back.h"
 #include "core/hle/ipc_helpers.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/service/filesystem/filesystem.h"
 #include "core/hle/service/filesystem/fsp_srv.h"
+#include "core/memory.h"
 
 namespace Service::FileSystem {
 
@@ -37,10 +43,70 @@ enum class FileSystemType : u8 {
     ApplicationPackage = 7,
 };
 
+/**
+ * Reads from the file into the output buffer of the request. The data is read in place when the
+ * buffer is contiguous in host memory. Otherwise it is read in place one host contiguous run of
+ * pages at a time, and only the pages without a host pointer go through a bounce buffer.
+ * @returns The number of bytes read
+ */
+static std::size_t ReadToBuffer(Kernel::HLERequestContext& ctx, const FileSys::VfsFile& file,
+                                std::size_t length, std::size_t offset) {
+    const std::size_t buffer_size = ctx.GetWriteBufferSize();
+    if (length > buffer_size) {
+        LOG_ERROR(Service_FS, "Read length ({}) is larger than the output buffer ({})", length,
+                  buffer_size);
+        length = buffer_size;
+    }
+    if (u8* const buffer = ctx.GetWriteBufferPointer()) {
+        return file.Read(buffer, length, offset);
+    }
+
+    // Reused across requests, so that reads into cached pages don't allocate every time
+    constexpr std::size_t MaxBounceSize = 0x40000;
+    thread_local std::vector<u8> bounce_buffer;
+
+    const VAddr address = ctx.GetWriteBufferAddress();
+    std::size_t position = 0;
+    while (position < length) {
+        // Gather the pages that follow with the same kind of access, host contiguous or not
+        const VAddr run_address = address + position;
+        const auto page_length = [&](std::size_t run) {
+            const std::size_t page_offset = (run_address + run) & Memory::PAGE_MASK;
+            return std::min<std::size_t>(Memory::PAGE_SIZE - page_offset, length - position - run);
+        };
+        u8* const pointer = Memory::GetContiguousPointer(run_address, page_length(0));
+        std::size_t run = page_length(0);
+        while (position + run < length) {
+            const std::size_t next = page_length(run);
+            u8* const next_pointer = Memory::GetContiguousPointer(run_address + run, next);
+            if (pointer != nullptr ? next_pointer != pointer + run
+                                   : next_pointer != nullptr || run + next > MaxBounceSize) {
+                break;
+            }
+            run += next;
+        }
+
+        std::size_t read;
+        if (pointer != nullptr) {
+            read = file.Read(pointer, run, offset + position);
+        } else {
+            bounce_buffer.resize(std::max(bounce_buffer.size(), run));
+            read = file.Read(bounce_buffer.data(), run, offset + position);
+            Memory::WriteBlock(run_address, bounce_buffer.data(), read);
+        }
+        position += read;
+        if (read < run) {
+            break;
+        }
+    }
+    return position;
+}
+
 class IStorage final : public ServiceFramework<IStorage> {
 public:
     explicit IStorage(FileSys::VirtualFile backend_)
-        : ServiceFramework("IStorage"), backend(std::move(backend_)) {
+        : ServiceFramework("IStorage"),
+          backend(std::make_shared<FileSys::ReadAheadVfsFile>(std::move(backend_))) {
         static const FunctionInfo functions[] = {
             {0, &IStorage::Read, "Read"}, {1, nullptr, "Write"},   {2, nullptr, "Flush"},
             {3, nullptr, "SetSize"},      {4, nullptr, "GetSize"}, {5, nullptr, "OperateRange"},
@@ -70,10 +136,9 @@ private:
             return;
         }
 
-        // Read the data from the Storage backend
-        std::vector<u8> output = backend->ReadBytes(length, offset);
-        // Write the data to memory
-        ctx.WriteBuffer(output);
+        // Read the data from the Storage backend, straight into the output buffer when possible
+        ReadToBuffer(ctx, *backend, static_cast<std::size_t>(length),
+                     static_cast<std::size_t>(offset));
 
         IPC::ResponseBuilder rb{ctx, 2};
         rb.Push(RESULT_SUCCESS);
@@ -83,7 +148,7 @@ private:
 class IFile final : public ServiceFramework<IFile> {
 public:
     explicit IFile(FileSys::VirtualFile backend_)
-        : ServiceFramework("IFile"), backend(std::move(backend_)) {
+        : ServiceFramework("IFile"), backend(WrapReadOnlyFile(std::move(backend_))) {
         static const FunctionInfo functions[] = {
             {0, &IFile::Read, "Read"},       {1, &IFile::Write, "Write"},
             {2, &IFile::Flush, "Flush"},     {3, &IFile::SetSize, "SetSize"},
@@ -95,6 +160,14 @@ public:
 private:
     FileSys::VirtualFile backend;
 
+    /// Games stream data from read-only files in small chunks, these are read ahead
+    static FileSys::VirtualFile WrapReadOnlyFile(FileSys::VirtualFile file) {
+        if (file->IsWritable()) {
+            return file;
+        }
+        return std::make_shared<FileSys::ReadAheadVfsFile>(std::move(file));
+    }
+
     void Read(Kernel::HLERequestContext& ctx) {
         IPC::RequestParser rp{ctx};
         const u64 unk = rp.Pop<u64>();
@@ -115,15 +188,13 @@ private:
             return;
         }
 
-        // Read the data from the Storage backend
-        std::vector<u8> output = backend->ReadBytes(length, offset);
-
-        // Write the data to memory
-        ctx.WriteBuffer(output);
+        // Read the data from the Storage backend, straight into the output buffer when possible
+        const std::size_t read = ReadToBuffer(ctx, *backend, static_cast<std::size_t>(length),
+                                              static_cast<std::size_t>(offset));
 
         IPC::ResponseBuilder rb{ctx, 4};
         rb.Push(RESULT_SUCCESS);
-        rb.Push(static_cast<u64>(output.size()));
+        rb.Push(static_cast<u64>(read));
     }
 
     void Write(Kernel::HLERequestContext& ctx) {
@@ -146,17 +217,23 @@ private:
             return;
         }
 
-        const std::vector<u8> data = ctx.ReadBuffer();
+        // Write the data to the Storage backend, straight from the input buffer when possible
+        const u8* data = ctx.GetReadBufferPointer();
+        std::vector<u8> buffer;
+        if (data == nullptr) {
+            buffer = ctx.ReadBuffer();
+            data = buffer.data();
+        }
+        const std::size_t data_size = ctx.GetReadBufferSize();
 
         ASSERT_MSG(
-            static_cast<s64>(data.size()) <= length,
+            static_cast<s64>(data_size) <= length,
             "Attempting to write more data than requested (requested={:016X}, actual={:016X}).",
-            length, data.size());
+            length, data_size);
 
-        // Write the data to the Storage backend
-        const auto write_size =
-            static_cast<std::size_t>(std::distance(data.begin(), data.begin() + length));
-        const std::size_t written = backend->Write(data.data(), write_size, offset);
+        const std::size_t written =
+            backend->Write(data, static_cast<std::size_t>(length),
+                     static_cast<std::size_t>(offset));
 
         ASSERT_MSG(static_cast<s64>(written) == length,
                    "Could not write all bytes to file (requested={:016X}, actual={:016X}).", length,
@@ -195,16 +272,6 @@ private:
     }
 };
 
-template <typename T>
-static void BuildEntryIndex(std::vector<FileSys::Entry>& entries, const std::vector<T>& new_data,
-                            FileSys::EntryType type) {
-    entries.reserve(entries.size() + new_data.size());
-
-    for (const auto& new_entry : new_data) {
-        entries.emplace_back(new_entry->GetName(), type, new_entry->GetSize());
-    }
-}
-
 class IDirectory final : public ServiceFramework<IDirectory> {
 public:
     explicit IDirectory(FileSys::VirtualDir backend_)
@@ -216,14 +283,13 @@ public:
         RegisterHandlers(functions);
 
         // TODO(DarkLordZach): Verify that this is the correct behavior.
-        // Build entry index now to save time later.
-        BuildEntryIndex(entries, backend->GetFiles(), FileSys::File);
-        BuildEntryIndex(entries, backend->GetSubdirectories(), FileSys::Directory);
+        // Only list the entries now, their records are built as they are read.
+        listing = backend->GetEntries();
     }
 
 private:
     FileSys::VirtualDir backend;
-    std::vector<FileSys::Entry> entries;
+    std::vector<FileSys::VfsDirectoryEntry> listing;
     u64 next_entry_index = 0;
 
     void Read(Kernel::HLERequestContext& ctx) {
@@ -236,17 +302,23 @@ private:
         const u64 count_entries = ctx.GetWriteBufferSize() / sizeof(FileSys::Entry);
 
         // Cap at total number of entries.
-        const u64 actual_entries = std::min(count_entries, entries.size() - next_entry_index);
-
-        // Determine data start and end
-        const auto* begin = reinterpret_cast<u8*>(entries.data() + next_entry_index);
-        const auto* end = reinterpret_cast<u8*>(entries.data() + next_entry_index + actual_entries);
-        const auto range_size = static_cast<std::size_t>(std::distance(begin, end));
+        const u64 actual_entries = std::min(count_entries, listing.size() - next_entry_index);
+
+        // Build the records of the entries being read
+        std::vector<FileSys::Entry> entries;
+        entries.reserve(actual_entries);
+        for (u64 i = 0; i < actual_entries; ++i) {
+            const auto& entry = listing[next_entry_index + i];
+            const auto type = entry.type == FileSys::VfsEntryType::Directory
+                                  ? FileSys::Directory
+                                  : FileSys::File;
+            entries.emplace_back(entry.name, type, entry.size);
+        }
 
         next_entry_index += actual_entries;
 
         // Write the data to memory
-        ctx.WriteBuffer(begin, range_size);
+        ctx.WriteBuffer(entries);
 
         IPC::ResponseBuilder rb{ctx, 4};
         rb.Push(RESULT_SUCCESS);
@@ -256,7 +328,7 @@ private:
     void GetEntryCount(Kernel::HLERequestContext& ctx) {
         LOG_DEBUG(Service_FS, "called");
 
-        u64 count = entries.size() - next_entry_index;
+        u64 count = listing.size() - next_entry_index;
 
         IPC::ResponseBuilder rb{ctx, 4};
         rb.Push(RESULT_SUCCESS);
@@ -266,8 +338,16 @@ private:
 
 class IFileSystem final : public ServiceFramework<IFileSystem> {
 public:
-    explicit IFileSystem(FileSys::VirtualDir backend)
+    /**
+     * @param write_back Whether to keep the writes to files in memory until the filesystem is
+     *                   committed, used for save data
+     */
+    explicit IFileSystem(FileSys::VirtualDir backend, bool write_back = false)
         : ServiceFramework("IFileSystem"), backend(std::move(backend)) {
+        if (write_back) {
+            write_back_cache = std::make_shared<FileSys::WriteBackCache>();
+        }
+
         static const FunctionInfo functions[] = {
             {0, &IFileSystem::CreateFile, "CreateFile"},
             {1, &IFileSystem::DeleteFile, "DeleteFile"},
@@ -312,6 +392,10 @@ public:
 
         LOG_DEBUG(Service_FS, "called file {}", name);
 
+        if (write_back_cache) {
+            write_back_cache->Discard(GetCachePath(name));
+        }
+
         IPC::ResponseBuilder rb{ctx, 2};
         rb.Push(backend.DeleteFile(name));
     }
@@ -342,6 +426,10 @@ public:
 
         LOG_DEBUG(Service_FS, "called file '{}' to file '{}'", src_name, dst_name);
 
+        if (write_back_cache) {
+            write_back_cache->Release(GetCachePath(src_name));
+        }
+
         IPC::ResponseBuilder rb{ctx, 2};
         rb.Push(backend.RenameFile(src_name, dst_name));
     }
@@ -356,14 +444,24 @@ public:
 
         LOG_DEBUG(Service_FS, "called file {} mode {}", name, static_cast<u32>(mode));
 
-        auto result = backend.OpenFile(name, mode);
+        // Files of a write-back filesystem are opened in full, appending is done on their view
+        auto result = backend.OpenFile(name, write_back_cache ? FileSys::Mode::ReadWrite : mode);
         if (result.Failed()) {
             IPC::ResponseBuilder rb{ctx, 2};
             rb.Push(result.Code());
             return;
         }
 
-        IFile file(result.Unwrap());
+        auto backing_file = result.Unwrap();
+        if (write_back_cache) {
+            backing_file = write_back_cache->Open(GetCachePath(name), std::move(backing_file));
+            if (mode == FileSys::Mode::Append) {
+                const std::size_t size = backing_file->GetSize();
+                backing_file =
+                    std::make_shared<FileSys::OffsetVfsFile>(std::move(backing_file), 0, size);
+            }
+        }
+        IFile file(std::move(backing_file));
 
         IPC::ResponseBuilder rb{ctx, 2, 0, 1};
         rb.Push(RESULT_SUCCESS);
@@ -416,14 +514,27 @@ public:
     }
 
     void Commit(Kernel::HLERequestContext& ctx) {
-        LOG_WARNING(Service_FS, "(STUBBED) called");
+        LOG_DEBUG(Service_FS, "called");
+
+        if (write_back_cache && !write_back_cache->Commit()) {
+            LOG_ERROR(Service_FS, "Some of the files could not be committed");
+        }
 
         IPC::ResponseBuilder rb{ctx, 2};
         rb.Push(RESULT_SUCCESS);
     }
 
 private:
+    /// Gets the path of a file in the write-back cache, so that all the spellings of a path match
+    static std::string GetCachePath(const std::string& name) {
+        std::string path = FileUtil::SanitizePath(name);
+        path.erase(0, path.find_first_not_of("/\\"));
+        return path;
+    }
+
     VfsDirectoryServiceWrapper backend;
+    /// Writes to the files that haven't been committed yet, shared with the moved-from service
+    std::shared_ptr<FileSys::WriteBackCache> write_back_cache;
 };
 
 FSP_SRV::FSP_SRV() : ServiceFramework("fsp-srv") {
@@ -579,7 +690,7 @@ void FSP_SRV::MountSaveData(Kernel::HLERequestContext& ctx) {
         return;
     }
 
-    IFileSystem filesystem(std::move(dir.Unwrap()));
+    IFileSystem filesystem(std::move(dir.Unwrap()), true);
 
     IPC::ResponseBuilder rb{ctx, 2, 0, 1};
     rb.Push(RESULT_SUCCESS);
@@ -22,8 +22,10 @@
 namespace Service::HID {
 
 // Updating period for each HID device.
+// The pads are sampled at 200 Hz like the Switch does, as the delay between two samples adds up
+// to the input latency. The devices are read right before the shared memory is written.
 // TODO(shinyquagsire23): These need better values.
-constexpr u64 pad_update_ticks = CoreTiming::BASE_CLOCK_RATE / 100;
+constexpr u64 pad_update_ticks = CoreTiming::BASE_CLOCK_RATE / 200;
 constexpr u64 accelerometer_update_ticks = CoreTiming::BASE_CLOCK_RATE / 100;
 constexpr u64 gyroscope_update_ticks = CoreTiming::BASE_CLOCK_RATE / 100;
 
@@ -73,13 +75,60 @@ private:
         // TODO(shinyquagsire23): gyro, mouse, keyboard
     }
 
+    /// Reads the state of every pad input once, so all the layouts get the same sample
+    void SamplePadState(ControllerPadState& state, std::array<s32, 4>& joysticks) const {
+        using namespace Settings::NativeButton;
+        state.a.Assign(buttons[A - BUTTON_HID_BEGIN]->GetStatus());
+        state.b.Assign(buttons[B - BUTTON_HID_BEGIN]->GetStatus());
+        state.x.Assign(buttons[X - BUTTON_HID_BEGIN]->GetStatus());
+        state.y.Assign(buttons[Y - BUTTON_HID_BEGIN]->GetStatus());
+        state.lstick.Assign(buttons[LStick - BUTTON_HID_BEGIN]->GetStatus());
+        state.rstick.Assign(buttons[RStick - BUTTON_HID_BEGIN]->GetStatus());
+        state.l.Assign(buttons[L - BUTTON_HID_BEGIN]->GetStatus());
+        state.r.Assign(buttons[R - BUTTON_HID_BEGIN]->GetStatus());
+        state.zl.Assign(buttons[ZL - BUTTON_HID_BEGIN]->GetStatus());
+        state.zr.Assign(buttons[ZR - BUTTON_HID_BEGIN]->GetStatus());
+        state.plus.Assign(buttons[Plus - BUTTON_HID_BEGIN]->GetStatus());
+        state.minus.Assign(buttons[Minus - BUTTON_HID_BEGIN]->GetStatus());
+
+        state.dleft.Assign(buttons[DLeft - BUTTON_HID_BEGIN]->GetStatus());
+        state.dup.Assign(buttons[DUp - BUTTON_HID_BEGIN]->GetStatus());
+        state.dright.Assign(buttons[DRight - BUTTON_HID_BEGIN]->GetStatus());
+        state.ddown.Assign(buttons[DDown - BUTTON_HID_BEGIN]->GetStatus());
+
+        state.lstick_left.Assign(buttons[LStick_Left - BUTTON_HID_BEGIN]->GetStatus());
+        state.lstick_up.Assign(buttons[LStick_Up - BUTTON_HID_BEGIN]->GetStatus());
+        state.lstick_right.Assign(buttons[LStick_Right - BUTTON_HID_BEGIN]->GetStatus());
+        state.lstick_down.Assign(buttons[LStick_Down - BUTTON_HID_BEGIN]->GetStatus());
+
+        state.rstick_left.Assign(buttons[RStick_Left - BUTTON_HID_BEGIN]->GetStatus());
+        state.rstick_up.Assign(buttons[RStick_Up - BUTTON_HID_BEGIN]->GetStatus());
+        state.rstick_right.Assign(buttons[RStick_Right - BUTTON_HID_BEGIN]->GetStatus());
+        state.rstick_down.Assign(buttons[RStick_Down - BUTTON_HID_BEGIN]->GetStatus());
+
+        state.sl.Assign(buttons[SL - BUTTON_HID_BEGIN]->GetStatus());
+        state.sr.Assign(buttons[SR - BUTTON_HID_BEGIN]->GetStatus());
+
+        const auto [stick_l_x_f, stick_l_y_f] = sticks[Joystick_Left]->GetStatus();
+        const auto [stick_r_x_f, stick_r_y_f] = sticks[Joystick_Right]->GetStatus();
+        joysticks[0] = static_cast<s32>(stick_l_x_f * HID_JOYSTICK_MAX);
+        joysticks[1] = static_cast<s32>(stick_l_y_f * HID_JOYSTICK_MAX);
+        joysticks[2] = static_cast<s32>(stick_r_x_f * HID_JOYSTICK_MAX);
+        joysticks[3] = static_cast<s32>(stick_r_y_f * HID_JOYSTICK_MAX);
+    }
+
     void UpdatePadCallback(u64 userdata, int cycles_late) {
-        SharedMemory mem{};
-        std::memcpy(&mem, shared_mem->GetPointer(), sizeof(SharedMemory));
+        // Only the newest entry of each ring changes, so the shared memory is updated in place
+        // rather than copied out and back in whole
+        SharedMemory& mem = *reinterpret_cast<SharedMemory*>(shared_mem->GetPointer());
 
         if (Settings::values.is_device_reload_pending.exchange(false))
             LoadInputDevices();
 
+        ControllerPadState pad_state{};
+        std::array<s32, 4> joysticks{};
+        SamplePadState(pad_state, joysticks);
+
         // Set up controllers as neon red+blue Joy-Con attached to console
         ControllerHeader& controller_header = mem.controllers[Controller_Handheld].header;
         controller_header.type = ControllerType_Handheld;
@@ -115,45 +164,11 @@ private:
                 // TODO(shinyquagsire23): Set up some LUTs for each layout mapping in the future?
                 // For now everything is just the default handheld layout, but split Joy-Con will
                 // rotate the face buttons and directions for certain layouts.
-                ControllerPadState& state = entry.buttons;
-                using namespace Settings::NativeButton;
-                state.a.Assign(buttons[A - BUTTON_HID_BEGIN]->GetStatus());
-                state.b.Assign(buttons[B - BUTTON_HID_BEGIN]->GetStatus());
-                state.x.Assign(buttons[X - BUTTON_HID_BEGIN]->GetStatus());
-                state.y.Assign(buttons[Y - BUTTON_HID_BEGIN]->GetStatus());
-                state.lstick.Assign(buttons[LStick - BUTTON_HID_BEGIN]->GetStatus());
-                state.rstick.Assign(buttons[RStick - BUTTON_HID_BEGIN]->GetStatus());
-                state.l.Assign(buttons[L - BUTTON_HID_BEGIN]->GetStatus());
-                state.r.Assign(buttons[R - BUTTON_HID_BEGIN]->GetStatus());
-                state.zl.Assign(buttons[ZL - BUTTON_HID_BEGIN]->GetStatus());
-                state.zr.Assign(buttons[ZR - BUTTON_HID_BEGIN]->GetStatus());
-                state.plus.Assign(buttons[Plus - BUTTON_HID_BEGIN]->GetStatus());
-                state.minus.Assign(buttons[Minus - BUTTON_HID_BEGIN]->GetStatus());
-
-                state.dleft.Assign(buttons[DLeft - BUTTON_HID_BEGIN]->GetStatus());
-                state.dup.Assign(buttons[DUp - BUTTON_HID_BEGIN]->GetStatus());
-                state.dright.Assign(buttons[DRight - BUTTON_HID_BEGIN]->GetStatus());
-                state.ddown.Assign(buttons[DDown - BUTTON_HID_BEGIN]->GetStatus());
-
-                state.lstick_left.Assign(buttons[LStick_Left - BUTTON_HID_BEGIN]->GetStatus());
-                state.lstick_up.Assign(buttons[LStick_Up - BUTTON_HID_BEGIN]->GetStatus());
-                state.lstick_right.Assign(buttons[LStick_Right - BUTTON_HID_BEGIN]->GetStatus());
-                state.lstick_down.Assign(buttons[LStick_Down - BUTTON_HID_BEGIN]->GetStatus());
-
-                state.rstick_left.Assign(buttons[RStick_Left - BUTTON_HID_BEGIN]->GetStatus());
-                state.rstick_up.Assign(buttons[RStick_Up - BUTTON_HID_BEGIN]->GetStatus());
-                state.rstick_right.Assign(buttons[RStick_Right - BUTTON_HID_BEGIN]->GetStatus());
-                state.rstick_down.Assign(buttons[RStick_Down - BUTTON_HID_BEGIN]->GetStatus());
-
-                state.sl.Assign(buttons[SL - BUTTON_HID_BEGIN]->GetStatus());
-                state.sr.Assign(buttons[SR - BUTTON_HID_BEGIN]->GetStatus());
-
-                const auto [stick_l_x_f, stick_l_y_f] = sticks[Joystick_Left]->GetStatus();
-                const auto [stick_r_x_f, stick_r_y_f] = sticks[Joystick_Right]->GetStatus();
-                entry.joystick_left_x = static_cast<s32>(stick_l_x_f * HID_JOYSTICK_MAX);
-                entry.joystick_left_y = static_cast<s32>(stick_l_y_f * HID_JOYSTICK_MAX);
-                entry.joystick_right_x = static_cast<s32>(stick_r_x_f * HID_JOYSTICK_MAX);
-                entry.joystick_right_y = static_cast<s32>(stick_r_y_f * HID_JOYSTICK_MAX);
+                entry.buttons.hex = pad_state.hex;
+                entry.joystick_left_x = joysticks[0];
+                entry.joystick_left_y = joysticks[1];
+                entry.joystick_right_x = joysticks[2];
+                entry.joystick_right_y = joysticks[3];
             }
         }
 
@@ -253,8 +268,6 @@ private:
 
         // TODO(shinyquagsire23): Signal events
 
-        std::memcpy(shared_mem->GetPointer(), &mem, sizeof(SharedMemory));
-
         // Reschedule recurrent event
         CoreTiming::ScheduleEvent(pad_update_ticks - cycles_late, pad_update_event);
     }
@@ -6,6 +6,7 @@
 #include "core/hle/kernel/hle_ipc.h"
 #include "core/hle/service/ns/ns.h"
 #include "core/hle/service/ns/pl_u.h"
+#include "core/hle/service/sm/sm.h"
 
 namespace Service::NS {
 
@@ -445,17 +446,17 @@ public:
 };
 
 void InstallInterfaces(SM::ServiceManager& service_manager) {
-    std::make_shared<NS>("ns:am2")->InstallAsService(service_manager);
-    std::make_shared<NS>("ns:ec")->InstallAsService(service_manager);
-    std::make_shared<NS>("ns:rid")->InstallAsService(service_manager);
-    std::make_shared<NS>("ns:rt")->InstallAsService(service_manager);
-    std::make_shared<NS>("ns:web")->InstallAsService(service_manager);
+    service_manager.InstallLazyService<NS>("ns:am2", "ns:am2");
+    service_manager.InstallLazyService<NS>("ns:ec", "ns:ec");
+    service_manager.InstallLazyService<NS>("ns:rid", "ns:rid");
+    service_manager.InstallLazyService<NS>("ns:rt", "ns:rt");
+    service_manager.InstallLazyService<NS>("ns:web", "ns:web");
 
-    std::make_shared<NS_DEV>()->InstallAsService(service_manager);
-    std::make_shared<NS_SU>()->InstallAsService(service_manager);
-    std::make_shared<NS_VM>()->InstallAsService(service_manager);
+    service_manager.InstallLazyService<NS_DEV>("ns:dev");
+    service_manager.InstallLazyService<NS_SU>("ns:su");
+    service_manager.InstallLazyService<NS_VM>("ns:vm");
 
-    std::make_shared<PL_U>()->InstallAsService(service_manager);
+    service_manager.InstallLazyService<PL_U>("pl:u");
 }
 
 } // namespace Service::NS
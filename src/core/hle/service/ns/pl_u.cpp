@@ -3,8 +3,11 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
 #include <cstring>
 #include <vector>
+#include <boost/optional.hpp>
+#include <mbedtls/sha256.h>
 
 #include <FontChineseSimplified.h>
 #include <FontChineseTraditional.h>
@@ -14,6 +17,7 @@
 #include <FontStandard.h>
 
 #include "common/assert.h"
+#include "common/common_funcs.h"
 #include "common/common_paths.h"
 #include "common/common_types.h"
 #include "common/file_util.h"
@@ -72,29 +76,50 @@ constexpr u32 EXPECTED_MAGIC{0x36f81a1e};  // What we expect the encrypted bfttf
 constexpr u64 SHARED_FONT_MEM_SIZE{0x1100000};
 constexpr FontRegion EMPTY_REGION{0, 0};
 
+/// Identifies the system archives a cached copy of the decrypted shared fonts was built from
+using SharedFontCacheKey = std::array<u8, 0x20>;
+
+struct SharedFontCacheHeader {
+    u32_le magic;
+    u32_le num_regions;
+    SharedFontCacheKey key;
+};
+static_assert(sizeof(SharedFontCacheHeader) == 0x28, "SharedFontCacheHeader has incorrect size.");
+
+constexpr u32 SHARED_FONT_CACHE_MAGIC{Common::MakeMagic('Y', 'S', 'F', 'C')};
+
 enum class LoadState : u32 {
     Loading = 0,
     Done = 1,
 };
 
-static void DecryptSharedFont(const std::vector<u32>& input, std::vector<u8>& output,
-                              std::size_t& offset) {
-    ASSERT_MSG(offset + (input.size() * sizeof(u32)) < SHARED_FONT_MEM_SIZE,
-               "Shared fonts exceeds 17mb!");
-    ASSERT_MSG(input[0] == EXPECTED_MAGIC, "Failed to derive key, unexpected magic number");
-
-    const u32 KEY = input[0] ^ EXPECTED_RESULT; // Derive key using an inverse xor
-    std::vector<u32> transformed_font(input.size());
-    // TODO(ogniK): Figure out a better way to do this
-    std::transform(input.begin(), input.end(), transformed_font.begin(),
-                   [&KEY](u32 font_data) { return Common::swap32(font_data ^ KEY); });
-    transformed_font[1] = Common::swap32(transformed_font[1]) ^ KEY; // "re-encrypt" the size
-    std::memcpy(output.data() + offset, transformed_font.data(),
-                transformed_font.size() * sizeof(u32));
-    offset += transformed_font.size() * sizeof(u32);
+// Decrypts a shared font read from the system archives in place. The data is kept as read, little
+// endian, so the byte swaps around the big endian xor key cancel out into a single xor per word.
+static void DecryptSharedFont(u8* data, std::size_t size) {
+    const std::size_t num_words = size / sizeof(u32);
+    u32 magic;
+    std::memcpy(&magic, data, sizeof(u32));
+    ASSERT_MSG(Common::swap32(magic) == EXPECTED_MAGIC,
+               "Failed to derive key, unexpected magic number");
+
+    const u32 KEY = Common::swap32(Common::swap32(magic) ^ EXPECTED_RESULT);
+    u32 size_word;
+    std::memcpy(&size_word, data + sizeof(u32), sizeof(u32));
+
+    // Kept as a simple loop over whole words so the compiler can vectorize it
+    for (std::size_t i = 0; i < num_words; ++i) {
+        u32 word;
+        std::memcpy(&word, data + i * sizeof(u32), sizeof(u32));
+        word ^= KEY;
+        std::memcpy(data + i * sizeof(u32), &word, sizeof(u32));
+    }
+
+    // The size is left "encrypted", as it is on hardware
+    size_word = Common::swap32(size_word);
+    std::memcpy(data + sizeof(u32), &size_word, sizeof(u32));
 }
 
-static void EncryptSharedFont(const std::vector<u8>& input, std::vector<u8>& output,
+static void EncryptSharedFont(const std::vector<u8>& input, Common::DemandZeroBuffer& output,
                               std::size_t& offset) {
     ASSERT_MSG(offset + input.size() + 8 < SHARED_FONT_MEM_SIZE, "Shared fonts exceeds 17mb!");
     const u32 KEY = EXPECTED_MAGIC ^ EXPECTED_RESULT;
@@ -105,6 +130,24 @@ static void EncryptSharedFont(const std::vector<u8>& input, std::vector<u8>& out
     offset += input.size() + (sizeof(u32) * 2);
 }
 
+// NCA IDs are the start of the SHA-256 of the whole NCA, so together they identify the exact font
+// data without reading any of it.
+static boost::optional<SharedFontCacheKey> GetSharedFontCacheKey(
+    const FileSys::RegisteredCache& nand) {
+    std::vector<u8> ids;
+    for (const auto& font : SHARED_FONTS) {
+        const auto id = nand.GetEntryNcaID(static_cast<u64>(font.first),
+                                           FileSys::ContentRecordType::Data);
+        if (id == boost::none)
+            return boost::none;
+        ids.insert(ids.end(), id->begin(), id->end());
+    }
+
+    SharedFontCacheKey key;
+    mbedtls_sha256(ids.data(), ids.size(), key.data(), 0);
+    return key;
+}
+
 // Helper function to make BuildSharedFontsRawRegions a bit nicer
 static u32 GetU32Swapped(const u8* data) {
     u32 value;
@@ -121,7 +164,7 @@ struct PL_U::Impl {
         return shared_font_regions.at(index);
     }
 
-    void BuildSharedFontsRawRegions(const std::vector<u8>& input) {
+    void BuildSharedFontsRawRegions(const Common::DemandZeroBuffer& input) {
         // As we can derive the xor key we can just populate the offsets
         // based on the shared memory dump
         unsigned cur_offset = 0;
@@ -140,11 +183,67 @@ struct PL_U::Impl {
         }
     }
 
+    bool LoadSharedFontCache(const std::string& path, const SharedFontCacheKey& key) {
+        FileUtil::IOFile file(path, "rb");
+        if (!file.IsOpen())
+            return false;
+
+        SharedFontCacheHeader header{};
+        if (file.ReadBytes(&header, sizeof(header)) != sizeof(header) ||
+            header.magic != SHARED_FONT_CACHE_MAGIC || header.key != key ||
+            header.num_regions > SHARED_FONTS.size()) {
+            return false;
+        }
+
+        std::vector<FontRegion> regions(header.num_regions);
+        const std::size_t regions_size = regions.size() * sizeof(FontRegion);
+        if (file.ReadBytes(regions.data(), regions_size) != regions_size)
+            return false;
+
+        const std::size_t data_size = file.GetSize() - sizeof(header) - regions_size;
+        if (data_size > SHARED_FONT_MEM_SIZE)
+            return false;
+        if (file.ReadBytes(shared_font->data(), data_size) != data_size) {
+            std::fill(shared_font->begin(), shared_font->end(), 0);
+            return false;
+        }
+
+        shared_font_regions = std::move(regions);
+        return true;
+    }
+
+    void WriteSharedFontCache(const std::string& path, const SharedFontCacheKey& key) const {
+        if (shared_font_regions.empty())
+            return;
+
+        if (!FileUtil::CreateFullPath(path)) {
+            LOG_ERROR(Service_NS, "Failed to create shared font cache path \"{}\"!", path);
+            return;
+        }
+
+        FileUtil::IOFile file(path, "wb");
+        if (!file.IsOpen()) {
+            LOG_WARNING(Service_NS, "Unable to write shared font cache \"{}\"", path);
+            return;
+        }
+
+        // Only the used part of the shared memory is stored, the rest is left zeroed
+        const auto& last_region = shared_font_regions.back();
+        const std::size_t data_size = last_region.offset + last_region.size;
+
+        const SharedFontCacheHeader header{SHARED_FONT_CACHE_MAGIC,
+                                           static_cast<u32>(shared_font_regions.size()), key};
+        file.WriteBytes(&header, sizeof(header));
+        file.WriteBytes(shared_font_regions.data(),
+                        shared_font_regions.size() * sizeof(FontRegion));
+        file.WriteBytes(shared_font->data(), data_size);
+    }
+
     /// Handle to shared memory region designated for a shared font
     Kernel::SharedPtr<Kernel::SharedMemory> shared_font_mem;
 
     /// Backing memory for the shared font data
-    std::shared_ptr<std::vector<u8>> shared_font;
+    std::shared_ptr<Common::DemandZeroBuffer> shared_font;
 
     // Automatically populated based on shared_fonts dump or system archives.
     std::vector<FontRegion> shared_font_regions;
@@ -166,7 +265,16 @@ PL_U::PL_U() : ServiceFramework("pl:u"), impl{std::make_unique<Impl>()} {
     // Rebuild shared fonts from data ncas
     if (nand->HasEntry(static_cast<u64>(FontArchives::Standard),
                        FileSys::ContentRecordType::Data)) {
-        impl->shared_font = std::make_shared<std::vector<u8>>(SHARED_FONT_MEM_SIZE);
+        impl->shared_font = std::make_shared<Common::DemandZeroBuffer>(SHARED_FONT_MEM_SIZE);
+
+        const std::string cache_path =
+            FileUtil::GetUserPath(FileUtil::UserPath::CacheDir) + SHARED_FONT_CACHE;
+        const auto cache_key = GetSharedFontCacheKey(*nand);
+        if (cache_key && impl->LoadSharedFontCache(cache_path, *cache_key)) {
+            LOG_DEBUG(Service_NS, "Loaded shared fonts from cache");
+            return;
+        }
+
         for (auto font : SHARED_FONTS) {
             const auto nca =
                 nand->GetEntry(static_cast<u64>(font.first), FileSys::ContentRecordType::Data);
@@ -193,21 +301,26 @@ PL_U::PL_U() : ServiceFramework("pl:u"), impl{std::make_unique<Impl>()} {
                           static_cast<u64>(font.first), font.second);
                 continue;
             }
-            std::vector<u32> font_data_u32(font_fp->GetSize() / sizeof(u32));
-            font_fp->ReadBytes<u32>(font_data_u32.data(), font_fp->GetSize());
-            // We need to be BigEndian as u32s for the xor encryption
-            std::transform(font_data_u32.begin(), font_data_u32.end(), font_data_u32.begin(),
-                           Common::swap32);
-            FontRegion region{
-                static_cast<u32>(offset + 8),
-                static_cast<u32>((font_data_u32.size() * sizeof(u32)) -
-                                 8)}; // Font offset and size do not account for the header
-            DecryptSharedFont(font_data_u32, *impl->shared_font, offset);
-            impl->shared_font_regions.push_back(region);
+
+            // Only whole words are decrypted
+            const std::size_t font_size = font_fp->GetSize() / sizeof(u32) * sizeof(u32);
+            ASSERT_MSG(offset + font_size < SHARED_FONT_MEM_SIZE, "Shared fonts exceeds 17mb!");
+            u8* const font_data = impl->shared_font->data() + offset;
+            font_fp->Read(font_data, font_size);
+            DecryptSharedFont(font_data, font_size);
+
+            // Font offset and size do not account for the header
+            impl->shared_font_regions.push_back(
+                FontRegion{static_cast<u32>(offset + 8), static_cast<u32>(font_size - 8)});
+            offset += font_size;
+        }
+
+        if (cache_key) {
+            impl->WriteSharedFontCache(cache_path, *cache_key);
         }
 
     } else {
-        impl->shared_font = std::make_shared<std::vector<u8>>(
+        impl->shared_font = std::make_shared<Common::DemandZeroBuffer>(
             SHARED_FONT_MEM_SIZE); // Shared memory needs to always be allocated and a fixed size
 
         const std::string user_path = FileUtil::GetUserPath(FileUtil::UserPath::SysDataDir);
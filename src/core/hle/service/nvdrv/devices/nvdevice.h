@@ -4,13 +4,40 @@
 
 #pragma once
 
-#include <vector>
+#include <cstddef>
 #include "common/bit_field.h"
 #include "common/common_types.h"
 #include "common/swap.h"
 
 namespace Service::Nvidia::Devices {
 
+/// A view of the input or output buffer of an ioctl, which usually points straight into the guest
+/// memory of the request.
+template <typename T>
+class IoctlBuffer {
+public:
+    constexpr IoctlBuffer(T* data, std::size_t size) : buffer_data(data), buffer_size(size) {}
+
+    constexpr T* data() const {
+        return buffer_data;
+    }
+
+    constexpr std::size_t size() const {
+        return buffer_size;
+    }
+
+    constexpr T& operator[](std::size_t index) const {
+        return buffer_data[index];
+    }
+
+private:
+    T* buffer_data;
+    std::size_t buffer_size;
+};
+
+using InputBuffer = IoctlBuffer<const u8>;
+using OutputBuffer = IoctlBuffer<u8>;
+
 /// Represents an abstract nvidia device node. It is to be subclassed by concrete device nodes to
 /// implement the ioctl interface.
 class nvdevice {
@@ -33,7 +60,7 @@ public:
      * @param output A buffer where the output data will be written to.
      * @returns The result code of the ioctl.
      */
-    virtual u32 ioctl(Ioctl command, const std::vector<u8>& input, std::vector<u8>& output) = 0;
+    virtual u32 ioctl(Ioctl command, InputBuffer input, OutputBuffer output) = 0;
 };
 
 } // namespace Service::Nvidia::Devices
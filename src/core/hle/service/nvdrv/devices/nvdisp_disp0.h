@@ -20,12 +20,13 @@ public:
     explicit nvdisp_disp0(std::shared_ptr<nvmap> nvmap_dev);
     ~nvdisp_disp0();
 
-    u32 ioctl(Ioctl command, const std::vector<u8>& input, std::vector<u8>& output) override;
+    u32 ioctl(Ioctl command, InputBuffer input, OutputBuffer output) override;
 
-    /// Performs a screen flip, drawing the buffer pointed to by the handle.
-    void flip(u32 buffer_handle, u32 offset, u32 format, u32 width, u32 height, u32 stride,
-              NVFlinger::BufferQueue::BufferTransformFlags transform,
-              const MathUtil::Rectangle<int>& crop_rect);
+    /// Performs a screen flip, drawing the buffer pointed to by the handle. Returns the GPU fence
+    /// signaled once the buffer has been read.
+    u64 flip(u32 buffer_handle, u32 offset, u32 format, u32 width, u32 height, u32 stride,
+             NVFlinger::BufferQueue::BufferTransformFlags transform,
+             const MathUtil::Rectangle<int>& crop_rect);
 
 private:
     std::shared_ptr<nvmap> nvmap_dev;
@@ -2,19 +2,25 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <chrono>
 #include <cstdlib>
 #include <cstring>
 
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "core/core.h"
 #include "core/hle/service/nvdrv/devices/nvhost_ctrl.h"
+#include "video_core/gpu.h"
 
 namespace Service::Nvidia::Devices {
 
+constexpr u32 NvResultBadParameter = 0x4;
+constexpr u32 NvResultTimeout = 0x5;
+
 nvhost_ctrl::nvhost_ctrl() = default;
 nvhost_ctrl::~nvhost_ctrl() = default;
 
-u32 nvhost_ctrl::ioctl(Ioctl command, const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvhost_ctrl::ioctl(Ioctl command, InputBuffer input, OutputBuffer output) {
     LOG_DEBUG(Service_NVDRV, "called, command=0x{:08X}, input_size=0x{:X}, output_size=0x{:X}",
               command.raw, input.size(), output.size());
 
@@ -32,7 +38,7 @@ u32 nvhost_ctrl::ioctl(Ioctl command, const std::vector<u8>& input, std::vector<
     return 0;
 }
 
-u32 nvhost_ctrl::NvOsGetConfigU32(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvhost_ctrl::NvOsGetConfigU32(InputBuffer input, OutputBuffer output) {
     IocGetConfigParams params{};
     std::memcpy(&params, input.data(), sizeof(params));
     LOG_TRACE(Service_NVDRV, "called, setting={}!{}", params.domain_str.data(),
@@ -40,21 +46,30 @@ u32 nvhost_ctrl::NvOsGetConfigU32(const std::vector<u8>& input, std::vector<u8>&
     return 0x30006; // Returns error on production mode
 }
 
-u32 nvhost_ctrl::IocCtrlEventWait(const std::vector<u8>& input, std::vector<u8>& output,
-                                  bool is_async) {
+u32 nvhost_ctrl::IocCtrlEventWait(InputBuffer input, OutputBuffer output, bool is_async) {
     IocCtrlEventWaitParams params{};
     std::memcpy(&params, input.data(), sizeof(params));
-    LOG_WARNING(Service_NVDRV,
-                "(STUBBED) called, syncpt_id={}, threshold={}, timeout={}, is_async={}",
-                params.syncpt_id, params.threshold, params.timeout, is_async);
+    LOG_DEBUG(Service_NVDRV, "called, syncpt_id={}, threshold={}, timeout={}, is_async={}",
+              params.syncpt_id, params.threshold, params.timeout, is_async);
+
+    auto& gpu = Core::System::GetInstance().GPU();
+    if (params.syncpt_id >= Tegra::GPU::NumSyncPoints) {
+        LOG_ERROR(Service_NVDRV, "Invalid syncpoint {}", params.syncpt_id);
+        return NvResultBadParameter;
+    }
 
-    // TODO(Subv): Implement actual syncpt waiting.
-    params.value = 0;
+    // The wait blocks the guest thread on the host, the GPU thread signals the syncpoint once the
+    // submissions before the increment have been processed. A negative timeout waits forever.
+    const auto timeout = params.timeout < 0 ? std::chrono::milliseconds::max()
+                                            : std::chrono::milliseconds(params.timeout);
+    const bool reached = gpu.WaitForSyncPoint(params.syncpt_id, params.threshold, timeout);
+
+    params.value = gpu.GetSyncPointValue(params.syncpt_id);
     std::memcpy(output.data(), &params, sizeof(params));
-    return 0;
+    return reached ? 0 : NvResultTimeout;
 }
 
-u32 nvhost_ctrl::IocCtrlEventRegister(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvhost_ctrl::IocCtrlEventRegister(InputBuffer input, OutputBuffer output) {
     LOG_WARNING(Service_NVDRV, "(STUBBED) called");
     // TODO(bunnei): Implement this.
     return 0;
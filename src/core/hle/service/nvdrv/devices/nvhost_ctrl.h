@@ -16,7 +16,7 @@ public:
     nvhost_ctrl();
     ~nvhost_ctrl() override;
 
-    u32 ioctl(Ioctl command, const std::vector<u8>& input, std::vector<u8>& output) override;
+    u32 ioctl(Ioctl command, InputBuffer input, OutputBuffer output) override;
 
 private:
     enum class IoctlCommand : u32_le {
@@ -130,11 +130,11 @@ private:
     };
     static_assert(sizeof(IocCtrlEventKill) == 8, "IocCtrlEventKill is incorrect size");
 
-    u32 NvOsGetConfigU32(const std::vector<u8>& input, std::vector<u8>& output);
+    u32 NvOsGetConfigU32(InputBuffer input, OutputBuffer output);
 
-    u32 IocCtrlEventWait(const std::vector<u8>& input, std::vector<u8>& output, bool is_async);
+    u32 IocCtrlEventWait(InputBuffer input, OutputBuffer output, bool is_async);
 
-    u32 IocCtrlEventRegister(const std::vector<u8>& input, std::vector<u8>& output);
+    u32 IocCtrlEventRegister(InputBuffer input, OutputBuffer output);
 };
 
 } // namespace Service::Nvidia::Devices
@@ -2,7 +2,9 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <cstdint>
 #include <cstring>
+#include <utility>
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "core/core.h"
@@ -17,7 +19,7 @@ namespace Service::Nvidia::Devices {
 nvhost_gpu::nvhost_gpu(std::shared_ptr<nvmap> nvmap_dev) : nvmap_dev(std::move(nvmap_dev)) {}
 nvhost_gpu::~nvhost_gpu() = default;
 
-u32 nvhost_gpu::ioctl(Ioctl command, const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvhost_gpu::ioctl(Ioctl command, InputBuffer input, OutputBuffer output) {
     LOG_DEBUG(Service_NVDRV, "called, command=0x{:08X}, input_size=0x{:X}, output_size=0x{:X}",
               command.raw, input.size(), output.size());
 
@@ -57,7 +59,7 @@ u32 nvhost_gpu::ioctl(Ioctl command, const std::vector<u8>& input, std::vector<u
     return 0;
 };
 
-u32 nvhost_gpu::SetNVMAPfd(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvhost_gpu::SetNVMAPfd(InputBuffer input, OutputBuffer output) {
     IoctlSetNvmapFD params{};
     std::memcpy(&params, input.data(), input.size());
     LOG_DEBUG(Service_NVDRV, "called, fd={}", params.nvmap_fd);
@@ -65,7 +67,7 @@ u32 nvhost_gpu::SetNVMAPfd(const std::vector<u8>& input, std::vector<u8>& output
     return 0;
 }
 
-u32 nvhost_gpu::SetClientData(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvhost_gpu::SetClientData(InputBuffer input, OutputBuffer output) {
     LOG_DEBUG(Service_NVDRV, "called");
     IoctlClientData params{};
     std::memcpy(&params, input.data(), input.size());
@@ -73,7 +75,7 @@ u32 nvhost_gpu::SetClientData(const std::vector<u8>& input, std::vector<u8>& out
     return 0;
 }
 
-u32 nvhost_gpu::GetClientData(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvhost_gpu::GetClientData(InputBuffer input, OutputBuffer output) {
     LOG_DEBUG(Service_NVDRV, "called");
     IoctlClientData params{};
     std::memcpy(&params, input.data(), input.size());
@@ -82,7 +84,7 @@ u32 nvhost_gpu::GetClientData(const std::vector<u8>& input, std::vector<u8>& out
     return 0;
 }
 
-u32 nvhost_gpu::ZCullBind(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvhost_gpu::ZCullBind(InputBuffer input, OutputBuffer output) {
     std::memcpy(&zcull_params, input.data(), input.size());
     LOG_DEBUG(Service_NVDRV, "called, gpu_va={:X}, mode={:X}", zcull_params.gpu_va,
               zcull_params.mode);
@@ -90,7 +92,7 @@ u32 nvhost_gpu::ZCullBind(const std::vector<u8>& input, std::vector<u8>& output)
     return 0;
 }
 
-u32 nvhost_gpu::SetErrorNotifier(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvhost_gpu::SetErrorNotifier(InputBuffer input, OutputBuffer output) {
     IoctlSetErrorNotifier params{};
     std::memcpy(&params, input.data(), input.size());
     LOG_WARNING(Service_NVDRV, "(STUBBED) called, offset={:X}, size={:X}, mem={:X}", params.offset,
@@ -99,13 +101,13 @@ u32 nvhost_gpu::SetErrorNotifier(const std::vector<u8>& input, std::vector<u8>&
     return 0;
 }
 
-u32 nvhost_gpu::SetChannelPriority(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvhost_gpu::SetChannelPriority(InputBuffer input, OutputBuffer output) {
     std::memcpy(&channel_priority, input.data(), input.size());
     LOG_DEBUG(Service_NVDRV, "(STUBBED) called, priority={:X}", channel_priority);
     return 0;
 }
 
-u32 nvhost_gpu::AllocGPFIFOEx2(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvhost_gpu::AllocGPFIFOEx2(InputBuffer input, OutputBuffer output) {
     IoctlAllocGpfifoEx2 params{};
     std::memcpy(&params, input.data(), input.size());
     LOG_WARNING(Service_NVDRV,
@@ -113,13 +115,14 @@ u32 nvhost_gpu::AllocGPFIFOEx2(const std::vector<u8>& input, std::vector<u8>& ou
                 "unk1={:X}, unk2={:X}, unk3={:X}",
                 params.num_entries, params.flags, params.unk0, params.unk1, params.unk2,
                 params.unk3);
-    params.fence_out.id = 0;
-    params.fence_out.value = 0;
+    params.fence_out.id = ChannelSyncPointId;
+    params.fence_out.value =
+        Core::System::GetInstance().GPU().GetSyncPointValue(ChannelSyncPointId);
     std::memcpy(output.data(), &params, output.size());
     return 0;
 }
 
-u32 nvhost_gpu::AllocateObjectContext(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvhost_gpu::AllocateObjectContext(InputBuffer input, OutputBuffer output) {
     IoctlAllocObjCtx params{};
     std::memcpy(&params, input.data(), input.size());
     LOG_WARNING(Service_NVDRV, "(STUBBED) called, class_num={:X}, flags={:X}", params.class_num,
@@ -129,7 +132,26 @@ u32 nvhost_gpu::AllocateObjectContext(const std::vector<u8>& input, std::vector<
     return 0;
 }
 
-u32 nvhost_gpu::SubmitGPFIFO(const std::vector<u8>& input, std::vector<u8>& output) {
+void nvhost_gpu::PushGPUEntries(const u8* entries, std::size_t num_entries) {
+    auto& gpu = Core::System::GetInstance().GPU();
+    if (reinterpret_cast<std::uintptr_t>(entries) % alignof(Tegra::CommandListHeader) == 0) {
+        gpu.PushGPUEntries(reinterpret_cast<const Tegra::CommandListHeader*>(entries), num_entries);
+        return;
+    }
+
+    std::vector<Tegra::CommandListHeader> entries_copy(num_entries);
+    std::memcpy(entries_copy.data(), entries, num_entries * sizeof(Tegra::CommandListHeader));
+    gpu.PushGPUEntries(std::move(entries_copy));
+}
+
+nvhost_gpu::IoctlFence nvhost_gpu::IncrementChannelSyncPoint() {
+    // Command lists are processed in submission order, so the fence of the last one submitted
+    // is signaled once all of them have been processed
+    const u32 value{Core::System::GetInstance().GPU().IncrementSyncPoint(ChannelSyncPointId)};
+    return {ChannelSyncPointId, value};
+}
+
+u32 nvhost_gpu::SubmitGPFIFO(InputBuffer input, OutputBuffer output) {
     if (input.size() < sizeof(IoctlSubmitGpfifo)) {
         UNIMPLEMENTED();
     }
@@ -142,19 +164,14 @@ u32 nvhost_gpu::SubmitGPFIFO(const std::vector<u8>& input, std::vector<u8>& outp
                                    params.num_entries * sizeof(Tegra::CommandListHeader),
                "Incorrect input size");
 
-    std::vector<Tegra::CommandListHeader> entries(params.num_entries);
-    std::memcpy(entries.data(), &input[sizeof(IoctlSubmitGpfifo)],
-                params.num_entries * sizeof(Tegra::CommandListHeader));
-
-    Core::System::GetInstance().GPU().ProcessCommandLists(entries);
+    PushGPUEntries(input.data() + sizeof(IoctlSubmitGpfifo), params.num_entries);
 
-    params.fence_out.id = 0;
-    params.fence_out.value = 0;
+    params.fence_out = IncrementChannelSyncPoint();
     std::memcpy(output.data(), &params, sizeof(IoctlSubmitGpfifo));
     return 0;
 }
 
-u32 nvhost_gpu::KickoffPB(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvhost_gpu::KickoffPB(InputBuffer input, OutputBuffer output) {
     if (input.size() < sizeof(IoctlSubmitGpfifo)) {
         UNIMPLEMENTED();
     }
@@ -163,19 +180,21 @@ u32 nvhost_gpu::KickoffPB(const std::vector<u8>& input, std::vector<u8>& output)
     LOG_WARNING(Service_NVDRV, "(STUBBED) called, gpfifo={:X}, num_entries={:X}, flags={:X}",
                 params.address, params.num_entries, params.flags);
 
-    std::vector<Tegra::CommandListHeader> entries(params.num_entries);
-    Memory::ReadBlock(params.address, entries.data(),
-                      params.num_entries * sizeof(Tegra::CommandListHeader));
-
-    Core::System::GetInstance().GPU().ProcessCommandLists(entries);
+    const std::size_t entries_size = params.num_entries * sizeof(Tegra::CommandListHeader);
+    if (const u8* const entries = Memory::GetContiguousPointer(params.address, entries_size)) {
+        PushGPUEntries(entries, params.num_entries);
+    } else {
+        std::vector<Tegra::CommandListHeader> entries_copy(params.num_entries);
+        Memory::ReadBlock(params.address, entries_copy.data(), entries_size);
+        Core::System::GetInstance().GPU().PushGPUEntries(std::move(entries_copy));
+    }
 
-    params.fence_out.id = 0;
-    params.fence_out.value = 0;
+    params.fence_out = IncrementChannelSyncPoint();
     std::memcpy(output.data(), &params, output.size());
     return 0;
 }
 
-u32 nvhost_gpu::GetWaitbase(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvhost_gpu::GetWaitbase(InputBuffer input, OutputBuffer output) {
     IoctlGetWaitbase params{};
     std::memcpy(&params, input.data(), sizeof(IoctlGetWaitbase));
     LOG_INFO(Service_NVDRV, "called, unknown=0x{:X}", params.unknown);
@@ -184,7 +203,7 @@ u32 nvhost_gpu::GetWaitbase(const std::vector<u8>& input, std::vector<u8>& outpu
     return 0;
 }
 
-u32 nvhost_gpu::ChannelSetTimeout(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvhost_gpu::ChannelSetTimeout(InputBuffer input, OutputBuffer output) {
     IoctlChannelSetTimeout params{};
     std::memcpy(&params, input.data(), sizeof(IoctlChannelSetTimeout));
     LOG_INFO(Service_NVDRV, "called, timeout=0x{:X}", params.timeout);
@@ -23,7 +23,7 @@ public:
     explicit nvhost_gpu(std::shared_ptr<nvmap> nvmap_dev);
     ~nvhost_gpu() override;
 
-    u32 ioctl(Ioctl command, const std::vector<u8>& input, std::vector<u8>& output) override;
+    u32 ioctl(Ioctl command, InputBuffer input, OutputBuffer output) override;
 
 private:
     enum class IoctlCommand : u32_le {
@@ -165,23 +165,30 @@ private:
     };
     static_assert(sizeof(IoctlGetWaitbase) == 8, "IoctlGetWaitbase is incorrect size");
 
+    /// Syncpoint incremented after each submission to the channel
+    static constexpr u32 ChannelSyncPointId = 1;
+
     u32_le nvmap_fd{};
     u64_le user_data{};
     IoctlZCullBind zcull_params{};
     u32_le channel_priority{};
 
-    u32 SetNVMAPfd(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 SetClientData(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 GetClientData(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 ZCullBind(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 SetErrorNotifier(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 SetChannelPriority(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 AllocGPFIFOEx2(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 AllocateObjectContext(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 SubmitGPFIFO(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 KickoffPB(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 GetWaitbase(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 ChannelSetTimeout(const std::vector<u8>& input, std::vector<u8>& output);
+    u32 SetNVMAPfd(InputBuffer input, OutputBuffer output);
+    u32 SetClientData(InputBuffer input, OutputBuffer output);
+    u32 GetClientData(InputBuffer input, OutputBuffer output);
+    u32 ZCullBind(InputBuffer input, OutputBuffer output);
+    u32 SetErrorNotifier(InputBuffer input, OutputBuffer output);
+    u32 SetChannelPriority(InputBuffer input, OutputBuffer output);
+    u32 AllocGPFIFOEx2(InputBuffer input, OutputBuffer output);
+    u32 AllocateObjectContext(InputBuffer input, OutputBuffer output);
+    /// Pushes command list headers read from guest memory, in place when they're aligned
+    void PushGPUEntries(const u8* entries, std::size_t num_entries);
+    /// Schedules an increment of the channel syncpoint, returns the fence to wait for it
+    IoctlFence IncrementChannelSyncPoint();
+    u32 SubmitGPFIFO(InputBuffer input, OutputBuffer output);
+    u32 KickoffPB(InputBuffer input, OutputBuffer output);
+    u32 GetWaitbase(InputBuffer input, OutputBuffer output);
+    u32 ChannelSetTimeout(InputBuffer input, OutputBuffer output);
 
     std::shared_ptr<nvmap> nvmap_dev;
 };
@@ -7,10 +7,19 @@
 
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "core/core.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/kernel/vm_manager.h"
 #include "core/hle/service/nvdrv/devices/nvmap.h"
+#include "core/memory.h"
+#include "core/settings.h"
+#include "video_core/gpu.h"
 
 namespace Service::Nvidia::Devices {
 
+/// Smallest object worth aliasing, smaller buffers are cheap to upload on every use
+constexpr u32 MIN_ALIASED_SIZE = 0x100000;
+
 nvmap::nvmap() = default;
 nvmap::~nvmap() = default;
 
@@ -21,7 +30,7 @@ VAddr nvmap::GetObjectAddress(u32 handle) const {
     return object->addr;
 }
 
-u32 nvmap::ioctl(Ioctl command, const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvmap::ioctl(Ioctl command, InputBuffer input, OutputBuffer output) {
     switch (static_cast<IoctlCommand>(command.raw)) {
     case IoctlCommand::Create:
         return IocCreate(input, output);
@@ -41,7 +50,7 @@ u32 nvmap::ioctl(Ioctl command, const std::vector<u8>& input, std::vector<u8>& o
     return 0;
 }
 
-u32 nvmap::IocCreate(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvmap::IocCreate(InputBuffer input, OutputBuffer output) {
     IocCreateParams params;
     std::memcpy(&params, input.data(), sizeof(params));
 
@@ -63,7 +72,7 @@ u32 nvmap::IocCreate(const std::vector<u8>& input, std::vector<u8>& output) {
     return 0;
 }
 
-u32 nvmap::IocAlloc(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvmap::IocAlloc(InputBuffer input, OutputBuffer output) {
     IocAllocParams params;
     std::memcpy(&params, input.data(), sizeof(params));
 
@@ -75,6 +84,7 @@ u32 nvmap::IocAlloc(const std::vector<u8>& input, std::vector<u8>& output) {
     object->kind = params.kind;
     object->addr = params.addr;
     object->status = Object::Status::Allocated;
+    AliasObject(*object);
 
     LOG_DEBUG(Service_NVDRV, "called, addr={:X}", params.addr);
 
@@ -82,7 +92,7 @@ u32 nvmap::IocAlloc(const std::vector<u8>& input, std::vector<u8>& output) {
     return 0;
 }
 
-u32 nvmap::IocGetId(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvmap::IocGetId(InputBuffer input, OutputBuffer output) {
     IocGetIdParams params;
     std::memcpy(&params, input.data(), sizeof(params));
 
@@ -97,7 +107,7 @@ u32 nvmap::IocGetId(const std::vector<u8>& input, std::vector<u8>& output) {
     return 0;
 }
 
-u32 nvmap::IocFromId(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvmap::IocFromId(InputBuffer input, OutputBuffer output) {
     IocFromIdParams params;
     std::memcpy(&params, input.data(), sizeof(params));
 
@@ -116,7 +126,7 @@ u32 nvmap::IocFromId(const std::vector<u8>& input, std::vector<u8>& output) {
     return 0;
 }
 
-u32 nvmap::IocParam(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvmap::IocParam(InputBuffer input, OutputBuffer output) {
     enum class ParamTypes { Size = 1, Alignment = 2, Base = 3, Heap = 4, Kind = 5, Compr = 6 };
 
     IocParamParams params;
@@ -150,7 +160,7 @@ u32 nvmap::IocParam(const std::vector<u8>& input, std::vector<u8>& output) {
     return 0;
 }
 
-u32 nvmap::IocFree(const std::vector<u8>& input, std::vector<u8>& output) {
+u32 nvmap::IocFree(InputBuffer input, OutputBuffer output) {
     // TODO(Subv): These flags are unconfirmed.
     enum FreeFlags {
         Freed = 0,
@@ -172,6 +182,7 @@ u32 nvmap::IocFree(const std::vector<u8>& input, std::vector<u8>& output) {
     params.size = itr->second->size;
 
     if (itr->second->refcount == 0) {
+        UnaliasObject(*itr->second);
         params.flags = Freed;
         // The address of the nvmap is written to the output if we're finally freeing it, otherwise
         // 0 is written.
@@ -187,4 +198,67 @@ u32 nvmap::IocFree(const std::vector<u8>& input, std::vector<u8>& output) {
     return 0;
 }
 
+void nvmap::AliasObject(Object& object) {
+    if (!Settings::values.use_gpu_memory_aliasing || object.aliased_pointer != nullptr ||
+        object.size < MIN_ALIASED_SIZE || (object.addr & Memory::PAGE_MASK) != 0 ||
+        (object.size & Memory::PAGE_MASK) != 0) {
+        return;
+    }
+
+    // Only heap objects are aliased, the heap block stays allocated to map them back later
+    auto& vm_manager = Core::CurrentProcess()->vm_manager;
+    const auto vma = vm_manager.FindVMA(object.addr);
+    if (vma == vm_manager.vma_map.end() ||
+        vma->second.type != Kernel::VMAType::AllocatedMemoryBlock ||
+        vma->second.base + vma->second.size < object.addr + object.size) {
+        return;
+    }
+    const Kernel::MemoryState state = vma->second.meminfo_state;
+    const Kernel::VMAPermission permissions = vma->second.permissions;
+    auto block = vma->second.backing_block;
+    const std::size_t offset = vma->second.offset + (object.addr - vma->second.base);
+
+    auto& gpu = Core::System::GetInstance().GPU();
+    u8* const pointer = gpu.AliasRegion(object.addr, object.size);
+    if (pointer == nullptr) {
+        return;
+    }
+
+    // The object may already hold data, written by the guest or by the GPU
+    gpu.FlushRegion(object.addr, object.size);
+    std::memcpy(pointer, block->data() + offset, object.size);
+
+    vm_manager.UnmapRange(object.addr, object.size);
+    vm_manager.MapBackingMemory(object.addr, pointer, object.size, state);
+    vm_manager.ReprotectRange(object.addr, object.size, permissions);
+
+    object.aliased_pointer = pointer;
+    object.aliased_block = std::move(block);
+    object.aliased_offset = offset;
+    LOG_DEBUG(Service_NVDRV, "Aliased object at {:X} with size {:X}", object.addr, object.size);
+}
+
+void nvmap::UnaliasObject(Object& object) {
+    if (object.aliased_pointer == nullptr) {
+        return;
+    }
+
+    auto& vm_manager = Core::CurrentProcess()->vm_manager;
+    const auto vma = vm_manager.FindVMA(object.addr);
+    ASSERT(vma != vm_manager.vma_map.end());
+    const Kernel::MemoryState state = vma->second.meminfo_state;
+    const Kernel::VMAPermission permissions = vma->second.permissions;
+
+    std::memcpy(object.aliased_block->data() + object.aliased_offset, object.aliased_pointer,
+                object.size);
+    vm_manager.UnmapRange(object.addr, object.size);
+    vm_manager.MapMemoryBlock(object.addr, object.aliased_block, object.aliased_offset,
+                              object.size, state);
+    vm_manager.ReprotectRange(object.addr, object.size, permissions);
+
+    Core::System::GetInstance().GPU().UnaliasRegion(object.addr);
+    object.aliased_pointer = nullptr;
+    object.aliased_block.reset();
+}
+
 } // namespace Service::Nvidia::Devices
@@ -9,6 +9,7 @@
 #include <vector>
 #include "common/common_funcs.h"
 #include "common/common_types.h"
+#include "common/memory_util.h"
 #include "common/swap.h"
 #include "core/hle/service/nvdrv/devices/nvdevice.h"
 
@@ -22,7 +23,7 @@ public:
     /// Returns the allocated address of an nvmap object given its handle.
     VAddr GetObjectAddress(u32 handle) const;
 
-    u32 ioctl(Ioctl command, const std::vector<u8>& input, std::vector<u8>& output) override;
+    u32 ioctl(Ioctl command, InputBuffer input, OutputBuffer output) override;
 
     /// Represents an nvmap object.
     struct Object {
@@ -35,6 +36,12 @@ public:
         VAddr addr;
         Status status;
         u32 refcount;
+
+        /// Host memory visible to the GPU backing the object instead of the heap, or nullptr
+        u8* aliased_pointer = nullptr;
+        /// Heap memory the object was mapped from before it was aliased
+        std::shared_ptr<Common::DemandZeroBuffer> aliased_block;
+        std::size_t aliased_offset = 0;
     };
 
     std::shared_ptr<Object> GetObject(u32 handle) const {
@@ -55,6 +62,12 @@ private:
     /// Mapping of currently allocated handles to the objects they represent.
     std::unordered_map<u32, std::shared_ptr<Object>> handles;
 
+    /// Backs a large object with memory the GPU reads directly, when enabled in the settings
+    void AliasObject(Object& object);
+
+    /// Maps the heap memory of an aliased object back, with the contents of the GPU memory
+    void UnaliasObject(Object& object);
+
     enum class IoctlCommand : u32 {
         Create = 0xC0080101,
         FromId = 0xC0080103,
@@ -117,12 +130,12 @@ private:
     };
     static_assert(sizeof(IocGetIdParams) == 8, "IocGetIdParams has wrong size");
 
-    u32 IocCreate(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 IocAlloc(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 IocGetId(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 IocFromId(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 IocParam(const std::vector<u8>& input, std::vector<u8>& output);
-    u32 IocFree(const std::vector<u8>& input, std::vector<u8>& output);
+    u32 IocCreate(InputBuffer input, OutputBuffer output);
+    u32 IocAlloc(InputBuffer input, OutputBuffer output);
+    u32 IocGetId(InputBuffer input, OutputBuffer output);
+    u32 IocFromId(InputBuffer input, OutputBuffer output);
+    u32 IocParam(InputBuffer input, OutputBuffer output);
+    u32 IocFree(InputBuffer input, OutputBuffer output);
 };
 
 } // namespace Service::Nvidia::Devices
@@ -32,13 +32,29 @@ void NVDRV::Ioctl(Kernel::HLERequestContext& ctx) {
     u32 fd = rp.Pop<u32>();
     u32 command = rp.Pop<u32>();
 
-    std::vector<u8> output(ctx.GetWriteBufferSize());
+    // The ioctl works on views of the guest buffers, unless they have to be copied to be contiguous
+    std::vector<u8> input_copy;
+    const u8* input = ctx.GetReadBufferPointer();
+    if (input == nullptr) {
+        input_copy = ctx.ReadBuffer();
+        input = input_copy.data();
+    }
+
+    std::vector<u8> output_copy;
+    u8* output = ctx.GetWriteBufferPointer();
+    if (output == nullptr) {
+        output_copy.resize(ctx.GetWriteBufferSize());
+        output = output_copy.data();
+    }
 
     IPC::ResponseBuilder rb{ctx, 3};
     rb.Push(RESULT_SUCCESS);
-    rb.Push(nvdrv->Ioctl(fd, command, ctx.ReadBuffer(), output));
+    rb.Push(nvdrv->Ioctl(fd, command, {input, ctx.GetReadBufferSize()},
+                         {output, ctx.GetWriteBufferSize()}));
 
-    ctx.WriteBuffer(output);
+    if (!output_copy.empty()) {
+        ctx.WriteBuffer(output_copy);
+    }
 }
 
 void NVDRV::Close(Kernel::HLERequestContext& ctx) {
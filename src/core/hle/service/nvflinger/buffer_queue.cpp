@@ -2,12 +2,11 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
-#include <algorithm>
-
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "core/core.h"
 #include "core/hle/service/nvflinger/buffer_queue.h"
+#include "video_core/gpu.h"
 
 namespace Service::NVFlinger {
 
@@ -20,72 +19,83 @@ BufferQueue::BufferQueue(u32 id, u64 layer_id) : id(id), layer_id(layer_id) {
 BufferQueue::~BufferQueue() = default;
 
 void BufferQueue::SetPreallocatedBuffer(u32 slot, const IGBPBuffer& igbp_buffer) {
-    Buffer buffer{};
+    ASSERT(slot < NumBufferSlots);
+    ASSERT(!allocated_slots[slot]);
+
+    Buffer& buffer = buffers[slot];
+    buffer = {};
     buffer.slot = slot;
     buffer.igbp_buffer = igbp_buffer;
     buffer.status = Buffer::Status::Free;
 
     LOG_WARNING(Service, "Adding graphics buffer {}", slot);
 
-    queue.emplace_back(buffer);
+    allocated_slots[slot] = true;
+    free_slots[slot] = true;
     buffer_wait_event->Signal();
 }
 
 boost::optional<u32> BufferQueue::DequeueBuffer(u32 width, u32 height) {
-    auto itr = std::find_if(queue.begin(), queue.end(), [&](const Buffer& buffer) {
-        // Only consider free buffers. Buffers become free once again after they've been Acquired
-        // and Released by the compositor, see the NVFlinger::Compose method.
-        if (buffer.status != Buffer::Status::Free) {
-            return false;
-        }
-
+    // Only consider free buffers. Buffers become free once again after they've been Acquired and
+    // Released by the compositor, see the NVFlinger::Compose method. Prefer the buffer released
+    // first, as it is the most likely to be done being presented.
+    Buffer* dequeued = nullptr;
+    for (const int slot : free_slots) {
+        Buffer& buffer = buffers[slot];
         // Make sure that the parameters match.
-        return buffer.igbp_buffer.width == width && buffer.igbp_buffer.height == height;
-    });
+        if (buffer.igbp_buffer.width != width || buffer.igbp_buffer.height != height) {
+            continue;
+        }
+        if (dequeued == nullptr || buffer.release_fence < dequeued->release_fence) {
+            dequeued = &buffer;
+        }
+    }
 
-    if (itr == queue.end()) {
+    if (dequeued == nullptr) {
         return boost::none;
     }
 
-    itr->status = Buffer::Status::Dequeued;
-    return itr->slot;
+    if (dequeued->release_fence != 0) {
+        Core::System::GetInstance().GPU().WaitForFence(dequeued->release_fence);
+        dequeued->release_fence = 0;
+    }
+
+    dequeued->status = Buffer::Status::Dequeued;
+    free_slots[dequeued->slot] = false;
+    return dequeued->slot;
 }
 
 const IGBPBuffer& BufferQueue::RequestBuffer(u32 slot) const {
-    auto itr = std::find_if(queue.begin(), queue.end(),
-                            [&](const Buffer& buffer) { return buffer.slot == slot; });
-    ASSERT(itr != queue.end());
-    ASSERT(itr->status == Buffer::Status::Dequeued);
-    return itr->igbp_buffer;
+    const Buffer& buffer = GetBuffer(slot);
+    ASSERT(buffer.status == Buffer::Status::Dequeued);
+    return buffer.igbp_buffer;
 }
 
 void BufferQueue::QueueBuffer(u32 slot, BufferTransformFlags transform,
                               const MathUtil::Rectangle<int>& crop_rect) {
-    auto itr = std::find_if(queue.begin(), queue.end(),
-                            [&](const Buffer& buffer) { return buffer.slot == slot; });
-    ASSERT(itr != queue.end());
-    ASSERT(itr->status == Buffer::Status::Dequeued);
-    itr->status = Buffer::Status::Queued;
-    itr->transform = transform;
-    itr->crop_rect = crop_rect;
+    Buffer& buffer = GetBuffer(slot);
+    ASSERT(buffer.status == Buffer::Status::Dequeued);
+    buffer.status = Buffer::Status::Queued;
+    buffer.transform = transform;
+    buffer.crop_rect = crop_rect;
+    queued_slots.push_back(slot);
 }
 
 boost::optional<const BufferQueue::Buffer&> BufferQueue::AcquireBuffer() {
-    auto itr = std::find_if(queue.begin(), queue.end(), [](const Buffer& buffer) {
-        return buffer.status == Buffer::Status::Queued;
-    });
-    if (itr == queue.end())
+    if (queued_slots.empty())
         return boost::none;
-    itr->status = Buffer::Status::Acquired;
-    return *itr;
+    Buffer& buffer = buffers[queued_slots.front()];
+    queued_slots.pop_front();
+    buffer.status = Buffer::Status::Acquired;
+    return buffer;
 }
 
-void BufferQueue::ReleaseBuffer(u32 slot) {
-    auto itr = std::find_if(queue.begin(), queue.end(),
-                            [&](const Buffer& buffer) { return buffer.slot == slot; });
-    ASSERT(itr != queue.end());
-    ASSERT(itr->status == Buffer::Status::Acquired);
-    itr->status = Buffer::Status::Free;
+void BufferQueue::ReleaseBuffer(u32 slot, u64 release_fence) {
+    Buffer& buffer = GetBuffer(slot);
+    ASSERT(buffer.status == Buffer::Status::Acquired);
+    buffer.status = Buffer::Status::Free;
+    buffer.release_fence = release_fence;
+    free_slots[slot] = true;
 
     buffer_wait_event->Signal();
 }
@@ -103,4 +113,14 @@ u32 BufferQueue::Query(QueryType type) {
     return 0;
 }
 
+BufferQueue::Buffer& BufferQueue::GetBuffer(u32 slot) {
+    ASSERT(slot < NumBufferSlots && allocated_slots[slot]);
+    return buffers[slot];
+}
+
+const BufferQueue::Buffer& BufferQueue::GetBuffer(u32 slot) const {
+    ASSERT(slot < NumBufferSlots && allocated_slots[slot]);
+    return buffers[slot];
+}
+
 } // namespace Service::NVFlinger
@@ -4,8 +4,10 @@
 
 #pragma once
 
-#include <vector>
+#include <array>
+#include <deque>
 #include <boost/optional.hpp>
+#include "common/bit_set.h"
 #include "common/common_funcs.h"
 #include "common/math_util.h"
 #include "common/swap.h"
@@ -62,6 +64,9 @@ public:
         Roate270 = 0x07,
     };
 
+    /// Number of buffer slots of a queue, as in the Android BufferQueue
+    static constexpr u32 NumBufferSlots = 64;
+
     struct Buffer {
         enum class Status { Free = 0, Queued = 1, Dequeued = 2, Acquired = 3 };
 
@@ -70,15 +75,29 @@ public:
         IGBPBuffer igbp_buffer;
         BufferTransformFlags transform;
         MathUtil::Rectangle<int> crop_rect;
+        /// GPU fence signaled once the compositor is done reading the buffer, 0 if it isn't
+        u64 release_fence{};
     };
 
     void SetPreallocatedBuffer(u32 slot, const IGBPBuffer& igbp_buffer);
+
+    /**
+     * Dequeues a free buffer of the specified size. When the compositor is still reading the
+     * buffer, waits for it to be done, so that the guest doesn't overwrite a frame being presented.
+     */
     boost::optional<u32> DequeueBuffer(u32 width, u32 height);
     const IGBPBuffer& RequestBuffer(u32 slot) const;
     void QueueBuffer(u32 slot, BufferTransformFlags transform,
                      const MathUtil::Rectangle<int>& crop_rect);
+
+    /// Acquires the buffer that was queued first, if any
     boost::optional<const Buffer&> AcquireBuffer();
-    void ReleaseBuffer(u32 slot);
+
+    /**
+     * Releases an acquired buffer back to the producer.
+     * @param release_fence GPU fence signaled once the buffer has been presented, 0 if it has
+     */
+    void ReleaseBuffer(u32 slot, u64 release_fence);
     u32 Query(QueryType type);
 
     u32 GetId() const {
@@ -93,7 +112,18 @@ private:
     u32 id;
     u64 layer_id;
 
-    std::vector<Buffer> queue;
+    /// Returns the buffer in the specified slot, which must have been set
+    Buffer& GetBuffer(u32 slot);
+    const Buffer& GetBuffer(u32 slot) const;
+
+    std::array<Buffer, NumBufferSlots> buffers{};
+    /// Slots that a buffer has been set for
+    BitSet64 allocated_slots;
+    /// Slots whose buffer can be dequeued
+    BitSet64 free_slots;
+    /// Slots of the queued buffers, in the order they were queued
+    std::deque<u32> queued_slots;
+
     Kernel::SharedPtr<Kernel::Event> buffer_wait_event;
 };
 
@@ -18,6 +18,7 @@
 #include "core/hle/service/nvflinger/buffer_queue.h"
 #include "core/hle/service/nvflinger/nvflinger.h"
 #include "core/perf_stats.h"
+#include "core/savestate.h"
 #include "video_core/renderer_base.h"
 #include "video_core/video_core.h"
 
@@ -26,6 +27,10 @@ namespace Service::NVFlinger {
 constexpr std::size_t SCREEN_REFRESH_RATE = 60;
 constexpr u64 frame_ticks = static_cast<u64>(CoreTiming::BASE_CLOCK_RATE / SCREEN_REFRESH_RATE);
 
+/// Number of vsyncs without a queued buffer after which the previous frame is presented again, so
+/// that the frontend keeps polling window events and frame limiting while the game isn't drawing.
+constexpr u32 IDLE_PRESENT_INTERVAL = 4;
+
 NVFlinger::NVFlinger() {
     // Add the different displays to the list of displays.
     displays.emplace_back(0, "Default");
@@ -115,6 +120,8 @@ Layer& NVFlinger::GetLayer(u64 display_id, u64 layer_id) {
 }
 
 void NVFlinger::Compose() {
+    bool presented = false;
+
     for (auto& display : displays) {
         // Trigger vsync for this display at the end of drawing
         SCOPE_EXIT({ display.vsync_event->Signal(); });
@@ -135,11 +142,7 @@ void NVFlinger::Compose() {
         MicroProfileFlip();
 
         if (buffer == boost::none) {
-            auto& system_instance = Core::System::GetInstance();
-
-            // There was no queued buffer to draw, render previous frame
-            system_instance.GetPerfStats().EndGameFrame();
-            system_instance.Renderer().SwapBuffers({});
+            // There was no queued buffer to draw, the previous frame is still on screen
             continue;
         }
 
@@ -151,11 +154,27 @@ void NVFlinger::Compose() {
         auto nvdisp = nvdrv->GetDevice<Nvidia::Devices::nvdisp_disp0>("/dev/nvdisp_disp0");
         ASSERT(nvdisp);
 
-        nvdisp->flip(igbp_buffer.gpu_buffer_id, igbp_buffer.offset, igbp_buffer.format,
-                     igbp_buffer.width, igbp_buffer.height, igbp_buffer.stride, buffer->transform,
-                     buffer->crop_rect);
+        const u64 present_fence =
+            nvdisp->flip(igbp_buffer.gpu_buffer_id, igbp_buffer.offset, igbp_buffer.format,
+                         igbp_buffer.width, igbp_buffer.height, igbp_buffer.stride,
+                         buffer->transform, buffer->crop_rect);
+
+        // The buffer is read when the frame is presented, the producer waits for it on dequeue
+        buffer_queue->ReleaseBuffer(buffer->slot, present_fence);
+        presented = true;
+    }
+
+    if (presented) {
+        Core::System::GetInstance().SaveStates().NotifyFrame();
+        idle_vsyncs = 0;
+        return;
+    }
 
-        buffer_queue->ReleaseBuffer(buffer->slot);
+    // Games running below the refresh rate don't queue a buffer on every vsync, only present the
+    // previous frame again once the display has been idle for a while.
+    if (++idle_vsyncs >= IDLE_PRESENT_INTERVAL) {
+        idle_vsyncs = 0;
+        Core::System::GetInstance().GPU().SwapBuffers({});
     }
 }
 
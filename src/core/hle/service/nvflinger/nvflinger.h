@@ -67,7 +67,7 @@ public:
     std::shared_ptr<BufferQueue> GetBufferQueue(u32 id) const;
 
     /// Performs a composition request to the emulated nvidia GPU and triggers the vsync events when
-    /// finished.
+    /// finished. Only buffers queued since the last composition are presented.
     void Compose();
 
 private:
@@ -88,6 +88,9 @@ private:
     /// layers.
     u32 next_buffer_queue_id = 1;
 
+    /// Number of consecutive compositions that had no queued buffer to present.
+    u32 idle_vsyncs = 0;
+
     /// CoreTiming event that handles screen composition.
     CoreTiming::EventType* composition_event;
 };
@@ -3,10 +3,12 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <chrono>
 #include <fmt/format.h>
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "common/string_util.h"
+#include "common/tracing.h"
 #include "core/core.h"
 #include "core/hle/ipc.h"
 #include "core/hle/ipc_helpers.h"
@@ -15,6 +17,7 @@
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/server_port.h"
+#include "core/hle/kernel/svc_profiler.h"
 #include "core/hle/kernel/thread.h"
 #include "core/hle/service/acc/acc.h"
 #include "core/hle/service/am/am.h"
@@ -67,6 +70,7 @@
 #include "core/hle/service/usb/usb.h"
 #include "core/hle/service/vi/vi.h"
 #include "core/hle/service/wlan/wlan.h"
+#include "core/settings.h"
 
 using Kernel::ClientPort;
 using Kernel::ServerPort;
@@ -120,6 +124,35 @@ void ServiceFrameworkBase::RegisterHandlersBase(const FunctionInfoBase* function
         // Usually this array is sorted by id already, so hint to insert at the end
         handlers.emplace_hint(handlers.cend(), functions[i].expected_header, functions[i]);
     }
+
+    // Index the handlers by id unless that would leave too many empty entries
+    constexpr std::size_t MIN_DENSE_SIZE = 0x100;
+    constexpr std::size_t MAX_ENTRIES_PER_HANDLER = 4;
+    dense_handlers.clear();
+    if (handlers.empty()) {
+        return;
+    }
+    const std::size_t dense_size = std::size_t{handlers.rbegin()->first} + 1;
+    if (dense_size > std::max(MIN_DENSE_SIZE, handlers.size() * MAX_ENTRIES_PER_HANDLER)) {
+        return;
+    }
+    dense_handlers.resize(dense_size, FunctionInfoBase{0, nullptr, nullptr});
+    for (const auto& [id, info] : handlers) {
+        dense_handlers[id] = info;
+    }
+}
+
+const ServiceFrameworkBase::FunctionInfoBase* ServiceFrameworkBase::FindHandler(
+    u32 command) const {
+    if (!dense_handlers.empty()) {
+        if (command >= dense_handlers.size() || dense_handlers[command].name == nullptr) {
+            return nullptr;
+        }
+        return &dense_handlers[command];
+    }
+
+    const auto itr = handlers.find(command);
+    return itr == handlers.end() ? nullptr : &itr->second;
 }
 
 void ServiceFrameworkBase::ReportUnimplementedFunction(Kernel::HLERequestContext& ctx,
@@ -140,8 +173,7 @@ void ServiceFrameworkBase::ReportUnimplementedFunction(Kernel::HLERequestContext
 }
 
 void ServiceFrameworkBase::InvokeRequest(Kernel::HLERequestContext& ctx) {
-    auto itr = handlers.find(ctx.GetCommand());
-    const FunctionInfoBase* info = itr == handlers.end() ? nullptr : &itr->second;
+    const FunctionInfoBase* info = FindHandler(ctx.GetCommand());
     if (info == nullptr || info->handler_callback == nullptr) {
         return ReportUnimplementedFunction(ctx, info);
     }
@@ -149,10 +181,20 @@ void ServiceFrameworkBase::InvokeRequest(Kernel::HLERequestContext& ctx) {
     LOG_TRACE(
         Service, "{}",
         MakeFunctionString(info->name, GetServiceName().c_str(), ctx.CommandBuffer()).c_str());
+
+    if (!Settings::values.profile_svcs) {
+        handler_invoker(this, info->handler_callback, ctx);
+        return;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
     handler_invoker(this, info->handler_callback, ctx);
+    Kernel::SVCProfiler::RecordRequest(service_name, info->expected_header, info->name,
+                                       std::chrono::steady_clock::now() - start);
 }
 
 ResultCode ServiceFrameworkBase::HandleSyncRequest(Kernel::HLERequestContext& context) {
+    YUZU_TRACE_ZONE("HandleSyncRequest");
     switch (context.GetCommandType()) {
     case IPC::CommandType::Close: {
         IPC::ResponseBuilder rb{context, 2};
@@ -6,6 +6,7 @@
 
 #include <cstddef>
 #include <string>
+#include <vector>
 #include <boost/container/flat_map.hpp>
 #include "common/common_types.h"
 #include "core/hle/kernel/hle_ipc.h"
@@ -89,6 +90,9 @@ private:
     void RegisterHandlersBase(const FunctionInfoBase* functions, std::size_t n);
     void ReportUnimplementedFunction(Kernel::HLERequestContext& ctx, const FunctionInfoBase* info);
 
+    /// Returns the handler registered for a command, or null if there's none
+    const FunctionInfoBase* FindHandler(u32 command) const;
+
     /// Identifier string used to connect to the service.
     std::string service_name;
     /// Maximum number of concurrent sessions that this service can handle.
@@ -97,6 +101,12 @@ private:
     /// Function used to safely up-cast pointers to the derived class before invoking a handler.
     InvokerFn* handler_invoker;
     boost::container::flat_map<u32, FunctionInfoBase> handlers;
+    /**
+     * Copy of the handlers indexed by command id, so that dispatching a request is a single bounds
+     * checked access. It's only built when the ids are dense enough, which they are for most
+     * services, and is empty otherwise. Ids without a handler have a null name.
+     */
+    std::vector<FunctionInfoBase> dense_handlers;
 };
 
 /**
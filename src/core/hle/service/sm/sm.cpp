@@ -47,8 +47,10 @@ ResultVal<Kernel::SharedPtr<Kernel::ServerPort>> ServiceManager::RegisterService
 
     CASCADE_CODE(ValidateServiceName(name));
 
-    if (registered_services.find(name) != registered_services.end())
+    if (registered_services.find(name) != registered_services.end() ||
+        lazy_services.find(name) != lazy_services.end()) {
         return ERR_ALREADY_REGISTERED;
+    }
 
     auto& kernel = Core::System::GetInstance().Kernel();
     Kernel::SharedPtr<Kernel::ServerPort> server_port;
@@ -60,13 +62,38 @@ ResultVal<Kernel::SharedPtr<Kernel::ServerPort>> ServiceManager::RegisterService
     return MakeResult<Kernel::SharedPtr<Kernel::ServerPort>>(std::move(server_port));
 }
 
+ResultCode ServiceManager::RegisterLazyService(std::string name,
+                                               std::function<void(ServiceManager&)> install) {
+    CASCADE_CODE(ValidateServiceName(name));
+
+    if (registered_services.find(name) != registered_services.end())
+        return ERR_ALREADY_REGISTERED;
+
+    if (!lazy_services.emplace(std::move(name), std::move(install)).second)
+        return ERR_ALREADY_REGISTERED;
+
+    return RESULT_SUCCESS;
+}
+
 ResultVal<Kernel::SharedPtr<Kernel::ClientPort>> ServiceManager::GetServicePort(
     const std::string& name) {
 
     CASCADE_CODE(ValidateServiceName(name));
     auto it = registered_services.find(name);
     if (it == registered_services.end()) {
-        return ERR_SERVICE_NOT_REGISTERED;
+        const auto lazy_it = lazy_services.find(name);
+        if (lazy_it == lazy_services.end()) {
+            return ERR_SERVICE_NOT_REGISTERED;
+        }
+
+        // Take the install function out first, so the service can register under its name
+        const auto install = std::move(lazy_it->second);
+        lazy_services.erase(lazy_it);
+        LOG_DEBUG(Service_SM, "creating service={} on first use", name);
+        install(*this);
+
+        it = registered_services.find(name);
+        ASSERT_MSG(it != registered_services.end(), "Service {} was not installed", name);
     }
 
     return MakeResult<Kernel::SharedPtr<Kernel::ClientPort>>(it->second);
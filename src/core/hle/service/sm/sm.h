@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -45,6 +46,21 @@ public:
 
     ResultVal<Kernel::SharedPtr<Kernel::ServerPort>> RegisterService(std::string name,
                                                                      unsigned int max_sessions);
+
+    /**
+     * Registers a service that is only created when it is first looked up. The install function
+     * is then expected to register the service under the same name.
+     */
+    ResultCode RegisterLazyService(std::string name, std::function<void(ServiceManager&)> install);
+
+    /// Registers the service T, constructed with the given arguments when it is first looked up.
+    template <typename T, typename... Args>
+    void InstallLazyService(std::string name, Args... args) {
+        RegisterLazyService(std::move(name), [args...](ServiceManager& self) {
+            std::make_shared<T>(args...)->InstallAsService(self);
+        });
+    }
+
     ResultVal<Kernel::SharedPtr<Kernel::ClientPort>> GetServicePort(const std::string& name);
     ResultVal<Kernel::SharedPtr<Kernel::ClientSession>> ConnectToService(const std::string& name);
 
@@ -55,6 +71,9 @@ private:
 
     /// Map of registered services, retrieved using GetServicePort or ConnectToService.
     std::unordered_map<std::string, Kernel::SharedPtr<Kernel::ClientPort>> registered_services;
+
+    /// Map of services that have not been created yet, with the functions that create them.
+    std::unordered_map<std::string, std::function<void(ServiceManager&)>> lazy_services;
 };
 
 } // namespace Service::SM
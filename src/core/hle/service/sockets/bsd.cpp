@@ -2,11 +2,91 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstring>
+#include "common/common_funcs.h"
+#include "common/logging/log.h"
+#include "core/core.h"
 #include "core/hle/ipc_helpers.h"
+#include "core/hle/kernel/event.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/thread.h"
 #include "core/hle/service/sockets/bsd.h"
+#include "core/hle/service/sockets/socket_poller.h"
 
 namespace Service::Sockets {
 
+namespace {
+
+constexpr u32 FCNTL_GETFL = 3;
+constexpr u32 FCNTL_SETFL = 4;
+constexpr u32 FLAG_NONBLOCK = 0x800;
+
+constexpr u32 LEVEL_SOCKET = 0xFFFF;
+constexpr u32 OPTION_SNDTIMEO = 0x1005;
+constexpr u32 OPTION_RCVTIMEO = 0x1006;
+constexpr u32 OPTION_ERROR = 0x1007;
+
+struct TimeVal {
+    s64 sec;
+    s64 usec;
+};
+static_assert(sizeof(TimeVal) == 0x10, "TimeVal has incorrect size.");
+
+struct SelectParameters {
+    s32 nfds;
+    INSERT_PADDING_WORDS(1);
+    TimeVal timeout;
+    bool null_timeout;
+    INSERT_PADDING_BYTES(7);
+};
+static_assert(sizeof(SelectParameters) == 0x20, "SelectParameters has incorrect size.");
+
+void WriteResponse(Kernel::HLERequestContext& ctx, s32 ret, Errno error) {
+    IPC::ResponseBuilder rb{ctx, 4};
+    rb.Push(RESULT_SUCCESS);
+    rb.Push<s32>(error == Errno::SUCCESS ? ret : -1);
+    rb.Push(static_cast<u32>(error));
+}
+
+/// Writes the response of the calls that also return the length of an output buffer
+void WriteResponse(Kernel::HLERequestContext& ctx, s32 ret, Errno error, u32 length) {
+    IPC::ResponseBuilder rb{ctx, 5};
+    rb.Push(RESULT_SUCCESS);
+    rb.Push<s32>(error == Errno::SUCCESS ? ret : -1);
+    rb.Push(static_cast<u32>(error));
+    rb.Push<u32>(length);
+}
+
+bool ReadAddress(const Kernel::HLERequestContext& ctx, int buffer_index, SockAddrIn& address) {
+    const std::vector<u8> buffer = ctx.ReadBuffer(buffer_index);
+    if (buffer.size() < sizeof(SockAddrIn))
+        return false;
+    std::memcpy(&address, buffer.data(), sizeof(SockAddrIn));
+    return true;
+}
+
+/// Converts a timeout set by the guest to milliseconds, where zero means waiting forever
+s64 ToTimeout(const TimeVal& time) {
+    const s64 timeout = time.sec * 1000 + time.usec / 1000;
+    return timeout == 0 ? -1 : timeout;
+}
+
+TimeVal FromTimeout(s64 timeout) {
+    return timeout < 0 ? TimeVal{} : TimeVal{timeout / 1000, (timeout % 1000) * 1000};
+}
+
+bool IsFdSet(const std::vector<u8>& set, s32 fd) {
+    const auto byte = static_cast<std::size_t>(fd / 8);
+    return byte < set.size() && (set[byte] & (1 << (fd % 8))) != 0;
+}
+
+void SetFd(std::vector<u8>& set, s32 fd) {
+    set[fd / 8] |= static_cast<u8>(1 << (fd % 8));
+}
+
+} // Anonymous namespace
+
 void BSD::RegisterClient(Kernel::HLERequestContext& ctx) {
     LOG_WARNING(Service, "(STUBBED) called");
 
@@ -27,49 +107,660 @@ void BSD::StartMonitoring(Kernel::HLERequestContext& ctx) {
 void BSD::Socket(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp{ctx};
 
-    u32 domain = rp.Pop<u32>();
-    u32 type = rp.Pop<u32>();
-    u32 protocol = rp.Pop<u32>();
+    const u32 domain = rp.Pop<u32>();
+    const u32 type = rp.Pop<u32>();
+    const u32 protocol = rp.Pop<u32>();
 
-    LOG_WARNING(Service, "(STUBBED) called domain={} type={} protocol={}", domain, type, protocol);
+    LOG_DEBUG(Service, "called domain={} type={} protocol={}", domain, type, protocol);
 
-    u32 fd = next_fd++;
+    const auto free_fd = std::find(file_descriptors.begin(), file_descriptors.end(), boost::none);
+    if (free_fd == file_descriptors.end()) {
+        WriteResponse(ctx, -1, Errno::MFILE);
+        return;
+    }
 
-    IPC::ResponseBuilder rb{ctx, 4};
+    auto [socket, error] =
+        HostSocket::Open(static_cast<Domain>(domain), static_cast<Type>(type), protocol);
+    if (error != Errno::SUCCESS) {
+        WriteResponse(ctx, -1, error);
+        return;
+    }
 
-    rb.Push(RESULT_SUCCESS);
-    rb.Push<u32>(fd);
-    rb.Push<u32>(0); // bsd errno
+    *free_fd = FileDescriptor{std::move(socket)};
+    WriteResponse(ctx, static_cast<s32>(free_fd - file_descriptors.begin()), Errno::SUCCESS);
 }
 
-void BSD::Connect(Kernel::HLERequestContext& ctx) {
-    LOG_WARNING(Service, "(STUBBED) called");
+void BSD::Select(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
+    const auto parameters = rp.PopRaw<SelectParameters>();
+    const s64 timeout = parameters.null_timeout
+                            ? -1
+                            : parameters.timeout.sec * 1000 + parameters.timeout.usec / 1000;
 
-    IPC::ResponseBuilder rb{ctx, 4};
+    LOG_DEBUG(Service, "called nfds={} timeout={}", parameters.nfds, timeout);
 
-    rb.Push(RESULT_SUCCESS);
-    rb.Push<u32>(0); // ret
-    rb.Push<u32>(0); // bsd errno
+    // Select is served by polling the sockets of the sets
+    const std::array<std::vector<u8>, 3> sets{ctx.ReadBuffer(0), ctx.ReadBuffer(1),
+                                              ctx.ReadBuffer(2)};
+    std::vector<PollFD> fds;
+    const s32 nfds = std::clamp<s32>(parameters.nfds, 0, static_cast<s32>(MAX_FD));
+    for (s32 fd = 0; fd < nfds; ++fd) {
+        u16 events = 0;
+        if (IsFdSet(sets[0], fd))
+            events |= PollIn;
+        if (IsFdSet(sets[1], fd))
+            events |= PollOut;
+        if (IsFdSet(sets[2], fd))
+            events |= PollPri;
+        if (events != 0)
+            fds.push_back({fd, events, 0});
+    }
+
+    std::vector<HostPollFD> host_fds;
+    for (const auto& fd : fds) {
+        if (const auto* descriptor = GetFileDescriptor(fd.fd)) {
+            host_fds.push_back({descriptor->socket->GetHandle(), fd.events, 0});
+        }
+    }
+
+    CallBlocking(ctx, "BSD:Select", std::move(host_fds), timeout,
+                 [this, fds, sets, timeout](Kernel::HLERequestContext& ctx, bool may_wait) mutable {
+                     const auto [ret, error] = PollImmediate(fds);
+                     if (ret == 0 && error == Errno::SUCCESS && may_wait && timeout != 0)
+                         return false;
+
+                     std::array<std::vector<u8>, 3> ready_sets;
+                     s32 num_ready = 0;
+                     for (std::size_t i = 0; i < sets.size(); ++i) {
+                         ready_sets[i].resize(sets[i].size());
+                     }
+                     for (const auto& fd : fds) {
+                         if (fd.revents & PollNval) {
+                             WriteResponse(ctx, -1, Errno::BADF);
+                             return true;
+                         }
+                         const u16 read_events = PollIn | PollHup | PollErr;
+                         const u16 write_events = PollOut | PollHup | PollErr;
+                         const std::array<bool, 3> is_ready{
+                             (fd.events & PollIn) && (fd.revents & read_events),
+                             (fd.events & PollOut) && (fd.revents & write_events),
+                             (fd.events & PollPri) && (fd.revents & PollPri)};
+                         for (std::size_t i = 0; i < is_ready.size(); ++i) {
+                             if (is_ready[i]) {
+                                 SetFd(ready_sets[i], fd.fd);
+                                 ++num_ready;
+                             }
+                         }
+                     }
+
+                     for (std::size_t i = 0; i < ready_sets.size(); ++i) {
+                         if (!ready_sets[i].empty()) {
+                             ctx.WriteBuffer(ready_sets[i], static_cast<int>(i));
+                         }
+                     }
+                     WriteResponse(ctx, num_ready, error);
+                     return true;
+                 });
+}
+
+void BSD::Poll(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
+    const s32 nfds = rp.Pop<s32>();
+    const s32 timeout = rp.Pop<s32>();
+
+    LOG_DEBUG(Service, "called nfds={} timeout={}", nfds, timeout);
+
+    const std::vector<u8> buffer = ctx.ReadBuffer();
+    if (nfds < 0 || buffer.size() < static_cast<std::size_t>(nfds) * sizeof(PollFD)) {
+        WriteResponse(ctx, -1, Errno::INVAL);
+        return;
+    }
+    std::vector<PollFD> fds(nfds);
+    std::memcpy(fds.data(), buffer.data(), fds.size() * sizeof(PollFD));
+
+    std::vector<HostPollFD> host_fds;
+    for (const auto& fd : fds) {
+        if (const auto* descriptor = GetFileDescriptor(fd.fd)) {
+            host_fds.push_back({descriptor->socket->GetHandle(), fd.events, 0});
+        }
+    }
+
+    CallBlocking(ctx, "BSD:Poll", std::move(host_fds), timeout,
+                 [this, fds, timeout](Kernel::HLERequestContext& ctx, bool may_wait) mutable {
+                     const auto [ret, error] = PollImmediate(fds);
+                     if (ret == 0 && error == Errno::SUCCESS && may_wait && timeout != 0)
+                         return false;
+
+                     if (!fds.empty()) {
+                         ctx.WriteBuffer(fds);
+                     }
+                     WriteResponse(ctx, ret, error);
+                     return true;
+                 });
+}
+
+void BSD::Recv(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
+    const s32 fd = rp.Pop<s32>();
+    const u32 flags = rp.Pop<u32>();
+
+    LOG_DEBUG(Service, "called fd={} flags=0x{:X}", fd, flags);
+    RecvImpl(ctx, fd, flags, false);
+}
+
+void BSD::RecvFrom(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
+    const s32 fd = rp.Pop<s32>();
+    const u32 flags = rp.Pop<u32>();
+
+    LOG_DEBUG(Service, "called fd={} flags=0x{:X}", fd, flags);
+    RecvImpl(ctx, fd, flags, true);
+}
+
+void BSD::Send(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
+    const s32 fd = rp.Pop<s32>();
+    const u32 flags = rp.Pop<u32>();
+
+    LOG_DEBUG(Service, "called fd={} flags=0x{:X}", fd, flags);
+    SendImpl(ctx, fd, flags, boost::none);
 }
 
 void BSD::SendTo(Kernel::HLERequestContext& ctx) {
-    LOG_WARNING(Service, "(STUBBED) called");
+    IPC::RequestParser rp{ctx};
+    const s32 fd = rp.Pop<s32>();
+    const u32 flags = rp.Pop<u32>();
 
-    IPC::ResponseBuilder rb{ctx, 4};
+    LOG_DEBUG(Service, "called fd={} flags=0x{:X}", fd, flags);
 
-    rb.Push(RESULT_SUCCESS);
-    rb.Push<u32>(0); // ret
-    rb.Push<u32>(0); // bsd errno
+    SockAddrIn address;
+    if (!ReadAddress(ctx, 1, address)) {
+        WriteResponse(ctx, -1, Errno::INVAL);
+        return;
+    }
+    SendImpl(ctx, fd, flags, address);
+}
+
+void BSD::Accept(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
+    const s32 fd = rp.Pop<s32>();
+
+    LOG_DEBUG(Service, "called fd={}", fd);
+
+    const FileDescriptor* descriptor = GetFileDescriptor(fd);
+    if (descriptor == nullptr) {
+        WriteResponse(ctx, -1, Errno::BADF, 0);
+        return;
+    }
+
+    const SocketCall call = [this, fd](Kernel::HLERequestContext& ctx, bool may_wait) {
+        FileDescriptor* descriptor = GetFileDescriptor(fd);
+        if (descriptor == nullptr) {
+            WriteResponse(ctx, -1, Errno::BADF, 0);
+            return true;
+        }
+
+        const auto free_fd =
+            std::find(file_descriptors.begin(), file_descriptors.end(), boost::none);
+        if (free_fd == file_descriptors.end()) {
+            WriteResponse(ctx, -1, Errno::MFILE, 0);
+            return true;
+        }
+
+        SockAddrIn address{};
+        auto [socket, error] = descriptor->socket->Accept(address);
+        if (error == Errno::AGAIN && may_wait)
+            return false;
+        if (error != Errno::SUCCESS) {
+            WriteResponse(ctx, -1, error, 0);
+            return true;
+        }
+
+        *free_fd = FileDescriptor{std::move(socket)};
+        ctx.WriteBuffer(&address, sizeof(address));
+        WriteResponse(ctx, static_cast<s32>(free_fd - file_descriptors.begin()), Errno::SUCCESS,
+                      sizeof(address));
+        return true;
+    };
+
+    if (!descriptor->is_blocking) {
+        call(ctx, false);
+        return;
+    }
+    CallBlocking(ctx, "BSD:Accept", {{descriptor->socket->GetHandle(), PollIn, 0}},
+                 descriptor->recv_timeout, call);
+}
+
+void BSD::Bind(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
+    const s32 fd = rp.Pop<s32>();
+
+    LOG_DEBUG(Service, "called fd={}", fd);
+
+    FileDescriptor* descriptor = GetFileDescriptor(fd);
+    SockAddrIn address;
+    if (descriptor == nullptr) {
+        WriteResponse(ctx, -1, Errno::BADF);
+    } else if (!ReadAddress(ctx, 0, address)) {
+        WriteResponse(ctx, -1, Errno::INVAL);
+    } else {
+        WriteResponse(ctx, 0, descriptor->socket->Bind(address));
+    }
+}
+
+void BSD::Connect(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
+    const s32 fd = rp.Pop<s32>();
+
+    LOG_DEBUG(Service, "called fd={}", fd);
+
+    FileDescriptor* descriptor = GetFileDescriptor(fd);
+    SockAddrIn address;
+    if (descriptor == nullptr) {
+        WriteResponse(ctx, -1, Errno::BADF);
+        return;
+    }
+    if (!ReadAddress(ctx, 0, address)) {
+        WriteResponse(ctx, -1, Errno::INVAL);
+        return;
+    }
+
+    const Errno error = descriptor->socket->Connect(address);
+    if (error != Errno::INPROGRESS || !descriptor->is_blocking) {
+        WriteResponse(ctx, 0, error);
+        return;
+    }
+
+    // Wait for the connection to be established, then report how it went
+    CallBlocking(ctx, "BSD:Connect", {{descriptor->socket->GetHandle(), PollOut, 0}},
+                 descriptor->send_timeout,
+                 [this, fd](Kernel::HLERequestContext& ctx, bool may_wait) {
+                     if (may_wait)
+                         return false;
+
+                     const FileDescriptor* descriptor = GetFileDescriptor(fd);
+                     if (descriptor == nullptr) {
+                         WriteResponse(ctx, -1, Errno::BADF);
+                         return true;
+                     }
+
+                     std::vector<u8> value;
+                     Errno error =
+                         descriptor->socket->GetSockOpt(LEVEL_SOCKET, OPTION_ERROR, value);
+                     if (error == Errno::SUCCESS) {
+                         std::memcpy(&error, value.data(), sizeof(error));
+                     }
+                     if (error == Errno::SUCCESS &&
+                         descriptor->socket->GetPeerName().second != Errno::SUCCESS) {
+                         error = Errno::TIMEDOUT;
+                     }
+                     WriteResponse(ctx, 0, error);
+                     return true;
+                 });
+}
+
+void BSD::GetPeerName(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
+    const s32 fd = rp.Pop<s32>();
+
+    LOG_DEBUG(Service, "called fd={}", fd);
+
+    const FileDescriptor* descriptor = GetFileDescriptor(fd);
+    if (descriptor == nullptr) {
+        WriteResponse(ctx, -1, Errno::BADF, 0);
+        return;
+    }
+
+    const auto [address, error] = descriptor->socket->GetPeerName();
+    if (error != Errno::SUCCESS) {
+        WriteResponse(ctx, -1, error, 0);
+        return;
+    }
+    ctx.WriteBuffer(&address, sizeof(address));
+    WriteResponse(ctx, 0, Errno::SUCCESS, sizeof(address));
+}
+
+void BSD::GetSockName(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
+    const s32 fd = rp.Pop<s32>();
+
+    LOG_DEBUG(Service, "called fd={}", fd);
+
+    const FileDescriptor* descriptor = GetFileDescriptor(fd);
+    if (descriptor == nullptr) {
+        WriteResponse(ctx, -1, Errno::BADF, 0);
+        return;
+    }
+
+    const auto [address, error] = descriptor->socket->GetSockName();
+    if (error != Errno::SUCCESS) {
+        WriteResponse(ctx, -1, error, 0);
+        return;
+    }
+    ctx.WriteBuffer(&address, sizeof(address));
+    WriteResponse(ctx, 0, Errno::SUCCESS, sizeof(address));
+}
+
+void BSD::GetSockOpt(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
+    const s32 fd = rp.Pop<s32>();
+    const u32 level = rp.Pop<u32>();
+    const u32 option = rp.Pop<u32>();
+
+    LOG_DEBUG(Service, "called fd={} level=0x{:X} option=0x{:X}", fd, level, option);
+
+    const FileDescriptor* descriptor = GetFileDescriptor(fd);
+    if (descriptor == nullptr) {
+        WriteResponse(ctx, -1, Errno::BADF, 0);
+        return;
+    }
+
+    // Timeouts only apply to the guest, the host socket never blocks
+    if (level == LEVEL_SOCKET && (option == OPTION_SNDTIMEO || option == OPTION_RCVTIMEO)) {
+        const TimeVal time = FromTimeout(option == OPTION_SNDTIMEO ? descriptor->send_timeout
+                                                                    : descriptor->recv_timeout);
+        ctx.WriteBuffer(&time, sizeof(time));
+        WriteResponse(ctx, 0, Errno::SUCCESS, sizeof(time));
+        return;
+    }
+
+    std::vector<u8> value;
+    const Errno error = descriptor->socket->GetSockOpt(level, option, value);
+    if (error != Errno::SUCCESS) {
+        WriteResponse(ctx, -1, error, 0);
+        return;
+    }
+    ctx.WriteBuffer(value);
+    WriteResponse(ctx, 0, Errno::SUCCESS, static_cast<u32>(value.size()));
+}
+
+void BSD::Listen(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
+    const s32 fd = rp.Pop<s32>();
+    const s32 backlog = rp.Pop<s32>();
+
+    LOG_DEBUG(Service, "called fd={} backlog={}", fd, backlog);
+
+    FileDescriptor* descriptor = GetFileDescriptor(fd);
+    if (descriptor == nullptr) {
+        WriteResponse(ctx, -1, Errno::BADF);
+        return;
+    }
+    WriteResponse(ctx, 0, descriptor->socket->Listen(backlog));
+}
+
+void BSD::Fcntl(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
+    const s32 fd = rp.Pop<s32>();
+    const u32 cmd = rp.Pop<u32>();
+    const u32 arg = rp.Pop<u32>();
+
+    LOG_DEBUG(Service, "called fd={} cmd={} arg=0x{:X}", fd, cmd, arg);
+
+    FileDescriptor* descriptor = GetFileDescriptor(fd);
+    if (descriptor == nullptr) {
+        WriteResponse(ctx, -1, Errno::BADF);
+        return;
+    }
+
+    switch (cmd) {
+    case FCNTL_GETFL:
+        WriteResponse(ctx, descriptor->is_blocking ? 0 : static_cast<s32>(FLAG_NONBLOCK),
+                      Errno::SUCCESS);
+        break;
+    case FCNTL_SETFL:
+        descriptor->is_blocking = (arg & FLAG_NONBLOCK) == 0;
+        WriteResponse(ctx, 0, Errno::SUCCESS);
+        break;
+    default:
+        LOG_WARNING(Service, "Unimplemented fcntl cmd={}", cmd);
+        WriteResponse(ctx, -1, Errno::INVAL);
+        break;
+    }
+}
+
+void BSD::SetSockOpt(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
+    const s32 fd = rp.Pop<s32>();
+    const u32 level = rp.Pop<u32>();
+    const u32 option = rp.Pop<u32>();
+
+    LOG_DEBUG(Service, "called fd={} level=0x{:X} option=0x{:X}", fd, level, option);
+
+    FileDescriptor* descriptor = GetFileDescriptor(fd);
+    if (descriptor == nullptr) {
+        WriteResponse(ctx, -1, Errno::BADF);
+        return;
+    }
+
+    const std::vector<u8> value = ctx.ReadBuffer();
+    if (level == LEVEL_SOCKET && (option == OPTION_SNDTIMEO || option == OPTION_RCVTIMEO)) {
+        TimeVal time;
+        if (value.size() < sizeof(time)) {
+            WriteResponse(ctx, -1, Errno::INVAL);
+            return;
+        }
+        std::memcpy(&time, value.data(), sizeof(time));
+        if (option == OPTION_SNDTIMEO) {
+            descriptor->send_timeout = ToTimeout(time);
+        } else {
+            descriptor->recv_timeout = ToTimeout(time);
+        }
+        WriteResponse(ctx, 0, Errno::SUCCESS);
+        return;
+    }
+
+    const Errno error = descriptor->socket->SetSockOpt(level, option, value);
+    if (error == Errno::NOPROTOOPT) {
+        // Options that only tune the connection shouldn't stop the guest from using it
+        LOG_WARNING(Service, "Ignoring unsupported socket option level=0x{:X} option=0x{:X}",
+                    level, option);
+        WriteResponse(ctx, 0, Errno::SUCCESS);
+        return;
+    }
+    WriteResponse(ctx, 0, error);
+}
+
+void BSD::Shutdown(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
+    const s32 fd = rp.Pop<s32>();
+    const s32 how = rp.Pop<s32>();
+
+    LOG_DEBUG(Service, "called fd={} how={}", fd, how);
+
+    FileDescriptor* descriptor = GetFileDescriptor(fd);
+    if (descriptor == nullptr) {
+        WriteResponse(ctx, -1, Errno::BADF);
+        return;
+    }
+    WriteResponse(ctx, 0, descriptor->socket->Shutdown(how));
+}
+
+void BSD::Write(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
+    const s32 fd = rp.Pop<s32>();
+
+    LOG_DEBUG(Service, "called fd={}", fd);
+    SendImpl(ctx, fd, 0, boost::none);
+}
+
+void BSD::Read(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
+    const s32 fd = rp.Pop<s32>();
+
+    LOG_DEBUG(Service, "called fd={}", fd);
+    RecvImpl(ctx, fd, 0, false);
 }
 
 void BSD::Close(Kernel::HLERequestContext& ctx) {
-    LOG_WARNING(Service, "(STUBBED) called");
+    IPC::RequestParser rp{ctx};
+    const s32 fd = rp.Pop<s32>();
 
-    IPC::ResponseBuilder rb{ctx, 4};
+    LOG_DEBUG(Service, "called fd={}", fd);
+
+    const FileDescriptor* descriptor = GetFileDescriptor(fd);
+    if (descriptor == nullptr) {
+        WriteResponse(ctx, -1, Errno::BADF);
+        return;
+    }
+
+    // Wake the threads blocked on the socket, they will find it closed
+    if (poller != nullptr) {
+        poller->Cancel(descriptor->socket->GetHandle());
+    }
+    file_descriptors[fd] = boost::none;
+    WriteResponse(ctx, 0, Errno::SUCCESS);
+}
+
+void BSD::RecvImpl(Kernel::HLERequestContext& ctx, s32 fd, u32 flags, bool with_address) {
+    const FileDescriptor* descriptor = GetFileDescriptor(fd);
+    const auto write_error = [with_address](Kernel::HLERequestContext& ctx, Errno error) {
+        if (with_address) {
+            WriteResponse(ctx, -1, error, 0);
+        } else {
+            WriteResponse(ctx, -1, error);
+        }
+    };
+    if (descriptor == nullptr) {
+        write_error(ctx, Errno::BADF);
+        return;
+    }
+
+    const std::size_t size = ctx.GetWriteBufferSize();
+    const SocketCall call = [this, fd, flags, with_address, size,
+                             write_error](Kernel::HLERequestContext& ctx, bool may_wait) {
+        const FileDescriptor* descriptor = GetFileDescriptor(fd);
+        if (descriptor == nullptr) {
+            write_error(ctx, Errno::BADF);
+            return true;
+        }
+
+        std::vector<u8> buffer(size);
+        SockAddrIn address{};
+        const auto [ret, error] =
+            descriptor->socket->Recv(flags, buffer, with_address ? &address : nullptr);
+        if (error == Errno::AGAIN && may_wait)
+            return false;
+        if (error != Errno::SUCCESS) {
+            write_error(ctx, error);
+            return true;
+        }
+
+        if (!buffer.empty()) {
+            ctx.WriteBuffer(buffer);
+        }
+        if (with_address) {
+            ctx.WriteBuffer(&address, sizeof(address), 1);
+            WriteResponse(ctx, ret, Errno::SUCCESS, sizeof(address));
+        } else {
+            WriteResponse(ctx, ret, Errno::SUCCESS);
+        }
+        return true;
+    };
+
+    if (!descriptor->is_blocking || (flags & MSG_FLAG_DONTWAIT) != 0) {
+        call(ctx, false);
+        return;
+    }
+    CallBlocking(ctx, "BSD:Recv", {{descriptor->socket->GetHandle(), PollIn, 0}},
+                 descriptor->recv_timeout, call);
+}
+
+void BSD::SendImpl(Kernel::HLERequestContext& ctx, s32 fd, u32 flags,
+                   boost::optional<SockAddrIn> address) {
+    const FileDescriptor* descriptor = GetFileDescriptor(fd);
+    if (descriptor == nullptr) {
+        WriteResponse(ctx, -1, Errno::BADF);
+        return;
+    }
+
+    const std::vector<u8> message = ctx.ReadBuffer();
+    const SocketCall call = [this, fd, flags, address,
+                             message](Kernel::HLERequestContext& ctx, bool may_wait) {
+        const FileDescriptor* descriptor = GetFileDescriptor(fd);
+        if (descriptor == nullptr) {
+            WriteResponse(ctx, -1, Errno::BADF);
+            return true;
+        }
+
+        const auto [ret, error] =
+            descriptor->socket->Send(flags, message, address ? &*address : nullptr);
+        if (error == Errno::AGAIN && may_wait)
+            return false;
+        WriteResponse(ctx, ret, error);
+        return true;
+    };
+
+    if (!descriptor->is_blocking || (flags & MSG_FLAG_DONTWAIT) != 0) {
+        call(ctx, false);
+        return;
+    }
+    CallBlocking(ctx, "BSD:Send", {{descriptor->socket->GetHandle(), PollOut, 0}},
+                 descriptor->send_timeout, call);
+}
+
+void BSD::CallBlocking(Kernel::HLERequestContext& ctx, const char* reason,
+                       std::vector<HostPollFD> fds, s64 timeout, SocketCall call) {
+    if (call(ctx, true))
+        return;
+
+    // The guest thread sleeps until the poller thread sees the socket ready, then the call is made
+    // again on the emulated core. If the data was taken in the meantime it fails with AGAIN.
+    auto& kernel = Core::System::GetInstance().Kernel();
+    const auto event = ctx.SleepClientThread(
+        Kernel::GetCurrentThread(), reason, 0,
+        [call](Kernel::SharedPtr<Kernel::Thread>, Kernel::HLERequestContext& ctx,
+               Kernel::ThreadWakeupReason) { call(ctx, false); });
+    GetPoller().Watch(std::move(fds), timeout, kernel.CreateThreadsafeEventHandle(event));
 
+    // Placeholder response, written again once the thread wakes up
+    IPC::ResponseBuilder rb{ctx, 2};
     rb.Push(RESULT_SUCCESS);
-    rb.Push<u32>(0); // ret
-    rb.Push<u32>(0); // bsd errno
+}
+
+std::pair<s32, Errno> BSD::PollImmediate(std::vector<PollFD>& fds) {
+    std::vector<HostPollFD> host_fds;
+    for (auto& fd : fds) {
+        fd.revents = 0;
+        if (fd.fd < 0)
+            continue;
+        if (const auto* descriptor = GetFileDescriptor(fd.fd)) {
+            host_fds.push_back({descriptor->socket->GetHandle(), fd.events, 0});
+        } else {
+            fd.revents = PollNval;
+        }
+    }
+
+    if (!host_fds.empty()) {
+        const auto [ret, error] = PollHostSockets(host_fds, 0);
+        if (error != Errno::SUCCESS)
+            return {-1, error};
+    }
+
+    s32 num_ready = 0;
+    auto host_fd = host_fds.begin();
+    for (auto& fd : fds) {
+        if (fd.fd >= 0 && fd.revents != PollNval) {
+            fd.revents = (host_fd++)->revents;
+        }
+        num_ready += fd.revents != 0 ? 1 : 0;
+    }
+    return {num_ready, Errno::SUCCESS};
+}
+
+BSD::FileDescriptor* BSD::GetFileDescriptor(s32 fd) {
+    if (fd < 0 || static_cast<std::size_t>(fd) >= file_descriptors.size() ||
+        !file_descriptors[fd]) {
+        return nullptr;
+    }
+    return &*file_descriptors[fd];
+}
+
+SocketPoller& BSD::GetPoller() {
+    if (poller == nullptr) {
+        poller = std::make_unique<SocketPoller>(Core::System::GetInstance().Kernel());
+    }
+    return *poller;
 }
 
 BSD::BSD(const char* name) : ServiceFramework(name) {
@@ -79,27 +770,27 @@ BSD::BSD(const char* name) : ServiceFramework(name) {
         {2, &BSD::Socket, "Socket"},
         {3, nullptr, "SocketExempt"},
         {4, nullptr, "Open"},
-        {5, nullptr, "Select"},
-        {6, nullptr, "Poll"},
+        {5, &BSD::Select, "Select"},
+        {6, &BSD::Poll, "Poll"},
         {7, nullptr, "Sysctl"},
-        {8, nullptr, "Recv"},
-        {9, nullptr, "RecvFrom"},
-        {10, nullptr, "Send"},
+        {8, &BSD::Recv, "Recv"},
+        {9, &BSD::RecvFrom, "RecvFrom"},
+        {10, &BSD::Send, "Send"},
         {11, &BSD::SendTo, "SendTo"},
-        {12, nullptr, "Accept"},
-        {13, nullptr, "Bind"},
+        {12, &BSD::Accept, "Accept"},
+        {13, &BSD::Bind, "Bind"},
         {14, &BSD::Connect, "Connect"},
-        {15, nullptr, "GetPeerName"},
-        {16, nullptr, "GetSockName"},
-        {17, nullptr, "GetSockOpt"},
-        {18, nullptr, "Listen"},
+        {15, &BSD::GetPeerName, "GetPeerName"},
+        {16, &BSD::GetSockName, "GetSockName"},
+        {17, &BSD::GetSockOpt, "GetSockOpt"},
+        {18, &BSD::Listen, "Listen"},
         {19, nullptr, "Ioctl"},
-        {20, nullptr, "Fcntl"},
-        {21, nullptr, "SetSockOpt"},
-        {22, nullptr, "Shutdown"},
+        {20, &BSD::Fcntl, "Fcntl"},
+        {21, &BSD::SetSockOpt, "SetSockOpt"},
+        {22, &BSD::Shutdown, "Shutdown"},
         {23, nullptr, "ShutdownAllSockets"},
-        {24, nullptr, "Write"},
-        {25, nullptr, "Read"},
+        {24, &BSD::Write, "Write"},
+        {25, &BSD::Read, "Read"},
         {26, &BSD::Close, "Close"},
         {27, nullptr, "DuplicateSocket"},
         {28, nullptr, "GetResourceStatistics"},
@@ -4,26 +4,95 @@
 
 #pragma once
 
+#include <array>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <boost/optional.hpp>
 #include "core/hle/kernel/hle_ipc.h"
 #include "core/hle/service/service.h"
+#include "core/hle/service/sockets/host_socket.h"
 
 namespace Service::Sockets {
 
+class SocketPoller;
+
+/// Poll request in the layout used by the guest
+struct PollFD {
+    s32 fd;
+    u16 events;
+    u16 revents;
+};
+static_assert(sizeof(PollFD) == 8, "PollFD has incorrect size.");
+
 class BSD final : public ServiceFramework<BSD> {
 public:
     explicit BSD(const char* name);
     ~BSD() override;
 
 private:
+    struct FileDescriptor {
+        std::unique_ptr<HostSocket> socket;
+        /// Whether calls block the guest thread, the host socket itself never blocks
+        bool is_blocking = true;
+        /// Timeouts of blocking calls in milliseconds, negative to wait forever
+        s64 recv_timeout = -1;
+        s64 send_timeout = -1;
+    };
+
+    /**
+     * Attempts a call that may have to wait for the socket. Returns true once the response has been
+     * written, or false without writing anything if the call would block and may wait.
+     */
+    using SocketCall = std::function<bool(Kernel::HLERequestContext& ctx, bool may_wait)>;
+
     void RegisterClient(Kernel::HLERequestContext& ctx);
     void StartMonitoring(Kernel::HLERequestContext& ctx);
     void Socket(Kernel::HLERequestContext& ctx);
-    void Connect(Kernel::HLERequestContext& ctx);
+    void Select(Kernel::HLERequestContext& ctx);
+    void Poll(Kernel::HLERequestContext& ctx);
+    void Recv(Kernel::HLERequestContext& ctx);
+    void RecvFrom(Kernel::HLERequestContext& ctx);
+    void Send(Kernel::HLERequestContext& ctx);
     void SendTo(Kernel::HLERequestContext& ctx);
+    void Accept(Kernel::HLERequestContext& ctx);
+    void Bind(Kernel::HLERequestContext& ctx);
+    void Connect(Kernel::HLERequestContext& ctx);
+    void GetPeerName(Kernel::HLERequestContext& ctx);
+    void GetSockName(Kernel::HLERequestContext& ctx);
+    void GetSockOpt(Kernel::HLERequestContext& ctx);
+    void Listen(Kernel::HLERequestContext& ctx);
+    void Fcntl(Kernel::HLERequestContext& ctx);
+    void SetSockOpt(Kernel::HLERequestContext& ctx);
+    void Shutdown(Kernel::HLERequestContext& ctx);
+    void Write(Kernel::HLERequestContext& ctx);
+    void Read(Kernel::HLERequestContext& ctx);
     void Close(Kernel::HLERequestContext& ctx);
 
-    /// Id to use for the next open file descriptor.
-    u32 next_fd = 1;
+    void RecvImpl(Kernel::HLERequestContext& ctx, s32 fd, u32 flags, bool with_address);
+    void SendImpl(Kernel::HLERequestContext& ctx, s32 fd, u32 flags,
+                  boost::optional<SockAddrIn> address);
+
+    /**
+     * Runs the call, and when it would block, parks the guest thread until the socket has one of
+     * the events or the timeout expires. The call is then made once more without waiting.
+     */
+    void CallBlocking(Kernel::HLERequestContext& ctx, const char* reason,
+                      std::vector<HostPollFD> fds, s64 timeout, SocketCall call);
+
+    /// Polls the sockets of the guest without waiting, filling in their revents
+    std::pair<s32, Errno> PollImmediate(std::vector<PollFD>& fds);
+
+    /// Returns the open file descriptor with the given number, or nullptr
+    FileDescriptor* GetFileDescriptor(s32 fd);
+
+    SocketPoller& GetPoller();
+
+    static constexpr std::size_t MAX_FD = 128;
+    std::array<boost::optional<FileDescriptor>, MAX_FD> file_descriptors;
+
+    /// Created on the first blocking call, and destroyed before the sockets it may be polling
+    std::unique_ptr<SocketPoller> poller;
 };
 
 class BSDCFG final : public ServiceFramework<BSDCFG> {
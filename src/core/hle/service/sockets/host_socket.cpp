@@ -0,0 +1,506 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <mutex>
+
+#ifdef _WIN32
+#include <winsock2.h>
+// winsock2.h needs to be included first to prevent winsock.h being included by other includes
+#include <ws2tcpip.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "core/hle/service/sockets/host_socket.h"
+
+namespace Service::Sockets {
+
+namespace {
+
+constexpr u8 GUEST_AF_INET = static_cast<u8>(Domain::INET);
+constexpr u32 GUEST_SOL_SOCKET = 0xFFFF;
+constexpr u32 GUEST_IPPROTO_TCP = 6;
+
+#ifdef _WIN32
+using socklen_t = int;
+constexpr HostSocketHandle INVALID_HANDLE = INVALID_SOCKET;
+#define HOST_ERROR(name) WSAE##name
+
+int GetLastHostError() {
+    return WSAGetLastError();
+}
+
+void CloseHostSocket(HostSocketHandle handle) {
+    closesocket(static_cast<SOCKET>(handle));
+}
+
+bool SetNonBlocking(HostSocketHandle handle) {
+    u_long enable = 1;
+    return ioctlsocket(static_cast<SOCKET>(handle), FIONBIO, &enable) == 0;
+}
+
+void InitializeHostSockets() {
+    static std::once_flag flag;
+    std::call_once(flag, [] {
+        WSADATA data;
+        WSAStartup(MAKEWORD(2, 2), &data);
+    });
+}
+#else
+constexpr HostSocketHandle INVALID_HANDLE = -1;
+#define HOST_ERROR(name) E##name
+
+int GetLastHostError() {
+    return errno;
+}
+
+void CloseHostSocket(HostSocketHandle handle) {
+    close(handle);
+}
+
+bool SetNonBlocking(HostSocketHandle handle) {
+    const int flags = fcntl(handle, F_GETFL);
+    return flags != -1 && fcntl(handle, F_SETFL, flags | O_NONBLOCK) != -1;
+}
+
+void InitializeHostSockets() {}
+#endif
+
+Errno TranslateHostError(int error) {
+#ifdef _WIN32
+    if (error == WSAESHUTDOWN)
+        return Errno::PIPE;
+#else
+    // EWOULDBLOCK is allowed to be the same value as EAGAIN, so it can't be a case of the switch
+    if (error == EWOULDBLOCK)
+        return Errno::AGAIN;
+    if (error == EPIPE)
+        return Errno::PIPE;
+    if (error == EAGAIN)
+        return Errno::AGAIN;
+#endif
+
+    switch (error) {
+    case 0:
+        return Errno::SUCCESS;
+#ifdef _WIN32
+    case WSAEWOULDBLOCK:
+        return Errno::AGAIN;
+#endif
+    case HOST_ERROR(BADF):
+        return Errno::BADF;
+    case HOST_ERROR(ACCES):
+        return Errno::ACCES;
+    case HOST_ERROR(FAULT):
+        return Errno::FAULT;
+    case HOST_ERROR(INVAL):
+        return Errno::INVAL;
+    case HOST_ERROR(MFILE):
+        return Errno::MFILE;
+    case HOST_ERROR(NOTSOCK):
+        return Errno::NOTSOCK;
+    case HOST_ERROR(MSGSIZE):
+        return Errno::MSGSIZE;
+    case HOST_ERROR(NOPROTOOPT):
+        return Errno::NOPROTOOPT;
+    case HOST_ERROR(PROTONOSUPPORT):
+        return Errno::PROTONOSUPPORT;
+    case HOST_ERROR(OPNOTSUPP):
+        return Errno::OPNOTSUPP;
+    case HOST_ERROR(AFNOSUPPORT):
+        return Errno::AFNOSUPPORT;
+    case HOST_ERROR(ADDRINUSE):
+        return Errno::ADDRINUSE;
+    case HOST_ERROR(ADDRNOTAVAIL):
+        return Errno::ADDRNOTAVAIL;
+    case HOST_ERROR(NETDOWN):
+        return Errno::NETDOWN;
+    case HOST_ERROR(NETUNREACH):
+        return Errno::NETUNREACH;
+    case HOST_ERROR(CONNABORTED):
+        return Errno::CONNABORTED;
+    case HOST_ERROR(CONNRESET):
+        return Errno::CONNRESET;
+    case HOST_ERROR(NOBUFS):
+        return Errno::NOBUFS;
+    case HOST_ERROR(ISCONN):
+        return Errno::ISCONN;
+    case HOST_ERROR(NOTCONN):
+        return Errno::NOTCONN;
+    case HOST_ERROR(TIMEDOUT):
+        return Errno::TIMEDOUT;
+    case HOST_ERROR(CONNREFUSED):
+        return Errno::CONNREFUSED;
+    case HOST_ERROR(HOSTUNREACH):
+        return Errno::HOSTUNREACH;
+    case HOST_ERROR(ALREADY):
+        return Errno::ALREADY;
+    case HOST_ERROR(INPROGRESS):
+        return Errno::INPROGRESS;
+    default:
+        LOG_ERROR(Service, "Unhandled host socket error {}", error);
+        return Errno::INVAL;
+    }
+}
+
+Errno GetLastError() {
+    return TranslateHostError(GetLastHostError());
+}
+
+sockaddr_in ToHostAddress(const SockAddrIn& address) {
+    sockaddr_in host_address{};
+    host_address.sin_family = AF_INET;
+    host_address.sin_port = address.port;
+    std::memcpy(&host_address.sin_addr, address.ip.data(), address.ip.size());
+    return host_address;
+}
+
+SockAddrIn FromHostAddress(const sockaddr_in& host_address) {
+    SockAddrIn address{};
+    address.len = sizeof(SockAddrIn);
+    address.family = GUEST_AF_INET;
+    address.port = host_address.sin_port;
+    std::memcpy(address.ip.data(), &host_address.sin_addr, address.ip.size());
+    return address;
+}
+
+int ToHostMessageFlags(u32 flags) {
+    // The host sockets never block, so MSG_FLAG_DONTWAIT has nothing to do
+    int host_flags = 0;
+    if (flags & MSG_FLAG_OOB)
+        host_flags |= MSG_OOB;
+    if (flags & MSG_FLAG_PEEK)
+        host_flags |= MSG_PEEK;
+#ifdef MSG_NOSIGNAL
+    // Report writes to closed connections as errors instead of raising SIGPIPE
+    host_flags |= MSG_NOSIGNAL;
+#endif
+    return host_flags;
+}
+
+/// Translates a socket option of the guest, returning false if it isn't supported
+bool ToHostSocketOption(u32 level, u32 option, int& host_level, int& host_option) {
+    if (level == GUEST_IPPROTO_TCP) {
+        host_level = IPPROTO_TCP;
+        if (option == 1) {
+            host_option = TCP_NODELAY;
+            return true;
+        }
+        return false;
+    }
+    if (level != GUEST_SOL_SOCKET)
+        return false;
+
+    host_level = SOL_SOCKET;
+    switch (option) {
+    case 0x4:
+        host_option = SO_REUSEADDR;
+        return true;
+    case 0x8:
+        host_option = SO_KEEPALIVE;
+        return true;
+    case 0x20:
+        host_option = SO_BROADCAST;
+        return true;
+    case 0x80:
+        host_option = SO_LINGER;
+        return true;
+    case 0x1001:
+        host_option = SO_SNDBUF;
+        return true;
+    case 0x1002:
+        host_option = SO_RCVBUF;
+        return true;
+    case 0x1007:
+        host_option = SO_ERROR;
+        return true;
+    case 0x1008:
+        host_option = SO_TYPE;
+        return true;
+    default:
+        return false;
+    }
+}
+
+/// Guest linger option, which unlike the one of some hosts uses 32-bit fields
+struct GuestLinger {
+    s32 onoff;
+    s32 linger;
+};
+
+} // Anonymous namespace
+
+std::pair<s32, Errno> PollHostSockets(std::vector<HostPollFD>& fds, s32 timeout) {
+#ifdef _WIN32
+    std::vector<WSAPOLLFD> host_fds(fds.size());
+#else
+    std::vector<pollfd> host_fds(fds.size());
+#endif
+    for (std::size_t i = 0; i < fds.size(); ++i) {
+        // WSAPoll rejects POLLPRI, so it is only asked for on other hosts
+        short events = 0;
+        if (fds[i].events & PollIn)
+            events |= POLLIN;
+        if (fds[i].events & PollOut)
+            events |= POLLOUT;
+#ifndef _WIN32
+        if (fds[i].events & PollPri)
+            events |= POLLPRI;
+#endif
+        host_fds[i].fd = fds[i].handle;
+        host_fds[i].events = events;
+        host_fds[i].revents = 0;
+    }
+
+#ifdef _WIN32
+    const int result = WSAPoll(host_fds.data(), static_cast<ULONG>(host_fds.size()), timeout);
+#else
+    const int result = poll(host_fds.data(), static_cast<nfds_t>(host_fds.size()), timeout);
+#endif
+    if (result < 0)
+        return {-1, GetLastError()};
+
+    for (std::size_t i = 0; i < fds.size(); ++i) {
+        const auto revents = host_fds[i].revents;
+        u16 guest_revents = 0;
+        if (revents & POLLIN)
+            guest_revents |= PollIn;
+        if (revents & POLLPRI)
+            guest_revents |= PollPri;
+        if (revents & POLLOUT)
+            guest_revents |= PollOut;
+        if (revents & POLLERR)
+            guest_revents |= PollErr;
+        if (revents & POLLHUP)
+            guest_revents |= PollHup;
+        if (revents & POLLNVAL)
+            guest_revents |= PollNval;
+        fds[i].revents = guest_revents;
+    }
+    return {result, Errno::SUCCESS};
+}
+
+HostSocket::HostSocket(HostSocketHandle handle) : handle(handle) {}
+
+HostSocket::~HostSocket() {
+    CloseHostSocket(handle);
+}
+
+std::pair<std::unique_ptr<HostSocket>, Errno> HostSocket::Open(Domain domain, Type type,
+                                                               u32 protocol) {
+    InitializeHostSockets();
+
+    if (domain != Domain::INET)
+        return {nullptr, Errno::AFNOSUPPORT};
+
+    int host_type;
+    switch (type) {
+    case Type::STREAM:
+        host_type = SOCK_STREAM;
+        break;
+    case Type::DGRAM:
+        host_type = SOCK_DGRAM;
+        break;
+    case Type::RAW:
+        host_type = SOCK_RAW;
+        break;
+    default:
+        return {nullptr, Errno::PROTONOSUPPORT};
+    }
+
+    const auto handle =
+        static_cast<HostSocketHandle>(socket(AF_INET, host_type, static_cast<int>(protocol)));
+    if (handle == INVALID_HANDLE)
+        return {nullptr, GetLastError()};
+
+    std::unique_ptr<HostSocket> host_socket{new HostSocket(handle)};
+    if (!SetNonBlocking(handle))
+        return {nullptr, GetLastError()};
+    return {std::move(host_socket), Errno::SUCCESS};
+}
+
+std::pair<std::unique_ptr<HostSocket>, Errno> HostSocket::Accept(SockAddrIn& address) {
+    sockaddr_in host_address{};
+    socklen_t length = sizeof(host_address);
+    const auto new_handle = static_cast<HostSocketHandle>(
+        accept(handle, reinterpret_cast<sockaddr*>(&host_address), &length));
+    if (new_handle == INVALID_HANDLE)
+        return {nullptr, GetLastError()};
+
+    // Accepted sockets don't inherit the non-blocking mode everywhere
+    std::unique_ptr<HostSocket> host_socket{new HostSocket(new_handle)};
+    if (!SetNonBlocking(new_handle))
+        return {nullptr, GetLastError()};
+
+    address = FromHostAddress(host_address);
+    return {std::move(host_socket), Errno::SUCCESS};
+}
+
+Errno HostSocket::Bind(const SockAddrIn& address) {
+    if (address.family != GUEST_AF_INET)
+        return Errno::AFNOSUPPORT;
+
+    const sockaddr_in host_address = ToHostAddress(address);
+    if (bind(handle, reinterpret_cast<const sockaddr*>(&host_address), sizeof(host_address)) != 0)
+        return GetLastError();
+    return Errno::SUCCESS;
+}
+
+Errno HostSocket::Connect(const SockAddrIn& address) {
+    if (address.family != GUEST_AF_INET)
+        return Errno::AFNOSUPPORT;
+
+    const sockaddr_in host_address = ToHostAddress(address);
+    if (connect(handle, reinterpret_cast<const sockaddr*>(&host_address), sizeof(host_address)) ==
+        0) {
+        return Errno::SUCCESS;
+    }
+
+    // Windows reports connections in progress the same way as any other call that would block
+    const Errno error = GetLastError();
+    return error == Errno::AGAIN ? Errno::INPROGRESS : error;
+}
+
+Errno HostSocket::Listen(s32 backlog) {
+    if (listen(handle, backlog) != 0)
+        return GetLastError();
+    return Errno::SUCCESS;
+}
+
+Errno HostSocket::Shutdown(s32 how) {
+    if (how < 0 || how > 2)
+        return Errno::INVAL;
+    if (shutdown(handle, how) != 0)
+        return GetLastError();
+    return Errno::SUCCESS;
+}
+
+std::pair<SockAddrIn, Errno> HostSocket::GetSockName() const {
+    sockaddr_in host_address{};
+    socklen_t length = sizeof(host_address);
+    if (getsockname(handle, reinterpret_cast<sockaddr*>(&host_address), &length) != 0)
+        return {SockAddrIn{}, GetLastError()};
+    return {FromHostAddress(host_address), Errno::SUCCESS};
+}
+
+std::pair<SockAddrIn, Errno> HostSocket::GetPeerName() const {
+    sockaddr_in host_address{};
+    socklen_t length = sizeof(host_address);
+    if (getpeername(handle, reinterpret_cast<sockaddr*>(&host_address), &length) != 0)
+        return {SockAddrIn{}, GetLastError()};
+    return {FromHostAddress(host_address), Errno::SUCCESS};
+}
+
+std::pair<s32, Errno> HostSocket::Recv(u32 flags, std::vector<u8>& buffer, SockAddrIn* address) {
+    sockaddr_in host_address{};
+    socklen_t length = sizeof(host_address);
+    const auto result =
+        recvfrom(handle, reinterpret_cast<char*>(buffer.data()), static_cast<int>(buffer.size()),
+                 ToHostMessageFlags(flags), reinterpret_cast<sockaddr*>(&host_address), &length);
+    if (result < 0)
+        return {-1, GetLastError()};
+
+    buffer.resize(static_cast<std::size_t>(result));
+    if (address != nullptr)
+        *address = FromHostAddress(host_address);
+    return {static_cast<s32>(result), Errno::SUCCESS};
+}
+
+std::pair<s32, Errno> HostSocket::Send(u32 flags, const std::vector<u8>& buffer,
+                                       const SockAddrIn* address) {
+    sockaddr_in host_address{};
+    if (address != nullptr) {
+        if (address->family != GUEST_AF_INET)
+            return {-1, Errno::AFNOSUPPORT};
+        host_address = ToHostAddress(*address);
+    }
+
+    const auto result = sendto(
+        handle, reinterpret_cast<const char*>(buffer.data()), static_cast<int>(buffer.size()),
+        ToHostMessageFlags(flags),
+        address != nullptr ? reinterpret_cast<const sockaddr*>(&host_address) : nullptr,
+        address != nullptr ? sizeof(host_address) : 0);
+    if (result < 0)
+        return {-1, GetLastError()};
+    return {static_cast<s32>(result), Errno::SUCCESS};
+}
+
+Errno HostSocket::SetSockOpt(u32 level, u32 option, const std::vector<u8>& value) {
+    int host_level;
+    int host_option;
+    if (!ToHostSocketOption(level, option, host_level, host_option))
+        return Errno::NOPROTOOPT;
+
+    if (host_level == SOL_SOCKET && host_option == SO_LINGER) {
+        GuestLinger guest_linger;
+        if (value.size() < sizeof(guest_linger))
+            return Errno::INVAL;
+        std::memcpy(&guest_linger, value.data(), sizeof(guest_linger));
+
+        linger host_linger{};
+        host_linger.l_onoff = static_cast<decltype(host_linger.l_onoff)>(guest_linger.onoff);
+        host_linger.l_linger = static_cast<decltype(host_linger.l_linger)>(guest_linger.linger);
+        if (setsockopt(handle, host_level, host_option, reinterpret_cast<const char*>(&host_linger),
+                       sizeof(host_linger)) != 0) {
+            return GetLastError();
+        }
+        return Errno::SUCCESS;
+    }
+
+    s32 host_value;
+    if (value.size() < sizeof(host_value))
+        return Errno::INVAL;
+    std::memcpy(&host_value, value.data(), sizeof(host_value));
+    if (setsockopt(handle, host_level, host_option, reinterpret_cast<const char*>(&host_value),
+                   sizeof(host_value)) != 0) {
+        return GetLastError();
+    }
+    return Errno::SUCCESS;
+}
+
+Errno HostSocket::GetSockOpt(u32 level, u32 option, std::vector<u8>& value) const {
+    int host_level;
+    int host_option;
+    if (!ToHostSocketOption(level, option, host_level, host_option))
+        return Errno::NOPROTOOPT;
+
+    if (host_level == SOL_SOCKET && host_option == SO_LINGER) {
+        linger host_linger{};
+        socklen_t length = sizeof(host_linger);
+        if (getsockopt(handle, host_level, host_option, reinterpret_cast<char*>(&host_linger),
+                       &length) != 0) {
+            return GetLastError();
+        }
+        const GuestLinger guest_linger{host_linger.l_onoff, host_linger.l_linger};
+        value.resize(sizeof(guest_linger));
+        std::memcpy(value.data(), &guest_linger, sizeof(guest_linger));
+        return Errno::SUCCESS;
+    }
+
+    s32 host_value = 0;
+    socklen_t length = sizeof(host_value);
+    if (getsockopt(handle, host_level, host_option, reinterpret_cast<char*>(&host_value),
+                   &length) != 0) {
+        return GetLastError();
+    }
+
+    // Pending errors are host error codes
+    if (host_level == SOL_SOCKET && host_option == SO_ERROR)
+        host_value = static_cast<s32>(TranslateHostError(host_value));
+
+    value.resize(sizeof(host_value));
+    std::memcpy(value.data(), &host_value, sizeof(host_value));
+    return Errno::SUCCESS;
+}
+
+} // namespace Service::Sockets
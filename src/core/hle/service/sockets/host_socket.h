@@ -0,0 +1,148 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "common/common_funcs.h"
+#include "common/common_types.h"
+
+namespace Service::Sockets {
+
+/// Error codes as seen by the guest, which follow the Linux numbering
+enum class Errno : u32 {
+    SUCCESS = 0,
+    BADF = 9,
+    AGAIN = 11,
+    ACCES = 13,
+    FAULT = 14,
+    INVAL = 22,
+    MFILE = 24,
+    PIPE = 32,
+    NOTSOCK = 88,
+    MSGSIZE = 90,
+    NOPROTOOPT = 92,
+    PROTONOSUPPORT = 93,
+    OPNOTSUPP = 95,
+    AFNOSUPPORT = 97,
+    ADDRINUSE = 98,
+    ADDRNOTAVAIL = 99,
+    NETDOWN = 100,
+    NETUNREACH = 101,
+    CONNABORTED = 103,
+    CONNRESET = 104,
+    NOBUFS = 105,
+    ISCONN = 106,
+    NOTCONN = 107,
+    TIMEDOUT = 110,
+    CONNREFUSED = 111,
+    HOSTUNREACH = 113,
+    ALREADY = 114,
+    INPROGRESS = 115,
+};
+
+/// Socket domains as used by the guest
+enum class Domain : u32 {
+    INET = 2,
+};
+
+/// Socket types as used by the guest
+enum class Type : u32 {
+    STREAM = 1,
+    DGRAM = 2,
+    RAW = 3,
+};
+
+/// IPv4 socket address in the layout used by the guest
+struct SockAddrIn {
+    u8 len;
+    u8 family;
+    u16 port; ///< Big endian
+    std::array<u8, 4> ip;
+    std::array<u8, 8> zeroes;
+};
+static_assert(sizeof(SockAddrIn) == 0x10, "SockAddrIn has incorrect size.");
+
+/// Poll events as used by the guest
+enum PollEvents : u16 {
+    PollIn = 1 << 0,
+    PollPri = 1 << 1,
+    PollOut = 1 << 2,
+    PollErr = 1 << 3,
+    PollHup = 1 << 4,
+    PollNval = 1 << 5,
+};
+
+/// Flags of the send and receive calls as used by the guest
+enum MessageFlags : u32 {
+    MSG_FLAG_OOB = 0x1,
+    MSG_FLAG_PEEK = 0x2,
+    MSG_FLAG_DONTWAIT = 0x80,
+};
+
+#ifdef _WIN32
+using HostSocketHandle = u64;
+#else
+using HostSocketHandle = int;
+#endif
+
+struct HostPollFD {
+    HostSocketHandle handle;
+    u16 events;
+    u16 revents;
+};
+
+/**
+ * Polls the given host sockets, filling in their revents.
+ * @param timeout Timeout in milliseconds, a negative value waits forever.
+ * @returns The number of sockets with events, or the error of the host call.
+ */
+std::pair<s32, Errno> PollHostSockets(std::vector<HostPollFD>& fds, s32 timeout);
+
+/**
+ * Non-blocking host socket, with calls taking and returning their arguments as seen by the guest.
+ * Calls that would block fail with Errno::AGAIN, or Errno::INPROGRESS for Connect.
+ */
+class HostSocket : NonCopyable {
+public:
+    ~HostSocket();
+
+    static std::pair<std::unique_ptr<HostSocket>, Errno> Open(Domain domain, Type type,
+                                                              u32 protocol);
+
+    std::pair<std::unique_ptr<HostSocket>, Errno> Accept(SockAddrIn& address);
+
+    Errno Bind(const SockAddrIn& address);
+    Errno Connect(const SockAddrIn& address);
+    Errno Listen(s32 backlog);
+    Errno Shutdown(s32 how);
+
+    std::pair<SockAddrIn, Errno> GetSockName() const;
+    std::pair<SockAddrIn, Errno> GetPeerName() const;
+
+    /// Receives into the buffer, resizing it to the received length. Fills in the address of the
+    /// sender if it isn't null.
+    std::pair<s32, Errno> Recv(u32 flags, std::vector<u8>& buffer, SockAddrIn* address);
+    /// Sends the buffer, to the given address if it isn't null.
+    std::pair<s32, Errno> Send(u32 flags, const std::vector<u8>& buffer,
+                               const SockAddrIn* address);
+
+    Errno SetSockOpt(u32 level, u32 option, const std::vector<u8>& value);
+    /// Reads an option into the buffer, resizing it to the size of the value.
+    Errno GetSockOpt(u32 level, u32 option, std::vector<u8>& value) const;
+
+    HostSocketHandle GetHandle() const {
+        return handle;
+    }
+
+private:
+    explicit HostSocket(HostSocketHandle handle);
+
+    HostSocketHandle handle;
+};
+
+} // namespace Service::Sockets
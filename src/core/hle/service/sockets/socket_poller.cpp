@@ -0,0 +1,144 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <tuple>
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/thread.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/service/sockets/socket_poller.h"
+
+namespace Service::Sockets {
+
+SocketPoller::SocketPoller(Kernel::KernelCore& kernel) : kernel{kernel} {
+    // A UDP socket bound to the loopback interface and connected to itself can wake the poll on
+    // every host, unlike pipes which Windows can't poll
+    wake_socket = HostSocket::Open(Domain::INET, Type::DGRAM, 0).first;
+    ASSERT_MSG(wake_socket != nullptr, "Failed to create the socket poller wake socket");
+
+    SockAddrIn loopback{};
+    loopback.len = sizeof(loopback);
+    loopback.family = static_cast<u8>(Domain::INET);
+    loopback.ip = {127, 0, 0, 1};
+    Errno error = wake_socket->Bind(loopback);
+    if (error == Errno::SUCCESS) {
+        SockAddrIn address;
+        std::tie(address, error) = wake_socket->GetSockName();
+        if (error == Errno::SUCCESS) {
+            error = wake_socket->Connect(address);
+        }
+    }
+    ASSERT_MSG(error == Errno::SUCCESS, "Failed to connect the socket poller wake socket");
+
+    thread = std::thread{&SocketPoller::Run, this};
+}
+
+SocketPoller::~SocketPoller() {
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        stop = true;
+    }
+    Wake();
+    thread.join();
+}
+
+void SocketPoller::Watch(std::vector<HostPollFD> fds, s64 timeout, Kernel::Handle event_handle) {
+    const bool has_deadline = timeout >= 0;
+    const auto deadline = std::chrono::steady_clock::now() +
+                          std::chrono::milliseconds{has_deadline ? timeout : 0};
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        watchers.push_back({std::move(fds), has_deadline, deadline, event_handle, false});
+    }
+    Wake();
+}
+
+void SocketPoller::Cancel(HostSocketHandle handle) {
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        for (auto& watcher : watchers) {
+            const bool has_socket =
+                std::any_of(watcher.fds.begin(), watcher.fds.end(),
+                            [handle](const HostPollFD& fd) { return fd.handle == handle; });
+            watcher.is_cancelled |= has_socket;
+        }
+    }
+    Wake();
+}
+
+void SocketPoller::Wake() {
+    static const std::vector<u8> message(1);
+    wake_socket->Send(0, message, nullptr);
+}
+
+void SocketPoller::Run() {
+    Common::SetCurrentThreadName("yuzu:SocketPoller");
+
+    std::vector<HostPollFD> poll_fds;
+    std::vector<u8> wake_buffer;
+    while (true) {
+        std::size_t num_polled;
+        s64 timeout = -1;
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            if (stop) {
+                return;
+            }
+
+            poll_fds.clear();
+            poll_fds.push_back({wake_socket->GetHandle(), PollIn, 0});
+            const auto now = std::chrono::steady_clock::now();
+            for (const auto& watcher : watchers) {
+                poll_fds.insert(poll_fds.end(), watcher.fds.begin(), watcher.fds.end());
+                if (!watcher.has_deadline) {
+                    continue;
+                }
+                const auto remaining = std::max<s64>(
+                    std::chrono::duration_cast<std::chrono::milliseconds>(watcher.deadline - now)
+                        .count(),
+                    0);
+                timeout = timeout < 0 ? remaining : std::min(timeout, remaining);
+            }
+            num_polled = watchers.size();
+        }
+
+        const auto [num_ready, error] = PollHostSockets(poll_fds, static_cast<s32>(timeout));
+        if (error != Errno::SUCCESS) {
+            LOG_ERROR(Service, "Failed to poll sockets, error={}", static_cast<u32>(error));
+        }
+
+        if (poll_fds[0].revents & PollIn) {
+            // Drain every pending wake up, they are all handled by this iteration
+            do {
+                wake_buffer.resize(1);
+            } while (wake_socket->Recv(0, wake_buffer, nullptr).second == Errno::SUCCESS);
+        }
+
+        // Signal and remove the watchers that are done, keeping the order of the others
+        std::lock_guard<std::mutex> lock{mutex};
+        const auto now = std::chrono::steady_clock::now();
+        std::size_t fd_index = 1;
+        std::size_t num_kept = 0;
+        for (std::size_t i = 0; i < watchers.size(); ++i) {
+            auto& watcher = watchers[i];
+            bool is_ready =
+                watcher.is_cancelled || (watcher.has_deadline && now >= watcher.deadline);
+            if (i < num_polled) {
+                for (std::size_t fd = 0; fd < watcher.fds.size(); ++fd, ++fd_index) {
+                    is_ready |= poll_fds[fd_index].revents != 0;
+                }
+            }
+
+            if (is_ready) {
+                kernel.SignalEventThreadsafe(watcher.event_handle);
+            } else {
+                watchers[num_kept++] = std::move(watcher);
+            }
+        }
+        watchers.resize(num_kept);
+    }
+}
+
+} // namespace Service::Sockets
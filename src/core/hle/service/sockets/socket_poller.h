@@ -0,0 +1,70 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "common/common_types.h"
+#include "core/hle/kernel/object.h"
+#include "core/hle/service/sockets/host_socket.h"
+
+namespace Kernel {
+class KernelCore;
+}
+
+namespace Service::Sockets {
+
+/**
+ * Host thread waiting for non-blocking host sockets to become ready. Guest threads doing blocking
+ * socket calls sleep on a kernel event that this thread signals, so they never block the emulated
+ * core on network I/O.
+ */
+class SocketPoller {
+public:
+    explicit SocketPoller(Kernel::KernelCore& kernel);
+    ~SocketPoller();
+
+    /**
+     * Signals an event once one of the sockets has one of the requested events, or once the
+     * timeout has expired.
+     * @param fds Sockets and events to wait for.
+     * @param timeout Timeout in milliseconds, a negative value waits forever.
+     * @param event_handle Event to signal, from KernelCore::CreateThreadsafeEventHandle.
+     */
+    void Watch(std::vector<HostPollFD> fds, s64 timeout, Kernel::Handle event_handle);
+
+    /// Wakes the threads waiting for the given socket, which is about to be closed.
+    void Cancel(HostSocketHandle handle);
+
+private:
+    struct Watcher {
+        std::vector<HostPollFD> fds;
+        bool has_deadline;
+        std::chrono::steady_clock::time_point deadline;
+        Kernel::Handle event_handle;
+        bool is_cancelled;
+    };
+
+    void Run();
+    void Wake();
+
+    Kernel::KernelCore& kernel;
+
+    /// Loopback socket connected to itself, written to in order to interrupt the poll
+    std::unique_ptr<HostSocket> wake_socket;
+
+    std::mutex mutex;
+    /// Only removed from by the poller thread, so that the watchers which were polled keep their
+    /// position while new ones are added.
+    std::vector<Watcher> watchers;
+    bool stop = false;
+
+    std::thread thread;
+};
+
+} // namespace Service::Sockets
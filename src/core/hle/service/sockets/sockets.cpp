@@ -7,21 +7,22 @@
 #include "core/hle/service/sockets/nsd.h"
 #include "core/hle/service/sockets/sfdnsres.h"
 #include "core/hle/service/sockets/sockets.h"
+#include "core/hle/service/sm/sm.h"
 
 namespace Service::Sockets {
 
 void InstallInterfaces(SM::ServiceManager& service_manager) {
-    std::make_shared<BSD>("bsd:s")->InstallAsService(service_manager);
-    std::make_shared<BSD>("bsd:u")->InstallAsService(service_manager);
-    std::make_shared<BSDCFG>()->InstallAsService(service_manager);
+    service_manager.InstallLazyService<BSD>("bsd:s", "bsd:s");
+    service_manager.InstallLazyService<BSD>("bsd:u", "bsd:u");
+    service_manager.InstallLazyService<BSDCFG>("bsdcfg");
 
-    std::make_shared<ETHC_C>()->InstallAsService(service_manager);
-    std::make_shared<ETHC_I>()->InstallAsService(service_manager);
+    service_manager.InstallLazyService<ETHC_C>("ethc:c");
+    service_manager.InstallLazyService<ETHC_I>("ethc:i");
 
-    std::make_shared<NSD>("nsd:a")->InstallAsService(service_manager);
-    std::make_shared<NSD>("nsd:u")->InstallAsService(service_manager);
+    service_manager.InstallLazyService<NSD>("nsd:a", "nsd:a");
+    service_manager.InstallLazyService<NSD>("nsd:u", "nsd:u");
 
-    std::make_shared<SFDNSRES>()->InstallAsService(service_manager);
+    service_manager.InstallLazyService<SFDNSRES>("sfdnsres");
 }
 
 } // namespace Service::Sockets
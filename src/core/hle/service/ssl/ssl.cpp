@@ -123,7 +123,7 @@ private:
 };
 
 void InstallInterfaces(SM::ServiceManager& service_manager) {
-    std::make_shared<SSL>()->InstallAsService(service_manager);
+    service_manager.InstallLazyService<SSL>("ssl");
 }
 
 } // namespace Service::SSL
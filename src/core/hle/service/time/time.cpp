@@ -4,6 +4,7 @@
 
 #include <chrono>
 #include <ctime>
+#include <random>
 #include "common/logging/log.h"
 #include "core/core_timing.h"
 #include "core/core_timing_util.h"
@@ -12,12 +13,27 @@
 #include "core/hle/kernel/client_session.h"
 #include "core/hle/service/time/interface.h"
 #include "core/hle/service/time/time.h"
+#include "core/hle/service/time/time_sharedmemory.h"
 
 namespace Service::Time {
 
+// The system clocks have a resolution of one second, so their contexts are refreshed as often
+constexpr u64 clock_update_ticks = CoreTiming::BASE_CLOCK_RATE;
+
+static u64 GetSteadyClockSeconds() {
+    return CoreTiming::cyclesToMs(CoreTiming::GetTicks()) / 1000;
+}
+
+static s64 GetPosixTime() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
 class ISystemClock final : public ServiceFramework<ISystemClock> {
 public:
-    ISystemClock() : ServiceFramework("ISystemClock") {
+    explicit ISystemClock(std::shared_ptr<Module> time)
+        : ServiceFramework("ISystemClock"), time(std::move(time)) {
         static const FunctionInfo functions[] = {
             {0, &ISystemClock::GetCurrentTime, "GetCurrentTime"},
             {1, nullptr, "SetCurrentTime"},
@@ -30,9 +46,7 @@ public:
 
 private:
     void GetCurrentTime(Kernel::HLERequestContext& ctx) {
-        const s64 time_since_epoch{std::chrono::duration_cast<std::chrono::seconds>(
-                                       std::chrono::system_clock::now().time_since_epoch())
-                                       .count()};
+        const s64 time_since_epoch{GetPosixTime()};
         LOG_DEBUG(Service_Time, "called");
         IPC::ResponseBuilder rb{ctx, 4};
         rb.Push(RESULT_SUCCESS);
@@ -40,17 +54,20 @@ private:
     }
 
     void GetSystemClockContext(Kernel::HLERequestContext& ctx) {
-        LOG_WARNING(Service_Time, "(STUBBED) called");
-        SystemClockContext system_clock_ontext{};
+        LOG_DEBUG(Service_Time, "called");
+        const SystemClockContext system_clock_context{time->GetSystemClockContext()};
         IPC::ResponseBuilder rb{ctx, (sizeof(SystemClockContext) / 4) + 2};
         rb.Push(RESULT_SUCCESS);
-        rb.PushRaw(system_clock_ontext);
+        rb.PushRaw(system_clock_context);
     }
+
+    std::shared_ptr<Module> time;
 };
 
 class ISteadyClock final : public ServiceFramework<ISteadyClock> {
 public:
-    ISteadyClock() : ServiceFramework("ISteadyClock") {
+    explicit ISteadyClock(std::shared_ptr<Module> time)
+        : ServiceFramework("ISteadyClock"), time(std::move(time)) {
         static const FunctionInfo functions[] = {
             {0, &ISteadyClock::GetCurrentTimePoint, "GetCurrentTimePoint"},
         };
@@ -60,12 +77,13 @@ public:
 private:
     void GetCurrentTimePoint(Kernel::HLERequestContext& ctx) {
         LOG_DEBUG(Service_Time, "called");
-        SteadyClockTimePoint steady_clock_time_point{
-            CoreTiming::cyclesToMs(CoreTiming::GetTicks()) / 1000};
+        const SteadyClockTimePoint steady_clock_time_point{time->GetCurrentTimePoint()};
         IPC::ResponseBuilder rb{ctx, (sizeof(SteadyClockTimePoint) / 4) + 2};
         rb.Push(RESULT_SUCCESS);
         rb.PushRaw(steady_clock_time_point);
     }
+
+    std::shared_ptr<Module> time;
 };
 
 class ITimeZoneService final : public ServiceFramework<ITimeZoneService> {
@@ -175,21 +193,21 @@ private:
 void Module::Interface::GetStandardUserSystemClock(Kernel::HLERequestContext& ctx) {
     IPC::ResponseBuilder rb{ctx, 2, 0, 1};
     rb.Push(RESULT_SUCCESS);
-    rb.PushIpcInterface<ISystemClock>();
+    rb.PushIpcInterface<ISystemClock>(time);
     LOG_DEBUG(Service_Time, "called");
 }
 
 void Module::Interface::GetStandardNetworkSystemClock(Kernel::HLERequestContext& ctx) {
     IPC::ResponseBuilder rb{ctx, 2, 0, 1};
     rb.Push(RESULT_SUCCESS);
-    rb.PushIpcInterface<ISystemClock>();
+    rb.PushIpcInterface<ISystemClock>(time);
     LOG_DEBUG(Service_Time, "called");
 }
 
 void Module::Interface::GetStandardSteadyClock(Kernel::HLERequestContext& ctx) {
     IPC::ResponseBuilder rb{ctx, 2, 0, 1};
     rb.Push(RESULT_SUCCESS);
-    rb.PushIpcInterface<ISteadyClock>();
+    rb.PushIpcInterface<ISteadyClock>(time);
     LOG_DEBUG(Service_Time, "called");
 }
 
@@ -203,10 +221,53 @@ void Module::Interface::GetTimeZoneService(Kernel::HLERequestContext& ctx) {
 void Module::Interface::GetStandardLocalSystemClock(Kernel::HLERequestContext& ctx) {
     IPC::ResponseBuilder rb{ctx, 2, 0, 1};
     rb.Push(RESULT_SUCCESS);
-    rb.PushIpcInterface<ISystemClock>();
+    rb.PushIpcInterface<ISystemClock>(time);
+    LOG_DEBUG(Service_Time, "called");
+}
+
+void Module::Interface::GetSharedMemoryNativeHandle(Kernel::HLERequestContext& ctx) {
+    IPC::ResponseBuilder rb{ctx, 2, 1};
+    rb.Push(RESULT_SUCCESS);
+    rb.PushCopyObjects(time->shared_memory->GetSharedMemoryHolder());
     LOG_DEBUG(Service_Time, "called");
 }
 
+Module::Module() : shared_memory{std::make_unique<SharedMemory>()} {
+    std::random_device device;
+    std::mt19937_64 gen(device());
+    clock_source_id = {gen(), gen()};
+
+    // The guest adds the system counter to the offset, which already starts with the emulation
+    shared_memory->SetupStandardSteadyClock(clock_source_id, 0);
+    shared_memory->SetStandardUserSystemClockAutomaticCorrectionEnabled(false);
+
+    clock_update_event = CoreTiming::RegisterEvent(
+        "Time::UpdateSystemClockContexts",
+        [this](u64 userdata, int cycles_late) { UpdateSystemClockContexts(cycles_late); });
+    UpdateSystemClockContexts(0);
+}
+
+Module::~Module() {
+    CoreTiming::UnscheduleEvent(clock_update_event, 0);
+}
+
+SteadyClockTimePoint Module::GetCurrentTimePoint() const {
+    return {GetSteadyClockSeconds(), clock_source_id};
+}
+
+SystemClockContext Module::GetSystemClockContext() const {
+    const SteadyClockTimePoint time_point{GetCurrentTimePoint()};
+    return {static_cast<u64>(GetPosixTime() - static_cast<s64>(time_point.value)), time_point};
+}
+
+void Module::UpdateSystemClockContexts(int cycles_late) {
+    const SystemClockContext context{GetSystemClockContext()};
+    shared_memory->UpdateLocalSystemClockContext(context);
+    shared_memory->UpdateNetworkSystemClockContext(context);
+
+    CoreTiming::ScheduleEvent(clock_update_ticks - cycles_late, clock_update_event);
+}
+
 Module::Interface::Interface(std::shared_ptr<Module> time, const char* name)
     : ServiceFramework(name), time(std::move(time)) {}
 
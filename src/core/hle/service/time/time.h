@@ -5,8 +5,13 @@
 #pragma once
 
 #include <array>
+#include <memory>
 #include "core/hle/service/service.h"
 
+namespace CoreTiming {
+struct EventType;
+}
+
 namespace Service::Time {
 
 struct LocationName {
@@ -42,10 +47,16 @@ struct TimeZoneRule {
 
 struct SteadyClockTimePoint {
     u64_le value;
-    INSERT_PADDING_WORDS(4);
+    u128 clock_source_id;
 };
 static_assert(sizeof(SteadyClockTimePoint) == 0x18, "SteadyClockTimePoint is incorrect size");
 
+struct SteadyClockContext {
+    u64_le internal_offset;
+    u128 clock_source_id;
+};
+static_assert(sizeof(SteadyClockContext) == 0x18, "SteadyClockContext is incorrect size");
+
 struct SystemClockContext {
     u64_le offset;
     SteadyClockTimePoint time_point;
@@ -53,8 +64,13 @@ struct SystemClockContext {
 static_assert(sizeof(SystemClockContext) == 0x20,
               "SystemClockContext structure has incorrect size");
 
+class SharedMemory;
+
 class Module final {
 public:
+    Module();
+    ~Module();
+
     class Interface : public ServiceFramework<Interface> {
     public:
         explicit Interface(std::shared_ptr<Module> time, const char* name);
@@ -65,10 +81,25 @@ public:
         void GetStandardSteadyClock(Kernel::HLERequestContext& ctx);
         void GetTimeZoneService(Kernel::HLERequestContext& ctx);
         void GetStandardLocalSystemClock(Kernel::HLERequestContext& ctx);
+        void GetSharedMemoryNativeHandle(Kernel::HLERequestContext& ctx);
 
     protected:
         std::shared_ptr<Module> time;
     };
+
+    /// Returns the current time point of the standard steady clock
+    SteadyClockTimePoint GetCurrentTimePoint() const;
+
+    /// Returns the context the system clocks derive the current time from
+    SystemClockContext GetSystemClockContext() const;
+
+private:
+    /// Refreshes the contexts of the system clocks in the shared memory
+    void UpdateSystemClockContexts(int cycles_late);
+
+    u128 clock_source_id{};
+    std::unique_ptr<SharedMemory> shared_memory;
+    CoreTiming::EventType* clock_update_event{};
 };
 
 /// Registers all Time services with the specified service manager.
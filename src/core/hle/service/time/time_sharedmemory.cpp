@@ -0,0 +1,56 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include "core/core.h"
+#include "core/hle/service/time/time_sharedmemory.h"
+
+namespace Service::Time {
+
+constexpr std::size_t SHARED_MEMORY_SIZE = 0x1000;
+
+template <typename T>
+static void StoreToLockObject(SharedMemory::LockObject<T>& object, const T& data) {
+    const u32 next_counter = object.counter + 1;
+    object.data[next_counter & 1] = data;
+    // The new copy has to be visible before the counter that selects it
+    std::atomic_thread_fence(std::memory_order_release);
+    object.counter = next_counter;
+}
+
+SharedMemory::SharedMemory() {
+    auto& kernel = Core::System::GetInstance().Kernel();
+    shared_memory_holder = Kernel::SharedMemory::Create(
+        kernel, nullptr, SHARED_MEMORY_SIZE, Kernel::MemoryPermission::ReadWrite,
+        Kernel::MemoryPermission::Read, 0, Kernel::MemoryRegion::BASE, "Time:SharedMemory");
+}
+
+SharedMemory::~SharedMemory() = default;
+
+Kernel::SharedPtr<Kernel::SharedMemory> SharedMemory::GetSharedMemoryHolder() const {
+    return shared_memory_holder;
+}
+
+void SharedMemory::SetupStandardSteadyClock(const u128& clock_source_id, u64 internal_offset) {
+    StoreToLockObject(GetFormat().standard_steady_clock_context,
+                      SteadyClockContext{internal_offset, clock_source_id});
+}
+
+void SharedMemory::UpdateLocalSystemClockContext(const SystemClockContext& context) {
+    StoreToLockObject(GetFormat().standard_local_system_clock_context, context);
+}
+
+void SharedMemory::UpdateNetworkSystemClockContext(const SystemClockContext& context) {
+    StoreToLockObject(GetFormat().standard_network_system_clock_context, context);
+}
+
+void SharedMemory::SetStandardUserSystemClockAutomaticCorrectionEnabled(bool enabled) {
+    StoreToLockObject(GetFormat().standard_user_system_clock_automatic_correction, enabled);
+}
+
+SharedMemory::Format& SharedMemory::GetFormat() {
+    return *reinterpret_cast<Format*>(shared_memory_holder->GetPointer());
+}
+
+} // namespace Service::Time
@@ -0,0 +1,71 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include "common/common_funcs.h"
+#include "common/common_types.h"
+#include "common/swap.h"
+#include "core/hle/kernel/shared_memory.h"
+#include "core/hle/service/time/time.h"
+
+namespace Service::Time {
+
+/**
+ * Memory shared with the guest holding the contexts of the standard clocks, as the Switch
+ * exposes them. Reading a clock through it costs the guest a few memory reads instead of an IPC
+ * round trip per query.
+ */
+class SharedMemory final {
+public:
+    SharedMemory();
+    ~SharedMemory();
+
+    /// Returns the kernel object of the shared memory, to be mapped by the guest
+    Kernel::SharedPtr<Kernel::SharedMemory> GetSharedMemoryHolder() const;
+
+    void SetupStandardSteadyClock(const u128& clock_source_id, u64 internal_offset);
+    void UpdateLocalSystemClockContext(const SystemClockContext& context);
+    void UpdateNetworkSystemClockContext(const SystemClockContext& context);
+    void SetStandardUserSystemClockAutomaticCorrectionEnabled(bool enabled);
+
+    /**
+     * Every value is stored twice. The writer fills the copy the counter doesn't select before
+     * incrementing it, so readers only retry when the counter changed while they were reading.
+     */
+    template <typename T>
+    struct LockObject {
+        u32_le counter;
+        INSERT_PADDING_WORDS(1);
+        std::array<T, 2> data;
+    };
+
+    struct Format {
+        LockObject<SteadyClockContext> standard_steady_clock_context;
+        LockObject<SystemClockContext> standard_local_system_clock_context;
+        LockObject<SystemClockContext> standard_network_system_clock_context;
+        LockObject<bool> standard_user_system_clock_automatic_correction;
+        u32_le format_version;
+    };
+    static_assert(offsetof(Format, standard_steady_clock_context) == 0x0,
+                  "standard_steady_clock_context is at an invalid offset");
+    static_assert(offsetof(Format, standard_local_system_clock_context) == 0x38,
+                  "standard_local_system_clock_context is at an invalid offset");
+    static_assert(offsetof(Format, standard_network_system_clock_context) == 0x80,
+                  "standard_network_system_clock_context is at an invalid offset");
+    static_assert(offsetof(Format, standard_user_system_clock_automatic_correction) == 0xC8,
+                  "standard_user_system_clock_automatic_correction is at an invalid offset");
+    static_assert(offsetof(Format, format_version) == 0xD4,
+                  "format_version is at an invalid offset");
+    static_assert(sizeof(Format) == 0xD8, "Format is an invalid size");
+
+private:
+    Format& GetFormat();
+
+    Kernel::SharedPtr<Kernel::SharedMemory> shared_memory_holder;
+};
+
+} // namespace Service::Time
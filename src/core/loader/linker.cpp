@@ -2,11 +2,16 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <cstring>
+#include <optional>
+#include <string>
 #include <vector>
 
 #include "common/common_funcs.h"
 #include "common/logging/log.h"
 #include "common/swap.h"
+#include "core/guest_profiler.h"
+#include "core/hle/function_replacement.h"
 #include "core/loader/linker.h"
 #include "core/memory.h"
 
@@ -39,9 +44,13 @@ struct Elf64_Dyn {
 };
 static_assert(sizeof(Elf64_Dyn) == 0x10, "Elf64_Dyn has incorrect size.");
 
+/// Symbol type of functions, in the low bits of Elf64_Sym::info
+constexpr u8 STT_FUNC = 2;
+
 struct Elf64_Sym {
     u32_le name;
-    INSERT_PADDING_BYTES(0x2);
+    u8 info;
+    u8 other;
     u16_le shndx;
     u64_le value;
     u64_le size;
@@ -132,6 +141,83 @@ void Linker::Relocate(std::vector<u8>& program_image, u32 dynamic_section_offset
     }
 }
 
+namespace {
+/// Function defined by a module, at an offset into its image
+struct FunctionSymbol {
+    std::string name;
+    u64 offset;
+    u64 size;
+};
+
+std::vector<FunctionSymbol> ReadFunctionSymbols(const std::vector<u8>& program_image,
+                                                u32 dynamic_section_offset) {
+    // The image comes from the guest, so every offset read from it is checked
+    std::map<u64, u64> dynamic;
+    for (u64 offset = dynamic_section_offset; offset + sizeof(Elf64_Dyn) <= program_image.size();
+         offset += sizeof(Elf64_Dyn)) {
+        Elf64_Dyn dyn;
+        std::memcpy(&dyn, &program_image[offset], sizeof(Elf64_Dyn));
+        if (dyn.tag == DT_NULL) {
+            break;
+        }
+        dynamic[dyn.tag] = dyn.value;
+    }
+    if (dynamic.count(DT_SYMTAB) == 0 || dynamic.count(DT_STRTAB) == 0) {
+        return {};
+    }
+
+    const u64 symtab = dynamic[DT_SYMTAB];
+    const u64 strtab = dynamic[DT_STRTAB];
+    const u64 strsz = dynamic[DT_STRSZ];
+    if (strtab >= program_image.size() || strsz > program_image.size() - strtab) {
+        return {};
+    }
+
+    // The symbol table has no size of its own, but the string table follows it
+    std::vector<FunctionSymbol> functions;
+    const u64 symtab_end = strtab > symtab ? strtab : program_image.size();
+    for (u64 offset = symtab; offset + sizeof(Elf64_Sym) <= symtab_end;
+         offset += sizeof(Elf64_Sym)) {
+        Elf64_Sym sym;
+        std::memcpy(&sym, &program_image[offset], sizeof(Elf64_Sym));
+        if (sym.name >= strsz) {
+            break;
+        }
+        // Imported functions are undefined, they belong to the module that exports them
+        if ((sym.info & 0xF) != STT_FUNC || sym.shndx == 0 || sym.value == 0) {
+            continue;
+        }
+
+        const char* name = reinterpret_cast<const char*>(&program_image[strtab + sym.name]);
+        functions.push_back(
+            {std::string(name, strnlen(name, strsz - sym.name)), sym.value, sym.size});
+    }
+    return functions;
+}
+} // Anonymous namespace
+
+void Linker::RegisterSymbols(const std::vector<u8>& program_image, u32 dynamic_section_offset,
+                             VAddr load_base) {
+    for (auto& function : ReadFunctionSymbols(program_image, dynamic_section_offset)) {
+        Core::GuestProfiler::RegisterSymbol(std::move(function.name), load_base + function.offset,
+                                            function.size);
+    }
+}
+
+void Linker::ReplaceFunctions(std::vector<u8>& program_image, u32 dynamic_section_offset) {
+    using HLE::FunctionReplacement::ReplacementCode;
+    for (const auto& function : ReadFunctionSymbols(program_image, dynamic_section_offset)) {
+        const std::optional<ReplacementCode> code =
+            HLE::FunctionReplacement::GetReplacementCode(function.name);
+        if (!code || function.size < sizeof(ReplacementCode) ||
+            function.offset + sizeof(ReplacementCode) > program_image.size()) {
+            continue;
+        }
+        std::memcpy(&program_image[function.offset], code->data(), sizeof(ReplacementCode));
+        LOG_DEBUG(Loader, "Replaced {} at offset 0x{:X}", function.name, function.offset);
+    }
+}
+
 void Linker::ResolveImports() {
     // Resolve imports
     for (const auto& import : imports) {
@@ -6,6 +6,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 #include "common/common_types.h"
 
 namespace Loader {
@@ -29,6 +30,23 @@ protected:
 
     void ResolveImports();
 
+    /**
+     * Registers the functions of the dynamic symbol table of a module with the guest profiler
+     * @param program_image Image of the module, as it's loaded in memory
+     * @param dynamic_section_offset Offset of the dynamic section in the image
+     * @param load_base Address the module is loaded at
+     */
+    static void RegisterSymbols(const std::vector<u8>& program_image, u32 dynamic_section_offset,
+                                VAddr load_base);
+
+    /**
+     * Replaces the functions of a module that have host implementations, by their symbol in its
+     * dynamic symbol table. Must be called before the image is loaded.
+     * @param program_image Image of the module, as it's loaded in memory
+     * @param dynamic_section_offset Offset of the dynamic section in the image
+     */
+    static void ReplaceFunctions(std::vector<u8>& program_image, u32 dynamic_section_offset);
+
     std::map<std::string, Import> imports;
     std::map<std::string, VAddr> exports;
 };
@@ -14,11 +14,13 @@
 #include "core/file_sys/control_metadata.h"
 #include "core/file_sys/vfs_offset.h"
 #include "core/gdbstub/gdbstub.h"
+#include "core/guest_profiler.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/resource_limit.h"
 #include "core/loader/nro.h"
 #include "core/memory.h"
+#include "core/settings.h"
 
 namespace Loader {
 
@@ -164,14 +166,28 @@ bool AppLoader_NRO::LoadNro(FileSys::VirtualFile file, VAddr load_base) {
     codeset->DataSegment().size += bss_size;
     program_image.resize(static_cast<u32>(program_image.size()) + bss_size);
 
+    if (has_mod_header && Settings::values.use_hle_libc) {
+        ReplaceFunctions(program_image,
+                         nro_header.module_header_offset + mod_header.dynamic_offset);
+    }
+
     // Load codeset for current process
     codeset->name = file->GetName();
-    codeset->memory = std::make_shared<std::vector<u8>>(std::move(program_image));
+    codeset->memory =
+        std::make_shared<Common::DemandZeroBuffer>(program_image.begin(), program_image.end());
     Core::CurrentProcess()->LoadModule(codeset, load_base);
 
     // Register module with GDBStub
     GDBStub::RegisterModule(codeset->name, load_base, load_base);
 
+    // Register module and its functions with the guest profiler
+    Core::GuestProfiler::RegisterModule(codeset->name, load_base,
+                                        load_base + program_image.size());
+    if (has_mod_header) {
+        RegisterSymbols(program_image,
+                        nro_header.module_header_offset + mod_header.dynamic_offset, load_base);
+    }
+
     return true;
 }
 
@@ -2,7 +2,10 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
 #include <cinttypes>
+#include <future>
 #include <vector>
 #include <lz4.h>
 #include "common/common_funcs.h"
@@ -11,11 +14,13 @@
 #include "common/swap.h"
 #include "core/core.h"
 #include "core/gdbstub/gdbstub.h"
+#include "core/guest_profiler.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/resource_limit.h"
 #include "core/loader/nso.h"
 #include "core/memory.h"
+#include "core/settings.h"
 
 namespace Loader {
 
@@ -67,19 +72,14 @@ FileType AppLoader_NSO::IdentifyType(const FileSys::VirtualFile& file) {
     return FileType::NSO;
 }
 
-static std::vector<u8> DecompressSegment(const std::vector<u8>& compressed_data,
-                                         const NsoSegmentHeader& header) {
-    std::vector<u8> uncompressed_data(header.size);
-    const int bytes_uncompressed =
-        LZ4_decompress_safe(reinterpret_cast<const char*>(compressed_data.data()),
-                            reinterpret_cast<char*>(uncompressed_data.data()),
-                            static_cast<int>(compressed_data.size()), header.size);
+static void DecompressSegment(const u8* compressed_data, std::size_t compressed_size,
+                              const NsoSegmentHeader& header, u8* dest) {
+    const int bytes_uncompressed = LZ4_decompress_safe(
+        reinterpret_cast<const char*>(compressed_data), reinterpret_cast<char*>(dest),
+        static_cast<int>(compressed_size), header.size);
 
-    ASSERT_MSG(bytes_uncompressed == static_cast<int>(header.size) &&
-                   bytes_uncompressed == static_cast<int>(uncompressed_data.size()),
-               "{} != {} != {}", bytes_uncompressed, header.size, uncompressed_data.size());
-
-    return uncompressed_data;
+    ASSERT_MSG(bytes_uncompressed == static_cast<int>(header.size), "{} != {}", bytes_uncompressed,
+               header.size);
 }
 
 static constexpr u32 PageAlignSize(u32 size) {
@@ -100,21 +100,49 @@ VAddr AppLoader_NSO::LoadModule(FileSys::VirtualFile file, VAddr load_base) {
     if (nso_header.magic != Common::MakeMagic('N', 'S', 'O', '0'))
         return {};
 
-    // Build program image
+    // Build program image. The segments are decompressed in place into the final image, which is
+    // sized for the .bss from the NSO header and only grows if the MOD0 header asks for more.
     auto& kernel = Core::System::GetInstance().Kernel();
     Kernel::SharedPtr<Kernel::CodeSet> codeset = Kernel::CodeSet::Create(kernel, "");
-    std::vector<u8> program_image;
+    u32 segments_end = 0;
+    for (const auto& segment : nso_header.segments) {
+        segments_end = std::max(segments_end, segment.location + segment.size);
+    }
+    std::vector<u8> program_image(
+        PageAlignSize(segments_end + PageAlignSize(nso_header.segments[2].bss_size)));
+
+    // Reading the file isn't thread-safe, so the compressed segments are read up front, straight
+    // from memory when the file is mapped.
+    std::array<std::vector<u8>, 3> compressed_buffers;
+    std::array<const u8*, 3> compressed_data{};
     for (std::size_t i = 0; i < nso_header.segments.size(); ++i) {
-        const std::vector<u8> compressed_data =
-            file->ReadBytes(nso_header.segments_compressed_size[i], nso_header.segments[i].offset);
-        std::vector<u8> data = DecompressSegment(compressed_data, nso_header.segments[i]);
-        program_image.resize(nso_header.segments[i].location);
-        program_image.insert(program_image.end(), data.begin(), data.end());
-        codeset->segments[i].addr = nso_header.segments[i].location;
-        codeset->segments[i].offset = nso_header.segments[i].location;
-        codeset->segments[i].size = PageAlignSize(static_cast<u32>(data.size()));
+        const auto& segment = nso_header.segments[i];
+        const u32 compressed_size = nso_header.segments_compressed_size[i];
+        compressed_data[i] = file->GetPointer(compressed_size, segment.offset);
+        if (compressed_data[i] == nullptr) {
+            compressed_buffers[i] = file->ReadBytes(compressed_size, segment.offset);
+            if (compressed_buffers[i].size() != compressed_size)
+                return {};
+            compressed_data[i] = compressed_buffers[i].data();
+        }
+
+        codeset->segments[i].addr = segment.location;
+        codeset->segments[i].offset = segment.location;
+        codeset->segments[i].size = PageAlignSize(segment.size);
     }
 
+    // Each segment decompresses into its own range of the image, so they can be done in parallel
+    const auto decompress = [&](std::size_t i) {
+        DecompressSegment(compressed_data[i], nso_header.segments_compressed_size[i],
+                          nso_header.segments[i],
+                          program_image.data() + nso_header.segments[i].location);
+    };
+    auto rodata = std::async(std::launch::async, decompress, 1);
+    auto data = std::async(std::launch::async, decompress, 2);
+    decompress(0);
+    rodata.get();
+    data.get();
+
     // MOD header pointer is at .text offset + 4
     u32 module_offset;
     std::memcpy(&module_offset, program_image.data() + 4, sizeof(u32));
@@ -130,17 +158,28 @@ VAddr AppLoader_NSO::LoadModule(FileSys::VirtualFile file, VAddr load_base) {
         bss_size = PageAlignSize(mod_header.bss_end_offset - mod_header.bss_start_offset);
     }
     codeset->DataSegment().size += bss_size;
-    const u32 image_size{PageAlignSize(static_cast<u32>(program_image.size()) + bss_size)};
+    const u32 image_size{PageAlignSize(segments_end + bss_size)};
     program_image.resize(image_size);
 
+    if (has_mod_header && Settings::values.use_hle_libc) {
+        ReplaceFunctions(program_image, module_offset + mod_header.dynamic_offset);
+    }
+
     // Load codeset for current process
     codeset->name = file->GetName();
-    codeset->memory = std::make_shared<std::vector<u8>>(std::move(program_image));
+    codeset->memory =
+        std::make_shared<Common::DemandZeroBuffer>(program_image.begin(), program_image.end());
     Core::CurrentProcess()->LoadModule(codeset, load_base);
 
     // Register module with GDBStub
     GDBStub::RegisterModule(codeset->name, load_base, load_base);
 
+    // Register module and its functions with the guest profiler
+    Core::GuestProfiler::RegisterModule(codeset->name, load_base, load_base + image_size);
+    if (has_mod_header) {
+        RegisterSymbols(program_image, module_offset + mod_header.dynamic_offset, load_base);
+    }
+
     return load_base + image_size;
 }
 
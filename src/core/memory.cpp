@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cstring>
 #include <utility>
 
@@ -14,10 +15,12 @@
 #include "common/swap.h"
 #include "core/arm/arm_interface.h"
 #include "core/core.h"
+#include "core/gdbstub/gdbstub.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/lock.h"
 #include "core/memory.h"
 #include "core/memory_setup.h"
+#include "core/memory_stats.h"
 #include "video_core/renderer_base.h"
 #include "video_core/video_core.h"
 
@@ -25,6 +28,26 @@ namespace Memory {
 
 static PageTable* current_page_table = nullptr;
 
+/// Translation of a rasterizer cached page, which has no pointer in its page table
+struct CachedPagePointer {
+    const PageTable* page_table = nullptr;
+    VAddr page = 0;
+    u8* pointer = nullptr;
+    u64 generation = 0;
+};
+
+constexpr std::size_t PAGE_POINTER_CACHE_SIZE = 64;
+
+/**
+ * Pointers of the rasterizer cached pages each thread accessed last, which would otherwise need a
+ * lookup of their VMA for every access while they're cached. The pages are looked up by the
+ * threads of the HLE services and the GPU alike, so each one keeps its own entries.
+ */
+static thread_local std::array<CachedPagePointer, PAGE_POINTER_CACHE_SIZE> page_pointer_cache;
+
+/// Incremented whenever a mapping changes, which invalidates every cached page pointer
+static std::atomic<u64> mapping_generation{1};
+
 void SetCurrentPageTable(PageTable* page_table) {
     current_page_table = page_table;
 
@@ -41,23 +64,59 @@ PageTable* GetCurrentPageTable() {
     return current_page_table;
 }
 
+/// Returns the pointer that backs the page at the given index of a region mapped at `memory`
+static u8* GetPagePointer(u8* memory, u64 page_index) {
+    return memory == nullptr ? nullptr : memory + page_index * PAGE_SIZE;
+}
+
+/// Returns whether a page has a debugger watchpoint, and thus no pointer in the page table
+static bool IsPageWatched(const PageTable& page_table, u64 page) {
+    return !page_table.watched_pages.empty() && page_table.watched_pages.count(page) != 0;
+}
+
+/// Returns whether a page of the table already has the given type and backing
+static bool IsPageMapped(const PageTable& page_table, VAddr page, u8* pointer, PageType type) {
+    return page_table.attributes[page] == type && page_table.pointers[page] == pointer;
+}
+
 static void MapPages(PageTable& page_table, VAddr base, u64 size, u8* memory, PageType type) {
     LOG_DEBUG(HW_Memory, "Mapping {} onto {:016X}-{:016X}", fmt::ptr(memory), base * PAGE_SIZE,
               (base + size) * PAGE_SIZE);
+    ASSERT_MSG(base + size <= PAGE_TABLE_NUM_ENTRIES, "out of range mapping at {:016X}",
+               base * PAGE_SIZE);
+
+    // Remapping a region usually leaves most of its pages as they were, e.g. when refreshing the
+    // mappings of a block that didn't move. Trim those from both ends so that neither the table
+    // nor the rasterizer caches are touched for them.
+    u64 first = 0;
+    while (first < size &&
+           IsPageMapped(page_table, base + first, GetPagePointer(memory, first), type)) {
+        ++first;
+    }
+    if (first == size) {
+        return;
+    }
+    u64 last = size - 1;
+    while (last > first &&
+           IsPageMapped(page_table, base + last, GetPagePointer(memory, last), type)) {
+        --last;
+    }
 
-    RasterizerFlushVirtualRegion(base << PAGE_BITS, size * PAGE_SIZE,
+    const VAddr changed_base = base + first;
+    const u64 changed_size = last - first + 1;
+    mapping_generation.fetch_add(1, std::memory_order_relaxed);
+    RasterizerFlushVirtualRegion(changed_base << PAGE_BITS, changed_size * PAGE_SIZE,
                                  FlushMode::FlushAndInvalidate);
 
-    VAddr end = base + size;
-    while (base != end) {
-        ASSERT_MSG(base < PAGE_TABLE_NUM_ENTRIES, "out of range mapping at {:016X}", base);
-
-        page_table.attributes[base] = type;
-        page_table.pointers[base] = memory;
-
-        base += 1;
-        if (memory != nullptr)
-            memory += PAGE_SIZE;
+    std::fill_n(page_table.attributes.begin() + changed_base, changed_size, type);
+    if (memory == nullptr) {
+        std::fill_n(page_table.pointers.begin() + changed_base, changed_size, nullptr);
+        return;
+    }
+    u8* pointer = GetPagePointer(memory, first);
+    for (u64 page = changed_base; page != changed_base + changed_size; ++page) {
+        page_table.pointers[page] = IsPageWatched(page_table, page) ? nullptr : pointer;
+        pointer += PAGE_SIZE;
     }
 }
 
@@ -98,11 +157,8 @@ void RemoveDebugHook(PageTable& page_table, VAddr base, u64 size, MemoryHookPoin
     page_table.special_regions.subtract(std::make_pair(interval, std::set<SpecialRegion>{region}));
 }
 
-/**
- * Gets a pointer to the exact memory at the virtual address (i.e. not page aligned)
- * using a VMA from the current process
- */
-static u8* GetPointerFromVMA(const Kernel::Process& process, VAddr vaddr) {
+/// Gets a pointer to the memory backing the virtual address by looking up its VMA
+static u8* FindPointerInVMA(const Kernel::Process& process, VAddr vaddr) {
     u8* direct_pointer = nullptr;
 
     auto& vm_manager = process.vm_manager;
@@ -127,6 +183,28 @@ static u8* GetPointerFromVMA(const Kernel::Process& process, VAddr vaddr) {
     return direct_pointer + (vaddr - vma.base);
 }
 
+/**
+ * Gets a pointer to the exact memory at the virtual address (i.e. not page aligned)
+ * using a VMA from the current process
+ */
+static u8* GetPointerFromVMA(const Kernel::Process& process, VAddr vaddr) {
+    const PageTable* const page_table = &process.vm_manager.page_table;
+    const VAddr page = vaddr >> PAGE_BITS;
+    const u64 generation = mapping_generation.load(std::memory_order_relaxed);
+
+    CachedPagePointer& entry = page_pointer_cache[page % PAGE_POINTER_CACHE_SIZE];
+    if (entry.generation != generation || entry.page != page || entry.page_table != page_table) {
+        // VMAs are page aligned, so the whole page is backed by contiguous memory
+        AccessStats::RecordVMALookup(vaddr);
+        u8* const pointer = FindPointerInVMA(process, vaddr & ~PAGE_MASK);
+        if (pointer == nullptr) {
+            return nullptr;
+        }
+        entry = {page_table, page, pointer, generation};
+    }
+    return entry.pointer + (vaddr & PAGE_MASK);
+}
+
 /**
  * Gets a pointer to the exact memory at the virtual address (i.e. not page aligned)
  * using a VMA from the current process.
@@ -135,6 +213,13 @@ static u8* GetPointerFromVMA(VAddr vaddr) {
     return GetPointerFromVMA(*Core::CurrentProcess(), vaddr);
 }
 
+/// Reports an access to a page without a pointer to the debugger, if it hits a watchpoint
+static void ReportWatchedAccess(VAddr vaddr, std::size_t size, GDBStub::BreakpointType type) {
+    if (IsPageWatched(*current_page_table, vaddr >> PAGE_BITS)) {
+        GDBStub::CheckWatchpoint(vaddr, size, type);
+    }
+}
+
 template <typename T>
 T Read(const VAddr vaddr) {
     const u8* page_pointer = current_page_table->pointers[vaddr >> PAGE_BITS];
@@ -149,15 +234,23 @@ T Read(const VAddr vaddr) {
     std::lock_guard<std::recursive_mutex> lock(HLE::g_hle_lock);
 
     PageType type = current_page_table->attributes[vaddr >> PAGE_BITS];
+    AccessStats::RecordSlowAccess(vaddr, type, false);
     switch (type) {
     case PageType::Unmapped:
         LOG_ERROR(HW_Memory, "Unmapped Read{} @ 0x{:08X}", sizeof(T) * 8, vaddr);
         return 0;
-    case PageType::Memory:
-        ASSERT_MSG(false, "Mapped memory page without a pointer @ {:016X}", vaddr);
-        break;
+    case PageType::Memory: {
+        ASSERT_MSG(IsPageWatched(*current_page_table, vaddr >> PAGE_BITS),
+                   "Mapped memory page without a pointer @ {:016X}", vaddr);
+        ReportWatchedAccess(vaddr, sizeof(T), GDBStub::BreakpointType::Read);
+
+        T value;
+        std::memcpy(&value, GetPointerFromVMA(vaddr), sizeof(T));
+        return value;
+    }
     case PageType::RasterizerCachedMemory: {
         RasterizerFlushVirtualRegion(vaddr, sizeof(T), FlushMode::Flush);
+        ReportWatchedAccess(vaddr, sizeof(T), GDBStub::BreakpointType::Read);
 
         T value;
         std::memcpy(&value, GetPointerFromVMA(vaddr), sizeof(T));
@@ -181,16 +274,21 @@ void Write(const VAddr vaddr, const T data) {
     std::lock_guard<std::recursive_mutex> lock(HLE::g_hle_lock);
 
     PageType type = current_page_table->attributes[vaddr >> PAGE_BITS];
+    AccessStats::RecordSlowAccess(vaddr, type, true);
     switch (type) {
     case PageType::Unmapped:
         LOG_ERROR(HW_Memory, "Unmapped Write{} 0x{:08X} @ 0x{:016X}", sizeof(data) * 8,
                   static_cast<u32>(data), vaddr);
         return;
     case PageType::Memory:
-        ASSERT_MSG(false, "Mapped memory page without a pointer @ {:016X}", vaddr);
+        ASSERT_MSG(IsPageWatched(*current_page_table, vaddr >> PAGE_BITS),
+                   "Mapped memory page without a pointer @ {:016X}", vaddr);
+        ReportWatchedAccess(vaddr, sizeof(T), GDBStub::BreakpointType::Write);
+        std::memcpy(GetPointerFromVMA(vaddr), &data, sizeof(T));
         break;
     case PageType::RasterizerCachedMemory: {
         RasterizerFlushVirtualRegion(vaddr, sizeof(T), FlushMode::Invalidate);
+        ReportWatchedAccess(vaddr, sizeof(T), GDBStub::BreakpointType::Write);
         std::memcpy(GetPointerFromVMA(vaddr), &data, sizeof(T));
         break;
     }
@@ -209,6 +307,9 @@ bool IsValidVirtualAddress(const Kernel::Process& process, const VAddr vaddr) {
     if (page_table.attributes[vaddr >> PAGE_BITS] == PageType::RasterizerCachedMemory)
         return true;
 
+    if (page_table.attributes[vaddr >> PAGE_BITS] == PageType::Memory)
+        return IsPageWatched(page_table, vaddr >> PAGE_BITS);
+
     if (page_table.attributes[vaddr >> PAGE_BITS] != PageType::Special)
         return false;
 
@@ -229,7 +330,9 @@ u8* GetPointer(const VAddr vaddr) {
         return page_pointer + (vaddr & PAGE_MASK);
     }
 
-    if (current_page_table->attributes[vaddr >> PAGE_BITS] == PageType::RasterizerCachedMemory) {
+    // Watched pages have no pointer either, but are only watched for accesses by the CPU
+    const PageType type = current_page_table->attributes[vaddr >> PAGE_BITS];
+    if (type == PageType::RasterizerCachedMemory || type == PageType::Memory) {
         return GetPointerFromVMA(vaddr);
     }
 
@@ -237,6 +340,27 @@ u8* GetPointer(const VAddr vaddr) {
     return nullptr;
 }
 
+u8* GetContiguousPointer(const VAddr vaddr, const std::size_t size) {
+    const VAddr first_page = vaddr >> PAGE_BITS;
+    const VAddr last_page = (vaddr + std::max<std::size_t>(size, 1) - 1) >> PAGE_BITS;
+    if (last_page >= PAGE_TABLE_NUM_ENTRIES || last_page < first_page) {
+        return nullptr;
+    }
+
+    // Rasterizer cached and special pages have no pointer, so they end the range here as well
+    u8* const first_page_pointer = current_page_table->pointers[first_page];
+    if (first_page_pointer == nullptr) {
+        return nullptr;
+    }
+    for (VAddr page = first_page + 1; page <= last_page; ++page) {
+        if (current_page_table->pointers[page] !=
+            first_page_pointer + ((page - first_page) << PAGE_BITS)) {
+            return nullptr;
+        }
+    }
+    return first_page_pointer + (vaddr & PAGE_MASK);
+}
+
 std::string ReadCString(VAddr vaddr, std::size_t max_length) {
     std::string string;
     string.reserve(max_length);
@@ -303,7 +427,9 @@ void RasterizerMarkRegionCached(VAddr vaddr, u64 size, bool cached) {
                     page_type = PageType::Unmapped;
                 } else {
                     page_type = PageType::Memory;
-                    current_page_table->pointers[vaddr >> PAGE_BITS] = pointer;
+                    if (!IsPageWatched(*current_page_table, vaddr >> PAGE_BITS)) {
+                        current_page_table->pointers[vaddr >> PAGE_BITS] = pointer;
+                    }
                 }
                 break;
             }
@@ -323,6 +449,8 @@ void RasterizerFlushVirtualRegion(VAddr start, u64 size, FlushMode mode) {
         return;
     }
 
+    AccessStats::RecordRasterizerFlush(start, size, mode);
+
     VAddr end = start + size;
 
     const auto CheckRegion = [&](VAddr region_start, VAddr region_end) {
@@ -335,16 +463,16 @@ void RasterizerFlushVirtualRegion(VAddr start, u64 size, FlushMode mode) {
         const VAddr overlap_end = std::min(end, region_end);
         const u64 overlap_size = overlap_end - overlap_start;
 
-        auto& rasterizer = system_instance.Renderer().Rasterizer();
+        auto& gpu = system_instance.GPU();
         switch (mode) {
         case FlushMode::Flush:
-            rasterizer.FlushRegion(overlap_start, overlap_size);
+            gpu.FlushRegion(overlap_start, overlap_size);
             break;
         case FlushMode::Invalidate:
-            rasterizer.InvalidateRegion(overlap_start, overlap_size);
+            gpu.InvalidateRegion(overlap_start, overlap_size);
             break;
         case FlushMode::FlushAndInvalidate:
-            rasterizer.FlushAndInvalidateRegion(overlap_start, overlap_size);
+            gpu.FlushAndInvalidateRegion(overlap_start, overlap_size);
             break;
         }
     };
@@ -353,6 +481,101 @@ void RasterizerFlushVirtualRegion(VAddr start, u64 size, FlushMode mode) {
     CheckRegion(HEAP_VADDR, HEAP_VADDR_END);
 }
 
+void MarkRegionWatched(VAddr vaddr, u64 size, bool watched) {
+    const u64 first_page = vaddr >> PAGE_BITS;
+    const u64 last_page = (vaddr + std::max<u64>(size, 1) - 1) >> PAGE_BITS;
+    auto& watched_pages = current_page_table->watched_pages;
+
+    for (u64 page = first_page; page <= last_page; ++page) {
+        if (watched) {
+            // Clearing the pointer makes the JIT go through the memory callbacks for this page
+            ++watched_pages[page];
+            current_page_table->pointers[page] = nullptr;
+            continue;
+        }
+
+        const auto iter = watched_pages.find(page);
+        if (iter == watched_pages.end() || --iter->second != 0) {
+            continue;
+        }
+        watched_pages.erase(iter);
+        if (current_page_table->attributes[page] == PageType::Memory) {
+            current_page_table->pointers[page] = GetPointerFromVMA(page << PAGE_BITS);
+        }
+    }
+}
+
+/**
+ * Splits a block of the address space of a process into runs of pages that have the same type
+ * and, when they're backed by memory, are backed by contiguous host memory. This lets the block
+ * accessors handle each run with a single copy and a single rasterizer flush.
+ * @param name Name of the accessor, logged along with the unmapped runs
+ * @param on_unmapped Called with the offset into the block and size of unmapped runs
+ * @param on_memory Called with the host pointer, offset into the block and size of memory runs
+ * @param on_cached Called with the address, host pointer, offset into the block and size of
+ *                  rasterizer cached runs
+ */
+template <typename UnmappedFunc, typename MemoryFunc, typename CachedFunc>
+static void WalkBlock(const Kernel::Process& process, const char* name, VAddr addr,
+                      std::size_t size, UnmappedFunc&& on_unmapped, MemoryFunc&& on_memory,
+                      CachedFunc&& on_cached) {
+    const auto& page_table = process.vm_manager.page_table;
+    const auto GetHostPointer = [&](VAddr vaddr, PageType type) -> u8* {
+        switch (type) {
+        case PageType::Memory:
+            if (page_table.pointers[vaddr >> PAGE_BITS] == nullptr) {
+                // Watched pages are accessed directly by the emulator, only the CPU is watched
+                DEBUG_ASSERT(IsPageWatched(page_table, vaddr >> PAGE_BITS));
+                return GetPointerFromVMA(process, vaddr);
+            }
+            return page_table.pointers[vaddr >> PAGE_BITS] + (vaddr & PAGE_MASK);
+        case PageType::RasterizerCachedMemory:
+            return GetPointerFromVMA(process, vaddr);
+        default:
+            return nullptr;
+        }
+    };
+
+    std::size_t offset = 0;
+    while (offset < size) {
+        const VAddr run_addr = addr + offset;
+        const PageType type = page_table.attributes[run_addr >> PAGE_BITS];
+        u8* const run_pointer = GetHostPointer(run_addr, type);
+
+        std::size_t run_size =
+            std::min(static_cast<std::size_t>(PAGE_SIZE - (run_addr & PAGE_MASK)), size - offset);
+        while (offset + run_size < size) {
+            const VAddr next_addr = run_addr + run_size;
+            if (page_table.attributes[next_addr >> PAGE_BITS] != type) {
+                break;
+            }
+            // Unmapped pages have no pointer and only need to be of the same type
+            if (run_pointer != nullptr &&
+                GetHostPointer(next_addr, type) != run_pointer + run_size) {
+                break;
+            }
+            run_size += std::min(static_cast<std::size_t>(PAGE_SIZE), size - offset - run_size);
+        }
+
+        switch (type) {
+        case PageType::Unmapped:
+            LOG_ERROR(HW_Memory, "Unmapped {} @ 0x{:016X} (start address = 0x{:016X}, size = {})",
+                      name, run_addr, addr, size);
+            on_unmapped(offset, run_size);
+            break;
+        case PageType::Memory:
+            on_memory(run_pointer, offset, run_size);
+            break;
+        case PageType::RasterizerCachedMemory:
+            on_cached(run_addr, run_pointer, offset, run_size);
+            break;
+        default:
+            UNREACHABLE();
+        }
+        offset += run_size;
+    }
+}
+
 u8 Read8(const VAddr addr) {
     return Read<u8>(addr);
 }
@@ -371,47 +594,18 @@ u64 Read64(const VAddr addr) {
 
 void ReadBlock(const Kernel::Process& process, const VAddr src_addr, void* dest_buffer,
                const std::size_t size) {
-    auto& page_table = process.vm_manager.page_table;
-
-    std::size_t remaining_size = size;
-    std::size_t page_index = src_addr >> PAGE_BITS;
-    std::size_t page_offset = src_addr & PAGE_MASK;
-
-    while (remaining_size > 0) {
-        const std::size_t copy_amount =
-            std::min(static_cast<std::size_t>(PAGE_SIZE) - page_offset, remaining_size);
-        const VAddr current_vaddr = static_cast<VAddr>((page_index << PAGE_BITS) + page_offset);
-
-        switch (page_table.attributes[page_index]) {
-        case PageType::Unmapped: {
-            LOG_ERROR(HW_Memory,
-                      "Unmapped ReadBlock @ 0x{:016X} (start address = 0x{:016X}, size = {})",
-                      current_vaddr, src_addr, size);
-            std::memset(dest_buffer, 0, copy_amount);
-            break;
-        }
-        case PageType::Memory: {
-            DEBUG_ASSERT(page_table.pointers[page_index]);
-
-            const u8* src_ptr = page_table.pointers[page_index] + page_offset;
-            std::memcpy(dest_buffer, src_ptr, copy_amount);
-            break;
-        }
-        case PageType::RasterizerCachedMemory: {
-            RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
-                                         FlushMode::Flush);
-            std::memcpy(dest_buffer, GetPointerFromVMA(process, current_vaddr), copy_amount);
-            break;
-        }
-        default:
-            UNREACHABLE();
-        }
-
-        page_index++;
-        page_offset = 0;
-        dest_buffer = static_cast<u8*>(dest_buffer) + copy_amount;
-        remaining_size -= copy_amount;
-    }
+    u8* const dest = static_cast<u8*>(dest_buffer);
+    WalkBlock(process, "ReadBlock", src_addr, size,
+              [&](std::size_t offset, std::size_t run_size) {
+                  std::memset(dest + offset, 0, run_size);
+              },
+              [&](const u8* pointer, std::size_t offset, std::size_t run_size) {
+                  std::memcpy(dest + offset, pointer, run_size);
+              },
+              [&](VAddr run_addr, const u8* pointer, std::size_t offset, std::size_t run_size) {
+                  RasterizerFlushVirtualRegion(run_addr, run_size, FlushMode::Flush);
+                  std::memcpy(dest + offset, pointer, run_size);
+              });
 }
 
 void ReadBlock(const VAddr src_addr, void* dest_buffer, const std::size_t size) {
@@ -436,45 +630,15 @@ void Write64(const VAddr addr, const u64 data) {
 
 void WriteBlock(const Kernel::Process& process, const VAddr dest_addr, const void* src_buffer,
                 const std::size_t size) {
-    auto& page_table = process.vm_manager.page_table;
-    std::size_t remaining_size = size;
-    std::size_t page_index = dest_addr >> PAGE_BITS;
-    std::size_t page_offset = dest_addr & PAGE_MASK;
-
-    while (remaining_size > 0) {
-        const std::size_t copy_amount =
-            std::min(static_cast<std::size_t>(PAGE_SIZE) - page_offset, remaining_size);
-        const VAddr current_vaddr = static_cast<VAddr>((page_index << PAGE_BITS) + page_offset);
-
-        switch (page_table.attributes[page_index]) {
-        case PageType::Unmapped: {
-            LOG_ERROR(HW_Memory,
-                      "Unmapped WriteBlock @ 0x{:016X} (start address = 0x{:016X}, size = {})",
-                      current_vaddr, dest_addr, size);
-            break;
-        }
-        case PageType::Memory: {
-            DEBUG_ASSERT(page_table.pointers[page_index]);
-
-            u8* dest_ptr = page_table.pointers[page_index] + page_offset;
-            std::memcpy(dest_ptr, src_buffer, copy_amount);
-            break;
-        }
-        case PageType::RasterizerCachedMemory: {
-            RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
-                                         FlushMode::Invalidate);
-            std::memcpy(GetPointerFromVMA(process, current_vaddr), src_buffer, copy_amount);
-            break;
-        }
-        default:
-            UNREACHABLE();
-        }
-
-        page_index++;
-        page_offset = 0;
-        src_buffer = static_cast<const u8*>(src_buffer) + copy_amount;
-        remaining_size -= copy_amount;
-    }
+    const u8* const src = static_cast<const u8*>(src_buffer);
+    WalkBlock(process, "WriteBlock", dest_addr, size, [](std::size_t, std::size_t) {},
+              [&](u8* pointer, std::size_t offset, std::size_t run_size) {
+                  std::memcpy(pointer, src + offset, run_size);
+              },
+              [&](VAddr run_addr, u8* pointer, std::size_t offset, std::size_t run_size) {
+                  RasterizerFlushVirtualRegion(run_addr, run_size, FlushMode::Invalidate);
+                  std::memcpy(pointer, src + offset, run_size);
+              });
 }
 
 void WriteBlock(const VAddr dest_addr, const void* src_buffer, const std::size_t size) {
@@ -482,88 +646,41 @@ void WriteBlock(const VAddr dest_addr, const void* src_buffer, const std::size_t
 }
 
 void ZeroBlock(const Kernel::Process& process, const VAddr dest_addr, const std::size_t size) {
-    auto& page_table = process.vm_manager.page_table;
-    std::size_t remaining_size = size;
-    std::size_t page_index = dest_addr >> PAGE_BITS;
-    std::size_t page_offset = dest_addr & PAGE_MASK;
-
-    while (remaining_size > 0) {
-        const std::size_t copy_amount =
-            std::min(static_cast<std::size_t>(PAGE_SIZE) - page_offset, remaining_size);
-        const VAddr current_vaddr = static_cast<VAddr>((page_index << PAGE_BITS) + page_offset);
-
-        switch (page_table.attributes[page_index]) {
-        case PageType::Unmapped: {
-            LOG_ERROR(HW_Memory,
-                      "Unmapped ZeroBlock @ 0x{:016X} (start address = 0x{:016X}, size = {})",
-                      current_vaddr, dest_addr, size);
-            break;
-        }
-        case PageType::Memory: {
-            DEBUG_ASSERT(page_table.pointers[page_index]);
-
-            u8* dest_ptr = page_table.pointers[page_index] + page_offset;
-            std::memset(dest_ptr, 0, copy_amount);
-            break;
-        }
-        case PageType::RasterizerCachedMemory: {
-            RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
-                                         FlushMode::Invalidate);
-            std::memset(GetPointerFromVMA(process, current_vaddr), 0, copy_amount);
-            break;
-        }
-        default:
-            UNREACHABLE();
-        }
+    WalkBlock(process, "ZeroBlock", dest_addr, size, [](std::size_t, std::size_t) {},
+              [&](u8* pointer, std::size_t, std::size_t run_size) {
+                  std::memset(pointer, 0, run_size);
+              },
+              [&](VAddr run_addr, u8* pointer, std::size_t, std::size_t run_size) {
+                  RasterizerFlushVirtualRegion(run_addr, run_size, FlushMode::Invalidate);
+                  std::memset(pointer, 0, run_size);
+              });
+}
 
-        page_index++;
-        page_offset = 0;
-        remaining_size -= copy_amount;
-    }
+void FillBlock(const Kernel::Process& process, const VAddr dest_addr, const u8 value,
+               const std::size_t size) {
+    WalkBlock(process, "FillBlock", dest_addr, size, [](std::size_t, std::size_t) {},
+              [&](u8* pointer, std::size_t, std::size_t run_size) {
+                  std::memset(pointer, value, run_size);
+              },
+              [&](VAddr run_addr, u8* pointer, std::size_t, std::size_t run_size) {
+                  RasterizerFlushVirtualRegion(run_addr, run_size, FlushMode::Invalidate);
+                  std::memset(pointer, value, run_size);
+              });
 }
 
 void CopyBlock(const Kernel::Process& process, VAddr dest_addr, VAddr src_addr,
                const std::size_t size) {
-    auto& page_table = process.vm_manager.page_table;
-    std::size_t remaining_size = size;
-    std::size_t page_index = src_addr >> PAGE_BITS;
-    std::size_t page_offset = src_addr & PAGE_MASK;
-
-    while (remaining_size > 0) {
-        const std::size_t copy_amount =
-            std::min(static_cast<std::size_t>(PAGE_SIZE) - page_offset, remaining_size);
-        const VAddr current_vaddr = static_cast<VAddr>((page_index << PAGE_BITS) + page_offset);
-
-        switch (page_table.attributes[page_index]) {
-        case PageType::Unmapped: {
-            LOG_ERROR(HW_Memory,
-                      "Unmapped CopyBlock @ 0x{:016X} (start address = 0x{:016X}, size = {})",
-                      current_vaddr, src_addr, size);
-            ZeroBlock(process, dest_addr, copy_amount);
-            break;
-        }
-        case PageType::Memory: {
-            DEBUG_ASSERT(page_table.pointers[page_index]);
-            const u8* src_ptr = page_table.pointers[page_index] + page_offset;
-            WriteBlock(process, dest_addr, src_ptr, copy_amount);
-            break;
-        }
-        case PageType::RasterizerCachedMemory: {
-            RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
-                                         FlushMode::Flush);
-            WriteBlock(process, dest_addr, GetPointerFromVMA(process, current_vaddr), copy_amount);
-            break;
-        }
-        default:
-            UNREACHABLE();
-        }
-
-        page_index++;
-        page_offset = 0;
-        dest_addr += static_cast<VAddr>(copy_amount);
-        src_addr += static_cast<VAddr>(copy_amount);
-        remaining_size -= copy_amount;
-    }
+    WalkBlock(process, "CopyBlock", src_addr, size,
+              [&](std::size_t offset, std::size_t run_size) {
+                  ZeroBlock(process, dest_addr + offset, run_size);
+              },
+              [&](const u8* pointer, std::size_t offset, std::size_t run_size) {
+                  WriteBlock(process, dest_addr + offset, pointer, run_size);
+              },
+              [&](VAddr run_addr, const u8* pointer, std::size_t offset, std::size_t run_size) {
+                  RasterizerFlushVirtualRegion(run_addr, run_size, FlushMode::Flush);
+                  WriteBlock(process, dest_addr + offset, pointer, run_size);
+              });
 }
 
 void CopyBlock(VAddr dest_addr, VAddr src_addr, std::size_t size) {
@@ -8,8 +8,10 @@
 #include <cstddef>
 #include <string>
 #include <tuple>
+#include <unordered_map>
 #include <boost/icl/interval_map.hpp>
 #include "common/common_types.h"
+#include "common/virtual_buffer.h"
 #include "core/memory_hook.h"
 
 namespace Kernel {
@@ -29,8 +31,9 @@ constexpr std::size_t ADDRESS_SPACE_BITS = 36;
 constexpr std::size_t PAGE_TABLE_NUM_ENTRIES = 1ULL << (ADDRESS_SPACE_BITS - PAGE_BITS);
 
 enum class PageType : u8 {
-    /// Page is unmapped and should cause an access error.
-    Unmapped,
+    /// Page is unmapped and should cause an access error. Page tables start out zero filled, so
+    /// this must stay zero.
+    Unmapped = 0,
     /// Page is mapped to regular memory. This is the only type you can get pointers to.
     Memory,
     /// Page is mapped to regular memory, but also needs to check for rasterizer cache flushing and
@@ -59,14 +62,23 @@ struct SpecialRegion {
 
 /**
  * A (reasonably) fast way of allowing switchable and remappable process address spaces. It loosely
- * mimics the way a real CPU page table works.
+ * mimics the way a real CPU page table works. Its arrays span the whole address space, but their
+ * pages are only allocated once an entry in them is mapped.
  */
 struct PageTable {
     /**
      * Array of memory pointers backing each page. An entry can only be non-null if the
-     * corresponding entry in the `attributes` array is of type `Memory`.
+     * corresponding entry in the `attributes` array is of type `Memory` and the page isn't
+     * watched.
      */
-    std::array<u8*, PAGE_TABLE_NUM_ENTRIES> pointers;
+    Common::VirtualBuffer<u8*> pointers{PAGE_TABLE_NUM_ENTRIES};
+
+    /**
+     * Number of debugger watchpoints touching each page that has any. These pages have no entry
+     * in `pointers`, so that the CPU accesses them through the memory accessors, which check the
+     * watchpoints, while every other page is still accessed directly.
+     */
+    std::unordered_map<u64, u32> watched_pages;
 
     /**
      * Contains MMIO handlers that back memory regions whose entries in the `attribute` array is of
@@ -78,7 +90,7 @@ struct PageTable {
      * Array of fine grained page attributes. If it is set to any value other than `Memory`, then
      * the corresponding entry in `pointers` MUST be set to null.
      */
-    std::array<PageType, PAGE_TABLE_NUM_ENTRIES> attributes;
+    Common::VirtualBuffer<PageType> attributes{PAGE_TABLE_NUM_ENTRIES};
 };
 
 /// Virtual user-space memory regions
@@ -160,10 +172,18 @@ void WriteBlock(const Kernel::Process& process, VAddr dest_addr, const void* src
                 std::size_t size);
 void WriteBlock(VAddr dest_addr, const void* src_buffer, std::size_t size);
 void ZeroBlock(const Kernel::Process& process, VAddr dest_addr, std::size_t size);
+void FillBlock(const Kernel::Process& process, VAddr dest_addr, u8 value, std::size_t size);
 void CopyBlock(VAddr dest_addr, VAddr src_addr, std::size_t size);
 
 u8* GetPointer(VAddr vaddr);
 
+/**
+ * Gets a host pointer to the range [vaddr, vaddr + size) when all of it is regular memory that is
+ * also contiguous on the host, so that it can be accessed without ReadBlock/WriteBlock.
+ * @returns The pointer to vaddr, or nullptr when the range has to be accessed page by page.
+ */
+u8* GetContiguousPointer(VAddr vaddr, std::size_t size);
+
 std::string ReadCString(VAddr vaddr, std::size_t max_length);
 
 enum class FlushMode {
@@ -186,4 +206,10 @@ void RasterizerMarkRegionCached(VAddr vaddr, u64 size, bool cached);
  */
 void RasterizerFlushVirtualRegion(VAddr start, u64 size, FlushMode mode);
 
+/**
+ * Mark each page touching the region as watched by a debugger watchpoint, or remove one such mark.
+ * Pages stay watched until each of their marks has been removed.
+ */
+void MarkRegionWatched(VAddr vaddr, u64 size, bool watched);
+
 } // namespace Memory
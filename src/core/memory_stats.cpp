@@ -0,0 +1,200 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <fmt/format.h>
+#include "common/logging/log.h"
+#include "core/memory_stats.h"
+#include "core/settings.h"
+
+namespace Memory::AccessStats {
+namespace {
+/// Number of pages listed by LogTotals
+constexpr std::size_t NUM_LOGGED_PAGES = 16;
+
+constexpr std::array<const char*, 4> PAGE_TYPE_NAMES{"Unmapped", "Memory",
+                                                     "RasterizerCachedMemory", "Special"};
+
+std::mutex stats_mutex;
+// Keyed by page number
+std::unordered_map<u64, PageAccessStats> page_stats;
+std::array<u64, 4> accesses_by_page_type{};
+std::map<std::string, CachedObjectStats> cached_object_stats;
+
+/// Returns the counters of the page, must be called with the lock held
+PageAccessStats& GetPageStats(u64 page) {
+    PageAccessStats& stats = page_stats[page];
+    stats.address = page << PAGE_BITS;
+    return stats;
+}
+
+/// Calls the function with the counters of every page overlapping the region, with the lock held
+template <typename Func>
+void ForEachPage(VAddr addr, u64 size, Func&& func) {
+    const u64 first_page = addr >> PAGE_BITS;
+    const u64 last_page = (addr + std::max<u64>(size, 1) - 1) >> PAGE_BITS;
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    for (u64 page = first_page; page <= last_page; ++page) {
+        func(GetPageStats(page));
+    }
+}
+} // Anonymous namespace
+
+bool IsEnabled() {
+    return Settings::values.record_memory_stats;
+}
+
+void RecordSlowAccess(VAddr vaddr, PageType type, bool is_write) {
+    if (!IsEnabled()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    PageAccessStats& stats = GetPageStats(vaddr >> PAGE_BITS);
+    ++(is_write ? stats.slow_writes : stats.slow_reads);
+    ++accesses_by_page_type[static_cast<std::size_t>(type)];
+}
+
+void RecordRasterizerFlush(VAddr addr, u64 size, FlushMode mode) {
+    if (!IsEnabled()) {
+        return;
+    }
+    const bool flushes = mode != FlushMode::Invalidate;
+    const bool invalidates = mode != FlushMode::Flush;
+    ForEachPage(addr, size, [&](PageAccessStats& stats) {
+        stats.rasterizer_flushes += flushes ? 1 : 0;
+        stats.rasterizer_invalidations += invalidates ? 1 : 0;
+    });
+}
+
+void RecordVMALookup(VAddr vaddr) {
+    if (!IsEnabled()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    ++GetPageStats(vaddr >> PAGE_BITS).vma_lookups;
+}
+
+void RecordFlushedObjects(const char* cache_name, std::size_t count) {
+    if (!IsEnabled() || count == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    CachedObjectStats& stats = cached_object_stats[cache_name];
+    stats.cache_name = cache_name;
+    stats.flushed += count;
+}
+
+void RecordInvalidatedObjects(const char* cache_name, std::size_t count) {
+    if (!IsEnabled() || count == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    CachedObjectStats& stats = cached_object_stats[cache_name];
+    stats.cache_name = cache_name;
+    stats.invalidated += count;
+}
+
+MemoryAccessReport GetReport() {
+    MemoryAccessReport report;
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        report.pages.reserve(page_stats.size());
+        for (const auto& [page, stats] : page_stats) {
+            report.pages.push_back(stats);
+        }
+        report.accesses_by_page_type = accesses_by_page_type;
+        for (const auto& [name, stats] : cached_object_stats) {
+            report.cached_objects.push_back(stats);
+        }
+    }
+
+    std::sort(report.pages.begin(), report.pages.end(), [](const auto& lhs, const auto& rhs) {
+        const u64 lhs_total = lhs.GetTotal();
+        const u64 rhs_total = rhs.GetTotal();
+        return lhs_total != rhs_total ? lhs_total > rhs_total : lhs.address < rhs.address;
+    });
+    return report;
+}
+
+void Reset() {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    page_stats.clear();
+    accesses_by_page_type.fill(0);
+    cached_object_stats.clear();
+}
+
+void LogTotals() {
+    const MemoryAccessReport report = GetReport();
+    if (report.pages.empty()) {
+        return;
+    }
+
+    LOG_INFO(HW_Memory, "Slow path memory accesses, by page type:");
+    for (std::size_t type = 0; type < PAGE_TYPE_NAMES.size(); ++type) {
+        LOG_INFO(HW_Memory, "  {:<24} {:>12}", PAGE_TYPE_NAMES[type],
+                 report.accesses_by_page_type[type]);
+    }
+
+    LOG_INFO(HW_Memory, "Rasterizer cache objects flushed and invalidated by guest accesses:");
+    for (const CachedObjectStats& stats : report.cached_objects) {
+        LOG_INFO(HW_Memory, "  {:<24} {:>12} flushed {:>12} invalidated", stats.cache_name,
+                 stats.flushed, stats.invalidated);
+    }
+
+    LOG_INFO(HW_Memory, "Most accessed pages, out of {}:", report.pages.size());
+    const std::size_t num_logged = std::min(report.pages.size(), NUM_LOGGED_PAGES);
+    for (std::size_t i = 0; i < num_logged; ++i) {
+        const PageAccessStats& stats = report.pages[i];
+        LOG_INFO(HW_Memory,
+                 "  0x{:016X}: {} reads, {} writes, {} flushes, {} invalidations, "
+                 "{} VMA lookups",
+                 stats.address, stats.slow_reads, stats.slow_writes, stats.rasterizer_flushes,
+                 stats.rasterizer_invalidations, stats.vma_lookups);
+    }
+}
+
+std::string FormatCSV(const MemoryAccessReport& report) {
+    std::string csv = "address,slow_reads,slow_writes,rasterizer_flushes,"
+                      "rasterizer_invalidations,vma_lookups\n";
+    for (const PageAccessStats& stats : report.pages) {
+        csv += fmt::format("0x{:016X},{},{},{},{},{}\n", stats.address, stats.slow_reads,
+                           stats.slow_writes, stats.rasterizer_flushes,
+                           stats.rasterizer_invalidations, stats.vma_lookups);
+    }
+    return csv;
+}
+
+std::string FormatJSON(const MemoryAccessReport& report) {
+    std::string json = "{\n  \"page_types\": {";
+    for (std::size_t type = 0; type < PAGE_TYPE_NAMES.size(); ++type) {
+        json += fmt::format("{}\"{}\": {}", type == 0 ? "" : ", ", PAGE_TYPE_NAMES[type],
+                            report.accesses_by_page_type[type]);
+    }
+
+    json += "},\n  \"caches\": [";
+    for (std::size_t i = 0; i < report.cached_objects.size(); ++i) {
+        const CachedObjectStats& stats = report.cached_objects[i];
+        json += fmt::format("{}\n    {{\"name\": \"{}\", \"flushed\": {}, \"invalidated\": {}}}",
+                            i == 0 ? "" : ",", stats.cache_name, stats.flushed,
+                            stats.invalidated);
+    }
+
+    json += "\n  ],\n  \"pages\": [";
+    for (std::size_t i = 0; i < report.pages.size(); ++i) {
+        const PageAccessStats& stats = report.pages[i];
+        json += fmt::format("{}\n    {{\"address\": \"0x{:016X}\", \"slow_reads\": {}, "
+                            "\"slow_writes\": {}, \"rasterizer_flushes\": {}, "
+                            "\"rasterizer_invalidations\": {}, \"vma_lookups\": {}}}",
+                            i == 0 ? "" : ",", stats.address, stats.slow_reads,
+                            stats.slow_writes, stats.rasterizer_flushes,
+                            stats.rasterizer_invalidations, stats.vma_lookups);
+    }
+    json += "\n  ]\n}\n";
+    return json;
+}
+
+} // namespace Memory::AccessStats
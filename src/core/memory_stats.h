@@ -0,0 +1,91 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+#include "core/memory.h"
+
+namespace Memory {
+
+/// Accesses to one guest page which couldn't take the fast path through its page pointer
+struct PageAccessStats {
+    VAddr address = 0;
+
+    /// Memory::Read and Memory::Write calls that took the slow path
+    u64 slow_reads = 0;
+    u64 slow_writes = 0;
+    /// Flushes and invalidations of the rasterizer caches requested for the page
+    u64 rasterizer_flushes = 0;
+    u64 rasterizer_invalidations = 0;
+    /// Pointers looked up in the VMAs because the page has none in the page table
+    u64 vma_lookups = 0;
+
+    u64 GetTotal() const {
+        return slow_reads + slow_writes + rasterizer_flushes + rasterizer_invalidations +
+               vma_lookups;
+    }
+};
+
+/// Objects of one of the rasterizer caches written back or dropped because of guest accesses
+struct CachedObjectStats {
+    std::string cache_name;
+    u64 flushed = 0;
+    u64 invalidated = 0;
+};
+
+struct MemoryAccessReport {
+    /// Pages which were accessed through the slow path, by decreasing number of accesses
+    std::vector<PageAccessStats> pages;
+    /// Slow path reads and writes by the type of the page they hit, indexed by PageType
+    std::array<u64, 4> accesses_by_page_type{};
+    /// Sorted by cache name
+    std::vector<CachedObjectStats> cached_objects;
+};
+
+/**
+ * Counts the guest memory accesses which miss the fast path, to find out which pages and which
+ * titles pay for the rasterizer cached pages. Only records when record_memory_stats is set. The
+ * counters are updated by the CPU and the GPU threads alike, so they're guarded by a lock of
+ * their own, which is only taken while recording.
+ */
+namespace AccessStats {
+
+bool IsEnabled();
+
+/// Records a Memory::Read or Memory::Write that missed the page pointer
+void RecordSlowAccess(VAddr vaddr, PageType type, bool is_write);
+
+/// Records a flush and/or invalidation of the rasterizer caches over the region
+void RecordRasterizerFlush(VAddr addr, u64 size, FlushMode mode);
+
+/// Records a page pointer looked up in the VMAs of the process
+void RecordVMALookup(VAddr vaddr);
+
+/// Records objects of a rasterizer cache written back to guest memory
+void RecordFlushedObjects(const char* cache_name, std::size_t count);
+
+/// Records objects of a rasterizer cache dropped because guest memory changed
+void RecordInvalidatedObjects(const char* cache_name, std::size_t count);
+
+MemoryAccessReport GetReport();
+
+/// Clears all the recorded counters
+void Reset();
+
+/// Logs the totals per page type and per cache, and the most accessed pages
+void LogTotals();
+
+/// Formats the pages of the report as a CSV table with a header row, one row per page
+std::string FormatCSV(const MemoryAccessReport& report);
+
+/// Formats the whole report as a JSON object
+std::string FormatJSON(const MemoryAccessReport& report);
+
+} // namespace AccessStats
+} // namespace Memory
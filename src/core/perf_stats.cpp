@@ -4,12 +4,26 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <mutex>
 #include <thread>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include <fmt/format.h>
+#include "common/assert.h"
 #include "common/math_util.h"
+#include "common/tracing.h"
 #include "core/perf_stats.h"
 #include "core/settings.h"
 
+#ifdef _WIN32
+// Only defined by recent SDKs, creating such a timer fails on Windows versions older than 1803
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#endif
+
 using namespace std::chrono_literals;
 using DoubleSecs = std::chrono::duration<double, std::chrono::seconds::period>;
 using std::chrono::duration_cast;
@@ -17,6 +31,48 @@ using std::chrono::microseconds;
 
 namespace Core {
 
+const char* GetPerfStageName(PerfStage stage) {
+    switch (stage) {
+    case PerfStage::CPU:
+        return "CPU";
+    case PerfStage::HLE:
+        return "HLE";
+    case PerfStage::GPU:
+        return "GPU";
+    case PerfStage::ShaderCompile:
+        return "Shaders";
+    case PerfStage::TextureUpload:
+        return "Textures";
+    case PerfStage::Present:
+        return "Present";
+    case PerfStage::Audio:
+        return "Audio";
+    default:
+        UNREACHABLE();
+        return "";
+    }
+}
+
+const char* GetPerfCounterName(PerfCounter counter) {
+    switch (counter) {
+    case PerfCounter::DrawCalls:
+        return "Draws";
+    case PerfCounter::CommandLists:
+        return "CommandLists";
+    case PerfCounter::ShaderCode:
+        return "ShaderCodeBytes";
+    case PerfCounter::TextureDedup:
+        return "DedupTextureBytes";
+    case PerfCounter::SkippedDraws:
+        return "SkippedDraws";
+    case PerfCounter::AudioVoices:
+        return "AudioVoices";
+    default:
+        UNREACHABLE();
+        return "";
+    }
+}
+
 void PerfStats::BeginSystemFrame() {
     std::lock_guard<std::mutex> lock(object_mutex);
 
@@ -32,6 +88,36 @@ void PerfStats::EndSystemFrame() {
 
     previous_frame_length = frame_end - previous_frame_end;
     previous_frame_end = frame_end;
+    frame_lengths.push_back(previous_frame_length);
+    ++total_system_frames;
+
+    FrameRecord record;
+    record.end = DoubleSecs(frame_end - creation_point).count();
+    record.length = DoubleSecs(previous_frame_length).count();
+    for (std::size_t stage = 0; stage < NumPerfStages; ++stage) {
+        const s64 time_ns = current_stage_times[stage].exchange(0, std::memory_order_relaxed);
+        record.stage_times[stage] = time_ns / 1'000'000'000.0;
+        record.stage_calls[stage] =
+            current_stage_calls[stage].exchange(0, std::memory_order_relaxed);
+    }
+    for (std::size_t counter = 0; counter < NumPerfCounters; ++counter) {
+        record.counters[counter] = current_counters[counter].exchange(0, std::memory_order_relaxed);
+    }
+    YUZU_TRACE_COUNTER("Frame length (us)",
+                       duration_cast<microseconds>(previous_frame_length).count());
+    YUZU_TRACE_COUNTER("Draws", record.counters[static_cast<std::size_t>(PerfCounter::DrawCalls)]);
+    // The CPU runs HLE code from within guest code, the CPU stage only counts the guest's part
+    auto& cpu_time = record.stage_times[static_cast<std::size_t>(PerfStage::CPU)];
+    const double hle_time = record.stage_times[static_cast<std::size_t>(PerfStage::HLE)];
+    cpu_time = std::max(0.0, cpu_time - hle_time);
+
+    for (std::size_t stage = 0; stage < NumPerfStages; ++stage) {
+        accumulated_stage_times[stage] += record.stage_times[stage];
+    }
+    frame_history.push_back(record);
+    if (frame_history.size() > MAX_FRAME_HISTORY) {
+        frame_history.pop_front();
+    }
 }
 
 void PerfStats::EndGameFrame() {
@@ -40,6 +126,15 @@ void PerfStats::EndGameFrame() {
     game_frames += 1;
 }
 
+/// Returns the value at the given percentile of a sorted list, using the nearest rank
+static double GetPercentile(const std::vector<double>& sorted_values, double percentile) {
+    if (sorted_values.empty()) {
+        return 0.0;
+    }
+    const auto rank{static_cast<std::size_t>(std::ceil(percentile / 100.0 * sorted_values.size()))};
+    return sorted_values[std::clamp<std::size_t>(rank, 1, sorted_values.size()) - 1];
+}
+
 PerfStatsResults PerfStats::GetAndResetStats(microseconds current_system_time_us) {
     std::lock_guard<std::mutex> lock(object_mutex);
 
@@ -56,16 +151,158 @@ PerfStatsResults PerfStats::GetAndResetStats(microseconds current_system_time_us
                         static_cast<double>(system_frames);
     results.emulation_speed = system_us_per_second.count() / 1'000'000.0;
 
+    // Averages hide stutters, so the distribution of the frame lengths is reported as well
+    std::vector<double> lengths(frame_lengths.size());
+    std::transform(frame_lengths.begin(), frame_lengths.end(), lengths.begin(),
+                   [](Clock::duration length) { return DoubleSecs(length).count(); });
+    std::sort(lengths.begin(), lengths.end());
+    results.frame_length_median = GetPercentile(lengths, 50.0);
+    results.frame_length_p99 = GetPercentile(lengths, 99.0);
+    results.frame_length_p999 = GetPercentile(lengths, 99.9);
+    if (!lengths.empty()) {
+        double mean{};
+        for (const double length : lengths) {
+            mean += length;
+        }
+        mean /= lengths.size();
+        double variance{};
+        for (const double length : lengths) {
+            variance += (length - mean) * (length - mean);
+        }
+        results.frame_length_stddev = std::sqrt(variance / lengths.size());
+    }
+    for (std::size_t stage = 0; stage < NumPerfStages; ++stage) {
+        results.stage_times[stage] =
+            system_frames == 0 ? 0.0 : accumulated_stage_times[stage] / system_frames;
+    }
+    results.audio_latency = audio_latency_us.load(std::memory_order_relaxed) / 1'000'000.0;
+    results.audio_underruns = audio_underruns.exchange(0, std::memory_order_relaxed);
+
     // Reset counters
     reset_point = now;
     reset_point_system_us = current_system_time_us;
     accumulated_frametime = Clock::duration::zero();
     system_frames = 0;
     game_frames = 0;
+    frame_lengths.clear();
+    accumulated_stage_times = {};
 
     return results;
 }
 
+void PerfStats::AddStageTime(PerfStage stage, Clock::duration time) {
+    const auto time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+    current_stage_times[static_cast<std::size_t>(stage)].fetch_add(time_ns,
+                                                                   std::memory_order_relaxed);
+    current_stage_calls[static_cast<std::size_t>(stage)].fetch_add(1, std::memory_order_relaxed);
+    total_stage_calls[static_cast<std::size_t>(stage)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void PerfStats::AddCounter(PerfCounter counter, u64 value) {
+    current_counters[static_cast<std::size_t>(counter)].fetch_add(value,
+                                                                  std::memory_order_relaxed);
+}
+
+void PerfStats::SetAudioLatency(std::chrono::microseconds latency) {
+    audio_latency_us.store(latency.count(), std::memory_order_relaxed);
+}
+
+void PerfStats::AddAudioUnderrun() {
+    audio_underruns.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::vector<FrameRecord> PerfStats::GetFrameHistory() {
+    std::lock_guard<std::mutex> lock(object_mutex);
+
+    return {frame_history.begin(), frame_history.end()};
+}
+
+u64 PerfStats::GetTotalSystemFrames() {
+    std::lock_guard<std::mutex> lock(object_mutex);
+
+    return total_system_frames;
+}
+
+std::array<u64, NumPerfStages> PerfStats::GetTotalStageCalls() const {
+    std::array<u64, NumPerfStages> calls;
+    for (std::size_t stage = 0; stage < NumPerfStages; ++stage) {
+        calls[stage] = total_stage_calls[stage].load(std::memory_order_relaxed);
+    }
+    return calls;
+}
+
+std::string FormatFrameHistoryCSV(const std::vector<FrameRecord>& frames) {
+    std::string csv = "frame,length_ms";
+    for (std::size_t stage = 0; stage < NumPerfStages; ++stage) {
+        csv += fmt::format(",{}_ms", GetPerfStageName(static_cast<PerfStage>(stage)));
+    }
+    for (std::size_t stage = 0; stage < NumPerfStages; ++stage) {
+        csv += fmt::format(",{}_calls", GetPerfStageName(static_cast<PerfStage>(stage)));
+    }
+    for (std::size_t counter = 0; counter < NumPerfCounters; ++counter) {
+        csv += fmt::format(",{}", GetPerfCounterName(static_cast<PerfCounter>(counter)));
+    }
+    csv += '\n';
+
+    for (std::size_t i = 0; i < frames.size(); ++i) {
+        csv += fmt::format("{},{:.3f}", i, frames[i].length * 1000.0);
+        for (const double stage_time : frames[i].stage_times) {
+            csv += fmt::format(",{:.3f}", stage_time * 1000.0);
+        }
+        for (const u32 calls : frames[i].stage_calls) {
+            csv += fmt::format(",{}", calls);
+        }
+        for (const u64 value : frames[i].counters) {
+            csv += fmt::format(",{}", value);
+        }
+        csv += '\n';
+    }
+    return csv;
+}
+
+std::string FormatFrameHistoryTrace(const std::vector<FrameRecord>& frames) {
+    // Timestamps of the trace event format are in microseconds
+    constexpr double US_PER_SECOND = 1'000'000.0;
+
+    std::string json = "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    json += "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 1, "
+            "\"args\": {\"name\": \"yuzu\"}}";
+    for (std::size_t i = 0; i < frames.size(); ++i) {
+        const FrameRecord& frame = frames[i];
+        const double start = (frame.end - frame.length) * US_PER_SECOND;
+
+        json += fmt::format(",\n{{\"name\": \"Frame\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, "
+                            "\"ts\": {:.3f}, \"dur\": {:.3f}, \"args\": {{\"frame\": {}}}}}",
+                            start, frame.length * US_PER_SECOND, i);
+
+        // Counter samples hold until the next one, so they're placed at the start of their frame
+        std::string stage_times;
+        std::string stage_calls;
+        for (std::size_t stage = 0; stage < NumPerfStages; ++stage) {
+            const char* separator = stage == 0 ? "" : ", ";
+            const char* name = GetPerfStageName(static_cast<PerfStage>(stage));
+            stage_times += fmt::format("{}\"{}\": {:.3f}", separator, name,
+                                       frame.stage_times[stage] * 1000.0);
+            stage_calls += fmt::format("{}\"{}\": {}", separator, name, frame.stage_calls[stage]);
+        }
+        std::string counters;
+        for (std::size_t counter = 0; counter < NumPerfCounters; ++counter) {
+            counters += fmt::format("{}\"{}\": {}", counter == 0 ? "" : ", ",
+                                    GetPerfCounterName(static_cast<PerfCounter>(counter)),
+                                    frame.counters[counter]);
+        }
+        for (const auto& [name, args] : {std::make_pair("Stage time (ms)", &stage_times),
+                                         std::make_pair("Stage calls", &stage_calls),
+                                         std::make_pair("Counters", &counters)}) {
+            json += fmt::format(",\n{{\"name\": \"{}\", \"ph\": \"C\", \"pid\": 1, "
+                                "\"ts\": {:.3f}, \"args\": {{{}}}}}",
+                                name, start, *args);
+        }
+    }
+    json += "\n]}\n";
+    return json;
+}
+
 double PerfStats::GetLastFrameTimeScale() {
     std::lock_guard<std::mutex> lock(object_mutex);
 
@@ -73,41 +310,81 @@ double PerfStats::GetLastFrameTimeScale() {
     return duration_cast<DoubleSecs>(previous_frame_length).count() / FRAME_LENGTH;
 }
 
+FrameLimiter::FrameLimiter() {
+#ifdef _WIN32
+    wait_timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION,
+                                        TIMER_ALL_ACCESS);
+#endif
+}
+
+FrameLimiter::~FrameLimiter() {
+#ifdef _WIN32
+    if (wait_timer != nullptr) {
+        CloseHandle(wait_timer);
+    }
+#endif
+}
+
 void FrameLimiter::DoFrameLimiting(microseconds current_system_time_us) {
-    // Max lag caused by slow frames. Can be adjusted to compensate for too many slow frames. Higher
-    // values increase the time needed to recover and limit framerate again after spikes.
-    constexpr microseconds MAX_LAG_TIME_US = 25000us;
+    const microseconds emulated_time_us = current_system_time_us - previous_system_time_us;
+    previous_system_time_us = current_system_time_us;
 
+    auto now = Clock::now();
     if (!Settings::values.use_frame_limit) {
+        // Keep the deadline current so that enabling the limiter again starts from now
+        frame_deadline = now;
         return;
     }
 
-    auto now = Clock::now();
-
     const double sleep_scale = Settings::values.frame_limit / 100.0;
 
     // Max lag caused by slow frames. Shouldn't be more than the length of a frame at the current
     // speed percent or it will clamp too much and prevent this from properly limiting to that
     // percent. High values means it'll take longer after a slow frame to recover and start
     // limiting
-    const microseconds max_lag_time_us = duration_cast<microseconds>(
+    const auto max_lag_time = duration_cast<Clock::duration>(
         std::chrono::duration<double, std::chrono::microseconds::period>(25ms / sleep_scale));
-    frame_limiting_delta_err += duration_cast<microseconds>(
-        std::chrono::duration<double, std::chrono::microseconds::period>(
-            (current_system_time_us - previous_system_time_us) / sleep_scale));
-    frame_limiting_delta_err -= duration_cast<microseconds>(now - previous_walltime);
-    frame_limiting_delta_err =
-        std::clamp(frame_limiting_delta_err, -max_lag_time_us, max_lag_time_us);
+    frame_deadline += duration_cast<Clock::duration>(
+        std::chrono::duration<double, std::chrono::microseconds::period>(emulated_time_us /
+                                                                         sleep_scale));
+    frame_deadline = std::clamp(frame_deadline, now - max_lag_time, now + max_lag_time);
 
-    if (frame_limiting_delta_err > microseconds::zero()) {
-        std::this_thread::sleep_for(frame_limiting_delta_err);
-        auto now_after_sleep = Clock::now();
-        frame_limiting_delta_err -= duration_cast<microseconds>(now_after_sleep - now);
-        now = now_after_sleep;
+    if (frame_deadline > now) {
+        WaitUntil(frame_deadline);
     }
+}
 
-    previous_system_time_us = current_system_time_us;
-    previous_walltime = now;
+void FrameLimiter::WaitUntil(Clock::time_point deadline) const {
+    // Sleeps can end late by up to the resolution of the system timer, so the end of the wait is
+    // spun instead. High resolution timers only need a short spin.
+    microseconds spin_time = 2ms;
+#ifdef _WIN32
+    if (wait_timer != nullptr) {
+        spin_time = 500us;
+    }
+#endif
+
+    const auto sleep_time = deadline - Clock::now() - spin_time;
+    if (sleep_time > Clock::duration::zero()) {
+#ifdef _WIN32
+        if (wait_timer != nullptr) {
+            // Negative due times are relative, in units of 100 nanoseconds
+            LARGE_INTEGER due_time;
+            due_time.QuadPart = -static_cast<LONGLONG>(
+                duration_cast<std::chrono::nanoseconds>(sleep_time).count() / 100);
+            SetWaitableTimer(wait_timer, &due_time, 0, nullptr, nullptr, FALSE);
+            WaitForSingleObject(wait_timer, INFINITE);
+        } else {
+            std::this_thread::sleep_for(sleep_time);
+        }
+#else
+        std::this_thread::sleep_for(sleep_time);
+#endif
+    }
+
+    while (Clock::now() < deadline) {
+        std::this_thread::yield();
+    }
 }
 
 } // namespace Core
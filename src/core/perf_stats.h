@@ -4,12 +4,68 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <deque>
 #include <mutex>
+#include <string>
+#include <vector>
 #include "common/common_types.h"
 
 namespace Core {
 
+/// Parts of the work done for each frame whose time is tracked by PerfStats
+enum class PerfStage : u32 {
+    CPU,           ///< Guest code run by the CPU, not counting the time spent in HLE
+    HLE,           ///< SVCs, including the services they call
+    GPU,           ///< GPU command processing
+    ShaderCompile, ///< Compilation of host shaders
+    TextureUpload, ///< Loading of textures from guest memory
+    Present,       ///< Drawing the previous frame to the window and swapping it
+    Audio,         ///< Mixing of the audio renderer, which also counts towards HLE
+    Count,
+};
+
+constexpr std::size_t NumPerfStages = static_cast<std::size_t>(PerfStage::Count);
+
+/// Returns a short name of a stage, for display
+const char* GetPerfStageName(PerfStage stage);
+
+/// Time spent in each stage, in seconds
+using PerfStageTimes = std::array<double, NumPerfStages>;
+
+/// Events counted per frame by PerfStats, on top of the number of times each stage was timed
+enum class PerfCounter : u32 {
+    DrawCalls,    ///< Draws and clears made by the guest, however they are batched on the host
+    CommandLists, ///< GPU command lists processed
+    ShaderCode,   ///< Bytes of generated shader code given to the host driver to compile
+    TextureDedup, ///< Bytes of texture loads served by sharing an identical host texture
+    SkippedDraws, ///< Draws to presented images skipped by the frame skip
+    AudioVoices,  ///< Voices mixed by the audio renderer, once per audio frame they play in
+    Count,
+};
+
+constexpr std::size_t NumPerfCounters = static_cast<std::size_t>(PerfCounter::Count);
+
+/// Returns a short name of a counter, for display
+const char* GetPerfCounterName(PerfCounter counter);
+
+/// Performance of a single system frame
+struct FrameRecord {
+    /// Walltime from the creation of the PerfStats to the end of the frame, in seconds
+    double end;
+    /// Walltime since the previous system frame, in seconds
+    double length;
+    /// Time spent in each stage since the previous system frame. Stages that run on several
+    /// threads at once can add up to more than the frame length.
+    PerfStageTimes stage_times;
+    /// Number of times each stage was timed since the previous system frame
+    std::array<u32, NumPerfStages> stage_calls;
+    /// Value of each counter since the previous system frame
+    std::array<u64, NumPerfCounters> counters;
+};
+
 struct PerfStatsResults {
     /// System FPS (LCD VBlanks) in Hz
     double system_fps;
@@ -19,6 +75,20 @@ struct PerfStatsResults {
     double frametime;
     /// Ratio of walltime / emulated time elapsed
     double emulation_speed;
+    /// Walltime between consecutive system frames, in seconds, at the median and 99th percentile
+    double frame_length_median;
+    double frame_length_p99;
+    /// Walltime between consecutive system frames at the 99.9th percentile. Along with the 99th
+    /// percentile, this gives the 1% and 0.1% lows.
+    double frame_length_p999;
+    /// Standard deviation of the walltime between consecutive system frames, in seconds
+    double frame_length_stddev;
+    /// Average time spent in each stage per system frame
+    PerfStageTimes stage_times;
+    /// Time from audio being submitted to the audio output to it being played, in seconds
+    double audio_latency;
+    /// Number of times the audio output ran out of samples
+    u32 audio_underruns;
 };
 
 /**
@@ -35,6 +105,29 @@ public:
 
     PerfStatsResults GetAndResetStats(std::chrono::microseconds current_system_time_us);
 
+    /// Adds time spent in a stage to the current system frame. Unlike the rest of the class this
+    /// doesn't lock, as it is called from hot paths.
+    void AddStageTime(PerfStage stage, Clock::duration time);
+
+    /// Sets the current latency of the audio output. Like AddStageTime, this doesn't lock, as it
+    /// is called from audio callbacks.
+    void SetAudioLatency(std::chrono::microseconds latency);
+
+    /// Counts a time the audio output ran out of samples, without locking
+    void AddAudioUnderrun();
+
+    /// Adds to a counter of the current system frame. Like AddStageTime, this doesn't lock.
+    void AddCounter(PerfCounter counter, u64 value = 1);
+
+    /// Returns the most recent system frames, oldest first
+    std::vector<FrameRecord> GetFrameHistory();
+
+    /// Returns the number of system frames since emulation started, never reset
+    u64 GetTotalSystemFrames();
+
+    /// Returns the number of times each stage was timed since emulation started, never reset
+    std::array<u64, NumPerfStages> GetTotalStageCalls() const;
+
     /**
      * Gets the ratio between walltime and the emulated time of the previous system frame. This is
      * useful for scaling inputs or outputs moving between the two time domains.
@@ -44,8 +137,10 @@ public:
 private:
     std::mutex object_mutex;
 
+    /// Point the frame records are timed from
+    const Clock::time_point creation_point = Clock::now();
     /// Point when the cumulative counters were reset
-    Clock::time_point reset_point = Clock::now();
+    Clock::time_point reset_point = creation_point;
     /// System time when the cumulative counters were reset
     std::chrono::microseconds reset_point_system_us{0};
 
@@ -62,22 +157,88 @@ private:
     Clock::time_point frame_begin = reset_point;
     /// Total visible duration (including frame-limiting, etc.) of the previous system frame
     Clock::duration previous_frame_length = Clock::duration::zero();
+    /// Visible duration of every system frame since last reset
+    std::vector<Clock::duration> frame_lengths;
+
+    /// Maximum number of frames kept in the history, a minute of frames at 60 FPS
+    static constexpr std::size_t MAX_FRAME_HISTORY = 3600;
+
+    /// Nanoseconds spent in each stage during the current system frame
+    std::array<std::atomic<s64>, NumPerfStages> current_stage_times{};
+    /// Number of times each stage was timed during the current system frame
+    std::array<std::atomic<u32>, NumPerfStages> current_stage_calls{};
+    /// Number of times each stage was timed since emulation started
+    std::array<std::atomic<u64>, NumPerfStages> total_stage_calls{};
+    /// Value of each counter during the current system frame
+    std::array<std::atomic<u64>, NumPerfCounters> current_counters{};
+    /// Number of system frames since emulation started
+    u64 total_system_frames = 0;
+    /// Cumulative time spent in each stage since last reset
+    PerfStageTimes accumulated_stage_times{};
+    /// The most recent system frames, oldest first
+    std::deque<FrameRecord> frame_history;
+
+    /// Latest latency of the audio output, in microseconds
+    std::atomic<s64> audio_latency_us{0};
+    /// Number of audio output underruns since last reset
+    std::atomic<u32> audio_underruns{0};
 };
 
+/// Adds the time spent in its scope to a stage of the current system frame
+class ScopedStageTimer final {
+public:
+    ScopedStageTimer(PerfStats& perf_stats, PerfStage stage)
+        : perf_stats{perf_stats}, stage{stage}, start{PerfStats::Clock::now()} {}
+
+    ~ScopedStageTimer() {
+        perf_stats.AddStageTime(stage, PerfStats::Clock::now() - start);
+    }
+
+    ScopedStageTimer(const ScopedStageTimer&) = delete;
+    ScopedStageTimer& operator=(const ScopedStageTimer&) = delete;
+
+private:
+    PerfStats& perf_stats;
+    PerfStage stage;
+    PerfStats::Clock::time_point start;
+};
+
+/// Formats frame records as a CSV table with a header row, with times in milliseconds
+std::string FormatFrameHistoryCSV(const std::vector<FrameRecord>& frames);
+
+/**
+ * Formats frame records in the Chrome trace event format, which Perfetto and chrome://tracing
+ * load. Each frame is a slice, with the stage times and counters of the frame as counter tracks.
+ */
+std::string FormatFrameHistoryTrace(const std::vector<FrameRecord>& frames);
+
+/**
+ * Paces frames so that emulated time advances at Settings::values.frame_limit percent of walltime.
+ * Each frame is given a deadline that follows from the previous one, rather than from the time the
+ * previous wait ended, so oversleeping doesn't accumulate from frame to frame.
+ */
 class FrameLimiter {
 public:
     using Clock = std::chrono::high_resolution_clock;
 
+    FrameLimiter();
+    ~FrameLimiter();
+
     void DoFrameLimiting(std::chrono::microseconds current_system_time_us);
 
 private:
+    /// Waits until the given point, sleeping for most of the wait and spinning for the rest of it
+    void WaitUntil(Clock::time_point deadline) const;
+
     /// Emulated system time (in microseconds) at the last limiter invocation
     std::chrono::microseconds previous_system_time_us{0};
-    /// Walltime at the last limiter invocation
-    Clock::time_point previous_walltime = Clock::now();
+    /// Walltime at which the last frame was due to end
+    Clock::time_point frame_deadline = Clock::now();
 
-    /// Accumulated difference between walltime and emulated time
-    std::chrono::microseconds frame_limiting_delta_err{0};
+#ifdef _WIN32
+    /// High resolution waitable timer, null when the system doesn't support them
+    void* wait_timer = nullptr;
+#endif
 };
 
 } // namespace Core
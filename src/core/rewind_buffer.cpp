@@ -0,0 +1,77 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include "core/rewind_buffer.h"
+#include "core/savestate.h"
+
+namespace Core {
+
+namespace {
+
+/// Returns the size of the pages of the state which aren't shared with the previous one
+std::size_t GetDeltaSize(const SaveState& previous, const SaveState& state) {
+    std::size_t num_changed = 0;
+    for (const auto& block : state.memory_blocks) {
+        const auto previous_block =
+            std::find_if(previous.memory_blocks.begin(), previous.memory_blocks.end(),
+                         [&block](const auto& other) { return other.base == block.base; });
+        if (previous_block == previous.memory_blocks.end()) {
+            num_changed += block.pages.size();
+            continue;
+        }
+        const std::size_t num_common = std::min(block.pages.size(), previous_block->pages.size());
+        num_changed += block.pages.size() - num_common;
+        for (std::size_t page = 0; page < num_common; ++page) {
+            num_changed += block.pages[page] != previous_block->pages[page] ? 1 : 0;
+        }
+    }
+    return num_changed * Memory::PAGE_SIZE;
+}
+
+} // Anonymous namespace
+
+RewindBuffer::RewindBuffer(std::size_t memory_budget) : memory_budget{memory_budget} {}
+
+RewindBuffer::~RewindBuffer() = default;
+
+void RewindBuffer::Push(std::shared_ptr<const SaveState> state) {
+    const std::size_t delta_size =
+        entries.empty() ? 0 : GetDeltaSize(*entries.back().state, *state);
+    entries.push_back({std::move(state), delta_size});
+    memory_usage += delta_size;
+    Evict();
+}
+
+std::shared_ptr<const SaveState> RewindBuffer::Pop() {
+    if (entries.empty()) {
+        return nullptr;
+    }
+    auto state = std::move(entries.back().state);
+    memory_usage -= entries.back().delta_size;
+    entries.pop_back();
+    return state;
+}
+
+void RewindBuffer::Clear() {
+    entries.clear();
+    memory_usage = 0;
+}
+
+void RewindBuffer::SetMemoryBudget(std::size_t new_budget) {
+    memory_budget = new_budget;
+    Evict();
+}
+
+void RewindBuffer::Evict() {
+    // The pages of the oldest state which the next one doesn't share are the ones freed with it,
+    // and there are as many of them as in the delta of the next state
+    while (memory_usage > memory_budget && entries.size() > 1) {
+        entries.pop_front();
+        memory_usage -= entries.front().delta_size;
+        entries.front().delta_size = 0;
+    }
+}
+
+} // namespace Core
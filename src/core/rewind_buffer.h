@@ -0,0 +1,57 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+
+namespace Core {
+
+struct SaveState;
+
+/**
+ * Ring of the latest savestates, to step the emulation back in time. Consecutive states share the
+ * pages that didn't change between them, so each one costs about the pages written to in between.
+ * The oldest states are dropped once that cost goes over the memory budget.
+ */
+class RewindBuffer {
+public:
+    /// @param memory_budget Maximum number of bytes held by the states besides the oldest one
+    explicit RewindBuffer(std::size_t memory_budget);
+    ~RewindBuffer();
+
+    void Push(std::shared_ptr<const SaveState> state);
+
+    /// Removes the newest state and returns it, or nullptr if there is none
+    std::shared_ptr<const SaveState> Pop();
+
+    void Clear();
+
+    void SetMemoryBudget(std::size_t memory_budget);
+
+    std::size_t GetSize() const {
+        return entries.size();
+    }
+
+    std::size_t GetMemoryUsage() const {
+        return memory_usage;
+    }
+
+private:
+    struct Entry {
+        std::shared_ptr<const SaveState> state;
+        /// Size of the pages which differ from the previous state
+        std::size_t delta_size;
+    };
+
+    void Evict();
+
+    std::deque<Entry> entries;
+    std::size_t memory_budget;
+    std::size_t memory_usage = 0;
+};
+
+} // namespace Core
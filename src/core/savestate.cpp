@@ -0,0 +1,501 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <utility>
+#include <fmt/format.h>
+#include <lz4.h>
+#include "common/assert.h"
+#include "common/common_funcs.h"
+#include "common/common_paths.h"
+#include "common/dirty_page_tracker.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/swap.h"
+#include "common/thread_pool.h"
+#include "core/core.h"
+#include "core/core_cpu.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/kernel/scheduler.h"
+#include "core/hle/kernel/thread.h"
+#include "core/hle/kernel/vm_manager.h"
+#include "core/hle/lock.h"
+#include "core/savestate.h"
+#include "core/settings.h"
+
+namespace Core {
+
+namespace {
+
+constexpr u32 SAVESTATE_MAGIC = Common::MakeMagic('Y', 'Z', 'S', 'T');
+constexpr u32 SAVESTATE_VERSION = 1;
+
+struct FileHeader {
+    u32_le magic;
+    u32_le version;
+    u64_le title_id;
+    u64_le ticks;
+    u32_le num_threads;
+    u32_le num_memory_blocks;
+};
+static_assert(sizeof(FileHeader) == 32, "FileHeader has incorrect size.");
+
+struct BlockHeader {
+    u64_le base;
+    u64_le size;
+};
+static_assert(sizeof(BlockHeader) == 16, "BlockHeader has incorrect size.");
+
+/// Page sizes in the file that mark pages stored as they are, or pages full of zeros
+constexpr u32 RAW_PAGE_SIZE = static_cast<u32>(Memory::PAGE_SIZE);
+constexpr u32 ZERO_PAGE_SIZE = 0;
+
+/// Minimum number of pages copied by a thread at once
+constexpr std::size_t PAGES_PER_CHUNK = 64;
+
+using Page = SaveState::Page;
+
+/// Shared by all the pages full of zeros, which most of the heap is until the game uses it
+const std::shared_ptr<const Page>& GetZeroPage() {
+    static const std::shared_ptr<const Page> zero_page = std::make_shared<Page>();
+    return zero_page;
+}
+
+std::size_t GetPageCount(std::size_t size) {
+    return (size + Memory::PAGE_SIZE - 1) / Memory::PAGE_SIZE;
+}
+
+std::shared_ptr<const Page> CopyPage(const u8* data, std::size_t size) {
+    const auto& zero_page = GetZeroPage();
+    if (std::memcmp(data, zero_page->data(), size) == 0) {
+        return zero_page;
+    }
+    auto page = std::make_shared<Page>();
+    std::memcpy(page->data(), data, size);
+    return page;
+}
+
+/// Returns whether the block was reallocated, its tracker is then watching freed memory
+bool WasReallocated(const Common::DirtyPageTracker& tracker,
+                    const Common::DemandZeroBuffer& block) {
+    return tracker.GetBase() != block.data() || tracker.GetSize() != block.size();
+}
+
+bool WriteStateFile(const SaveState& state, const std::string& path) {
+    FileUtil::CreateFullPath(path);
+    FileUtil::IOFile file(path, "wb");
+    if (!file.IsOpen()) {
+        LOG_ERROR(Core, "Failed to create savestate file {}", path);
+        return false;
+    }
+
+    FileHeader header{};
+    header.magic = SAVESTATE_MAGIC;
+    header.version = SAVESTATE_VERSION;
+    header.title_id = state.title_id;
+    header.ticks = state.ticks;
+    header.num_threads = static_cast<u32>(state.threads.size());
+    header.num_memory_blocks = static_cast<u32>(state.memory_blocks.size());
+    bool success = file.WriteObject(header) == 1;
+
+    for (const auto& thread : state.threads) {
+        success &= file.WriteObject(thread.thread_id) == 1;
+        success &= file.WriteObject(thread.context) == 1;
+    }
+
+    std::vector<char> compressed(LZ4_compressBound(RAW_PAGE_SIZE));
+    for (const auto& block : state.memory_blocks) {
+        success &= file.WriteObject(BlockHeader{block.base, block.size}) == 1;
+        for (const auto& page : block.pages) {
+            if (page == GetZeroPage()) {
+                success &= file.WriteObject(ZERO_PAGE_SIZE) == 1;
+                continue;
+            }
+            const auto source = reinterpret_cast<const char*>(page->data());
+            const int compressed_size = LZ4_compress_default(
+                source, compressed.data(), RAW_PAGE_SIZE, static_cast<int>(compressed.size()));
+            if (compressed_size <= 0 || static_cast<u32>(compressed_size) >= RAW_PAGE_SIZE) {
+                success &= file.WriteObject(RAW_PAGE_SIZE) == 1;
+                success &= file.WriteBytes(source, RAW_PAGE_SIZE) == RAW_PAGE_SIZE;
+                continue;
+            }
+            success &= file.WriteObject(static_cast<u32>(compressed_size)) == 1;
+            success &= file.WriteBytes(compressed.data(), compressed_size) ==
+                       static_cast<std::size_t>(compressed_size);
+        }
+    }
+
+    if (!success) {
+        LOG_ERROR(Core, "Failed to write savestate file {}", path);
+    }
+    return success;
+}
+
+} // Anonymous namespace
+
+SaveStateManager::SaveStateManager() : rewind_buffer{0} {}
+
+SaveStateManager::~SaveStateManager() {
+    Reset();
+}
+
+std::shared_ptr<const SaveState> SaveStateManager::Capture() {
+    std::lock_guard<std::recursive_mutex> lock(HLE::g_hle_lock);
+    auto& system = System::GetInstance();
+
+    // Surfaces only written to by the GPU have to reach guest memory first
+    Memory::RasterizerFlushVirtualRegion(Memory::PROCESS_IMAGE_VADDR,
+                                         Memory::PROCESS_IMAGE_VADDR_END -
+                                             Memory::PROCESS_IMAGE_VADDR,
+                                         Memory::FlushMode::Flush);
+    Memory::RasterizerFlushVirtualRegion(Memory::HEAP_VADDR,
+                                         Memory::HEAP_VADDR_END - Memory::HEAP_VADDR,
+                                         Memory::FlushMode::Flush);
+
+    auto state = std::make_shared<SaveState>();
+    state->title_id = system.CurrentProcess()->program_id;
+    state->ticks = CoreTiming::GetTicks();
+
+    UpdateTrackedBlocks();
+    for (auto& [base, tracked] : tracked_blocks) {
+        UpdatePages(tracked);
+        state->memory_blocks.push_back({base, tracked.block->size(), tracked.pages});
+    }
+
+    for (std::size_t core = 0; core < NUM_CPU_CORES; ++core) {
+        const auto& scheduler = system.Scheduler(core);
+        for (const auto& thread : scheduler->GetThreadList()) {
+            ARM_Interface::ThreadContext context = thread->context;
+            // The context of the running thread is only up to date in the CPU core
+            if (thread.get() == scheduler->GetCurrentThread()) {
+                system.ArmInterface(core).SaveContext(context);
+            }
+            state->threads.push_back({thread->GetThreadId(), context});
+        }
+    }
+    return state;
+}
+
+bool SaveStateManager::Restore(const SaveState& state) {
+    std::lock_guard<std::recursive_mutex> lock(HLE::g_hle_lock);
+    auto& system = System::GetInstance();
+
+    if (state.title_id != system.CurrentProcess()->program_id) {
+        LOG_ERROR(Core, "Savestate of title {:016X} can't be restored in title {:016X}",
+                  state.title_id, system.CurrentProcess()->program_id);
+        return false;
+    }
+
+    UpdateTrackedBlocks();
+    for (const auto& saved : state.memory_blocks) {
+        const auto iter = tracked_blocks.find(saved.base);
+        if (iter == tracked_blocks.end() || iter->second.block->size() != saved.size) {
+            LOG_ERROR(Core, "Memory block at {:016X} was remapped since the savestate was taken",
+                      saved.base);
+            return false;
+        }
+    }
+
+    for (const auto& saved : state.memory_blocks) {
+        auto& tracked = tracked_blocks.at(saved.base);
+        UpdatePages(tracked);
+
+        // The pages the tracker shares with the state are the ones that weren't written to
+        u8* const data = tracked.block->data();
+        Common::ThreadPool::GetInstance().ParallelFor(
+            0, saved.pages.size(),
+            [&](std::size_t page) {
+                if (tracked.pages[page] == saved.pages[page]) {
+                    return;
+                }
+                const std::size_t offset = page * Memory::PAGE_SIZE;
+                const std::size_t size =
+                    std::min<std::size_t>(Memory::PAGE_SIZE, saved.size - offset);
+                std::memcpy(data + offset, saved.pages[page]->data(), size);
+                tracked.pages[page] = saved.pages[page];
+            },
+            PAGES_PER_CHUNK);
+
+        // Memory now matches the pages, so the writes done above aren't changes
+        tracked.tracker->CollectDirtyRanges();
+    }
+
+    std::unordered_map<u32, const ARM_Interface::ThreadContext*> contexts;
+    for (const auto& thread : state.threads) {
+        contexts.emplace(thread.thread_id, &thread.context);
+    }
+    for (std::size_t core = 0; core < NUM_CPU_CORES; ++core) {
+        const auto& scheduler = system.Scheduler(core);
+        for (const auto& thread : scheduler->GetThreadList()) {
+            const auto context = contexts.find(thread->GetThreadId());
+            if (context == contexts.end()) {
+                LOG_WARNING(Core, "Thread {} was created after the savestate was taken",
+                            thread->GetThreadId());
+                continue;
+            }
+            thread->context = *context->second;
+            if (thread.get() == scheduler->GetCurrentThread()) {
+                system.ArmInterface(core).LoadContext(thread->context);
+            }
+        }
+    }
+
+    // Code and GPU resources may have been restored to older contents
+    system.InvalidateCpuInstructionCaches();
+    Memory::RasterizerFlushVirtualRegion(Memory::PROCESS_IMAGE_VADDR,
+                                         Memory::PROCESS_IMAGE_VADDR_END -
+                                             Memory::PROCESS_IMAGE_VADDR,
+                                         Memory::FlushMode::Invalidate);
+    Memory::RasterizerFlushVirtualRegion(Memory::HEAP_VADDR,
+                                         Memory::HEAP_VADDR_END - Memory::HEAP_VADDR,
+                                         Memory::FlushMode::Invalidate);
+
+    CoreTiming::RestoreTicks(state.ticks);
+    return true;
+}
+
+std::future<bool> SaveStateManager::SaveToFile(std::shared_ptr<const SaveState> state,
+                                               std::string path) const {
+    // The pages are immutable, so the state can be compressed while the emulation goes on
+    return std::async(std::launch::async, [state = std::move(state), path = std::move(path)] {
+        return WriteStateFile(*state, path);
+    });
+}
+
+std::shared_ptr<const SaveState> SaveStateManager::LoadFromFile(const std::string& path) {
+    FileUtil::IOFile file(path, "rb");
+    if (!file.IsOpen()) {
+        LOG_ERROR(Core, "Failed to open savestate file {}", path);
+        return nullptr;
+    }
+
+    FileHeader header{};
+    if (file.ReadBytes(&header, sizeof(header)) != sizeof(header) ||
+        header.magic != SAVESTATE_MAGIC || header.version != SAVESTATE_VERSION) {
+        LOG_ERROR(Core, "{} is not a savestate of this version", path);
+        return nullptr;
+    }
+
+    auto state = std::make_shared<SaveState>();
+    state->title_id = header.title_id;
+    state->ticks = header.ticks;
+
+    bool success = true;
+    state->threads.resize(header.num_threads);
+    for (auto& thread : state->threads) {
+        success &= file.ReadBytes(&thread.thread_id, sizeof(thread.thread_id)) ==
+                   sizeof(thread.thread_id);
+        success &=
+            file.ReadBytes(&thread.context, sizeof(thread.context)) == sizeof(thread.context);
+    }
+
+    std::vector<char> compressed(RAW_PAGE_SIZE);
+    state->memory_blocks.resize(header.num_memory_blocks);
+    for (auto& block : state->memory_blocks) {
+        BlockHeader block_header{};
+        success &= file.ReadBytes(&block_header, sizeof(block_header)) == sizeof(block_header);
+        if (!success) {
+            break;
+        }
+        block.base = block_header.base;
+        block.size = block_header.size;
+        block.pages.resize(GetPageCount(block.size));
+
+        for (auto& page : block.pages) {
+            u32 page_size = 0;
+            success &= file.ReadBytes(&page_size, sizeof(page_size)) == sizeof(page_size);
+            if (!success || page_size > RAW_PAGE_SIZE) {
+                success = false;
+                break;
+            }
+            if (page_size == ZERO_PAGE_SIZE) {
+                page = GetZeroPage();
+                continue;
+            }
+
+            auto data = std::make_shared<Page>();
+            auto destination = reinterpret_cast<char*>(data->data());
+            if (page_size == RAW_PAGE_SIZE) {
+                success &= file.ReadBytes(destination, RAW_PAGE_SIZE) == RAW_PAGE_SIZE;
+            } else {
+                success &= file.ReadBytes(compressed.data(), page_size) == page_size;
+                success &= LZ4_decompress_safe(compressed.data(), destination, page_size,
+                                               RAW_PAGE_SIZE) == static_cast<int>(RAW_PAGE_SIZE);
+            }
+            page = std::move(data);
+        }
+    }
+
+    if (!success) {
+        LOG_ERROR(Core, "Savestate file {} is truncated or corrupted", path);
+        return nullptr;
+    }
+    return state;
+}
+
+void SaveStateManager::RequestSave() {
+    std::lock_guard<std::mutex> lock(request_mutex);
+    save_requested = true;
+}
+
+void SaveStateManager::RequestLoad() {
+    std::lock_guard<std::mutex> lock(request_mutex);
+    load_requested = true;
+}
+
+void SaveStateManager::RequestRewind() {
+    std::lock_guard<std::mutex> lock(request_mutex);
+    rewind_requested = true;
+}
+
+void SaveStateManager::NotifyFrame() {
+    ++frames_since_snapshot;
+}
+
+void SaveStateManager::ProcessRequests() {
+    bool save;
+    bool load;
+    bool rewind;
+    {
+        std::lock_guard<std::mutex> lock(request_mutex);
+        save = std::exchange(save_requested, false);
+        load = std::exchange(load_requested, false);
+        rewind = std::exchange(rewind_requested, false);
+    }
+    const u32 rewind_interval = Settings::values.rewind_interval;
+    const bool snapshot_due = rewind_interval != 0 && frames_since_snapshot >= rewind_interval;
+    if (!save && !load && !rewind && !snapshot_due) {
+        return;
+    }
+
+    // The other cores run their slices on their own threads, so their state is never settled
+    if (Settings::values.use_multi_core) {
+        if (save || load || rewind) {
+            LOG_ERROR(Core, "Savestates are not supported with multicore CPU emulation");
+        }
+        return;
+    }
+
+    if (save) {
+        quick_save = Capture();
+        // Waits for the previous write to the file to finish first
+        pending_write = SaveToFile(quick_save, GetQuickSavePath());
+        LOG_INFO(Core, "Saved state");
+    }
+    if (load) {
+        if (quick_save == nullptr) {
+            quick_save = LoadFromFile(GetQuickSavePath());
+        }
+        if (quick_save != nullptr && Restore(*quick_save)) {
+            LOG_INFO(Core, "Loaded state");
+        }
+    }
+    if (rewind) {
+        frames_since_snapshot = 0;
+        const auto state = rewind_buffer.Pop();
+        if (state == nullptr || !Restore(*state)) {
+            LOG_WARNING(Core, "Nothing to rewind to");
+        }
+    } else if (snapshot_due) {
+        frames_since_snapshot = 0;
+        rewind_buffer.SetMemoryBudget(Settings::values.rewind_memory_budget * 0x100000ULL);
+        rewind_buffer.Push(Capture());
+    }
+}
+
+void SaveStateManager::Reset() {
+    if (pending_write.valid()) {
+        pending_write.wait();
+    }
+    pending_write = {};
+    quick_save.reset();
+    rewind_buffer.Clear();
+    frames_since_snapshot = 0;
+
+    for (auto& [base, tracked] : tracked_blocks) {
+        if (WasReallocated(*tracked.tracker, *tracked.block)) {
+            tracked.tracker->Abandon();
+        }
+    }
+    tracked_blocks.clear();
+}
+
+void SaveStateManager::UpdatePages(TrackedBlock& tracked) {
+    const u8* const data = tracked.block->data();
+    const std::size_t block_size = tracked.block->size();
+
+    std::vector<std::size_t> dirty_pages;
+    for (const auto& [offset, size] : tracked.tracker->CollectDirtyRanges()) {
+        const std::size_t first_page = offset / Memory::PAGE_SIZE;
+        const std::size_t end_page = GetPageCount(offset + size);
+        for (std::size_t page = first_page; page < end_page; ++page) {
+            // Host pages smaller than guest pages report the same page several times
+            if (dirty_pages.empty() || dirty_pages.back() != page) {
+                dirty_pages.push_back(page);
+            }
+        }
+    }
+
+    Common::ThreadPool::GetInstance().ParallelFor(
+        0, dirty_pages.size(),
+        [&](std::size_t index) {
+            const std::size_t offset = dirty_pages[index] * Memory::PAGE_SIZE;
+            const std::size_t size = std::min<std::size_t>(Memory::PAGE_SIZE, block_size - offset);
+            tracked.pages[dirty_pages[index]] = CopyPage(data + offset, size);
+        },
+        PAGES_PER_CHUNK);
+}
+
+void SaveStateManager::UpdateTrackedBlocks() {
+    // A block may be mapped several times, it is identified by the lowest address
+    using BlockPointer = std::shared_ptr<Common::DemandZeroBuffer>;
+    std::unordered_map<Common::DemandZeroBuffer*, std::pair<VAddr, BlockPointer>> blocks;
+    for (const auto& [address, vma] : System::GetInstance().CurrentProcess()->vm_manager.vma_map) {
+        if (vma.type != Kernel::VMAType::AllocatedMemoryBlock) {
+            continue;
+        }
+        const VAddr base = vma.base - vma.offset;
+        const auto [iter, is_new] =
+            blocks.emplace(vma.backing_block.get(), std::make_pair(base, vma.backing_block));
+        if (!is_new) {
+            iter->second.first = std::min(iter->second.first, base);
+        }
+    }
+
+    std::map<VAddr, TrackedBlock> previous_blocks = std::move(tracked_blocks);
+    tracked_blocks.clear();
+    for (auto& [pointer, mapping] : blocks) {
+        auto& [base, block] = mapping;
+        const auto previous = previous_blocks.find(base);
+        if (previous != previous_blocks.end() && previous->second.block == block &&
+            !WasReallocated(*previous->second.tracker, *block)) {
+            tracked_blocks.emplace(base, std::move(previous->second));
+            previous_blocks.erase(previous);
+            continue;
+        }
+        TrackedBlock tracked;
+        tracked.tracker = std::make_unique<Common::DirtyPageTracker>(block->data(), block->size());
+        tracked.pages.resize(GetPageCount(block->size()));
+        tracked.block = std::move(block);
+        tracked_blocks.emplace(base, std::move(tracked));
+    }
+
+    // The blocks left were unmapped or reallocated, the latter are already freed
+    for (auto& [base, tracked] : previous_blocks) {
+        if (WasReallocated(*tracked.tracker, *tracked.block)) {
+            tracked.tracker->Abandon();
+        }
+    }
+}
+
+std::string SaveStateManager::GetQuickSavePath() const {
+    return fmt::format("{}states" DIR_SEP "{:016X}.state",
+                       FileUtil::GetUserPath(FileUtil::UserPath::CacheDir),
+                       System::GetInstance().CurrentProcess()->program_id);
+}
+
+} // namespace Core
@@ -0,0 +1,134 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+#include "common/memory_util.h"
+#include "core/arm/arm_interface.h"
+#include "core/memory.h"
+#include "core/rewind_buffer.h"
+
+namespace Common {
+class DirtyPageTracker;
+}
+
+namespace Core {
+
+/**
+ * Snapshot of the emulated system. The pages of guest memory are immutable and shared with the
+ * snapshots taken before and after it, so each snapshot only owns the pages that changed.
+ */
+struct SaveState {
+    using Page = std::array<u8, Memory::PAGE_SIZE>;
+
+    /// Contents of a memory block backing guest memory
+    struct MemoryBlock {
+        /// Address the start of the block would be mapped at, which identifies it
+        VAddr base;
+        std::size_t size;
+        std::vector<std::shared_ptr<const Page>> pages;
+    };
+
+    struct ThreadState {
+        u32 thread_id;
+        ARM_Interface::ThreadContext context;
+    };
+
+    u64 title_id = 0;
+    u64 ticks = 0;
+    std::vector<ThreadState> threads;
+    std::vector<MemoryBlock> memory_blocks;
+};
+
+/**
+ * Captures and restores savestates of the running process: guest memory, the CPU context of its
+ * threads and the CoreTiming clock. It also feeds the rewind buffer.
+ *
+ * Kernel objects and the state of the HLE services aren't captured, so a savestate can only be
+ * restored in the emulation session it was taken in, while the process still has the same
+ * threads and memory layout.
+ */
+class SaveStateManager {
+public:
+    SaveStateManager();
+    ~SaveStateManager();
+
+    /**
+     * Captures the current state, only copying the pages written to since the previous capture.
+     * Must be called from the emulation thread while the CPU cores aren't running.
+     */
+    std::shared_ptr<const SaveState> Capture();
+
+    /**
+     * Restores a state captured in this session, only copying the pages which differ from the
+     * current memory. Must be called from the emulation thread while the CPU cores aren't running.
+     * @returns Whether the state could be restored.
+     */
+    bool Restore(const SaveState& state);
+
+    /// Writes the state to a file, compressing it on a worker thread
+    std::future<bool> SaveToFile(std::shared_ptr<const SaveState> state, std::string path) const;
+
+    /// Reads a state written by SaveToFile, returns nullptr on failure
+    static std::shared_ptr<const SaveState> LoadFromFile(const std::string& path);
+
+    /// Asks the emulation thread to capture the quick save slot and write it to disk
+    void RequestSave();
+
+    /// Asks the emulation thread to restore the quick save slot
+    void RequestLoad();
+
+    /// Asks the emulation thread to go back to the newest state of the rewind buffer
+    void RequestRewind();
+
+    /// Counts a presented frame, the rewind buffer captures a state every rewind_interval frames
+    void NotifyFrame();
+
+    /// Handles the pending requests, called by the emulation thread between runs of the CPU
+    void ProcessRequests();
+
+    /// Releases the tracked memory and the quick save slot, when the emulation session ends
+    void Reset();
+
+private:
+    /// Memory block of the process and the pages of its latest capture
+    struct TrackedBlock {
+        std::shared_ptr<Common::DemandZeroBuffer> block;
+        std::unique_ptr<Common::DirtyPageTracker> tracker;
+        std::vector<std::shared_ptr<const SaveState::Page>> pages;
+    };
+
+    /// Copies the pages written to since the previous capture of the block
+    void UpdatePages(TrackedBlock& tracked);
+
+    /// Starts tracking the blocks which were mapped, and stops tracking the ones which are gone
+    void UpdateTrackedBlocks();
+
+    std::string GetQuickSavePath() const;
+
+    /// Blocks by the address their start would be mapped at
+    std::map<VAddr, TrackedBlock> tracked_blocks;
+
+    std::mutex request_mutex;
+    bool save_requested = false;
+    bool load_requested = false;
+    bool rewind_requested = false;
+
+    RewindBuffer rewind_buffer;
+    std::atomic<u32> frames_since_snapshot{0};
+
+    std::shared_ptr<const SaveState> quick_save;
+    std::future<bool> pending_write;
+};
+
+} // namespace Core
@@ -8,6 +8,7 @@
 #include <atomic>
 #include <string>
 #include "common/common_types.h"
+#include "common/cpu_dispatch.h"
 
 namespace Settings {
 
@@ -110,6 +111,11 @@ static const std::array<const char*, NumAnalogs> mapping = {{
 }};
 } // namespace NativeAnalog
 
+enum class RendererBackend {
+    OpenGL = 0,
+    Null = 1,
+};
+
 struct Values {
     // System
     bool use_docked_mode;
@@ -126,6 +132,12 @@ struct Values {
     // Core
     bool use_cpu_jit;
     bool use_multi_core;
+    bool pin_emulation_threads;
+    bool use_host_timing;
+    bool use_hle_libc;
+    Common::SIMDLevel simd_level_limit;
+    u16 rewind_interval;
+    u32 rewind_memory_budget;
 
     // Data Storage
     bool use_virtual_sd;
@@ -133,10 +145,25 @@ struct Values {
     std::string sdmc_dir;
 
     // Renderer
+    RendererBackend renderer_backend;
+    bool skip_gpu_commands;
     float resolution_factor;
     bool use_frame_limit;
     u16 frame_limit;
     bool use_accurate_framebuffers;
+    bool use_disk_shader_cache;
+    bool use_asynchronous_shaders;
+    bool skip_draws_with_pending_shaders;
+    bool use_uber_shaders;
+    bool use_gpu_texture_decoding;
+    bool use_texture_deduplication;
+    bool use_deferred_cache_invalidation;
+    bool use_resident_vertex_buffers;
+    bool use_gpu_memory_aliasing;
+    bool use_draw_batching;
+    bool use_asynchronous_gpu_emulation;
+    bool use_frame_skip;
+    u32 texture_cache_budget;
 
     float bg_red;
     float bg_green;
@@ -149,12 +176,17 @@ struct Values {
     // Audio
     std::string sink_id;
     bool enable_audio_stretching;
+    u16 audio_latency;
+    int audio_stretch_quality;
     std::string audio_device_id;
     float volume;
 
     // Debugging
     bool use_gdbstub;
     u16 gdbstub_port;
+    bool profile_svcs;
+    bool record_memory_stats;
+    bool profile_guest;
 } extern values;
 
 void Apply();
@@ -2,9 +2,15 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 #include "common/assert.h"
 #include "common/common_types.h"
 #include "common/file_util.h"
+#include "common/thread.h"
 
 #include "core/core.h"
 #include "core/file_sys/control_metadata.h"
@@ -15,6 +21,91 @@
 
 namespace Core {
 
+namespace {
+
+/// How long exiting the emulator waits for the sessions which are still being submitted
+constexpr std::chrono::seconds SubmissionTimeout{3};
+
+/// A closed session, with the backend it's submitted through
+struct Submission {
+    std::unique_ptr<Telemetry::FieldCollection> fields;
+    std::unique_ptr<Telemetry::VisitorInterface> backend;
+};
+
+/**
+ * Serializes and submits the closed sessions on a thread of its own. The thread only runs while
+ * there are sessions to submit, and when the emulator exits it's abandoned if the submissions
+ * take longer than SubmissionTimeout.
+ */
+class SessionSubmitter final {
+public:
+    static SessionSubmitter& GetInstance() {
+        static SessionSubmitter instance;
+        return instance;
+    }
+
+    ~SessionSubmitter() {
+        if (!worker.joinable()) {
+            return;
+        }
+        std::unique_lock<std::mutex> lock{state->mutex};
+        const bool completed = state->worker_done.wait_for(
+            lock, SubmissionTimeout, [this] { return state->worker_stopped; });
+        lock.unlock();
+        // The state is shared with the worker, so it outlives the submitter if it's abandoned
+        if (completed) {
+            worker.join();
+        } else {
+            worker.detach();
+        }
+    }
+
+    void Submit(std::unique_ptr<Submission> submission) {
+        std::lock_guard<std::mutex> lock{state->mutex};
+        state->submissions.push_back(std::move(submission));
+        if (state->worker_stopped) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+            state->worker_stopped = false;
+            worker = std::thread{RunWorker, state};
+        }
+    }
+
+private:
+    struct State {
+        std::mutex mutex;
+        std::condition_variable worker_done;
+        std::deque<std::unique_ptr<Submission>> submissions;
+        bool worker_stopped = true;
+    };
+
+    static void RunWorker(std::shared_ptr<State> state) {
+        Common::SetCurrentThreadName("yuzu:Telemetry");
+
+        std::unique_lock<std::mutex> lock{state->mutex};
+        while (!state->submissions.empty()) {
+            std::unique_ptr<Submission> submission{std::move(state->submissions.front())};
+            state->submissions.pop_front();
+
+            lock.unlock();
+            submission->fields->Accept(*submission->backend);
+            submission->backend->Complete();
+            submission.reset();
+            lock.lock();
+        }
+
+        // The worker stops once it ran out of sessions, the next one starts it again
+        state->worker_stopped = true;
+        state->worker_done.notify_all();
+    }
+
+    std::shared_ptr<State> state = std::make_shared<State>();
+    std::thread worker;
+};
+
+} // Anonymous namespace
+
 static u64 GenerateTelemetryId() {
     u64 telemetry_id{};
     return telemetry_id;
@@ -113,19 +204,29 @@ TelemetrySession::TelemetrySession() {
              static_cast<u8>(System::GetInstance().GetAppLoader().GetFileType()));
 
     // Log application information
-    Telemetry::AppendBuildInfo(field_collection);
+    Telemetry::AppendBuildInfo(*field_collection);
 
     // Log user system information
-    Telemetry::AppendCPUInfo(field_collection);
-    Telemetry::AppendOSInfo(field_collection);
+    Telemetry::AppendCPUInfo(*field_collection);
+    Telemetry::AppendOSInfo(*field_collection);
 
     // Log user configuration information
     AddField(Telemetry::FieldType::UserConfig, "Audio_SinkId", Settings::values.sink_id);
     AddField(Telemetry::FieldType::UserConfig, "Audio_EnableAudioStretching",
              Settings::values.enable_audio_stretching);
+    AddField(Telemetry::FieldType::UserConfig, "Audio_Latency", Settings::values.audio_latency);
+    AddField(Telemetry::FieldType::UserConfig, "Audio_StretchQuality",
+             Settings::values.audio_stretch_quality);
     AddField(Telemetry::FieldType::UserConfig, "Core_UseCpuJit", Settings::values.use_cpu_jit);
     AddField(Telemetry::FieldType::UserConfig, "Core_UseMultiCore",
              Settings::values.use_multi_core);
+    AddField(Telemetry::FieldType::UserConfig, "Core_PinEmulationThreads",
+             Settings::values.pin_emulation_threads);
+    AddField(Telemetry::FieldType::UserConfig, "Core_UseHostTiming",
+             Settings::values.use_host_timing);
+    AddField(Telemetry::FieldType::UserConfig, "Core_UseHLELibc", Settings::values.use_hle_libc);
+    AddField(Telemetry::FieldType::UserConfig, "Core_SIMDLevelLimit",
+             static_cast<u32>(Settings::values.simd_level_limit));
     AddField(Telemetry::FieldType::UserConfig, "Renderer_ResolutionFactor",
              Settings::values.resolution_factor);
     AddField(Telemetry::FieldType::UserConfig, "Renderer_UseFrameLimit",
@@ -133,6 +234,32 @@ TelemetrySession::TelemetrySession() {
     AddField(Telemetry::FieldType::UserConfig, "Renderer_FrameLimit", Settings::values.frame_limit);
     AddField(Telemetry::FieldType::UserConfig, "Renderer_UseAccurateFramebuffers",
              Settings::values.use_accurate_framebuffers);
+    AddField(Telemetry::FieldType::UserConfig, "Renderer_UseDiskShaderCache",
+             Settings::values.use_disk_shader_cache);
+    AddField(Telemetry::FieldType::UserConfig, "Renderer_UseAsynchronousShaders",
+             Settings::values.use_asynchronous_shaders);
+    AddField(Telemetry::FieldType::UserConfig, "Renderer_UseGpuTextureDecoding",
+             Settings::values.use_gpu_texture_decoding);
+    AddField(Telemetry::FieldType::UserConfig, "Renderer_UseTextureDeduplication",
+             Settings::values.use_texture_deduplication);
+    AddField(Telemetry::FieldType::UserConfig, "Renderer_UseDeferredCacheInvalidation",
+             Settings::values.use_deferred_cache_invalidation);
+    AddField(Telemetry::FieldType::UserConfig, "Renderer_UseResidentVertexBuffers",
+             Settings::values.use_resident_vertex_buffers);
+    AddField(Telemetry::FieldType::UserConfig, "Renderer_UseGpuMemoryAliasing",
+             Settings::values.use_gpu_memory_aliasing);
+    AddField(Telemetry::FieldType::UserConfig, "Renderer_UseDrawBatching",
+             Settings::values.use_draw_batching);
+    AddField(Telemetry::FieldType::UserConfig, "Renderer_UseAsynchronousGpuEmulation",
+             Settings::values.use_asynchronous_gpu_emulation);
+    AddField(Telemetry::FieldType::UserConfig, "Renderer_UseFrameSkip",
+             Settings::values.use_frame_skip);
+    AddField(Telemetry::FieldType::UserConfig, "Renderer_Backend",
+             static_cast<u32>(Settings::values.renderer_backend));
+    AddField(Telemetry::FieldType::UserConfig, "Renderer_SkipGpuCommands",
+             Settings::values.skip_gpu_commands);
+    AddField(Telemetry::FieldType::UserConfig, "Renderer_TextureCacheBudget",
+             Settings::values.texture_cache_budget);
     AddField(Telemetry::FieldType::UserConfig, "System_UseDockedMode",
              Settings::values.use_docked_mode);
 }
@@ -145,11 +272,14 @@ TelemetrySession::~TelemetrySession() {
     AddField(Telemetry::FieldType::Session, "Shutdown_Time", shutdown_time);
 
     // Complete the session, submitting to web service if necessary
-    // This is just a placeholder to wrap up the session once the core completes and this is
-    // destroyed. This will be moved elsewhere once we are actually doing real I/O with the service.
-    field_collection.Accept(*backend);
-    backend->Complete();
-    backend = nullptr;
+    auto submission = std::make_unique<Submission>();
+    std::unique_ptr<Telemetry::FieldInterface> field;
+    while (pending_fields.Pop(field)) {
+        field_collection->AddField(std::move(field));
+    }
+    submission->fields = std::move(field_collection);
+    submission->backend = std::move(backend);
+    SessionSubmitter::GetInstance().Submit(std::move(submission));
 }
 
 } // namespace Core
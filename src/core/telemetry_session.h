@@ -7,13 +7,15 @@
 #include <future>
 #include <memory>
 #include "common/telemetry.h"
+#include "common/threadsafe_queue.h"
 
 namespace Core {
 
 /**
  * Instruments telemetry for this emulation session. Creates a new set of telemetry fields on each
  * session, logging any one-time fields. Interfaces with the telemetry backend used for submitting
- * data to the web service. Submits session data on close.
+ * data to the web service. Submits session data on close, on a background thread so that closing
+ * the session doesn't wait for the web service.
  */
 class TelemetrySession : NonCopyable {
 public:
@@ -21,18 +23,23 @@ public:
     ~TelemetrySession();
 
     /**
-     * Wrapper around the Telemetry::FieldCollection::AddField method.
+     * Records a field of the session, it can be called from any thread. Fields added later replace
+     * the ones with the same name.
      * @param type Type of the field to add.
      * @param name Name of the field to add.
      * @param value Value for the field to add.
      */
     template <typename T>
     void AddField(Telemetry::FieldType type, const char* name, T value) {
-        field_collection.AddField(type, name, std::move(value));
+        pending_fields.Push(std::make_unique<Telemetry::Field<T>>(type, name, std::move(value)));
     }
 
 private:
-    Telemetry::FieldCollection field_collection; ///< Tracks all added fields for the session
+    /// Tracks the fields added when the session started, and all of them once it's closed
+    std::unique_ptr<Telemetry::FieldCollection> field_collection =
+        std::make_unique<Telemetry::FieldCollection>();
+    /// Fields added during the session, only collected when it's submitted
+    Common::MPSCQueue<std::unique_ptr<Telemetry::FieldInterface>, false> pending_fields;
     std::unique_ptr<Telemetry::VisitorInterface> backend; ///< Backend interface that logs fields
 };
 
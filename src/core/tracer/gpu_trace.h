@@ -0,0 +1,61 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include "common/common_funcs.h"
+#include "common/common_types.h"
+
+/**
+ * A GPU trace is a capture of the command stream a title submitted to the GPU, along with the
+ * guest memory the stream depends on, which can be replayed without emulating the CPU.
+ *
+ * The file starts with a Header and is followed by a sequence of elements, each made of an
+ * ElementHeader and its payload. The payload of each element type is:
+ *
+ * - MappedRegions: the MappedRegion entries of the whole GPU address space, replacing the
+ *   previous ones.
+ * - MemoryUpdate: the guest address the data is written to, as a u64, followed by the data.
+ * - SubmitList: for each command list, its CommandListHeader followed by the words of the list.
+ * - SwapBuffers: a u32 that is non-zero when a framebuffer follows, then the FramebufferConfig.
+ *
+ * All values are stored in host byte order, traces are only meant to be replayed on the kind of
+ * machine that recorded them.
+ */
+namespace GPUTrace {
+
+struct Header {
+    std::array<char, 4> magic;
+    u32 version;
+
+    static constexpr std::array<char, 4> EXPECTED_MAGIC{{'Y', 'G', 'P', 'T'}};
+    static constexpr u32 EXPECTED_VERSION = 1;
+};
+static_assert(sizeof(Header) == 0x8, "Header has incorrect size");
+
+enum class ElementType : u32 {
+    MappedRegions = 0,
+    MemoryUpdate = 1,
+    SubmitList = 2,
+    SwapBuffers = 3,
+};
+
+struct ElementHeader {
+    ElementType type;
+    INSERT_PADDING_WORDS(1);
+    /// Size of the payload that follows, in bytes
+    u64 size;
+};
+static_assert(sizeof(ElementHeader) == 0x10, "ElementHeader has incorrect size");
+
+/// Mapping of a range of guest memory into the GPU address space
+struct MappedRegion {
+    VAddr cpu_addr;
+    u64 gpu_addr;
+    u64 size;
+};
+static_assert(sizeof(MappedRegion) == 0x18, "MappedRegion has incorrect size");
+
+} // namespace GPUTrace
@@ -0,0 +1,210 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include "common/alignment.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "core/core.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/kernel/vm_manager.h"
+#include "core/memory.h"
+#include "core/perf_stats.h"
+#include "core/tracer/player.h"
+#include "video_core/command_processor.h"
+#include "video_core/gpu.h"
+#include "video_core/memory_manager.h"
+
+namespace GPUTrace {
+namespace {
+bool Contains(const std::vector<MappedRegion>& regions, const MappedRegion& region) {
+    return std::any_of(regions.begin(), regions.end(), [&region](const MappedRegion& other) {
+        return other.cpu_addr == region.cpu_addr && other.gpu_addr == region.gpu_addr &&
+               other.size == region.size;
+    });
+}
+} // Anonymous namespace
+
+Player::Player(const std::string& filename) {
+    FileUtil::IOFile file(filename, "rb");
+    if (!file.IsOpen()) {
+        LOG_ERROR(HW_GPU, "Failed to open the GPU trace {}", filename);
+        return;
+    }
+
+    data.resize(file.GetSize());
+    if (file.ReadBytes(data.data(), data.size()) != data.size()) {
+        LOG_ERROR(HW_GPU, "Failed to read the GPU trace {}", filename);
+        return;
+    }
+
+    Header header;
+    if (data.size() < sizeof(header)) {
+        LOG_ERROR(HW_GPU, "GPU trace {} is too small", filename);
+        return;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != Header::EXPECTED_MAGIC || header.version != Header::EXPECTED_VERSION) {
+        LOG_ERROR(HW_GPU, "GPU trace {} has an unknown format", filename);
+        return;
+    }
+
+    offset = sizeof(header);
+    valid = true;
+}
+
+Player::~Player() = default;
+
+bool Player::IsValid() const {
+    return valid;
+}
+
+void Player::ReplayFrame(Tegra::GPU& gpu, Kernel::Process& process) {
+    if (!valid) {
+        return;
+    }
+
+    // A trace without any frame is replayed only once per call, so that this always returns
+    bool rewound = false;
+    while (true) {
+        ElementHeader header;
+        if (data.size() - offset < sizeof(header)) {
+            if (rewound) {
+                return;
+            }
+            offset = sizeof(Header);
+            rewound = true;
+            continue;
+        }
+        std::memcpy(&header, data.data() + offset, sizeof(header));
+        offset += sizeof(header);
+
+        if (header.size > data.size() - offset) {
+            LOG_ERROR(HW_GPU, "GPU trace is truncated, ignoring its last element");
+            offset = data.size();
+            continue;
+        }
+
+        const u8* const payload = data.data() + offset;
+        offset += header.size;
+        if (ReplayElement(header.type, payload, header.size, gpu, process)) {
+            return;
+        }
+    }
+}
+
+bool Player::ReplayElement(ElementType type, const u8* payload, std::size_t size, Tegra::GPU& gpu,
+                           Kernel::Process& process) {
+    switch (type) {
+    case ElementType::MappedRegions: {
+        std::vector<MappedRegion> regions(size / sizeof(MappedRegion));
+        std::memcpy(regions.data(), payload, regions.size() * sizeof(MappedRegion));
+        MapRegions(std::move(regions), gpu, process);
+        return false;
+    }
+    case ElementType::MemoryUpdate: {
+        VAddr addr;
+        if (size < sizeof(addr)) {
+            break;
+        }
+        std::memcpy(&addr, payload, sizeof(addr));
+        // Nothing makes the replay wait for the GPU like the guest did, so memory is only
+        // written once the commands that may still read it are done
+        gpu.WaitIdle();
+        Memory::WriteBlock(process, addr, payload + sizeof(addr), size - sizeof(addr));
+        return false;
+    }
+    case ElementType::SubmitList: {
+        // The command lists are written back to where they were read from, as they are usually
+        // rewritten by the guest within a frame
+        gpu.WaitIdle();
+        std::vector<Tegra::CommandListHeader> entries;
+        std::size_t position = 0;
+        while (size - position >= sizeof(Tegra::CommandListHeader)) {
+            Tegra::CommandListHeader entry;
+            std::memcpy(&entry, payload + position, sizeof(entry));
+            position += sizeof(entry);
+
+            const std::size_t list_size = std::min<std::size_t>(entry.sz * sizeof(u32),
+                                                                size - position);
+            if (const auto cpu_addr = gpu.MemoryManager().GpuToCpuAddress(entry.Address())) {
+                Memory::WriteBlock(process, *cpu_addr, payload + position, list_size);
+                entries.push_back(entry);
+            }
+            position += list_size;
+        }
+        gpu.PushGPUEntries(std::move(entries));
+        return false;
+    }
+    case ElementType::SwapBuffers: {
+        u32 has_framebuffer;
+        Tegra::FramebufferConfig framebuffer;
+        if (size < sizeof(has_framebuffer)) {
+            break;
+        }
+        std::memcpy(&has_framebuffer, payload, sizeof(has_framebuffer));
+        if (has_framebuffer && size < sizeof(has_framebuffer) + sizeof(framebuffer)) {
+            break;
+        }
+
+        Core::System::GetInstance().GetPerfStats().EndGameFrame();
+        if (has_framebuffer) {
+            std::memcpy(&framebuffer, payload + sizeof(has_framebuffer), sizeof(framebuffer));
+            gpu.SwapBuffers(framebuffer);
+        } else {
+            gpu.SwapBuffers({});
+        }
+        return true;
+    }
+    }
+
+    LOG_ERROR(HW_GPU, "Invalid GPU trace element type={} size={}", static_cast<u32>(type), size);
+    return false;
+}
+
+void Player::MapRegions(std::vector<MappedRegion> regions, Tegra::GPU& gpu,
+                        Kernel::Process& process) {
+    auto& memory_manager = gpu.MemoryManager();
+
+    for (const MappedRegion& region : mapped_regions) {
+        if (!Contains(regions, region)) {
+            memory_manager.UnmapBuffer(region.gpu_addr, region.size);
+        }
+    }
+
+    for (const MappedRegion& region : regions) {
+        if (Contains(mapped_regions, region)) {
+            continue;
+        }
+        AllocateMemory(Common::AlignDown(region.cpu_addr, Memory::PAGE_SIZE),
+                       Common::AlignUp(region.cpu_addr + region.size, Memory::PAGE_SIZE),
+                       process);
+        memory_manager.AllocateSpace(region.gpu_addr, region.size, 1);
+        memory_manager.MapBufferEx(region.cpu_addr, region.gpu_addr, region.size);
+    }
+
+    mapped_regions = std::move(regions);
+}
+
+void Player::AllocateMemory(VAddr start, VAddr end, Kernel::Process& process) {
+    boost::icl::interval_set<VAddr> missing_memory;
+    missing_memory.add(boost::icl::interval<VAddr>::right_open(start, end));
+    missing_memory -= allocated_memory;
+
+    for (const auto& interval : missing_memory) {
+        const u64 size = interval.upper() - interval.lower();
+        const auto result = process.vm_manager.MapMemoryBlock(
+            interval.lower(), std::make_shared<Common::DemandZeroBuffer>(size), 0, size,
+            Kernel::MemoryState::Heap);
+        if (result.Failed()) {
+            LOG_ERROR(HW_GPU, "Failed to allocate guest memory at 0x{:016X} size=0x{:X}",
+                      interval.lower(), size);
+        }
+    }
+    allocated_memory += missing_memory;
+}
+
+} // namespace GPUTrace
@@ -0,0 +1,62 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <boost/icl/interval_set.hpp>
+#include "common/common_types.h"
+#include "core/tracer/gpu_trace.h"
+
+namespace Kernel {
+class Process;
+}
+
+namespace Tegra {
+class GPU;
+}
+
+namespace GPUTrace {
+
+/**
+ * Replays a GPU trace into the GPU without emulating the CPU. The guest memory the trace refers
+ * to is allocated in the given process, which should be empty otherwise.
+ *
+ * The whole trace is loaded at once, so that replaying it doesn't depend on the speed of the disk,
+ * and it starts over once the end is reached, so it can be used as a steady benchmark.
+ */
+class Player {
+public:
+    /// Loads the trace file, check IsValid for errors
+    explicit Player(const std::string& filename);
+    ~Player();
+
+    /// Returns whether the trace could be loaded and is in a known format
+    bool IsValid() const;
+
+    /// Replays the trace up to and including the presentation of the next frame
+    void ReplayFrame(Tegra::GPU& gpu, Kernel::Process& process);
+
+private:
+    /// Replays a single element, returns true when it presented a frame
+    bool ReplayElement(ElementType type, const u8* payload, std::size_t size, Tegra::GPU& gpu,
+                       Kernel::Process& process);
+
+    /// Replaces the recorded GPU mappings, allocating the memory of the new ones
+    void MapRegions(std::vector<MappedRegion> regions, Tegra::GPU& gpu, Kernel::Process& process);
+
+    /// Allocates the guest memory in the given range that isn't allocated already
+    void AllocateMemory(VAddr start, VAddr end, Kernel::Process& process);
+
+    std::vector<u8> data;
+    /// Offset of the next element to replay
+    std::size_t offset = 0;
+    bool valid = false;
+
+    std::vector<MappedRegion> mapped_regions;
+    boost::icl::interval_set<VAddr> allocated_memory;
+};
+
+} // namespace GPUTrace
@@ -1,208 +1,178 @@
-// Copyright 2015 Citra Emulator Project
+// Copyright 2018 yuzu emulator team
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cstring>
-#include "common/assert.h"
-#include "common/file_util.h"
+#include "common/alignment.h"
+#include "common/cityhash.h"
 #include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "core/memory.h"
 #include "core/tracer/recorder.h"
+#include "video_core/command_processor.h"
+#include "video_core/gpu.h"
+#include "video_core/memory_manager.h"
 
-namespace CiTrace {
-
-Recorder::Recorder(const InitialState& initial_state) : initial_state(initial_state) {}
-
-void Recorder::Finish(const std::string& filename) {
-    // Setup CiTrace header
-    CTHeader header;
-    std::memcpy(header.magic, CTHeader::ExpectedMagicWord(), 4);
-    header.version = CTHeader::ExpectedVersion();
-    header.header_size = sizeof(CTHeader);
-
-    // Calculate file offsets
-    auto& initial = header.initial_state_offsets;
-
-    initial.gpu_registers_size = static_cast<u32>(initial_state.gpu_registers.size());
-    initial.lcd_registers_size = static_cast<u32>(initial_state.lcd_registers.size());
-    initial.pica_registers_size = static_cast<u32>(initial_state.pica_registers.size());
-    initial.default_attributes_size = static_cast<u32>(initial_state.default_attributes.size());
-    initial.vs_program_binary_size = static_cast<u32>(initial_state.vs_program_binary.size());
-    initial.vs_swizzle_data_size = static_cast<u32>(initial_state.vs_swizzle_data.size());
-    initial.vs_float_uniforms_size = static_cast<u32>(initial_state.vs_float_uniforms.size());
-    initial.gs_program_binary_size = static_cast<u32>(initial_state.gs_program_binary.size());
-    initial.gs_swizzle_data_size = static_cast<u32>(initial_state.gs_swizzle_data.size());
-    initial.gs_float_uniforms_size = static_cast<u32>(initial_state.gs_float_uniforms.size());
-    header.stream_size = static_cast<u32>(stream.size());
-
-    initial.gpu_registers = sizeof(header);
-    initial.lcd_registers = initial.gpu_registers + initial.gpu_registers_size * sizeof(u32);
-    initial.pica_registers = initial.lcd_registers + initial.lcd_registers_size * sizeof(u32);
-    ;
-    initial.default_attributes = initial.pica_registers + initial.pica_registers_size * sizeof(u32);
-    initial.vs_program_binary =
-        initial.default_attributes + initial.default_attributes_size * sizeof(u32);
-    initial.vs_swizzle_data =
-        initial.vs_program_binary + initial.vs_program_binary_size * sizeof(u32);
-    initial.vs_float_uniforms =
-        initial.vs_swizzle_data + initial.vs_swizzle_data_size * sizeof(u32);
-    initial.gs_program_binary =
-        initial.vs_float_uniforms + initial.vs_float_uniforms_size * sizeof(u32);
-    initial.gs_swizzle_data =
-        initial.gs_program_binary + initial.gs_program_binary_size * sizeof(u32);
-    initial.gs_float_uniforms =
-        initial.gs_swizzle_data + initial.gs_swizzle_data_size * sizeof(u32);
-    header.stream_offset = initial.gs_float_uniforms + initial.gs_float_uniforms_size * sizeof(u32);
-
-    // Iterate through stream elements, update relevant stream element data
-    for (auto& stream_element : stream) {
-        switch (stream_element.data.type) {
-        case MemoryLoad: {
-            auto& file_offset = memory_regions[stream_element.hash];
-            if (!stream_element.uses_existing_data) {
-                file_offset = header.stream_offset;
-            }
-            stream_element.data.memory_load.file_offset = file_offset;
-            break;
-        }
+namespace GPUTrace {
 
-        default:
-            // Other commands don't use any extra data
-            DEBUG_ASSERT(stream_element.extra_data.size() == 0);
-            break;
-        }
-        header.stream_offset += static_cast<u32>(stream_element.extra_data.size());
+Recorder::Recorder(const std::string& filename) : file(filename, "wb") {
+    if (!file.IsOpen()) {
+        LOG_ERROR(HW_GPU, "Failed to create the GPU trace {}", filename);
+        failed = true;
+        return;
     }
 
-    try {
-        // Open file and write header
-        FileUtil::IOFile file(filename, "wb");
-        std::size_t written = file.WriteObject(header);
-        if (written != 1 || file.Tell() != initial.gpu_registers)
-            throw "Failed to write header";
-
-        // Write initial state
-        written =
-            file.WriteArray(initial_state.gpu_registers.data(), initial_state.gpu_registers.size());
-        if (written != initial_state.gpu_registers.size() || file.Tell() != initial.lcd_registers)
-            throw "Failed to write GPU registers";
-
-        written =
-            file.WriteArray(initial_state.lcd_registers.data(), initial_state.lcd_registers.size());
-        if (written != initial_state.lcd_registers.size() || file.Tell() != initial.pica_registers)
-            throw "Failed to write LCD registers";
-
-        written = file.WriteArray(initial_state.pica_registers.data(),
-                                  initial_state.pica_registers.size());
-        if (written != initial_state.pica_registers.size() ||
-            file.Tell() != initial.default_attributes)
-            throw "Failed to write Pica registers";
-
-        written = file.WriteArray(initial_state.default_attributes.data(),
-                                  initial_state.default_attributes.size());
-        if (written != initial_state.default_attributes.size() ||
-            file.Tell() != initial.vs_program_binary)
-            throw "Failed to write default vertex attributes";
-
-        written = file.WriteArray(initial_state.vs_program_binary.data(),
-                                  initial_state.vs_program_binary.size());
-        if (written != initial_state.vs_program_binary.size() ||
-            file.Tell() != initial.vs_swizzle_data)
-            throw "Failed to write vertex shader program binary";
-
-        written = file.WriteArray(initial_state.vs_swizzle_data.data(),
-                                  initial_state.vs_swizzle_data.size());
-        if (written != initial_state.vs_swizzle_data.size() ||
-            file.Tell() != initial.vs_float_uniforms)
-            throw "Failed to write vertex shader swizzle data";
-
-        written = file.WriteArray(initial_state.vs_float_uniforms.data(),
-                                  initial_state.vs_float_uniforms.size());
-        if (written != initial_state.vs_float_uniforms.size() ||
-            file.Tell() != initial.gs_program_binary)
-            throw "Failed to write vertex shader float uniforms";
-
-        written = file.WriteArray(initial_state.gs_program_binary.data(),
-                                  initial_state.gs_program_binary.size());
-        if (written != initial_state.gs_program_binary.size() ||
-            file.Tell() != initial.gs_swizzle_data)
-            throw "Failed to write geomtry shader program binary";
-
-        written = file.WriteArray(initial_state.gs_swizzle_data.data(),
-                                  initial_state.gs_swizzle_data.size());
-        if (written != initial_state.gs_swizzle_data.size() ||
-            file.Tell() != initial.gs_float_uniforms)
-            throw "Failed to write geometry shader swizzle data";
-
-        written = file.WriteArray(initial_state.gs_float_uniforms.data(),
-                                  initial_state.gs_float_uniforms.size());
-        if (written != initial_state.gs_float_uniforms.size() ||
-            file.Tell() != initial.gs_float_uniforms + sizeof(u32) * initial.gs_float_uniforms_size)
-            throw "Failed to write geometry shader float uniforms";
-
-        // Iterate through stream elements, write "extra data"
-        for (const auto& stream_element : stream) {
-            if (stream_element.extra_data.size() == 0)
-                continue;
+    const Header header{Header::EXPECTED_MAGIC, Header::EXPECTED_VERSION};
+    Write(&header, sizeof(header));
+}
 
-            written =
-                file.WriteBytes(stream_element.extra_data.data(), stream_element.extra_data.size());
-            if (written != stream_element.extra_data.size())
-                throw "Failed to write extra data";
-        }
+Recorder::~Recorder() = default;
+
+bool Recorder::IsOpen() const {
+    return !failed;
+}
 
-        if (file.Tell() != header.stream_offset)
-            throw "Unexpected end of extra data";
+MICROPROFILE_DEFINE(GPUTrace_Record, "GPU", "Record GPU trace", MP_RGB(128, 64, 192));
+void Recorder::RecordSubmit(const Tegra::MemoryManager& memory_manager,
+                            const Tegra::CommandListHeader* entries, std::size_t count) {
+    MICROPROFILE_SCOPE(GPUTrace_Record);
+    std::lock_guard<std::mutex> lock{mutex};
+    if (failed) {
+        return;
+    }
 
-        // Write actual stream elements
-        for (const auto& stream_element : stream) {
-            if (1 != file.WriteObject(stream_element.data))
-                throw "Failed to write stream element";
+    SyncMappedRegions(memory_manager);
+    if (!memory_synced) {
+        SyncMemory();
+        memory_synced = true;
+    }
+
+    u64 payload_size = count * sizeof(Tegra::CommandListHeader);
+    for (std::size_t i = 0; i < count; ++i) {
+        payload_size += entries[i].sz * sizeof(u32);
+    }
+    WriteElementHeader(ElementType::SubmitList, payload_size);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        const Tegra::CommandListHeader& entry = entries[i];
+        Write(&entry, sizeof(entry));
+
+        // Lists that aren't mapped are still recorded with their size, so the trace stays valid
+        command_buffer.assign(entry.sz, 0);
+        const auto region = std::find_if(
+            mapped_regions.begin(), mapped_regions.end(), [&entry](const MappedRegion& mapped) {
+                return entry.Address() >= mapped.gpu_addr &&
+                       entry.Address() < mapped.gpu_addr + mapped.size;
+            });
+        if (region != mapped_regions.end()) {
+            Memory::ReadBlock(region->cpu_addr + (entry.Address() - region->gpu_addr),
+                              command_buffer.data(), command_buffer.size() * sizeof(u32));
+        } else {
+            LOG_ERROR(HW_GPU, "Recorded command list at unmapped address 0x{:X}",
+                      entry.Address());
         }
-    } catch (const char* str) {
-        LOG_ERROR(HW_GPU, "Writing CiTrace file failed: {}", str);
+        Write(command_buffer.data(), command_buffer.size() * sizeof(u32));
+    }
+}
+
+void Recorder::RecordSwapBuffers(boost::optional<const Tegra::FramebufferConfig&> framebuffer) {
+    std::lock_guard<std::mutex> lock{mutex};
+    if (failed) {
+        return;
+    }
+
+    const u32 has_framebuffer = framebuffer ? 1 : 0;
+    WriteElementHeader(ElementType::SwapBuffers,
+                       sizeof(has_framebuffer) + (framebuffer ? sizeof(*framebuffer) : 0));
+    Write(&has_framebuffer, sizeof(has_framebuffer));
+    if (framebuffer) {
+        Write(&*framebuffer, sizeof(*framebuffer));
     }
+
+    memory_synced = false;
 }
 
-void Recorder::FrameFinished() {
-    stream.push_back({{FrameMarker}});
+void Recorder::SyncMappedRegions(const Tegra::MemoryManager& memory_manager) {
+    const auto& regions = memory_manager.GetMappedRegions();
+    const bool unchanged = std::equal(
+        regions.begin(), regions.end(), mapped_regions.begin(), mapped_regions.end(),
+        [](const auto& lhs, const MappedRegion& rhs) {
+            return lhs.cpu_addr == rhs.cpu_addr && lhs.gpu_addr == rhs.gpu_addr &&
+                   lhs.size == rhs.size;
+        });
+    if (unchanged) {
+        return;
+    }
+
+    mapped_regions.clear();
+    for (const auto& region : regions) {
+        mapped_regions.push_back({region.cpu_addr, region.gpu_addr, region.size});
+    }
+    WriteElementHeader(ElementType::MappedRegions, mapped_regions.size() * sizeof(MappedRegion));
+    Write(mapped_regions.data(), mapped_regions.size() * sizeof(MappedRegion));
+
+    // Newly mapped memory has to be recorded before it's used
+    memory_synced = false;
 }
 
-void Recorder::MemoryAccessed(const u8* data, u32 size, u32 physical_address) {
-    StreamElement element = {{MemoryLoad}};
-    element.data.memory_load.size = size;
-    element.data.memory_load.physical_address = physical_address;
-
-    // Compute hash over given memory region to check if the contents are already stored internally
-    boost::crc_32_type result;
-    result.process_bytes(data, size);
-    element.hash = result.checksum();
-
-    element.uses_existing_data = (memory_regions.find(element.hash) != memory_regions.end());
-    if (!element.uses_existing_data) {
-        element.extra_data.resize(size);
-        memcpy(element.extra_data.data(), data, size);
-        memory_regions.insert({element.hash, 0}); // file offset will be initialized in Finish()
+void Recorder::SyncMemory() {
+    // Consecutive changed pages are recorded as a single update
+    VAddr run_start = 0;
+    const auto FlushRun = [this, &run_start] {
+        if (memory_buffer.empty()) {
+            return;
+        }
+        WriteElementHeader(ElementType::MemoryUpdate, sizeof(run_start) + memory_buffer.size());
+        Write(&run_start, sizeof(run_start));
+        Write(memory_buffer.data(), memory_buffer.size());
+        memory_buffer.clear();
+    };
+
+    for (const MappedRegion& region : mapped_regions) {
+        const VAddr start = Common::AlignDown(region.cpu_addr, Memory::PAGE_SIZE);
+        const VAddr end = Common::AlignUp(region.cpu_addr + region.size, Memory::PAGE_SIZE);
+        for (VAddr page = start; page < end; page += Memory::PAGE_SIZE) {
+            const u8* const pointer =
+                Memory::IsValidVirtualAddress(page) ? Memory::GetPointer(page) : nullptr;
+            if (pointer == nullptr) {
+                FlushRun();
+                continue;
+            }
+
+            const u64 hash = Common::CityHash64(reinterpret_cast<const char*>(pointer),
+                                                Memory::PAGE_SIZE);
+            const auto [iter, inserted] = page_hashes.emplace(page, hash);
+            if (!inserted && iter->second == hash) {
+                FlushRun();
+                continue;
+            }
+            iter->second = hash;
+
+            if (memory_buffer.empty()) {
+                run_start = page;
+            }
+            memory_buffer.insert(memory_buffer.end(), pointer, pointer + Memory::PAGE_SIZE);
+        }
+        FlushRun();
     }
+}
 
-    stream.push_back(element);
+void Recorder::WriteElementHeader(ElementType type, u64 size) {
+    ElementHeader header{};
+    header.type = type;
+    header.size = size;
+    Write(&header, sizeof(header));
 }
 
-template <typename T>
-void Recorder::RegisterWritten(u32 physical_address, T value) {
-    StreamElement element = {{RegisterWrite}};
-    element.data.register_write.size =
-        (sizeof(T) == 1) ? CTRegisterWrite::SIZE_8
-                         : (sizeof(T) == 2) ? CTRegisterWrite::SIZE_16
-                                            : (sizeof(T) == 4) ? CTRegisterWrite::SIZE_32
-                                                               : CTRegisterWrite::SIZE_64;
-    element.data.register_write.physical_address = physical_address;
-    element.data.register_write.value = value;
-
-    stream.push_back(element);
+void Recorder::Write(const void* data, std::size_t size) {
+    if (failed || size == 0) {
+        return;
+    }
+    if (file.WriteBytes(static_cast<const u8*>(data), size) != size) {
+        LOG_ERROR(HW_GPU, "Failed to write to the GPU trace, recording stopped");
+        failed = true;
+    }
 }
 
-template void Recorder::RegisterWritten(u32, u8);
-template void Recorder::RegisterWritten(u32, u16);
-template void Recorder::RegisterWritten(u32, u32);
-template void Recorder::RegisterWritten(u32, u64);
-} // namespace CiTrace
+} // namespace GPUTrace
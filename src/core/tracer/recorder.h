@@ -1,87 +1,77 @@
-// Copyright 2015 Citra Emulator Project
+// Copyright 2018 yuzu emulator team
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
 #pragma once
 
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
-#include <boost/crc.hpp>
+#include <boost/optional.hpp>
 #include "common/common_types.h"
-#include "core/tracer/citrace.h"
-
-namespace CiTrace {
-
+#include "common/file_util.h"
+#include "core/tracer/gpu_trace.h"
+
+namespace Tegra {
+struct CommandListHeader;
+struct FramebufferConfig;
+class MemoryManager;
+} // namespace Tegra
+
+namespace GPUTrace {
+
+/**
+ * Records the command lists submitted to the GPU and the frames presented to a trace file.
+ *
+ * The GPU reads guest memory through the CPU page table, so there is no way to tell which pages a
+ * command list touches. Instead, the memory mapped into the GPU address space is captured the
+ * first time it's seen, and then before the first command list of each frame for the pages whose
+ * contents changed since they were captured. The command lists themselves are captured on every
+ * submission, as the guest usually rewrites them within a frame.
+ */
 class Recorder {
 public:
-    struct InitialState {
-        std::vector<u32> gpu_registers;
-        std::vector<u32> lcd_registers;
-        std::vector<u32> pica_registers;
-        std::vector<u32> default_attributes;
-        std::vector<u32> vs_program_binary;
-        std::vector<u32> vs_swizzle_data;
-        std::vector<u32> vs_float_uniforms;
-        std::vector<u32> gs_program_binary;
-        std::vector<u32> gs_swizzle_data;
-        std::vector<u32> gs_float_uniforms;
-    };
-
-    /**
-     * Recorder constructor
-     * @param initial_state Initial recorder state
-     */
-    explicit Recorder(const InitialState& initial_state);
-
-    /// Finish recording of this Citrace and save it using the given filename.
-    void Finish(const std::string& filename);
-
-    /// Mark end of a frame
-    void FrameFinished();
-
-    /**
-     * Store a copy of the given memory range in the recording.
-     * @note Use this whenever the GPU is about to access a particular memory region.
-     * @note The implementation will make sure to minimize redundant memory updates.
-     */
-    void MemoryAccessed(const u8* data, u32 size, u32 physical_address);
-
-    /**
-     * Record a register write.
-     * @note Use this whenever a GPU-related MMIO register has been written to.
-     */
-    template <typename T>
-    void RegisterWritten(u32 physical_address, T value);
+    /// Creates the trace file, check IsOpen for errors
+    explicit Recorder(const std::string& filename);
+    ~Recorder();
+
+    /// Returns whether the trace file could be created and nothing failed to be written to it
+    bool IsOpen() const;
+
+    /// Records a submission of command lists, along with the memory they may depend on
+    void RecordSubmit(const Tegra::MemoryManager& memory_manager,
+                      const Tegra::CommandListHeader* entries, std::size_t count);
+
+    /// Records the presentation of a framebuffer, or of the previous frame when there is none
+    void RecordSwapBuffers(boost::optional<const Tegra::FramebufferConfig&> framebuffer);
 
 private:
-    // Initial state of recording start
-    InitialState initial_state;
+    /// Records the GPU mappings when they changed since they were last recorded
+    void SyncMappedRegions(const Tegra::MemoryManager& memory_manager);
 
-    // Command stream
-    struct StreamElement {
-        CTStreamElement data;
+    /// Records the mapped pages whose contents changed since they were last recorded
+    void SyncMemory();
 
-        /**
-         * Extra data to store along "core" data.
-         * This is e.g. used for data used in MemoryUpdates.
-         */
-        std::vector<u8> extra_data;
+    /// Writes the header of an element with a payload of the given size
+    void WriteElementHeader(ElementType type, u64 size);
 
-        /// Optional CRC hash (e.g. for hashing memory regions)
-        boost::crc_32_type::value_type hash;
+    /// Writes raw data to the trace, marking it as failed on errors
+    void Write(const void* data, std::size_t size);
 
-        /// If true, refer to data already written to the output file instead of extra_data
-        bool uses_existing_data;
-    };
+    std::mutex mutex;
+    FileUtil::IOFile file;
+    bool failed = false;
 
-    std::vector<StreamElement> stream;
+    std::vector<MappedRegion> mapped_regions;
+    /// Hash of the contents of each recorded page, keyed by page address
+    std::unordered_map<VAddr, u64> page_hashes;
+    /// Whether the memory was recorded since the last frame was presented
+    bool memory_synced = false;
 
-    /**
-     * Internal cache which maps hashes of memory contents to file offsets at which those memory
-     * contents are stored.
-     */
-    std::unordered_map<boost::crc_32_type::value_type /*hash*/, u32 /*file_offset*/> memory_regions;
+    /// Scratch buffers reused across submissions
+    std::vector<u8> memory_buffer;
+    std::vector<u32> command_buffer;
 };
 
-} // namespace CiTrace
+} // namespace GPUTrace
@@ -3,13 +3,16 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <mutex>
 #include <thread>
 #include <tuple>
+#include "common/common_types.h"
 #include "common/math_util.h"
 #include "common/quaternion.h"
-#include "common/thread.h"
 #include "common/vector_math.h"
 #include "input_common/motion_emu.h"
 
@@ -26,7 +29,11 @@ public:
 
     ~MotionEmuDevice() {
         if (motion_emu_thread.joinable()) {
-            shutdown_event.Set();
+            {
+                std::lock_guard<std::mutex> guard(tilt_mutex);
+                is_shutting_down = true;
+            }
+            tilt_changed.notify_one();
             motion_emu_thread.join();
         }
     }
@@ -39,29 +46,79 @@ public:
     void Tilt(int x, int y) {
         auto mouse_move = Math::MakeVec(x, y) - mouse_origin;
         if (is_tilting) {
-            std::lock_guard<std::mutex> guard(tilt_mutex);
-            if (mouse_move.x == 0 && mouse_move.y == 0) {
-                tilt_angle = 0;
-            } else {
-                tilt_direction = mouse_move.Cast<float>();
-                tilt_angle =
-                    std::clamp(tilt_direction.Normalize() * sensitivity, 0.0f, MathUtil::PI * 0.5f);
+            {
+                std::lock_guard<std::mutex> guard(tilt_mutex);
+                if (mouse_move.x == 0 && mouse_move.y == 0) {
+                    tilt_angle = 0;
+                } else {
+                    tilt_direction = mouse_move.Cast<float>();
+                    tilt_angle = std::clamp(tilt_direction.Normalize() * sensitivity, 0.0f,
+                                            MathUtil::PI * 0.5f);
+                }
+                has_new_tilt = true;
             }
+            tilt_changed.notify_one();
         }
     }
 
     void EndTilt() {
-        std::lock_guard<std::mutex> guard(tilt_mutex);
-        tilt_angle = 0;
-        is_tilting = false;
+        {
+            std::lock_guard<std::mutex> guard(tilt_mutex);
+            tilt_angle = 0;
+            is_tilting = false;
+            has_new_tilt = true;
+        }
+        tilt_changed.notify_one();
     }
 
     std::tuple<Math::Vec3<float>, Math::Vec3<float>> GetStatus() {
-        std::lock_guard<std::mutex> guard(status_mutex);
-        return status;
+        return status.Load();
     }
 
 private:
+    /**
+     * The sensor state, published by the motion thread and read by the emulated HID whenever it
+     * samples. Like the state of the other input devices it's kept in atomics rather than behind a
+     * lock, with a sequence number so that a reader never mixes the vectors of two updates.
+     */
+    class Status {
+    public:
+        Status() {
+            Store(Math::MakeVec(0.0f, -1.0f, 0.0f), {});
+        }
+
+        void Store(const Math::Vec3<float>& gravity, const Math::Vec3<float>& angular_rate) {
+            // There is a single writer, an odd sequence number marks an update in progress
+            const u32 begin = sequence.load(std::memory_order_relaxed) + 1;
+            sequence.store(begin, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            for (std::size_t i = 0; i < 3; ++i) {
+                values[i].store(gravity[i], std::memory_order_relaxed);
+                values[i + 3].store(angular_rate[i], std::memory_order_relaxed);
+            }
+            sequence.store(begin + 1, std::memory_order_release);
+        }
+
+        std::tuple<Math::Vec3<float>, Math::Vec3<float>> Load() const {
+            Math::Vec3<float> gravity;
+            Math::Vec3<float> angular_rate;
+            u32 begin;
+            do {
+                begin = sequence.load(std::memory_order_acquire);
+                for (std::size_t i = 0; i < 3; ++i) {
+                    gravity[i] = values[i].load(std::memory_order_relaxed);
+                    angular_rate[i] = values[i + 3].load(std::memory_order_relaxed);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+            } while ((begin & 1) != 0 || sequence.load(std::memory_order_relaxed) != begin);
+            return std::make_tuple(gravity, angular_rate);
+        }
+
+    private:
+        std::atomic<u32> sequence{0};
+        std::array<std::atomic<float>, 6> values{};
+    };
+
     const int update_millisecond;
     const std::chrono::steady_clock::duration update_duration;
     const float sensitivity;
@@ -69,56 +126,74 @@ private:
     Math::Vec2<int> mouse_origin;
 
     std::mutex tilt_mutex;
+    std::condition_variable tilt_changed;
     Math::Vec2<float> tilt_direction;
     float tilt_angle = 0;
+    bool has_new_tilt = false;
+    bool is_shutting_down = false;
 
     bool is_tilting = false;
 
-    Common::Event shutdown_event;
-
-    std::tuple<Math::Vec3<float>, Math::Vec3<float>> status;
-    std::mutex status_mutex;
+    Status status;
 
     // Note: always keep the thread declaration at the end so that other objects are initialized
     // before this!
     std::thread motion_emu_thread;
 
     void MotionEmuThread() {
-        auto update_time = std::chrono::steady_clock::now();
         Math::Quaternion<float> q = MakeQuaternion(Math::Vec3<float>(), 0);
         Math::Quaternion<float> old_q;
 
-        while (!shutdown_event.WaitUntil(update_time)) {
-            update_time += update_duration;
-            old_q = q;
-
-            {
-                std::lock_guard<std::mutex> guard(tilt_mutex);
-
+        std::unique_lock<std::mutex> lock(tilt_mutex);
+        while (true) {
+            // The sensors only change while the tilt does, so the thread sleeps until the mouse
+            // moves rather than waking up every update period
+            tilt_changed.wait(lock, [this] { return has_new_tilt || is_shutting_down; });
+            if (is_shutting_down)
+                return;
+
+            // Updates keep the period for as long as the tilt changes, the angular rate is
+            // derived from it. The update after the tilt stops brings the rate back to zero.
+            auto update_time = std::chrono::steady_clock::now();
+            bool is_changing = true;
+            while (is_changing) {
+                is_changing = has_new_tilt;
+                has_new_tilt = false;
+
+                old_q = q;
                 // Find the quaternion describing current 3DS tilting
                 q = MakeQuaternion(Math::MakeVec(-tilt_direction.y, 0.0f, tilt_direction.x),
                                    tilt_angle);
+
+                lock.unlock();
+                UpdateStatus(q, old_q);
+                lock.lock();
+
+                update_time += update_duration;
+                if (tilt_changed.wait_until(lock, update_time,
+                                            [this] { return is_shutting_down; })) {
+                    return;
+                }
             }
+        }
+    }
 
-            auto inv_q = q.Inverse();
+    void UpdateStatus(const Math::Quaternion<float>& q, const Math::Quaternion<float>& old_q) {
+        auto inv_q = q.Inverse();
 
-            // Set the gravity vector in world space
-            auto gravity = Math::MakeVec(0.0f, -1.0f, 0.0f);
+        // Set the gravity vector in world space
+        auto gravity = Math::MakeVec(0.0f, -1.0f, 0.0f);
 
-            // Find the angular rate vector in world space
-            auto angular_rate = ((q - old_q) * inv_q).xyz * 2;
-            angular_rate *= 1000 / update_millisecond / MathUtil::PI * 180;
+        // Find the angular rate vector in world space
+        auto angular_rate = ((q - old_q) * inv_q).xyz * 2;
+        angular_rate *= 1000 / update_millisecond / MathUtil::PI * 180;
 
-            // Transform the two vectors from world space to 3DS space
-            gravity = QuaternionRotate(inv_q, gravity);
-            angular_rate = QuaternionRotate(inv_q, angular_rate);
+        // Transform the two vectors from world space to 3DS space
+        gravity = QuaternionRotate(inv_q, gravity);
+        angular_rate = QuaternionRotate(inv_q, angular_rate);
 
-            // Update the sensor state
-            {
-                std::lock_guard<std::mutex> guard(status_mutex);
-                status = std::make_tuple(gravity, angular_rate);
-            }
-        }
+        // Update the sensor state
+        status.Store(gravity, angular_rate);
     }
 };
 
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <cmath>
 #include <functional>
@@ -44,6 +45,11 @@ static Common::SPSCQueue<SDL_Event> event_queue;
 
 static std::atomic<bool> initialized = false;
 
+/// Number of buttons, axes and hats kept per joystick, inputs past them are ignored
+constexpr std::size_t MaxButtons = 64;
+constexpr std::size_t MaxAxes = 32;
+constexpr std::size_t MaxHats = 8;
+
 static std::string GetGUID(SDL_Joystick* joystick) {
     SDL_JoystickGUID guid = SDL_JoystickGetGUID(joystick);
     char guid_str[33];
@@ -57,24 +63,33 @@ public:
                 decltype(&SDL_JoystickClose) deleter = &SDL_JoystickClose)
         : guid{std::move(guid_)}, port{port_}, sdl_joystick{joystick, deleter} {}
 
+    // The state is written by the poll thread as soon as SDL reports an event and read by the
+    // emulated HID whenever it samples, so it's kept in atomics rather than behind a lock
+
     void SetButton(int button, bool value) {
-        std::lock_guard<std::mutex> lock(mutex);
-        state.buttons[button] = value;
+        if (button >= 0 && button < static_cast<int>(MaxButtons)) {
+            state.buttons[button].store(value, std::memory_order_relaxed);
+        }
     }
 
     bool GetButton(int button) const {
-        std::lock_guard<std::mutex> lock(mutex);
-        return state.buttons.at(button);
+        if (button < 0 || button >= static_cast<int>(MaxButtons)) {
+            return false;
+        }
+        return state.buttons[button].load(std::memory_order_relaxed);
     }
 
     void SetAxis(int axis, Sint16 value) {
-        std::lock_guard<std::mutex> lock(mutex);
-        state.axes[axis] = value;
+        if (axis >= 0 && axis < static_cast<int>(MaxAxes)) {
+            state.axes[axis].store(value, std::memory_order_relaxed);
+        }
     }
 
     float GetAxis(int axis) const {
-        std::lock_guard<std::mutex> lock(mutex);
-        return state.axes.at(axis) / 32767.0f;
+        if (axis < 0 || axis >= static_cast<int>(MaxAxes)) {
+            return 0.0f;
+        }
+        return state.axes[axis].load(std::memory_order_relaxed) / 32767.0f;
     }
 
     std::tuple<float, float> GetAnalog(int axis_x, int axis_y) const {
@@ -95,13 +110,16 @@ public:
     }
 
     void SetHat(int hat, Uint8 direction) {
-        std::lock_guard<std::mutex> lock(mutex);
-        state.hats[hat] = direction;
+        if (hat >= 0 && hat < static_cast<int>(MaxHats)) {
+            state.hats[hat].store(direction, std::memory_order_relaxed);
+        }
     }
 
     bool GetHatDirection(int hat, Uint8 direction) const {
-        std::lock_guard<std::mutex> lock(mutex);
-        return (state.hats.at(hat) & direction) != 0;
+        if (hat < 0 || hat >= static_cast<int>(MaxHats)) {
+            return false;
+        }
+        return (state.hats[hat].load(std::memory_order_relaxed) & direction) != 0;
     }
     /**
      * The guid of the joystick
@@ -129,14 +147,13 @@ public:
 
 private:
     struct State {
-        std::unordered_map<int, bool> buttons;
-        std::unordered_map<int, Sint16> axes;
-        std::unordered_map<int, Uint8> hats;
+        std::array<std::atomic<bool>, MaxButtons> buttons{};
+        std::array<std::atomic<Sint16>, MaxAxes> axes{};
+        std::array<std::atomic<Uint8>, MaxHats> hats{};
     } state;
     std::string guid;
     int port;
     std::unique_ptr<SDL_Joystick, decltype(&SDL_JoystickClose)> sdl_joystick;
-    mutable std::mutex mutex;
 };
 
 /**
@@ -287,15 +304,20 @@ void PollLoop() {
 
     SDL_Event event;
     while (initialized) {
-        // Wait for 10 ms or until an event happens
-        if (SDL_WaitEventTimeout(&event, 10)) {
+        // Sleep until an event happens, Shutdown pushes one to wake the loop up. The timeout only
+        // matters when that event is taken by another thread waiting on SDL events.
+        if (!SDL_WaitEventTimeout(&event, 100)) {
+            continue;
+        }
+        // Handle every event already pending, so a burst of them doesn't add up to any delay
+        do {
             // Don't handle the event if we are configuring
             if (polling) {
                 event_queue.Push(event);
             } else {
                 HandleGameControllerEvent(event);
             }
-        }
+        } while (SDL_PollEvent(&event));
     }
     CloseSDLJoysticks();
     SDL_QuitSubSystem(SDL_INIT_JOYSTICK);
@@ -476,6 +498,11 @@ void Shutdown() {
         UnregisterFactory<ButtonDevice>("sdl");
         UnregisterFactory<AnalogDevice>("sdl");
         initialized = false;
+
+        // Wake the poll loop up so it notices the shutdown
+        SDL_Event wake_event{};
+        wake_event.type = SDL_USEREVENT;
+        SDL_PushEvent(&wake_event);
     }
 }
 
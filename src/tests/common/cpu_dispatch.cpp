@@ -0,0 +1,46 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+#include "common/cpu_dispatch.h"
+
+namespace Common {
+
+namespace {
+int CallScalar() {
+    return 0;
+}
+
+int CallSSE2() {
+    return 1;
+}
+
+int CallNEON() {
+    return 2;
+}
+} // Anonymous namespace
+
+TEST_CASE("CPUDispatch: Variants follow the limit", "[common]") {
+    DispatchedFunction<int()> function{"Test",
+                                       {
+                                           {SIMDLevel::Scalar, CallScalar},
+                                           {SIMDLevel::SSE2, CallSSE2},
+                                           {SIMDLevel::NEON, CallNEON},
+                                       }};
+
+    const int expected_variant = IsSIMDLevelSupported(SIMDLevel::SSE2)
+                                     ? 1
+                                     : IsSIMDLevelSupported(SIMDLevel::NEON) ? 2 : 0;
+    REQUIRE(function() == expected_variant);
+
+    // The already resolved function falls back as soon as the limit changes
+    SetSIMDLevelLimit(SIMDLevel::Scalar);
+    REQUIRE(function() == 0);
+    REQUIRE(function.GetResolvedLevel() == SIMDLevel::Scalar);
+
+    SetSIMDLevelLimit(MAX_SIMD_LEVEL);
+    REQUIRE(function() == expected_variant);
+}
+
+} // namespace Common
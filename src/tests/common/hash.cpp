@@ -0,0 +1,98 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/hash.h"
+
+namespace Common {
+
+static std::vector<u8> MakeData(std::size_t size) {
+    std::mt19937 generator{size};
+    std::vector<u8> data(size);
+    for (u8& byte : data) {
+        byte = static_cast<u8>(generator());
+    }
+    return data;
+}
+
+TEST_CASE("Hash: Streaming matches ComputeHash64", "[common]") {
+    for (const std::size_t size : {0, 1, 63, 64, 1023, 1024, 1025, 1087, 1088, 2048, 2049, 5000}) {
+        const std::vector<u8> data = MakeData(size);
+        const u64 expected = ComputeHash64(data.data(), data.size());
+
+        for (const std::size_t piece_size : {1, 7, 64, 1000, 1024, 1500, 4096}) {
+            HashStream64 stream;
+            for (std::size_t offset = 0; offset < size; offset += piece_size) {
+                stream.Update(data.data() + offset, std::min(piece_size, size - offset));
+            }
+            REQUIRE(stream.Digest() == expected);
+        }
+    }
+}
+
+TEST_CASE("Hash: Short inputs keep using CityHash64", "[common]") {
+    const std::vector<u8> data = MakeData(WIDE_HASH_THRESHOLD - 1);
+    REQUIRE(ComputeHash64(data.data(), data.size()) ==
+            CityHash64(reinterpret_cast<const char*>(data.data()), data.size()));
+}
+
+TEST_CASE("Hash: Wide hash depends on every byte", "[common]") {
+    const std::vector<u8> data = MakeData(3000);
+    const u64 original = ComputeHash64(data.data(), data.size());
+    REQUIRE(ComputeHash64(data.data(), data.size() - 1) != original);
+
+    for (const std::size_t position : {0, 7, 8, 63, 1023, 1024, 2047, 2999}) {
+        std::vector<u8> modified = data;
+        modified[position] ^= 1;
+        REQUIRE(ComputeHash64(modified.data(), modified.size()) != original);
+    }
+}
+
+TEST_CASE("Hash: Stream can be digested and continued", "[common]") {
+    const std::vector<u8> data = MakeData(4000);
+    HashStream64 stream;
+    stream.Update(data.data(), 2000);
+    REQUIRE(stream.Digest() == ComputeHash64(data.data(), 2000));
+    stream.Update(data.data() + 2000, 2000);
+    REQUIRE(stream.Digest() == ComputeHash64(data.data(), 4000));
+
+    stream.Reset();
+    stream.Update(data.data(), 100);
+    REQUIRE(stream.Digest() == ComputeHash64(data.data(), 100));
+}
+
+// Hidden from the default run, run with: tests "[.benchmark]"
+TEST_CASE("Hash: Wide hash against CityHash64 benchmark", "[.benchmark]") {
+    using Clock = std::chrono::steady_clock;
+    for (const std::size_t size : {4096, 256 * 1024, 4 * 1024 * 1024}) {
+        const std::vector<u8> data = MakeData(size);
+        const std::size_t iterations = std::max<std::size_t>(1, (256 * 1024 * 1024) / size);
+
+        u64 sink = 0;
+        const auto city_start = Clock::now();
+        for (std::size_t i = 0; i < iterations; ++i) {
+            sink += CityHash64(reinterpret_cast<const char*>(data.data()), size);
+        }
+        const auto wide_start = Clock::now();
+        for (std::size_t i = 0; i < iterations; ++i) {
+            sink += ComputeWideHash64(data.data(), size);
+        }
+        const auto wide_end = Clock::now();
+
+        const double bytes = static_cast<double>(size) * iterations;
+        const auto GetSpeed = [bytes](Clock::duration duration) {
+            return bytes / std::chrono::duration<double>(duration).count() / (1024 * 1024 * 1024);
+        };
+        WARN(size << " bytes: CityHash64 " << GetSpeed(wide_start - city_start)
+                  << " GiB/s, wide hash " << GetSpeed(wide_end - wide_start) << " GiB/s ("
+                  << sink << ")");
+    }
+}
+
+} // namespace Common
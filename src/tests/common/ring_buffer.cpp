@@ -127,4 +127,107 @@ TEST_CASE("RingBuffer: Threaded Test", "[common]") {
     printf("RingBuffer: Threaded Test: full: %zu, empty: %zu\n", full, empty);
 }
 
+TEST_CASE("RingBuffer: In-place Tests", "[common]") {
+    RingBuffer<char, 4, 1> buf;
+
+    // Reserving more slots than free should only return the free ones, in a single span.
+    {
+        const auto spans = buf.ReserveWrite(6);
+        REQUIRE(spans.first_count == 4);
+        REQUIRE(spans.second_count == 0);
+        std::iota(spans.first, spans.first + 3, 0);
+        buf.CommitWrite(3);
+    }
+
+    REQUIRE(buf.Size() == 3);
+
+    // Peeking shouldn't pop anything until the slots are consumed.
+    {
+        const auto spans = buf.Peek(2);
+        REQUIRE(spans.Size() == 2);
+        REQUIRE(spans.first[0] == 0);
+        REQUIRE(spans.first[1] == 1);
+        REQUIRE(buf.Size() == 3);
+        buf.Consume(2);
+    }
+
+    REQUIRE(buf.Size() == 1);
+
+    // Free slots wrapping around the end of the buffer should be split in two spans.
+    {
+        const auto spans = buf.ReserveWrite();
+        REQUIRE(spans.first_count == 1);
+        REQUIRE(spans.second_count == 2);
+        spans.first[0] = 3;
+        spans.second[0] = 4;
+        spans.second[1] = 5;
+        buf.CommitWrite(spans.Size());
+    }
+
+    REQUIRE(buf.Size() == 4);
+
+    // So should filled slots.
+    {
+        const auto spans = buf.Peek();
+        REQUIRE(spans.first_count == 2);
+        REQUIRE(spans.second_count == 2);
+        REQUIRE(spans.first[0] == 2);
+        REQUIRE(spans.first[1] == 3);
+        REQUIRE(spans.second[0] == 4);
+        REQUIRE(spans.second[1] == 5);
+        buf.Consume(spans.Size());
+    }
+
+    REQUIRE(buf.Size() == 0);
+}
+
+TEST_CASE("RingBuffer: Threaded In-place Test", "[common]") {
+    RingBuffer<u32, 64> buf;
+    const u32 count = 1000000;
+    std::size_t full = 0;
+    std::size_t empty = 0;
+
+    std::thread producer{[&] {
+        u32 value = 0;
+        while (value < count) {
+            const auto spans = buf.ReserveWrite(count - value);
+            if (spans.Size() == 0) {
+                full++;
+                std::this_thread::yield();
+                continue;
+            }
+            std::iota(spans.first, spans.first + spans.first_count, value);
+            std::iota(spans.second, spans.second + spans.second_count,
+                      value + static_cast<u32>(spans.first_count));
+            buf.CommitWrite(spans.Size());
+            value += static_cast<u32>(spans.Size());
+        }
+    }};
+
+    std::thread consumer{[&] {
+        u32 value = 0;
+        while (value < count) {
+            const auto spans = buf.Peek();
+            if (spans.Size() == 0) {
+                empty++;
+                std::this_thread::yield();
+                continue;
+            }
+            for (std::size_t i = 0; i < spans.first_count; i++) {
+                REQUIRE(spans.first[i] == value++);
+            }
+            for (std::size_t i = 0; i < spans.second_count; i++) {
+                REQUIRE(spans.second[i] == value++);
+            }
+            buf.Consume(spans.Size());
+        }
+    }};
+
+    producer.join();
+    consumer.join();
+
+    REQUIRE(buf.Size() == 0);
+    printf("RingBuffer: Threaded In-place Test: full: %zu, empty: %zu\n", full, empty);
+}
+
 } // namespace Common
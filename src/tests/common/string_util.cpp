@@ -0,0 +1,53 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <string>
+#include <catch2/catch.hpp>
+#include "common/string_util.h"
+
+namespace Common {
+
+TEST_CASE("StringUtil: UTF-8 and UTF-16 round trip", "[common]") {
+    // Long enough for the ASCII runs to be converted in blocks, with the non-ASCII characters
+    // in the middle and at the end of a block
+    const std::u16string utf16 = u"The Legend of Zelda: Breath of the Wild éè "
+                                 u"ゼルダの伝説 \U0001F600 end of title";
+    const std::string utf8 = u8"The Legend of Zelda: Breath of the Wild éè "
+                             u8"ゼルダの伝説 \U0001F600 end of title";
+
+    REQUIRE(UTF16ToUTF8(utf16) == utf8);
+    REQUIRE(UTF8ToUTF16(utf8) == utf16);
+    REQUIRE(UTF16ToUTF8(std::u16string{}).empty());
+    REQUIRE(UTF8ToUTF16(std::string{}).empty());
+
+    for (std::size_t length = 0; length < 40; ++length) {
+        const std::string ascii(length, 'a');
+        REQUIRE(UTF16ToUTF8(UTF8ToUTF16(ascii)) == ascii);
+    }
+}
+
+TEST_CASE("StringUtil: Invalid UTF-8 and UTF-16", "[common]") {
+    // Truncated, overlong and surrogate sequences, and a stray continuation byte
+    REQUIRE(UTF8ToUTF16("a\xE3\x82") == u"a�");
+    REQUIRE(UTF8ToUTF16("\xC0\xAF") == u"�");
+    REQUIRE(UTF8ToUTF16("\xED\xA0\x80z") == u"�z");
+    REQUIRE(UTF8ToUTF16("\x80z") == u"�z");
+
+    // Unpaired surrogates
+    REQUIRE(UTF16ToUTF8(std::u16string{u'a', char16_t(0xD800)}) == u8"a�");
+    REQUIRE(UTF16ToUTF8(std::u16string{char16_t(0xDC00), u'b'}) == u8"�b");
+}
+
+TEST_CASE("StringUtil: UTF conversion into caller buffers", "[common]") {
+    const std::u16string utf16 = u"save data セーブ";
+    std::string utf8(utf16.size() * MAX_UTF8_UNITS_PER_UTF16_UNIT, '\0');
+    utf8.resize(UTF16ToUTF8(utf16, utf8.data()));
+    REQUIRE(utf8 == u8"save data セーブ");
+
+    std::u16string converted(utf8.size(), u'\0');
+    converted.resize(UTF8ToUTF16(utf8, converted.data()));
+    REQUIRE(converted == utf16);
+}
+
+} // namespace Common
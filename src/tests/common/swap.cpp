@@ -0,0 +1,159 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/bit_field.h"
+#include "common/common_types.h"
+#include "common/cpu_dispatch.h"
+#include "common/swap.h"
+
+namespace Common {
+
+namespace {
+
+constexpr SIMDLevel Levels[] = {SIMDLevel::Scalar, SIMDLevel::SSSE3, SIMDLevel::AVX2,
+                                SIMDLevel::NEON};
+
+std::vector<u8> MakeRandomBytes(std::size_t size) {
+    std::mt19937 generator{static_cast<u32>(size)};
+    std::vector<u8> bytes(size);
+    for (u8& byte : bytes) {
+        byte = static_cast<u8>(generator());
+    }
+    return bytes;
+}
+
+template <typename T, T (*Swap)(T)>
+void SwapBlockReference(u8* dst, const u8* src, std::size_t count) {
+    for (std::size_t index = 0; index < count; ++index) {
+        T value;
+        std::memcpy(&value, src + index * sizeof(T), sizeof(T));
+        value = Swap(value);
+        std::memcpy(dst + index * sizeof(T), &value, sizeof(T));
+    }
+}
+
+template <typename T, T (*Swap)(T)>
+void CheckSwapBlock(void (*swap_block)(void*, const void*, std::size_t)) {
+    // Odd counts cover the scalar tails, the offset of one byte covers unaligned accesses
+    for (const std::size_t count : {0, 1, 7, 16, 33, 100, 1027}) {
+        const std::vector<u8> input{MakeRandomBytes(count * sizeof(T) + 1)};
+        std::vector<u8> expected(input.size());
+        SwapBlockReference<T, Swap>(expected.data() + 1, input.data() + 1, count);
+
+        std::vector<u8> output(input.size());
+        swap_block(output.data() + 1, input.data() + 1, count);
+        REQUIRE(std::memcmp(output.data() + 1, expected.data() + 1, count * sizeof(T)) == 0);
+
+        std::vector<u8> in_place{input};
+        swap_block(in_place.data() + 1, in_place.data() + 1, count);
+        REQUIRE(std::memcmp(in_place.data() + 1, expected.data() + 1, count * sizeof(T)) == 0);
+    }
+}
+
+u16 Swap16(u16 value) {
+    return swap16(value);
+}
+
+u32 Swap32(u32 value) {
+    return swap32(value);
+}
+
+u64 Swap64(u64 value) {
+    return swap64(value);
+}
+
+/// Entry of a table of big endian words, as found in the file formats of some titles
+union PackedEntry {
+    u32 raw;
+    BitField<0, 12, u32> offset;
+    BitField<12, 8, u32> flags;
+    BitField<20, 12, u32> id;
+};
+
+} // Anonymous namespace
+
+TEST_CASE("Swap: Block swaps match the scalar swaps", "[common]") {
+    for (const SIMDLevel level : Levels) {
+        SetSIMDLevelLimit(level);
+        CheckSwapBlock<u16, Swap16>(SwapBlock16);
+        CheckSwapBlock<u32, Swap32>(SwapBlock32);
+        CheckSwapBlock<u64, Swap64>(SwapBlock64);
+    }
+    SetSIMDLevelLimit(MAX_SIMD_LEVEL);
+}
+
+TEST_CASE("BitField: Batch extraction matches the unions", "[common]") {
+    const std::vector<u8> bytes{MakeRandomBytes(257 * sizeof(u32))};
+    std::vector<PackedEntry> entries(257);
+    std::memcpy(entries.data(), bytes.data(), bytes.size());
+    std::vector<u32> words(entries.size());
+    std::memcpy(words.data(), bytes.data(), bytes.size());
+
+    std::vector<u32> flags(entries.size());
+    decltype(PackedEntry::flags)::ExtractValues(flags.data(), words.data(), words.size());
+    std::vector<u32> ids(entries.size());
+    decltype(PackedEntry::id)::ExtractValues(ids.data(), words.data(), words.size());
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        REQUIRE(flags[i] == entries[i].flags);
+        REQUIRE(ids[i] == entries[i].id);
+    }
+}
+
+TEST_CASE("Swap: Block swap benchmark", "[.][benchmark]") {
+    constexpr std::size_t BufferSize = 0x100000;
+    constexpr int Iterations = 1000;
+    const std::vector<u8> input{MakeRandomBytes(BufferSize)};
+    std::vector<u8> output(BufferSize);
+
+    const auto measure = [](const char* name, const char* variant, auto&& function) {
+        const auto start{std::chrono::steady_clock::now()};
+        for (int i = 0; i < Iterations; ++i) {
+            function();
+        }
+        const std::chrono::duration<double> duration{std::chrono::steady_clock::now() - start};
+        std::printf("%-12s %-8s %8.2f GB/s\n", name, variant,
+                    static_cast<double>(BufferSize) * Iterations / duration.count() / 1e9);
+    };
+
+    for (const SIMDLevel level : Levels) {
+        if (!IsSIMDLevelSupported(level)) {
+            continue;
+        }
+        SetSIMDLevelLimit(level);
+        const char* const variant = GetSIMDLevelName(level);
+        measure("SwapBlock16", variant,
+                [&] { SwapBlock16(output.data(), input.data(), BufferSize / 2); });
+        measure("SwapBlock32", variant,
+                [&] { SwapBlock32(output.data(), input.data(), BufferSize / 4); });
+        measure("SwapBlock64", variant,
+                [&] { SwapBlock64(output.data(), input.data(), BufferSize / 8); });
+    }
+    SetSIMDLevelLimit(MAX_SIMD_LEVEL);
+
+    // Decoding a big endian table, one entry at a time against swapping it first
+    const std::size_t num_entries = BufferSize / sizeof(u32);
+    std::vector<u32> words(num_entries);
+    std::vector<u32> ids(num_entries);
+    measure("Decode table", "Unions", [&] {
+        for (std::size_t i = 0; i < num_entries; ++i) {
+            u32_be word;
+            std::memcpy(&word, input.data() + i * sizeof(u32), sizeof(u32));
+            PackedEntry entry{};
+            entry.raw = word;
+            ids[i] = entry.id;
+        }
+    });
+    measure("Decode table", "Batched", [&] {
+        SwapBlock32(words.data(), input.data(), num_entries);
+        decltype(PackedEntry::id)::ExtractValues(ids.data(), words.data(), num_entries);
+    });
+}
+
+} // namespace Common
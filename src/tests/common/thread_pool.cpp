@@ -0,0 +1,67 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <numeric>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/thread_pool.h"
+
+namespace Common {
+
+TEST_CASE("ThreadPool: Submit", "[common]") {
+    ThreadPool pool{4};
+    REQUIRE(pool.GetThreadCount() == 4);
+
+    std::vector<std::future<int>> results;
+    for (int i = 0; i < 100; ++i) {
+        results.push_back(pool.Submit([i] { return i * 2; }, static_cast<TaskPriority>(i % 3)));
+    }
+    for (int i = 0; i < 100; ++i) {
+        REQUIRE(results[i].get() == i * 2);
+    }
+}
+
+TEST_CASE("ThreadPool: Pending tasks run before destruction", "[common]") {
+    std::atomic<int> count{0};
+    {
+        ThreadPool pool{2};
+        for (int i = 0; i < 1000; ++i) {
+            pool.Submit([&count] { ++count; });
+        }
+    }
+    REQUIRE(count == 1000);
+}
+
+TEST_CASE("ThreadPool: ParallelFor", "[common]") {
+    ThreadPool pool{4};
+    std::vector<int> values(10000);
+    pool.ParallelFor(0, values.size(), [&values](std::size_t i) { values[i]++; });
+    // Every index should have been visited exactly once
+    REQUIRE(std::all_of(values.begin(), values.end(), [](int value) { return value == 1; }));
+
+    // Empty ranges shouldn't call anything
+    pool.ParallelFor(5, 5, [](std::size_t) { FAIL(); });
+}
+
+TEST_CASE("ThreadPool: Nested ParallelFor", "[common]") {
+    // Every worker waiting in a ParallelFor shouldn't keep the nested ones from finishing
+    ThreadPool pool{2};
+    std::atomic<std::size_t> sum{0};
+    pool.ParallelFor(0, 16, [&](std::size_t i) {
+        pool.ParallelFor(0, 100, [&](std::size_t j) { sum += i * 100 + j; });
+    });
+    REQUIRE(sum == 1600 * 1599 / 2);
+
+    auto task = pool.Submit([&] {
+        std::atomic<int> count{0};
+        pool.ParallelFor(0, 64, [&count](std::size_t) { ++count; });
+        return count.load();
+    });
+    REQUIRE(task.get() == 64);
+}
+
+} // namespace Common
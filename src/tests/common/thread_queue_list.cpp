@@ -0,0 +1,56 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+#include "common/thread_queue_list.h"
+
+namespace Common {
+
+TEST_CASE("ThreadQueueList: Priority order", "[common]") {
+    ThreadQueueList<int, 64> queue;
+    REQUIRE(queue.get_first() == 0);
+    REQUIRE(queue.pop_first() == 0);
+
+    queue.push_back(63, 1);
+    queue.push_back(10, 2);
+    queue.push_back(10, 3);
+    queue.push_front(10, 4);
+    queue.push_back(0, 5);
+
+    REQUIRE(queue.get_first() == 5);
+    REQUIRE(queue.pop_first() == 5);
+    REQUIRE(queue.empty(0));
+
+    // Only levels with a higher priority than the given one are considered
+    REQUIRE(queue.pop_first_better(10) == 0);
+    REQUIRE(queue.pop_first_better(11) == 4);
+
+    queue.remove(10, 2);
+    REQUIRE(queue.pop_first() == 3);
+    REQUIRE(queue.empty(10));
+    REQUIRE(queue.pop_first() == 1);
+    REQUIRE(queue.get_first() == 0);
+}
+
+TEST_CASE("ThreadQueueList: Changing priorities", "[common]") {
+    ThreadQueueList<int, 64> queue;
+    queue.push_back(20, 1);
+    queue.push_back(30, 2);
+
+    queue.move(2, 30, 5);
+    REQUIRE(queue.empty(30));
+    REQUIRE(queue.contains(2) == 5);
+    REQUIRE(queue.pop_first() == 2);
+
+    queue.push_back(20, 3);
+    queue.rotate(20);
+    REQUIRE(queue.pop_first() == 3);
+    REQUIRE(queue.pop_first() == 1);
+
+    queue.push_back(40, 4);
+    queue.clear();
+    REQUIRE(queue.get_first() == 0);
+}
+
+} // namespace Common
@@ -0,0 +1,112 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/threadsafe_queue.h"
+
+namespace Common {
+
+TEST_CASE("SPSCQueue: Basic Tests", "[common]") {
+    SPSCQueue<int> queue;
+    REQUIRE(queue.Empty());
+
+    // Elements are popped in the order they were pushed, also when the freed ones are reused
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 4; ++i) {
+            queue.Push(i);
+        }
+        REQUIRE(queue.Size() == 4);
+        REQUIRE(queue.Front() == 0);
+
+        for (int i = 0; i < 4; ++i) {
+            int value;
+            REQUIRE(queue.Pop(value));
+            REQUIRE(value == i);
+        }
+        REQUIRE(queue.Empty());
+
+        int value;
+        REQUIRE(!queue.Pop(value));
+    }
+
+    queue.Push(42);
+    queue.Clear();
+    REQUIRE(queue.Empty());
+    REQUIRE(queue.Size() == 0);
+}
+
+TEST_CASE("SPSCQueue: Popping releases the element", "[common]") {
+    SPSCQueue<std::shared_ptr<int>> queue;
+    const auto element = std::make_shared<int>(1);
+
+    queue.Push(element);
+    REQUIRE(element.use_count() == 2);
+    queue.Pop();
+    REQUIRE(element.use_count() == 1);
+
+    queue.Push(element);
+    std::shared_ptr<int> popped;
+    REQUIRE(queue.Pop(popped));
+    popped.reset();
+    REQUIRE(element.use_count() == 1);
+}
+
+TEST_CASE("SPSCQueue: Threaded Test", "[common]") {
+    constexpr int count = 100000;
+    SPSCQueue<int> queue;
+
+    std::thread producer{[&queue] {
+        for (int i = 0; i < count; ++i) {
+            queue.Push(i);
+        }
+    }};
+
+    int expected = 0;
+    while (expected < count) {
+        int value;
+        if (queue.Pop(value)) {
+            REQUIRE(value == expected);
+            ++expected;
+        }
+    }
+    producer.join();
+    REQUIRE(queue.Empty());
+}
+
+TEST_CASE("MPSCQueue: Threaded Test", "[common]") {
+    constexpr int producer_count = 4;
+    constexpr int count = 25000;
+    MPSCQueue<std::pair<int, int>> queue;
+
+    std::vector<std::thread> producers;
+    for (int producer = 0; producer < producer_count; ++producer) {
+        producers.emplace_back([&queue, producer] {
+            for (int i = 0; i < count; ++i) {
+                queue.Push(std::make_pair(producer, i));
+            }
+        });
+    }
+
+    // The elements of each producer are popped in the order it pushed them
+    std::array<int, producer_count> expected{};
+    int popped = 0;
+    while (popped < producer_count * count) {
+        std::pair<int, int> value;
+        if (queue.Pop(value)) {
+            REQUIRE(value.second == expected[value.first]);
+            ++expected[value.first];
+            ++popped;
+        }
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    REQUIRE(queue.Empty());
+}
+
+} // namespace Common
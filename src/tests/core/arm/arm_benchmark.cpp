@@ -0,0 +1,212 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#ifdef ARCHITECTURE_x86_64
+#include "core/arm/dynarmic/arm_dynarmic.h"
+#endif
+#include "core/arm/unicorn/arm_unicorn.h"
+#include "core/core.h"
+#include "core/core_cpu.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/process.h"
+#include "core/memory.h"
+#include "core/memory_setup.h"
+#include "tests/core/arm/arm_test_common.h"
+
+namespace ArmTests {
+
+namespace {
+
+constexpr VAddr CodeAddress = 0x10000;
+constexpr VAddr DataAddress = 0x100000;
+constexpr std::size_t CodeSize = Memory::PAGE_SIZE;
+constexpr std::size_t DataSize = 0x10000;
+
+constexpr u64 Iterations = 2000000;
+
+/// Loop counting X0 down to zero, followed by a branch to itself where the run ends
+struct Microbenchmark {
+    const char* name;
+    std::vector<u32> code;
+    u64 instructions_per_iteration;
+};
+
+const Microbenchmark Microbenchmarks[] = {
+    {"Integer",
+     {
+         0x8b020021, // add x1, x1, x2
+         0xca010c42, // eor x2, x2, x1, lsl #3
+         0x9b027c23, // mul x3, x1, x2
+         0xcb411c64, // sub x4, x3, x1, lsr #7
+         0xaa020085, // orr x5, x4, x2
+         0xf1000400, // subs x0, x0, #1
+         0x54ffff41, // b.ne #-0x18
+         0x14000000, // b .
+     },
+     7},
+    {"NEON",
+     {
+         0x4e22cc20, // fmla v0.4s, v1.4s, v2.4s
+         0x4e22cc23, // fmla v3.4s, v1.4s, v2.4s
+         0x4e25d484, // fadd v4.4s, v4.4s, v5.4s
+         0x4ea784c6, // add v6.4s, v6.4s, v7.4s
+         0x4ea99d08, // mul v8.4s, v8.4s, v9.4s
+         0x6e2b1d4a, // eor v10.16b, v10.16b, v11.16b
+         0xf1000400, // subs x0, x0, #1
+         0x54ffff21, // b.ne #-0x1c
+         0x14000000, // b .
+     },
+     8},
+    {"Load/store",
+     {
+         0xf8646823, // ldr x3, [x1, x4]
+         0x91000463, // add x3, x3, #1
+         0xf8246823, // str x3, [x1, x4]
+         0xa9411825, // ldp x5, x6, [x1, #16]
+         0xa9021426, // stp x6, x5, [x1, #32]
+         0x91002084, // add x4, x4, #8
+         0x927d3084, // and x4, x4, #0xfff8
+         0xf1000400, // subs x0, x0, #1
+         0x54ffff01, // b.ne #-0x20
+         0x14000000, // b .
+     },
+     9},
+    // Both sides of each branch run three instructions, so the count doesn't depend on the data
+    {"Branchy",
+     {
+         0x9b020c21, // madd x1, x1, x2, x3
+         0x36880061, // tbz w1, #17, #+0xc
+         0x91000484, // add x4, x4, #1
+         0x14000003, // b #+0xc
+         0x910004a5, // add x5, x5, #1
+         0xd503201f, // nop
+         0x37e80061, // tbnz w1, #29, #+0xc
+         0xca0100c6, // eor x6, x6, x1
+         0x14000003, // b #+0xc
+         0xcb0100c6, // sub x6, x6, x1
+         0xd503201f, // nop
+         0xf1000400, // subs x0, x0, #1
+         0x54fffe81, // b.ne #-0x30
+         0x14000000, // b .
+     },
+     9},
+    // Nothing else touches the monitor, so the store always succeeds
+    {"Exclusive",
+     {
+         0xc85ffc23, // ldaxr x3, [x1]
+         0x91000463, // add x3, x3, #1
+         0xc804fc23, // stlxr w4, x3, [x1]
+         0x35ffffa4, // cbnz w4, #-0xc
+         0xf1000400, // subs x0, x0, #1
+         0x54ffff61, // b.ne #-0x14
+         0x14000000, // b .
+     },
+     6},
+};
+
+/// Backs the code and data of the microbenchmarks with host memory, as the loaders do for guest
+/// programs, so that the CPU backends access them without going through the memory hook
+class BenchmarkMemory final {
+public:
+    explicit BenchmarkMemory(const std::vector<u32>& code_words)
+        : code(CodeSize), data(DataSize) {
+        std::memcpy(code.data(), code_words.data(), code_words.size() * sizeof(u32));
+        auto& page_table = Core::CurrentProcess()->vm_manager.page_table;
+        Memory::MapMemoryRegion(page_table, CodeAddress, CodeSize, code.data());
+        Memory::MapMemoryRegion(page_table, DataAddress, DataSize, data.data());
+    }
+
+    ~BenchmarkMemory() {
+        auto& page_table = Core::CurrentProcess()->vm_manager.page_table;
+        Memory::UnmapRegion(page_table, DataAddress, DataSize);
+        Memory::UnmapRegion(page_table, CodeAddress, CodeSize);
+    }
+
+    void MapInto(Core::ARM_Interface& cpu) {
+        cpu.MapBackingMemory(CodeAddress, CodeSize, code.data(),
+                             Kernel::VMAPermission::ReadWriteExecute);
+        cpu.MapBackingMemory(DataAddress, DataSize, data.data(),
+                             Kernel::VMAPermission::ReadWriteExecute);
+    }
+
+private:
+    std::vector<u8> code;
+    std::vector<u8> data;
+};
+
+void ResetContext(Core::ARM_Interface& cpu, u64 iterations) {
+    Core::ARM_Interface::ThreadContext context{};
+    context.pc = CodeAddress;
+    context.cpu_registers[0] = iterations;
+    context.cpu_registers[1] = DataAddress;
+    // Constants of a linear congruential generator, which the branchy loop runs on X1
+    context.cpu_registers[2] = 6364136223846793005ULL;
+    context.cpu_registers[3] = 1442695040888963407ULL;
+    cpu.LoadContext(context);
+}
+
+/// Runs timing slices until the CPU reaches the end of the microbenchmark
+std::chrono::duration<double> RunToEnd(Core::ARM_Interface& cpu, VAddr end_address) {
+    const auto start{std::chrono::steady_clock::now()};
+    while (cpu.GetPC() != end_address) {
+        cpu.Run();
+        CoreTiming::Advance();
+    }
+    return std::chrono::steady_clock::now() - start;
+}
+
+template <typename MakeCpu>
+void RunMicrobenchmarks(const char* backend_name, MakeCpu&& make_cpu) {
+    for (const Microbenchmark& benchmark : Microbenchmarks) {
+        TestEnvironment test_env{true};
+        CoreTiming::Init();
+        BenchmarkMemory memory{benchmark.code};
+
+        const std::unique_ptr<Core::ARM_Interface> cpu{make_cpu()};
+        memory.MapInto(*cpu);
+        const VAddr end_address{CodeAddress + (benchmark.code.size() - 1) * sizeof(u32)};
+
+        // The first run translates the code, the second one runs the same code from the cache
+        ResetContext(*cpu, 1);
+        const auto cold_time{RunToEnd(*cpu, end_address)};
+        ResetContext(*cpu, 1);
+        const auto warm_time{RunToEnd(*cpu, end_address)};
+
+        ResetContext(*cpu, Iterations);
+        const auto run_time{RunToEnd(*cpu, end_address)};
+        REQUIRE(cpu->GetReg(0) == 0);
+
+        const double instructions{
+            static_cast<double>(Iterations * benchmark.instructions_per_iteration)};
+        std::printf("%-8s %-12s %10.1f MIPS %10.3f ms compile\n", backend_name, benchmark.name,
+                    instructions / run_time.count() / 1e6,
+                    (cold_time - warm_time).count() * 1e3);
+
+        CoreTiming::Shutdown();
+    }
+}
+
+} // Anonymous namespace
+
+#ifdef ARCHITECTURE_x86_64
+TEST_CASE("ARM: Dynarmic microbenchmarks", "[.][benchmark]") {
+    const auto monitor{std::make_shared<Core::DynarmicExclusiveMonitor>(Core::NUM_CPU_CORES)};
+    RunMicrobenchmarks("Dynarmic", [&monitor] {
+        return std::make_unique<Core::ARM_Dynarmic>(monitor, 0);
+    });
+}
+#endif
+
+TEST_CASE("ARM: Unicorn microbenchmarks", "[.][benchmark]") {
+    RunMicrobenchmarks("Unicorn", [] { return std::make_unique<Core::ARM_Unicorn>(); });
+}
+
+} // namespace ArmTests
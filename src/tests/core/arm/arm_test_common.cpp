@@ -16,9 +16,10 @@ TestEnvironment::TestEnvironment(bool mutable_memory_)
     Core::CurrentProcess() = Kernel::Process::Create(kernel, "");
     page_table = &Core::CurrentProcess()->vm_manager.page_table;
 
-    page_table->pointers.fill(nullptr);
+    page_table->pointers = Common::VirtualBuffer<u8*>(Memory::PAGE_TABLE_NUM_ENTRIES);
     page_table->special_regions.clear();
-    page_table->attributes.fill(Memory::PageType::Unmapped);
+    page_table->attributes =
+        Common::VirtualBuffer<Memory::PageType>(Memory::PAGE_TABLE_NUM_ENTRIES);
 
     Memory::MapIoRegion(*page_table, 0x00000000, 0x80000000, test_memory);
     Memory::MapIoRegion(*page_table, 0x80000000, 0x80000000, test_memory);
@@ -6,7 +6,11 @@
 
 #include <array>
 #include <bitset>
+#include <chrono>
+#include <cstdio>
 #include <string>
+#include <thread>
+#include <vector>
 #include "common/file_util.h"
 #include "core/core.h"
 #include "core/core_timing.h"
@@ -235,3 +239,148 @@ TEST_CASE("CoreTiming[ChainScheduling]", "[core]") {
     REQUIRE(0 == reschedules);
     REQUIRE(MAX_SLICE_LENGTH == CoreTiming::GetDowncount());
 }
+
+TEST_CASE("CoreTiming[UnscheduleByHandle]", "[core]") {
+    ScopeInit guard;
+
+    CoreTiming::EventType* cb_a = CoreTiming::RegisterEvent("callbackA", CallbackTemplate<0>);
+    CoreTiming::EventType* cb_b = CoreTiming::RegisterEvent("callbackB", CallbackTemplate<1>);
+    CoreTiming::EventType* cb_c = CoreTiming::RegisterEvent("callbackC", CallbackTemplate<2>);
+
+    // Enter slice 0
+    CoreTiming::Advance();
+
+    const CoreTiming::EventHandle handle_a = CoreTiming::ScheduleEvent(100, cb_a, CB_IDS[0]);
+    const CoreTiming::EventHandle handle_b = CoreTiming::ScheduleEvent(500, cb_b, CB_IDS[1]);
+    const CoreTiming::EventHandle handle_c =
+        CoreTiming::ScheduleEventThreadsafe(800, cb_c, CB_IDS[2]);
+    REQUIRE(handle_a != CoreTiming::INVALID_EVENT_HANDLE);
+    REQUIRE(handle_a != handle_b);
+    REQUIRE(handle_b != handle_c);
+
+    // Cancelled events must neither fire nor shorten the following slices
+    CoreTiming::UnscheduleEvent(handle_a);
+    CoreTiming::UnscheduleEventThreadsafe(handle_c);
+
+    callbacks_ran_flags = 0;
+    CoreTiming::AddTicks(CoreTiming::GetDowncount());
+    CoreTiming::Advance();
+    REQUIRE(callbacks_ran_flags.none());
+    REQUIRE(400 == CoreTiming::GetDowncount());
+
+    AdvanceAndCheck(1, MAX_SLICE_LENGTH);
+
+    // Cancelling events that already fired or were cancelled is harmless
+    CoreTiming::UnscheduleEvent(handle_a);
+    CoreTiming::UnscheduleEvent(handle_b);
+    CoreTiming::UnscheduleEvent(CoreTiming::INVALID_EVENT_HANDLE);
+
+    callbacks_ran_flags = 0;
+    CoreTiming::AddTicks(CoreTiming::GetDowncount());
+    CoreTiming::Advance();
+    REQUIRE(callbacks_ran_flags.none());
+    REQUIRE(MAX_SLICE_LENGTH == CoreTiming::GetDowncount());
+}
+
+TEST_CASE("CoreTiming[IdleUntilNextEvent]", "[core]") {
+    ScopeInit guard;
+
+    CoreTiming::EventType* cb_a = CoreTiming::RegisterEvent("callbackA", CallbackTemplate<0>);
+
+    // Enter slice 0
+    CoreTiming::Advance();
+
+    // Schedule well past a single slice, idling should skip straight to the event.
+    CoreTiming::ScheduleEvent(MAX_SLICE_LENGTH * 5 + 100, cb_a, CB_IDS[0]);
+    CoreTiming::AddTicks(100); // Pretend we executed 100 cycles before the core went idle.
+
+    callbacks_ran_flags = 0;
+    expected_callback = CB_IDS[0];
+    lateness = 0;
+    CoreTiming::IdleUntilNextEvent();
+    CoreTiming::Advance();
+
+    REQUIRE(decltype(callbacks_ran_flags)().set(0) == callbacks_ran_flags);
+    REQUIRE(static_cast<u64>(MAX_SLICE_LENGTH * 5 + 100) == CoreTiming::GetTicks());
+    REQUIRE(static_cast<u64>(MAX_SLICE_LENGTH * 5) == CoreTiming::GetIdleTicks());
+
+    // Without any pending events this behaves like Idle()
+    CoreTiming::IdleUntilNextEvent();
+    CoreTiming::Advance();
+    REQUIRE(static_cast<u64>(MAX_SLICE_LENGTH * 6 + 100) == CoreTiming::GetTicks());
+}
+
+namespace BenchmarkTest {
+static u64 fired_events = 0;
+
+static void CountingCallback(u64 userdata, s64 cycles_late) {
+    ++fired_events;
+}
+
+/// Spreads the events over a thousand slices, in a fixed order unrelated to their index
+static s64 EventDelay(u64 index) {
+    return static_cast<s64>((index * 2654435761ULL) % (MAX_SLICE_LENGTH * 1000ULL)) + 1;
+}
+
+template <typename Function>
+static double MeasureNanoseconds(Function&& function) {
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+static void FireAllEvents(u64 expected_events) {
+    while (fired_events < expected_events) {
+        CoreTiming::AddTicks(CoreTiming::GetDowncount());
+        CoreTiming::Advance();
+    }
+}
+} // namespace BenchmarkTest
+
+TEST_CASE("CoreTiming[Benchmark]", "[.][benchmark]") {
+    using namespace BenchmarkTest;
+
+    for (const u64 count : {1000ULL, 10000ULL, 50000ULL}) {
+        ScopeInit guard;
+        CoreTiming::EventType* cb = CoreTiming::RegisterEvent("callback", CountingCallback);
+        CoreTiming::Advance();
+        fired_events = 0;
+
+        std::vector<CoreTiming::EventHandle> handles(count);
+        const double schedule_ns = MeasureNanoseconds([&] {
+            for (u64 i = 0; i < count; ++i) {
+                handles[i] = CoreTiming::ScheduleEvent(EventDelay(i), cb, i);
+            }
+        });
+
+        // Cancel every other event, like threads waking up before their timeout
+        const double unschedule_ns = MeasureNanoseconds([&] {
+            for (u64 i = 0; i < count; i += 2) {
+                CoreTiming::UnscheduleEvent(handles[i]);
+            }
+        });
+
+        // Events from other host threads go through the threadsafe queue until the next slice
+        double threadsafe_ns = 0;
+        std::thread producer([&] {
+            threadsafe_ns = MeasureNanoseconds([&] {
+                for (u64 i = 0; i < count / 2; ++i) {
+                    CoreTiming::ScheduleEventThreadsafe(EventDelay(count + i), cb, i);
+                }
+            });
+        });
+        producer.join();
+        const double move_ns = MeasureNanoseconds([] { CoreTiming::MoveEvents(); });
+
+        const u64 expected_events = count / 2 + count / 2;
+        const double fire_ns = MeasureNanoseconds([&] { FireAllEvents(expected_events); });
+        REQUIRE(fired_events == expected_events);
+
+        std::printf("%6llu events: schedule %7.1f ns, unschedule %7.1f ns, threadsafe schedule "
+                    "%7.1f ns, move %7.1f ns, fire %7.1f ns per event\n",
+                    static_cast<unsigned long long>(count), schedule_ns / count,
+                    unschedule_ns / ((count + 1) / 2), threadsafe_ns / (count / 2),
+                    move_ns / (count / 2), fire_ns / expected_events);
+    }
+}
@@ -0,0 +1,125 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "core/crypto/aes_ni.h"
+#include "core/crypto/aes_util.h"
+#include "core/crypto/key_manager.h"
+
+namespace Core::Crypto {
+
+// F.5.1 CTR-AES128.Encrypt from NIST SP 800-38A
+constexpr Key128 CTR_KEY{0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6,
+                         0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C};
+constexpr std::array<u8, 32> CTR_PLAINTEXT{
+    0x6B, 0xC1, 0xBE, 0xE2, 0x2E, 0x40, 0x9F, 0x96, 0xE9, 0x3D, 0x7E, 0x11, 0x73, 0x93, 0x17, 0x2A,
+    0xAE, 0x2D, 0x8A, 0x57, 0x1E, 0x03, 0xAC, 0x9C, 0x9E, 0xB7, 0x6F, 0xAC, 0x45, 0xAF, 0x8E, 0x51};
+constexpr std::array<u8, 32> CTR_CIPHERTEXT{
+    0x87, 0x4D, 0x61, 0x91, 0xB6, 0x20, 0xE3, 0x26, 0x1B, 0xEF, 0x68, 0x64, 0x99, 0x0D, 0xB6, 0xCE,
+    0x98, 0x06, 0xF6, 0x6B, 0x79, 0x70, 0xFD, 0xFF, 0x86, 0x17, 0x18, 0x7B, 0xB9, 0xFF, 0xFD, 0xFF};
+
+// Vector 2 from IEEE 1619-2007
+const Key256 XTS_KEY{[] {
+    Key256 key;
+    key.fill(0x22);
+    std::fill_n(key.begin(), 0x10, 0x11);
+    return key;
+}()};
+constexpr std::array<u8, 32> XTS_CIPHERTEXT{
+    0xC4, 0x54, 0x18, 0x5E, 0x6A, 0x16, 0x93, 0x6E, 0x39, 0x33, 0x40, 0x38, 0xAC, 0xEF, 0x83, 0x8B,
+    0xFB, 0x18, 0x6F, 0xFF, 0x74, 0x80, 0xAD, 0xC4, 0x28, 0x93, 0x82, 0xEC, 0xD6, 0xD3, 0x94, 0xF0};
+
+std::vector<u8> GetCTRCounter() {
+    std::vector<u8> iv(0x10);
+    for (std::size_t i = 0; i < iv.size(); ++i) {
+        iv[i] = static_cast<u8>(0xF0 + i);
+    }
+    return iv;
+}
+
+TEST_CASE("AESCipher: CTR", "[core][crypto]") {
+    AESCipher<Key128> cipher(CTR_KEY, Mode::CTR);
+
+    std::array<u8, 32> out{};
+    cipher.SetIV(GetCTRCounter());
+    cipher.Transcode(CTR_PLAINTEXT.data(), CTR_PLAINTEXT.size(), out.data(), Op::Encrypt);
+    REQUIRE(out == CTR_CIPHERTEXT);
+
+    cipher.SetIV(GetCTRCounter());
+    cipher.Transcode(CTR_CIPHERTEXT.data(), CTR_CIPHERTEXT.size(), out.data(), Op::Decrypt);
+    REQUIRE(out == CTR_PLAINTEXT);
+
+    // The counter carries on from where the previous call left it
+    cipher.SetIV(GetCTRCounter());
+    cipher.Transcode(CTR_PLAINTEXT.data(), 0x10, out.data(), Op::Encrypt);
+    cipher.Transcode(CTR_PLAINTEXT.data() + 0x10, 0x10, out.data() + 0x10, Op::Encrypt);
+    REQUIRE(out == CTR_CIPHERTEXT);
+
+    // Partial blocks only use part of the key stream
+    out.fill(0);
+    cipher.SetIV(GetCTRCounter());
+    cipher.Transcode(CTR_PLAINTEXT.data(), 7, out.data(), Op::Encrypt);
+    REQUIRE(std::equal(out.begin(), out.begin() + 7, CTR_CIPHERTEXT.begin()));
+    REQUIRE(std::all_of(out.begin() + 7, out.end(), [](u8 value) { return value == 0; }));
+}
+
+TEST_CASE("AESCipher: XTS", "[core][crypto]") {
+    AESCipher<Key256> cipher(XTS_KEY, Mode::XTS);
+
+    std::array<u8, 32> plaintext;
+    plaintext.fill(0x44);
+    std::vector<u8> tweak(0x10);
+    std::fill_n(tweak.begin(), 5, 0x33);
+
+    std::array<u8, 32> out{};
+    cipher.SetIV(tweak);
+    cipher.Transcode(plaintext.data(), plaintext.size(), out.data(), Op::Encrypt);
+    REQUIRE(out == XTS_CIPHERTEXT);
+
+    cipher.Transcode(XTS_CIPHERTEXT.data(), XTS_CIPHERTEXT.size(), out.data(), Op::Decrypt);
+    REQUIRE(out == plaintext);
+
+    // Whole sectors round trip with their index as the tweak
+    std::vector<u8> sectors(0x400);
+    for (std::size_t i = 0; i < sectors.size(); ++i) {
+        sectors[i] = static_cast<u8>(i * 7);
+    }
+    std::vector<u8> encrypted(sectors.size());
+    cipher.XTSTranscode(sectors.data(), sectors.size(), encrypted.data(), 3, 0x200, Op::Encrypt);
+    std::vector<u8> decrypted(sectors.size());
+    cipher.XTSTranscode(encrypted.data(), encrypted.size(), decrypted.data(), 3, 0x200,
+                        Op::Decrypt);
+    REQUIRE(decrypted == sectors);
+}
+
+// Run with "[benchmark]" to report the throughput of the backend used on this machine
+TEST_CASE("AESCipher: Throughput", "[.][benchmark]") {
+    constexpr std::size_t size = 64 * 1024 * 1024;
+    std::vector<u8> data(size);
+
+    const auto report = [](const char* name, auto&& func) {
+        const auto start = std::chrono::steady_clock::now();
+        func();
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::printf("%s: %.1f MB/s\n", name, size / (1024.0 * 1024.0) / elapsed.count());
+    };
+
+    std::printf("AES-NI: %s\n", AESNI::IsSupported() ? "supported" : "not supported");
+
+    AESCipher<Key128> ctr(CTR_KEY, Mode::CTR);
+    ctr.SetIV(GetCTRCounter());
+    report("CTR", [&] { ctr.Transcode(data.data(), data.size(), data.data(), Op::Decrypt); });
+
+    AESCipher<Key256> xts(XTS_KEY, Mode::XTS);
+    report("XTS", [&] {
+        xts.XTSTranscode(data.data(), data.size(), data.data(), 0, 0x4000, Op::Decrypt);
+    });
+}
+
+} // namespace Core::Crypto
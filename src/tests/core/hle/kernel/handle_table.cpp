@@ -0,0 +1,89 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "core/hle/kernel/errors.h"
+#include "core/hle/kernel/event.h"
+#include "core/hle/kernel/handle_table.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/timer.h"
+
+namespace Kernel {
+
+TEST_CASE("HandleTable: Typed lookups", "[core][kernel]") {
+    KernelCore kernel;
+    HandleTable table;
+
+    const auto event = Event::Create(kernel, ResetType::OneShot, "Event");
+    const auto timer = Timer::Create(kernel, ResetType::OneShot, "Timer");
+    const Handle event_handle = table.Create(event).Unwrap();
+    const Handle timer_handle = table.Create(timer).Unwrap();
+
+    REQUIRE(table.Get<Event>(event_handle) == event);
+    REQUIRE(table.Get<Timer>(timer_handle) == timer);
+    REQUIRE(table.GetGeneric(event_handle) == event);
+
+    // Lookups with the wrong type fail, while any waitable object is a WaitObject
+    REQUIRE(table.Get<Timer>(event_handle) == nullptr);
+    REQUIRE(table.Get<Event>(timer_handle) == nullptr);
+    REQUIRE(table.Get<WaitObject>(event_handle) == event);
+    REQUIRE(table.Get<WaitObject>(timer_handle) == timer);
+
+    // Duplicates refer to the same object through a different handle
+    const Handle duplicate = table.Duplicate(event_handle).Unwrap();
+    REQUIRE(duplicate != event_handle);
+    REQUIRE(table.Get<Event>(duplicate) == event);
+
+    // Closed handles stay invalid once their slot is reused
+    REQUIRE(table.Close(event_handle).IsSuccess());
+    REQUIRE(!table.IsValid(event_handle));
+    REQUIRE(table.Get<Event>(event_handle) == nullptr);
+    REQUIRE(table.Close(event_handle) == ERR_INVALID_HANDLE);
+    const Handle reused = table.Create(timer).Unwrap();
+    REQUIRE(table.Get<Event>(event_handle) == nullptr);
+    REQUIRE(table.Get<Timer>(reused) == timer);
+
+    table.Clear();
+    REQUIRE(table.Get<Timer>(timer_handle) == nullptr);
+    REQUIRE(table.Get<Event>(duplicate) == nullptr);
+}
+
+// Run with "[benchmark]" to report the cost of the lookups done by every SVC
+TEST_CASE("HandleTable: Lookup throughput", "[.][benchmark]") {
+    constexpr std::size_t lookups = 10000000;
+    KernelCore kernel;
+    HandleTable table;
+
+    std::vector<Handle> event_handles;
+    std::vector<Handle> timer_handles;
+    for (std::size_t i = 0; i < 64; ++i) {
+        event_handles.push_back(
+            table.Create(Event::Create(kernel, ResetType::OneShot, "Event")).Unwrap());
+        timer_handles.push_back(
+            table.Create(Timer::Create(kernel, ResetType::OneShot, "Timer")).Unwrap());
+    }
+
+    const auto report = [](const char* name, auto&& func) {
+        std::size_t found = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < lookups; ++i) {
+            found += func(i) != nullptr;
+        }
+        const std::chrono::duration<double, std::nano> elapsed =
+            std::chrono::steady_clock::now() - start;
+        std::printf("%s: %.2f ns per lookup\n", name, elapsed.count() / lookups);
+        REQUIRE(found != 0);
+    };
+
+    report("Get<Event>", [&](std::size_t i) { return table.Get<Event>(event_handles[i % 64]); });
+    report("Get<Timer>", [&](std::size_t i) { return table.Get<Timer>(timer_handles[i % 64]); });
+    report("Get<WaitObject>",
+           [&](std::size_t i) { return table.Get<WaitObject>(event_handles[i % 64]); });
+    report("GetGeneric", [&](std::size_t i) { return table.GetGeneric(event_handles[i % 64]); });
+}
+
+} // namespace Kernel
@@ -0,0 +1,288 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_funcs.h"
+#include "common/common_types.h"
+#include "core/core.h"
+#include "core/hle/ipc.h"
+#include "core/hle/ipc_helpers.h"
+#include "core/hle/kernel/client_session.h"
+#include "core/hle/kernel/event.h"
+#include "core/hle/kernel/handle_table.h"
+#include "core/hle/kernel/hle_ipc.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/kernel/server_session.h"
+#include "core/hle/service/service.h"
+#include "core/memory.h"
+#include "core/memory_setup.h"
+#include "tests/core/arm/arm_test_common.h"
+
+namespace Kernel {
+
+namespace {
+
+constexpr VAddr InputAddress = 0x100000;
+constexpr VAddr OutputAddress = 0x101000;
+constexpr std::size_t BufferSize = 0x400;
+
+constexpr int Iterations = 100000;
+
+using CommandBuffer = std::array<u32, IPC::COMMAND_BUFFER_LENGTH>;
+
+class BenchmarkService final : public Service::ServiceFramework<BenchmarkService> {
+public:
+    BenchmarkService() : ServiceFramework{"benchmark"}, output(BufferSize) {
+        // clang-format off
+        static const FunctionInfo functions[] = {
+            {0, &BenchmarkService::Echo, "Echo"},
+            {1, &BenchmarkService::ReadInput, "ReadInput"},
+            {2, &BenchmarkService::WriteOutput, "WriteOutput"},
+            {3, &BenchmarkService::EchoHandle, "EchoHandle"},
+        };
+        // clang-format on
+        RegisterHandlers(functions);
+    }
+
+private:
+    void Echo(HLERequestContext& ctx) {
+        IPC::RequestParser rp{ctx};
+        const u64 value{rp.Pop<u64>()};
+
+        IPC::ResponseBuilder rb{ctx, 4};
+        rb.Push(RESULT_SUCCESS);
+        rb.Push(value);
+    }
+
+    void ReadInput(HLERequestContext& ctx) {
+        const std::vector<u8> input{ctx.ReadBuffer()};
+
+        IPC::ResponseBuilder rb{ctx, 4};
+        rb.Push(RESULT_SUCCESS);
+        rb.Push<u64>(input.size());
+    }
+
+    void WriteOutput(HLERequestContext& ctx) {
+        ctx.WriteBuffer(output);
+
+        IPC::ResponseBuilder rb{ctx, 2};
+        rb.Push(RESULT_SUCCESS);
+    }
+
+    void EchoHandle(HLERequestContext& ctx) {
+        const auto event{ctx.NumCopyObjects() != 0 ? ctx.GetCopyObject<Event>(0)
+                                                   : ctx.GetMoveObject<Event>(0)};
+
+        IPC::ResponseBuilder rb{ctx, 2, 1};
+        rb.Push(RESULT_SUCCESS);
+        rb.PushCopyObjects(event);
+    }
+
+    std::vector<u8> output;
+};
+
+/// Shape of a synthetic request, every request carries its command id and one u64 parameter
+struct RequestLayout {
+    const char* name;
+    u32 command;
+    u32 num_x_buffers;
+    u32 num_a_buffers;
+    u32 num_b_buffers;
+    bool has_c_buffer;
+    u32 num_copy_handles;
+    u32 num_move_handles;
+    bool is_domain;
+};
+
+// clang-format off
+constexpr RequestLayout RequestLayouts[] = {
+    {"Inline data",        0, 0, 0, 0, false, 0, 0, false},
+    {"X buffer",           1, 1, 0, 0, false, 0, 0, false},
+    {"A buffer",           1, 0, 1, 0, false, 0, 0, false},
+    {"B buffer",           2, 0, 0, 1, false, 0, 0, false},
+    {"C buffer",           2, 0, 0, 0, true,  0, 0, false},
+    {"Copy handle",        3, 0, 0, 0, false, 1, 0, false},
+    {"Move handle",        3, 0, 0, 0, false, 0, 1, false},
+    {"Domain inline data", 0, 0, 0, 0, false, 0, 0, true},
+};
+// clang-format on
+
+/// Encodes a request the way the IPC library of the guest lays it out in its TLS
+CommandBuffer MakeRequest(const RequestLayout& layout, Handle handle) {
+    CommandBuffer cmd_buf{};
+    std::size_t index = 0;
+    const auto push_raw = [&cmd_buf, &index](const auto& value) {
+        std::memcpy(&cmd_buf[index], &value, sizeof(value));
+        index += sizeof(value) / sizeof(u32);
+    };
+
+    // The payload header, the command id and the parameter
+    const u32 payload_size = (sizeof(IPC::DataPayloadHeader) + 2 * sizeof(u64)) / sizeof(u32);
+    // The data size also covers the padding and the domain header
+    u32 data_size = 4 + payload_size;
+    if (layout.is_domain) {
+        data_size += sizeof(IPC::DomainMessageHeader) / sizeof(u32);
+    }
+
+    IPC::CommandHeader header{};
+    header.type.Assign(IPC::CommandType::Request);
+    header.num_buf_x_descriptors.Assign(layout.num_x_buffers);
+    header.num_buf_a_descriptors.Assign(layout.num_a_buffers);
+    header.num_buf_b_descriptors.Assign(layout.num_b_buffers);
+    header.data_size.Assign(data_size);
+    if (layout.has_c_buffer) {
+        header.buf_c_descriptor_flags.Assign(
+            IPC::CommandHeader::BufferDescriptorCFlag::OneDescriptor);
+    }
+    if (layout.num_copy_handles != 0 || layout.num_move_handles != 0) {
+        header.enable_handle_descriptor.Assign(1);
+    }
+    push_raw(header);
+
+    if (header.enable_handle_descriptor) {
+        IPC::HandleDescriptorHeader handle_descriptor_header{};
+        handle_descriptor_header.num_handles_to_copy.Assign(layout.num_copy_handles);
+        handle_descriptor_header.num_handles_to_move.Assign(layout.num_move_handles);
+        push_raw(handle_descriptor_header);
+        for (u32 i = 0; i < layout.num_copy_handles + layout.num_move_handles; ++i) {
+            push_raw(handle);
+        }
+    }
+
+    for (u32 i = 0; i < layout.num_x_buffers; ++i) {
+        IPC::BufferDescriptorX descriptor{};
+        descriptor.address_bits_0_31 = static_cast<u32>(InputAddress);
+        descriptor.size.Assign(static_cast<u32>(BufferSize));
+        push_raw(descriptor);
+    }
+    for (u32 i = 0; i < layout.num_a_buffers; ++i) {
+        IPC::BufferDescriptorABW descriptor{};
+        descriptor.address_bits_0_31 = static_cast<u32>(InputAddress);
+        descriptor.size_bits_0_31 = static_cast<u32>(BufferSize);
+        push_raw(descriptor);
+    }
+    for (u32 i = 0; i < layout.num_b_buffers; ++i) {
+        IPC::BufferDescriptorABW descriptor{};
+        descriptor.address_bits_0_31 = static_cast<u32>(OutputAddress);
+        descriptor.size_bits_0_31 = static_cast<u32>(BufferSize);
+        push_raw(descriptor);
+    }
+
+    const std::size_t buffer_c_offset = index + data_size;
+    index = (index + 3) & ~std::size_t{3};
+
+    if (layout.is_domain) {
+        IPC::DomainMessageHeader domain_header{};
+        domain_header.command.Assign(IPC::DomainMessageHeader::CommandType::SendMessage);
+        domain_header.size.Assign(payload_size * sizeof(u32));
+        domain_header.object_id = 1;
+        push_raw(domain_header);
+    }
+
+    IPC::DataPayloadHeader data_payload_header{};
+    data_payload_header.magic = Common::MakeMagic('S', 'F', 'C', 'I');
+    push_raw(data_payload_header);
+    push_raw(u64{layout.command});
+    push_raw(u64{0x0123456789ABCDEF});
+
+    if (layout.has_c_buffer) {
+        index = buffer_c_offset;
+        IPC::BufferDescriptorC descriptor{};
+        descriptor.address_bits_0_31 = static_cast<u32>(OutputAddress);
+        descriptor.size.Assign(static_cast<u32>(BufferSize));
+        push_raw(descriptor);
+    }
+    return cmd_buf;
+}
+
+/// Returns the result code written after the payload header of a response
+u32 GetResponseResult(const CommandBuffer& cmd_buf) {
+    const u32 magic = Common::MakeMagic('S', 'F', 'C', 'O');
+    for (std::size_t i = 0; i + 2 < cmd_buf.size(); ++i) {
+        if (cmd_buf[i] == magic) {
+            return cmd_buf[i + 2];
+        }
+    }
+    return ~0U;
+}
+
+/**
+ * Runs the server side of a request the way ServerSession::HandleSyncRequest does for HLE
+ * services, up to the response being written back to the command buffer of the client.
+ */
+void RoundTrip(const SharedPtr<ServerSession>& session, BenchmarkService& service,
+               CommandBuffer& cmd_buf, Process& process, HandleTable& handle_table) {
+    HLERequestContext context(session);
+    context.PopulateFromIncomingCommandBuffer(cmd_buf.data(), process, handle_table);
+    if (session->IsDomain()) {
+        context.SetDomainRequestHandlers(session->domain_request_handlers);
+    }
+    service.InvokeRequest(context);
+    context.WriteToOutgoingCommandBuffer(cmd_buf.data(), process, handle_table);
+}
+
+} // Anonymous namespace
+
+TEST_CASE("HLERequestContext: Round trip benchmark", "[.][benchmark]") {
+    ArmTests::TestEnvironment test_env{true};
+    Process& process = *Core::CurrentProcess();
+
+    // The buffers are backed by host memory, like the heap of a guest program
+    std::vector<u8> buffers(2 * Memory::PAGE_SIZE);
+    Memory::MapMemoryRegion(process.vm_manager.page_table, InputAddress, buffers.size(),
+                            buffers.data());
+
+    // Handles in requests are looked up in the table of the global kernel
+    KernelCore& kernel = Core::System::GetInstance().Kernel();
+    HandleTable& handle_table = kernel.HandleTable();
+    const auto event = Event::Create(kernel, ResetType::OneShot, "Benchmark Event");
+    const Handle event_handle = handle_table.Create(event).Unwrap();
+
+    const auto service = std::make_shared<BenchmarkService>();
+    auto [server_session, client_session] = ServerSession::CreateSessionPair(kernel, "benchmark");
+    auto [domain_server_session, domain_client_session] =
+        ServerSession::CreateSessionPair(kernel, "benchmark_domain");
+    service->ClientConnected(server_session);
+    service->ClientConnected(domain_server_session);
+    domain_server_session->domain_request_handlers = {service};
+
+    for (const RequestLayout& layout : RequestLayouts) {
+        const SharedPtr<ServerSession>& session{layout.is_domain ? domain_server_session
+                                                                 : server_session};
+        const CommandBuffer request{MakeRequest(layout, event_handle)};
+        const bool returns_handle{layout.num_copy_handles != 0 || layout.num_move_handles != 0};
+
+        CommandBuffer cmd_buf;
+        const auto start{std::chrono::steady_clock::now()};
+        for (int i = 0; i < Iterations; ++i) {
+            // The client writes the whole request to its TLS for each call
+            cmd_buf = request;
+            RoundTrip(session, *service, cmd_buf, process, handle_table);
+            if (returns_handle) {
+                // The handle of the response directly follows the handle descriptor
+                handle_table.Close(cmd_buf[3]);
+            }
+        }
+        const std::chrono::duration<double, std::nano> duration{std::chrono::steady_clock::now() -
+                                                                start};
+        REQUIRE(GetResponseResult(cmd_buf) == RESULT_SUCCESS.raw);
+
+        std::printf("%-20s %8.1f ns per round trip\n", layout.name, duration.count() / Iterations);
+    }
+
+    domain_server_session->domain_request_handlers.clear();
+    service->ClientDisconnected(domain_server_session);
+    service->ClientDisconnected(server_session);
+    handle_table.Close(event_handle);
+    Memory::UnmapRegion(process.vm_manager.page_table, InputAddress, buffers.size());
+}
+
+} // namespace Kernel
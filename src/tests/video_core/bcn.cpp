@@ -0,0 +1,153 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <utility>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "video_core/textures/bcn.h"
+
+namespace Tegra::Texture::BCn {
+
+namespace {
+
+/// Builds a 128-bit block by appending fields from the least significant bit up
+class BlockWriter {
+public:
+    void Write(u32 value, u32 count) {
+        for (u32 bit = 0; bit < count; ++bit, ++position) {
+            if ((value >> bit) & 1) {
+                block[position / 8] |= static_cast<u8>(1 << (position % 8));
+            }
+        }
+    }
+
+    const std::array<u8, 16>& GetBlock() const {
+        return block;
+    }
+
+private:
+    std::array<u8, 16> block{};
+    u32 position{};
+};
+
+std::vector<u8> DecodeBlock(const u8* block, Format format) {
+    std::vector<u8> texels(16 * GetDecodedBytesPerPixel(format));
+    Decompress(block, texels.data(), format, 4, 4);
+    return texels;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("BCn: BC1 colors", "[video_core]") {
+    // Pure red and pure blue endpoints, with the texels walking through the palette
+    const std::array<u8, 8> block{0x00, 0xF8, 0x1F, 0x00, 0xE4, 0xE4, 0xE4, 0xE4};
+    const auto texels{DecodeBlock(block.data(), Format::BC1)};
+    REQUIRE(std::vector<u8>(texels.begin(), texels.begin() + 16) ==
+            std::vector<u8>{0xFF, 0, 0, 0xFF, 0, 0, 0xFF, 0xFF, 0xAA, 0, 0x55, 0xFF, 0x55, 0,
+                            0xAA, 0xFF});
+
+    // With the endpoints swapped, the last index is transparent black
+    const std::array<u8, 8> punchthrough{0x1F, 0x00, 0x00, 0xF8, 0xFF, 0xFF, 0xFF, 0xFF};
+    const auto transparent{DecodeBlock(punchthrough.data(), Format::BC1)};
+    REQUIRE(transparent == std::vector<u8>(64, 0));
+}
+
+TEST_CASE("BCn: BC3 and BC4 interpolated components", "[video_core]") {
+    // Endpoints 255 and 0, the first texel uses index 2, (6 * 255 + 0) / 7
+    std::array<u8, 16> block{0xFF, 0x00, 0x02};
+    const auto texels{DecodeBlock(block.data(), Format::BC3)};
+    REQUIRE(texels[3] == 219);
+    REQUIRE(texels[7] == 255);
+
+    const auto reds{DecodeBlock(block.data(), Format::BC4)};
+    REQUIRE(reds[0] == 219);
+    REQUIRE(reds[1] == 0);
+    REQUIRE(reds[3] == 0xFF);
+
+    // Six value mode, with indices 6 and 7 being the minimum and the maximum
+    std::array<u8, 8> signed_block{0x81, 0x7F, 0x3E};
+    std::array<u8, 16> bc5_block{};
+    std::copy(signed_block.begin(), signed_block.end(), bc5_block.begin());
+    const auto signed_texels{DecodeBlock(bc5_block.data(), Format::BC5S)};
+    REQUIRE(static_cast<s8>(signed_texels[0]) == -127);
+    REQUIRE(static_cast<s8>(signed_texels[4]) == 127);
+}
+
+TEST_CASE("BCn: BC7 mode 6", "[video_core]") {
+    BlockWriter writer;
+    writer.Write(1 << 6, 7);
+    for (const u32 value : {100, 0, 10, 0, 50, 0, 127, 127}) {
+        writer.Write(value, 7);
+    }
+    // P-bits of both endpoints, then index 0 for every texel
+    writer.Write(1, 1);
+    writer.Write(0, 1);
+
+    const auto texels{DecodeBlock(writer.GetBlock().data(), Format::BC7)};
+    REQUIRE(texels[0] == 201);
+    REQUIRE(texels[1] == 21);
+    REQUIRE(texels[2] == 101);
+    REQUIRE(texels[3] == 255);
+}
+
+TEST_CASE("BCn: BC6H single subset", "[video_core]") {
+    // Mode 0x03 stores both endpoints with 10 bits per component
+    BlockWriter writer;
+    writer.Write(0x03, 5);
+    for (const u32 value : {1023, 512, 0, 1023, 512, 0}) {
+        writer.Write(value, 10);
+    }
+
+    const auto texels{DecodeBlock(writer.GetBlock().data(), Format::BC6HU)};
+    std::array<u16, 4> texel;
+    std::memcpy(texel.data(), texels.data(), sizeof(texel));
+    REQUIRE(texel == std::array<u16, 4>{0x7BFF, 0x3E0F, 0, 0x3C00});
+}
+
+TEST_CASE("BCn: Image edges", "[video_core]") {
+    // Blocks sticking out of the image are clipped
+    const std::array<u8, 16> blocks{0x00, 0xF8, 0x00, 0xF8, 0, 0, 0, 0,
+                                    0x1F, 0x00, 0x1F, 0x00, 0, 0, 0, 0};
+    std::vector<u8> texels(6 * 2 * 4);
+    Decompress(blocks.data(), texels.data(), Format::BC1, 6, 2);
+    REQUIRE(texels[4 * 4] == 0);
+    REQUIRE(texels[4 * 4 + 2] == 0xFF);
+    REQUIRE(texels[6 * 4] == 0xFF);
+}
+
+TEST_CASE("BCn: Decode throughput", "[.][benchmark]") {
+    constexpr u32 Size = 2048;
+    constexpr int Iterations = 8;
+
+    std::mt19937 random{0x42};
+    std::vector<u8> data(GetEncodedSize(Format::BC7, Size, Size));
+    for (auto& byte : data) {
+        byte = static_cast<u8>(random());
+    }
+
+    for (const auto& [format, name] :
+         {std::pair{Format::BC1, "BC1"}, std::pair{Format::BC2, "BC2"},
+          std::pair{Format::BC3, "BC3"}, std::pair{Format::BC4, "BC4"},
+          std::pair{Format::BC5U, "BC5U"}, std::pair{Format::BC5S, "BC5S"},
+          std::pair{Format::BC6HU, "BC6HU"}, std::pair{Format::BC6HS, "BC6HS"},
+          std::pair{Format::BC7, "BC7"}}) {
+        std::vector<u8> output(Size * Size * GetDecodedBytesPerPixel(format));
+        const auto start{std::chrono::steady_clock::now()};
+        for (int i = 0; i < Iterations; ++i) {
+            Decompress(data.data(), output.data(), format, Size, Size);
+        }
+        const std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - start};
+        const double texels{static_cast<double>(Size) * Size * Iterations};
+        std::printf("%-6s %8.1f Mtexels/s\n", name, texels / elapsed.count() / 1e6);
+    }
+}
+
+} // namespace Tegra::Texture::BCn
@@ -0,0 +1,141 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <utility>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "video_core/textures/astc.h"
+#include "video_core/textures/bcn.h"
+#include "video_core/textures/decoders.h"
+
+namespace Tegra::Texture {
+
+namespace {
+
+constexpr int Iterations = 8;
+
+std::vector<u8> MakeRandomData(std::size_t size) {
+    std::mt19937 random{0x42};
+    std::vector<u8> data(size);
+    for (auto& byte : data) {
+        byte = static_cast<u8>(random());
+    }
+    return data;
+}
+
+/// Returns the size of the swizzled image, padded to whole blocks of GOBs
+std::size_t GetSwizzledSize(u32 width, u32 height, u32 bytes_per_pixel, u32 block_height) {
+    constexpr std::size_t gob_width{64};
+    constexpr std::size_t gob_height{8};
+    const std::size_t width_in_gobs{(width * bytes_per_pixel + gob_width - 1) / gob_width};
+    const std::size_t block_rows{(height + gob_height * block_height - 1) /
+                                 (gob_height * block_height)};
+    return width_in_gobs * block_rows * 512 * block_height;
+}
+
+/// Runs the function Iterations times and prints the rate at which it went through size bytes
+template <typename Func>
+void Measure(const char* name, std::size_t size, Func&& func) {
+    const auto start{std::chrono::steady_clock::now()};
+    for (int i = 0; i < Iterations; ++i) {
+        func();
+    }
+    const std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - start};
+    const double bytes{static_cast<double>(size) * Iterations};
+    std::printf("%-40s %8.2f GB/s\n", name, bytes / elapsed.count() / 1e9);
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Decoders: Swizzle round trip", "[video_core]") {
+    // The first size goes through FastSwizzleData, the second through the per-pixel path
+    for (const u32 width : {64U, 61U}) {
+        constexpr u32 height = 45;
+        constexpr u32 bytes_per_pixel = 4;
+        for (const u32 block_height : {1U, 2U, 16U}) {
+            auto linear{MakeRandomData(width * height * bytes_per_pixel)};
+            std::vector<u8> swizzled(GetSwizzledSize(width, height, bytes_per_pixel, block_height));
+            std::vector<u8> result(linear.size());
+            CopySwizzledData(width, height, bytes_per_pixel, bytes_per_pixel, swizzled.data(),
+                             linear.data(), false, block_height);
+            CopySwizzledData(width, height, bytes_per_pixel, bytes_per_pixel, swizzled.data(),
+                             result.data(), true, block_height);
+            REQUIRE(result == linear);
+        }
+    }
+}
+
+TEST_CASE("Decoders: Swizzle throughput", "[.][benchmark]") {
+    for (const u32 size : {256U, 1024U, 4096U}) {
+        for (const u32 bytes_per_pixel : {1U, 2U, 4U, 8U, 12U, 16U}) {
+            for (const u32 block_height : {1U, 4U, 16U}) {
+                // Keep the byte size of the image the same regardless of the pixel size
+                const u32 width{size * 4 / bytes_per_pixel};
+                const std::size_t linear_size{static_cast<std::size_t>(width) * size *
+                                              bytes_per_pixel};
+                auto linear{MakeRandomData(linear_size)};
+                std::vector<u8> swizzled(
+                    GetSwizzledSize(width, size, bytes_per_pixel, block_height));
+
+                char name[64];
+                for (const bool unswizzle : {true, false}) {
+                    std::snprintf(name, sizeof(name), "%s %ux%u %ubpp bh%u",
+                                  unswizzle ? "Unswizzle" : "Swizzle", width, size,
+                                  bytes_per_pixel, block_height);
+                    Measure(name, linear_size, [&] {
+                        CopySwizzledData(width, size, bytes_per_pixel, bytes_per_pixel,
+                                         swizzled.data(), linear.data(), unswizzle, block_height);
+                    });
+                }
+                if ((width * bytes_per_pixel) % 16 == 0) {
+                    std::snprintf(name, sizeof(name), "FastSwizzleData %ux%u %ubpp bh%u", width,
+                                  size, bytes_per_pixel, block_height);
+                    Measure(name, linear_size, [&] {
+                        FastSwizzleData(width, size, bytes_per_pixel, swizzled.data(),
+                                        linear.data(), true, block_height);
+                    });
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Decoders: Compressed texture throughput", "[.][benchmark]") {
+    // Rates are given in decoded bytes, the size of the data uploaded to the GPU
+    constexpr u32 Size = 1024;
+    char name[64];
+
+    for (const u32 block_size : {4U, 8U}) {
+        const u32 blocks{Size / block_size};
+        auto data{MakeRandomData(blocks * blocks * 16)};
+        // Single partition blocks with a 4x4 grid of 2-bit weights and RGBA direct endpoints,
+        // leaving random endpoints and weights in the rest of the block
+        for (std::size_t offset = 0; offset < data.size(); offset += 16) {
+            data[offset] = 0x42;
+            data[offset + 1] = 0x80;
+            data[offset + 2] |= 0x01;
+        }
+        std::snprintf(name, sizeof(name), "ASTC %ux%u %ux%u", block_size, block_size, Size, Size);
+        Measure(name, Size * Size * 4,
+                [&] { ASTC::Decompress(data, Size, Size, block_size, block_size); });
+    }
+
+    for (const auto& [format, format_name] :
+         {std::pair{BCn::Format::BC1, "BC1"}, std::pair{BCn::Format::BC3, "BC3"},
+          std::pair{BCn::Format::BC5U, "BC5U"}, std::pair{BCn::Format::BC6HU, "BC6HU"},
+          std::pair{BCn::Format::BC7, "BC7"}}) {
+        const auto data{MakeRandomData(BCn::GetEncodedSize(format, Size, Size))};
+        const std::size_t decoded_size{Size * Size * BCn::GetDecodedBytesPerPixel(format)};
+        std::vector<u8> output(decoded_size);
+        std::snprintf(name, sizeof(name), "BCn %s %ux%u", format_name, Size, Size);
+        Measure(name, decoded_size,
+                [&] { BCn::Decompress(data.data(), output.data(), format, Size, Size); });
+    }
+}
+
+} // namespace Tegra::Texture
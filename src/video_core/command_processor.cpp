@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <memory>
@@ -9,9 +10,12 @@
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
+#include "common/tracing.h"
 #include "common/vector_math.h"
+#include "core/core.h"
 #include "core/memory.h"
-#include "core/tracer/recorder.h"
+#include "core/perf_stats.h"
+#include "core/settings.h"
 #include "video_core/command_processor.h"
 #include "video_core/engines/fermi_2d.h"
 #include "video_core/engines/kepler_memory.h"
@@ -31,8 +35,53 @@ enum class BufferMethods {
 
 MICROPROFILE_DEFINE(ProcessCommandLists, "GPU", "Execute command buffer", MP_RGB(128, 128, 192));
 
+GPU::MethodWriter GPU::GetMethodWriter(EngineID engine) {
+    // Other engines may access memory used by the draws batched by the 3D engine
+    switch (engine) {
+    case EngineID::FERMI_TWOD_A:
+        return [](GPU& gpu, u32 method, u32 value, u32) {
+            gpu.maxwell_3d->FlushDrawBatch();
+            gpu.fermi_2d->WriteReg(method, value);
+        };
+    case EngineID::MAXWELL_B:
+        return [](GPU& gpu, u32 method, u32 value, u32 remaining_params) {
+            gpu.maxwell_3d->WriteReg(method, value, remaining_params);
+        };
+    case EngineID::MAXWELL_COMPUTE_B:
+        return [](GPU& gpu, u32 method, u32 value, u32) {
+            gpu.maxwell_3d->FlushDrawBatch();
+            gpu.maxwell_compute->WriteReg(method, value);
+        };
+    case EngineID::MAXWELL_DMA_COPY_A:
+        return [](GPU& gpu, u32 method, u32 value, u32) {
+            gpu.maxwell_3d->FlushDrawBatch();
+            gpu.maxwell_dma->WriteReg(method, value);
+        };
+    case EngineID::KEPLER_INLINE_TO_MEMORY_B:
+        return [](GPU& gpu, u32 method, u32 value, u32) {
+            gpu.maxwell_3d->FlushDrawBatch();
+            gpu.kepler_memory->WriteReg(method, value);
+        };
+    default:
+        return nullptr;
+    }
+}
+
 void GPU::ProcessCommandLists(const std::vector<CommandListHeader>& commands) {
+    ProcessCommandLists(commands.data(), commands.size());
+}
+
+void GPU::ProcessCommandLists(const CommandListHeader* commands, std::size_t count) {
     MICROPROFILE_SCOPE(ProcessCommandLists);
+    YUZU_TRACE_ZONE("ProcessCommandLists");
+    auto& perf_stats{system.GetPerfStats()};
+    const Core::ScopedStageTimer stage_timer{perf_stats, Core::PerfStage::GPU};
+    perf_stats.AddCounter(Core::PerfCounter::CommandLists, count);
+
+    if (Settings::values.skip_gpu_commands) {
+        // Benchmarking the CPU side only, the engines never see the commands
+        return;
+    }
 
     auto WriteReg = [this](u32 method, u32 subchannel, u32 value, u32 remaining_params) {
         LOG_TRACE(HW_GPU,
@@ -46,6 +95,7 @@ void GPU::ProcessCommandLists(const std::vector<CommandListHeader>& commands) {
             // Bind the current subchannel to the desired engine id.
             LOG_DEBUG(HW_GPU, "Binding subchannel {} to engine {}", subchannel, value);
             bound_engines[subchannel] = static_cast<EngineID>(value);
+            bound_writers[subchannel] = GetMethodWriter(bound_engines[subchannel]);
             return;
         }
 
@@ -55,73 +105,83 @@ void GPU::ProcessCommandLists(const std::vector<CommandListHeader>& commands) {
             return;
         }
 
-        const EngineID engine = bound_engines[subchannel];
-
-        switch (engine) {
-        case EngineID::FERMI_TWOD_A:
-            fermi_2d->WriteReg(method, value);
-            break;
-        case EngineID::MAXWELL_B:
-            maxwell_3d->WriteReg(method, value, remaining_params);
-            break;
-        case EngineID::MAXWELL_COMPUTE_B:
-            maxwell_compute->WriteReg(method, value);
-            break;
-        case EngineID::MAXWELL_DMA_COPY_A:
-            maxwell_dma->WriteReg(method, value);
-            break;
-        case EngineID::KEPLER_INLINE_TO_MEMORY_B:
-            kepler_memory->WriteReg(method, value);
-            break;
-        default:
+        const MethodWriter writer = bound_writers[subchannel];
+        if (writer == nullptr) {
             UNIMPLEMENTED_MSG("Unimplemented engine");
+            return;
+        }
+        writer(*this, method, value, remaining_params);
+    };
+
+    // Dispatches a run of arguments to consecutive methods, or to the same method
+    auto WriteRegBlock = [&](u32 method, u32 subchannel, const u32* values, u32 count,
+                             bool is_increasing) {
+        if (count == 0) {
+            return;
+        }
+        ASSERT(subchannel < bound_engines.size());
+        if (method >= static_cast<u32>(BufferMethods::CountBufferMethods) &&
+            bound_engines[subchannel] == EngineID::MAXWELL_B) {
+            maxwell_3d->WriteRegBlock(method, values, count, is_increasing);
+            return;
+        }
+        for (u32 i = 0; i < count; ++i) {
+            WriteReg(is_increasing ? method + i : method, subchannel, values[i], count - i - 1);
         }
     };
 
-    for (auto entry : commands) {
+    for (std::size_t i = 0; i < count; ++i) {
+        const CommandListHeader& entry = commands[i];
         Tegra::GPUVAddr address = entry.Address();
         u32 size = entry.sz;
-        const boost::optional<VAddr> head_address = memory_manager->GpuToCpuAddress(address);
-        VAddr current_addr = *head_address;
-        while (current_addr < *head_address + size * sizeof(CommandHeader)) {
-            const CommandHeader header = {Memory::Read32(current_addr)};
-            current_addr += sizeof(u32);
+
+        // Fetch the whole command list and decode it from host memory. It's only contiguous in the
+        // GPU address space, so it's read with one copy per range of CPU memory backing it.
+        command_buffer.resize(size);
+        u8* destination = reinterpret_cast<u8*>(command_buffer.data());
+        const auto ranges = memory_manager->GpuToCpuRanges(address, size * sizeof(CommandHeader));
+        ASSERT_MSG(size == 0 || !ranges.empty(), "Unmapped command list @ {:016X}", address);
+        for (const auto& range : ranges) {
+            Memory::ReadBlock(range.cpu_addr, destination, range.size);
+            destination += range.size;
+        }
+
+        std::size_t current_word = 0;
+        while (current_word < size) {
+            const CommandHeader header = {command_buffer[current_word]};
+            ++current_word;
+
+            // A truncated command list only provides the arguments it contains
+            const u32* const args{command_buffer.data() + current_word};
+            const u32 arg_count{std::min<u32>(header.arg_count, size - current_word)};
 
             switch (header.mode.Value()) {
             case SubmissionMode::IncreasingOld:
             case SubmissionMode::Increasing: {
                 // Increase the method value with each argument.
-                for (unsigned i = 0; i < header.arg_count; ++i) {
-                    WriteReg(header.method + i, header.subchannel, Memory::Read32(current_addr),
-                             header.arg_count - i - 1);
-                    current_addr += sizeof(u32);
-                }
+                WriteRegBlock(header.method, header.subchannel, args, arg_count, true);
+                current_word += arg_count;
                 break;
             }
             case SubmissionMode::NonIncreasingOld:
             case SubmissionMode::NonIncreasing: {
                 // Use the same method value for all arguments.
-                for (unsigned i = 0; i < header.arg_count; ++i) {
-                    WriteReg(header.method, header.subchannel, Memory::Read32(current_addr),
-                             header.arg_count - i - 1);
-                    current_addr += sizeof(u32);
-                }
+                WriteRegBlock(header.method, header.subchannel, args, arg_count, false);
+                current_word += arg_count;
                 break;
             }
             case SubmissionMode::IncreaseOnce: {
                 ASSERT(header.arg_count.Value() >= 1);
+                if (arg_count == 0) {
+                    break;
+                }
 
                 // Use the original method for the first argument and then the next method for all
                 // other arguments.
-                WriteReg(header.method, header.subchannel, Memory::Read32(current_addr),
-                         header.arg_count - 1);
-                current_addr += sizeof(u32);
-
-                for (unsigned i = 1; i < header.arg_count; ++i) {
-                    WriteReg(header.method + 1, header.subchannel, Memory::Read32(current_addr),
-                             header.arg_count - i - 1);
-                    current_addr += sizeof(u32);
-                }
+                WriteReg(header.method, header.subchannel, args[0], arg_count - 1);
+                WriteRegBlock(header.method + 1, header.subchannel, args + 1, arg_count - 1,
+                              false);
+                current_word += arg_count;
                 break;
             }
             case SubmissionMode::Inline: {
@@ -134,6 +194,9 @@ void GPU::ProcessCommandLists(const std::vector<CommandListHeader>& commands) {
             }
         }
     }
+
+    // The guest may access the memory used by the batched draws once the command lists are done
+    maxwell_3d->FlushDrawBatch();
 }
 
 } // namespace Tegra
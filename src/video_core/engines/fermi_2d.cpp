@@ -4,11 +4,13 @@
 
 #include "core/memory.h"
 #include "video_core/engines/fermi_2d.h"
+#include "video_core/rasterizer_interface.h"
 #include "video_core/textures/decoders.h"
 
 namespace Tegra::Engines {
 
-Fermi2D::Fermi2D(MemoryManager& memory_manager) : memory_manager(memory_manager) {}
+Fermi2D::Fermi2D(VideoCore::RasterizerInterface& rasterizer, MemoryManager& memory_manager)
+    : memory_manager(memory_manager), rasterizer{rasterizer} {}
 
 void Fermi2D::WriteReg(u32 method, u32 value) {
     ASSERT_MSG(method < Regs::NUM_REGS,
@@ -38,17 +40,27 @@ void Fermi2D::HandleSurfaceCopy() {
     // TODO(Subv): Only raw copies are implemented.
     ASSERT(regs.operation == Regs::Operation::SrcCopy);
 
+    // Copies between surfaces the rasterizer has cached are done without going through memory
+    if (rasterizer.AccelerateSurfaceCopy(regs.src, regs.dst)) {
+        return;
+    }
+
     const VAddr source_cpu = *memory_manager.GpuToCpuAddress(source);
     const VAddr dest_cpu = *memory_manager.GpuToCpuAddress(dest);
 
     u32 src_bytes_per_pixel = RenderTargetBytesPerPixel(regs.src.format);
     u32 dst_bytes_per_pixel = RenderTargetBytesPerPixel(regs.dst.format);
+    const std::size_t src_size = src_bytes_per_pixel * regs.src.width * regs.src.height;
+    const std::size_t dst_size = dst_bytes_per_pixel * regs.dst.width * regs.dst.height;
+
+    // The source has to be up to date in memory, and the caches of the destination are outdated
+    rasterizer.FlushRegion(source_cpu, src_size);
+    rasterizer.InvalidateRegion(dest_cpu, dst_size);
 
     if (regs.src.linear == regs.dst.linear) {
         // If the input layout and the output layout are the same, just perform a raw copy.
         ASSERT(regs.src.BlockHeight() == regs.dst.BlockHeight());
-        Memory::CopyBlock(dest_cpu, source_cpu,
-                          src_bytes_per_pixel * regs.dst.width * regs.dst.height);
+        Memory::CopyBlock(dest_cpu, source_cpu, dst_size);
         return;
     }
 
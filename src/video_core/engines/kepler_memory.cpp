@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include "common/logging/log.h"
 #include "core/memory.h"
 #include "video_core/engines/kepler_memory.h"
@@ -19,7 +20,7 @@ void KeplerMemory::WriteReg(u32 method, u32 value) {
 
     switch (method) {
     case KEPLERMEMORY_REG_INDEX(exec): {
-        state.write_offset = 0;
+        StartUpload();
         break;
     }
     case KEPLERMEMORY_REG_INDEX(data): {
@@ -29,17 +30,36 @@ void KeplerMemory::WriteReg(u32 method, u32 value) {
     }
 }
 
-void KeplerMemory::ProcessData(u32 data) {
+void KeplerMemory::StartUpload() {
     ASSERT_MSG(regs.exec.linear, "Non-linear uploads are not supported");
     ASSERT(regs.dest.x == 0 && regs.dest.y == 0 && regs.dest.z == 0);
 
-    GPUVAddr address = regs.dest.Address();
-    VAddr dest_address =
-        *memory_manager.GpuToCpuAddress(address + state.write_offset * sizeof(u32));
+    state.write_offset = 0;
+    state.copy_size = regs.line_length_in * regs.line_count;
+    state.inner_buffer.clear();
+    state.inner_buffer.reserve((state.copy_size + sizeof(u32) - 1) / sizeof(u32));
+}
 
-    Memory::Write32(dest_address, data);
+void KeplerMemory::ProcessData(u32 data) {
+    // The upload is written to memory once all of its data has arrived, so that the rasterizer
+    // caches are invalidated once for the whole upload rather than once per word
+    state.inner_buffer.push_back(data);
+    if (state.inner_buffer.size() * sizeof(u32) >= state.copy_size) {
+        FinishUpload();
+    }
+}
 
-    state.write_offset++;
+void KeplerMemory::FinishUpload() {
+    const GPUVAddr address = regs.dest.Address() + state.write_offset;
+    const u64 size = std::min<u64>(state.copy_size - state.write_offset,
+                                   state.inner_buffer.size() * sizeof(u32));
+    const u8* source = reinterpret_cast<const u8*>(state.inner_buffer.data());
+    for (const auto& range : memory_manager.GpuToCpuRanges(address, size)) {
+        Memory::WriteBlock(range.cpu_addr, source, range.size);
+        source += range.size;
+    }
+    state.write_offset += static_cast<u32>(size);
+    state.inner_buffer.clear();
 }
 
 } // namespace Tegra::Engines
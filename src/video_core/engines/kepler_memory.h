@@ -5,6 +5,7 @@
 #pragma once
 
 #include <array>
+#include <vector>
 #include "common/assert.h"
 #include "common/bit_field.h"
 #include "common/common_funcs.h"
@@ -67,13 +68,20 @@ public:
     } regs{};
 
     struct {
+        /// Offset in bytes of the data that wasn't written to memory yet
         u32 write_offset = 0;
+        /// Size in bytes of the whole upload
+        u32 copy_size = 0;
+        /// Data of the upload that wasn't written to memory yet
+        std::vector<u32> inner_buffer;
     } state{};
 
 private:
     MemoryManager& memory_manager;
 
+    void StartUpload();
     void ProcessData(u32 data);
+    void FinishUpload();
 };
 
 #define ASSERT_REG_POSITION(field_name, position)                                                  \
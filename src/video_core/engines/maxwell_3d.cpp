@@ -2,8 +2,10 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <array>
 #include <cinttypes>
 #include "common/assert.h"
+#include "common/hash.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/memory.h"
@@ -19,10 +21,135 @@ namespace Engines {
 /// First register id that is actually a Macro call.
 constexpr u32 MacroRegistersStart = 0xE00;
 
-Maxwell3D::Maxwell3D(VideoCore::RasterizerInterface& rasterizer, MemoryManager& memory_manager)
-    : memory_manager(memory_manager), rasterizer{rasterizer}, macro_interpreter(*this) {}
+using DirtyTable = std::array<u8, Maxwell3D::Regs::NUM_REGS>;
+
+/// Builds the table mapping each register to the mask of the DirtyFlag groups it belongs to.
+static DirtyTable BuildDirtyTable() {
+    using DirtyFlag = Maxwell3D::DirtyFlag;
+    DirtyTable table{};
+    const auto set_range = [&table](std::size_t start, std::size_t size_in_bytes,
+                                    DirtyFlag flag) {
+        const std::size_t end{start + size_in_bytes / sizeof(u32)};
+        for (std::size_t method = start; method < end; ++method) {
+            table[method] |= static_cast<u8>(flag);
+        }
+    };
+#define SET_DIRTY(field_name, flag)                                                                \
+    set_range(MAXWELL3D_REG_INDEX(field_name), sizeof(Maxwell3D::Regs::field_name), flag)
+
+    SET_DIRTY(viewport_transform, DirtyFlag::Viewport);
+
+    // The viewport is also checked to know whether triangles are flipped
+    SET_DIRTY(viewport_transform, DirtyFlag::CullMode);
+    SET_DIRTY(cull, DirtyFlag::CullMode);
+    SET_DIRTY(screen_y_control, DirtyFlag::CullMode);
+
+    SET_DIRTY(depth_test_enable, DirtyFlag::DepthTest);
+    SET_DIRTY(depth_write_enabled, DirtyFlag::DepthTest);
+    SET_DIRTY(depth_test_func, DirtyFlag::DepthTest);
+
+    SET_DIRTY(stencil_enable, DirtyFlag::StencilTest);
+    SET_DIRTY(stencil_two_side_enable, DirtyFlag::StencilTest);
+    SET_DIRTY(stencil_front_op_fail, DirtyFlag::StencilTest);
+    SET_DIRTY(stencil_front_op_zfail, DirtyFlag::StencilTest);
+    SET_DIRTY(stencil_front_op_zpass, DirtyFlag::StencilTest);
+    SET_DIRTY(stencil_front_func_func, DirtyFlag::StencilTest);
+    SET_DIRTY(stencil_front_func_ref, DirtyFlag::StencilTest);
+    SET_DIRTY(stencil_front_func_mask, DirtyFlag::StencilTest);
+    SET_DIRTY(stencil_front_mask, DirtyFlag::StencilTest);
+    SET_DIRTY(stencil_back_op_fail, DirtyFlag::StencilTest);
+    SET_DIRTY(stencil_back_op_zfail, DirtyFlag::StencilTest);
+    SET_DIRTY(stencil_back_op_zpass, DirtyFlag::StencilTest);
+    SET_DIRTY(stencil_back_func_func, DirtyFlag::StencilTest);
+    SET_DIRTY(stencil_back_func_ref, DirtyFlag::StencilTest);
+    SET_DIRTY(stencil_back_func_mask, DirtyFlag::StencilTest);
+    SET_DIRTY(stencil_back_mask, DirtyFlag::StencilTest);
+
+    // Blending and logic ops check each other's enable register
+    SET_DIRTY(blend, DirtyFlag::Blend);
+    SET_DIRTY(independent_blend_enable, DirtyFlag::Blend);
+    SET_DIRTY(independent_blend, DirtyFlag::Blend);
+    SET_DIRTY(logic_op, DirtyFlag::Blend);
+    SET_DIRTY(logic_op, DirtyFlag::LogicOp);
+    SET_DIRTY(blend, DirtyFlag::LogicOp);
+
+#undef SET_DIRTY
+    return table;
+}
+
+/// Action triggered by writing a register, besides storing the value
+enum class MethodHandler : u8 {
+    None,
+    MacroUpload,
+    CBData,
+    CBBind,
+    DrawEnd,
+    ClearBuffers,
+    QueryGet,
+};
+
+/// How writing a register affects the draws batched by the rasterizer
+enum class BatchRule : u8 {
+    BreakOnChange, ///< Breaks the batch when the value changes
+    Captured,      ///< Captured for each draw of the batch, never breaks it
+    Topology,      ///< Only breaks the batch when the topology changes
+    Always,        ///< Breaks the batch even when the value doesn't change
+};
+
+struct MethodInfo {
+    MethodHandler handler = MethodHandler::None;
+    BatchRule batch_rule = BatchRule::BreakOnChange;
+};
+
+using MethodTable = std::array<MethodInfo, Maxwell3D::Regs::NUM_REGS>;
+
+/// Builds the table describing what writing each register does, so that it isn't switched on.
+static constexpr MethodTable BuildMethodTable() {
+    MethodTable table{};
+    const auto set = [&table](std::size_t method, MethodHandler handler, BatchRule batch_rule) {
+        table[method].handler = handler;
+        table[method].batch_rule = batch_rule;
+    };
+
+    set(MAXWELL3D_REG_INDEX(macros.data), MethodHandler::MacroUpload, BatchRule::BreakOnChange);
+
+    // Const buffer uploads write to memory, which may be read by the batched draws
+    for (std::size_t i = 0; i < Maxwell3D::Regs::NumCBData; ++i) {
+        set(MAXWELL3D_REG_INDEX(const_buffer.cb_data) + i, MethodHandler::CBData,
+            BatchRule::Always);
+    }
+
+    constexpr std::size_t cb_bind_stride{MAXWELL3D_REG_INDEX(cb_bind[1]) -
+                                         MAXWELL3D_REG_INDEX(cb_bind[0])};
+    for (std::size_t stage = 0; stage < Maxwell3D::Regs::MaxShaderStage; ++stage) {
+        set(MAXWELL3D_REG_INDEX(cb_bind[0].raw_config) + stage * cb_bind_stride,
+            MethodHandler::CBBind, BatchRule::Always);
+    }
 
-void Maxwell3D::CallMacroMethod(u32 method, std::vector<u32> parameters) {
+    set(MAXWELL3D_REG_INDEX(clear_buffers), MethodHandler::ClearBuffers, BatchRule::Always);
+    set(MAXWELL3D_REG_INDEX(query.query_get), MethodHandler::QueryGet, BatchRule::Always);
+
+    // These are captured by the rasterizer for each draw of the batch
+    set(MAXWELL3D_REG_INDEX(draw.vertex_end_gl), MethodHandler::DrawEnd, BatchRule::Captured);
+    set(MAXWELL3D_REG_INDEX(vertex_buffer.first), MethodHandler::None, BatchRule::Captured);
+    set(MAXWELL3D_REG_INDEX(vertex_buffer.count), MethodHandler::None, BatchRule::Captured);
+    set(MAXWELL3D_REG_INDEX(index_array.first), MethodHandler::None, BatchRule::Captured);
+    set(MAXWELL3D_REG_INDEX(index_array.count), MethodHandler::None, BatchRule::Captured);
+    set(MAXWELL3D_REG_INDEX(vb_element_base), MethodHandler::None, BatchRule::Captured);
+
+    // The instance is also captured for each draw, only the topology is shared
+    set(MAXWELL3D_REG_INDEX(draw.vertex_begin_gl), MethodHandler::None, BatchRule::Topology);
+    return table;
+}
+
+static constexpr MethodTable method_table{BuildMethodTable()};
+
+Maxwell3D::Maxwell3D(Core::System& system, VideoCore::RasterizerInterface& rasterizer,
+                     MemoryManager& memory_manager)
+    : memory_manager(memory_manager), system{system}, rasterizer{rasterizer},
+      macro_interpreter(*this) {}
+
+void Maxwell3D::CallMacroMethod(u32 method, const u32* parameters, std::size_t num_parameters) {
     // Reset the current macro.
     executing_macro = 0;
 
@@ -34,11 +161,28 @@ void Maxwell3D::CallMacroMethod(u32 method, std::vector<u32> parameters) {
     }
 
     // Execute the current macro.
-    macro_interpreter.Execute(macro_code->second, std::move(parameters));
+    macro_interpreter.Execute(GetMacroProgram(method, macro_code->second), parameters,
+                              num_parameters);
+}
+
+const MacroInterpreter::Program& Maxwell3D::GetMacroProgram(u32 method,
+                                                            const std::vector<u32>& code) {
+    auto& compiled_macro = compiled_macros[method];
+    if (compiled_macro) {
+        return *compiled_macro;
+    }
+
+    // Games usually upload the same set of macros several times, only decode each of them once.
+    auto& program = macro_programs[Common::ComputeHash64(code.data(), code.size() * sizeof(u32))];
+    if (!program) {
+        program = MacroInterpreter::Compile(code);
+    }
+    compiled_macro = program;
+    return *compiled_macro;
 }
 
 void Maxwell3D::WriteReg(u32 method, u32 value, u32 remaining_params) {
-    auto debug_context = Core::System::GetInstance().GetGPUDebugContext();
+    auto debug_context = system.GetGPUDebugContext();
 
     // It is an error to write to a register other than the current macro's ARG register before it
     // has finished execution.
@@ -57,11 +201,13 @@ void Maxwell3D::WriteReg(u32 method, u32 value, u32 remaining_params) {
             executing_macro = method;
         }
 
-        macro_params.push_back(value);
+        PushMacroParameters(&value, 1);
 
         // Call the macro when there are no more parameters in the command buffer
         if (remaining_params == 0) {
-            CallMacroMethod(executing_macro, std::move(macro_params));
+            CallMacroMethod(executing_macro, macro_params.data(), macro_params.size());
+            // The parameters are only used during the call, this keeps the allocation around.
+            macro_params.clear();
         }
         return;
     }
@@ -69,81 +215,133 @@ void Maxwell3D::WriteReg(u32 method, u32 value, u32 remaining_params) {
     ASSERT_MSG(method < Regs::NUM_REGS,
                "Invalid Maxwell3D register, increase the size of the Regs structure");
 
+    // Most writes store the value a register already has, those have nothing else to do
+    const MethodInfo& info{method_table[method]};
+    if (info.handler == MethodHandler::None && regs.reg_array[method] == value &&
+        debug_context == nullptr) {
+        return;
+    }
+
     if (debug_context) {
         debug_context->OnEvent(Tegra::DebugContext::Event::MaxwellCommandLoaded, nullptr);
     }
 
-    regs.reg_array[method] = value;
-
-    switch (method) {
-    case MAXWELL3D_REG_INDEX(macros.data): {
-        ProcessMacroUpload(value);
-        break;
+    // Batched draws read the registers when they are submitted, so they have to be submitted
+    // before anything they use changes.
+    if (BreaksDrawBatch(method, value)) {
+        rasterizer.FlushDrawBatch();
     }
-    case MAXWELL3D_REG_INDEX(const_buffer.cb_data[0]):
-    case MAXWELL3D_REG_INDEX(const_buffer.cb_data[1]):
-    case MAXWELL3D_REG_INDEX(const_buffer.cb_data[2]):
-    case MAXWELL3D_REG_INDEX(const_buffer.cb_data[3]):
-    case MAXWELL3D_REG_INDEX(const_buffer.cb_data[4]):
-    case MAXWELL3D_REG_INDEX(const_buffer.cb_data[5]):
-    case MAXWELL3D_REG_INDEX(const_buffer.cb_data[6]):
-    case MAXWELL3D_REG_INDEX(const_buffer.cb_data[7]):
-    case MAXWELL3D_REG_INDEX(const_buffer.cb_data[8]):
-    case MAXWELL3D_REG_INDEX(const_buffer.cb_data[9]):
-    case MAXWELL3D_REG_INDEX(const_buffer.cb_data[10]):
-    case MAXWELL3D_REG_INDEX(const_buffer.cb_data[11]):
-    case MAXWELL3D_REG_INDEX(const_buffer.cb_data[12]):
-    case MAXWELL3D_REG_INDEX(const_buffer.cb_data[13]):
-    case MAXWELL3D_REG_INDEX(const_buffer.cb_data[14]):
-    case MAXWELL3D_REG_INDEX(const_buffer.cb_data[15]): {
-        ProcessCBData(value);
-        break;
+
+    // Anything other than another upload may read the pending const buffer data
+    if (info.handler != MethodHandler::CBData) {
+        FlushCBData();
     }
-    case MAXWELL3D_REG_INDEX(cb_bind[0].raw_config): {
-        ProcessCBBind(Regs::ShaderStage::Vertex);
-        break;
+
+    static const DirtyTable dirty_table{BuildDirtyTable()};
+    if (regs.reg_array[method] != value) {
+        dirty_flags |= dirty_table[method];
     }
-    case MAXWELL3D_REG_INDEX(cb_bind[1].raw_config): {
-        ProcessCBBind(Regs::ShaderStage::TesselationControl);
+
+    regs.reg_array[method] = value;
+
+    switch (info.handler) {
+    case MethodHandler::None:
         break;
-    }
-    case MAXWELL3D_REG_INDEX(cb_bind[2].raw_config): {
-        ProcessCBBind(Regs::ShaderStage::TesselationEval);
+    case MethodHandler::MacroUpload:
+        ProcessMacroUpload(value);
         break;
-    }
-    case MAXWELL3D_REG_INDEX(cb_bind[3].raw_config): {
-        ProcessCBBind(Regs::ShaderStage::Geometry);
+    case MethodHandler::CBData:
+        ProcessCBData(value);
         break;
-    }
-    case MAXWELL3D_REG_INDEX(cb_bind[4].raw_config): {
-        ProcessCBBind(Regs::ShaderStage::Fragment);
+    case MethodHandler::CBBind: {
+        constexpr u32 cb_bind_stride{MAXWELL3D_REG_INDEX(cb_bind[1]) -
+                                     MAXWELL3D_REG_INDEX(cb_bind[0])};
+        const u32 stage{(method - MAXWELL3D_REG_INDEX(cb_bind[0].raw_config)) / cb_bind_stride};
+        ProcessCBBind(static_cast<Regs::ShaderStage>(stage));
         break;
     }
-    case MAXWELL3D_REG_INDEX(draw.vertex_end_gl): {
+    case MethodHandler::DrawEnd:
         DrawArrays();
         break;
-    }
-    case MAXWELL3D_REG_INDEX(clear_buffers): {
+    case MethodHandler::ClearBuffers:
         ProcessClearBuffers();
         break;
-    }
-    case MAXWELL3D_REG_INDEX(query.query_get): {
+    case MethodHandler::QueryGet:
         ProcessQueryGet();
         break;
     }
-    default:
-        break;
-    }
 
     if (debug_context) {
         debug_context->OnEvent(Tegra::DebugContext::Event::MaxwellCommandProcessed, nullptr);
     }
 }
 
+void Maxwell3D::WriteRegBlock(u32 method, const u32* values, u32 count, bool is_increasing) {
+    // Const buffer uploads make up the longest runs, they are written to memory in one go. Each
+    // CB_DATA register appends to the const buffer, so the increasing and non increasing forms
+    // do the same.
+    constexpr u32 first_cb_data{MAXWELL3D_REG_INDEX(const_buffer.cb_data[0])};
+    constexpr u32 last_cb_data{MAXWELL3D_REG_INDEX(const_buffer.cb_data[15])};
+    const u32 last_method{is_increasing ? method + count - 1 : method};
+    const bool is_cb_data{method >= first_cb_data && last_method <= last_cb_data};
+    if (is_cb_data && count > 1 && executing_macro == 0 &&
+        system.GetGPUDebugContext() == nullptr) {
+        rasterizer.FlushDrawBatch();
+        ProcessCBDataBlock(values, count);
+        regs.reg_array[last_method] = values[count - 1];
+        return;
+    }
+
+    // The arguments of a macro call are usually written in a single run after its method, the
+    // whole run is appended at once and the macro is called right away.
+    if (!is_increasing && executing_macro != 0 && method == executing_macro + 1) {
+        PushMacroParameters(values, count);
+        CallMacroMethod(executing_macro, macro_params.data(), macro_params.size());
+        macro_params.clear();
+        return;
+    }
+
+    for (u32 i = 0; i < count; ++i) {
+        WriteReg(is_increasing ? method + i : method, values[i], count - i - 1);
+    }
+}
+
+void Maxwell3D::PushMacroParameters(const u32* values, std::size_t count) {
+    if (macro_params.size() + count > macro_params.capacity()) {
+        ++macro_parameter_allocations;
+    }
+    macro_params.insert(macro_params.end(), values, values + count);
+}
+
+bool Maxwell3D::BreaksDrawBatch(u32 method, u32 value) const {
+    switch (method_table[method].batch_rule) {
+    case BatchRule::Captured:
+        return false;
+    case BatchRule::Topology: {
+        constexpr u32 topology_mask{0xFFFF};
+        return ((regs.reg_array[method] ^ value) & topology_mask) != 0;
+    }
+    case BatchRule::Always:
+        return true;
+    case BatchRule::BreakOnChange:
+    default:
+        return regs.reg_array[method] != value;
+    }
+}
+
+void Maxwell3D::FlushDrawBatch() {
+    FlushCBData();
+    rasterizer.FlushDrawBatch();
+}
+
 void Maxwell3D::ProcessMacroUpload(u32 data) {
     // Store the uploaded macro code to interpret them when they're called.
-    auto& macro = uploaded_macros[regs.macros.entry * 2 + MacroRegistersStart];
+    const u32 method{regs.macros.entry * 2 + MacroRegistersStart};
+    auto& macro = uploaded_macros[method];
     macro.push_back(data);
+
+    // The code of the macro changed, it has to be decoded again the next time it's called.
+    compiled_macros.erase(method);
 }
 
 void Maxwell3D::ProcessQueryGet() {
@@ -156,7 +354,6 @@ void Maxwell3D::ProcessQueryGet() {
     ASSERT_MSG(regs.query.query_get.unit == Regs::QueryUnit::Crop,
                "Units other than CROP are unimplemented");
 
-    u32 value = Memory::Read32(*address);
     u64 result = 0;
 
     // TODO(Subv): Support the other query variables
@@ -165,6 +362,16 @@ void Maxwell3D::ProcessQueryGet() {
         // This seems to actually write the query sequence to the query address.
         result = regs.query.query_sequence;
         break;
+    case Regs::QuerySelect::SamplesPassed:
+        // The counter is only known once the previous draws completed on the host GPU. The
+        // rasterizer writes it then, so the guest gets it without the GPU being waited on here.
+        if (regs.query.query_get.mode != Regs::QueryMode::Sync &&
+            rasterizer.AccelerateSamplesPassedQuery(
+                *address, regs.query.query_get.short_query != 0, CoreTiming::GetTicks())) {
+            return;
+        }
+        UNIMPLEMENTED_MSG("Samples passed queries need the rasterizer");
+        break;
     default:
         UNIMPLEMENTED_MSG("Unimplemented query select type {}",
                           static_cast<u32>(regs.query.query_get.select.Value()));
@@ -210,7 +417,7 @@ void Maxwell3D::DrawArrays() {
               regs.vertex_buffer.count);
     ASSERT_MSG(!(regs.index_array.count && regs.vertex_buffer.count), "Both indexed and direct?");
 
-    auto debug_context = Core::System::GetInstance().GetGPUDebugContext();
+    auto debug_context = system.GetGPUDebugContext();
 
     if (debug_context) {
         debug_context->OnEvent(Tegra::DebugContext::Event::IncomingPrimitiveBatch, nullptr);
@@ -262,20 +469,51 @@ void Maxwell3D::ProcessCBBind(Regs::ShaderStage stage) {
 }
 
 void Maxwell3D::ProcessCBData(u32 value) {
-    // Write the input value to the current const buffer at the current position.
-    GPUVAddr buffer_address = regs.const_buffer.BufferAddress();
+    ProcessCBDataBlock(&value, 1);
+}
+
+void Maxwell3D::ProcessCBDataBlock(const u32* values, u32 count) {
+    // Write the input values to the current const buffer at the current position.
+    const GPUVAddr buffer_address = regs.const_buffer.BufferAddress();
     ASSERT(buffer_address != 0);
 
     // Don't allow writing past the end of the buffer.
-    ASSERT(regs.const_buffer.cb_pos + sizeof(u32) <= regs.const_buffer.cb_size);
+    const u32 size{count * static_cast<u32>(sizeof(u32))};
+    ASSERT(regs.const_buffer.cb_pos + size <= regs.const_buffer.cb_size);
+
+    // The data is kept until something else is written, appending to the pending data when it
+    // continues it
+    const GPUVAddr address{buffer_address + regs.const_buffer.cb_pos};
+    auto& pending = pending_cb_data;
+    const GPUVAddr pending_end{pending.address + pending.values.size() * sizeof(u32)};
+    if (!pending.values.empty() && pending_end != address) {
+        FlushCBData();
+    }
+    if (pending.values.empty()) {
+        pending.address = address;
+    }
+    pending.values.insert(pending.values.end(), values, values + count);
 
-    boost::optional<VAddr> address =
-        memory_manager.GpuToCpuAddress(buffer_address + regs.const_buffer.cb_pos);
+    // Increment the current buffer position.
+    regs.const_buffer.cb_pos = regs.const_buffer.cb_pos + size;
+}
 
-    Memory::Write32(*address, value);
+void Maxwell3D::FlushCBData() {
+    auto& pending = pending_cb_data;
+    if (pending.values.empty()) {
+        return;
+    }
 
-    // Increment the current buffer position.
-    regs.const_buffer.cb_pos = regs.const_buffer.cb_pos + 4;
+    // The data is written with one copy per range of guest memory backing it
+    const u64 size{pending.values.size() * sizeof(u32)};
+    const auto ranges = memory_manager.GpuToCpuRanges(pending.address, size);
+    ASSERT_MSG(!ranges.empty(), "Unmapped const buffer @ {:016X}", pending.address);
+    const u8* source = reinterpret_cast<const u8*>(pending.values.data());
+    for (const auto& range : ranges) {
+        Memory::WriteBlock(range.cpu_addr, source, range.size);
+        source += range.size;
+    }
+    pending.values.clear();
 }
 
 Texture::TICEntry Maxwell3D::GetTICEntry(u32 tic_index) const {
@@ -5,8 +5,10 @@
 #pragma once
 
 #include <array>
+#include <memory>
 #include <unordered_map>
 #include <vector>
+#include <boost/container/small_vector.hpp>
 #include "common/assert.h"
 #include "common/bit_field.h"
 #include "common/common_funcs.h"
@@ -17,6 +19,10 @@
 #include "video_core/memory_manager.h"
 #include "video_core/textures/texture.h"
 
+namespace Core {
+class System;
+}
+
 namespace VideoCore {
 class RasterizerInterface;
 }
@@ -28,7 +34,8 @@ namespace Tegra::Engines {
 
 class Maxwell3D final {
 public:
-    explicit Maxwell3D(VideoCore::RasterizerInterface& rasterizer, MemoryManager& memory_manager);
+    explicit Maxwell3D(Core::System& system, VideoCore::RasterizerInterface& rasterizer,
+                       MemoryManager& memory_manager);
     ~Maxwell3D() = default;
 
     /// Register structure of the Maxwell3D engine.
@@ -67,6 +74,7 @@ public:
 
         enum class QuerySelect : u32 {
             Zero = 0,
+            SamplesPassed = 2,
         };
 
         enum class QuerySyncCondition : u32 {
@@ -81,6 +89,8 @@ public:
             TesselationEval = 3,
             Geometry = 4,
             Fragment = 5,
+            // Not part of the 3D pipeline, the kernels of MaxwellCompute are built as this program
+            Compute = 6,
         };
 
         enum class ShaderStage : u32 {
@@ -89,6 +99,8 @@ public:
             TesselationEval = 2,
             Geometry = 3,
             Fragment = 4,
+            // Not part of the 3D pipeline, the kernels of MaxwellCompute are decompiled as it
+            Compute = 5,
         };
 
         struct VertexAttribute {
@@ -915,12 +927,55 @@ public:
     State state{};
     MemoryManager& memory_manager;
 
+    /// Groups of registers the rasterizer syncs to its host state together
+    enum class DirtyFlag : u32 {
+        Viewport = 1 << 0,
+        CullMode = 1 << 1,
+        DepthTest = 1 << 2,
+        StencilTest = 1 << 3,
+        Blend = 1 << 4,
+        LogicOp = 1 << 5,
+    };
+
+    /**
+     * Returns whether any register of the specified group was modified since the last time this
+     * was called for the same group. All groups start as modified.
+     */
+    bool ConsumeDirtyFlag(DirtyFlag flag) {
+        const u32 mask{static_cast<u32>(flag)};
+        const bool is_dirty{(dirty_flags & mask) != 0};
+        dirty_flags &= ~mask;
+        return is_dirty;
+    }
+
     /// Reads a register value located at the input method address
     u32 GetRegisterValue(u32 method) const;
 
     /// Write the value to the register identified by method.
     void WriteReg(u32 method, u32 value, u32 remaining_params);
 
+    /**
+     * Writes a run of values from a command list.
+     * @param method Register written by the first value
+     * @param values Values to write, the last one is the last parameter of the command
+     * @param count Number of values to write
+     * @param is_increasing Whether each value is written to the register after the previous one
+     */
+    void WriteRegBlock(u32 method, const u32* values, u32 count, bool is_increasing);
+
+    /// Submits the draws the rasterizer batched so far, has to be called before other engines run
+    void FlushDrawBatch();
+
+    /**
+     * Returns the number of times the macro parameters outgrew their inline storage and had to be
+     * allocated since the last call, it's meant to be called once per frame.
+     */
+    u32 GetAndResetMacroParameterAllocations() {
+        const u32 allocations{macro_parameter_allocations};
+        macro_parameter_allocations = 0;
+        return allocations;
+    }
+
     /// Returns a list of enabled textures for the specified shader stage.
     std::vector<Texture::FullTextureInfo> GetStageTextures(Regs::ShaderStage stage) const;
 
@@ -928,18 +983,41 @@ public:
     Texture::FullTextureInfo GetStageTexture(Regs::ShaderStage stage, std::size_t offset) const;
 
 private:
+    Core::System& system;
     VideoCore::RasterizerInterface& rasterizer;
 
     std::unordered_map<u32, std::vector<u32>> uploaded_macros;
 
+    /// Decoded programs of the uploaded macros, indexed by macro method. Entries are created the
+    /// first time a macro is called and dropped when its code is uploaded again.
+    std::unordered_map<u32, std::shared_ptr<const MacroInterpreter::Program>> compiled_macros;
+    /// Decoded programs indexed by the hash of their code, so that macros uploaded again with the
+    /// same code aren't decoded twice.
+    std::unordered_map<u64, std::shared_ptr<const MacroInterpreter::Program>> macro_programs;
+
+    /// Number of parameters of a macro call that are stored without allocating memory.
+    static constexpr std::size_t MaxInlineMacroParameters = 256;
+
     /// Macro method that is currently being executed / being fed parameters.
     u32 executing_macro = 0;
     /// Parameters that have been submitted to the macro call so far.
-    std::vector<u32> macro_params;
+    boost::container::small_vector<u32, MaxInlineMacroParameters> macro_params;
+
+    /// Const buffer data that was uploaded but not written to memory yet. Uploads usually write
+    /// whole structures a few words at a time, so consecutive ones are written in a single block.
+    struct {
+        GPUVAddr address = 0;
+        std::vector<u32> values;
+    } pending_cb_data;
+    /// Number of times macro_params had to grow since it was last reported.
+    u32 macro_parameter_allocations = 0;
 
     /// Interpreter for the macro codes uploaded to the GPU.
     MacroInterpreter macro_interpreter;
 
+    /// Mask of the DirtyFlag groups that were modified since the rasterizer last synced them.
+    u32 dirty_flags = ~0U;
+
     /// Retrieves information about a specific TIC entry from the TIC buffer.
     Texture::TICEntry GetTICEntry(u32 tic_index) const;
 
@@ -950,8 +1028,15 @@ private:
      * Call a macro on this engine.
      * @param method Method to call
      * @param parameters Arguments to the method call
+     * @param num_parameters Number of arguments to the method call
      */
-    void CallMacroMethod(u32 method, std::vector<u32> parameters);
+    void CallMacroMethod(u32 method, const u32* parameters, std::size_t num_parameters);
+
+    /// Appends parameters to the macro call that is currently being fed parameters.
+    void PushMacroParameters(const u32* values, std::size_t count);
+
+    /// Returns the decoded program of an uploaded macro, decoding it if it wasn't already.
+    const MacroInterpreter::Program& GetMacroProgram(u32 method, const std::vector<u32>& code);
 
     /// Handles writes to the macro uploading registers.
     void ProcessMacroUpload(u32 data);
@@ -965,11 +1050,20 @@ private:
     /// Handles a write to the CB_DATA[i] register.
     void ProcessCBData(u32 value);
 
+    /// Handles consecutive writes to the CB_DATA registers.
+    void ProcessCBDataBlock(const u32* values, u32 count);
+
+    /// Writes the const buffer data that was uploaded since the last call to memory.
+    void FlushCBData();
+
     /// Handles a write to the CB_BIND register.
     void ProcessCBBind(Regs::ShaderStage stage);
 
     /// Handles a write to the VERTEX_END_GL register, triggering a draw.
     void DrawArrays();
+
+    /// Returns whether writing the value to the register changes state used by batched draws.
+    bool BreaksDrawBatch(u32 method, u32 value) const;
 };
 
 #define ASSERT_REG_POSITION(field_name, position)                                                  \
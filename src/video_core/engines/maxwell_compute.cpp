@@ -2,12 +2,88 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include "common/logging/log.h"
+#include "core/memory.h"
 #include "video_core/engines/maxwell_compute.h"
+#include "video_core/rasterizer_interface.h"
 
-namespace Tegra {
-namespace Engines {
+namespace Tegra::Engines {
 
-void MaxwellCompute::WriteReg(u32 method, u32 value) {}
+MaxwellCompute::MaxwellCompute(VideoCore::RasterizerInterface& rasterizer,
+                               MemoryManager& memory_manager)
+    : memory_manager{memory_manager}, rasterizer{rasterizer} {}
 
-} // namespace Engines
-} // namespace Tegra
+MaxwellCompute::~MaxwellCompute() = default;
+
+void MaxwellCompute::WriteReg(u32 method, u32 value) {
+    ASSERT_MSG(method < Regs::NUM_REGS,
+               "Invalid MaxwellCompute register, increase the size of the Regs structure");
+
+    regs.reg_array[method] = value;
+
+    switch (method) {
+    case MAXWELL_COMPUTE_REG_INDEX(exec_upload): {
+        StartUpload();
+        break;
+    }
+    case MAXWELL_COMPUTE_REG_INDEX(data_upload): {
+        ProcessData(value);
+        break;
+    }
+    case MAXWELL_COMPUTE_REG_INDEX(launch): {
+        ProcessLaunch();
+        break;
+    }
+    }
+}
+
+void MaxwellCompute::StartUpload() {
+    ASSERT_MSG(regs.exec_upload.linear, "Non-linear uploads are not supported");
+    ASSERT(regs.upload_dest.x == 0 && regs.upload_dest.y == 0 && regs.upload_dest.z == 0);
+
+    upload_state.write_offset = 0;
+    upload_state.copy_size = regs.upload_line_length_in * regs.upload_line_count;
+    upload_state.inner_buffer.clear();
+    upload_state.inner_buffer.reserve((upload_state.copy_size + sizeof(u32) - 1) / sizeof(u32));
+}
+
+void MaxwellCompute::ProcessData(u32 data) {
+    upload_state.inner_buffer.push_back(data);
+    if (upload_state.inner_buffer.size() * sizeof(u32) >= upload_state.copy_size) {
+        FinishUpload();
+    }
+}
+
+void MaxwellCompute::FinishUpload() {
+    const GPUVAddr address = regs.upload_dest.Address() + upload_state.write_offset;
+    const u64 size = std::min<u64>(upload_state.copy_size - upload_state.write_offset,
+                                   upload_state.inner_buffer.size() * sizeof(u32));
+    const u8* source = reinterpret_cast<const u8*>(upload_state.inner_buffer.data());
+    for (const auto& range : memory_manager.GpuToCpuRanges(address, size)) {
+        // Uploads may overwrite const buffers the rasterizer has cached
+        rasterizer.InvalidateRegion(range.cpu_addr, range.size);
+        Memory::WriteBlock(range.cpu_addr, source, range.size);
+        source += range.size;
+    }
+    upload_state.write_offset += static_cast<u32>(size);
+    upload_state.inner_buffer.clear();
+}
+
+void MaxwellCompute::ProcessLaunch() {
+    const GPUVAddr launch_desc_loc = static_cast<GPUVAddr>(regs.launch_desc_loc) << 8;
+    u8* destination = reinterpret_cast<u8*>(&launch_description);
+    for (const auto& range : memory_manager.GpuToCpuRanges(launch_desc_loc, sizeof(LaunchParams))) {
+        Memory::ReadBlock(range.cpu_addr, destination, range.size);
+        destination += range.size;
+    }
+
+    LOG_TRACE(HW_GPU, "Compute launch of {}x{}x{} blocks of {}x{}x{} threads",
+              launch_description.grid_dim_x.Value(), launch_description.grid_dim_y.Value(),
+              launch_description.grid_dim_z.Value(), launch_description.block_dim_x.Value(),
+              launch_description.block_dim_y.Value(), launch_description.block_dim_z.Value());
+
+    rasterizer.DispatchCompute(regs.code_loc.Address() + launch_description.program_start);
+}
+
+} // namespace Tegra::Engines
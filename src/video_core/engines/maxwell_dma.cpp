@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include "common/alignment.h"
 #include "core/memory.h"
 #include "video_core/engines/maxwell_dma.h"
 #include "video_core/textures/decoders.h"
@@ -31,7 +32,7 @@ void MaxwellDMA::WriteReg(u32 method, u32 value) {
 }
 
 void MaxwellDMA::HandleCopy() {
-    LOG_WARNING(HW_GPU, "Requested a DMA copy");
+    LOG_TRACE(HW_GPU, "Requested a DMA copy");
 
     const GPUVAddr source = regs.src_address.Address();
     const GPUVAddr dest = regs.dst_address.Address();
@@ -50,15 +51,23 @@ void MaxwellDMA::HandleCopy() {
     ASSERT(regs.dst_params.pos_y == 0);
 
     if (regs.exec.is_dst_linear == regs.exec.is_src_linear) {
-        std::size_t copy_size = regs.x_count;
-
         // When the enable_2d bit is disabled, the copy is performed as if we were copying a 1D
         // buffer of length `x_count`, otherwise we copy a 2D buffer of size (x_count, y_count).
-        if (regs.exec.enable_2d) {
-            copy_size = copy_size * regs.y_count;
+        if (!regs.exec.enable_2d) {
+            Memory::CopyBlock(dest_cpu, source_cpu, regs.x_count);
+            return;
         }
 
-        Memory::CopyBlock(dest_cpu, source_cpu, copy_size);
+        // Rows that are packed in both buffers are copied at once, otherwise each row is copied
+        // with its own pitch
+        if (regs.src_pitch == regs.x_count && regs.dst_pitch == regs.x_count) {
+            Memory::CopyBlock(dest_cpu, source_cpu, std::size_t{regs.x_count} * regs.y_count);
+            return;
+        }
+        for (u32 row = 0; row < regs.y_count; ++row) {
+            Memory::CopyBlock(dest_cpu + u64{row} * regs.dst_pitch,
+                              source_cpu + u64{row} * regs.src_pitch, regs.x_count);
+        }
         return;
     }
 
@@ -66,12 +75,30 @@ void MaxwellDMA::HandleCopy() {
     u8* src_buffer = Memory::GetPointer(source_cpu);
     u8* dst_buffer = Memory::GetPointer(dest_cpu);
 
+    // The swizzled data is accessed straight from memory, so the rasterizer caches have to write
+    // back the source and drop the destination first. A cached destination texture is reloaded
+    // from memory the next time it's used.
+    const auto SwizzledSize = [](const Regs::Parameters& params) {
+        return Common::AlignUp(u64{params.size_x}, 64) *
+               Common::AlignUp(u64{params.size_y}, 8 * params.BlockHeight());
+    };
+
     if (regs.exec.is_dst_linear && !regs.exec.is_src_linear) {
         // If the input is tiled and the output is linear, deswizzle the input and copy it over.
+        Memory::RasterizerFlushVirtualRegion(source_cpu, SwizzledSize(regs.src_params),
+                                             Memory::FlushMode::Flush);
+        Memory::RasterizerFlushVirtualRegion(
+            dest_cpu, u64{regs.src_params.size_x} * regs.src_params.size_y,
+            Memory::FlushMode::Invalidate);
         Texture::CopySwizzledData(regs.src_params.size_x, regs.src_params.size_y, 1, 1, src_buffer,
                                   dst_buffer, true, regs.src_params.BlockHeight());
     } else {
         // If the input is linear and the output is tiled, swizzle the input and copy it over.
+        Memory::RasterizerFlushVirtualRegion(
+            source_cpu, u64{regs.dst_params.size_x} * regs.dst_params.size_y,
+            Memory::FlushMode::Flush);
+        Memory::RasterizerFlushVirtualRegion(dest_cpu, SwizzledSize(regs.dst_params),
+                                             Memory::FlushMode::Invalidate);
         Texture::CopySwizzledData(regs.dst_params.size_x, regs.dst_params.size_y, 1, 1, dst_buffer,
                                   src_buffer, false, regs.dst_params.BlockHeight());
     }
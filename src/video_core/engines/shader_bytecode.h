@@ -329,6 +329,19 @@ struct IpaMode {
     }
 };
 
+/// System values read by the S2R instruction
+enum class SystemVariable : u64 {
+    LaneId = 0x00,
+    InvocationId = 0x11,
+    Tid = 0x20,
+    TidX = 0x21,
+    TidY = 0x22,
+    TidZ = 0x23,
+    CtaIdX = 0x25,
+    CtaIdY = 0x26,
+    CtaIdZ = 0x27,
+};
+
 union Instruction {
     Instruction& operator=(const Instruction& instr) {
         value = instr.value;
@@ -346,6 +359,7 @@ union Instruction {
     BitField<19, 1, u64> negate_pred;
     BitField<20, 8, Register> gpr20;
     BitField<20, 4, SubOp> sub_op;
+    BitField<20, 8, SystemVariable> sys20;
     BitField<28, 8, Register> gpr28;
     BitField<39, 8, Register> gpr39;
     BitField<48, 16, u64> opcode;
@@ -964,6 +978,7 @@ public:
         TMML,   // Texture Mip Map Level
         EXIT,
         IPA,
+        S2R, // Move a system value to a register
         FFMA_IMM, // Fused Multiply and Add
         FFMA_CR,
         FFMA_RC,
@@ -1100,6 +1115,10 @@ public:
             return mask;
         }
 
+        u16 GetExpected() const {
+            return expected;
+        }
+
         Id GetId() const {
             return id;
         }
@@ -1127,16 +1146,41 @@ public:
 
     static boost::optional<const Matcher&> Decode(Instruction instr) {
         static const auto table{GetDecodeTable()};
+        static const auto lookup{GetDecodeLookup(table)};
 
-        const auto matches_instruction = [instr](const auto& matcher) {
-            return matcher.Matches(static_cast<u16>(instr.opcode));
-        };
-
-        auto iter = std::find_if(table.begin(), table.end(), matches_instruction);
-        return iter != table.end() ? boost::optional<const Matcher&>(*iter) : boost::none;
+        const u16 index = lookup[static_cast<u16>(instr.opcode)];
+        return index != INVALID_MATCHER ? boost::optional<const Matcher&>(table[index])
+                                        : boost::none;
     }
 
 private:
+    static constexpr u16 INVALID_MATCHER = 0xFFFF;
+
+    /**
+     * Maps every value of the opcode bits to the index of the first matcher of the table that
+     * matches it, so that decoding an instruction is a single lookup.
+     */
+    static std::vector<u16> GetDecodeLookup(const std::vector<Matcher>& table) {
+        ASSERT(table.size() < INVALID_MATCHER);
+        std::vector<u16> lookup(0x10000, INVALID_MATCHER);
+
+        // Going from the least specific matcher to the most specific one, each matcher overwrites
+        // the opcodes the ones after it in the table matched as well
+        for (std::size_t i = table.size(); i-- > 0;) {
+            const u16 free_bits = static_cast<u16>(~table[i].GetMask());
+            // Enumerate every combination of the bits the matcher ignores
+            u16 bits = free_bits;
+            while (true) {
+                lookup[table[i].GetExpected() | bits] = static_cast<u16>(i);
+                if (bits == 0) {
+                    break;
+                }
+                bits = (bits - 1) & free_bits;
+            }
+        }
+        return lookup;
+    }
+
     struct Detail {
     private:
         static constexpr std::size_t opcode_bitsize = 16;
@@ -1198,6 +1242,7 @@ private:
             INST("1101111101011---", Id::TMML, Type::Memory, "TMML"),
             INST("111000110000----", Id::EXIT, Type::Trivial, "EXIT"),
             INST("11100000--------", Id::IPA, Type::Trivial, "IPA"),
+            INST("1111000011001---", Id::S2R, Type::Trivial, "S2R"),
             INST("0011001-1-------", Id::FFMA_IMM, Type::Ffma, "FFMA_IMM"),
             INST("010010011-------", Id::FFMA_CR, Type::Ffma, "FFMA_CR"),
             INST("010100011-------", Id::FFMA_RC, Type::Ffma, "FFMA_RC"),
@@ -3,13 +3,17 @@
 // Refer to the license.txt file included.
 
 #include "common/assert.h"
+#include "core/settings.h"
+#include "core/tracer/recorder.h"
 #include "video_core/engines/fermi_2d.h"
 #include "video_core/engines/kepler_memory.h"
 #include "video_core/engines/maxwell_3d.h"
 #include "video_core/engines/maxwell_compute.h"
 #include "video_core/engines/maxwell_dma.h"
 #include "video_core/gpu.h"
+#include "video_core/gpu_thread.h"
 #include "video_core/rasterizer_interface.h"
+#include "video_core/renderer_base.h"
 
 namespace Tegra {
 
@@ -22,17 +26,198 @@ u32 FramebufferConfig::BytesPerPixel(PixelFormat format) {
     UNREACHABLE();
 }
 
-GPU::GPU(VideoCore::RasterizerInterface& rasterizer) {
+GPU::GPU(Core::System& system, VideoCore::RendererBase& renderer)
+    : system{system}, renderer{renderer} {
+    auto& rasterizer{renderer.Rasterizer()};
     memory_manager = std::make_unique<Tegra::MemoryManager>();
-    maxwell_3d = std::make_unique<Engines::Maxwell3D>(rasterizer, *memory_manager);
-    fermi_2d = std::make_unique<Engines::Fermi2D>(*memory_manager);
-    maxwell_compute = std::make_unique<Engines::MaxwellCompute>();
+    maxwell_3d = std::make_unique<Engines::Maxwell3D>(system, rasterizer, *memory_manager);
+    fermi_2d = std::make_unique<Engines::Fermi2D>(rasterizer, *memory_manager);
+    maxwell_compute = std::make_unique<Engines::MaxwellCompute>(rasterizer, *memory_manager);
     maxwell_dma = std::make_unique<Engines::MaxwellDMA>(*memory_manager);
     kepler_memory = std::make_unique<Engines::KeplerMemory>(*memory_manager);
+
+    if (Settings::values.use_asynchronous_gpu_emulation) {
+        gpu_thread = std::make_unique<VideoCommon::GPUThread::ThreadManager>(renderer, *this);
+    }
 }
 
 GPU::~GPU() = default;
 
+void GPU::PushGPUEntries(std::vector<CommandListHeader>&& entries) {
+    if (trace_recorder) {
+        trace_recorder->RecordSubmit(*memory_manager, entries.data(), entries.size());
+    }
+    if (gpu_thread) {
+        gpu_thread->SubmitList(std::move(entries));
+    } else {
+        ProcessCommandLists(entries);
+    }
+}
+
+void GPU::PushGPUEntries(const CommandListHeader* entries, std::size_t count) {
+    if (trace_recorder) {
+        trace_recorder->RecordSubmit(*memory_manager, entries, count);
+    }
+    if (gpu_thread) {
+        gpu_thread->SubmitList({entries, entries + count});
+    } else {
+        ProcessCommandLists(entries, count);
+    }
+}
+
+u64 GPU::SwapBuffers(boost::optional<const FramebufferConfig&> framebuffer) {
+    if (trace_recorder) {
+        trace_recorder->RecordSwapBuffers(framebuffer);
+    }
+    if (gpu_thread) {
+        return gpu_thread->SwapBuffers(framebuffer);
+    }
+    renderer.SwapBuffers(framebuffer);
+    return 0;
+}
+
+void GPU::WaitForFence(u64 fence) {
+    if (fence != 0 && UseGPUThread()) {
+        gpu_thread->WaitForFence(fence);
+    }
+}
+
+/// Returns whether the value of a syncpoint is past the specified one, handling wrap-around
+static bool IsSyncPointPast(u32 current, u32 value) {
+    return static_cast<s32>(current - value) >= 0;
+}
+
+u32 GPU::IncrementSyncPoint(u32 syncpoint_id) {
+    ASSERT(syncpoint_id < NumSyncPoints);
+    const u32 value{++syncpoint_max_values[syncpoint_id]};
+    if (UseGPUThread()) {
+        gpu_thread->IncrementSyncPoint(syncpoint_id);
+    } else {
+        SignalSyncPoint(syncpoint_id);
+    }
+    return value;
+}
+
+void GPU::SignalSyncPoint(u32 syncpoint_id) {
+    {
+        std::lock_guard<std::mutex> lock{syncpoint_mutex};
+        syncpoints[syncpoint_id].fetch_add(1, std::memory_order_release);
+    }
+    syncpoint_cv.notify_all();
+}
+
+u32 GPU::GetSyncPointValue(u32 syncpoint_id) const {
+    ASSERT(syncpoint_id < NumSyncPoints);
+    return syncpoints[syncpoint_id].load(std::memory_order_acquire);
+}
+
+bool GPU::IsSyncPointReached(u32 syncpoint_id, u32 value) const {
+    ASSERT(syncpoint_id < NumSyncPoints);
+    // Values past the scheduled increments would never be reached, don't wait for them
+    return IsSyncPointPast(GetSyncPointValue(syncpoint_id), value) ||
+           !IsSyncPointPast(syncpoint_max_values[syncpoint_id], value);
+}
+
+bool GPU::WaitForSyncPoint(u32 syncpoint_id, u32 value, std::chrono::milliseconds timeout) {
+    if (IsSyncPointReached(syncpoint_id, value)) {
+        return true;
+    }
+    const auto is_reached = [this, syncpoint_id, value] {
+        return IsSyncPointPast(GetSyncPointValue(syncpoint_id), value);
+    };
+    std::unique_lock<std::mutex> lock{syncpoint_mutex};
+    if (timeout == std::chrono::milliseconds::max()) {
+        syncpoint_cv.wait(lock, is_reached);
+        return true;
+    }
+    return syncpoint_cv.wait_for(lock, timeout, is_reached);
+}
+
+void GPU::FlushRegion(VAddr addr, u64 size) {
+    if (UseGPUThread()) {
+        gpu_thread->FlushRegion(addr, size);
+    } else {
+        renderer.Rasterizer().FlushRegion(addr, size);
+    }
+}
+
+void GPU::InvalidateRegion(VAddr addr, u64 size) {
+    if (UseGPUThread()) {
+        gpu_thread->InvalidateRegion(addr, size);
+    } else {
+        renderer.Rasterizer().InvalidateRegion(addr, size);
+    }
+}
+
+void GPU::FlushAndInvalidateRegion(VAddr addr, u64 size) {
+    if (UseGPUThread()) {
+        gpu_thread->FlushAndInvalidateRegion(addr, size);
+    } else {
+        renderer.Rasterizer().FlushAndInvalidateRegion(addr, size);
+    }
+}
+
+void GPU::WaitIdle() {
+    if (UseGPUThread()) {
+        gpu_thread->WaitIdle();
+    }
+}
+
+u8* GPU::AliasRegion(VAddr addr, u64 size) {
+    if (UseGPUThread()) {
+        return gpu_thread->AliasRegion(addr, size);
+    }
+    return renderer.Rasterizer().AliasRegion(addr, size);
+}
+
+void GPU::UnaliasRegion(VAddr addr) {
+    if (UseGPUThread()) {
+        gpu_thread->UnaliasRegion(addr);
+    } else {
+        renderer.Rasterizer().UnaliasRegion(addr);
+    }
+}
+
+void GPU::LoadDiskResources(const VideoCore::DiskResourceLoadCallback& callback) {
+    if (UseGPUThread()) {
+        gpu_thread->LoadDiskResources(callback);
+    } else {
+        renderer.Rasterizer().LoadDiskResources(callback);
+    }
+}
+
+void GPU::ResetGuestState() {
+    if (UseGPUThread()) {
+        gpu_thread->ResetGuestState();
+    } else {
+        renderer.Rasterizer().ResetGuestState();
+    }
+}
+
+bool GPU::IsFrameBehind() const {
+    return UseGPUThread() && gpu_thread->IsFrameBehind();
+}
+
+bool GPU::StartTraceRecording(const std::string& filename) {
+    // The commands are recorded as they are pushed, when the guest memory they depend on is in
+    // the state the guest left it in
+    auto recorder = std::make_unique<GPUTrace::Recorder>(filename);
+    if (!recorder->IsOpen()) {
+        return false;
+    }
+    trace_recorder = std::move(recorder);
+    return true;
+}
+
+void GPU::StopTraceRecording() {
+    trace_recorder.reset();
+}
+
+bool GPU::UseGPUThread() const {
+    // The GPU thread itself accesses guest memory, calls coming from it are handled directly
+    return gpu_thread && !gpu_thread->IsGPUThread();
+}
+
 Engines::Maxwell3D& GPU::Maxwell3D() {
     return *maxwell_3d;
 }
@@ -41,6 +226,14 @@ const Engines::Maxwell3D& GPU::Maxwell3D() const {
     return *maxwell_3d;
 }
 
+Engines::MaxwellCompute& GPU::MaxwellCompute() {
+    return *maxwell_compute;
+}
+
+const Engines::MaxwellCompute& GPU::MaxwellCompute() const {
+    return *maxwell_compute;
+}
+
 MemoryManager& GPU::MemoryManager() {
     return *memory_manager;
 }
@@ -5,16 +5,45 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
+#include <boost/optional.hpp>
 #include "common/common_types.h"
 #include "core/hle/service/nvflinger/buffer_queue.h"
 #include "video_core/memory_manager.h"
 
-namespace VideoCore {
-class RasterizerInterface;
+namespace Core {
+class System;
 }
 
+namespace GPUTrace {
+class Recorder;
+} // namespace GPUTrace
+
+namespace VideoCore {
+class RendererBase;
+
+/// Stages of the loading of the disk resources, reported to the frontend
+enum class LoadCallbackStage {
+    Prepare,
+    Build,
+    Complete,
+};
+
+/// Called with the stage of the loading, along with how many resources are done out of the total
+using DiskResourceLoadCallback = std::function<void(LoadCallbackStage, std::size_t, std::size_t)>;
+} // namespace VideoCore
+
+namespace VideoCommon::GPUThread {
+class ThreadManager;
+} // namespace VideoCommon::GPUThread
+
 namespace Tegra {
 
 enum class RenderTargetFormat : u32 {
@@ -116,18 +145,105 @@ enum class EngineID {
 
 class GPU final {
 public:
-    explicit GPU(VideoCore::RasterizerInterface& rasterizer);
+    explicit GPU(Core::System& system, VideoCore::RendererBase& renderer);
     ~GPU();
 
     /// Processes a command list stored at the specified address in GPU memory.
+    void ProcessCommandLists(const CommandListHeader* commands, std::size_t count);
     void ProcessCommandLists(const std::vector<CommandListHeader>& commands);
 
+    /// Pushes command lists to be processed, on the GPU thread when it is enabled.
+    void PushGPUEntries(std::vector<CommandListHeader>&& entries);
+
+    /// Pushes command lists that are only valid during the call, such as a view of guest memory.
+    /// Without the GPU thread they're processed in place, otherwise they're copied.
+    void PushGPUEntries(const CommandListHeader* entries, std::size_t count);
+
+    /// Presents a framebuffer, or the previous frame when there is none. Returns the fence
+    /// signaled once the framebuffer has been read, 0 when it has been already.
+    u64 SwapBuffers(boost::optional<const FramebufferConfig&> framebuffer);
+
+    /// Waits until the specified fence returned by the GPU has been signaled.
+    void WaitForFence(u64 fence);
+
+    /// Number of syncpoints the guest can use to wait for the GPU.
+    static constexpr u32 NumSyncPoints = 192;
+
+    /// Schedules an increment of a syncpoint once the command lists pushed so far have been
+    /// processed. Returns the value the syncpoint will have after the increment.
+    u32 IncrementSyncPoint(u32 syncpoint_id);
+
+    /// Increments a syncpoint, waking up the threads waiting for it. Called by the GPU thread.
+    void SignalSyncPoint(u32 syncpoint_id);
+
+    /// Returns the current value of a syncpoint.
+    u32 GetSyncPointValue(u32 syncpoint_id) const;
+
+    /// Returns whether a syncpoint has reached the specified value, or never will because no
+    /// increment to that value was scheduled.
+    bool IsSyncPointReached(u32 syncpoint_id, u32 value) const;
+
+    /**
+     * Waits until a syncpoint has reached the specified value, without timeout when it is
+     * std::chrono::milliseconds::max().
+     * @returns false if the timeout expired before the syncpoint reached the value.
+     */
+    bool WaitForSyncPoint(u32 syncpoint_id, u32 value, std::chrono::milliseconds timeout);
+
+    /// Flushes any GPU caches of the specified region to guest memory.
+    void FlushRegion(VAddr addr, u64 size);
+
+    /// Invalidates any GPU caches of the specified region.
+    void InvalidateRegion(VAddr addr, u64 size);
+
+    /// Flushes any GPU caches of the specified region to guest memory and invalidates them.
+    void FlushAndInvalidateRegion(VAddr addr, u64 size);
+
+    /// Waits until the GPU thread has processed all the pending commands, if it is enabled.
+    void WaitIdle();
+
+    /// Backs a guest region with memory the GPU reads directly, see RasterizerInterface.
+    u8* AliasRegion(VAddr addr, u64 size);
+
+    /// Releases the memory of a region aliased with AliasRegion.
+    void UnaliasRegion(VAddr addr);
+
+    /**
+     * Builds the resources the rasterizer stored on disk, see RasterizerInterface. Waits for the
+     * GPU thread when it owns the rasterizer, the callback is then called from that thread.
+     */
+    void LoadDiskResources(const VideoCore::DiskResourceLoadCallback& callback = {});
+
+    /**
+     * Drops the guest state of the rasterizer, see RasterizerInterface, so that the renderer can
+     * be used by the next title. Waits for the GPU thread when it owns the rasterizer.
+     */
+    void ResetGuestState();
+
+    /**
+     * Returns whether the frame whose commands are being processed already has a newer frame
+     * queued behind it, so that it won't be presented. Only the GPU thread queues frames ahead.
+     */
+    bool IsFrameBehind() const;
+
+    /// Starts recording the commands pushed to the GPU to a trace file, returns false on errors.
+    bool StartTraceRecording(const std::string& filename);
+
+    /// Stops recording the GPU trace, if one is being recorded.
+    void StopTraceRecording();
+
     /// Returns a reference to the Maxwell3D GPU engine.
     Engines::Maxwell3D& Maxwell3D();
 
     /// Returns a const reference to the Maxwell3D GPU engine.
     const Engines::Maxwell3D& Maxwell3D() const;
 
+    /// Returns a reference to the MaxwellCompute GPU engine.
+    Engines::MaxwellCompute& MaxwellCompute();
+
+    /// Returns a const reference to the MaxwellCompute GPU engine.
+    const Engines::MaxwellCompute& MaxwellCompute() const;
+
     /// Returns a reference to the GPU memory manager.
     Tegra::MemoryManager& MemoryManager();
 
@@ -135,10 +251,23 @@ public:
     const Tegra::MemoryManager& MemoryManager() const;
 
 private:
+    /// Writes a method of the engine bound to a subchannel
+    using MethodWriter = void (*)(GPU& gpu, u32 method, u32 value, u32 remaining_params);
+
+    /// Returns the writer of the methods of an engine, nullptr if the engine is unimplemented
+    static MethodWriter GetMethodWriter(EngineID engine);
+
+    /// Returns whether the calls have to go through the GPU thread.
+    bool UseGPUThread() const;
+
+    Core::System& system;
+    VideoCore::RendererBase& renderer;
     std::unique_ptr<Tegra::MemoryManager> memory_manager;
 
     /// Mapping of command subchannels to their bound engine ids.
     std::array<EngineID, 8> bound_engines = {};
+    /// Method writers of the engines bound to the subchannels, resolved when they are bound.
+    std::array<MethodWriter, 8> bound_writers = {};
 
     /// 3D engine
     std::unique_ptr<Engines::Maxwell3D> maxwell_3d;
@@ -150,6 +279,23 @@ private:
     std::unique_ptr<Engines::MaxwellDMA> maxwell_dma;
     /// Inline memory engine
     std::unique_ptr<Engines::KeplerMemory> kepler_memory;
+
+    /// Recorder of the commands pushed to the GPU, when a trace is being recorded.
+    std::unique_ptr<GPUTrace::Recorder> trace_recorder;
+
+    /// Words of the command list being processed, reused across command lists.
+    std::vector<u32> command_buffer;
+
+    /// Current values of the syncpoints, incremented as the GPU processes command lists.
+    std::array<std::atomic<u32>, NumSyncPoints> syncpoints{};
+    /// Values the syncpoints will reach with the increments scheduled so far.
+    std::array<u32, NumSyncPoints> syncpoint_max_values{};
+    std::mutex syncpoint_mutex;
+    std::condition_variable syncpoint_cv;
+
+    /// Thread the command lists are processed on, when the asynchronous GPU is enabled. It is
+    /// declared last so that it is stopped before the engines it uses are destroyed.
+    std::unique_ptr<VideoCommon::GPUThread::ThreadManager> gpu_thread;
 };
 
 } // namespace Tegra
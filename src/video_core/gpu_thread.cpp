@@ -0,0 +1,201 @@
+// Copyright 2018 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/assert.h"
+#include "common/cpu_topology.h"
+#include "common/microprofile.h"
+#include "common/thread.h"
+#include "core/core_cpu.h"
+#include "core/frontend/emu_window.h"
+#include "core/settings.h"
+#include "video_core/gpu_thread.h"
+#include "video_core/rasterizer_interface.h"
+#include "video_core/renderer_base.h"
+
+namespace VideoCommon::GPUThread {
+
+ThreadManager::ThreadManager(VideoCore::RendererBase& renderer, Tegra::GPU& gpu)
+    : renderer{renderer}, gpu{gpu}, thread{&ThreadManager::RunThread, this} {
+    thread_id = thread.get_id();
+}
+
+ThreadManager::~ThreadManager() {
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        is_running = false;
+    }
+    command_cv.notify_one();
+    thread.join();
+}
+
+void ThreadManager::SubmitList(std::vector<Tegra::CommandListHeader>&& entries) {
+    PushCommand(SubmitListCommand{std::move(entries)});
+}
+
+u64 ThreadManager::SwapBuffers(boost::optional<const Tegra::FramebufferConfig&> framebuffer) {
+    boost::optional<Tegra::FramebufferConfig> framebuffer_copy;
+    if (framebuffer) {
+        framebuffer_copy = *framebuffer;
+    }
+
+    // The guest doesn't wait for the GPU yet, so this keeps it from running too many frames ahead.
+    // The slot being replaced holds the oldest frame in flight.
+    ++queued_swaps;
+    const u64 swap_fence{PushCommand(SwapBuffersCommand{std::move(framebuffer_copy)})};
+    WaitForFence(swap_fences[next_swap_slot]);
+    swap_fences[next_swap_slot] = swap_fence;
+    next_swap_slot = (next_swap_slot + 1) % MAX_QUEUED_FRAMES;
+    return swap_fence;
+}
+
+void ThreadManager::IncrementSyncPoint(u32 syncpoint_id) {
+    PushCommand(IncrementSyncPointCommand{syncpoint_id});
+}
+
+void ThreadManager::FlushRegion(VAddr addr, u64 size) {
+    WaitForFence(PushCommand(FlushRegionCommand{addr, size}));
+}
+
+void ThreadManager::InvalidateRegion(VAddr addr, u64 size) {
+    PushCommand(InvalidateRegionCommand{addr, size});
+}
+
+void ThreadManager::FlushAndInvalidateRegion(VAddr addr, u64 size) {
+    WaitForFence(PushCommand(FlushAndInvalidateRegionCommand{addr, size}));
+}
+
+u8* ThreadManager::AliasRegion(VAddr addr, u64 size) {
+    u8* result = nullptr;
+    WaitForFence(PushCommand(AliasRegionCommand{addr, size, &result}));
+    return result;
+}
+
+void ThreadManager::UnaliasRegion(VAddr addr) {
+    WaitForFence(PushCommand(UnaliasRegionCommand{addr}));
+}
+
+void ThreadManager::LoadDiskResources(const VideoCore::DiskResourceLoadCallback& callback) {
+    WaitForFence(PushCommand(LoadDiskResourcesCommand{&callback}));
+}
+
+void ThreadManager::ResetGuestState() {
+    WaitForFence(PushCommand(ResetGuestStateCommand{}));
+}
+
+void ThreadManager::WaitIdle() {
+    u64 fence;
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        fence = last_fence;
+    }
+    WaitForFence(fence);
+}
+
+u64 ThreadManager::PushCommand(CommandData&& data) {
+    ASSERT_MSG(!IsGPUThread(), "GPU commands can't be pushed from the GPU thread");
+
+    u64 fence;
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        fence = ++last_fence;
+        queue.Push(CommandDataContainer{std::move(data), fence});
+    }
+    command_cv.notify_one();
+    return fence;
+}
+
+void ThreadManager::WaitForFence(u64 fence) {
+    if (signaled_fence.load(std::memory_order_acquire) >= fence) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock{mutex};
+    fence_cv.wait(lock, [this, fence] { return signaled_fence.load() >= fence; });
+}
+
+void ThreadManager::RunThread() {
+    Common::SetCurrentThreadName("yuzu:GPU");
+    MicroProfileOnThreadCreate("GpuThread");
+    Common::SetCurrentThreadPriority(Common::ThreadPriority::High);
+    if (Settings::values.pin_emulation_threads) {
+        // The physical cores after the ones of the emulated CPU cores
+        const u32 mask{Common::GetPhysicalCoreMask(Core::NUM_CPU_CORES)};
+        if (mask != 0) {
+            Common::SetCurrentThreadAffinity(mask);
+        }
+    }
+
+    bool has_context{};
+    while (true) {
+        CommandDataContainer command;
+        {
+            std::unique_lock<std::mutex> lock{mutex};
+            command_cv.wait(lock, [this] { return !queue.Empty() || !is_running; });
+            if (!is_running) {
+                break;
+            }
+            queue.Pop(command);
+        }
+
+        // The context is only taken once the guest starts running, as the frontend keeps it
+        // while the title is being loaded.
+        if (!has_context) {
+            renderer.GetRenderWindow().MakeCurrent();
+            has_context = true;
+        }
+
+        ExecuteCommand(command.data);
+
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            signaled_fence.store(command.fence, std::memory_order_release);
+        }
+        fence_cv.notify_all();
+    }
+
+    if (has_context) {
+        renderer.GetRenderWindow().DoneCurrent();
+    }
+
+#if MICROPROFILE_ENABLED
+    MicroProfileOnThreadExit();
+#endif
+}
+
+void ThreadManager::ExecuteCommand(CommandData& data) {
+    auto& rasterizer = renderer.Rasterizer();
+    if (auto* submit_list = std::get_if<SubmitListCommand>(&data)) {
+        gpu.ProcessCommandLists(submit_list->entries);
+    } else if (auto* swap_buffers = std::get_if<SwapBuffersCommand>(&data)) {
+        // A frame with a newer one queued behind it is stale, so only the end of frame work is
+        // done for it and the wait for the display is left to the newest frame
+        const bool is_stale{queued_swaps.fetch_sub(1) > 1};
+        if (swap_buffers->framebuffer && !is_stale) {
+            renderer.SwapBuffers(*swap_buffers->framebuffer);
+        } else {
+            renderer.SwapBuffers({});
+        }
+    } else if (const auto* increment = std::get_if<IncrementSyncPointCommand>(&data)) {
+        gpu.SignalSyncPoint(increment->syncpoint_id);
+    } else if (const auto* flush = std::get_if<FlushRegionCommand>(&data)) {
+        rasterizer.FlushRegion(flush->addr, flush->size);
+    } else if (const auto* invalidate = std::get_if<InvalidateRegionCommand>(&data)) {
+        rasterizer.InvalidateRegion(invalidate->addr, invalidate->size);
+    } else if (const auto* flush_and_invalidate =
+                   std::get_if<FlushAndInvalidateRegionCommand>(&data)) {
+        rasterizer.FlushAndInvalidateRegion(flush_and_invalidate->addr,
+                                            flush_and_invalidate->size);
+    } else if (const auto* alias = std::get_if<AliasRegionCommand>(&data)) {
+        *alias->result = rasterizer.AliasRegion(alias->addr, alias->size);
+    } else if (const auto* unalias = std::get_if<UnaliasRegionCommand>(&data)) {
+        rasterizer.UnaliasRegion(unalias->addr);
+    } else if (const auto* load = std::get_if<LoadDiskResourcesCommand>(&data)) {
+        rasterizer.LoadDiskResources(*load->callback);
+    } else if (std::holds_alternative<ResetGuestStateCommand>(data)) {
+        rasterizer.ResetGuestState();
+    } else {
+        UNREACHABLE();
+    }
+}
+
+} // namespace VideoCommon::GPUThread
@@ -0,0 +1,191 @@
+// Copyright 2018 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <variant>
+#include <vector>
+#include <boost/optional.hpp>
+
+#include "common/common_types.h"
+#include "common/threadsafe_queue.h"
+#include "video_core/command_processor.h"
+#include "video_core/gpu.h"
+
+namespace VideoCore {
+class RendererBase;
+}
+
+namespace VideoCommon::GPUThread {
+
+/// Command to process a list of command buffers
+struct SubmitListCommand final {
+    std::vector<Tegra::CommandListHeader> entries;
+};
+
+/// Command to present a framebuffer, or the previous frame when there is none
+struct SwapBuffersCommand final {
+    boost::optional<Tegra::FramebufferConfig> framebuffer;
+};
+
+/// Command to increment a syncpoint once the previous commands have been executed
+struct IncrementSyncPointCommand final {
+    u32 syncpoint_id;
+};
+
+/// Command to flush a region of the GPU caches to guest memory
+struct FlushRegionCommand final {
+    VAddr addr;
+    u64 size;
+};
+
+/// Command to invalidate a region of the GPU caches
+struct InvalidateRegionCommand final {
+    VAddr addr;
+    u64 size;
+};
+
+/// Command to flush a region of the GPU caches to guest memory and invalidate it
+struct FlushAndInvalidateRegionCommand final {
+    VAddr addr;
+    u64 size;
+};
+
+/// Command to back a guest region with GPU memory, the caller waits for the result
+struct AliasRegionCommand final {
+    VAddr addr;
+    u64 size;
+    u8** result;
+};
+
+/// Command to release the GPU memory of an aliased region
+struct UnaliasRegionCommand final {
+    VAddr addr;
+};
+
+/// Command to build the resources the rasterizer stored on disk, the caller waits for it
+struct LoadDiskResourcesCommand final {
+    const VideoCore::DiskResourceLoadCallback* callback;
+};
+
+/// Command to drop the guest state of the rasterizer when the title shuts down
+struct ResetGuestStateCommand final {};
+
+using CommandData =
+    std::variant<SubmitListCommand, SwapBuffersCommand, IncrementSyncPointCommand,
+                 FlushRegionCommand, InvalidateRegionCommand, FlushAndInvalidateRegionCommand,
+                 AliasRegionCommand, UnaliasRegionCommand, LoadDiskResourcesCommand,
+                 ResetGuestStateCommand>;
+
+struct CommandDataContainer {
+    CommandData data;
+
+    /// Value the signaled fence is set to once the command has been executed
+    u64 fence{};
+};
+
+/**
+ * Runs the GPU on its own thread, which owns the GL context. Commands are executed in the order
+ * they are pushed. Operations whose results the guest depends on wait for their fence.
+ */
+class ThreadManager final {
+public:
+    ThreadManager(VideoCore::RendererBase& renderer, Tegra::GPU& gpu);
+    ~ThreadManager();
+
+    /// Queues a list of command buffers to be processed
+    void SubmitList(std::vector<Tegra::CommandListHeader>&& entries);
+
+    /**
+     * Queues a frame to be presented, only waiting when MAX_QUEUED_FRAMES frames are in flight
+     * already. Frames that have a newer one queued behind them when they are reached are dropped
+     * instead of presented, so the guest doesn't wait for the display to catch up with them.
+     * Returns the fence signaled once the frame has been presented or dropped.
+     */
+    u64 SwapBuffers(boost::optional<const Tegra::FramebufferConfig&> framebuffer);
+
+    /// Queues the increment of a syncpoint after the command lists queued so far
+    void IncrementSyncPoint(u32 syncpoint_id);
+
+    /// Flushes a region of the GPU caches to guest memory, waiting for it to complete
+    void FlushRegion(VAddr addr, u64 size);
+
+    /// Queues the invalidation of a region of the GPU caches
+    void InvalidateRegion(VAddr addr, u64 size);
+
+    /// Flushes and invalidates a region of the GPU caches, waiting for it to complete
+    void FlushAndInvalidateRegion(VAddr addr, u64 size);
+
+    /// Backs a guest region with GPU memory, waiting for the GPU thread to allocate it
+    u8* AliasRegion(VAddr addr, u64 size);
+
+    /// Releases the GPU memory of an aliased region, waiting for the commands using it
+    void UnaliasRegion(VAddr addr);
+
+    /// Builds the resources stored on disk on the GPU thread, waiting for it to complete
+    void LoadDiskResources(const VideoCore::DiskResourceLoadCallback& callback);
+
+    /// Drops the guest state of the rasterizer on the GPU thread, waiting for it to complete
+    void ResetGuestState();
+
+    /**
+     * Returns whether a newer frame is queued behind the one the GPU thread is processing, in
+     * which case the frame being processed won't be presented.
+     */
+    bool IsFrameBehind() const {
+        return queued_swaps.load(std::memory_order_relaxed) > 1;
+    }
+
+    /// Waits until every command pushed so far has been executed
+    void WaitIdle();
+
+    /// Waits until the specified fence has been signaled
+    void WaitForFence(u64 fence);
+
+    /// Returns whether the caller is running on the GPU thread
+    bool IsGPUThread() const {
+        return std::this_thread::get_id() == thread_id;
+    }
+
+private:
+    /// Pushes a command to the queue, returns the fence signaled once it is executed
+    u64 PushCommand(CommandData&& data);
+
+    /// Entry point of the GPU thread
+    void RunThread();
+
+    /// Executes a single command on the GPU thread
+    void ExecuteCommand(CommandData& data);
+
+    VideoCore::RendererBase& renderer;
+    Tegra::GPU& gpu;
+
+    /// Only the GPU thread pops commands, pushes are serialized by the mutex
+    Common::SPSCQueue<CommandDataContainer> queue;
+    std::mutex mutex;
+    std::condition_variable command_cv;
+    std::condition_variable fence_cv;
+
+    /// Number of frames the guest can queue before waiting for the oldest of them to be presented
+    static constexpr std::size_t MAX_QUEUED_FRAMES = 3;
+
+    u64 last_fence{};
+    /// Fences of the frames in flight, only accessed by the thread that queues frames
+    std::array<u64, MAX_QUEUED_FRAMES> swap_fences{};
+    std::size_t next_swap_slot{};
+    /// Frames queued and not executed yet, a frame is stale when this is greater than one
+    std::atomic<u32> queued_swaps{};
+    std::atomic<u64> signaled_fence{};
+    bool is_running{true};
+
+    std::thread thread;
+    std::thread::id thread_id;
+};
+
+} // namespace VideoCommon::GPUThread
@@ -11,19 +11,53 @@ namespace Tegra {
 
 MacroInterpreter::MacroInterpreter(Engines::Maxwell3D& maxwell3d) : maxwell3d(maxwell3d) {}
 
-void MacroInterpreter::Execute(const std::vector<u32>& code, std::vector<u32> parameters) {
+std::shared_ptr<const MacroInterpreter::Program> MacroInterpreter::Compile(
+    const std::vector<u32>& code) {
+    auto program = std::make_shared<Program>();
+    program->instructions.reserve(code.size());
+    for (std::size_t index = 0; index < code.size(); ++index) {
+        const Opcode opcode{code[index]};
+
+        Instruction instruction{};
+        instruction.operation = opcode.operation;
+        instruction.result_operation = opcode.result_operation;
+        instruction.alu_operation = opcode.alu_operation;
+        instruction.branch_condition = opcode.branch_condition;
+        instruction.branch_annul = opcode.branch_annul != 0;
+        instruction.is_exit = opcode.is_exit != 0;
+        instruction.dst = opcode.dst;
+        instruction.src_a = opcode.src_a;
+        instruction.src_b = opcode.src_b;
+        instruction.immediate = opcode.immediate;
+        instruction.bf_src_bit = opcode.bf_src_bit;
+        instruction.bf_dst_bit = opcode.bf_dst_bit;
+        instruction.bitfield_mask = opcode.GetBitfieldMask();
+        // Branch targets are relative to the branch itself, in units of instructions
+        instruction.branch_target = static_cast<s64>(index) + opcode.immediate;
+        program->instructions.push_back(instruction);
+    }
+    return program;
+}
+
+void MacroInterpreter::Execute(const Program& program, const u32* parameters,
+                               std::size_t num_parameters) {
+    ASSERT(num_parameters > 0);
     Reset();
     registers[1] = parameters[0];
-    this->parameters = std::move(parameters);
+    this->parameters = parameters;
+    this->num_parameters = num_parameters;
 
     // Execute the code until we hit an exit condition.
     bool keep_executing = true;
     while (keep_executing) {
-        keep_executing = Step(code, false);
+        keep_executing = Step(program, false);
     }
 
     // Assert the the macro used all the input parameters
-    ASSERT(next_parameter_index == this->parameters.size());
+    ASSERT(next_parameter_index == num_parameters);
+
+    this->parameters = nullptr;
+    this->num_parameters = 0;
 }
 
 void MacroInterpreter::Reset() {
@@ -31,17 +65,14 @@ void MacroInterpreter::Reset() {
     pc = 0;
     delayed_pc = boost::none;
     method_address.raw = 0;
-    parameters.clear();
     // The next parameter index starts at 1, because $r1 already has the value of the first
     // parameter.
     next_parameter_index = 1;
 }
 
-bool MacroInterpreter::Step(const std::vector<u32>& code, bool is_delay_slot) {
-    u32 base_address = pc;
-
-    Opcode opcode = GetOpcode(code);
-    pc += 4;
+bool MacroInterpreter::Step(const Program& program, bool is_delay_slot) {
+    const Instruction& opcode = GetInstruction(program);
+    pc += 1;
 
     // Update the program counter if we were delayed
     if (delayed_pc != boost::none) {
@@ -66,8 +97,8 @@ bool MacroInterpreter::Step(const std::vector<u32>& code, bool is_delay_slot) {
         u32 dst = GetRegister(opcode.src_a);
         u32 src = GetRegister(opcode.src_b);
 
-        src = (src >> opcode.bf_src_bit) & opcode.GetBitfieldMask();
-        dst &= ~(opcode.GetBitfieldMask() << opcode.bf_dst_bit);
+        src = (src >> opcode.bf_src_bit) & opcode.bitfield_mask;
+        dst &= ~(opcode.bitfield_mask << opcode.bf_dst_bit);
         dst |= src << opcode.bf_dst_bit;
         ProcessResult(opcode.result_operation, opcode.dst, dst);
         break;
@@ -76,7 +107,7 @@ bool MacroInterpreter::Step(const std::vector<u32>& code, bool is_delay_slot) {
         u32 dst = GetRegister(opcode.src_a);
         u32 src = GetRegister(opcode.src_b);
 
-        u32 result = ((src >> dst) & opcode.GetBitfieldMask()) << opcode.bf_dst_bit;
+        u32 result = ((src >> dst) & opcode.bitfield_mask) << opcode.bf_dst_bit;
 
         ProcessResult(opcode.result_operation, opcode.dst, result);
         break;
@@ -85,7 +116,7 @@ bool MacroInterpreter::Step(const std::vector<u32>& code, bool is_delay_slot) {
         u32 dst = GetRegister(opcode.src_a);
         u32 src = GetRegister(opcode.src_b);
 
-        u32 result = ((src >> opcode.bf_src_bit) & opcode.GetBitfieldMask()) << dst;
+        u32 result = ((src >> opcode.bf_src_bit) & opcode.bitfield_mask) << dst;
 
         ProcessResult(opcode.result_operation, opcode.dst, result);
         break;
@@ -100,38 +131,41 @@ bool MacroInterpreter::Step(const std::vector<u32>& code, bool is_delay_slot) {
         u32 value = GetRegister(opcode.src_a);
         bool taken = EvaluateBranchCondition(opcode.branch_condition, value);
         if (taken) {
+            ASSERT(opcode.branch_target >= 0);
+            const u32 target{static_cast<u32>(opcode.branch_target)};
+
             // Ignore the delay slot if the branch has the annul bit.
             if (opcode.branch_annul) {
-                pc = base_address + opcode.GetBranchTarget();
+                pc = target;
                 return true;
             }
 
-            delayed_pc = base_address + opcode.GetBranchTarget();
+            delayed_pc = target;
             // Execute one more instruction due to the delay slot.
-            return Step(code, true);
+            return Step(program, true);
         }
         break;
     }
     default:
         UNIMPLEMENTED_MSG("Unimplemented macro operation {}",
-                          static_cast<u32>(opcode.operation.Value()));
+                          static_cast<u32>(opcode.operation));
     }
 
     if (opcode.is_exit) {
         // Exit has a delay slot, execute the next instruction
         // Note: Executing an exit during a branch delay slot will cause the instruction at the
         // branch target to be executed before exiting.
-        Step(code, true);
+        Step(program, true);
         return false;
     }
 
     return true;
 }
 
-MacroInterpreter::Opcode MacroInterpreter::GetOpcode(const std::vector<u32>& code) const {
-    ASSERT((pc % sizeof(u32)) == 0);
-    ASSERT(pc < code.size() * sizeof(u32));
-    return {code[pc / sizeof(u32)]};
+const MacroInterpreter::Instruction& MacroInterpreter::GetInstruction(
+    const Program& program) const {
+    ASSERT(pc < program.instructions.size());
+    return program.instructions[pc];
 }
 
 u32 MacroInterpreter::GetALUResult(ALUOperation operation, u32 src_a, u32 src_b) const {
@@ -206,7 +240,7 @@ void MacroInterpreter::ProcessResult(ResultOperation operation, u32 reg, u32 res
 }
 
 u32 MacroInterpreter::FetchParameter() {
-    ASSERT(next_parameter_index < parameters.size());
+    ASSERT(next_parameter_index < num_parameters);
     return parameters[next_parameter_index++];
 }
 
@@ -5,6 +5,8 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
+#include <memory>
 #include <vector>
 #include <boost/optional.hpp>
 #include "common/bit_field.h"
@@ -17,14 +19,21 @@ class Maxwell3D;
 
 class MacroInterpreter final {
 public:
+    /// Macro code decoded ahead of time, so that it isn't decoded again on every call
+    struct Program;
+
     explicit MacroInterpreter(Engines::Maxwell3D& maxwell3d);
 
+    /// Decodes the specified macro code into a program that can be executed repeatedly
+    static std::shared_ptr<const Program> Compile(const std::vector<u32>& code);
+
     /**
-     * Executes the macro code with the specified input parameters.
-     * @param code The macro byte code to execute
-     * @param parameters The parameters of the macro
+     * Executes a macro program with the specified input parameters.
+     * @param program The decoded macro code to execute
+     * @param parameters The parameters of the macro, at least one is required
+     * @param num_parameters The number of parameters of the macro
      */
-    void Execute(const std::vector<u32>& code, std::vector<u32> parameters);
+    void Execute(const Program& program, const u32* parameters, std::size_t num_parameters);
 
 private:
     enum class Operation : u32 {
@@ -103,17 +112,36 @@ private:
         BitField<12, 6, u32> increment;
     };
 
+    /// Opcode with all of its fields extracted, as they are used by the interpreter
+    struct Instruction {
+        Operation operation;
+        ResultOperation result_operation;
+        ALUOperation alu_operation;
+        BranchCondition branch_condition;
+        bool branch_annul;
+        bool is_exit;
+        u32 dst;
+        u32 src_a;
+        u32 src_b;
+        s32 immediate;
+        u32 bf_src_bit;
+        u32 bf_dst_bit;
+        u32 bitfield_mask;
+        /// Index of the instruction a branch jumps to
+        s64 branch_target;
+    };
+
     /// Resets the execution engine state, zeroing registers, etc.
     void Reset();
 
     /**
      * Executes a single macro instruction located at the current program counter. Returns whether
      * the interpreter should keep running.
-     * @param code The macro code to execute.
+     * @param program The macro program to execute.
      * @param is_delay_slot Whether the current step is being executed due to a delay slot in a
      * previous instruction.
      */
-    bool Step(const std::vector<u32>& code, bool is_delay_slot);
+    bool Step(const Program& program, bool is_delay_slot);
 
     /// Calculates the result of an ALU operation. src_a OP src_b;
     u32 GetALUResult(ALUOperation operation, u32 src_a, u32 src_b) const;
@@ -125,8 +153,8 @@ private:
     /// Evaluates the branch condition and returns whether the branch should be taken or not.
     bool EvaluateBranchCondition(BranchCondition cond, u32 value) const;
 
-    /// Reads an opcode at the current program counter location.
-    Opcode GetOpcode(const std::vector<u32>& code) const;
+    /// Reads the instruction at the current program counter location.
+    const Instruction& GetInstruction(const Program& program) const;
 
     /// Returns the specified register's value. Register 0 is hardcoded to always return 0.
     u32 GetRegister(u32 register_id) const;
@@ -148,7 +176,7 @@ private:
 
     Engines::Maxwell3D& maxwell3d;
 
-    u32 pc; ///< Current program counter
+    u32 pc; ///< Current program counter, as an instruction index
     boost::optional<u32>
         delayed_pc; ///< Program counter to execute at after the delay slot is executed.
 
@@ -160,9 +188,15 @@ private:
     /// Method address to use for the next Send instruction.
     MethodAddress method_address = {};
 
-    /// Input parameters of the current macro.
-    std::vector<u32> parameters;
+    /// Input parameters of the current macro, owned by the caller of Execute.
+    const u32* parameters = nullptr;
+    std::size_t num_parameters = 0;
     /// Index of the next parameter that will be fetched by the 'parm' instruction.
     u32 next_parameter_index = 0;
 };
+
+struct MacroInterpreter::Program {
+    std::vector<Instruction> instructions;
+};
+
 } // namespace Tegra
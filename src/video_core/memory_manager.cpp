@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include "common/alignment.h"
 #include "common/assert.h"
 #include "video_core/memory_manager.h"
@@ -44,8 +45,7 @@ GPUVAddr MemoryManager::MapBufferEx(VAddr cpu_addr, u64 size) {
         slot = cpu_addr + offset;
     }
 
-    MappedRegion region{cpu_addr, *gpu_addr, size};
-    mapped_regions.push_back(region);
+    AddMappedRegion({cpu_addr, *gpu_addr, size});
 
     return *gpu_addr;
 }
@@ -60,8 +60,7 @@ GPUVAddr MemoryManager::MapBufferEx(VAddr cpu_addr, GPUVAddr gpu_addr, u64 size)
         slot = cpu_addr + offset;
     }
 
-    MappedRegion region{cpu_addr, gpu_addr, size};
-    mapped_regions.push_back(region);
+    AddMappedRegion({cpu_addr, gpu_addr, size});
 
     return gpu_addr;
 }
@@ -78,12 +77,18 @@ GPUVAddr MemoryManager::UnmapBuffer(GPUVAddr gpu_addr, u64 size) {
     }
 
     // Delete the region mappings that are contained within the unmapped region
-    mapped_regions.erase(std::remove_if(mapped_regions.begin(), mapped_regions.end(),
-                                        [&](const MappedRegion& region) {
-                                            return region.gpu_addr <= gpu_addr &&
-                                                   region.gpu_addr + region.size < gpu_addr + size;
-                                        }),
-                         mapped_regions.end());
+    const auto removed = std::stable_partition(
+        mapped_regions.begin(), mapped_regions.end(), [&](const MappedRegion& region) {
+            return !(region.gpu_addr >= gpu_addr &&
+                     region.gpu_addr + region.size <= gpu_addr + size);
+        });
+    for (auto region = removed; region != mapped_regions.end(); ++region) {
+        cpu_to_gpu_offsets.subtract(
+            std::make_pair(boost::icl::discrete_interval<VAddr>::right_open(
+                               region->cpu_addr, region->cpu_addr + region->size),
+                           std::set<u64>{region->gpu_addr - region->cpu_addr}));
+    }
+    mapped_regions.erase(removed, mapped_regions.end());
     return gpu_addr;
 }
 
@@ -108,8 +113,8 @@ boost::optional<GPUVAddr> MemoryManager::FindFreeBlock(u64 size, u64 align) {
     return {};
 }
 
-boost::optional<VAddr> MemoryManager::GpuToCpuAddress(GPUVAddr gpu_addr) {
-    VAddr base_addr = PageSlot(gpu_addr);
+boost::optional<VAddr> MemoryManager::GpuToCpuAddress(GPUVAddr gpu_addr) const {
+    VAddr base_addr = GetPageEntry(gpu_addr);
 
     if (base_addr == static_cast<u64>(PageStatus::Allocated) ||
         base_addr == static_cast<u64>(PageStatus::Unmapped)) {
@@ -121,17 +126,45 @@ boost::optional<VAddr> MemoryManager::GpuToCpuAddress(GPUVAddr gpu_addr) {
 
 std::vector<GPUVAddr> MemoryManager::CpuToGpuAddress(VAddr cpu_addr) const {
     std::vector<GPUVAddr> results;
-    for (const auto& region : mapped_regions) {
-        if (cpu_addr >= region.cpu_addr && cpu_addr < (region.cpu_addr + region.size)) {
-            u64 offset = cpu_addr - region.cpu_addr;
-            results.push_back(region.gpu_addr + offset);
+    const auto offsets = cpu_to_gpu_offsets.find(cpu_addr);
+    if (offsets != cpu_to_gpu_offsets.end()) {
+        for (const u64 offset : offsets->second) {
+            results.push_back(cpu_addr + offset);
         }
     }
     return results;
 }
 
-bool MemoryManager::IsPageMapped(GPUVAddr gpu_addr) {
-    return PageSlot(gpu_addr) != static_cast<u64>(PageStatus::Unmapped);
+std::vector<MemoryManager::CpuRange> MemoryManager::GpuToCpuRanges(GPUVAddr gpu_addr,
+                                                                   u64 size) const {
+    std::vector<CpuRange> ranges;
+    u64 offset = 0;
+    while (offset < size) {
+        const GPUVAddr current_addr = gpu_addr + offset;
+        const boost::optional<VAddr> cpu_addr = GpuToCpuAddress(current_addr);
+        if (!cpu_addr) {
+            return {};
+        }
+        const u64 page_size = std::min(PAGE_SIZE - (current_addr & PAGE_MASK), size - offset);
+        if (!ranges.empty() && ranges.back().cpu_addr + ranges.back().size == *cpu_addr) {
+            ranges.back().size += page_size;
+        } else {
+            ranges.push_back({*cpu_addr, page_size});
+        }
+        offset += page_size;
+    }
+    return ranges;
+}
+
+void MemoryManager::AddMappedRegion(const MappedRegion& region) {
+    mapped_regions.push_back(region);
+    cpu_to_gpu_offsets.add(std::make_pair(boost::icl::discrete_interval<VAddr>::right_open(
+                                              region.cpu_addr, region.cpu_addr + region.size),
+                                          std::set<u64>{region.gpu_addr - region.cpu_addr}));
+}
+
+bool MemoryManager::IsPageMapped(GPUVAddr gpu_addr) const {
+    return GetPageEntry(gpu_addr) != static_cast<u64>(PageStatus::Unmapped);
 }
 
 VAddr& MemoryManager::PageSlot(GPUVAddr gpu_addr) {
@@ -143,4 +176,12 @@ VAddr& MemoryManager::PageSlot(GPUVAddr gpu_addr) {
     return (*block)[(gpu_addr >> PAGE_BITS) & PAGE_BLOCK_MASK];
 }
 
+VAddr MemoryManager::GetPageEntry(GPUVAddr gpu_addr) const {
+    const auto& block = page_table[(gpu_addr >> (PAGE_BITS + PAGE_TABLE_BITS)) & PAGE_TABLE_MASK];
+    if (!block) {
+        return static_cast<VAddr>(PageStatus::Unmapped);
+    }
+    return (*block)[(gpu_addr >> PAGE_BITS) & PAGE_BLOCK_MASK];
+}
+
 } // namespace Tegra
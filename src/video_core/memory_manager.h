@@ -6,8 +6,10 @@
 
 #include <array>
 #include <memory>
+#include <set>
 #include <vector>
 
+#include <boost/icl/interval_map.hpp>
 #include <boost/optional.hpp>
 
 #include "common/common_types.h"
@@ -26,17 +28,44 @@ public:
     GPUVAddr MapBufferEx(VAddr cpu_addr, u64 size);
     GPUVAddr MapBufferEx(VAddr cpu_addr, GPUVAddr gpu_addr, u64 size);
     GPUVAddr UnmapBuffer(GPUVAddr gpu_addr, u64 size);
-    boost::optional<VAddr> GpuToCpuAddress(GPUVAddr gpu_addr);
+    boost::optional<VAddr> GpuToCpuAddress(GPUVAddr gpu_addr) const;
     std::vector<GPUVAddr> CpuToGpuAddress(VAddr cpu_addr) const;
 
+    /// A range of guest memory that is contiguous in the CPU address space.
+    struct CpuRange {
+        VAddr cpu_addr;
+        u64 size;
+    };
+
+    /**
+     * Translates a range of the GPU address space into the CPU ranges backing it, merging the
+     * pages that are contiguous in CPU memory so that each range can be accessed with one copy.
+     * @returns The CPU ranges in GPU address order, or nothing if any page is unmapped.
+     */
+    std::vector<CpuRange> GpuToCpuRanges(GPUVAddr gpu_addr, u64 size) const;
+
+    struct MappedRegion {
+        VAddr cpu_addr;
+        GPUVAddr gpu_addr;
+        u64 size;
+    };
+
+    /// Returns the regions of guest memory mapped into the GPU address space.
+    const std::vector<MappedRegion>& GetMappedRegions() const {
+        return mapped_regions;
+    }
+
     static constexpr u64 PAGE_BITS = 16;
     static constexpr u64 PAGE_SIZE = 1 << PAGE_BITS;
     static constexpr u64 PAGE_MASK = PAGE_SIZE - 1;
 
 private:
     boost::optional<GPUVAddr> FindFreeBlock(u64 size, u64 align = 1);
-    bool IsPageMapped(GPUVAddr gpu_addr);
+    bool IsPageMapped(GPUVAddr gpu_addr) const;
     VAddr& PageSlot(GPUVAddr gpu_addr);
+    /// Returns the entry of a page without allocating its block
+    VAddr GetPageEntry(GPUVAddr gpu_addr) const;
+    void AddMappedRegion(const MappedRegion& region);
 
     enum class PageStatus : u64 {
         Unmapped = 0xFFFFFFFFFFFFFFFFULL,
@@ -54,13 +83,11 @@ private:
     using PageBlock = std::array<VAddr, PAGE_BLOCK_SIZE>;
     std::array<std::unique_ptr<PageBlock>, PAGE_TABLE_SIZE> page_table{};
 
-    struct MappedRegion {
-        VAddr cpu_addr;
-        GPUVAddr gpu_addr;
-        u64 size;
-    };
-
     std::vector<MappedRegion> mapped_regions;
+
+    /// Offsets from the CPU to the GPU addresses of the regions mapped over each CPU address, to
+    /// look the GPU addresses of a CPU address up without going through every mapped region.
+    boost::icl::interval_map<VAddr, std::set<u64>> cpu_to_gpu_offsets;
 };
 
 } // namespace Tegra
@@ -4,86 +4,131 @@
 
 #pragma once
 
-#include <set>
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
 
-#include <boost/icl/interval_map.hpp>
-#include <boost/range/iterator_range_core.hpp>
+#include <boost/container/small_vector.hpp>
 
 #include "common/common_types.h"
-#include "core/core.h"
+#include "core/memory.h"
 #include "video_core/rasterizer_interface.h"
-#include "video_core/renderer_base.h"
 
 template <class T>
 class RasterizerCache : NonCopyable {
 public:
-    /// Mark the specified region as being invalidated
-    void InvalidateRegion(VAddr addr, u64 size) {
-        if (size == 0)
-            return;
-
-        const ObjectInterval interval{addr, addr + size};
-        for (auto& pair : boost::make_iterator_range(object_cache.equal_range(interval))) {
-            for (auto& cached_object : pair.second) {
-                if (!cached_object)
-                    continue;
-
-                remove_objects.emplace(cached_object);
-            }
-        }
+    explicit RasterizerCache(VideoCore::RasterizerInterface& rasterizer) : rasterizer{rasterizer} {}
+
+    /// Mark the specified region as being invalidated, returns the number of objects removed
+    std::size_t InvalidateRegion(VAddr addr, u64 size) {
+        if (size == 0 || page_table.empty())
+            return 0;
 
-        for (auto& remove_object : remove_objects) {
+        const auto objects{GetObjectsInRegion(addr, size)};
+        for (auto& remove_object : objects) {
             Unregister(remove_object);
         }
-
-        remove_objects.clear();
+        return objects.size();
     }
 
     /// Invalidates everything in the cache
     void InvalidateAll() {
-        while (object_cache.begin() != object_cache.end()) {
-            Unregister(*object_cache.begin()->second.begin());
+        while (!page_table.empty()) {
+            Unregister(page_table.begin()->second.front());
         }
     }
 
 protected:
     /// Tries to get an object from the cache with the specified address
     T TryGet(VAddr addr) const {
-        const ObjectInterval interval{addr};
-        for (auto& pair : boost::make_iterator_range(object_cache.equal_range(interval))) {
-            for (auto& cached_object : pair.second) {
-                if (cached_object->GetAddr() == addr) {
-                    return cached_object;
-                }
+        const auto page{page_table.find(addr >> Memory::PAGE_BITS)};
+        if (page == page_table.end()) {
+            return nullptr;
+        }
+        for (auto& cached_object : page->second) {
+            if (cached_object->GetAddr() == addr) {
+                return cached_object;
             }
         }
         return nullptr;
     }
 
+    /// Gets all the objects that overlap with the specified region
+    std::vector<T> GetObjectsInRegion(VAddr addr, u64 size) const {
+        std::vector<T> objects;
+        if (size == 0 || page_table.empty())
+            return objects;
+
+        const VAddr end{addr + size};
+        for (u64 page = addr >> Memory::PAGE_BITS; page <= (end - 1) >> Memory::PAGE_BITS;
+             ++page) {
+            const auto search{page_table.find(page)};
+            if (search == page_table.end()) {
+                continue;
+            }
+            for (auto& cached_object : search->second) {
+                // Objects are only indexed by page, so check that they overlap with the region
+                const VAddr object_start{cached_object->GetAddr()};
+                const VAddr object_end{object_start + cached_object->GetSizeInBytes()};
+                if (object_start < end && addr < object_end) {
+                    objects.push_back(cached_object);
+                }
+            }
+        }
+
+        // Objects spanning several pages are found once per page
+        std::sort(objects.begin(), objects.end());
+        objects.erase(std::unique(objects.begin(), objects.end()), objects.end());
+        return objects;
+    }
+
+    /// Returns whether an object is registered in the cache
+    bool IsRegistered(const T& object) const {
+        const auto page{page_table.find(object->GetAddr() >> Memory::PAGE_BITS)};
+        return page != page_table.end() &&
+               std::find(page->second.begin(), page->second.end(), object) != page->second.end();
+    }
+
     /// Register an object into the cache
     void Register(const T& object) {
-        object_cache.add({GetInterval(object), ObjectSet{object}});
-        auto& rasterizer = Core::System::GetInstance().Renderer().Rasterizer();
+        ForEachPage(object, [&](u64 page) { page_table[page].push_back(object); });
         rasterizer.UpdatePagesCachedCount(object->GetAddr(), object->GetSizeInBytes(), 1);
     }
 
     /// Unregisters an object from the cache
     void Unregister(const T& object) {
-        auto& rasterizer = Core::System::GetInstance().Renderer().Rasterizer();
         rasterizer.UpdatePagesCachedCount(object->GetAddr(), object->GetSizeInBytes(), -1);
-        object_cache.subtract({GetInterval(object), ObjectSet{object}});
+        ForEachPage(object, [&](u64 page) {
+            const auto search{page_table.find(page)};
+            if (search == page_table.end()) {
+                return;
+            }
+            auto& objects{search->second};
+            objects.erase(std::remove(objects.begin(), objects.end(), object), objects.end());
+            if (objects.empty()) {
+                page_table.erase(search);
+            }
+        });
     }
 
 private:
-    using ObjectSet = std::set<T>;
-    using ObjectCache = boost::icl::interval_map<VAddr, ObjectSet>;
-    using ObjectInterval = typename ObjectCache::interval_type;
-
-    static auto GetInterval(const T& object) {
-        return ObjectInterval::right_open(object->GetAddr(),
-                                          object->GetAddr() + object->GetSizeInBytes());
+    /// Most pages are only covered by a couple of objects, so these are stored inline
+    using PageObjects = boost::container::small_vector<T, 4>;
+
+    /// Calls the specified function for every page covered by an object
+    template <typename Func>
+    static void ForEachPage(const T& object, Func&& func) {
+        const VAddr start{object->GetAddr()};
+        const VAddr end{start + std::max<u64>(object->GetSizeInBytes(), 1)};
+        for (u64 page = start >> Memory::PAGE_BITS; page <= (end - 1) >> Memory::PAGE_BITS;
+             ++page) {
+            func(page);
+        }
     }
 
-    ObjectCache object_cache;
-    ObjectSet remove_objects;
+    /// Objects in the cache, indexed by each of the pages they cover
+    std::unordered_map<u64, PageObjects> page_table;
+
+    /// Rasterizer owning the cache, which tracks the pages with cached objects
+    VideoCore::RasterizerInterface& rasterizer;
 };
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "common/common_types.h"
+#include "video_core/engines/fermi_2d.h"
 #include "video_core/gpu.h"
 #include "video_core/memory_manager.h"
 
@@ -48,6 +49,12 @@ public:
         return false;
     }
 
+    /// Attempt to copy between surfaces of the 2D engine without going through Switch memory
+    virtual bool AccelerateSurfaceCopy(const Tegra::Engines::Fermi2D::Regs::Surface& src,
+                                       const Tegra::Engines::Fermi2D::Regs::Surface& dst) {
+        return false;
+    }
+
     /// Attempt to use a faster method to display the framebuffer to screen
     virtual bool AccelerateDisplay(const Tegra::FramebufferConfig& config, VAddr framebuffer_addr,
                                    u32 pixel_stride) {
@@ -58,7 +65,51 @@ public:
         return false;
     }
 
+    /// Submits the draws that were batched by AccelerateDrawBatch, if any
+    virtual void FlushDrawBatch() {}
+
+    /// Attempt to write the samples passed by the previous draws to memory once they complete,
+    /// instead of waiting for them
+    virtual bool AccelerateSamplesPassedQuery(VAddr addr, bool short_query, u64 timestamp) {
+        return false;
+    }
+
+    /// Notifies the rasterizer that the frontend is about to draw the frame to the screen
+    virtual void NotifyPresent() {}
+
     /// Increase/decrease the number of object in pages touching the specified region
     virtual void UpdatePagesCachedCount(Tegra::GPUVAddr addr, u64 size, int delta) {}
+
+    /// Notifies the rasterizer that a frame was presented, used to age cached resources
+    virtual void TickFrame() {}
+
+    /**
+     * Allocates host memory visible to the GPU to back the specified guest region, so that the
+     * guest writes to it directly and nothing has to be uploaded.
+     * @returns the host pointer the region has to be mapped to, or nullptr if unsupported.
+     */
+    virtual u8* AliasRegion(VAddr addr, u64 size) {
+        return nullptr;
+    }
+
+    /// Releases the memory of a region aliased with AliasRegion, after it was mapped elsewhere
+    virtual void UnaliasRegion(VAddr addr) {}
+
+    /// Dispatches the kernel at the address with the latest launch descriptor of MaxwellCompute
+    virtual void DispatchCompute(Tegra::GPUVAddr code_addr) {}
+
+    /**
+     * Builds the resources stored on disk by previous runs of the title, such as its shaders, so
+     * that they are ready before its first frame. Must be called from the thread owning the
+     * rasterizer's context.
+     */
+    virtual void LoadDiskResources(const DiskResourceLoadCallback& callback = {}) {}
+
+    /**
+     * Drops everything cached from the memory of the process that is shutting down, keeping the
+     * host resources which don't depend on it, such as the built shader programs, for the next
+     * title. Must be called from the thread owning the rasterizer's context.
+     */
+    virtual void ResetGuestState() {}
 };
 } // namespace VideoCore
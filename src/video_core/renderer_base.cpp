@@ -9,7 +9,8 @@
 
 namespace VideoCore {
 
-RendererBase::RendererBase(Core::Frontend::EmuWindow& window) : render_window{window} {
+RendererBase::RendererBase(Core::Frontend::EmuWindow& window, Core::System& system)
+    : render_window{window}, system{system} {
     RefreshBaseSettings();
 }
 
@@ -11,6 +11,10 @@
 #include "video_core/gpu.h"
 #include "video_core/rasterizer_interface.h"
 
+namespace Core {
+class System;
+}
+
 namespace Core::Frontend {
 class EmuWindow;
 }
@@ -24,7 +28,7 @@ struct RendererSettings {
 
 class RendererBase : NonCopyable {
 public:
-    explicit RendererBase(Core::Frontend::EmuWindow& window);
+    explicit RendererBase(Core::Frontend::EmuWindow& window, Core::System& system);
     virtual ~RendererBase();
 
     /// Swap buffers (render frame)
@@ -55,11 +59,16 @@ public:
         return *rasterizer;
     }
 
+    Core::Frontend::EmuWindow& GetRenderWindow() {
+        return render_window;
+    }
+
     /// Refreshes the settings common to all renderers
     void RefreshBaseSettings();
 
 protected:
     Core::Frontend::EmuWindow& render_window; ///< Reference to the render window handle.
+    Core::System& system;                     ///< System the renderer belongs to
     std::unique_ptr<RasterizerInterface> rasterizer;
     f32 m_current_fps = 0.0f; ///< Current framerate, should be set by the renderer
     int m_current_frame = 0;  ///< Current frame, should be set by the renderer
@@ -0,0 +1,38 @@
+// Copyright 2018 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/logging/log.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/frontend/emu_window.h"
+#include "core/perf_stats.h"
+#include "video_core/renderer_null/renderer_null.h"
+
+namespace Null {
+
+RendererNull::RendererNull(Core::Frontend::EmuWindow& window, Core::System& system)
+    : RendererBase{window, system} {}
+
+RendererNull::~RendererNull() = default;
+
+void RendererNull::SwapBuffers(boost::optional<const Tegra::FramebufferConfig&> framebuffer) {
+    system.GetPerfStats().EndSystemFrame();
+
+    render_window.PollEvents();
+    rasterizer->TickFrame();
+    ++m_current_frame;
+
+    system.FrameLimiter().DoFrameLimiting(CoreTiming::GetGlobalTimeUs());
+    system.GetPerfStats().BeginSystemFrame();
+}
+
+bool RendererNull::Init() {
+    rasterizer = std::make_unique<RasterizerNull>();
+    LOG_INFO(Render, "Using the null renderer, nothing will be displayed");
+    return true;
+}
+
+void RendererNull::ShutDown() {}
+
+} // namespace Null
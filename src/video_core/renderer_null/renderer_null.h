@@ -0,0 +1,39 @@
+// Copyright 2018 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/common_types.h"
+#include "video_core/rasterizer_interface.h"
+#include "video_core/renderer_base.h"
+
+namespace Null {
+
+/// Rasterizer that ignores every draw, there are no caches to flush or invalidate
+class RasterizerNull final : public VideoCore::RasterizerInterface {
+public:
+    void DrawArrays() override {}
+    void Clear() override {}
+    void FlushAll() override {}
+    void FlushRegion(VAddr addr, u64 size) override {}
+    void InvalidateRegion(VAddr addr, u64 size) override {}
+    void FlushAndInvalidateRegion(VAddr addr, u64 size) override {}
+};
+
+/**
+ * Renderer that displays nothing and needs no graphics context. The GPU engines still process
+ * the command lists, unless they are skipped, so that the CPU and the HLE services can be
+ * benchmarked without the cost of the graphics driver.
+ */
+class RendererNull final : public VideoCore::RendererBase {
+public:
+    explicit RendererNull(Core::Frontend::EmuWindow& window, Core::System& system);
+    ~RendererNull() override;
+
+    void SwapBuffers(boost::optional<const Tegra::FramebufferConfig&> framebuffer) override;
+    bool Init() override;
+    void ShutDown() override;
+};
+
+} // namespace Null
@@ -2,21 +2,27 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cstring>
 #include <memory>
+#include <vector>
 
 #include "common/alignment.h"
+#include "common/assert.h"
+#include "common/microprofile.h"
 #include "core/core.h"
 #include "core/memory.h"
 #include "video_core/renderer_opengl/gl_buffer_cache.h"
 
 namespace OpenGL {
 
-OGLBufferCache::OGLBufferCache(std::size_t size) : stream_buffer(GL_ARRAY_BUFFER, size) {}
+OGLBufferCache::OGLBufferCache(VideoCore::RasterizerInterface& rasterizer, Core::System& system,
+                               std::size_t size)
+    : RasterizerCache{rasterizer}, system{system}, stream_buffer(GL_ARRAY_BUFFER, size) {}
 
 GLintptr OGLBufferCache::UploadMemory(Tegra::GPUVAddr gpu_addr, std::size_t size,
                                       std::size_t alignment, bool cache) {
-    auto& memory_manager = Core::System::GetInstance().GPU().MemoryManager();
+    auto& memory_manager = system.GPU().MemoryManager();
     const boost::optional<VAddr> cpu_addr{memory_manager.GpuToCpuAddress(gpu_addr)};
 
     // Cache management is a big overhead, so only cache entries with a given size.
@@ -72,6 +78,7 @@ void OGLBufferCache::Map(std::size_t max_size) {
 
     if (invalidate) {
         InvalidateAll();
+        ++generation;
     }
 }
 void OGLBufferCache::Unmap() {
@@ -90,4 +97,85 @@ void OGLBufferCache::AlignBuffer(std::size_t alignment) {
     buffer_offset = offset_aligned;
 }
 
+CachedBufferBlock::CachedBufferBlock(VAddr addr, std::size_t size) : addr{addr}, size{size} {
+    // The copy write target isn't tracked by OpenGLState, so binding to it doesn't break the state
+    buffer.Create();
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer.handle);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_DYNAMIC_DRAW);
+    dirty_ranges.add(boost::icl::interval<std::size_t>::right_open(0, size));
+}
+
+void CachedBufferBlock::MarkAsDirty(VAddr region_addr, u64 region_size) {
+    const VAddr start{std::max(region_addr, addr)};
+    const VAddr end{std::min(region_addr + region_size, addr + size)};
+    if (start < end) {
+        dirty_ranges.add(boost::icl::interval<std::size_t>::right_open(
+            static_cast<std::size_t>(start - addr), static_cast<std::size_t>(end - addr)));
+    }
+}
+
+MICROPROFILE_DEFINE(OpenGL_BufferBlockUpload, "OpenGL", "Buffer Block Upload",
+                    MP_RGB(128, 192, 64));
+void CachedBufferBlock::Synchronize() {
+    if (dirty_ranges.empty()) {
+        return;
+    }
+
+    MICROPROFILE_SCOPE(OpenGL_BufferBlockUpload);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer.handle);
+    std::vector<u8> staging;
+    for (const auto& range : dirty_ranges) {
+        const std::size_t offset{boost::icl::first(range)};
+        const std::size_t length{boost::icl::length(range)};
+        staging.resize(length);
+        Memory::ReadBlock(addr + offset, staging.data(), length);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(offset),
+                        static_cast<GLsizeiptr>(length), staging.data());
+    }
+    dirty_ranges.clear();
+}
+
+OGLBufferBlockCache::OGLBufferBlockCache(VideoCore::RasterizerInterface& rasterizer,
+                                         Core::System& system)
+    : RasterizerCache{rasterizer}, system{system} {}
+
+bool OGLBufferBlockCache::IsCacheable(std::size_t size) {
+    return size >= MIN_BLOCK_SIZE && size <= MAX_RESIDENT_SIZE;
+}
+
+GLuint OGLBufferBlockCache::Upload(Tegra::GPUVAddr gpu_addr, std::size_t size) {
+    ASSERT(IsCacheable(size));
+
+    auto& memory_manager = system.GPU().MemoryManager();
+    const boost::optional<VAddr> cpu_addr{memory_manager.GpuToCpuAddress(gpu_addr)};
+
+    auto block = TryGet(*cpu_addr);
+    if (block && block->GetSizeInBytes() < size) {
+        resident_size -= block->GetSizeInBytes();
+        Unregister(block);
+        block = nullptr;
+    }
+
+    if (!block) {
+        if (resident_size + size > MAX_RESIDENT_SIZE) {
+            InvalidateAll();
+            resident_size = 0;
+        }
+        block = std::make_shared<CachedBufferBlock>(*cpu_addr, size);
+        resident_size += size;
+        Register(block);
+    }
+
+    block->Synchronize();
+    return block->GetHandle();
+}
+
+std::size_t OGLBufferBlockCache::InvalidateRegion(VAddr addr, u64 size) {
+    const auto blocks{GetObjectsInRegion(addr, size)};
+    for (const auto& block : blocks) {
+        block->MarkAsDirty(addr, size);
+    }
+    return blocks.size();
+}
+
 } // namespace OpenGL
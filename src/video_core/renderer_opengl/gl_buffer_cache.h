@@ -7,11 +7,17 @@
 #include <cstddef>
 #include <memory>
 
+#include <boost/icl/interval_set.hpp>
+
 #include "common/common_types.h"
 #include "video_core/rasterizer_cache.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
 #include "video_core/renderer_opengl/gl_stream_buffer.h"
 
+namespace Core {
+class System;
+}
+
 namespace OpenGL {
 
 struct CachedBufferEntry final {
@@ -31,7 +37,8 @@ struct CachedBufferEntry final {
 
 class OGLBufferCache final : public RasterizerCache<std::shared_ptr<CachedBufferEntry>> {
 public:
-    explicit OGLBufferCache(std::size_t size);
+    explicit OGLBufferCache(VideoCore::RasterizerInterface& rasterizer, Core::System& system,
+                            std::size_t size);
 
     GLintptr UploadMemory(Tegra::GPUVAddr gpu_addr, std::size_t size, std::size_t alignment = 4,
                           bool cache = true);
@@ -43,15 +50,91 @@ public:
 
     GLuint GetHandle() const;
 
+    /// Returns a counter bumped whenever the stream buffer is orphaned, invalidating its offsets
+    u64 GetGeneration() const {
+        return generation;
+    }
+
 protected:
     void AlignBuffer(std::size_t alignment);
 
 private:
+    Core::System& system;
     OGLStreamBuffer stream_buffer;
 
     u8* buffer_ptr = nullptr;
     GLintptr buffer_offset = 0;
     GLintptr buffer_offset_base = 0;
+    u64 generation = 1;
+};
+
+/**
+ * Guest buffer kept resident in its own GL buffer object. Writes from the guest only mark the
+ * written ranges as dirty, these ranges are uploaded again the next time the block is used.
+ */
+class CachedBufferBlock final {
+public:
+    CachedBufferBlock(VAddr addr, std::size_t size);
+
+    VAddr GetAddr() const {
+        return addr;
+    }
+
+    std::size_t GetSizeInBytes() const {
+        return size;
+    }
+
+    GLuint GetHandle() const {
+        return buffer.handle;
+    }
+
+    /// Marks the specified guest region as modified, it is clamped to the range of the block
+    void MarkAsDirty(VAddr region_addr, u64 region_size);
+
+    /// Uploads the dirty ranges of the block from guest memory
+    void Synchronize();
+
+private:
+    VAddr addr;
+    std::size_t size;
+    OGLBuffer buffer;
+
+    /// Dirty ranges of the block, as offsets from its start
+    boost::icl::interval_set<std::size_t> dirty_ranges;
+};
+
+/**
+ * Keeps large guest buffers resident in GL buffer objects, so that buffers that don't change
+ * across draws aren't copied again into the stream buffer every time they are used.
+ */
+class OGLBufferBlockCache final : public RasterizerCache<std::shared_ptr<CachedBufferBlock>> {
+public:
+    explicit OGLBufferBlockCache(VideoCore::RasterizerInterface& rasterizer, Core::System& system);
+
+    /// Smallest buffer worth keeping resident, smaller ones are cheaper to stream
+    static constexpr std::size_t MIN_BLOCK_SIZE = 16 * 1024;
+
+    /// Returns whether a buffer of the specified size is going to be kept resident
+    static bool IsCacheable(std::size_t size);
+
+    /**
+     * Gets the resident buffer of the specified guest region, uploading its dirty ranges.
+     * @returns the handle of a GL buffer holding the region at offset zero
+     */
+    GLuint Upload(Tegra::GPUVAddr gpu_addr, std::size_t size);
+
+    /**
+     * Marks the blocks overlapping with the specified region as dirty, keeping them resident
+     * @returns the number of blocks marked as dirty
+     */
+    std::size_t InvalidateRegion(VAddr addr, u64 size);
+
+private:
+    /// Evicts every block once this much memory is resident
+    static constexpr std::size_t MAX_RESIDENT_SIZE = 256 * 1024 * 1024;
+
+    Core::System& system;
+    std::size_t resident_size{};
 };
 
 } // namespace OpenGL
@@ -0,0 +1,157 @@
+// Copyright 2018 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "common/alignment.h"
+#include "common/assert.h"
+#include "common/microprofile.h"
+#include "video_core/renderer_opengl/gl_index_converter.h"
+#include "video_core/renderer_opengl/gl_state.h"
+
+namespace OpenGL {
+
+using Maxwell = Tegra::Engines::Maxwell3D::Regs;
+
+/// Vertices of a quad making up its two triangles, in the order GL_QUADS would draw them
+constexpr std::array<u32, 6> QuadTriangleOrder{0, 1, 2, 0, 2, 3};
+
+/// Each invocation converts one quad, reading its indices as 8, 16 or 32-bit values
+static const char quad_conversion_shader[] = R"(
+#version 430 core
+
+layout (local_size_x = 64) in;
+
+layout (std430, binding = 0) readonly buffer SourceIndices {
+    uint source[];
+};
+
+layout (std430, binding = 1) writeonly buffer TriangleIndices {
+    uint triangles[];
+};
+
+layout (location = 0) uniform uint source_offset;
+layout (location = 1) uniform uint index_size;
+layout (location = 2) uniform uint num_quads;
+
+uint ReadIndex(uint index) {
+    const uint byte_offset = source_offset + index * index_size;
+    const uint word = source[byte_offset / 4];
+    if (index_size == 4) {
+        return word;
+    }
+    const uint mask = index_size == 1 ? 0xFFu : 0xFFFFu;
+    return (word >> ((byte_offset % 4) * 8)) & mask;
+}
+
+void main() {
+    const uint quad = gl_GlobalInvocationID.x;
+    if (quad >= num_quads) {
+        return;
+    }
+
+    const uint order[6] = uint[](0, 1, 2, 0, 2, 3);
+    for (uint i = 0; i < 6; ++i) {
+        triangles[quad * 6 + i] = ReadIndex(quad * 4 + order[i]);
+    }
+}
+)";
+
+IndexConverterOpenGL::IndexConverterOpenGL() {
+    quad_indices.Create();
+    converted_indices.Create();
+    if (IsSupported()) {
+        OGLShader shader;
+        shader.Create(quad_conversion_shader, GL_COMPUTE_SHADER);
+        quad_program.Create(false, false, shader.handle);
+        glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &source_alignment);
+    }
+}
+
+IndexConverterOpenGL::~IndexConverterOpenGL() = default;
+
+bool IndexConverterOpenGL::IsSupported() {
+    return GLAD_GL_ARB_compute_shader && GLAD_GL_ARB_shader_storage_buffer_object &&
+           GLAD_GL_ARB_explicit_uniform_location;
+}
+
+GLuint IndexConverterOpenGL::GetQuadIndices(u32 num_vertices) {
+    if (num_vertices <= quad_indices_vertices) {
+        return quad_indices.handle;
+    }
+
+    // The pattern doesn't depend on the draw, so the buffer is grown to twice the size needed
+    // to generate it as rarely as possible
+    const u32 num_quads{std::max(num_vertices / 4 * 2, 1U)};
+    std::vector<u32> indices(num_quads * QuadTriangleOrder.size());
+    for (u32 quad = 0; quad < num_quads; ++quad) {
+        for (std::size_t i = 0; i < QuadTriangleOrder.size(); ++i) {
+            indices[quad * QuadTriangleOrder.size() + i] = quad * 4 + QuadTriangleOrder[i];
+        }
+    }
+    glNamedBufferData(quad_indices.handle, static_cast<GLsizeiptr>(indices.size() * sizeof(u32)),
+                      indices.data(), GL_STATIC_DRAW);
+    quad_indices_vertices = num_quads * 4;
+    return quad_indices.handle;
+}
+
+MICROPROFILE_DEFINE(OpenGL_IndexConversion, "OpenGL", "Index Conversion", MP_RGB(128, 128, 192));
+GLuint IndexConverterOpenGL::ConvertIndexedQuads(GLuint source, GLintptr source_offset,
+                                                 Maxwell::IndexFormat format, u32 count) {
+    MICROPROFILE_SCOPE(OpenGL_IndexConversion);
+    ASSERT(IsSupported());
+
+    u32 index_size{};
+    switch (format) {
+    case Maxwell::IndexFormat::UnsignedByte:
+        index_size = 1;
+        break;
+    case Maxwell::IndexFormat::UnsignedShort:
+        index_size = 2;
+        break;
+    case Maxwell::IndexFormat::UnsignedInt:
+        index_size = 4;
+        break;
+    }
+
+    const u32 num_quads{count / 4};
+    const GLsizeiptr converted_size{
+        static_cast<GLsizeiptr>(num_quads * QuadTriangleOrder.size() * sizeof(u32))};
+    if (converted_size > converted_indices_size) {
+        converted_indices_size = converted_size;
+        glNamedBufferData(converted_indices.handle, converted_indices_size, nullptr,
+                          GL_DYNAMIC_COPY);
+    }
+
+    // Storage buffers have to be bound at an aligned offset, the shader skips the difference
+    const std::size_t offset{static_cast<std::size_t>(source_offset)};
+    const std::size_t bound_offset{
+        Common::AlignDown(offset, static_cast<std::size_t>(source_alignment))};
+    const std::size_t source_size{
+        Common::AlignUp<std::size_t>(offset - bound_offset + count * index_size, 4)};
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, source, static_cast<GLintptr>(bound_offset),
+                      static_cast<GLsizeiptr>(source_size));
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 1, converted_indices.handle, 0, converted_size);
+
+    OpenGLState state{OpenGLState::GetCurState()};
+    const GLuint previous_program{state.draw.shader_program};
+    state.draw.shader_program = quad_program.handle;
+    state.Apply();
+
+    glUniform1ui(0, static_cast<GLuint>(offset - bound_offset));
+    glUniform1ui(1, index_size);
+    glUniform1ui(2, num_quads);
+    glDispatchCompute((num_quads + 63) / 64, 1, 1);
+
+    state.draw.shader_program = previous_program;
+    state.Apply();
+
+    // The result is read back as the index buffer of the following draw
+    glMemoryBarrier(GL_ELEMENT_ARRAY_BARRIER_BIT);
+    return converted_indices.handle;
+}
+
+} // namespace OpenGL
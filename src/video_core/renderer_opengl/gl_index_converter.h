@@ -0,0 +1,55 @@
+// Copyright 2018 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <glad/glad.h>
+
+#include "common/common_types.h"
+#include "video_core/engines/maxwell_3d.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+
+namespace OpenGL {
+
+/**
+ * Generates the index buffers that draw the primitives missing from the GL core profile as
+ * triangles. The generated buffers are kept around and reused by the following draws.
+ */
+class IndexConverterOpenGL final {
+public:
+    IndexConverterOpenGL();
+    ~IndexConverterOpenGL();
+
+    /// Returns whether the GL implementation supports converting indexed quads on the GPU
+    static bool IsSupported();
+
+    /**
+     * Returns a buffer of 32-bit indices drawing a non-indexed list of quads as triangles, with
+     * the first quad starting at vertex 0. It is only regenerated when a longer draw needs it.
+     * @param num_vertices Number of vertices of the quads the buffer has to cover
+     */
+    GLuint GetQuadIndices(u32 num_vertices);
+
+    /**
+     * Converts the indices of an indexed list of quads to 32-bit triangle indices with a compute
+     * pass, so that the guest indices are never rewritten on the CPU.
+     * @param source Buffer holding the guest indices
+     * @param source_offset Offset in bytes of the first index, aligned to the size of an index
+     * @returns Buffer holding the triangle indices at offset zero
+     */
+    GLuint ConvertIndexedQuads(GLuint source, GLintptr source_offset,
+                               Tegra::Engines::Maxwell3D::Regs::IndexFormat format, u32 count);
+
+private:
+    OGLProgram quad_program;
+
+    OGLBuffer quad_indices;
+    u32 quad_indices_vertices{};
+
+    OGLBuffer converted_indices;
+    GLsizeiptr converted_indices_size{};
+    GLint source_alignment{};
+};
+
+} // namespace OpenGL
@@ -0,0 +1,111 @@
+// Copyright 2018 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iterator>
+
+#include "core/memory.h"
+#include "video_core/rasterizer_interface.h"
+#include "video_core/renderer_opengl/gl_query_cache.h"
+
+namespace OpenGL {
+
+QueryCacheOpenGL::QueryCacheOpenGL(VideoCore::RasterizerInterface& rasterizer)
+    : rasterizer{rasterizer} {}
+
+void QueryCacheOpenGL::ResumeSamplesPassed() {
+    if (!is_enabled || is_counting) {
+        return;
+    }
+    OGLQuery& query = segments.emplace_back();
+    query.Create(GL_SAMPLES_PASSED);
+    glBeginQuery(GL_SAMPLES_PASSED, query.handle);
+    is_counting = true;
+}
+
+void QueryCacheOpenGL::PauseSamplesPassed() {
+    if (!is_counting) {
+        return;
+    }
+    glEndQuery(GL_SAMPLES_PASSED);
+    is_counting = false;
+}
+
+void QueryCacheOpenGL::QueueSamplesPassedWrite(VAddr addr, bool short_query, u64 timestamp) {
+    // The running segment is closed so the write only counts the draws submitted before it
+    PauseSamplesPassed();
+    is_enabled = true;
+
+    const PendingWrite& write = pending_writes.emplace_back(
+        PendingWrite{addr, short_query, timestamp, segments_begin + segments.size()});
+    rasterizer.UpdatePagesCachedCount(addr, write.GetSize(), 1);
+}
+
+void QueryCacheOpenGL::WriteAvailable() {
+    while (!pending_writes.empty() && WriteFront(false)) {
+    }
+}
+
+bool QueryCacheOpenGL::IsRegionPending(VAddr addr, u64 size) const {
+    return std::any_of(
+        pending_writes.begin(), pending_writes.end(),
+        [addr, size](const PendingWrite& write) { return write.Overlaps(addr, size); });
+}
+
+void QueryCacheOpenGL::FlushRegion(VAddr addr, u64 size) {
+    // Writes are done in order, as a later write to the same address has to win
+    const auto last = std::find_if(
+        pending_writes.rbegin(), pending_writes.rend(),
+        [addr, size](const PendingWrite& write) { return write.Overlaps(addr, size); });
+    auto count = static_cast<std::size_t>(std::distance(last, pending_writes.rend()));
+    for (; count > 0; --count) {
+        WriteFront(true);
+    }
+}
+
+bool QueryCacheOpenGL::ResolveSegments(u64 segments_end, bool wait) {
+    while (segments_begin < segments_end) {
+        const GLuint handle = segments.front().handle;
+        if (!wait) {
+            GLuint available{};
+            glGetQueryObjectuiv(handle, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available == GL_FALSE) {
+                return false;
+            }
+        }
+        GLuint64 samples{};
+        glGetQueryObjectui64v(handle, GL_QUERY_RESULT, &samples);
+        resolved_samples += samples;
+        segments.pop_front();
+        ++segments_begin;
+    }
+    return true;
+}
+
+bool QueryCacheOpenGL::WriteFront(bool wait) {
+    const PendingWrite write = pending_writes.front();
+    if (!ResolveSegments(write.segments_end, wait)) {
+        return false;
+    }
+    pending_writes.pop_front();
+
+    // Unmarked first, the result is written through the host pointer like surface flushes are
+    rasterizer.UpdatePagesCachedCount(write.addr, write.GetSize(), -1);
+    u8* const dest = Memory::GetPointer(write.addr);
+    if (dest == nullptr) {
+        return true;
+    }
+    if (write.short_query) {
+        const u32 value = static_cast<u32>(resolved_samples);
+        std::memcpy(dest, &value, sizeof(value));
+    } else {
+        const std::array<u64, 2> result{resolved_samples, write.timestamp};
+        std::memcpy(dest, result.data(), sizeof(result));
+    }
+    return true;
+}
+
+} // namespace OpenGL
@@ -0,0 +1,94 @@
+// Copyright 2018 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+
+#include <glad/glad.h>
+
+#include "common/common_types.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+
+namespace VideoCore {
+class RasterizerInterface;
+}
+
+namespace OpenGL {
+
+/**
+ * Counts the samples passed by the guest's draws with GL queries, and writes the counter to guest
+ * memory once the draws before each query get completed. The pages of the pending writes are
+ * marked as cached, so a CPU read of a result that isn't written yet waits for it in FlushRegion
+ * instead of every query get stalling the pipeline.
+ */
+class QueryCacheOpenGL final {
+public:
+    explicit QueryCacheOpenGL(VideoCore::RasterizerInterface& rasterizer);
+
+    /// Starts counting the samples passed by the following draws, if the guest uses them and it
+    /// isn't already
+    void ResumeSamplesPassed();
+
+    /// Stops counting samples, so that the draws of the frontend aren't counted
+    void PauseSamplesPassed();
+
+    /// Queues a write of the current samples passed counter to guest memory
+    void QueueSamplesPassedWrite(VAddr addr, bool short_query, u64 timestamp);
+
+    /// Writes the results of the queries that completed, without waiting for the others
+    void WriteAvailable();
+
+    /// Returns whether the guest uses the samples passed counter, which every draw adds to
+    bool IsEnabled() const {
+        return is_enabled;
+    }
+
+    /// Returns whether any result is pending to be written in the given region
+    bool IsRegionPending(VAddr addr, u64 size) const;
+
+    /// Writes the results pending in the given region, waiting for their queries if needed
+    void FlushRegion(VAddr addr, u64 size);
+
+private:
+    struct PendingWrite {
+        VAddr addr;
+        bool short_query;
+        u64 timestamp;
+        /// Index of the segment after the last one counted in this write
+        u64 segments_end;
+
+        u64 GetSize() const {
+            return short_query ? sizeof(u32) : sizeof(u64) * 2;
+        }
+
+        bool Overlaps(VAddr region_addr, u64 region_size) const {
+            return addr < region_addr + region_size && region_addr < addr + GetSize();
+        }
+    };
+
+    /// Accumulates the results of the segments before segments_end, returns false if one of them
+    /// isn't available and wait is false
+    bool ResolveSegments(u64 segments_end, bool wait);
+
+    /// Writes the front pending write, returns false if it isn't available and wait is false
+    bool WriteFront(bool wait);
+
+    VideoCore::RasterizerInterface& rasterizer;
+
+    /// Queries counting the samples between two query gets, oldest first
+    std::deque<OGLQuery> segments;
+    /// Index of the first segment in the deque
+    u64 segments_begin = 0;
+    /// Samples passed in the segments that were already popped
+    u64 resolved_samples = 0;
+    bool is_counting = false;
+    /// Samples are only counted once the guest queried them, the query is not free
+    bool is_enabled = false;
+
+    std::deque<PendingWrite> pending_writes;
+};
+
+} // namespace OpenGL
@@ -4,6 +4,8 @@
 
 #include <algorithm>
 #include <array>
+#include <cmath>
+#include <limits>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -12,13 +14,18 @@
 #include <glad/glad.h>
 #include "common/alignment.h"
 #include "common/assert.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/math_util.h"
 #include "common/microprofile.h"
 #include "common/scope_exit.h"
+#include "common/tracing.h"
 #include "core/core.h"
 #include "core/frontend/emu_window.h"
 #include "core/hle/kernel/process.h"
+#include "core/memory.h"
+#include "core/memory_stats.h"
+#include "core/perf_stats.h"
 #include "core/settings.h"
 #include "video_core/engines/maxwell_3d.h"
 #include "video_core/renderer_opengl/gl_rasterizer.h"
@@ -30,8 +37,8 @@
 namespace OpenGL {
 
 using Maxwell = Tegra::Engines::Maxwell3D::Regs;
-using PixelFormat = SurfaceParams::PixelFormat;
-using SurfaceType = SurfaceParams::SurfaceType;
+using DirtyFlag = Tegra::Engines::Maxwell3D::DirtyFlag;
+using VideoCore::Surface::PixelFormatFromGPUPixelFormat;
 
 MICROPROFILE_DEFINE(OpenGL_VAO, "OpenGL", "Vertex Array Setup", MP_RGB(128, 128, 192));
 MICROPROFILE_DEFINE(OpenGL_Shader, "OpenGL", "Shader Setup", MP_RGB(128, 128, 192));
@@ -40,17 +47,15 @@ MICROPROFILE_DEFINE(OpenGL_Index, "OpenGL", "Index Buffer Setup", MP_RGB(128, 12
 MICROPROFILE_DEFINE(OpenGL_Texture, "OpenGL", "Texture Setup", MP_RGB(128, 128, 192));
 MICROPROFILE_DEFINE(OpenGL_Framebuffer, "OpenGL", "Framebuffer Setup", MP_RGB(128, 128, 192));
 MICROPROFILE_DEFINE(OpenGL_Drawing, "OpenGL", "Drawing", MP_RGB(128, 128, 192));
+MICROPROFILE_DEFINE(OpenGL_Compute, "OpenGL", "Compute Dispatch", MP_RGB(128, 128, 192));
 MICROPROFILE_DEFINE(OpenGL_Blits, "OpenGL", "Blits", MP_RGB(128, 128, 192));
 MICROPROFILE_DEFINE(OpenGL_CacheManagement, "OpenGL", "Cache Mgmt", MP_RGB(100, 255, 100));
 
-RasterizerOpenGL::RasterizerOpenGL(Core::Frontend::EmuWindow& window, ScreenInfo& info)
-    : emu_window{window}, screen_info{info}, buffer_cache(STREAM_BUFFER_SIZE) {
-    // Create sampler objects
-    for (std::size_t i = 0; i < texture_samplers.size(); ++i) {
-        texture_samplers[i].Create();
-        state.texture_units[i].sampler = texture_samplers[i].sampler.handle;
-    }
-
+RasterizerOpenGL::RasterizerOpenGL(Core::Frontend::EmuWindow& window, Core::System& system,
+                                   ScreenInfo& info)
+    : res_cache{*this, system}, shader_cache{*this, system}, emu_window{window}, system{system},
+      screen_info{info}, buffer_cache(*this, system, STREAM_BUFFER_SIZE),
+      buffer_block_cache{*this, system} {
     GLint ext_num;
     glGetIntegerv(GL_NUM_EXTENSIONS, &ext_num);
     for (GLint i = 0; i < ext_num; i++) {
@@ -65,6 +70,10 @@ RasterizerOpenGL::RasterizerOpenGL(Core::Frontend::EmuWindow& window, ScreenInfo
             has_ARB_separate_shader_objects = true;
         } else if (extension == "GL_ARB_vertex_attrib_binding") {
             has_ARB_vertex_attrib_binding = true;
+        } else if (extension == "GL_ARB_texture_barrier") {
+            has_ARB_texture_barrier = true;
+        } else if (extension == "GL_NV_texture_barrier") {
+            has_NV_texture_barrier = true;
         }
     }
 
@@ -73,9 +82,6 @@ RasterizerOpenGL::RasterizerOpenGL(Core::Frontend::EmuWindow& window, ScreenInfo
     // Clipping plane 0 is always enabled for PICA fixed clip plane z <= 0
     state.clip_distance[0] = true;
 
-    // Create render framebuffer
-    framebuffer.Create();
-
     shader_program_manager = std::make_unique<GLShader::ProgramManager>();
     state.draw.shader_program = 0;
     state.Apply();
@@ -84,6 +90,8 @@ RasterizerOpenGL::RasterizerOpenGL(Core::Frontend::EmuWindow& window, ScreenInfo
 
     glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniform_buffer_alignment);
 
+    res_cache.SetResolutionScale(GetResolutionScale());
+
     LOG_CRITICAL(Render_OpenGL, "Sync fixed function OpenGL state here!");
 }
 
@@ -91,11 +99,12 @@ RasterizerOpenGL::~RasterizerOpenGL() {}
 
 void RasterizerOpenGL::SetupVertexArrays() {
     MICROPROFILE_SCOPE(OpenGL_VAO);
-    const auto& gpu = Core::System::GetInstance().GPU().Maxwell3D();
+    const auto& gpu = system.GPU().Maxwell3D();
     const auto& regs = gpu.regs;
 
     auto [iter, is_cache_miss] = vertex_array_cache.try_emplace(regs.vertex_attrib_format);
-    auto& VAO = iter->second;
+    CachedVertexArray& cached_vao = iter->second;
+    auto& VAO = cached_vao.vao;
 
     if (is_cache_miss) {
         VAO.Create();
@@ -145,6 +154,12 @@ void RasterizerOpenGL::SetupVertexArrays() {
     state.draw.vertex_buffer = buffer_cache.GetHandle();
     state.Apply();
 
+    // The attribute formats are stored in the VAO, so only the buffers are bound on each draw,
+    // all of them in a single call. Disabled arrays are bound to no buffer.
+    std::array<GLuint, Maxwell::NumVertexArrays> buffers{};
+    std::array<GLintptr, Maxwell::NumVertexArrays> offsets{};
+    std::array<GLsizei, Maxwell::NumVertexArrays> strides{};
+
     // Upload all guest vertex arrays sequentially to our buffer
     for (u32 index = 0; index < Maxwell::NumVertexArrays; ++index) {
         const auto& vertex_array = regs.vertex_array[index];
@@ -156,25 +171,62 @@ void RasterizerOpenGL::SetupVertexArrays() {
 
         ASSERT(end > start);
         const u64 size = end - start + 1;
-        const GLintptr vertex_buffer_offset = buffer_cache.UploadMemory(start, size);
-
-        // Bind the vertex array to the buffer at the current offset.
-        glBindVertexBuffer(index, buffer_cache.GetHandle(), vertex_buffer_offset,
-                           vertex_array.stride);
-
-        if (regs.instanced_arrays.IsInstancingEnabled(index) && vertex_array.divisor != 0) {
-            // Enable vertex buffer instancing with the specified divisor.
-            glVertexBindingDivisor(index, vertex_array.divisor);
+        const auto [aliased_buffer, aliased_offset] = FindAliasedBuffer(start, size);
+        if (aliased_buffer != 0) {
+            // The guest writes straight into this buffer, there is nothing to upload
+            buffers[index] = aliased_buffer;
+            offsets[index] = aliased_offset;
+        } else if (Settings::values.use_resident_vertex_buffers &&
+                   OGLBufferBlockCache::IsCacheable(size)) {
+            buffers[index] = buffer_block_cache.Upload(start, size);
+            offsets[index] = 0;
         } else {
-            // Disable the vertex buffer instancing.
-            glVertexBindingDivisor(index, 0);
+            // Bind the vertex array to the buffer at the current offset.
+            buffers[index] = buffer_cache.GetHandle();
+            offsets[index] = buffer_cache.UploadMemory(start, size);
+        }
+        strides[index] = static_cast<GLsizei>(vertex_array.stride);
+
+        // Zero disables the vertex buffer instancing
+        const GLuint divisor =
+            regs.instanced_arrays.IsInstancingEnabled(index) ? vertex_array.divisor : 0;
+        if (cached_vao.divisors[index] != divisor) {
+            glVertexBindingDivisor(index, divisor);
+            cached_vao.divisors[index] = divisor;
         }
     }
+
+    glBindVertexBuffers(0, static_cast<GLsizei>(Maxwell::NumVertexArrays), buffers.data(),
+                        offsets.data(), strides.data());
 }
 
-void RasterizerOpenGL::SetupShaders() {
+bool RasterizerOpenGL::SetupShaders() {
     MICROPROFILE_SCOPE(OpenGL_Shader);
-    const auto& gpu = Core::System::GetInstance().GPU().Maxwell3D();
+    const auto& gpu = system.GPU().Maxwell3D();
+
+    // Get the programs of all the enabled stages first, so that no state is touched when the draw
+    // has to be skipped because a program is still being built.
+    std::array<Shader, Maxwell::MaxShaderProgram> shaders;
+    for (std::size_t index = 0; index < Maxwell::MaxShaderProgram; ++index) {
+        if (!gpu.regs.IsShaderConfigEnabled(index)) {
+            continue;
+        }
+
+        const Maxwell::ShaderProgram program{static_cast<Maxwell::ShaderProgram>(index)};
+        shaders[index] = shader_cache.GetStageProgram(program);
+        if (shaders[index]) {
+            last_shaders[index] = shaders[index];
+        } else if (!Settings::values.skip_draws_with_pending_shaders && last_shaders[index]) {
+            shaders[index] = last_shaders[index];
+        } else {
+            return false;
+        }
+
+        // VertexB was combined with VertexA, so we skip the VertexB program
+        if (program == Maxwell::ShaderProgram::VertexA) {
+            index++;
+        }
+    }
 
     // Next available bindpoints to use when uploading the const buffers and textures to the GLSL
     // shaders. The constbuffer bindpoint starts after the shader stage configuration bind points.
@@ -193,19 +245,22 @@ void RasterizerOpenGL::SetupShaders() {
         const std::size_t stage{index == 0 ? 0 : index - 1}; // Stage indices are 0 - 5
 
         GLShader::MaxwellUniformData ubo{};
-        ubo.SetFromRegs(gpu.state.shader_stages[stage]);
-        const GLintptr offset = buffer_cache.UploadHostMemory(
-            &ubo, sizeof(ubo), static_cast<std::size_t>(uniform_buffer_alignment));
+        ubo.SetFromRegs(gpu, gpu.state.shader_stages[stage]);
+        const GLintptr offset = UploadStreamed(uniform_uploads[stage], &ubo, sizeof(ubo));
 
         // Bind the buffer
         glBindBufferRange(GL_UNIFORM_BUFFER, stage, buffer_cache.GetHandle(), offset, sizeof(ubo));
 
-        Shader shader{shader_cache.GetStageProgram(program)};
+        Shader& shader{shaders[index]};
 
         switch (program) {
         case Maxwell::ShaderProgram::VertexA:
         case Maxwell::ShaderProgram::VertexB: {
             shader_program_manager->UseProgrammableVertexShader(shader->GetProgramHandle());
+            if (const GLuint operations = shader->GetUberShaderOperations(); operations != 0) {
+                glBindBufferBase(GL_SHADER_STORAGE_BUFFER, UberShaderOpenGL::OperationsBinding,
+                                 operations);
+            }
             break;
         }
         case Maxwell::ShaderProgram::Fragment: {
@@ -236,10 +291,39 @@ void RasterizerOpenGL::SetupShaders() {
     state.Apply();
 
     shader_program_manager->UseTrivialGeometryShader();
+    return true;
+}
+
+std::pair<GLuint, GLintptr> RasterizerOpenGL::FindAliasedBuffer(Tegra::GPUVAddr gpu_addr,
+                                                                 u64 size) const {
+    if (aliased_regions.empty()) {
+        return {};
+    }
+    const auto& memory_manager = system.GPU().MemoryManager();
+    const boost::optional<VAddr> cpu_addr{memory_manager.GpuToCpuAddress(gpu_addr)};
+    if (!cpu_addr) {
+        return {};
+    }
+    auto iter = aliased_regions.upper_bound(*cpu_addr);
+    if (iter == aliased_regions.begin()) {
+        return {};
+    }
+    --iter;
+    const VAddr region_addr = iter->first;
+    const AliasedRegion& region = iter->second;
+    if (*cpu_addr + size > region_addr + region.size) {
+        return {};
+    }
+    // The region has to be contiguous in the GPU address space as well
+    const boost::optional<VAddr> cpu_end{memory_manager.GpuToCpuAddress(gpu_addr + size - 1)};
+    if (!cpu_end || *cpu_end != *cpu_addr + size - 1) {
+        return {};
+    }
+    return {region.buffer.handle, static_cast<GLintptr>(*cpu_addr - region_addr)};
 }
 
 std::size_t RasterizerOpenGL::CalculateVertexArraysSize() const {
-    const auto& regs = Core::System::GetInstance().GPU().Maxwell3D().regs;
+    const auto& regs = system.GPU().Maxwell3D().regs;
 
     std::size_t size = 0;
     for (u32 index = 0; index < Maxwell::NumVertexArrays; ++index) {
@@ -250,18 +334,139 @@ std::size_t RasterizerOpenGL::CalculateVertexArraysSize() const {
         const Tegra::GPUVAddr end = regs.vertex_array_limit[index].LimitAddress();
 
         ASSERT(end > start);
-        size += end - start + 1;
+        const std::size_t array_size = end - start + 1;
+        if (Settings::values.use_resident_vertex_buffers &&
+            OGLBufferBlockCache::IsCacheable(array_size)) {
+            // Resident vertex buffers don't go through the stream buffer
+            continue;
+        }
+        if (FindAliasedBuffer(start, array_size).first != 0) {
+            continue;
+        }
+        size += array_size;
     }
 
     return size;
 }
 
 bool RasterizerOpenGL::AccelerateDrawBatch(bool is_indexed) {
-    accelerate_draw = is_indexed ? AccelDraw::Indexed : AccelDraw::Arrays;
-    DrawArrays();
+    if (IsDrawSkipped()) {
+        system.GetPerfStats().AddCounter(Core::PerfCounter::SkippedDraws);
+        return true;
+    }
+
+    const auto& maxwell3d = system.GPU().Maxwell3D();
+    const auto& regs = maxwell3d.regs;
+
+    const AccelDraw draw_mode{is_indexed ? AccelDraw::Indexed : AccelDraw::Arrays};
+    if (!pending_draws.empty() && accelerate_draw != draw_mode) {
+        FlushDrawBatch();
+    }
+    accelerate_draw = draw_mode;
+
+    PendingDraw draw{};
+    draw.count = is_indexed ? regs.index_array.count : regs.vertex_buffer.count;
+    draw.first = is_indexed ? regs.index_array.first : regs.vertex_buffer.first;
+    draw.base_vertex = is_indexed ? static_cast<GLint>(regs.vb_element_base) : 0;
+    draw.base_instance = maxwell3d.state.current_instance;
+    draw.instance_count = 1;
+
+    // Draws of the next instance with nothing changed in between become one instanced draw. The
+    // engine flushes the pending draws before any state they depend on changes.
+    if (!pending_draws.empty()) {
+        PendingDraw& last = pending_draws.back();
+        if (last.count == draw.count && last.first == draw.first &&
+            last.base_vertex == draw.base_vertex &&
+            last.base_instance + last.instance_count == draw.base_instance) {
+            ++last.instance_count;
+            return true;
+        }
+    }
+
+    // Without batching, a draw is only held back until it's known whether the next one continues
+    // its instances
+    if (!Settings::values.use_draw_batching) {
+        FlushDrawBatch();
+    }
+    pending_draws.push_back(draw);
+
+    if (pending_draws.size() >= MaxDrawBatchSize) {
+        FlushDrawBatch();
+    }
+    return true;
+}
+
+bool RasterizerOpenGL::IsDrawSkipped() const {
+    if (!Settings::values.use_frame_skip || !system.GPU().IsFrameBehind()) {
+        return false;
+    }
+    // The samples passed counter would miss the skipped draws
+    if (query_cache.IsEnabled()) {
+        return false;
+    }
+
+    // Only draws to images that get presented are skipped. Depth only draws and draws to other
+    // render targets, like shadow maps and render to texture, may be read by later frames.
+    const auto& gpu = system.GPU();
+    const auto& regs = gpu.Maxwell3D().regs;
+    if (regs.rt_control.count == 0) {
+        return false;
+    }
+    for (u32 index = 0; index < regs.rt_control.count; ++index) {
+        const auto& render_target = regs.rt[regs.rt_control.GetMap(index)];
+        const boost::optional<VAddr> cpu_addr{
+            gpu.MemoryManager().GpuToCpuAddress(render_target.Address())};
+        if (!cpu_addr || presented_addresses.count(*cpu_addr) == 0) {
+            return false;
+        }
+    }
     return true;
 }
 
+void RasterizerOpenGL::FlushDrawBatch() {
+    if (!pending_draws.empty()) {
+        DrawArrays();
+    }
+}
+
+bool RasterizerOpenGL::AccelerateSamplesPassedQuery(VAddr addr, bool short_query, u64 timestamp) {
+    ScopeAcquireGLContext acquire_context{emu_window};
+    query_cache.QueueSamplesPassedWrite(addr, short_query, timestamp);
+    return true;
+}
+
+void RasterizerOpenGL::NotifyPresent() {
+    query_cache.PauseSamplesPassed();
+}
+
+GLintptr RasterizerOpenGL::UploadIndirectCommands(const std::vector<PendingDraw>& draws,
+                                                  bool is_indexed, u32 first_index,
+                                                  GLintptr index_buffer_offset) {
+    if (!is_indexed) {
+        std::vector<DrawArraysIndirectCommand> commands(draws.size());
+        for (std::size_t i = 0; i < draws.size(); ++i) {
+            commands[i] = {draws[i].count, draws[i].instance_count, draws[i].first,
+                           draws[i].base_instance};
+        }
+        return buffer_cache.UploadHostMemory(commands.data(),
+                                             commands.size() * sizeof(commands[0]));
+    }
+
+    // Indirect draws have no index buffer offset, so it is folded into the first index. The
+    // stream buffer aligns uploads to 4 bytes, which is a multiple of every index size.
+    const auto& regs = system.GPU().Maxwell3D().regs;
+    const u32 index_format_size{regs.index_array.FormatSizeInBytes()};
+    const u32 base_index{static_cast<u32>(index_buffer_offset) / index_format_size};
+
+    std::vector<DrawElementsIndirectCommand> commands(draws.size());
+    for (std::size_t i = 0; i < draws.size(); ++i) {
+        commands[i] = {draws[i].count, draws[i].instance_count,
+                       base_index + draws[i].first - first_index, draws[i].base_vertex,
+                       draws[i].base_instance};
+    }
+    return buffer_cache.UploadHostMemory(commands.data(), commands.size() * sizeof(commands[0]));
+}
+
 template <typename Map, typename Interval>
 static constexpr auto RangeFromInterval(Map& map, const Interval& interval) {
     return boost::make_iterator_range(map.equal_range(interval));
@@ -297,11 +502,162 @@ void RasterizerOpenGL::UpdatePagesCachedCount(VAddr addr, u64 size, int delta) {
         cached_pages.add({pages_interval, delta});
 }
 
+void RasterizerOpenGL::TickFrame() {
+    query_cache.WriteAvailable();
+    res_cache.TickFrame();
+
+    // Framebuffers of surfaces that died are never bound again
+    for (auto iter = framebuffer_cache.begin(); iter != framebuffer_cache.end();) {
+        const auto& surfaces{iter->second.surfaces};
+        const bool is_stale{std::any_of(surfaces.begin(), surfaces.end(),
+                                        [](const auto& surface) { return surface.expired(); })};
+        iter = is_stale ? framebuffer_cache.erase(iter) : std::next(iter);
+    }
+    res_cache.SetResolutionScale(GetResolutionScale());
+}
+
+u8* RasterizerOpenGL::AliasRegion(VAddr addr, u64 size) {
+    if (!GLAD_GL_ARB_buffer_storage) {
+        return nullptr;
+    }
+
+    // Coherent, so that the writes of the guest are seen by the draws submitted after them
+    constexpr GLbitfield flags =
+        GL_MAP_READ_BIT | GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    AliasedRegion region;
+    glCreateBuffers(1, &region.buffer.handle);
+    glNamedBufferStorage(region.buffer.handle, static_cast<GLsizeiptr>(size), nullptr, flags);
+    auto* const pointer = static_cast<u8*>(
+        glMapNamedBufferRange(region.buffer.handle, 0, static_cast<GLsizeiptr>(size), flags));
+    if (pointer == nullptr) {
+        LOG_ERROR(Render_OpenGL, "Failed to map an aliased buffer of size {:X}", size);
+        return nullptr;
+    }
+    region.size = size;
+    aliased_regions.insert_or_assign(addr, std::move(region));
+    return pointer;
+}
+
+void RasterizerOpenGL::UnaliasRegion(VAddr addr) {
+    const auto iter = aliased_regions.find(addr);
+    if (iter == aliased_regions.end()) {
+        return;
+    }
+    glUnmapNamedBuffer(iter->second.buffer.handle);
+    aliased_regions.erase(iter);
+}
+
+void RasterizerOpenGL::DispatchCompute(Tegra::GPUVAddr code_addr) {
+    MICROPROFILE_SCOPE(OpenGL_Compute);
+    YUZU_TRACE_ZONE("DispatchCompute");
+    const auto& compute = system.GPU().MaxwellCompute();
+    const auto& launch = compute.launch_description;
+
+    ScopeAcquireGLContext acquire_context{emu_window};
+
+    // Previous draws may still be batched, they have to be executed before the kernel
+    FlushDrawBatch();
+
+    const Shader kernel{shader_cache.GetComputeKernel(code_addr)};
+    const auto& entries = kernel->GetShaderEntries().const_buffer_entries;
+
+    constexpr std::size_t max_binds = Tegra::Engines::MaxwellCompute::NumConstBuffers;
+    std::array<GLuint, max_binds> bind_buffers{};
+    std::array<GLintptr, max_binds> bind_offsets{};
+    std::array<GLsizeiptr, max_binds> bind_sizes{};
+    ASSERT_MSG(entries.size() <= max_binds, "Exceeded expected number of binding points.");
+
+    buffer_cache.Map(max_binds * (MaxConstbufferSize + uniform_buffer_alignment));
+    for (u32 bindpoint = 0; bindpoint < entries.size(); ++bindpoint) {
+        const auto& used_buffer = entries[bindpoint];
+        const std::size_t index{used_buffer.GetIndex()};
+        if (index >= max_binds || !launch.IsConstBufferEnabled(index)) {
+            continue;
+        }
+
+        // The launch descriptor only gives the size of the buffers, so they are always uploaded
+        // entirely, which also covers indirect accesses
+        const auto& config = launch.const_buffer_config[index];
+        const std::size_t size{std::min<std::size_t>(
+            Common::AlignUp<std::size_t>(config.size, sizeof(GLvec4)), MaxConstbufferSize)};
+        if (size == 0) {
+            continue;
+        }
+
+        bind_buffers[bindpoint] = buffer_cache.GetHandle();
+        bind_offsets[bindpoint] =
+            UploadConstBuffer(compute_const_buffer_uploads[index], config.Address(), size);
+        bind_sizes[bindpoint] = static_cast<GLsizeiptr>(size);
+        glUniformBlockBinding(kernel->GetProgramHandle(),
+                              kernel->GetProgramResourceIndex(used_buffer), bindpoint);
+    }
+    buffer_cache.Unmap();
+
+    if (!entries.empty()) {
+        glBindBuffersRange(GL_UNIFORM_BUFFER, 0, static_cast<GLsizei>(entries.size()),
+                           bind_buffers.data(), bind_offsets.data(), bind_sizes.data());
+    }
+
+    // A program bound with glUseProgram takes precedence over the pipeline of the 3D stages
+    state.draw.shader_program = kernel->GetProgramHandle();
+    state.Apply();
+    glDispatchCompute(launch.grid_dim_x, launch.grid_dim_y, launch.grid_dim_z);
+    state.draw.shader_program = 0;
+    state.Apply();
+
+    // Anything the kernel wrote has to be visible to the commands that follow it
+    glMemoryBarrier(GL_ALL_BARRIER_BITS);
+}
+
+void RasterizerOpenGL::LoadDiskResources(const VideoCore::DiskResourceLoadCallback& callback) {
+    ScopeAcquireGLContext acquire_context{emu_window};
+    shader_cache.LoadDiskCache(callback);
+}
+
+void RasterizerOpenGL::ResetGuestState() {
+    ScopeAcquireGLContext acquire_context{emu_window};
+
+    // Pending query results still go to the process that asked for them, not to the next one
+    query_cache.FlushRegion(0, std::numeric_limits<u64>::max());
+
+    pending_draws.clear();
+    accelerate_draw = AccelDraw::Disabled;
+
+    res_cache.InvalidateAll();
+    shader_cache.InvalidateAll();
+    buffer_cache.InvalidateAll();
+    buffer_block_cache.InvalidateAll();
+    written_pages.clear();
+
+    last_shaders = {};
+    framebuffer_cache.clear();
+    bound_framebuffer_key = {};
+    presented_addresses.clear();
+    aliased_regions.clear();
+
+    // The next title has a disk cache of its own
+    shader_cache.ResetDiskCache();
+}
+
+u32 RasterizerOpenGL::GetResolutionScale() const {
+    float factor{Settings::values.resolution_factor};
+    if (factor == 0.0f) {
+        // Auto scales the render targets to the size of the screen in the window
+        factor = emu_window.GetFramebufferLayout().screen.GetHeight() /
+                 static_cast<float>(Layout::ScreenUndocked::Height);
+    }
+    return std::clamp(static_cast<u32>(std::lround(factor)), 1U,
+                      RasterizerCacheOpenGL::MAX_RESOLUTION_SCALE);
+}
+
 void RasterizerOpenGL::ConfigureFramebuffers(bool using_color_fb, bool using_depth_fb,
                                              bool preserve_contents,
                                              boost::optional<std::size_t> single_color_target) {
     MICROPROFILE_SCOPE(OpenGL_Framebuffer);
-    const auto& regs = Core::System::GetInstance().GPU().Maxwell3D().regs;
+    const auto& regs = system.GPU().Maxwell3D().regs;
+
+    // Surfaces bound to the framebuffer, these are going to be modified by the GPU
+    std::vector<Surface> render_targets;
 
     Surface depth_surface;
     if (using_depth_fb) {
@@ -313,77 +669,164 @@ void RasterizerOpenGL::ConfigureFramebuffers(bool using_color_fb, bool using_dep
     // tested.
     ASSERT_MSG(regs.rt_separate_frag_data == 0, "Unimplemented");
 
-    // Bind the framebuffer surfaces
-    state.draw.draw_framebuffer = framebuffer.handle;
-    state.Apply();
+    // The framebuffer objects are looked up by their attachments, so that an unchanged set of
+    // render targets only has to be bound
+    FramebufferCacheKey key;
 
     if (using_color_fb) {
         if (single_color_target) {
-            // Used when just a single color attachment is enabled, e.g. for clearing a color buffer
-            Surface color_surface =
-                res_cache.GetColorBufferSurface(*single_color_target, preserve_contents);
-            glFramebufferTexture2D(
-                GL_DRAW_FRAMEBUFFER,
-                GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(*single_color_target), GL_TEXTURE_2D,
-                color_surface != nullptr ? color_surface->Texture().handle : 0, 0);
-            glDrawBuffer(GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(*single_color_target));
+            // Used when just a single color attachment is enabled, e.g. for clearing a color buffer.
+            // The draw buffer has the index of the render target, as clears address it by index.
+            const std::size_t index{*single_color_target};
+            Surface color_surface = res_cache.GetColorBufferSurface(index, preserve_contents);
+            if (color_surface) {
+                render_targets.push_back(color_surface);
+                key.colors[index] = color_surface->Texture().handle;
+            }
+            key.draw_buffers.fill(GL_NONE);
+            key.draw_buffers[index] = GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(index);
+            key.num_draw_buffers = index + 1;
         } else {
             // Multiple color attachments are enabled
-            std::array<GLenum, Maxwell::NumRenderTargets> buffers;
             for (std::size_t index = 0; index < Maxwell::NumRenderTargets; ++index) {
                 Surface color_surface = res_cache.GetColorBufferSurface(index, preserve_contents);
-                buffers[index] = GL_COLOR_ATTACHMENT0 + regs.rt_control.GetMap(index);
-                glFramebufferTexture2D(
-                    GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(index),
-                    GL_TEXTURE_2D, color_surface != nullptr ? color_surface->Texture().handle : 0,
-                    0);
+                if (color_surface) {
+                    render_targets.push_back(color_surface);
+                    key.colors[index] = color_surface->Texture().handle;
+                }
+                key.draw_buffers[index] = GL_COLOR_ATTACHMENT0 + regs.rt_control.GetMap(index);
             }
-            glDrawBuffers(regs.rt_control.count, buffers.data());
-        }
-    } else {
-        // No color attachments are enabled - zero out all of them
-        for (std::size_t index = 0; index < Maxwell::NumRenderTargets; ++index) {
-            glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER,
-                                   GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(index), GL_TEXTURE_2D,
-                                   0, 0);
+            key.num_draw_buffers = regs.rt_control.count;
         }
-        glDrawBuffer(GL_NONE);
     }
 
     if (depth_surface) {
-        if (regs.stencil_enable) {
-            // Attach both depth and stencil
-            glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D,
-                                   depth_surface->Texture().handle, 0);
-        } else {
-            // Attach depth
-            glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D,
-                                   depth_surface->Texture().handle, 0);
-            // Clear stencil attachment
-            glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_TEXTURE_2D, 0, 0);
-        }
-    } else {
-        // Clear both depth and stencil attachment
-        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, 0,
-                               0);
+        render_targets.push_back(depth_surface);
+        key.zeta = depth_surface->Texture().handle;
+        key.stencil = regs.stencil_enable != 0;
     }
 
-    SyncViewport();
+    state.draw.draw_framebuffer = GetFramebuffer(key, render_targets);
+    bound_framebuffer_key = key;
+
+    // All the render targets are created at the same scale, the viewport has to be scaled along
+    // with them whenever it changes
+    u32 scale{1};
+    if (!render_targets.empty()) {
+        scale = render_targets.front()->GetSurfaceParams().resolution_scale;
+    }
+    const bool is_scale_changed{scale != framebuffer_scale};
+    framebuffer_scale = scale;
+
+    res_cache.NotifyRenderTargets(std::move(render_targets));
+
+    if (system.GPU().Maxwell3D().ConsumeDirtyFlag(DirtyFlag::Viewport) ||
+        is_scale_changed) {
+        SyncViewport();
+    }
 
     state.Apply();
 }
 
+bool RasterizerOpenGL::DeferClear(bool use_color, bool use_depth, bool use_stencil) {
+    const auto& regs = system.GPU().Maxwell3D().regs;
+
+    // Only clears of every component of the surfaces can be recorded. Scissors don't apply to
+    // clears, so the whole surfaces are cleared.
+    const bool is_full_color{regs.clear_buffers.R && regs.clear_buffers.G &&
+                             regs.clear_buffers.B && regs.clear_buffers.A};
+    if (use_color && !is_full_color) {
+        return false;
+    }
+
+    Surface color_surface;
+    if (use_color) {
+        color_surface = res_cache.GetColorBufferSurface(regs.clear_buffers.RT, false);
+        if (!color_surface || !color_surface->CanDeferClear()) {
+            return false;
+        }
+    }
+
+    Surface zeta_surface;
+    if (use_depth || use_stencil) {
+        zeta_surface = res_cache.GetDepthBufferSurface(false);
+        if (!zeta_surface || !zeta_surface->CanDeferClear()) {
+            return false;
+        }
+        const auto type{zeta_surface->GetSurfaceParams().type};
+        const bool clears_all{type == SurfaceType::DepthStencil
+                                  ? use_depth && use_stencil
+                                  : use_depth && !use_stencil};
+        if (!clears_all) {
+            return false;
+        }
+    }
+
+    SurfaceClearValue value{};
+    std::copy(std::begin(regs.clear_color), std::end(regs.clear_color), value.color.begin());
+    value.depth = regs.clear_depth;
+    value.stencil = static_cast<u8>(regs.clear_stencil);
+
+    if (color_surface) {
+        color_surface->DeferClear(value);
+    }
+    if (zeta_surface) {
+        zeta_surface->DeferClear(value);
+    }
+    return true;
+}
+
+GLuint RasterizerOpenGL::GetFramebuffer(const FramebufferCacheKey& key,
+                                        const std::vector<Surface>& surfaces) {
+    auto [iter, is_new] = framebuffer_cache.try_emplace(key);
+    CachedFramebuffer& cached = iter->second;
+    if (!is_new) {
+        const bool is_stale{std::any_of(cached.surfaces.begin(), cached.surfaces.end(),
+                                        [](const auto& surface) { return surface.expired(); })};
+        if (!is_stale) {
+            return cached.framebuffer.handle;
+        }
+        // A texture of the framebuffer was deleted and its name was reused by another surface
+        cached.framebuffer.Release();
+    }
+
+    cached.framebuffer.Create();
+    cached.surfaces.assign(surfaces.begin(), surfaces.end());
+
+    const GLuint handle{cached.framebuffer.handle};
+    for (std::size_t index = 0; index < Maxwell::NumRenderTargets; ++index) {
+        if (key.colors[index] != 0) {
+            glNamedFramebufferTexture(handle, GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(index),
+                                      key.colors[index], 0);
+        }
+    }
+    if (key.num_draw_buffers > 0) {
+        glNamedFramebufferDrawBuffers(handle, static_cast<GLsizei>(key.num_draw_buffers),
+                                      key.draw_buffers.data());
+    } else {
+        glNamedFramebufferDrawBuffer(handle, GL_NONE);
+    }
+    if (key.zeta != 0) {
+        glNamedFramebufferTexture(handle,
+                                  key.stencil ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT,
+                                  key.zeta, 0);
+    }
+    return handle;
+}
+
 void RasterizerOpenGL::Clear() {
+    YUZU_TRACE_ZONE("Clear");
+    InvalidateWrittenPages();
+
     const auto prev_state{state};
     SCOPE_EXIT({ prev_state.Apply(); });
 
-    const auto& regs = Core::System::GetInstance().GPU().Maxwell3D().regs;
+    const auto& regs = system.GPU().Maxwell3D().regs;
     bool use_color{};
     bool use_depth{};
     bool use_stencil{};
 
     OpenGLState clear_state;
-    clear_state.draw.draw_framebuffer = state.draw.draw_framebuffer;
     clear_state.color_mask.red_enabled = regs.clear_buffers.R ? GL_TRUE : GL_FALSE;
     clear_state.color_mask.green_enabled = regs.clear_buffers.G ? GL_TRUE : GL_FALSE;
     clear_state.color_mask.blue_enabled = regs.clear_buffers.B ? GL_TRUE : GL_FALSE;
@@ -415,9 +858,15 @@ void RasterizerOpenGL::Clear() {
 
     ScopeAcquireGLContext acquire_context{emu_window};
 
+    if (DeferClear(use_color, use_depth, use_stencil)) {
+        system.GetPerfStats().AddCounter(Core::PerfCounter::DrawCalls);
+        return;
+    }
+
     ConfigureFramebuffers(use_color, use_depth || use_stencil, false,
                           regs.clear_buffers.RT.Value());
 
+    clear_state.draw.draw_framebuffer = state.draw.draw_framebuffer;
     clear_state.Apply();
 
     if (use_color) {
@@ -431,33 +880,72 @@ void RasterizerOpenGL::Clear() {
     } else if (use_stencil) {
         glClearBufferiv(GL_STENCIL, 0, &regs.clear_stencil);
     }
+
+    system.GetPerfStats().AddCounter(Core::PerfCounter::DrawCalls);
 }
 
 void RasterizerOpenGL::DrawArrays() {
     if (accelerate_draw == AccelDraw::Disabled)
         return;
+    YUZU_TRACE_ZONE("DrawArrays");
+
+    // Taken before anything else, so that nothing called from here submits the same draws again
+    std::vector<PendingDraw> draws{std::move(pending_draws)};
+    pending_draws.clear();
+    if (draws.empty()) {
+        accelerate_draw = AccelDraw::Disabled;
+        return;
+    }
+
+    InvalidateWrittenPages();
 
     MICROPROFILE_SCOPE(OpenGL_Drawing);
-    const auto& gpu = Core::System::GetInstance().GPU().Maxwell3D();
+    const auto& gpu = system.GPU().Maxwell3D();
     const auto& regs = gpu.regs;
 
     ScopeAcquireGLContext acquire_context{emu_window};
 
     ConfigureFramebuffers();
 
-    SyncDepthTestState();
-    SyncStencilTestState();
-    SyncBlendState();
-    SyncLogicOpState();
-    SyncCullMode();
+    // Only the register groups written since the last draw have to be synced again
+    auto& maxwell3d = system.GPU().Maxwell3D();
+    if (maxwell3d.ConsumeDirtyFlag(DirtyFlag::DepthTest)) {
+        SyncDepthTestState();
+    }
+    if (maxwell3d.ConsumeDirtyFlag(DirtyFlag::StencilTest)) {
+        SyncStencilTestState();
+    }
+    if (maxwell3d.ConsumeDirtyFlag(DirtyFlag::Blend)) {
+        SyncBlendState();
+    }
+    if (maxwell3d.ConsumeDirtyFlag(DirtyFlag::LogicOp)) {
+        SyncLogicOpState();
+    }
+    if (maxwell3d.ConsumeDirtyFlag(DirtyFlag::CullMode)) {
+        SyncCullMode();
+    }
 
     // TODO(bunnei): Sync framebuffer_scale uniform here
     // TODO(bunnei): Sync scissorbox uniform(s) here
 
     // Draw the vertex batch
     const bool is_indexed = accelerate_draw == AccelDraw::Indexed;
-    const u64 index_buffer_size{static_cast<u64>(regs.index_array.count) *
-                                static_cast<u64>(regs.index_array.FormatSizeInBytes())};
+
+    // The index buffer is uploaded once for all the draws of the batch
+    u32 first_index{std::numeric_limits<u32>::max()};
+    u32 end_index{};
+    for (const auto& draw : draws) {
+        first_index = std::min(first_index, draw.first);
+        end_index = std::max(end_index, draw.first + draw.count);
+    }
+    const u64 index_format_size{regs.index_array.FormatSizeInBytes()};
+    const u64 index_buffer_size{is_indexed ? (end_index - first_index) * index_format_size : 0};
+
+    // Quads are drawn one by one, with the index buffers that turn them into triangles
+    const bool is_quads{regs.draw.topology == Maxwell::PrimitiveTopology::Quads};
+    const bool use_multi_draw{draws.size() > 1 && GLAD_GL_ARB_multi_draw_indirect && !is_quads};
+    const std::size_t indirect_command_size{is_indexed ? sizeof(DrawElementsIndirectCommand)
+                                                       : sizeof(DrawArraysIndirectCommand)};
 
     state.draw.vertex_buffer = buffer_cache.GetHandle();
     state.Apply();
@@ -476,6 +964,11 @@ void RasterizerOpenGL::DrawArrays() {
     // Add space for at least 18 constant buffers
     buffer_size += Maxwell::MaxConstBuffers * (MaxConstbufferSize + uniform_buffer_alignment);
 
+    if (use_multi_draw) {
+        buffer_size = Common::AlignUp<std::size_t>(buffer_size, 4) +
+                      indirect_command_size * draws.size();
+    }
+
     buffer_cache.Map(buffer_size);
 
     SetupVertexArrays();
@@ -487,45 +980,87 @@ void RasterizerOpenGL::DrawArrays() {
 
         // Adjust the index buffer offset so it points to the first desired index.
         auto index_start = regs.index_array.StartAddress();
-        index_start += static_cast<size_t>(regs.index_array.first) *
-                       static_cast<size_t>(regs.index_array.FormatSizeInBytes());
+        index_start += static_cast<size_t>(first_index) * static_cast<size_t>(index_format_size);
 
         index_buffer_offset = buffer_cache.UploadMemory(index_start, index_buffer_size);
     }
 
-    SetupShaders();
+    GLintptr indirect_buffer_offset = 0;
+    if (use_multi_draw) {
+        indirect_buffer_offset =
+            UploadIndirectCommands(draws, is_indexed, first_index, index_buffer_offset);
+    }
+
+    has_feedback_loop = false;
+    if (!SetupShaders()) {
+        buffer_cache.Unmap();
+        accelerate_draw = AccelDraw::Disabled;
+        return;
+    }
 
     buffer_cache.Unmap();
 
+    // Each instance of a draw sampling its own render targets needs a texture barrier of its own
+    if (has_feedback_loop) {
+        draws = SplitInstances(draws);
+    }
+
     shader_program_manager->ApplyTo(state);
     state.Apply();
+    query_cache.ResumeSamplesPassed();
 
+    // A draw that samples its own render targets only sees the texels rendered before the last
+    // texture barrier. The draws of the batch may overlap, so each of them is issued after one.
     const GLenum primitive_mode{MaxwellToGL::PrimitiveTopology(regs.draw.topology)};
-    if (is_indexed) {
-        const GLint base_vertex{static_cast<GLint>(regs.vb_element_base)};
-
-        if (gpu.state.current_instance > 0) {
-            glDrawElementsInstancedBaseVertexBaseInstance(
-                primitive_mode, regs.index_array.count,
-                MaxwellToGL::IndexFormat(regs.index_array.format),
-                reinterpret_cast<const void*>(index_buffer_offset), 1, base_vertex,
-                gpu.state.current_instance);
+    if (is_quads) {
+        DrawQuads(draws, is_indexed, first_index, index_buffer_offset);
+    } else if (use_multi_draw && !has_feedback_loop) {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, buffer_cache.GetHandle());
+        const auto* const indirect{reinterpret_cast<const void*>(indirect_buffer_offset)};
+        if (is_indexed) {
+            glMultiDrawElementsIndirect(primitive_mode,
+                                        MaxwellToGL::IndexFormat(regs.index_array.format),
+                                        indirect, static_cast<GLsizei>(draws.size()), 0);
         } else {
-            glDrawElementsBaseVertex(primitive_mode, regs.index_array.count,
-                                     MaxwellToGL::IndexFormat(regs.index_array.format),
-                                     reinterpret_cast<const void*>(index_buffer_offset),
-                                     base_vertex);
+            glMultiDrawArraysIndirect(primitive_mode, indirect,
+                                      static_cast<GLsizei>(draws.size()), 0);
+        }
+    } else if (is_indexed) {
+        for (const auto& draw : draws) {
+            const GLintptr offset{index_buffer_offset +
+                                  static_cast<GLintptr>((draw.first - first_index) *
+                                                        index_format_size)};
+            if (has_feedback_loop) {
+                TextureBarrier();
+            }
+            if (draw.base_instance > 0 || draw.instance_count > 1) {
+                glDrawElementsInstancedBaseVertexBaseInstance(
+                    primitive_mode, draw.count, MaxwellToGL::IndexFormat(regs.index_array.format),
+                    reinterpret_cast<const void*>(offset), draw.instance_count, draw.base_vertex,
+                    draw.base_instance);
+            } else {
+                glDrawElementsBaseVertex(primitive_mode, draw.count,
+                                         MaxwellToGL::IndexFormat(regs.index_array.format),
+                                         reinterpret_cast<const void*>(offset), draw.base_vertex);
+            }
         }
     } else {
-        if (gpu.state.current_instance > 0) {
-            glDrawArraysInstancedBaseInstance(primitive_mode, regs.vertex_buffer.first,
-                                              regs.vertex_buffer.count, 1,
-                                              gpu.state.current_instance);
-        } else {
-            glDrawArrays(primitive_mode, regs.vertex_buffer.first, regs.vertex_buffer.count);
+        for (const auto& draw : draws) {
+            if (has_feedback_loop) {
+                TextureBarrier();
+            }
+            if (draw.base_instance > 0 || draw.instance_count > 1) {
+                glDrawArraysInstancedBaseInstance(primitive_mode, draw.first, draw.count,
+                                                  draw.instance_count, draw.base_instance);
+            } else {
+                glDrawArrays(primitive_mode, draw.first, draw.count);
+            }
         }
     }
 
+    system.GetPerfStats().AddCounter(Core::PerfCounter::DrawCalls,
+                                                          draws.size());
+
     // Disable scissor test
     state.scissor.enabled = false;
 
@@ -538,18 +1073,145 @@ void RasterizerOpenGL::DrawArrays() {
     state.Apply();
 }
 
+std::vector<RasterizerOpenGL::PendingDraw> RasterizerOpenGL::SplitInstances(
+    const std::vector<PendingDraw>& draws) {
+    std::vector<PendingDraw> split_draws;
+    split_draws.reserve(draws.size());
+    for (const auto& draw : draws) {
+        for (GLuint instance = 0; instance < draw.instance_count; ++instance) {
+            PendingDraw& split_draw = split_draws.emplace_back(draw);
+            split_draw.base_instance = draw.base_instance + instance;
+            split_draw.instance_count = 1;
+        }
+    }
+    return split_draws;
+}
+
+void RasterizerOpenGL::DrawQuads(const std::vector<PendingDraw>& draws, bool is_indexed,
+                                 u32 first_index, GLintptr index_buffer_offset) {
+    const auto& regs = system.GPU().Maxwell3D().regs;
+    if (is_indexed && !IndexConverterOpenGL::IsSupported()) {
+        LOG_ERROR(Render_OpenGL, "Indexed quads can't be converted without compute shaders");
+        return;
+    }
+
+    for (const auto& draw : draws) {
+        const GLsizei num_indices{static_cast<GLsizei>(draw.count / 4 * 6)};
+        if (num_indices == 0) {
+            continue;
+        }
+
+        GLuint indices{};
+        GLint base_vertex{};
+        if (is_indexed) {
+            const GLintptr offset{index_buffer_offset +
+                                  static_cast<GLintptr>((draw.first - first_index) *
+                                                        regs.index_array.FormatSizeInBytes())};
+            indices = index_converter.ConvertIndexedQuads(
+                buffer_cache.GetHandle(), offset, regs.index_array.format, draw.count);
+            base_vertex = draw.base_vertex;
+        } else {
+            // The generated quads start at vertex zero, the base vertex moves them to the draw
+            indices = index_converter.GetQuadIndices(draw.count);
+            base_vertex = static_cast<GLint>(draw.first);
+        }
+
+        if (has_feedback_loop) {
+            TextureBarrier();
+        }
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices);
+        glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, num_indices, GL_UNSIGNED_INT,
+                                                      nullptr, draw.instance_count, base_vertex,
+                                                      draw.base_instance);
+    }
+
+    // The index buffer binding is part of the VAO, the cached ones all use the stream buffer
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer_cache.GetHandle());
+}
+
 void RasterizerOpenGL::FlushAll() {}
 
-void RasterizerOpenGL::FlushRegion(VAddr addr, u64 size) {}
+void RasterizerOpenGL::FlushRegion(VAddr addr, u64 size) {
+    MICROPROFILE_SCOPE(OpenGL_CacheManagement);
+    YUZU_TRACE_ZONE("FlushRegion");
+    if (!query_cache.IsRegionPending(addr, size) && !res_cache.IsRegionModified(addr, size)) {
+        return;
+    }
+
+    // Flushes can happen on any CPU core thread, whenever the guest reads a modified surface
+    ScopeAcquireGLContext acquire_context{emu_window};
+    query_cache.FlushRegion(addr, size);
+    Memory::AccessStats::RecordFlushedObjects("Surface", res_cache.FlushRegion(addr, size));
+}
 
 void RasterizerOpenGL::InvalidateRegion(VAddr addr, u64 size) {
     MICROPROFILE_SCOPE(OpenGL_CacheManagement);
-    res_cache.InvalidateRegion(addr, size);
-    shader_cache.InvalidateRegion(addr, size);
-    buffer_cache.InvalidateRegion(addr, size);
+    YUZU_TRACE_ZONE("InvalidateRegion");
+    if (size == 0) {
+        return;
+    }
+
+    if (!Settings::values.use_deferred_cache_invalidation) {
+        InvalidateCaches(addr, size);
+        return;
+    }
+
+    const u64 page_start{addr >> Memory::PAGE_BITS};
+    const u64 page_end{((addr + size - 1) >> Memory::PAGE_BITS) + 1};
+    const VAddr pages_addr{page_start << Memory::PAGE_BITS};
+    const u64 pages_size{(page_end - page_start) << Memory::PAGE_BITS};
+
+    // Pages holding surfaces modified by the GPU have to keep trapping reads, so that they are
+    // flushed before the guest sees them.
+    if (res_cache.IsRegionModified(pages_addr, pages_size)) {
+        InvalidateCaches(addr, size);
+        return;
+    }
+
+    // Everything cached in these pages is invalidated before the GPU uses its caches again. Until
+    // then, the pages go back to the fast memory path, as later writes don't change the outcome.
+    written_pages.add(boost::icl::interval<u64>::right_open(page_start, page_end));
+    Memory::RasterizerMarkRegionCached(pages_addr, pages_size, false);
+}
+
+void RasterizerOpenGL::InvalidateCaches(VAddr addr, u64 size) {
+    using Memory::AccessStats::RecordInvalidatedObjects;
+    RecordInvalidatedObjects("Surface", res_cache.InvalidateRegion(addr, size));
+    RecordInvalidatedObjects("Shader", shader_cache.InvalidateRegion(addr, size));
+    RecordInvalidatedObjects("Buffer", buffer_cache.InvalidateRegion(addr, size));
+    RecordInvalidatedObjects("BufferBlock", buffer_block_cache.InvalidateRegion(addr, size));
+}
+
+void RasterizerOpenGL::InvalidateWrittenPages() {
+    if (written_pages.empty()) {
+        return;
+    }
+
+    MICROPROFILE_SCOPE(OpenGL_CacheManagement);
+
+    // Objects may be registered on these pages until they are invalidated, in which case their
+    // pages are not marked as cached again. Resident buffer blocks survive invalidation, so the
+    // pages still covered by one have to trap writes again.
+    const auto pages{std::move(written_pages)};
+    written_pages.clear();
+    for (const auto& interval : pages) {
+        const VAddr addr{boost::icl::first(interval) << Memory::PAGE_BITS};
+        const u64 size{boost::icl::length(interval) << Memory::PAGE_BITS};
+        InvalidateCaches(addr, size);
+
+        const auto pages_interval{CachedPageMap::interval_type::right_open(
+            boost::icl::first(interval), boost::icl::last_next(interval))};
+        for (const auto& pair : RangeFromInterval(cached_pages, pages_interval)) {
+            const auto cached_interval{pair.first & pages_interval};
+            const VAddr cached_addr{boost::icl::first(cached_interval) << Memory::PAGE_BITS};
+            const u64 cached_size{boost::icl::length(cached_interval) << Memory::PAGE_BITS};
+            Memory::RasterizerMarkRegionCached(cached_addr, cached_size, true);
+        }
+    }
 }
 
 void RasterizerOpenGL::FlushAndInvalidateRegion(VAddr addr, u64 size) {
+    FlushRegion(addr, size);
     InvalidateRegion(addr, size);
 }
 
@@ -569,22 +1231,31 @@ bool RasterizerOpenGL::AccelerateFill(const void* config) {
     return true;
 }
 
+bool RasterizerOpenGL::AccelerateSurfaceCopy(const Tegra::Engines::Fermi2D::Regs::Surface& src,
+                                             const Tegra::Engines::Fermi2D::Regs::Surface& dst) {
+    MICROPROFILE_SCOPE(OpenGL_Blits);
+    return res_cache.AccelerateSurfaceCopy(src, dst);
+}
+
 bool RasterizerOpenGL::AccelerateDisplay(const Tegra::FramebufferConfig& config,
                                          VAddr framebuffer_addr, u32 pixel_stride) {
     if (!framebuffer_addr) {
         return {};
     }
 
+    InvalidateWrittenPages();
+
     MICROPROFILE_SCOPE(OpenGL_CacheManagement);
 
     const auto& surface{res_cache.TryFindFramebufferSurface(framebuffer_addr)};
     if (!surface) {
         return {};
     }
+    presented_addresses.insert(framebuffer_addr);
 
     // Verify that the cached surface is the same size and format as the requested framebuffer
     const auto& params{surface->GetSurfaceParams()};
-    const auto& pixel_format{SurfaceParams::PixelFormatFromGPUPixelFormat(config.pixel_format)};
+    const auto& pixel_format{PixelFormatFromGPUPixelFormat(config.pixel_format)};
     ASSERT_MSG(params.width == config.width, "Framebuffer width is different");
     ASSERT_MSG(params.height == config.height, "Framebuffer height is different");
     ASSERT_MSG(params.pixel_format == pixel_format, "Framebuffer pixel_format is different");
@@ -594,56 +1265,42 @@ bool RasterizerOpenGL::AccelerateDisplay(const Tegra::FramebufferConfig& config,
     return true;
 }
 
-void RasterizerOpenGL::SamplerInfo::Create() {
-    sampler.Create();
-    mag_filter = min_filter = Tegra::Texture::TextureFilter::Linear;
-    wrap_u = wrap_v = wrap_p = Tegra::Texture::WrapMode::Wrap;
-
-    // default is GL_LINEAR_MIPMAP_LINEAR
-    glSamplerParameteri(sampler.handle, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    // Other attributes have correct defaults
-}
-
-void RasterizerOpenGL::SamplerInfo::SyncWithConfig(const Tegra::Texture::TSCEntry& config) {
-    const GLuint s = sampler.handle;
-
-    if (mag_filter != config.mag_filter) {
-        mag_filter = config.mag_filter;
-        glSamplerParameteri(s, GL_TEXTURE_MAG_FILTER, MaxwellToGL::TextureFilterMode(mag_filter));
-    }
-    if (min_filter != config.min_filter) {
-        min_filter = config.min_filter;
-        glSamplerParameteri(s, GL_TEXTURE_MIN_FILTER, MaxwellToGL::TextureFilterMode(min_filter));
+GLintptr RasterizerOpenGL::UploadStreamed(StreamedUpload& last, const void* data,
+                                          std::size_t size) {
+    // Games tend to draw many times with the same uniforms, skip copying them again while the
+    // previous copy is still in the stream buffer
+    const u64 hash = Common::ComputeHash64(data, size);
+    const u64 generation = buffer_cache.GetGeneration();
+    if (last.buffer_generation == generation && last.hash == hash && last.size == size) {
+        return last.offset;
     }
 
-    if (wrap_u != config.wrap_u) {
-        wrap_u = config.wrap_u;
-        glSamplerParameteri(s, GL_TEXTURE_WRAP_S, MaxwellToGL::WrapMode(wrap_u));
-    }
-    if (wrap_v != config.wrap_v) {
-        wrap_v = config.wrap_v;
-        glSamplerParameteri(s, GL_TEXTURE_WRAP_T, MaxwellToGL::WrapMode(wrap_v));
-    }
-    if (wrap_p != config.wrap_p) {
-        wrap_p = config.wrap_p;
-        glSamplerParameteri(s, GL_TEXTURE_WRAP_R, MaxwellToGL::WrapMode(wrap_p));
-    }
+    last.hash = hash;
+    last.size = size;
+    last.offset = buffer_cache.UploadHostMemory(data, size,
+                                                static_cast<std::size_t>(uniform_buffer_alignment));
+    last.buffer_generation = generation;
+    return last.offset;
+}
 
-    if (wrap_u == Tegra::Texture::WrapMode::Border || wrap_v == Tegra::Texture::WrapMode::Border ||
-        wrap_p == Tegra::Texture::WrapMode::Border) {
-        const GLvec4 new_border_color = {{config.border_color_r, config.border_color_g,
-                                          config.border_color_b, config.border_color_a}};
-        if (border_color != new_border_color) {
-            border_color = new_border_color;
-            glSamplerParameterfv(s, GL_TEXTURE_BORDER_COLOR, border_color.data());
-        }
+GLintptr RasterizerOpenGL::UploadConstBuffer(StreamedUpload& last, Tegra::GPUVAddr gpu_addr,
+                                             std::size_t size) {
+    const auto& memory_manager = system.GPU().MemoryManager();
+    const boost::optional<VAddr> cpu_addr{memory_manager.GpuToCpuAddress(gpu_addr)};
+    const u8* const pointer = cpu_addr ? Memory::GetContiguousPointer(*cpu_addr, size) : nullptr;
+    if (pointer == nullptr) {
+        // The buffer has to be read page by page, it can't be hashed in place
+        last = {};
+        return buffer_cache.UploadMemory(gpu_addr, size,
+                                         static_cast<std::size_t>(uniform_buffer_alignment));
     }
+    return UploadStreamed(last, pointer, size);
 }
 
 u32 RasterizerOpenGL::SetupConstBuffers(Maxwell::ShaderStage stage, Shader& shader,
                                         u32 current_bindpoint) {
     MICROPROFILE_SCOPE(OpenGL_UBO);
-    const auto& gpu = Core::System::GetInstance().GPU();
+    const auto& gpu = system.GPU();
     const auto& maxwell3d = gpu.Maxwell3D();
     const auto& shader_stage = maxwell3d.state.shader_stages[static_cast<std::size_t>(stage)];
     const auto& entries = shader->GetShaderEntries().const_buffer_entries;
@@ -689,8 +1346,9 @@ u32 RasterizerOpenGL::SetupConstBuffers(Maxwell::ShaderStage stage, Shader& shad
         size = Common::AlignUp(size, sizeof(GLvec4));
         ASSERT_MSG(size <= MaxConstbufferSize, "Constbuffer too big");
 
-        GLintptr const_buffer_offset = buffer_cache.UploadMemory(
-            buffer.address, size, static_cast<std::size_t>(uniform_buffer_alignment));
+        const GLintptr const_buffer_offset = UploadConstBuffer(
+            const_buffer_uploads[static_cast<std::size_t>(stage)][used_buffer.GetIndex()],
+            buffer.address, size);
 
         // Now configure the bindpoint of the buffer inside the shader
         glUniformBlockBinding(shader->GetProgramHandle(),
@@ -709,9 +1367,23 @@ u32 RasterizerOpenGL::SetupConstBuffers(Maxwell::ShaderStage stage, Shader& shad
     return current_bindpoint + static_cast<u32>(entries.size());
 }
 
+bool RasterizerOpenGL::IsBoundRenderTarget(GLuint texture) const {
+    const auto& colors{bound_framebuffer_key.colors};
+    return texture == bound_framebuffer_key.zeta ||
+           std::find(colors.begin(), colors.end(), texture) != colors.end();
+}
+
+void RasterizerOpenGL::TextureBarrier() {
+    if (has_ARB_texture_barrier) {
+        glTextureBarrier();
+    } else {
+        glTextureBarrierNV();
+    }
+}
+
 u32 RasterizerOpenGL::SetupTextures(Maxwell::ShaderStage stage, Shader& shader, u32 current_unit) {
     MICROPROFILE_SCOPE(OpenGL_Texture);
-    const auto& gpu = Core::System::GetInstance().GPU();
+    const auto& gpu = system.GPU();
     const auto& maxwell3d = gpu.Maxwell3D();
     const auto& entries = shader->GetShaderEntries().texture_samplers;
 
@@ -734,10 +1406,20 @@ u32 RasterizerOpenGL::SetupTextures(Maxwell::ShaderStage stage, Shader& shader,
             continue;
         }
 
-        texture_samplers[current_bindpoint].SyncWithConfig(texture.tsc);
+        state.texture_units[current_bindpoint].sampler = sampler_cache.GetSampler(texture.tsc);
         Surface surface = res_cache.GetTextureSurface(texture);
         if (surface != nullptr) {
-            state.texture_units[current_bindpoint].texture = surface->Texture().handle;
+            GLuint handle{surface->Texture().handle};
+            if (IsBoundRenderTarget(handle)) {
+                // The draw reads the texture it renders to. A texture barrier before the draw
+                // keeps sampling the texture coherent, without one it is sampled from a copy.
+                if (has_ARB_texture_barrier || has_NV_texture_barrier) {
+                    has_feedback_loop = true;
+                } else if (const GLuint copy{surface->GetSampleCopy()}; copy != 0) {
+                    handle = copy;
+                }
+            }
+            state.texture_units[current_bindpoint].texture = handle;
             state.texture_units[current_bindpoint].target = surface->Target();
             state.texture_units[current_bindpoint].swizzle.r =
                 MaxwellToGL::SwizzleSource(texture.tic.x_source);
@@ -757,13 +1439,15 @@ u32 RasterizerOpenGL::SetupTextures(Maxwell::ShaderStage stage, Shader& shader,
 }
 
 void RasterizerOpenGL::SyncViewport() {
-    const auto& regs = Core::System::GetInstance().GPU().Maxwell3D().regs;
+    const auto& regs = system.GPU().Maxwell3D().regs;
     const MathUtil::Rectangle<s32> viewport_rect{regs.viewport_transform[0].GetRect()};
 
-    state.viewport.x = viewport_rect.left;
-    state.viewport.y = viewport_rect.bottom;
-    state.viewport.width = static_cast<GLsizei>(viewport_rect.GetWidth());
-    state.viewport.height = static_cast<GLsizei>(viewport_rect.GetHeight());
+    const auto scale{static_cast<s32>(framebuffer_scale)};
+
+    state.viewport.x = viewport_rect.left * scale;
+    state.viewport.y = viewport_rect.bottom * scale;
+    state.viewport.width = static_cast<GLsizei>(viewport_rect.GetWidth() * scale);
+    state.viewport.height = static_cast<GLsizei>(viewport_rect.GetHeight() * scale);
 }
 
 void RasterizerOpenGL::SyncClipEnabled() {
@@ -775,7 +1459,7 @@ void RasterizerOpenGL::SyncClipCoef() {
 }
 
 void RasterizerOpenGL::SyncCullMode() {
-    const auto& regs = Core::System::GetInstance().GPU().Maxwell3D().regs;
+    const auto& regs = system.GPU().Maxwell3D().regs;
 
     state.cull.enabled = regs.cull.enabled != 0;
 
@@ -807,7 +1491,7 @@ void RasterizerOpenGL::SyncDepthOffset() {
 }
 
 void RasterizerOpenGL::SyncDepthTestState() {
-    const auto& regs = Core::System::GetInstance().GPU().Maxwell3D().regs;
+    const auto& regs = system.GPU().Maxwell3D().regs;
 
     state.depth.test_enabled = regs.depth_test_enable != 0;
     state.depth.write_mask = regs.depth_write_enabled ? GL_TRUE : GL_FALSE;
@@ -819,7 +1503,7 @@ void RasterizerOpenGL::SyncDepthTestState() {
 }
 
 void RasterizerOpenGL::SyncStencilTestState() {
-    const auto& regs = Core::System::GetInstance().GPU().Maxwell3D().regs;
+    const auto& regs = system.GPU().Maxwell3D().regs;
     state.stencil.test_enabled = regs.stencil_enable != 0;
 
     if (!regs.stencil_enable) {
@@ -847,7 +1531,7 @@ void RasterizerOpenGL::SyncStencilTestState() {
 }
 
 void RasterizerOpenGL::SyncBlendState() {
-    const auto& regs = Core::System::GetInstance().GPU().Maxwell3D().regs;
+    const auto& regs = system.GPU().Maxwell3D().regs;
 
     // TODO(Subv): Support more than just render target 0.
     state.blend.enabled = regs.blend.enable[0] != 0;
@@ -869,7 +1553,7 @@ void RasterizerOpenGL::SyncBlendState() {
 }
 
 void RasterizerOpenGL::SyncLogicOpState() {
-    const auto& regs = Core::System::GetInstance().GPU().Maxwell3D().regs;
+    const auto& regs = system.GPU().Maxwell3D().regs;
 
     // TODO(Subv): Support more than just render target 0.
     state.logic_op.enabled = regs.logic_op.enable != 0;
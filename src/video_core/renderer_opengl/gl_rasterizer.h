@@ -9,28 +9,38 @@
 #include <map>
 #include <memory>
 #include <tuple>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include <boost/icl/interval_map.hpp>
+#include <boost/icl/interval_set.hpp>
 #include <boost/optional.hpp>
 #include <boost/range/iterator_range.hpp>
 #include <glad/glad.h>
 
 #include "common/common_types.h"
 #include "video_core/engines/maxwell_3d.h"
+#include "video_core/engines/maxwell_compute.h"
 #include "video_core/memory_manager.h"
 #include "video_core/rasterizer_cache.h"
 #include "video_core/rasterizer_interface.h"
 #include "video_core/renderer_opengl/gl_buffer_cache.h"
+#include "video_core/renderer_opengl/gl_index_converter.h"
+#include "video_core/renderer_opengl/gl_query_cache.h"
 #include "video_core/renderer_opengl/gl_rasterizer_cache.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
+#include "video_core/renderer_opengl/gl_sampler_cache.h"
 #include "video_core/renderer_opengl/gl_shader_cache.h"
 #include "video_core/renderer_opengl/gl_shader_gen.h"
 #include "video_core/renderer_opengl/gl_shader_manager.h"
 #include "video_core/renderer_opengl/gl_state.h"
 #include "video_core/renderer_opengl/gl_stream_buffer.h"
 
+namespace Core {
+class System;
+}
+
 namespace Core::Frontend {
 class EmuWindow;
 }
@@ -41,7 +51,8 @@ struct ScreenInfo;
 
 class RasterizerOpenGL : public VideoCore::RasterizerInterface {
 public:
-    explicit RasterizerOpenGL(Core::Frontend::EmuWindow& renderer, ScreenInfo& info);
+    explicit RasterizerOpenGL(Core::Frontend::EmuWindow& window, Core::System& system,
+                              ScreenInfo& info);
     ~RasterizerOpenGL() override;
 
     void DrawArrays() override;
@@ -53,10 +64,21 @@ public:
     bool AccelerateDisplayTransfer(const void* config) override;
     bool AccelerateTextureCopy(const void* config) override;
     bool AccelerateFill(const void* config) override;
+    bool AccelerateSurfaceCopy(const Tegra::Engines::Fermi2D::Regs::Surface& src,
+                               const Tegra::Engines::Fermi2D::Regs::Surface& dst) override;
     bool AccelerateDisplay(const Tegra::FramebufferConfig& config, VAddr framebuffer_addr,
                            u32 pixel_stride) override;
     bool AccelerateDrawBatch(bool is_indexed) override;
+    void FlushDrawBatch() override;
+    bool AccelerateSamplesPassedQuery(VAddr addr, bool short_query, u64 timestamp) override;
+    void NotifyPresent() override;
     void UpdatePagesCachedCount(Tegra::GPUVAddr addr, u64 size, int delta) override;
+    void TickFrame() override;
+    u8* AliasRegion(VAddr addr, u64 size) override;
+    void UnaliasRegion(VAddr addr) override;
+    void DispatchCompute(Tegra::GPUVAddr code_addr) override;
+    void LoadDiskResources(const VideoCore::DiskResourceLoadCallback& callback) override;
+    void ResetGuestState() override;
 
     /// OpenGL shader generated for a given Maxwell register state
     struct MaxwellShader {
@@ -78,25 +100,6 @@ public:
                   "The maximum size of a constbuffer must be a multiple of the size of GLvec4");
 
 private:
-    class SamplerInfo {
-    public:
-        OGLSampler sampler;
-
-        /// Creates the sampler object, initializing its state so that it's in sync with the
-        /// SamplerInfo struct.
-        void Create();
-        /// Syncs the sampler object with the config, updating any necessary state.
-        void SyncWithConfig(const Tegra::Texture::TSCEntry& config);
-
-    private:
-        Tegra::Texture::TextureFilter mag_filter;
-        Tegra::Texture::TextureFilter min_filter;
-        Tegra::Texture::WrapMode wrap_u;
-        Tegra::Texture::WrapMode wrap_v;
-        Tegra::Texture::WrapMode wrap_p;
-        GLvec4 border_color;
-    };
-
     /**
      * Configures the color and depth framebuffer states.
      * @param use_color_fb If true, configure color framebuffers.
@@ -108,6 +111,41 @@ private:
                                bool preserve_contents = true,
                                boost::optional<std::size_t> single_color_target = {});
 
+    /**
+     * Records a clear of whole surfaces on them instead of clearing them right away, which
+     * spares binding them to a framebuffer. Returns false if the clear has to be done now.
+     */
+    bool DeferClear(bool use_color, bool use_depth, bool use_stencil);
+
+    /// Attachments of a framebuffer object, the textures are the ones of the attached surfaces
+    struct FramebufferCacheKey {
+        std::array<GLuint, Tegra::Engines::Maxwell3D::Regs::NumRenderTargets> colors{};
+        std::array<GLenum, Tegra::Engines::Maxwell3D::Regs::NumRenderTargets> draw_buffers{};
+        std::size_t num_draw_buffers{};
+        GLuint zeta{};
+        bool stencil{};
+
+        auto Tie() const {
+            return std::tie(colors, draw_buffers, num_draw_buffers, zeta, stencil);
+        }
+
+        bool operator<(const FramebufferCacheKey& rhs) const {
+            return Tie() < rhs.Tie();
+        }
+    };
+
+    /**
+     * Returns a framebuffer object with the specified attachments, creating it if needed.
+     * @param surfaces Surfaces attached to the framebuffer, it is recreated once any of them dies
+     */
+    GLuint GetFramebuffer(const FramebufferCacheKey& key, const std::vector<Surface>& surfaces);
+
+    /// Returns whether a texture is attached to the framebuffer bound for the current draw
+    bool IsBoundRenderTarget(GLuint texture) const;
+
+    /// Issues a texture barrier, making the texels rendered so far visible to texture fetches
+    void TextureBarrier();
+
     /*
      * Configures the current constbuffers to use for the draw command.
      * @param stage The shader stage to configure buffers for.
@@ -118,6 +156,23 @@ private:
     u32 SetupConstBuffers(Tegra::Engines::Maxwell3D::Regs::ShaderStage stage, Shader& shader,
                           u32 current_bindpoint);
 
+    /// Data uploaded last to the stream buffer for a binding, reused while it doesn't change
+    struct StreamedUpload {
+        u64 hash = 0;
+        std::size_t size = 0;
+        GLintptr offset = 0;
+        u64 buffer_generation = 0;
+    };
+
+    /**
+     * Uploads host data to the stream buffer, unless it matches the last upload of the binding.
+     * @returns The offset of the data in the stream buffer.
+     */
+    GLintptr UploadStreamed(StreamedUpload& last, const void* data, std::size_t size);
+
+    /// Uploads a const buffer to the stream buffer, reusing the last upload when it is unchanged
+    GLintptr UploadConstBuffer(StreamedUpload& last, Tegra::GPUVAddr gpu_addr, std::size_t size);
+
     /*
      * Configures the current textures to use for the draw command.
      * @param stage The shader stage to configure textures for.
@@ -128,9 +183,12 @@ private:
     u32 SetupTextures(Tegra::Engines::Maxwell3D::Regs::ShaderStage stage, Shader& shader,
                       u32 current_unit);
 
-    /// Syncs the viewport to match the guest state
+    /// Syncs the viewport to match the guest state, scaled like the bound render targets
     void SyncViewport();
 
+    /// Returns the factor render targets are upscaled by, as per Settings::values.resolution_factor
+    u32 GetResolutionScale() const;
+
     /// Syncs the clip enabled status to match the guest state
     void SyncClipEnabled();
 
@@ -162,6 +220,8 @@ private:
     bool has_ARB_multi_bind = false;
     bool has_ARB_separate_shader_objects = false;
     bool has_ARB_vertex_attrib_binding = false;
+    bool has_ARB_texture_barrier = false;
+    bool has_NV_texture_barrier = false;
 
     OpenGLState state;
 
@@ -169,33 +229,143 @@ private:
     ShaderCacheOpenGL shader_cache;
 
     Core::Frontend::EmuWindow& emu_window;
+    Core::System& system;
 
     ScreenInfo& screen_info;
 
     std::unique_ptr<GLShader::ProgramManager> shader_program_manager;
+    /// VAO configured for a vertex attribute format, along with the binding state stored in it
+    struct CachedVertexArray {
+        OGLVertexArray vao;
+        std::array<GLuint, Tegra::Engines::Maxwell3D::Regs::NumVertexArrays> divisors{};
+    };
     std::map<std::array<Tegra::Engines::Maxwell3D::Regs::VertexAttribute,
                         Tegra::Engines::Maxwell3D::Regs::NumVertexAttributes>,
-             OGLVertexArray>
+             CachedVertexArray>
         vertex_array_cache;
 
-    std::array<SamplerInfo, GLShader::NumTextureSamplers> texture_samplers;
+    /// Framebuffer object with a set of attachments. GL names of deleted textures are reused, so
+    /// the attached surfaces are tracked to tell when the framebuffer has stale attachments.
+    struct CachedFramebuffer {
+        OGLFramebuffer framebuffer;
+        std::vector<std::weak_ptr<CachedSurface>> surfaces;
+    };
+    std::map<FramebufferCacheKey, CachedFramebuffer> framebuffer_cache;
+
+    SamplerCacheOpenGL sampler_cache;
+    QueryCacheOpenGL query_cache{*this};
+    IndexConverterOpenGL index_converter;
+
+    /// Last ready shader of each program, used while a new one is built asynchronously
+    std::array<Shader, Tegra::Engines::Maxwell3D::Regs::MaxShaderProgram> last_shaders;
 
     static constexpr std::size_t STREAM_BUFFER_SIZE = 128 * 1024 * 1024;
     OGLBufferCache buffer_cache;
-    OGLFramebuffer framebuffer;
+    OGLBufferBlockCache buffer_block_cache;
+
+    /// Guest region whose backing memory is a persistently mapped, coherent buffer
+    struct AliasedRegion {
+        OGLBuffer buffer;
+        u64 size;
+    };
+    /// Aliased regions by their guest address
+    std::map<VAddr, AliasedRegion> aliased_regions;
     GLint uniform_buffer_alignment;
 
+    std::array<StreamedUpload, Tegra::Engines::Maxwell3D::Regs::MaxShaderStage> uniform_uploads;
+    std::array<std::array<StreamedUpload, Tegra::Engines::Maxwell3D::Regs::MaxConstBuffers>,
+               Tegra::Engines::Maxwell3D::Regs::MaxShaderStage>
+        const_buffer_uploads;
+    std::array<StreamedUpload, Tegra::Engines::MaxwellCompute::NumConstBuffers>
+        compute_const_buffer_uploads;
+
+    /// Factor the render targets bound to the framebuffer are upscaled by
+    u32 framebuffer_scale = 1;
+
+    /// Attachments of the framebuffer bound for the current draw
+    FramebufferCacheKey bound_framebuffer_key;
+
+    /// Set when a texture sampled by the current draw is also one of its render targets, the
+    /// texels rendered by previous draws then have to be made visible with a texture barrier
+    bool has_feedback_loop = false;
+
+    /**
+     * Finds the aliased buffer holding the specified GPU region.
+     * @returns the handle of the buffer and the offset of the region in it, or a null handle.
+     */
+    std::pair<GLuint, GLintptr> FindAliasedBuffer(Tegra::GPUVAddr gpu_addr, u64 size) const;
+
     std::size_t CalculateVertexArraysSize() const;
 
     void SetupVertexArrays();
 
-    void SetupShaders();
+    /// Binds the shaders of all enabled stages, returns false when the draw has to be skipped
+    bool SetupShaders();
 
     enum class AccelDraw { Disabled, Arrays, Indexed };
     AccelDraw accelerate_draw = AccelDraw::Disabled;
 
+    /// Parameters of a draw that differ between the draws of a batch
+    struct PendingDraw {
+        GLuint count;
+        GLuint first;
+        GLint base_vertex;
+        GLuint base_instance;
+        /// Number of consecutive instances drawn with the same vertex range
+        GLuint instance_count;
+    };
+
+    /// Layouts of the commands read by glMultiDrawArraysIndirect and glMultiDrawElementsIndirect
+    struct DrawArraysIndirectCommand {
+        GLuint count;
+        GLuint instance_count;
+        GLuint first;
+        GLuint base_instance;
+    };
+    struct DrawElementsIndirectCommand {
+        GLuint count;
+        GLuint instance_count;
+        GLuint first_index;
+        GLint base_vertex;
+        GLuint base_instance;
+    };
+
+    /// Returns whether the current draw is dropped by the frame skip
+    bool IsDrawSkipped() const;
+
+    /// Guest addresses of the images that have been presented, draws to them are skipped in
+    /// frames that aren't going to be presented
+    std::unordered_set<VAddr> presented_addresses;
+
+    /// Maximum number of draws submitted at once
+    static constexpr std::size_t MaxDrawBatchSize = 256;
+
+    /// Draws sharing the same state, they are submitted before any of that state changes
+    std::vector<PendingDraw> pending_draws;
+
+    /// Turns the instanced draws of a batch back into one draw per instance
+    static std::vector<PendingDraw> SplitInstances(const std::vector<PendingDraw>& draws);
+
+    /// Draws a batch of quads as triangles, with index buffers from the index converter
+    void DrawQuads(const std::vector<PendingDraw>& draws, bool is_indexed, u32 first_index,
+                   GLintptr index_buffer_offset);
+
+    /// Uploads the indirect commands of a batch of draws, returns their offset in the buffer
+    GLintptr UploadIndirectCommands(const std::vector<PendingDraw>& draws, bool is_indexed,
+                                    u32 first_index, GLintptr index_buffer_offset);
+
     using CachedPageMap = boost::icl::interval_map<u64, int>;
     CachedPageMap cached_pages;
+
+    /// Invalidates the caches of all the pages written by the guest since the last call
+    void InvalidateWrittenPages();
+
+    /// Immediately invalidates the caches of the specified region
+    void InvalidateCaches(VAddr addr, u64 size);
+
+    /// Pages written by the guest whose caches haven't been invalidated yet, in page numbers.
+    /// These pages use the fast memory path until they are invalidated.
+    boost::icl::interval_set<u64> written_pages;
 };
 
 } // namespace OpenGL
@@ -3,6 +3,8 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cstring>
+#include <tuple>
 #include <glad/glad.h>
 
 #include "common/alignment.h"
@@ -13,18 +15,29 @@
 #include "core/core.h"
 #include "core/hle/kernel/process.h"
 #include "core/memory.h"
+#include "core/perf_stats.h"
 #include "core/settings.h"
 #include "video_core/engines/maxwell_3d.h"
 #include "video_core/renderer_opengl/gl_rasterizer_cache.h"
+#include "video_core/renderer_opengl/gl_texture_decoder.h"
 #include "video_core/textures/astc.h"
+#include "video_core/textures/bcn.h"
 #include "video_core/textures/decoders.h"
 #include "video_core/utils.h"
 
 namespace OpenGL {
 
-using SurfaceType = SurfaceParams::SurfaceType;
-using PixelFormat = SurfaceParams::PixelFormat;
-using ComponentType = SurfaceParams::ComponentType;
+using VideoCore::Surface::ComponentTypeFromDepthFormat;
+using VideoCore::Surface::ComponentTypeFromRenderTarget;
+using VideoCore::Surface::ComponentTypeFromTexture;
+using VideoCore::Surface::GetCompressionFactor;
+using VideoCore::Surface::GetFormatBpp;
+using VideoCore::Surface::GetFormatType;
+using VideoCore::Surface::MaxPixelFormat;
+using VideoCore::Surface::PixelFormatFromDepthFormat;
+using VideoCore::Surface::PixelFormatFromRenderTargetFormat;
+using VideoCore::Surface::PixelFormatFromTextureFormat;
+using VideoCore::Surface::SurfaceTargetFromTextureType;
 
 struct FormatTuple {
     GLint internal_format;
@@ -34,16 +47,45 @@ struct FormatTuple {
     bool compressed;
 };
 
-static VAddr TryGetCpuAddr(Tegra::GPUVAddr gpu_addr) {
-    auto& gpu{Core::System::GetInstance().GPU()};
-    const auto cpu_addr{gpu.MemoryManager().GpuToCpuAddress(gpu_addr)};
+const std::vector<u8>* DecodedTextureCache::Get(u64 key) {
+    const auto search{lookup.find(key)};
+    if (search == lookup.end()) {
+        return nullptr;
+    }
+
+    // Move the entry to the front, as it is now the most recently used one
+    entries.splice(entries.begin(), entries, search->second);
+    return &search->second->second;
+}
+
+void DecodedTextureCache::Insert(u64 key, std::vector<u8> decoded) {
+    if (decoded.size() > MAX_CACHE_SIZE || lookup.count(key) != 0) {
+        return;
+    }
+
+    total_size += decoded.size();
+    entries.emplace_front(key, std::move(decoded));
+    lookup.emplace(key, entries.begin());
+
+    while (total_size > MAX_CACHE_SIZE) {
+        const auto& oldest{entries.back()};
+        total_size -= oldest.second.size();
+        lookup.erase(oldest.first);
+        entries.pop_back();
+    }
+}
+
+static bool IsConvertedOnLoad(PixelFormat pixel_format);
+
+static VAddr TryGetCpuAddr(Core::System& system, Tegra::GPUVAddr gpu_addr) {
+    const auto cpu_addr{system.GPU().MemoryManager().GpuToCpuAddress(gpu_addr)};
     return cpu_addr ? *cpu_addr : 0;
 }
 
 /*static*/ SurfaceParams SurfaceParams::CreateForTexture(
-    const Tegra::Texture::FullTextureInfo& config) {
+    Core::System& system, const Tegra::Texture::FullTextureInfo& config) {
     SurfaceParams params{};
-    params.addr = TryGetCpuAddr(config.tic.Address());
+    params.addr = TryGetCpuAddr(system, config.tic.Address());
     params.is_tiled = config.tic.IsTiled();
     params.block_height = params.is_tiled ? config.tic.BlockHeight() : 0,
     params.pixel_format =
@@ -71,14 +113,29 @@ static VAddr TryGetCpuAddr(Tegra::GPUVAddr gpu_addr) {
         break;
     }
 
+    // Mipmaps are only loaded for tiled 2D textures and arrays that don't need to be converted in
+    // software, other textures only have their base level
+    params.num_levels = 1;
+    if (params.is_tiled && !IsConvertedOnLoad(params.pixel_format) &&
+        (params.target == SurfaceTarget::Texture2D ||
+         params.target == SurfaceTarget::Texture2DArray)) {
+        u32 max_levels = 1;
+        while ((std::max(params.width, params.height) >> max_levels) != 0) {
+            ++max_levels;
+        }
+        params.num_levels = std::min(config.tic.NumLevels(), max_levels);
+    }
+
     params.size_in_bytes = params.SizeInBytes();
+    params.resolution_scale = 1;
     return params;
 }
 
-/*static*/ SurfaceParams SurfaceParams::CreateForFramebuffer(std::size_t index) {
-    const auto& config{Core::System::GetInstance().GPU().Maxwell3D().regs.rt[index]};
+/*static*/ SurfaceParams SurfaceParams::CreateForFramebuffer(Core::System& system,
+                                                             std::size_t index) {
+    const auto& config{system.GPU().Maxwell3D().regs.rt[index]};
     SurfaceParams params{};
-    params.addr = TryGetCpuAddr(config.Address());
+    params.addr = TryGetCpuAddr(system, config.Address());
     params.is_tiled = true;
     params.block_height = Tegra::Texture::TICEntry::DefaultBlockHeight;
     params.pixel_format = PixelFormatFromRenderTargetFormat(config.format);
@@ -89,15 +146,38 @@ static VAddr TryGetCpuAddr(Tegra::GPUVAddr gpu_addr) {
     params.unaligned_height = config.height;
     params.target = SurfaceTarget::Texture2D;
     params.depth = 1;
+    params.num_levels = 1;
     params.size_in_bytes = params.SizeInBytes();
+    params.resolution_scale = 1;
     return params;
 }
 
-/*static*/ SurfaceParams SurfaceParams::CreateForDepthBuffer(u32 zeta_width, u32 zeta_height,
+/*static*/ SurfaceParams SurfaceParams::CreateForFermiCopySurface(
+    Core::System& system, const Tegra::Engines::Fermi2D::Regs::Surface& config) {
+    SurfaceParams params{};
+    params.addr = TryGetCpuAddr(system, config.Address());
+    params.is_tiled = !config.linear;
+    params.block_height = params.is_tiled ? config.BlockHeight() : 0;
+    params.pixel_format = PixelFormatFromRenderTargetFormat(config.format);
+    params.component_type = ComponentTypeFromRenderTarget(config.format);
+    params.type = GetFormatType(params.pixel_format);
+    params.width = config.width;
+    params.height = config.height;
+    params.unaligned_height = config.height;
+    params.target = SurfaceTarget::Texture2D;
+    params.depth = 1;
+    params.num_levels = 1;
+    params.size_in_bytes = params.SizeInBytes();
+    params.resolution_scale = 1;
+    return params;
+}
+
+/*static*/ SurfaceParams SurfaceParams::CreateForDepthBuffer(Core::System& system, u32 zeta_width,
+                                                             u32 zeta_height,
                                                              Tegra::GPUVAddr zeta_address,
                                                              Tegra::DepthFormat format) {
     SurfaceParams params{};
-    params.addr = TryGetCpuAddr(zeta_address);
+    params.addr = TryGetCpuAddr(system, zeta_address);
     params.is_tiled = true;
     params.block_height = Tegra::Texture::TICEntry::DefaultBlockHeight;
     params.pixel_format = PixelFormatFromDepthFormat(format);
@@ -108,11 +188,13 @@ static VAddr TryGetCpuAddr(Tegra::GPUVAddr gpu_addr) {
     params.unaligned_height = zeta_height;
     params.target = SurfaceTarget::Texture2D;
     params.depth = 1;
+    params.num_levels = 1;
     params.size_in_bytes = params.SizeInBytes();
+    params.resolution_scale = 1;
     return params;
 }
 
-static constexpr std::array<FormatTuple, SurfaceParams::MaxPixelFormat> tex_format_tuples = {{
+static constexpr std::array<FormatTuple, MaxPixelFormat> tex_format_tuples = {{
     {GL_RGBA8, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8_REV, ComponentType::UNorm, false}, // ABGR8U
     {GL_RGBA8, GL_RGBA, GL_BYTE, ComponentType::SNorm, false},                     // ABGR8S
     {GL_RGBA8UI, GL_RGBA_INTEGER, GL_UNSIGNED_BYTE, ComponentType::UInt, false},   // ABGR8UI
@@ -183,19 +265,19 @@ static constexpr std::array<FormatTuple, SurfaceParams::MaxPixelFormat> tex_form
      ComponentType::Float, false}, // Z32FS8
 }};
 
-static GLenum SurfaceTargetToGL(SurfaceParams::SurfaceTarget target) {
+static GLenum SurfaceTargetToGL(SurfaceTarget target) {
     switch (target) {
-    case SurfaceParams::SurfaceTarget::Texture1D:
+    case SurfaceTarget::Texture1D:
         return GL_TEXTURE_1D;
-    case SurfaceParams::SurfaceTarget::Texture2D:
+    case SurfaceTarget::Texture2D:
         return GL_TEXTURE_2D;
-    case SurfaceParams::SurfaceTarget::Texture3D:
+    case SurfaceTarget::Texture3D:
         return GL_TEXTURE_3D;
-    case SurfaceParams::SurfaceTarget::Texture1DArray:
+    case SurfaceTarget::Texture1DArray:
         return GL_TEXTURE_1D_ARRAY;
-    case SurfaceParams::SurfaceTarget::Texture2DArray:
+    case SurfaceTarget::Texture2DArray:
         return GL_TEXTURE_2D_ARRAY;
-    case SurfaceParams::SurfaceTarget::TextureCubemap:
+    case SurfaceTarget::TextureCubemap:
         return GL_TEXTURE_CUBE_MAP;
     }
     LOG_CRITICAL(Render_OpenGL, "Unimplemented texture target={}", static_cast<u32>(target));
@@ -203,9 +285,74 @@ static GLenum SurfaceTargetToGL(SurfaceParams::SurfaceTarget target) {
     return {};
 }
 
+/// Formats the BCn textures that the driver can't sample are decoded to, from DXT1 to BC6H_SF16
+static constexpr std::array<FormatTuple, 9> decoded_bcn_format_tuples = {{
+    {GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, ComponentType::UNorm, false}, // DXT1
+    {GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, ComponentType::UNorm, false}, // DXT23
+    {GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, ComponentType::UNorm, false}, // DXT45
+    {GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, ComponentType::UNorm, false}, // DXN1
+    {GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, ComponentType::UNorm, false}, // DXN2UNORM
+    {GL_RGBA8_SNORM, GL_RGBA, GL_BYTE, ComponentType::SNorm, false},    // DXN2SNORM
+    {GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, ComponentType::UNorm, false}, // BC7U
+    {GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT, ComponentType::UNorm, false},  // BC6H_UF16
+    {GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT, ComponentType::UNorm, false},  // BC6H_SF16
+}};
+
+/// Returns whether a BCn format can't be sampled by the driver and is decoded in software on load
+static bool IsBCnDecodedOnLoad(PixelFormat format) {
+    switch (format) {
+    case PixelFormat::DXT1:
+    case PixelFormat::DXT23:
+    case PixelFormat::DXT45:
+        return !GLAD_GL_EXT_texture_compression_s3tc;
+    case PixelFormat::DXN1:
+    case PixelFormat::DXN2UNORM:
+    case PixelFormat::DXN2SNORM:
+        // RGTC is part of OpenGL 3.0
+        return !GLAD_GL_VERSION_3_0 && !GLAD_GL_ARB_texture_compression_rgtc;
+    case PixelFormat::BC7U:
+    case PixelFormat::BC6H_UF16:
+    case PixelFormat::BC6H_SF16:
+        return !GLAD_GL_ARB_texture_compression_bptc;
+    default:
+        return false;
+    }
+}
+
+static Tegra::Texture::BCn::Format GetBCnFormat(PixelFormat format) {
+    using Tegra::Texture::BCn::Format;
+    switch (format) {
+    case PixelFormat::DXT1:
+        return Format::BC1;
+    case PixelFormat::DXT23:
+        return Format::BC2;
+    case PixelFormat::DXT45:
+        return Format::BC3;
+    case PixelFormat::DXN1:
+        return Format::BC4;
+    case PixelFormat::DXN2UNORM:
+        return Format::BC5U;
+    case PixelFormat::DXN2SNORM:
+        return Format::BC5S;
+    case PixelFormat::BC7U:
+        return Format::BC7;
+    case PixelFormat::BC6H_UF16:
+        return Format::BC6HU;
+    case PixelFormat::BC6H_SF16:
+        return Format::BC6HS;
+    default:
+        LOG_CRITICAL(HW_GPU, "Unhandled format: {}", static_cast<u32>(format));
+        UNREACHABLE();
+        return Format::BC1;
+    }
+}
+
 static const FormatTuple& GetFormatTuple(PixelFormat pixel_format, ComponentType component_type) {
     ASSERT(static_cast<std::size_t>(pixel_format) < tex_format_tuples.size());
-    auto& format = tex_format_tuples[static_cast<unsigned int>(pixel_format)];
+    auto& format = IsBCnDecodedOnLoad(pixel_format)
+                       ? decoded_bcn_format_tuples[static_cast<std::size_t>(pixel_format) -
+                                                   static_cast<std::size_t>(PixelFormat::DXT1)]
+                       : tex_format_tuples[static_cast<unsigned int>(pixel_format)];
     ASSERT(component_type == format.component_type);
 
     return format;
@@ -242,6 +389,89 @@ MathUtil::Rectangle<u32> SurfaceParams::GetRect() const {
     return {0, actual_height, width, 0};
 }
 
+MathUtil::Rectangle<u32> SurfaceParams::GetScaledRect() const {
+    const auto& rect{GetRect()};
+    return {0, rect.top * resolution_scale, rect.right * resolution_scale, 0};
+}
+
+u32 SurfaceParams::MipBlockHeight(u32 level) const {
+    if (level == 0) {
+        return block_height;
+    }
+
+    // Each level uses the base level's block height, halved for as long as the level is no taller
+    // than half a block
+    constexpr u32 gob_height{8};
+    const u32 compression_factor{GetCompressionFactor(pixel_format)};
+    const u32 height_in_tiles{(MipHeight(level) + compression_factor - 1) / compression_factor};
+    const u32 height_in_gobs{(height_in_tiles + gob_height - 1) / gob_height};
+    u32 mip_block_height{block_height};
+    while (mip_block_height > 1 && height_in_gobs <= mip_block_height / 2) {
+        mip_block_height /= 2;
+    }
+    return mip_block_height;
+}
+
+std::size_t SurfaceParams::GetLevelSizeInBytes(u32 level) const {
+    const u32 compression_factor{GetCompressionFactor(pixel_format)};
+    const std::size_t width_in_tiles{(MipWidth(level) + compression_factor - 1) /
+                                     compression_factor};
+    const std::size_t height_in_tiles{(MipHeight(level) + compression_factor - 1) /
+                                      compression_factor};
+    const std::size_t stride{width_in_tiles * GetFormatBpp(pixel_format) / CHAR_BIT};
+    if (!is_tiled) {
+        return stride * height_in_tiles;
+    }
+
+    // Tiled levels take whole blocks, which are one GOB wide and MipBlockHeight GOBs tall
+    constexpr std::size_t gob_width{64};
+    constexpr std::size_t gob_height{8};
+    return Common::AlignUp(stride, gob_width) *
+           Common::AlignUp(height_in_tiles, gob_height * MipBlockHeight(level));
+}
+
+std::size_t SurfaceParams::GetLevelOffset(u32 level) const {
+    std::size_t offset{};
+    for (u32 previous = 0; previous < level; ++previous) {
+        offset += GetLevelSizeInBytes(previous);
+    }
+    return offset;
+}
+
+std::size_t SurfaceParams::GetLayerSizeInBytes() const {
+    const std::size_t size{GetLevelOffset(num_levels)};
+    if (!is_tiled) {
+        return size;
+    }
+
+    // Each layer starts at a block of the base level
+    constexpr std::size_t gob_size{512};
+    return Common::AlignUp(size, gob_size * block_height);
+}
+
+std::size_t SurfaceParams::GetGLLevelSize(u32 level) const {
+    if (IsPixelFormatASTC(pixel_format)) {
+        // ASTC textures are decoded to RGBA8 in place, with the buffer sized for the result
+        return static_cast<std::size_t>(MipWidth(level)) * MipHeight(level) *
+               GetFormatBpp(pixel_format) / CHAR_BIT;
+    }
+
+    const u32 compression_factor{GetCompressionFactor(pixel_format)};
+    const std::size_t width_in_tiles{(MipWidth(level) + compression_factor - 1) /
+                                     compression_factor};
+    const std::size_t height_in_tiles{(MipHeight(level) + compression_factor - 1) /
+                                      compression_factor};
+    return width_in_tiles * height_in_tiles * GetFormatBpp(pixel_format) / CHAR_BIT;
+}
+
+std::size_t SurfaceParams::GetGLLevelOffset(u32 level) const {
+    std::size_t offset{};
+    for (u32 previous = 0; previous < level; ++previous) {
+        offset += GetGLLevelSize(previous) * depth;
+    }
+    return offset;
+}
+
 /// Returns true if the specified PixelFormat is a BCn format, e.g. DXT or DXN
 static bool IsFormatBCn(PixelFormat format) {
     switch (format) {
@@ -262,17 +492,18 @@ static bool IsFormatBCn(PixelFormat format) {
 template <bool morton_to_gl, PixelFormat format>
 void MortonCopy(u32 stride, u32 block_height, u32 height, u8* gl_buffer, std::size_t gl_buffer_size,
                 VAddr addr) {
-    constexpr u32 bytes_per_pixel = SurfaceParams::GetFormatBpp(format) / CHAR_BIT;
+    constexpr u32 bytes_per_pixel = GetFormatBpp(format) / CHAR_BIT;
     constexpr u32 gl_bytes_per_pixel = CachedSurface::GetGLBytesPerPixel(format);
 
     if (morton_to_gl) {
         // With the BCn formats (DXT and DXN), each 4x4 tile is swizzled instead of just individual
         // pixel values.
         const u32 tile_size{IsFormatBCn(format) ? 4U : 1U};
-        const std::vector<u8> data = Tegra::Texture::UnswizzleTexture(
-            addr, tile_size, bytes_per_pixel, stride, height, block_height);
-        const std::size_t size_to_copy{std::min(gl_buffer_size, data.size())};
-        memcpy(gl_buffer, data.data(), size_to_copy);
+        ASSERT(static_cast<std::size_t>(stride / tile_size) * (height / tile_size) *
+                   bytes_per_pixel <=
+               gl_buffer_size);
+        Tegra::Texture::UnswizzleTexture(gl_buffer, addr, tile_size, bytes_per_pixel, stride,
+                                         height, block_height);
     } else {
         // TODO(bunnei): Assumes the default rendering GOB size of 16 (128 lines). We should
         // check the configuration for this and perform more generic un/swizzle
@@ -283,7 +514,7 @@ void MortonCopy(u32 stride, u32 block_height, u32 height, u8* gl_buffer, std::si
 }
 
 static constexpr std::array<void (*)(u32, u32, u32, u8*, std::size_t, VAddr),
-                            SurfaceParams::MaxPixelFormat>
+                            MaxPixelFormat>
     morton_to_gl_fns = {
         // clang-format off
         MortonCopy<true, PixelFormat::ABGR8U>,
@@ -341,7 +572,7 @@ static constexpr std::array<void (*)(u32, u32, u32, u8*, std::size_t, VAddr),
 };
 
 static constexpr std::array<void (*)(u32, u32, u32, u8*, std::size_t, VAddr),
-                            SurfaceParams::MaxPixelFormat>
+                            MaxPixelFormat>
     gl_to_morton_fns = {
         // clang-format off
         MortonCopy<false, PixelFormat::ABGR8U>,
@@ -403,104 +634,131 @@ static constexpr std::array<void (*)(u32, u32, u32, u8*, std::size_t, VAddr),
 static bool BlitTextures(GLuint src_tex, const MathUtil::Rectangle<u32>& src_rect, GLuint dst_tex,
                          const MathUtil::Rectangle<u32>& dst_rect, SurfaceType type,
                          GLuint read_fb_handle, GLuint draw_fb_handle) {
-    OpenGLState prev_state{OpenGLState::GetCurState()};
-    SCOPE_EXIT({ prev_state.Apply(); });
-
-    OpenGLState state;
-    state.draw.read_framebuffer = read_fb_handle;
-    state.draw.draw_framebuffer = draw_fb_handle;
-    state.Apply();
-
+    // The framebuffers are edited and blitted with direct state access, so the bindings in the
+    // current state are left untouched
     u32 buffers{};
 
     if (type == SurfaceType::ColorTexture) {
-        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, src_tex,
-                               0);
-        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, 0,
-                               0);
+        glNamedFramebufferTexture(read_fb_handle, GL_COLOR_ATTACHMENT0, src_tex, 0);
+        glNamedFramebufferTexture(read_fb_handle, GL_DEPTH_STENCIL_ATTACHMENT, 0, 0);
 
-        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, dst_tex,
-                               0);
-        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, 0,
-                               0);
+        glNamedFramebufferTexture(draw_fb_handle, GL_COLOR_ATTACHMENT0, dst_tex, 0);
+        glNamedFramebufferTexture(draw_fb_handle, GL_DEPTH_STENCIL_ATTACHMENT, 0, 0);
 
         buffers = GL_COLOR_BUFFER_BIT;
     } else if (type == SurfaceType::Depth) {
-        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
-        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, src_tex, 0);
-        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_TEXTURE_2D, 0, 0);
+        glNamedFramebufferTexture(read_fb_handle, GL_COLOR_ATTACHMENT0, 0, 0);
+        glNamedFramebufferTexture(read_fb_handle, GL_DEPTH_ATTACHMENT, src_tex, 0);
+        glNamedFramebufferTexture(read_fb_handle, GL_STENCIL_ATTACHMENT, 0, 0);
 
-        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
-        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, dst_tex, 0);
-        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_TEXTURE_2D, 0, 0);
+        glNamedFramebufferTexture(draw_fb_handle, GL_COLOR_ATTACHMENT0, 0, 0);
+        glNamedFramebufferTexture(draw_fb_handle, GL_DEPTH_ATTACHMENT, dst_tex, 0);
+        glNamedFramebufferTexture(draw_fb_handle, GL_STENCIL_ATTACHMENT, 0, 0);
 
         buffers = GL_DEPTH_BUFFER_BIT;
     } else if (type == SurfaceType::DepthStencil) {
-        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
-        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D,
-                               src_tex, 0);
+        glNamedFramebufferTexture(read_fb_handle, GL_COLOR_ATTACHMENT0, 0, 0);
+        glNamedFramebufferTexture(read_fb_handle, GL_DEPTH_STENCIL_ATTACHMENT, src_tex, 0);
 
-        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
-        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D,
-                               dst_tex, 0);
+        glNamedFramebufferTexture(draw_fb_handle, GL_COLOR_ATTACHMENT0, 0, 0);
+        glNamedFramebufferTexture(draw_fb_handle, GL_DEPTH_STENCIL_ATTACHMENT, dst_tex, 0);
 
         buffers = GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT;
     }
 
-    glBlitFramebuffer(src_rect.left, src_rect.bottom, src_rect.right, src_rect.top, dst_rect.left,
-                      dst_rect.bottom, dst_rect.right, dst_rect.top, buffers,
-                      buffers == GL_COLOR_BUFFER_BIT ? GL_LINEAR : GL_NEAREST);
+    glBlitNamedFramebuffer(read_fb_handle, draw_fb_handle, src_rect.left, src_rect.bottom,
+                           src_rect.right, src_rect.top, dst_rect.left, dst_rect.bottom,
+                           dst_rect.right, dst_rect.top, buffers,
+                           buffers == GL_COLOR_BUFFER_BIT ? GL_LINEAR : GL_NEAREST);
 
     return true;
 }
 
+/// Allocates the storage of all the levels of a texture created for the given surface parameters
+static void AllocateTextureStorage(GLuint texture, const SurfaceParams& params) {
+    const auto& rect{params.GetScaledRect()};
+    const auto& format_tuple = GetFormatTuple(params.pixel_format, params.component_type);
+    const auto num_levels{static_cast<GLsizei>(params.num_levels)};
+    switch (params.target) {
+    case SurfaceTarget::Texture1D:
+        glTextureStorage1D(texture, num_levels, format_tuple.internal_format, rect.GetWidth());
+        break;
+    case SurfaceTarget::Texture2D:
+        glTextureStorage2D(texture, num_levels, format_tuple.internal_format, rect.GetWidth(),
+                           rect.GetHeight());
+        break;
+    case SurfaceTarget::Texture3D:
+    case SurfaceTarget::Texture2DArray:
+        glTextureStorage3D(texture, num_levels, format_tuple.internal_format, rect.GetWidth(),
+                           rect.GetHeight(), params.depth);
+        break;
+    default:
+        LOG_CRITICAL(Render_OpenGL, "Unimplemented surface target={}",
+                     static_cast<u32>(params.target));
+        UNREACHABLE();
+        glTextureStorage2D(texture, 1, format_tuple.internal_format, rect.GetWidth(),
+                           rect.GetHeight());
+    }
+}
+
+/// Copies every level of a texture to another one with the same storage
+static void CopyTextureLevels(GLuint src_tex, GLuint dst_tex, GLenum target,
+                              const SurfaceParams& params) {
+    const auto& rect{params.GetScaledRect()};
+    for (u32 level = 0; level < params.num_levels; ++level) {
+        const u32 width{std::max(rect.GetWidth() >> level, 1U)};
+        const u32 height{params.target == SurfaceTarget::Texture1D
+                             ? 1U
+                             : std::max(rect.GetHeight() >> level, 1U)};
+        u32 depth{1};
+        if (params.target == SurfaceTarget::Texture3D) {
+            depth = std::max(params.depth >> level, 1U);
+        } else if (params.target == SurfaceTarget::Texture2DArray) {
+            depth = params.depth;
+        }
+        glCopyImageSubData(src_tex, target, static_cast<GLint>(level), 0, 0, 0, dst_tex, target,
+                           static_cast<GLint>(level), 0, 0, 0, static_cast<GLsizei>(width),
+                           static_cast<GLsizei>(height), static_cast<GLsizei>(depth));
+    }
+}
+
 CachedSurface::CachedSurface(const SurfaceParams& params)
     : params(params), gl_target(SurfaceTargetToGL(params.target)) {
-    texture.Create();
-    const auto& rect{params.GetRect()};
-
-    // Keep track of previous texture bindings
-    OpenGLState cur_state = OpenGLState::GetCurState();
-    const auto& old_tex = cur_state.texture_units[0];
-    SCOPE_EXIT({
-        cur_state.texture_units[0] = old_tex;
-        cur_state.Apply();
-    });
+    CreateTexture();
+}
 
-    cur_state.texture_units[0].texture = texture.handle;
-    cur_state.texture_units[0].target = SurfaceTargetToGL(params.target);
-    cur_state.Apply();
-    glActiveTexture(GL_TEXTURE0);
+void CachedSurface::CreateTexture() {
+    texture = std::make_shared<SurfaceTexture>();
+    texture->texture.Create(gl_target);
 
+    // The texture is set up with direct state access, so no texture unit has to be bound
     const auto& format_tuple = GetFormatTuple(params.pixel_format, params.component_type);
     if (!format_tuple.compressed) {
         // Only pre-create the texture for non-compressed textures.
-        switch (params.target) {
-        case SurfaceParams::SurfaceTarget::Texture1D:
-            glTexStorage1D(SurfaceTargetToGL(params.target), 1, format_tuple.internal_format,
-                           rect.GetWidth());
-            break;
-        case SurfaceParams::SurfaceTarget::Texture2D:
-            glTexStorage2D(SurfaceTargetToGL(params.target), 1, format_tuple.internal_format,
-                           rect.GetWidth(), rect.GetHeight());
-            break;
-        case SurfaceParams::SurfaceTarget::Texture3D:
-        case SurfaceParams::SurfaceTarget::Texture2DArray:
-            glTexStorage3D(SurfaceTargetToGL(params.target), 1, format_tuple.internal_format,
-                           rect.GetWidth(), rect.GetHeight(), params.depth);
-            break;
-        default:
-            LOG_CRITICAL(Render_OpenGL, "Unimplemented surface target={}",
-                         static_cast<u32>(params.target));
-            UNREACHABLE();
-            glTexStorage2D(GL_TEXTURE_2D, 1, format_tuple.internal_format, rect.GetWidth(),
-                           rect.GetHeight());
-        }
+        AllocateTextureStorage(texture->texture.handle, params);
     }
 
-    glTexParameteri(SurfaceTargetToGL(params.target), GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(SurfaceTargetToGL(params.target), GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(SurfaceTargetToGL(params.target), GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(texture->texture.handle, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    // Compressed textures are specified level by level, so GL has to be told how many there are
+    glTextureParameteri(texture->texture.handle, GL_TEXTURE_MAX_LEVEL,
+                        static_cast<GLint>(params.num_levels - 1));
+    glTextureParameteri(texture->texture.handle, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(texture->texture.handle, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+void CachedSurface::PrepareForWrite(bool preserve_contents) {
+    if (texture.use_count() > 1) {
+        // The texture is shared with surfaces loaded from identical data, which must not see the
+        // write, so this surface continues on a texture of its own
+        const std::shared_ptr<SurfaceTexture> shared_texture{texture};
+        CreateTexture();
+        if (preserve_contents) {
+            CopyTextureLevels(shared_texture->texture.handle, texture->texture.handle, gl_target,
+                              params);
+        }
+    }
+    // The contents no longer match the data the texture was loaded from
+    texture->content_hash = 0;
 }
 
 static void ConvertS8Z24ToZ24S8(std::vector<u8>& data, u32 width, u32 height) {
@@ -530,6 +788,19 @@ static void ConvertS8Z24ToZ24S8(std::vector<u8>& data, u32 width, u32 height) {
     }
 }
 
+static void ConvertZ24S8ToS8Z24(std::vector<u8>& data, u32 width, u32 height) {
+    constexpr auto bpp{CachedSurface::GetGLBytesPerPixel(PixelFormat::S8Z24)};
+    for (std::size_t y = 0; y < height; ++y) {
+        for (std::size_t x = 0; x < width; ++x) {
+            const std::size_t offset{bpp * (y * width + x)};
+            u32 value;
+            std::memcpy(&value, &data[offset], sizeof(u32));
+            value = (value >> 8) | (value << 24);
+            std::memcpy(&data[offset], &value, sizeof(u32));
+        }
+    }
+}
+
 static void ConvertG8R8ToR8G8(std::vector<u8>& data, u32 width, u32 height) {
     constexpr auto bpp{CachedSurface::GetGLBytesPerPixel(PixelFormat::G8R8U)};
     for (std::size_t y = 0; y < height; ++y) {
@@ -542,21 +813,68 @@ static void ConvertG8R8ToR8G8(std::vector<u8>& data, u32 width, u32 height) {
     }
 }
 
+/// Returns whether a pixel format has to be converted by ConvertFormatAsNeeded_LoadGLBuffer
+static bool IsConvertedOnLoad(PixelFormat pixel_format) {
+    switch (pixel_format) {
+    case PixelFormat::ASTC_2D_4X4:
+    case PixelFormat::ASTC_2D_8X8:
+    case PixelFormat::S8Z24:
+    case PixelFormat::G8R8U:
+    case PixelFormat::G8R8S:
+        return true;
+    default:
+        return IsBCnDecodedOnLoad(pixel_format);
+    }
+}
+
+/// Decodes all the layers of a BCn texture, laid out one after the other
+static std::vector<u8> DecodeBCn(const std::vector<u8>& data, PixelFormat pixel_format, u32 width,
+                                 u32 height, u32 depth) {
+    namespace BCn = Tegra::Texture::BCn;
+    const BCn::Format format{GetBCnFormat(pixel_format)};
+    const std::size_t encoded_layer_size{BCn::GetEncodedSize(format, width, height)};
+    const std::size_t decoded_layer_size{static_cast<std::size_t>(width) * height *
+                                         BCn::GetDecodedBytesPerPixel(format)};
+    ASSERT(data.size() >= encoded_layer_size * depth);
+
+    std::vector<u8> decoded(decoded_layer_size * depth);
+    for (u32 layer = 0; layer < depth; ++layer) {
+        BCn::Decompress(data.data() + layer * encoded_layer_size,
+                        decoded.data() + layer * decoded_layer_size, format, width, height);
+    }
+    return decoded;
+}
+
 /**
  * Helper function to perform software conversion (as needed) when loading a buffer from Switch
  * memory. This is for Maxwell pixel formats that cannot be represented as-is in OpenGL or with
  * typical desktop GPUs.
  */
 static void ConvertFormatAsNeeded_LoadGLBuffer(std::vector<u8>& data, PixelFormat pixel_format,
-                                               u32 width, u32 height) {
+                                               u32 width, u32 height, u32 depth,
+                                               DecodedTextureCache& decoded_cache) {
+    // The same assets are reloaded every time their surface is invalidated, so textures decoded in
+    // software are looked up by a hash of their data first.
+    const auto get_decoded_key = [&] {
+        return Common::ComputeHash64(data.data(), data.size()) ^
+               ((static_cast<u64>(width) << 32 | height) * 31 + static_cast<u64>(pixel_format));
+    };
+
     switch (pixel_format) {
     case PixelFormat::ASTC_2D_4X4:
     case PixelFormat::ASTC_2D_8X8: {
         // Convert ASTC pixel formats to RGBA8, as most desktop GPUs do not support ASTC.
+        const u64 key{get_decoded_key()};
+        if (const auto* const decoded = decoded_cache.Get(key)) {
+            data = *decoded;
+            break;
+        }
+
         u32 block_width{};
         u32 block_height{};
         std::tie(block_width, block_height) = GetASTCBlockSize(pixel_format);
         data = Tegra::Texture::ASTC::Decompress(data, width, height, block_width, block_height);
+        decoded_cache.Insert(key, data);
         break;
     }
     case PixelFormat::S8Z24:
@@ -569,174 +887,469 @@ static void ConvertFormatAsNeeded_LoadGLBuffer(std::vector<u8>& data, PixelForma
         // Convert the G8R8 color format to R8G8, as OpenGL does not support G8R8.
         ConvertG8R8ToR8G8(data, width, height);
         break;
+
+    case PixelFormat::DXT1:
+    case PixelFormat::DXT23:
+    case PixelFormat::DXT45:
+    case PixelFormat::DXN1:
+    case PixelFormat::DXN2UNORM:
+    case PixelFormat::DXN2SNORM:
+    case PixelFormat::BC7U:
+    case PixelFormat::BC6H_UF16:
+    case PixelFormat::BC6H_SF16: {
+        // BCn formats are uploaded compressed, unless the driver lacks the extension for them
+        if (!IsBCnDecodedOnLoad(pixel_format)) {
+            break;
+        }
+        const u64 key{get_decoded_key()};
+        if (const auto* const decoded = decoded_cache.Get(key)) {
+            data = *decoded;
+            break;
+        }
+        data = DecodeBCn(data, pixel_format, width, height, depth);
+        decoded_cache.Insert(key, data);
+        break;
+    }
+    }
+}
+
+void CachedSurface::Reuse(const SurfaceParams& new_params) {
+    ASSERT(SurfaceReserveKey::Create(params) == SurfaceReserveKey::Create(new_params));
+    params = new_params;
+    is_modified = false;
+    is_read_by_guest = false;
+    pending_clear = boost::none;
+    // A readback still in flight has the contents of the previous surface
+    readback_fence.Release();
+}
+
+bool CachedSurface::CanDeferClear() const {
+    if (!GLAD_GL_ARB_clear_texture) {
+        return false;
+    }
+    // Integer color formats are cleared with integer values, which clears don't keep track of
+    return params.type == SurfaceType::Depth || params.type == SurfaceType::DepthStencil ||
+           (params.type == SurfaceType::ColorTexture &&
+            params.component_type != ComponentType::SInt &&
+            params.component_type != ComponentType::UInt &&
+            !GetFormatTuple(params.pixel_format, params.component_type).compressed);
+}
+
+void CachedSurface::DeferClear(const SurfaceClearValue& value) {
+    ASSERT(CanDeferClear());
+    pending_clear = value;
+    // The contents in memory are stale from now on, a readback in flight included
+    is_modified = true;
+    readback_fence.Release();
+}
+
+void CachedSurface::ApplyPendingClear() {
+    if (!pending_clear) {
+        return;
+    }
+    const SurfaceClearValue value{*pending_clear};
+    pending_clear = boost::none;
+    PrepareForWrite(false);
+
+    // The texture is cleared directly, so no framebuffer nor state has to be set up for it
+    switch (params.type) {
+    case SurfaceType::ColorTexture:
+        glClearTexImage(texture->texture.handle, 0, GL_RGBA, GL_FLOAT, value.color.data());
+        break;
+    case SurfaceType::Depth:
+        glClearTexImage(texture->texture.handle, 0, GL_DEPTH_COMPONENT, GL_FLOAT, &value.depth);
+        break;
+    case SurfaceType::DepthStencil: {
+        struct {
+            float depth;
+            u32 stencil;
+        } const depth_stencil{value.depth, value.stencil};
+        glClearTexImage(texture->texture.handle, 0, GL_DEPTH_STENCIL,
+                        GL_FLOAT_32_UNSIGNED_INT_24_8_REV, &depth_stencil);
+        break;
+    }
+    default:
+        UNREACHABLE();
+    }
+}
+
+GLuint CachedSurface::GetSampleCopy() {
+    if (!GLAD_GL_ARB_copy_image ||
+        GetFormatTuple(params.pixel_format, params.component_type).compressed) {
+        return 0;
+    }
+    ApplyPendingClear();
+
+    // The copy is created along the texture's storage, it is kept for the next feedback loops
+    if (sample_copy.handle == 0) {
+        sample_copy.Create(gl_target);
+        AllocateTextureStorage(sample_copy.handle, params);
+        glTextureParameteri(sample_copy.handle, GL_TEXTURE_MAX_LEVEL,
+                            static_cast<GLint>(params.num_levels - 1));
     }
+
+    CopyTextureLevels(texture->texture.handle, sample_copy.handle, gl_target, params);
+    return sample_copy.handle;
+}
+
+std::size_t CachedSurface::GetGLBufferSize() const {
+    return params.GetGLLevelOffset(params.num_levels);
+}
+
+std::size_t CachedSurface::GetTextureMemorySize() const {
+    return GetGLBufferSize() * params.resolution_scale * params.resolution_scale;
+}
+
+bool CachedSurface::CanLoadWithoutConversion() const {
+    return !IsConvertedOnLoad(params.pixel_format);
+}
+
+void CachedSurface::LoadGLBuffer(DecodedTextureCache& decoded_cache) {
+    gl_buffer.resize(GetGLBufferSize());
+    LoadGLBuffer(gl_buffer.data());
+
+    ConvertFormatAsNeeded_LoadGLBuffer(gl_buffer, params.pixel_format, params.width, params.height,
+                                       params.depth, decoded_cache);
 }
 
 MICROPROFILE_DEFINE(OpenGL_SurfaceLoad, "OpenGL", "Surface Load", MP_RGB(128, 64, 192));
-void CachedSurface::LoadGLBuffer() {
+void CachedSurface::LoadGLBuffer(u8* buffer) {
     ASSERT(params.type != SurfaceType::Fill);
 
     const u8* const texture_src_data = Memory::GetPointer(params.addr);
 
     ASSERT(texture_src_data);
 
-    const u32 bytes_per_pixel = GetGLBytesPerPixel(params.pixel_format);
-    const u32 copy_size = params.width * params.height * bytes_per_pixel;
-
     MICROPROFILE_SCOPE(OpenGL_SurfaceLoad);
 
-    if (params.is_tiled) {
-        // TODO(bunnei): This only unswizzles and copies a 2D texture - we do not yet know how to do
-        // this for 3D textures, etc.
-        switch (params.target) {
-        case SurfaceParams::SurfaceTarget::Texture2D:
-            // Pass impl. to the fallback code below
-            break;
-        default:
-            LOG_CRITICAL(HW_GPU, "Unimplemented tiled load for target={}",
-                         static_cast<u32>(params.target));
-            UNREACHABLE();
+    if (!params.is_tiled) {
+        std::memcpy(buffer, texture_src_data, GetGLBufferSize());
+        return;
+    }
+
+    // TODO(bunnei): This only unswizzles and copies 2D textures and arrays - we do not yet know
+    // how to do this for 3D textures, etc.
+    switch (params.target) {
+    case SurfaceTarget::Texture2D:
+    case SurfaceTarget::Texture2DArray:
+        break;
+    default:
+        LOG_CRITICAL(HW_GPU, "Unimplemented tiled load for target={}",
+                     static_cast<u32>(params.target));
+        UNREACHABLE();
+    }
+
+    // Every layer and level is unswizzled into its place in the buffer, so that all of them are
+    // uploaded from the same allocation
+    const u32 compression_factor{GetCompressionFactor(params.pixel_format)};
+    const std::size_t layer_size{params.GetLayerSizeInBytes()};
+    const auto unswizzle{morton_to_gl_fns[static_cast<std::size_t>(params.pixel_format)]};
+    for (u32 level = 0; level < params.num_levels; ++level) {
+        const u32 width{Common::AlignUp(params.MipWidth(level), compression_factor)};
+        const u32 height{Common::AlignUp(params.MipHeight(level), compression_factor)};
+        const u32 block_height{params.MipBlockHeight(level)};
+        const std::size_t gl_level_size{params.GetGLLevelSize(level)};
+        u8* const level_buffer{buffer + params.GetGLLevelOffset(level)};
+        const VAddr level_addr{params.addr + params.GetLevelOffset(level)};
+        for (u32 layer = 0; layer < params.depth; ++layer) {
+            unswizzle(width, block_height, height, level_buffer + layer * gl_level_size,
+                         gl_level_size, level_addr + layer * layer_size);
         }
+    }
+}
 
-        gl_buffer.resize(static_cast<std::size_t>(params.depth) * copy_size);
-        morton_to_gl_fns[static_cast<std::size_t>(params.pixel_format)](
-            params.width, params.block_height, params.height, gl_buffer.data(), copy_size,
-            params.addr);
+/**
+ * Helper function to perform software conversion (as needed) when flushing a buffer to Switch
+ * memory. This undoes the conversions done by ConvertFormatAsNeeded_LoadGLBuffer.
+ */
+static void ConvertFormatAsNeeded_FlushGLBuffer(std::vector<u8>& data, PixelFormat pixel_format,
+                                                u32 width, u32 height) {
+    switch (pixel_format) {
+    case PixelFormat::S8Z24:
+        ConvertZ24S8ToS8Z24(data, width, height);
+        break;
+    case PixelFormat::G8R8U:
+    case PixelFormat::G8R8S:
+        // The conversion only swaps the components, so flushing is the same operation
+        ConvertG8R8ToR8G8(data, width, height);
+        break;
+    }
+}
+
+/// Returns whether a surface can be read back from the GPU and written to guest memory
+static bool IsFlushable(const SurfaceParams& params) {
+    const FormatTuple& tuple{GetFormatTuple(params.pixel_format, params.component_type)};
+    return !tuple.compressed && !IsPixelFormatASTC(params.pixel_format) &&
+           !IsBCnDecodedOnLoad(params.pixel_format) &&
+           params.target == SurfaceTarget::Texture2D;
+}
+
+void CachedSurface::StartAsyncFlush(GLuint read_fb_handle, GLuint draw_fb_handle) {
+    if (!is_modified || readback_fence.handle != 0 || !IsFlushable(params)) {
+        return;
+    }
+    ApplyPendingClear();
+
+    const FormatTuple& tuple{GetFormatTuple(params.pixel_format, params.component_type)};
+    const auto& rect{params.GetRect()};
+    const GLsizei buffer_size{static_cast<GLsizei>(rect.GetWidth() * rect.GetHeight() *
+                                                   GetGLBytesPerPixel(params.pixel_format))};
+
+    if (readback_buffer.handle == 0) {
+        readback_buffer.Create();
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback_buffer.handle);
+        glBufferData(GL_PIXEL_PACK_BUFFER, buffer_size, nullptr, GL_STREAM_READ);
     } else {
-        const u8* const texture_src_data_end{texture_src_data +
-                                             (static_cast<std::size_t>(params.depth) * copy_size)};
-        gl_buffer.assign(texture_src_data, texture_src_data_end);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback_buffer.handle);
+    }
+
+    GLuint readback_texture{texture->texture.handle};
+    if (params.resolution_scale != 1) {
+        // Only the guest resolution is read back, so scaled surfaces are filtered down to it on
+        // the GPU, and rendering at a higher resolution adds nothing to the readback
+        if (downscaled_texture.handle == 0) {
+            downscaled_texture.Create(GL_TEXTURE_2D);
+            glTextureStorage2D(downscaled_texture.handle, 1, tuple.internal_format,
+                               rect.GetWidth(), rect.GetHeight());
+        }
+        BlitTextures(texture->texture.handle, params.GetScaledRect(), downscaled_texture.handle,
+                     rect, params.type, read_fb_handle, draw_fb_handle);
+        readback_texture = downscaled_texture.handle;
     }
 
-    ConvertFormatAsNeeded_LoadGLBuffer(gl_buffer, params.pixel_format, params.width, params.height);
+    // The copy into the pixel buffer is asynchronous, the fence tells when it is complete
+    glGetTextureImage(readback_texture, 0, tuple.format, tuple.type, buffer_size, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    readback_fence.Create();
 }
 
 MICROPROFILE_DEFINE(OpenGL_SurfaceFlush, "OpenGL", "Surface Flush", MP_RGB(128, 192, 64));
-void CachedSurface::FlushGLBuffer() {
-    ASSERT_MSG(false, "Unimplemented");
+void CachedSurface::FlushGLBuffer(GLuint read_fb_handle, GLuint draw_fb_handle) {
+    if (!is_modified) {
+        return;
+    }
+    ApplyPendingClear();
+
+    is_modified = false;
+    is_read_by_guest = true;
+
+    if (!IsFlushable(params)) {
+        LOG_WARNING(Render_OpenGL, "Unimplemented flush for pixel_format={}, target={}",
+                    static_cast<u32>(params.pixel_format), static_cast<u32>(params.target));
+        return;
+    }
+
+    u8* const texture_dst_data{Memory::GetPointer(params.addr)};
+    ASSERT(texture_dst_data);
+
+    MICROPROFILE_SCOPE(OpenGL_SurfaceFlush);
+
+    if (readback_fence.handle == 0) {
+        // No readback was started ahead of time, so this has to wait for the whole copy
+        is_modified = true;
+        StartAsyncFlush(read_fb_handle, draw_fb_handle);
+        is_modified = false;
+    }
+
+    GLenum wait_result;
+    do {
+        wait_result =
+            glClientWaitSync(readback_fence.handle, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000'000);
+    } while (wait_result == GL_TIMEOUT_EXPIRED);
+    readback_fence.Release();
+
+    const auto& rect{params.GetRect()};
+    const u32 bytes_per_pixel{GetGLBytesPerPixel(params.pixel_format)};
+    const std::size_t readback_size{static_cast<std::size_t>(rect.GetWidth()) *
+                                    rect.GetHeight() * bytes_per_pixel};
+    gl_buffer.resize(readback_size);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback_buffer.handle);
+    glGetBufferSubData(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(readback_size),
+                       gl_buffer.data());
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    ConvertFormatAsNeeded_FlushGLBuffer(gl_buffer, params.pixel_format, rect.GetWidth(),
+                                        rect.GetHeight());
+
+    // The data is written through the host pointer, as writing through Memory::Write would
+    // invalidate this surface.
+    if (params.is_tiled) {
+        Tegra::Texture::CopySwizzledData(rect.GetWidth(), rect.GetHeight(), bytes_per_pixel,
+                                         bytes_per_pixel, texture_dst_data, gl_buffer.data(),
+                                         false, params.block_height);
+    } else {
+        std::memcpy(texture_dst_data, gl_buffer.data(), readback_size);
+    }
 }
 
-MICROPROFILE_DEFINE(OpenGL_TextureUL, "OpenGL", "Texture Upload", MP_RGB(128, 64, 192));
 void CachedSurface::UploadGLTexture(GLuint read_fb_handle, GLuint draw_fb_handle) {
     if (params.type == SurfaceType::Fill)
         return;
 
-    MICROPROFILE_SCOPE(OpenGL_TextureUL);
+    ASSERT(gl_buffer.size() == GetGLBufferSize());
+    UploadGLData(gl_buffer.data());
+}
 
-    ASSERT(gl_buffer.size() == static_cast<std::size_t>(params.width) * params.height *
-                                   GetGLBytesPerPixel(params.pixel_format) * params.depth);
+void CachedSurface::UploadGLTexture(GLintptr unpack_buffer_offset) {
+    // GL reads from the bound pixel unpack buffer at the offset given in place of a pointer
+    UploadGLData(reinterpret_cast<const u8*>(unpack_buffer_offset));
+}
 
-    const auto& rect{params.GetRect()};
+MICROPROFILE_DEFINE(OpenGL_TextureUL, "OpenGL", "Texture Upload", MP_RGB(128, 64, 192));
+void CachedSurface::UploadGLData(const u8* data) {
+    MICROPROFILE_SCOPE(OpenGL_TextureUL);
+    PrepareForWrite(false);
 
-    // Load data from memory to the surface
-    const GLint x0 = static_cast<GLint>(rect.left);
-    const GLint y0 = static_cast<GLint>(rect.bottom);
-    const std::size_t buffer_offset =
-        static_cast<std::size_t>(static_cast<std::size_t>(y0) * params.width +
-                                 static_cast<std::size_t>(x0)) *
-        GetGLBytesPerPixel(params.pixel_format);
+    const auto& rect{params.GetRect()};
 
     const FormatTuple& tuple = GetFormatTuple(params.pixel_format, params.component_type);
-    const GLuint target_tex = texture.handle;
-    OpenGLState cur_state = OpenGLState::GetCurState();
+    const GLuint target_tex = texture->texture.handle;
 
-    const auto& old_tex = cur_state.texture_units[0];
+    // Compressed textures have no storage allocated up front and are specified through the bound
+    // texture, everything else is uploaded with direct state access
+    OpenGLState cur_state = OpenGLState::GetCurState();
+    const auto old_tex = cur_state.texture_units[0];
     SCOPE_EXIT({
-        cur_state.texture_units[0] = old_tex;
-        cur_state.Apply();
+        if (tuple.compressed) {
+            cur_state.texture_units[0] = old_tex;
+            cur_state.Apply();
+        }
     });
-    cur_state.texture_units[0].texture = target_tex;
-    cur_state.texture_units[0].target = SurfaceTargetToGL(params.target);
-    cur_state.Apply();
+    if (tuple.compressed) {
+        cur_state.texture_units[0].texture = target_tex;
+        cur_state.texture_units[0].target = SurfaceTargetToGL(params.target);
+        cur_state.Apply();
+        glActiveTexture(GL_TEXTURE0);
+    }
 
-    // Ensure no bad interactions with GL_UNPACK_ALIGNMENT
+    // Ensure no bad interactions with GL_UNPACK_ALIGNMENT. The rows of smaller mipmap levels can
+    // be narrower than that, so they are uploaded with byte alignment.
     ASSERT(params.width * GetGLBytesPerPixel(params.pixel_format) % 4 == 0);
-    glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(params.width));
+    if (params.num_levels > 1) {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    }
 
-    glActiveTexture(GL_TEXTURE0);
-    if (tuple.compressed) {
-        switch (params.target) {
-        case SurfaceParams::SurfaceTarget::Texture2D:
-            glCompressedTexImage2D(
-                SurfaceTargetToGL(params.target), 0, tuple.internal_format,
-                static_cast<GLsizei>(params.width), static_cast<GLsizei>(params.height), 0,
-                static_cast<GLsizei>(params.size_in_bytes), &gl_buffer[buffer_offset]);
-            break;
-        case SurfaceParams::SurfaceTarget::Texture3D:
-        case SurfaceParams::SurfaceTarget::Texture2DArray:
-            glCompressedTexImage3D(
-                SurfaceTargetToGL(params.target), 0, tuple.internal_format,
-                static_cast<GLsizei>(params.width), static_cast<GLsizei>(params.height),
-                static_cast<GLsizei>(params.depth), 0, static_cast<GLsizei>(params.size_in_bytes),
-                &gl_buffer[buffer_offset]);
-            break;
-        default:
-            LOG_CRITICAL(Render_OpenGL, "Unimplemented surface target={}",
-                         static_cast<u32>(params.target));
-            UNREACHABLE();
-            glCompressedTexImage2D(
-                GL_TEXTURE_2D, 0, tuple.internal_format, static_cast<GLsizei>(params.width),
-                static_cast<GLsizei>(params.height), 0, static_cast<GLsizei>(params.size_in_bytes),
-                &gl_buffer[buffer_offset]);
+    for (u32 level = 0; level < params.num_levels; ++level) {
+        // Load data from memory to the surface
+        const auto gl_level{static_cast<GLint>(level)};
+        const u8* const level_data{data + params.GetGLLevelOffset(level)};
+        const auto width{static_cast<GLsizei>(std::max(1U, rect.GetWidth() >> level))};
+        const auto height{static_cast<GLsizei>(std::max(1U, rect.GetHeight() >> level))};
+        const auto depth{static_cast<GLsizei>(params.depth)};
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(params.MipWidth(level)));
+
+        if (tuple.compressed) {
+            const auto mip_width{static_cast<GLsizei>(params.MipWidth(level))};
+            const auto mip_height{static_cast<GLsizei>(params.MipHeight(level))};
+            const auto image_size{static_cast<GLsizei>(params.GetGLLevelSize(level) * depth)};
+            switch (params.target) {
+            case SurfaceTarget::Texture2D:
+                glCompressedTexImage2D(SurfaceTargetToGL(params.target), gl_level,
+                                       tuple.internal_format, mip_width, mip_height, 0, image_size,
+                                       level_data);
+                break;
+            case SurfaceTarget::Texture3D:
+            case SurfaceTarget::Texture2DArray:
+                glCompressedTexImage3D(SurfaceTargetToGL(params.target), gl_level,
+                                       tuple.internal_format, mip_width, mip_height, depth, 0,
+                                       image_size, level_data);
+                break;
+            default:
+                LOG_CRITICAL(Render_OpenGL, "Unimplemented surface target={}",
+                             static_cast<u32>(params.target));
+                UNREACHABLE();
+                glCompressedTexImage2D(GL_TEXTURE_2D, gl_level, tuple.internal_format, mip_width,
+                                       mip_height, 0, image_size, level_data);
+            }
+            continue;
         }
-    } else {
 
         switch (params.target) {
-        case SurfaceParams::SurfaceTarget::Texture1D:
-            glTexSubImage1D(SurfaceTargetToGL(params.target), 0, x0,
-                            static_cast<GLsizei>(rect.GetWidth()), tuple.format, tuple.type,
-                            &gl_buffer[buffer_offset]);
+        case SurfaceTarget::Texture1D:
+            glTextureSubImage1D(target_tex, gl_level, 0, width, tuple.format, tuple.type,
+                                level_data);
             break;
-        case SurfaceParams::SurfaceTarget::Texture2D:
-            glTexSubImage2D(SurfaceTargetToGL(params.target), 0, x0, y0,
-                            static_cast<GLsizei>(rect.GetWidth()),
-                            static_cast<GLsizei>(rect.GetHeight()), tuple.format, tuple.type,
-                            &gl_buffer[buffer_offset]);
+        case SurfaceTarget::Texture2D:
+            glTextureSubImage2D(target_tex, gl_level, 0, 0, width, height, tuple.format,
+                                tuple.type, level_data);
             break;
-        case SurfaceParams::SurfaceTarget::Texture3D:
-        case SurfaceParams::SurfaceTarget::Texture2DArray:
-            glTexSubImage3D(SurfaceTargetToGL(params.target), 0, x0, y0, 0,
-                            static_cast<GLsizei>(rect.GetWidth()),
-                            static_cast<GLsizei>(rect.GetHeight()), params.depth, tuple.format,
-                            tuple.type, &gl_buffer[buffer_offset]);
+        case SurfaceTarget::Texture3D:
+        case SurfaceTarget::Texture2DArray:
+            glTextureSubImage3D(target_tex, gl_level, 0, 0, 0, width, height, depth, tuple.format,
+                                tuple.type, level_data);
             break;
         default:
             LOG_CRITICAL(Render_OpenGL, "Unimplemented surface target={}",
                          static_cast<u32>(params.target));
             UNREACHABLE();
-            glTexSubImage2D(GL_TEXTURE_2D, 0, x0, y0, static_cast<GLsizei>(rect.GetWidth()),
-                            static_cast<GLsizei>(rect.GetHeight()), tuple.format, tuple.type,
-                            &gl_buffer[buffer_offset]);
+            glTextureSubImage2D(target_tex, gl_level, 0, 0, width, height, tuple.format,
+                                tuple.type, level_data);
         }
     }
 
     glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    if (params.num_levels > 1) {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
 }
 
-RasterizerCacheOpenGL::RasterizerCacheOpenGL() {
+RasterizerCacheOpenGL::RasterizerCacheOpenGL(VideoCore::RasterizerInterface& rasterizer,
+                                             Core::System& system)
+    : RasterizerCache{rasterizer}, system{system},
+      upload_buffer(GL_PIXEL_UNPACK_BUFFER, UPLOAD_BUFFER_SIZE) {
     read_framebuffer.Create();
     draw_framebuffer.Create();
     copy_pbo.Create();
+
+    if (Settings::values.use_gpu_texture_decoding) {
+        if (ComputeTextureDecoder::IsSupported()) {
+            texture_decoder = std::make_unique<ComputeTextureDecoder>();
+        } else {
+            LOG_WARNING(Render_OpenGL, "Compute shaders are unsupported, textures will be decoded "
+                                       "on the CPU");
+        }
+    }
 }
 
+RasterizerCacheOpenGL::~RasterizerCacheOpenGL() = default;
+
 Surface RasterizerCacheOpenGL::GetTextureSurface(const Tegra::Texture::FullTextureInfo& config) {
-    return GetSurface(SurfaceParams::CreateForTexture(config));
+    SurfaceParams params{SurfaceParams::CreateForTexture(system, config)};
+
+    // Textures are sampled with normalized coordinates, so a render target rendered at a higher
+    // resolution is sampled at its own scale instead of being downscaled
+    if (const Surface cached{TryGet(params.addr)}) {
+        const u32 cached_scale{cached->GetSurfaceParams().resolution_scale};
+        if (cached_scale != 1) {
+            params.resolution_scale = cached_scale;
+            params.num_levels = 1;
+            params.size_in_bytes = params.SizeInBytes();
+        }
+    }
+
+    return GetSurface(params);
 }
 
 Surface RasterizerCacheOpenGL::GetDepthBufferSurface(bool preserve_contents) {
-    const auto& regs{Core::System::GetInstance().GPU().Maxwell3D().regs};
+    const auto& regs{system.GPU().Maxwell3D().regs};
     if (!regs.zeta.Address() || !regs.zeta_enable) {
         return {};
     }
 
     SurfaceParams depth_params{SurfaceParams::CreateForDepthBuffer(
-        regs.zeta_width, regs.zeta_height, regs.zeta.Address(), regs.zeta.format)};
+        system, regs.zeta_width, regs.zeta_height, regs.zeta.Address(), regs.zeta.format)};
+    depth_params.resolution_scale = resolution_scale;
 
-    return GetSurface(depth_params, preserve_contents);
+    // Render targets are drawn to, so they can't keep sharing a texture
+    const Surface surface{GetSurface(depth_params, preserve_contents)};
+    if (surface) {
+        surface->PrepareForWrite(preserve_contents);
+    }
+    return surface;
 }
 
 Surface RasterizerCacheOpenGL::GetColorBufferSurface(std::size_t index, bool preserve_contents) {
-    const auto& regs{Core::System::GetInstance().GPU().Maxwell3D().regs};
+    const auto& regs{system.GPU().Maxwell3D().regs};
 
     ASSERT(index < Tegra::Engines::Maxwell3D::Regs::NumRenderTargets);
 
@@ -748,18 +1361,210 @@ Surface RasterizerCacheOpenGL::GetColorBufferSurface(std::size_t index, bool pre
         return {};
     }
 
-    const SurfaceParams color_params{SurfaceParams::CreateForFramebuffer(index)};
+    SurfaceParams color_params{SurfaceParams::CreateForFramebuffer(system, index)};
+    color_params.resolution_scale = resolution_scale;
 
-    return GetSurface(color_params, preserve_contents);
+    const Surface surface{GetSurface(color_params, preserve_contents)};
+    if (surface) {
+        surface->PrepareForWrite(preserve_contents);
+    }
+    return surface;
 }
 
 void RasterizerCacheOpenGL::LoadSurface(const Surface& surface) {
-    surface->LoadGLBuffer();
-    surface->UploadGLTexture(read_framebuffer.handle, draw_framebuffer.handle);
+    if (surface->GetSurfaceParams().resolution_scale != 1) {
+        LoadScaledSurface(surface);
+        return;
+    }
+
+    u64 content_hash{};
+    if (LoadDeduplicatedSurface(surface, content_hash)) {
+        return;
+    }
+
+    if (!(texture_decoder && LoadSurfaceWithCompute(surface)) &&
+        !LoadSurfaceWithUploadBuffer(surface)) {
+        surface->LoadGLBuffer(decoded_cache);
+        surface->UploadGLTexture(read_framebuffer.handle, draw_framebuffer.handle);
+    }
+
+    // Registered only once loaded, as uploading to the texture resets its hash
+    if (content_hash != 0) {
+        surface->GetSharedTexture()->content_hash = content_hash;
+        deduplicated_textures[content_hash] = surface->GetSharedTexture();
+    }
+}
+
+bool RasterizerCacheOpenGL::LoadDeduplicatedSurface(const Surface& surface, u64& content_hash) {
+    // Small textures are cheaper to upload than to hash, and compressed ones have no storage the
+    // copy on write could be made into
+    constexpr std::size_t MinDeduplicatedSize{64 * 1024};
+    const SurfaceParams& params{surface->GetSurfaceParams()};
+    if (!Settings::values.use_texture_deduplication || !GLAD_GL_ARB_copy_image ||
+        params.type == SurfaceType::Fill || params.size_in_bytes < MinDeduplicatedSize ||
+        GetFormatTuple(params.pixel_format, params.component_type).compressed) {
+        return false;
+    }
+
+    const u8* const data{Memory::GetPointer(params.addr)};
+    if (data == nullptr) {
+        return false;
+    }
+
+    // The guest layout is part of the key, as the same data decodes differently with another one
+    u64 hash{Common::ComputeHash64(data, params.size_in_bytes)};
+    const auto combine = [&hash](u64 value) {
+        hash ^= value + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+    };
+    combine(SurfaceReserveKey::Create(params).Hash());
+    combine(params.is_tiled);
+    combine(params.block_height);
+
+    const auto it{deduplicated_textures.find(hash)};
+    if (it != deduplicated_textures.end()) {
+        if (const auto shared_texture{it->second.lock()}) {
+            if (shared_texture->content_hash == hash) {
+                surface->ShareTexture(shared_texture);
+                system.GetPerfStats().AddCounter(Core::PerfCounter::TextureDedup,
+                                                 surface->GetTextureMemorySize());
+                return true;
+            }
+        } else {
+            deduplicated_textures.erase(it);
+        }
+    }
+
+    content_hash = hash;
+    return false;
+}
+
+void RasterizerCacheOpenGL::LoadScaledSurface(const Surface& surface) {
+    const SurfaceParams& params{surface->GetSurfaceParams()};
+    if (params.type == SurfaceType::Fill) {
+        return;
+    }
+
+    // The guest data is loaded at its own resolution into a surface from the reserve, which is
+    // then stretched over the scaled texture
+    SurfaceParams native_params{params};
+    native_params.resolution_scale = 1;
+    const Surface native_surface{GetUncachedSurface(native_params)};
+    LoadSurface(native_surface);
+
+    surface->PrepareForWrite(false);
+    BlitTextures(native_surface->Texture().handle, native_params.GetRect(),
+                 surface->Texture().handle, params.GetScaledRect(), params.type,
+                 read_framebuffer.handle, draw_framebuffer.handle);
+}
+
+bool RasterizerCacheOpenGL::LoadSurfaceWithUploadBuffer(const Surface& surface) {
+    const SurfaceParams& params{surface->GetSurfaceParams()};
+    const auto size{static_cast<GLsizeiptr>(surface->GetGLBufferSize())};
+    if (params.type == SurfaceType::Fill || !surface->CanLoadWithoutConversion() ||
+        size > upload_buffer.GetSize()) {
+        return false;
+    }
+
+    // Unswizzle straight into the mapped buffer and let GL upload from there, the rows passed to
+    // glTexSubImage have to stay 4-byte aligned just like with client memory
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload_buffer.GetHandle());
+    u8* pointer{};
+    GLintptr offset{};
+    std::tie(pointer, offset, std::ignore) = upload_buffer.Map(size, 4);
+    surface->LoadGLBuffer(pointer);
+    upload_buffer.Unmap(size);
+
+    surface->UploadGLTexture(offset);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return true;
+}
+
+bool RasterizerCacheOpenGL::LoadSurfaceWithCompute(const Surface& surface) {
+    const SurfaceParams& params{surface->GetSurfaceParams()};
+    if (!params.is_tiled || params.type == SurfaceType::Fill ||
+        params.target != SurfaceTarget::Texture2D || params.depth != 1 ||
+        params.num_levels != 1) {
+        return false;
+    }
+
+    // Only formats that are uploaded with the same size as in guest memory are handled, which
+    // excludes compressed formats and formats decoded in software.
+    const FormatTuple& tuple{GetFormatTuple(params.pixel_format, params.component_type)};
+    const u32 bytes_per_pixel{CachedSurface::GetGLBytesPerPixel(params.pixel_format)};
+    if (tuple.compressed || IsBCnDecodedOnLoad(params.pixel_format) ||
+        bytes_per_pixel * CHAR_BIT != GetFormatBpp(params.pixel_format)) {
+        return false;
+    }
+
+    TextureConversion conversion{TextureConversion::None};
+    switch (params.pixel_format) {
+    case PixelFormat::ASTC_2D_4X4:
+    case PixelFormat::ASTC_2D_8X8:
+        return false;
+    case PixelFormat::S8Z24:
+        conversion = TextureConversion::S8Z24ToZ24S8;
+        break;
+    case PixelFormat::G8R8U:
+    case PixelFormat::G8R8S:
+        conversion = TextureConversion::G8R8ToR8G8;
+        break;
+    default:
+        break;
+    }
+
+    const u32 stride{params.width * bytes_per_pixel};
+    if (stride % 16 != 0 ||
+        !texture_decoder->Decode(params.addr, stride, params.height, params.block_height,
+                                 conversion)) {
+        return false;
+    }
+
+    surface->PrepareForWrite(false);
+
+    // The decoded texture is now bound as the pixel unpack buffer
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(params.width));
+    glTextureSubImage2D(surface->Texture().handle, 0, 0, 0, static_cast<GLsizei>(params.width),
+                        static_cast<GLsizei>(params.height), tuple.format, tuple.type, nullptr);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return true;
 }
 
 void RasterizerCacheOpenGL::FlushSurface(const Surface& surface) {
-    surface->FlushGLBuffer();
+    surface->FlushGLBuffer(read_framebuffer.handle, draw_framebuffer.handle);
+}
+
+std::size_t RasterizerCacheOpenGL::FlushRegion(VAddr addr, u64 size) {
+    std::size_t num_flushed = 0;
+    for (const auto& surface : GetObjectsInRegion(addr, size)) {
+        if (surface->IsModified()) {
+            FlushSurface(surface);
+            ++num_flushed;
+        }
+    }
+    return num_flushed;
+}
+
+bool RasterizerCacheOpenGL::IsRegionModified(VAddr addr, u64 size) const {
+    const auto surfaces{GetObjectsInRegion(addr, size)};
+    return std::any_of(surfaces.begin(), surfaces.end(),
+                       [](const Surface& surface) { return surface->IsModified(); });
+}
+
+void RasterizerCacheOpenGL::NotifyRenderTargets(std::vector<Surface> render_targets) {
+    for (const auto& surface : bound_render_targets) {
+        const bool is_still_bound{std::find(render_targets.begin(), render_targets.end(),
+                                            surface) != render_targets.end()};
+        if (!is_still_bound && surface->IsReadByGuest()) {
+            surface->StartAsyncFlush(read_framebuffer.handle, draw_framebuffer.handle);
+        }
+    }
+
+    for (const auto& surface : render_targets) {
+        surface->ApplyPendingClear();
+        surface->MarkAsModified(true);
+    }
+    bound_render_targets = std::move(render_targets);
 }
 
 Surface RasterizerCacheOpenGL::GetSurface(const SurfaceParams& params, bool preserve_contents) {
@@ -770,14 +1575,28 @@ Surface RasterizerCacheOpenGL::GetSurface(const SurfaceParams& params, bool pres
     // Look up surface in the cache based on address
     Surface surface{TryGet(params.addr)};
     if (surface) {
-        if (surface->GetSurfaceParams().IsCompatibleSurface(params)) {
+        // Surfaces whose contents are not preserved are about to be overwritten, they're cleared
+        // when bound as render targets instead
+        if (preserve_contents) {
+            surface->ApplyPendingClear();
+        }
+        // A surface missing mipmap levels that are wanted now is loaded again with all of them,
+        // unless the GPU has written to it, as then only its base level is up to date in it
+        const bool is_missing_levels{surface->GetSurfaceParams().num_levels < params.num_levels &&
+                                     !surface->IsModified()};
+        if (is_missing_levels) {
+            Unregister(surface);
+        } else if (surface->GetSurfaceParams().IsCompatibleSurface(params)) {
             // Use the cached surface as-is
+            surface->MarkAsUsed(current_frame);
             return surface;
         } else if (preserve_contents) {
             // If surface parameters changed and we care about keeping the previous data, recreate
             // the surface from the old one
             Unregister(surface);
             Surface new_surface{RecreateSurface(surface, params)};
+            new_surface->MarkAsModified(surface->IsModified());
+            new_surface->MarkAsUsed(current_frame);
             Register(new_surface);
             return new_surface;
         } else {
@@ -788,16 +1607,67 @@ Surface RasterizerCacheOpenGL::GetSurface(const SurfaceParams& params, bool pres
 
     // No cached surface found - get a new one
     surface = GetUncachedSurface(params);
+    surface->MarkAsModified(false);
+    surface->MarkAsUsed(current_frame);
     Register(surface);
 
     // Only load surface from memory if we care about the contents
     if (preserve_contents) {
+        const Core::ScopedStageTimer stage_timer{system.GetPerfStats(),
+                                                 Core::PerfStage::TextureUpload};
         LoadSurface(surface);
     }
 
     return surface;
 }
 
+bool RasterizerCacheOpenGL::AccelerateSurfaceCopy(
+    const Tegra::Engines::Fermi2D::Regs::Surface& src_config,
+    const Tegra::Engines::Fermi2D::Regs::Surface& dst_config) {
+    SurfaceParams src_params{SurfaceParams::CreateForFermiCopySurface(system, src_config)};
+    SurfaceParams dst_params{SurfaceParams::CreateForFermiCopySurface(system, dst_config)};
+    if (src_params.addr == 0 || dst_params.addr == 0 || src_params.type != dst_params.type ||
+        src_params.width != dst_params.width || src_params.height != dst_params.height) {
+        return false;
+    }
+
+    // Linear surfaces are only cached tightly packed
+    const auto is_packed = [](const Tegra::Engines::Fermi2D::Regs::Surface& config) {
+        return !config.linear ||
+               config.pitch == config.width * Tegra::RenderTargetBytesPerPixel(config.format);
+    };
+    if (!is_packed(src_config) || !is_packed(dst_config)) {
+        return false;
+    }
+
+    // Surfaces that are only in memory are copied there, uploading them would cost more
+    const Surface cached_src{TryGet(src_params.addr)};
+    const Surface cached_dst{TryGet(dst_params.addr)};
+    if (!cached_src && !cached_dst) {
+        return false;
+    }
+
+    // Render targets are kept at the resolution scale, copy them without downscaling
+    const u32 scale{(cached_src ? cached_src : cached_dst)->GetSurfaceParams().resolution_scale};
+    src_params.resolution_scale = scale;
+    dst_params.resolution_scale = scale;
+
+    const Surface src_surface{GetSurface(src_params)};
+    // The whole destination is overwritten, so its previous contents don't have to be loaded
+    const Surface dst_surface{GetSurface(dst_params, false)};
+    if (!src_surface || !dst_surface) {
+        return false;
+    }
+    dst_surface->PrepareForWrite(false);
+    dst_surface->ApplyPendingClear();
+
+    BlitTextures(src_surface->Texture().handle, src_params.GetScaledRect(),
+                 dst_surface->Texture().handle, dst_params.GetScaledRect(), src_params.type,
+                 read_framebuffer.handle, draw_framebuffer.handle);
+    dst_surface->MarkAsModified(true);
+    return true;
+}
+
 Surface RasterizerCacheOpenGL::GetUncachedSurface(const SurfaceParams& params) {
     Surface surface{TryGetReservedSurface(params)};
     if (!surface) {
@@ -808,6 +1678,35 @@ Surface RasterizerCacheOpenGL::GetUncachedSurface(const SurfaceParams& params) {
     return surface;
 }
 
+/// Returns whether a surface can be reinterpreted as another one by copying its texels as-is
+static bool CanCopyImage(const SurfaceParams& src_params, const SurfaceParams& dst_params) {
+    if (!GLAD_GL_ARB_copy_image) {
+        return false;
+    }
+
+    // Only uncompressed color formats of the same size are in the same view class, depth formats
+    // can only be copied to themselves. ASTC is excluded as it is stored decoded to RGBA8.
+    const FormatTuple& src_tuple{
+        GetFormatTuple(src_params.pixel_format, src_params.component_type)};
+    const FormatTuple& dst_tuple{
+        GetFormatTuple(dst_params.pixel_format, dst_params.component_type)};
+    if (src_tuple.compressed || dst_tuple.compressed ||
+        IsPixelFormatASTC(src_params.pixel_format) || IsPixelFormatASTC(dst_params.pixel_format) ||
+        IsBCnDecodedOnLoad(src_params.pixel_format) ||
+        IsBCnDecodedOnLoad(dst_params.pixel_format) ||
+        src_params.type != SurfaceType::ColorTexture ||
+        dst_params.type != SurfaceType::ColorTexture) {
+        return false;
+    }
+
+    return CachedSurface::GetGLBytesPerPixel(src_params.pixel_format) ==
+               CachedSurface::GetGLBytesPerPixel(dst_params.pixel_format) &&
+           std::tie(src_params.target, src_params.width, src_params.height, src_params.depth,
+                    src_params.resolution_scale) ==
+               std::tie(dst_params.target, dst_params.width, dst_params.height, dst_params.depth,
+                        dst_params.resolution_scale);
+}
+
 Surface RasterizerCacheOpenGL::RecreateSurface(const Surface& surface,
                                                const SurfaceParams& new_params) {
     // Verify surface is compatible for blitting
@@ -815,16 +1714,30 @@ Surface RasterizerCacheOpenGL::RecreateSurface(const Surface& surface,
 
     // Get a new surface with the new parameters, and blit the previous surface to it
     Surface new_surface{GetUncachedSurface(new_params)};
-
-    if (params.pixel_format == new_params.pixel_format ||
-        !Settings::values.use_accurate_framebuffers) {
+    new_surface->PrepareForWrite(false);
+
+    const bool is_scaled{params.resolution_scale != 1 || new_params.resolution_scale != 1};
+    if (params.pixel_format != new_params.pixel_format && CanCopyImage(params, new_params)) {
+        // Formats of the same size can be reinterpreted by copying the texels as they are. The
+        // copy stays on the GPU, and unlike a blit it doesn't convert the values.
+        const auto& rect{params.GetScaledRect()};
+        const auto& new_rect{new_params.GetScaledRect()};
+        glCopyImageSubData(surface->Texture().handle, surface->Target(), 0, 0, 0, 0,
+                           new_surface->Texture().handle, new_surface->Target(), 0, 0, 0, 0,
+                           static_cast<GLsizei>(std::min(rect.GetWidth(), new_rect.GetWidth())),
+                           static_cast<GLsizei>(std::min(rect.GetHeight(), new_rect.GetHeight())),
+                           static_cast<GLsizei>(params.depth));
+    } else if (params.pixel_format == new_params.pixel_format ||
+               !Settings::values.use_accurate_framebuffers || is_scaled) {
         // If the format is the same, just do a framebuffer blit. This is significantly faster than
         // using PBOs. The is also likely less accurate, as textures will be converted rather than
-        // reinterpreted.
+        // reinterpreted. Surfaces at different scales are always blitted, which rescales them.
+        SurfaceParams dst_params{params};
+        dst_params.resolution_scale = new_params.resolution_scale;
 
-        BlitTextures(surface->Texture().handle, params.GetRect(), new_surface->Texture().handle,
-                     params.GetRect(), params.type, read_framebuffer.handle,
-                     draw_framebuffer.handle);
+        BlitTextures(surface->Texture().handle, params.GetScaledRect(),
+                     new_surface->Texture().handle, dst_params.GetScaledRect(), params.type,
+                     read_framebuffer.handle, draw_framebuffer.handle);
     } else {
         // When use_accurate_framebuffers setting is enabled, perform a more accurate surface copy,
         // where pixels are reinterpreted as a new format (without conversion). This code path uses
@@ -874,19 +1787,19 @@ Surface RasterizerCacheOpenGL::RecreateSurface(const Surface& surface,
             UNREACHABLE();
         } else {
             switch (new_params.target) {
-            case SurfaceParams::SurfaceTarget::Texture1D:
+            case SurfaceTarget::Texture1D:
                 glTextureSubImage1D(new_surface->Texture().handle, 0, 0,
                                     static_cast<GLsizei>(dest_rect.GetWidth()), dest_format.format,
                                     dest_format.type, nullptr);
                 break;
-            case SurfaceParams::SurfaceTarget::Texture2D:
+            case SurfaceTarget::Texture2D:
                 glTextureSubImage2D(new_surface->Texture().handle, 0, 0, 0,
                                     static_cast<GLsizei>(dest_rect.GetWidth()),
                                     static_cast<GLsizei>(dest_rect.GetHeight()), dest_format.format,
                                     dest_format.type, nullptr);
                 break;
-            case SurfaceParams::SurfaceTarget::Texture3D:
-            case SurfaceParams::SurfaceTarget::Texture2DArray:
+            case SurfaceTarget::Texture3D:
+            case SurfaceTarget::Texture2DArray:
                 glTextureSubImage3D(new_surface->Texture().handle, 0, 0, 0, 0,
                                     static_cast<GLsizei>(dest_rect.GetWidth()),
                                     static_cast<GLsizei>(dest_rect.GetHeight()),
@@ -906,19 +1819,103 @@ Surface RasterizerCacheOpenGL::RecreateSurface(const Surface& surface,
 }
 
 Surface RasterizerCacheOpenGL::TryFindFramebufferSurface(VAddr addr) const {
-    return TryGet(addr);
+    const Surface surface{TryGet(addr)};
+    if (surface) {
+        surface->ApplyPendingClear();
+    }
+    return surface;
+}
+
+MICROPROFILE_DEFINE(OpenGL_SurfaceEviction, "OpenGL", "Surface Eviction", MP_RGB(192, 64, 128));
+void RasterizerCacheOpenGL::SetResolutionScale(u32 scale) {
+    ASSERT(scale >= 1 && scale <= MAX_RESOLUTION_SCALE);
+    resolution_scale = scale;
+}
+
+void RasterizerCacheOpenGL::TickFrame() {
+    ++current_frame;
+
+    MICROPROFILE_SCOPE(OpenGL_SurfaceEviction);
+    MICROPROFILE_META_CPU("Surface KiB", static_cast<int>(reserved_memory / 1024));
+    MICROPROFILE_META_CPU("Surfaces", static_cast<int>(surface_reserve.size()));
+
+    const std::size_t budget{std::size_t{Settings::values.texture_cache_budget} * 1024 * 1024};
+    if (budget != 0 && reserved_memory > budget) {
+        EvictSurfaces(budget);
+    }
+
+    // Drop the entries of shared textures whose surfaces were all destroyed or written to
+    for (auto it = deduplicated_textures.begin(); it != deduplicated_textures.end();) {
+        const auto shared_texture{it->second.lock()};
+        if (!shared_texture || shared_texture->content_hash != it->first) {
+            it = deduplicated_textures.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void RasterizerCacheOpenGL::EvictSurfaces(std::size_t budget) {
+    // Surfaces used this recently are likely to be used again, evicting them would only make them
+    // be loaded again
+    constexpr u64 MinFramesUnused = 2;
+
+    std::vector<SurfaceReserve::iterator> candidates;
+    for (auto iter = surface_reserve.begin(); iter != surface_reserve.end(); ++iter) {
+        const bool is_unused{iter->second.use_count() == 1};
+        if (is_unused || iter->second->GetLastUsedFrame() + MinFramesUnused <= current_frame) {
+            candidates.push_back(iter);
+        }
+    }
+
+    // Surfaces that aren't cached anymore go first, then the least recently used ones
+    const auto eviction_order{[](const SurfaceReserve::iterator& iter) {
+        return std::make_pair(iter->second.use_count() != 1, iter->second->GetLastUsedFrame());
+    }};
+    std::sort(candidates.begin(), candidates.end(), [&](const auto& lhs, const auto& rhs) {
+        return eviction_order(lhs) < eviction_order(rhs);
+    });
+
+    for (const auto& iter : candidates) {
+        if (reserved_memory <= budget) {
+            break;
+        }
+
+        const Surface surface{iter->second};
+        if (std::find(bound_render_targets.begin(), bound_render_targets.end(), surface) !=
+            bound_render_targets.end()) {
+            continue;
+        }
+        if (IsRegistered(surface)) {
+            if (surface->IsModified()) {
+                FlushSurface(surface);
+            }
+            Unregister(surface);
+        }
+
+        // Only this function and the reserve should be holding the surface now
+        if (surface.use_count() == 2) {
+            reserved_memory -= surface->GetTextureMemorySize();
+            surface_reserve.erase(iter);
+        }
+    }
 }
 
 void RasterizerCacheOpenGL::ReserveSurface(const Surface& surface) {
     const auto& surface_reserve_key{SurfaceReserveKey::Create(surface->GetSurfaceParams())};
-    surface_reserve[surface_reserve_key] = surface;
+    surface_reserve.emplace(surface_reserve_key, surface);
+    reserved_memory += surface->GetTextureMemorySize();
 }
 
 Surface RasterizerCacheOpenGL::TryGetReservedSurface(const SurfaceParams& params) {
     const auto& surface_reserve_key{SurfaceReserveKey::Create(params)};
-    auto search{surface_reserve.find(surface_reserve_key)};
-    if (search != surface_reserve.end()) {
-        return search->second;
+    const auto range{surface_reserve.equal_range(surface_reserve_key)};
+    for (auto iter = range.first; iter != range.second; ++iter) {
+        // Surfaces referenced anywhere else are still cached or bound
+        if (iter->second.use_count() == 1) {
+            iter->second->Reuse(params);
+            return iter->second;
+        }
     }
     return {};
 }
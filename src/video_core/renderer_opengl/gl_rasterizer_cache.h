@@ -4,694 +4,119 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <list>
 #include <map>
 #include <memory>
+#include <unordered_map>
+#include <utility>
 #include <vector>
+#include <boost/optional.hpp>
 
 #include "common/common_types.h"
 #include "common/hash.h"
 #include "common/math_util.h"
+#include "video_core/engines/fermi_2d.h"
 #include "video_core/engines/maxwell_3d.h"
 #include "video_core/rasterizer_cache.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
+#include "video_core/renderer_opengl/gl_stream_buffer.h"
+#include "video_core/surface.h"
 #include "video_core/textures/texture.h"
 
+namespace Core {
+class System;
+}
+
 namespace OpenGL {
 
+using VideoCore::Surface::ComponentType;
+using VideoCore::Surface::PixelFormat;
+using VideoCore::Surface::SurfaceTarget;
+using VideoCore::Surface::SurfaceType;
+
+class ComputeTextureDecoder;
+
 class CachedSurface;
 using Surface = std::shared_ptr<CachedSurface>;
 using SurfaceSurfaceRect_Tuple = std::tuple<Surface, Surface, MathUtil::Rectangle<u32>>;
 
 struct SurfaceParams {
-    enum class PixelFormat {
-        ABGR8U = 0,
-        ABGR8S = 1,
-        ABGR8UI = 2,
-        B5G6R5U = 3,
-        A2B10G10R10U = 4,
-        A1B5G5R5U = 5,
-        R8U = 6,
-        R8UI = 7,
-        RGBA16F = 8,
-        RGBA16U = 9,
-        RGBA16UI = 10,
-        R11FG11FB10F = 11,
-        RGBA32UI = 12,
-        DXT1 = 13,
-        DXT23 = 14,
-        DXT45 = 15,
-        DXN1 = 16, // This is also known as BC4
-        DXN2UNORM = 17,
-        DXN2SNORM = 18,
-        BC7U = 19,
-        BC6H_UF16 = 20,
-        BC6H_SF16 = 21,
-        ASTC_2D_4X4 = 22,
-        G8R8U = 23,
-        G8R8S = 24,
-        BGRA8 = 25,
-        RGBA32F = 26,
-        RG32F = 27,
-        R32F = 28,
-        R16F = 29,
-        R16U = 30,
-        R16S = 31,
-        R16UI = 32,
-        R16I = 33,
-        RG16 = 34,
-        RG16F = 35,
-        RG16UI = 36,
-        RG16I = 37,
-        RG16S = 38,
-        RGB32F = 39,
-        SRGBA8 = 40,
-        RG8U = 41,
-        RG8S = 42,
-        RG32UI = 43,
-        R32UI = 44,
-        ASTC_2D_8X8 = 45,
-
-        MaxColorFormat,
-
-        // Depth formats
-        Z32F = 46,
-        Z16 = 47,
-
-        MaxDepthFormat,
-
-        // DepthStencil formats
-        Z24S8 = 48,
-        S8Z24 = 49,
-        Z32FS8 = 50,
-
-        MaxDepthStencilFormat,
-
-        Max = MaxDepthStencilFormat,
-        Invalid = 255,
-    };
-
-    static constexpr std::size_t MaxPixelFormat = static_cast<std::size_t>(PixelFormat::Max);
-
-    enum class ComponentType {
-        Invalid = 0,
-        SNorm = 1,
-        UNorm = 2,
-        SInt = 3,
-        UInt = 4,
-        Float = 5,
-    };
-
-    enum class SurfaceType {
-        ColorTexture = 0,
-        Depth = 1,
-        DepthStencil = 2,
-        Fill = 3,
-        Invalid = 4,
-    };
-
-    enum class SurfaceTarget {
-        Texture1D,
-        Texture2D,
-        Texture3D,
-        Texture1DArray,
-        Texture2DArray,
-        TextureCubemap,
-    };
-
-    static SurfaceTarget SurfaceTargetFromTextureType(Tegra::Texture::TextureType texture_type) {
-        switch (texture_type) {
-        case Tegra::Texture::TextureType::Texture1D:
-            return SurfaceTarget::Texture1D;
-        case Tegra::Texture::TextureType::Texture2D:
-        case Tegra::Texture::TextureType::Texture2DNoMipmap:
-            return SurfaceTarget::Texture2D;
-        case Tegra::Texture::TextureType::Texture1DArray:
-            return SurfaceTarget::Texture1DArray;
-        case Tegra::Texture::TextureType::Texture2DArray:
-            return SurfaceTarget::Texture2DArray;
-        default:
-            LOG_CRITICAL(HW_GPU, "Unimplemented texture_type={}", static_cast<u32>(texture_type));
-            UNREACHABLE();
-            return SurfaceTarget::Texture2D;
-        }
-    }
-
-    /**
-     * Gets the compression factor for the specified PixelFormat. This applies to just the
-     * "compressed width" and "compressed height", not the overall compression factor of a
-     * compressed image. This is used for maintaining proper surface sizes for compressed
-     * texture formats.
-     */
-    static constexpr u32 GetCompressionFactor(PixelFormat format) {
-        if (format == PixelFormat::Invalid)
-            return 0;
-
-        constexpr std::array<u32, MaxPixelFormat> compression_factor_table = {{
-            1, // ABGR8U
-            1, // ABGR8S
-            1, // ABGR8UI
-            1, // B5G6R5U
-            1, // A2B10G10R10U
-            1, // A1B5G5R5U
-            1, // R8U
-            1, // R8UI
-            1, // RGBA16F
-            1, // RGBA16U
-            1, // RGBA16UI
-            1, // R11FG11FB10F
-            1, // RGBA32UI
-            4, // DXT1
-            4, // DXT23
-            4, // DXT45
-            4, // DXN1
-            4, // DXN2UNORM
-            4, // DXN2SNORM
-            4, // BC7U
-            4, // BC6H_UF16
-            4, // BC6H_SF16
-            4, // ASTC_2D_4X4
-            1, // G8R8U
-            1, // G8R8S
-            1, // BGRA8
-            1, // RGBA32F
-            1, // RG32F
-            1, // R32F
-            1, // R16F
-            1, // R16U
-            1, // R16S
-            1, // R16UI
-            1, // R16I
-            1, // RG16
-            1, // RG16F
-            1, // RG16UI
-            1, // RG16I
-            1, // RG16S
-            1, // RGB32F
-            1, // SRGBA8
-            1, // RG8U
-            1, // RG8S
-            1, // RG32UI
-            1, // R32UI
-            4, // ASTC_2D_8X8
-            1, // Z32F
-            1, // Z16
-            1, // Z24S8
-            1, // S8Z24
-            1, // Z32FS8
-        }};
-
-        ASSERT(static_cast<std::size_t>(format) < compression_factor_table.size());
-        return compression_factor_table[static_cast<std::size_t>(format)];
-    }
-
-    static constexpr u32 GetFormatBpp(PixelFormat format) {
-        if (format == PixelFormat::Invalid)
-            return 0;
-
-        constexpr std::array<u32, MaxPixelFormat> bpp_table = {{
-            32,  // ABGR8U
-            32,  // ABGR8S
-            32,  // ABGR8UI
-            16,  // B5G6R5U
-            32,  // A2B10G10R10U
-            16,  // A1B5G5R5U
-            8,   // R8U
-            8,   // R8UI
-            64,  // RGBA16F
-            64,  // RGBA16U
-            64,  // RGBA16UI
-            32,  // R11FG11FB10F
-            128, // RGBA32UI
-            64,  // DXT1
-            128, // DXT23
-            128, // DXT45
-            64,  // DXN1
-            128, // DXN2UNORM
-            128, // DXN2SNORM
-            128, // BC7U
-            128, // BC6H_UF16
-            128, // BC6H_SF16
-            32,  // ASTC_2D_4X4
-            16,  // G8R8U
-            16,  // G8R8S
-            32,  // BGRA8
-            128, // RGBA32F
-            64,  // RG32F
-            32,  // R32F
-            16,  // R16F
-            16,  // R16U
-            16,  // R16S
-            16,  // R16UI
-            16,  // R16I
-            32,  // RG16
-            32,  // RG16F
-            32,  // RG16UI
-            32,  // RG16I
-            32,  // RG16S
-            96,  // RGB32F
-            32,  // SRGBA8
-            16,  // RG8U
-            16,  // RG8S
-            64,  // RG32UI
-            32,  // R32UI
-            16,  // ASTC_2D_8X8
-            32,  // Z32F
-            16,  // Z16
-            32,  // Z24S8
-            32,  // S8Z24
-            64,  // Z32FS8
-        }};
-
-        ASSERT(static_cast<std::size_t>(format) < bpp_table.size());
-        return bpp_table[static_cast<std::size_t>(format)];
-    }
-
-    u32 GetFormatBpp() const {
-        return GetFormatBpp(pixel_format);
-    }
-
-    static PixelFormat PixelFormatFromDepthFormat(Tegra::DepthFormat format) {
-        switch (format) {
-        case Tegra::DepthFormat::S8_Z24_UNORM:
-            return PixelFormat::S8Z24;
-        case Tegra::DepthFormat::Z24_S8_UNORM:
-            return PixelFormat::Z24S8;
-        case Tegra::DepthFormat::Z32_FLOAT:
-            return PixelFormat::Z32F;
-        case Tegra::DepthFormat::Z16_UNORM:
-            return PixelFormat::Z16;
-        case Tegra::DepthFormat::Z32_S8_X24_FLOAT:
-            return PixelFormat::Z32FS8;
-        default:
-            LOG_CRITICAL(HW_GPU, "Unimplemented format={}", static_cast<u32>(format));
-            UNREACHABLE();
-        }
-    }
-
-    static PixelFormat PixelFormatFromRenderTargetFormat(Tegra::RenderTargetFormat format) {
-        switch (format) {
-        // TODO (Hexagon12): Converting SRGBA to RGBA is a hack and doesn't completely correct the
-        // gamma.
-        case Tegra::RenderTargetFormat::RGBA8_SRGB:
-        case Tegra::RenderTargetFormat::RGBA8_UNORM:
-            return PixelFormat::ABGR8U;
-        case Tegra::RenderTargetFormat::RGBA8_SNORM:
-            return PixelFormat::ABGR8S;
-        case Tegra::RenderTargetFormat::RGBA8_UINT:
-            return PixelFormat::ABGR8UI;
-        case Tegra::RenderTargetFormat::BGRA8_SRGB:
-        case Tegra::RenderTargetFormat::BGRA8_UNORM:
-            return PixelFormat::BGRA8;
-        case Tegra::RenderTargetFormat::RGB10_A2_UNORM:
-            return PixelFormat::A2B10G10R10U;
-        case Tegra::RenderTargetFormat::RGBA16_FLOAT:
-            return PixelFormat::RGBA16F;
-        case Tegra::RenderTargetFormat::RGBA16_UNORM:
-            return PixelFormat::RGBA16U;
-        case Tegra::RenderTargetFormat::RGBA16_UINT:
-            return PixelFormat::RGBA16UI;
-        case Tegra::RenderTargetFormat::RGBA32_FLOAT:
-            return PixelFormat::RGBA32F;
-        case Tegra::RenderTargetFormat::RG32_FLOAT:
-            return PixelFormat::RG32F;
-        case Tegra::RenderTargetFormat::R11G11B10_FLOAT:
-            return PixelFormat::R11FG11FB10F;
-        case Tegra::RenderTargetFormat::B5G6R5_UNORM:
-            return PixelFormat::B5G6R5U;
-        case Tegra::RenderTargetFormat::BGR5A1_UNORM:
-            return PixelFormat::A1B5G5R5U;
-        case Tegra::RenderTargetFormat::RGBA32_UINT:
-            return PixelFormat::RGBA32UI;
-        case Tegra::RenderTargetFormat::R8_UNORM:
-            return PixelFormat::R8U;
-        case Tegra::RenderTargetFormat::R8_UINT:
-            return PixelFormat::R8UI;
-        case Tegra::RenderTargetFormat::RG16_FLOAT:
-            return PixelFormat::RG16F;
-        case Tegra::RenderTargetFormat::RG16_UINT:
-            return PixelFormat::RG16UI;
-        case Tegra::RenderTargetFormat::RG16_SINT:
-            return PixelFormat::RG16I;
-        case Tegra::RenderTargetFormat::RG16_UNORM:
-            return PixelFormat::RG16;
-        case Tegra::RenderTargetFormat::RG16_SNORM:
-            return PixelFormat::RG16S;
-        case Tegra::RenderTargetFormat::RG8_UNORM:
-            return PixelFormat::RG8U;
-        case Tegra::RenderTargetFormat::RG8_SNORM:
-            return PixelFormat::RG8S;
-        case Tegra::RenderTargetFormat::R16_FLOAT:
-            return PixelFormat::R16F;
-        case Tegra::RenderTargetFormat::R16_UNORM:
-            return PixelFormat::R16U;
-        case Tegra::RenderTargetFormat::R16_SNORM:
-            return PixelFormat::R16S;
-        case Tegra::RenderTargetFormat::R16_UINT:
-            return PixelFormat::R16UI;
-        case Tegra::RenderTargetFormat::R16_SINT:
-            return PixelFormat::R16I;
-        case Tegra::RenderTargetFormat::R32_FLOAT:
-            return PixelFormat::R32F;
-        case Tegra::RenderTargetFormat::R32_UINT:
-            return PixelFormat::R32UI;
-        case Tegra::RenderTargetFormat::RG32_UINT:
-            return PixelFormat::RG32UI;
-        default:
-            LOG_CRITICAL(HW_GPU, "Unimplemented format={}", static_cast<u32>(format));
-            UNREACHABLE();
-        }
-    }
-
-    static PixelFormat PixelFormatFromTextureFormat(Tegra::Texture::TextureFormat format,
-                                                    Tegra::Texture::ComponentType component_type) {
-        // TODO(Subv): Properly implement this
-        switch (format) {
-        case Tegra::Texture::TextureFormat::A8R8G8B8:
-            switch (component_type) {
-            case Tegra::Texture::ComponentType::UNORM:
-                return PixelFormat::ABGR8U;
-            case Tegra::Texture::ComponentType::SNORM:
-                return PixelFormat::ABGR8S;
-            case Tegra::Texture::ComponentType::UINT:
-                return PixelFormat::ABGR8UI;
-            }
-            LOG_CRITICAL(HW_GPU, "Unimplemented component_type={}",
-                         static_cast<u32>(component_type));
-            UNREACHABLE();
-        case Tegra::Texture::TextureFormat::B5G6R5:
-            switch (component_type) {
-            case Tegra::Texture::ComponentType::UNORM:
-                return PixelFormat::B5G6R5U;
-            }
-            LOG_CRITICAL(HW_GPU, "Unimplemented component_type={}",
-                         static_cast<u32>(component_type));
-            UNREACHABLE();
-        case Tegra::Texture::TextureFormat::A2B10G10R10:
-            switch (component_type) {
-            case Tegra::Texture::ComponentType::UNORM:
-                return PixelFormat::A2B10G10R10U;
-            }
-            LOG_CRITICAL(HW_GPU, "Unimplemented component_type={}",
-                         static_cast<u32>(component_type));
-            UNREACHABLE();
-        case Tegra::Texture::TextureFormat::A1B5G5R5:
-            switch (component_type) {
-            case Tegra::Texture::ComponentType::UNORM:
-                return PixelFormat::A1B5G5R5U;
-            }
-            LOG_CRITICAL(HW_GPU, "Unimplemented component_type={}",
-                         static_cast<u32>(component_type));
-            UNREACHABLE();
-        case Tegra::Texture::TextureFormat::R8:
-            switch (component_type) {
-            case Tegra::Texture::ComponentType::UNORM:
-                return PixelFormat::R8U;
-            case Tegra::Texture::ComponentType::UINT:
-                return PixelFormat::R8UI;
-            }
-            LOG_CRITICAL(HW_GPU, "Unimplemented component_type={}",
-                         static_cast<u32>(component_type));
-            UNREACHABLE();
-        case Tegra::Texture::TextureFormat::G8R8:
-            switch (component_type) {
-            case Tegra::Texture::ComponentType::UNORM:
-                return PixelFormat::G8R8U;
-            case Tegra::Texture::ComponentType::SNORM:
-                return PixelFormat::G8R8S;
-            }
-            LOG_CRITICAL(HW_GPU, "Unimplemented component_type={}",
-                         static_cast<u32>(component_type));
-            UNREACHABLE();
-        case Tegra::Texture::TextureFormat::R16_G16_B16_A16:
-            switch (component_type) {
-            case Tegra::Texture::ComponentType::UNORM:
-                return PixelFormat::RGBA16U;
-            case Tegra::Texture::ComponentType::FLOAT:
-                return PixelFormat::RGBA16F;
-            }
-            LOG_CRITICAL(HW_GPU, "Unimplemented component_type={}",
-                         static_cast<u32>(component_type));
-            UNREACHABLE();
-        case Tegra::Texture::TextureFormat::BF10GF11RF11:
-            switch (component_type) {
-            case Tegra::Texture::ComponentType::FLOAT:
-                return PixelFormat::R11FG11FB10F;
-            }
-            LOG_CRITICAL(HW_GPU, "Unimplemented component_type={}",
-                         static_cast<u32>(component_type));
-            UNREACHABLE();
-        case Tegra::Texture::TextureFormat::R32_G32_B32_A32:
-            switch (component_type) {
-            case Tegra::Texture::ComponentType::FLOAT:
-                return PixelFormat::RGBA32F;
-            case Tegra::Texture::ComponentType::UINT:
-                return PixelFormat::RGBA32UI;
-            }
-            LOG_CRITICAL(HW_GPU, "Unimplemented component_type={}",
-                         static_cast<u32>(component_type));
-            UNREACHABLE();
-        case Tegra::Texture::TextureFormat::R32_G32:
-            switch (component_type) {
-            case Tegra::Texture::ComponentType::FLOAT:
-                return PixelFormat::RG32F;
-            case Tegra::Texture::ComponentType::UINT:
-                return PixelFormat::RG32UI;
-            }
-            LOG_CRITICAL(HW_GPU, "Unimplemented component_type={}",
-                         static_cast<u32>(component_type));
-            UNREACHABLE();
-        case Tegra::Texture::TextureFormat::R32_G32_B32:
-            switch (component_type) {
-            case Tegra::Texture::ComponentType::FLOAT:
-                return PixelFormat::RGB32F;
-            }
-            LOG_CRITICAL(HW_GPU, "Unimplemented component_type={}",
-                         static_cast<u32>(component_type));
-            UNREACHABLE();
-        case Tegra::Texture::TextureFormat::R16:
-            switch (component_type) {
-            case Tegra::Texture::ComponentType::FLOAT:
-                return PixelFormat::R16F;
-            case Tegra::Texture::ComponentType::UNORM:
-                return PixelFormat::R16U;
-            case Tegra::Texture::ComponentType::SNORM:
-                return PixelFormat::R16S;
-            case Tegra::Texture::ComponentType::UINT:
-                return PixelFormat::R16UI;
-            case Tegra::Texture::ComponentType::SINT:
-                return PixelFormat::R16I;
-            }
-            LOG_CRITICAL(HW_GPU, "Unimplemented component_type={}",
-                         static_cast<u32>(component_type));
-            UNREACHABLE();
-        case Tegra::Texture::TextureFormat::R32:
-            switch (component_type) {
-            case Tegra::Texture::ComponentType::FLOAT:
-                return PixelFormat::R32F;
-            case Tegra::Texture::ComponentType::UINT:
-                return PixelFormat::R32UI;
-            }
-            LOG_CRITICAL(HW_GPU, "Unimplemented component_type={}",
-                         static_cast<u32>(component_type));
-            UNREACHABLE();
-        case Tegra::Texture::TextureFormat::ZF32:
-            return PixelFormat::Z32F;
-        case Tegra::Texture::TextureFormat::Z16:
-            return PixelFormat::Z16;
-        case Tegra::Texture::TextureFormat::Z24S8:
-            return PixelFormat::Z24S8;
-        case Tegra::Texture::TextureFormat::DXT1:
-            return PixelFormat::DXT1;
-        case Tegra::Texture::TextureFormat::DXT23:
-            return PixelFormat::DXT23;
-        case Tegra::Texture::TextureFormat::DXT45:
-            return PixelFormat::DXT45;
-        case Tegra::Texture::TextureFormat::DXN1:
-            return PixelFormat::DXN1;
-        case Tegra::Texture::TextureFormat::DXN2:
-            switch (component_type) {
-            case Tegra::Texture::ComponentType::UNORM:
-                return PixelFormat::DXN2UNORM;
-            case Tegra::Texture::ComponentType::SNORM:
-                return PixelFormat::DXN2SNORM;
-            }
-            LOG_CRITICAL(HW_GPU, "Unimplemented component_type={}",
-                         static_cast<u32>(component_type));
-            UNREACHABLE();
-        case Tegra::Texture::TextureFormat::BC7U:
-            return PixelFormat::BC7U;
-        case Tegra::Texture::TextureFormat::BC6H_UF16:
-            return PixelFormat::BC6H_UF16;
-        case Tegra::Texture::TextureFormat::BC6H_SF16:
-            return PixelFormat::BC6H_SF16;
-        case Tegra::Texture::TextureFormat::ASTC_2D_4X4:
-            return PixelFormat::ASTC_2D_4X4;
-        case Tegra::Texture::TextureFormat::ASTC_2D_8X8:
-            return PixelFormat::ASTC_2D_8X8;
-        case Tegra::Texture::TextureFormat::R16_G16:
-            switch (component_type) {
-            case Tegra::Texture::ComponentType::FLOAT:
-                return PixelFormat::RG16F;
-            case Tegra::Texture::ComponentType::UNORM:
-                return PixelFormat::RG16;
-            case Tegra::Texture::ComponentType::SNORM:
-                return PixelFormat::RG16S;
-            case Tegra::Texture::ComponentType::UINT:
-                return PixelFormat::RG16UI;
-            case Tegra::Texture::ComponentType::SINT:
-                return PixelFormat::RG16I;
-            }
-            LOG_CRITICAL(HW_GPU, "Unimplemented component_type={}",
-                         static_cast<u32>(component_type));
-            UNREACHABLE();
-        default:
-            LOG_CRITICAL(HW_GPU, "Unimplemented format={}, component_type={}",
-                         static_cast<u32>(format), static_cast<u32>(component_type));
-            UNREACHABLE();
-        }
-    }
+    /// Returns the rectangle corresponding to this surface
+    MathUtil::Rectangle<u32> GetRect() const;
 
-    static ComponentType ComponentTypeFromTexture(Tegra::Texture::ComponentType type) {
-        // TODO(Subv): Implement more component types
-        switch (type) {
-        case Tegra::Texture::ComponentType::UNORM:
-            return ComponentType::UNorm;
-        case Tegra::Texture::ComponentType::FLOAT:
-            return ComponentType::Float;
-        case Tegra::Texture::ComponentType::SNORM:
-            return ComponentType::SNorm;
-        case Tegra::Texture::ComponentType::UINT:
-            return ComponentType::UInt;
-        case Tegra::Texture::ComponentType::SINT:
-            return ComponentType::SInt;
-        default:
-            LOG_CRITICAL(HW_GPU, "Unimplemented component type={}", static_cast<u32>(type));
-            UNREACHABLE();
-        }
-    }
+    /// Returns the rectangle covered by this surface in its texture, multiplied by its scale
+    MathUtil::Rectangle<u32> GetScaledRect() const;
 
-    static ComponentType ComponentTypeFromRenderTarget(Tegra::RenderTargetFormat format) {
-        // TODO(Subv): Implement more render targets
-        switch (format) {
-        case Tegra::RenderTargetFormat::RGBA8_UNORM:
-        case Tegra::RenderTargetFormat::RGBA8_SRGB:
-        case Tegra::RenderTargetFormat::BGRA8_UNORM:
-        case Tegra::RenderTargetFormat::BGRA8_SRGB:
-        case Tegra::RenderTargetFormat::RGB10_A2_UNORM:
-        case Tegra::RenderTargetFormat::R8_UNORM:
-        case Tegra::RenderTargetFormat::RG16_UNORM:
-        case Tegra::RenderTargetFormat::R16_UNORM:
-        case Tegra::RenderTargetFormat::B5G6R5_UNORM:
-        case Tegra::RenderTargetFormat::BGR5A1_UNORM:
-        case Tegra::RenderTargetFormat::RG8_UNORM:
-        case Tegra::RenderTargetFormat::RGBA16_UNORM:
-            return ComponentType::UNorm;
-        case Tegra::RenderTargetFormat::RGBA8_SNORM:
-        case Tegra::RenderTargetFormat::RG16_SNORM:
-        case Tegra::RenderTargetFormat::R16_SNORM:
-        case Tegra::RenderTargetFormat::RG8_SNORM:
-            return ComponentType::SNorm;
-        case Tegra::RenderTargetFormat::RGBA16_FLOAT:
-        case Tegra::RenderTargetFormat::R11G11B10_FLOAT:
-        case Tegra::RenderTargetFormat::RGBA32_FLOAT:
-        case Tegra::RenderTargetFormat::RG32_FLOAT:
-        case Tegra::RenderTargetFormat::RG16_FLOAT:
-        case Tegra::RenderTargetFormat::R16_FLOAT:
-        case Tegra::RenderTargetFormat::R32_FLOAT:
-            return ComponentType::Float;
-        case Tegra::RenderTargetFormat::RGBA32_UINT:
-        case Tegra::RenderTargetFormat::RGBA16_UINT:
-        case Tegra::RenderTargetFormat::RG16_UINT:
-        case Tegra::RenderTargetFormat::R8_UINT:
-        case Tegra::RenderTargetFormat::R16_UINT:
-        case Tegra::RenderTargetFormat::RG32_UINT:
-        case Tegra::RenderTargetFormat::R32_UINT:
-        case Tegra::RenderTargetFormat::RGBA8_UINT:
-            return ComponentType::UInt;
-        case Tegra::RenderTargetFormat::RG16_SINT:
-        case Tegra::RenderTargetFormat::R16_SINT:
-            return ComponentType::SInt;
-        default:
-            LOG_CRITICAL(HW_GPU, "Unimplemented format={}", static_cast<u32>(format));
-            UNREACHABLE();
+    /// Returns the size of this surface in bytes, adjusted for compression
+    std::size_t SizeInBytes() const {
+        if (HasLayout()) {
+            return GetLayerSizeInBytes() * depth;
         }
+        const u32 compression_factor{VideoCore::Surface::GetCompressionFactor(pixel_format)};
+        ASSERT(width % compression_factor == 0);
+        ASSERT(height % compression_factor == 0);
+        return (width / compression_factor) * (height / compression_factor) *
+               VideoCore::Surface::GetFormatBpp(pixel_format) * depth / CHAR_BIT;
     }
 
-    static PixelFormat PixelFormatFromGPUPixelFormat(Tegra::FramebufferConfig::PixelFormat format) {
-        switch (format) {
-        case Tegra::FramebufferConfig::PixelFormat::ABGR8:
-            return PixelFormat::ABGR8U;
-        default:
-            LOG_CRITICAL(HW_GPU, "Unimplemented format={}", static_cast<u32>(format));
-            UNREACHABLE();
-        }
+    /// Returns the width of a mipmap level, in pixels
+    u32 MipWidth(u32 level) const {
+        return std::max(1U, width >> level);
     }
 
-    static ComponentType ComponentTypeFromDepthFormat(Tegra::DepthFormat format) {
-        switch (format) {
-        case Tegra::DepthFormat::Z16_UNORM:
-        case Tegra::DepthFormat::S8_Z24_UNORM:
-        case Tegra::DepthFormat::Z24_S8_UNORM:
-            return ComponentType::UNorm;
-        case Tegra::DepthFormat::Z32_FLOAT:
-        case Tegra::DepthFormat::Z32_S8_X24_FLOAT:
-            return ComponentType::Float;
-        default:
-            LOG_CRITICAL(HW_GPU, "Unimplemented format={}", static_cast<u32>(format));
-            UNREACHABLE();
-        }
+    /// Returns the height of a mipmap level, in pixels
+    u32 MipHeight(u32 level) const {
+        return std::max(1U, height >> level);
     }
 
-    static SurfaceType GetFormatType(PixelFormat pixel_format) {
-        if (static_cast<std::size_t>(pixel_format) <
-            static_cast<std::size_t>(PixelFormat::MaxColorFormat)) {
-            return SurfaceType::ColorTexture;
-        }
+    /// Returns the height in GOBs of the blocks a mipmap level is tiled with
+    u32 MipBlockHeight(u32 level) const;
 
-        if (static_cast<std::size_t>(pixel_format) <
-            static_cast<std::size_t>(PixelFormat::MaxDepthFormat)) {
-            return SurfaceType::Depth;
-        }
+    /// Returns the size a mipmap level of one layer takes in Switch memory
+    std::size_t GetLevelSizeInBytes(u32 level) const;
 
-        if (static_cast<std::size_t>(pixel_format) <
-            static_cast<std::size_t>(PixelFormat::MaxDepthStencilFormat)) {
-            return SurfaceType::DepthStencil;
-        }
+    /// Returns the offset of a mipmap level in Switch memory, from the start of its layer
+    std::size_t GetLevelOffset(u32 level) const;
 
-        // TODO(Subv): Implement the other formats
-        ASSERT(false);
+    /// Returns the distance between the layers of a tiled texture array in Switch memory
+    std::size_t GetLayerSizeInBytes() const;
 
-        return SurfaceType::Invalid;
-    }
+    /// Returns the size of a mipmap level of one layer once loaded for OpenGL
+    std::size_t GetGLLevelSize(u32 level) const;
 
-    /// Returns the rectangle corresponding to this surface
-    MathUtil::Rectangle<u32> GetRect() const;
-
-    /// Returns the size of this surface in bytes, adjusted for compression
-    std::size_t SizeInBytes() const {
-        const u32 compression_factor{GetCompressionFactor(pixel_format)};
-        ASSERT(width % compression_factor == 0);
-        ASSERT(height % compression_factor == 0);
-        return (width / compression_factor) * (height / compression_factor) *
-               GetFormatBpp(pixel_format) * depth / CHAR_BIT;
-    }
+    /// Returns the offset of a mipmap level once loaded for OpenGL. The loaded data has all the
+    /// layers of a level next to each other, which is what glTexSubImage3D expects.
+    std::size_t GetGLLevelOffset(u32 level) const;
 
     /// Creates SurfaceParams from a texture configuration
-    static SurfaceParams CreateForTexture(const Tegra::Texture::FullTextureInfo& config);
+    static SurfaceParams CreateForTexture(Core::System& system,
+                                          const Tegra::Texture::FullTextureInfo& config);
 
     /// Creates SurfaceParams from a framebuffer configuration
-    static SurfaceParams CreateForFramebuffer(std::size_t index);
+    static SurfaceParams CreateForFramebuffer(Core::System& system, std::size_t index);
+
+    /// Creates SurfaceParams from a surface of the 2D engine
+    static SurfaceParams CreateForFermiCopySurface(
+        Core::System& system, const Tegra::Engines::Fermi2D::Regs::Surface& config);
 
     /// Creates SurfaceParams for a depth buffer configuration
-    static SurfaceParams CreateForDepthBuffer(u32 zeta_width, u32 zeta_height,
-                                              Tegra::GPUVAddr zeta_address,
+    static SurfaceParams CreateForDepthBuffer(Core::System& system, u32 zeta_width,
+                                              u32 zeta_height, Tegra::GPUVAddr zeta_address,
                                               Tegra::DepthFormat format);
 
     /// Checks if surfaces are compatible for caching
     bool IsCompatibleSurface(const SurfaceParams& other) const {
-        return std::tie(pixel_format, type, width, height) ==
-               std::tie(other.pixel_format, other.type, other.width, other.height);
+        return std::tie(pixel_format, type, width, height, resolution_scale) ==
+               std::tie(other.pixel_format, other.type, other.width, other.height,
+                        other.resolution_scale);
+    }
+
+    /// Returns whether the surface is laid out with the block linear mipmap and layer layout,
+    /// instead of as a single tightly packed image
+    bool HasLayout() const {
+        return is_tiled && (num_levels > 1 || target == SurfaceTarget::Texture2DArray);
     }
 
     VAddr addr;
@@ -704,17 +129,31 @@ struct SurfaceParams {
     u32 height;
     u32 depth;
     u32 unaligned_height;
+    /// Number of mipmap levels, only textures loaded without a software conversion have more than
+    /// one
+    u32 num_levels;
     std::size_t size_in_bytes;
     SurfaceTarget target;
+    /// Factor the texture is larger than the guest surface by, only render targets are rendered at
+    /// a higher resolution than the guest's
+    u32 resolution_scale;
 };
 
 }; // namespace OpenGL
 
-/// Hashable variation of SurfaceParams, used for a key in the surface cache
+/**
+ * Hashable variation of SurfaceParams, used for a key in the surface reserve. Only the parameters
+ * the texture is created with are kept, so that a surface can be reused at any address.
+ */
 struct SurfaceReserveKey : Common::HashableStruct<OpenGL::SurfaceParams> {
     static SurfaceReserveKey Create(const OpenGL::SurfaceParams& params) {
         SurfaceReserveKey res;
         res.state = params;
+        res.state.addr = 0;
+        res.state.is_tiled = false;
+        res.state.block_height = 0;
+        res.state.unaligned_height = 0;
+        res.state.size_in_bytes = 0;
         return res;
     }
 };
@@ -729,6 +168,39 @@ struct hash<SurfaceReserveKey> {
 
 namespace OpenGL {
 
+/// Keeps the most recently decoded textures, keyed by a hash of their encoded data
+class DecodedTextureCache final {
+public:
+    /// Gets a decoded texture, returns nullptr when it is not in the cache
+    const std::vector<u8>* Get(u64 key);
+
+    /// Adds a decoded texture, evicting the least recently used ones when the cache is full
+    void Insert(u64 key, std::vector<u8> decoded);
+
+private:
+    /// Maximum amount of decoded data kept in the cache
+    static constexpr std::size_t MAX_CACHE_SIZE = 256 * 1024 * 1024;
+
+    /// Decoded textures, from most to least recently used
+    std::list<std::pair<u64, std::vector<u8>>> entries;
+    std::unordered_map<u64, decltype(entries)::iterator> lookup;
+    std::size_t total_size{};
+};
+
+/// Values a whole surface is cleared to, depending on its type
+struct SurfaceClearValue {
+    std::array<float, 4> color;
+    float depth;
+    u8 stencil;
+};
+
+/// Texture of a surface. Surfaces loaded from identical guest data share it until one writes to it.
+struct SurfaceTexture {
+    OGLTexture texture;
+    /// Hash of the guest data and parameters the texture was loaded with, 0 once it was written to
+    u64 content_hash = 0;
+};
+
 class CachedSurface final {
 public:
     CachedSurface(const SurfaceParams& params);
@@ -742,41 +214,154 @@ public:
     }
 
     const OGLTexture& Texture() const {
+        return texture->texture;
+    }
+
+    /// Returns the texture of the surface, which may be shared with other surfaces
+    const std::shared_ptr<SurfaceTexture>& GetSharedTexture() const {
         return texture;
     }
 
+    /// Makes the surface use a texture loaded from identical guest data by another surface
+    void ShareTexture(std::shared_ptr<SurfaceTexture> shared_texture) {
+        texture = std::move(shared_texture);
+    }
+
+    /**
+     * Gives the surface a texture of its own if it shares one, before the texture is written to.
+     * Afterwards the texture can't be shared with surfaces loaded from the same data anymore.
+     * @param preserve_contents Whether the contents of the shared texture have to be copied
+     */
+    void PrepareForWrite(bool preserve_contents);
+
     GLenum Target() const {
         return gl_target;
     }
 
-    static constexpr unsigned int GetGLBytesPerPixel(SurfaceParams::PixelFormat format) {
-        if (format == SurfaceParams::PixelFormat::Invalid)
+    static constexpr unsigned int GetGLBytesPerPixel(PixelFormat format) {
+        if (format == PixelFormat::Invalid)
             return 0;
 
-        return SurfaceParams::GetFormatBpp(format) / CHAR_BIT;
+        return VideoCore::Surface::GetFormatBpp(format) / CHAR_BIT;
     }
 
     const SurfaceParams& GetSurfaceParams() const {
         return params;
     }
 
+    /// Returns whether the surface has been written by the GPU since it was last flushed
+    bool IsModified() const {
+        return is_modified;
+    }
+
+    /// Marks whether the surface has been written by the GPU, i.e. the guest copy is stale
+    void MarkAsModified(bool is_modified_) {
+        is_modified = is_modified_;
+    }
+
+    /// Returns whether the guest has read this surface back before, in which case it is likely to
+    /// read it again, and flushes are worth starting ahead of time
+    bool IsReadByGuest() const {
+        return is_read_by_guest;
+    }
+
+    /// Returns the frame in which the rasterizer last used this surface
+    u64 GetLastUsedFrame() const {
+        return last_used_frame;
+    }
+
+    /// Marks the surface as used by the rasterizer in the given frame
+    void MarkAsUsed(u64 frame) {
+        last_used_frame = frame;
+    }
+
+    /// Returns whether the whole surface can be cleared without binding it to a framebuffer
+    bool CanDeferClear() const;
+
+    /**
+     * Records a clear of the whole surface, which is only applied to the texture once its
+     * contents are used. A surface cleared again before then is only cleared once.
+     */
+    void DeferClear(const SurfaceClearValue& value);
+
+    /// Applies the clear recorded on the surface, if any
+    void ApplyPendingClear();
+
+    /**
+     * Copies the texture into a texture of the same storage and returns it, or 0 when it can't be
+     * copied. Used to sample a surface that the same draw renders to, without a texture barrier.
+     */
+    GLuint GetSampleCopy();
+
+    /**
+     * Makes an unused surface describe new parameters, which must create the same texture as the
+     * current ones. The texture keeps its stale contents until the surface is loaded again.
+     */
+    void Reuse(const SurfaceParams& new_params);
+
+    /// Returns the size of the data uploaded to the texture, as laid out by LoadGLBuffer
+    std::size_t GetGLBufferSize() const;
+
+    /// Returns the memory taken by the texture, larger than the buffer when the surface is scaled
+    std::size_t GetTextureMemorySize() const;
+
+    /// Returns whether the data in memory can be uploaded as-is, without a software conversion
+    bool CanLoadWithoutConversion() const;
+
     // Read/Write data in Switch memory to/from gl_buffer
-    void LoadGLBuffer();
-    void FlushGLBuffer();
+    void LoadGLBuffer(DecodedTextureCache& decoded_cache);
+    void FlushGLBuffer(GLuint read_fb_handle, GLuint draw_fb_handle);
+
+    /// Starts copying a modified surface into a pixel buffer, so that a later flush only has to
+    /// wait for the copy if it is still in flight. Scaled surfaces are downscaled on the GPU first.
+    void StartAsyncFlush(GLuint read_fb_handle, GLuint draw_fb_handle);
+
+    /**
+     * Reads the data in Switch memory into buffer, which must have room for GetGLBufferSize()
+     * bytes, without converting it. Only usable when CanLoadWithoutConversion() is true.
+     */
+    void LoadGLBuffer(u8* buffer);
 
     // Upload data in gl_buffer to this surface's texture
     void UploadGLTexture(GLuint read_fb_handle, GLuint draw_fb_handle);
 
+    /// Uploads data loaded at the given offset of the bound GL_PIXEL_UNPACK_BUFFER to the texture
+    void UploadGLTexture(GLintptr unpack_buffer_offset);
+
 private:
-    OGLTexture texture;
+    /// Uploads the data at the given pointer, or buffer offset, to this surface's texture
+    void UploadGLData(const u8* data);
+
+    /// Creates a texture for the surface, only allocating its storage if it isn't compressed
+    void CreateTexture();
+
+    std::shared_ptr<SurfaceTexture> texture;
     std::vector<u8> gl_buffer;
     SurfaceParams params;
     GLenum gl_target;
+
+    bool is_modified{};
+    bool is_read_by_guest{};
+    u64 last_used_frame{};
+
+    /// Clear recorded on the surface and not applied to the texture yet
+    boost::optional<SurfaceClearValue> pending_clear;
+
+    /// Copy of the texture sampled by draws that render to it, created on their first use
+    OGLTexture sample_copy;
+
+    /// Pixel buffer the texture is read back into, along with the fence of the pending readback
+    OGLBuffer readback_buffer;
+    /// Texture at the guest resolution that scaled surfaces are downscaled to before readbacks
+    OGLTexture downscaled_texture;
+    OGLSync readback_fence;
 };
 
 class RasterizerCacheOpenGL final : public RasterizerCache<Surface> {
 public:
-    RasterizerCacheOpenGL();
+    explicit RasterizerCacheOpenGL(VideoCore::RasterizerInterface& rasterizer,
+                                   Core::System& system);
+    ~RasterizerCacheOpenGL();
 
     /// Get a surface based on the texture configuration
     Surface GetTextureSurface(const Tegra::Texture::FullTextureInfo& config);
@@ -790,11 +375,58 @@ public:
     /// Flushes the surface to Switch memory
     void FlushSurface(const Surface& surface);
 
+    /**
+     * Flushes all the surfaces modified by the GPU that overlap with the specified region
+     * @returns the number of surfaces flushed
+     */
+    std::size_t FlushRegion(VAddr addr, u64 size);
+
+    /// Returns whether any surface overlapping with the specified region was modified by the GPU
+    bool IsRegionModified(VAddr addr, u64 size) const;
+
+    /**
+     * Marks the surfaces bound as render targets as modified, applying their pending clears.
+     * Surfaces that are not bound anymore start their readback, as they are not being rendered to
+     * for now.
+     */
+    void NotifyRenderTargets(std::vector<Surface> render_targets);
+
+    /// Copies between surfaces of the 2D engine on the GPU, when at least one of them is cached.
+    /// Returns false when the copy has to be done in Switch memory instead.
+    bool AccelerateSurfaceCopy(const Tegra::Engines::Fermi2D::Regs::Surface& src_config,
+                               const Tegra::Engines::Fermi2D::Regs::Surface& dst_config);
+
     /// Tries to find a framebuffer using on the provided CPU address
     Surface TryFindFramebufferSurface(VAddr addr) const;
 
+    /// Ages the surfaces at the end of a frame, evicting the least recently used ones if the
+    /// textures take more memory than Settings::values.texture_cache_budget
+    void TickFrame();
+
+    /// Sets the factor render targets created from now on are upscaled by
+    void SetResolutionScale(u32 scale);
+
+    /// Largest factor render targets can be upscaled by
+    static constexpr u32 MAX_RESOLUTION_SCALE = 4;
+
 private:
     void LoadSurface(const Surface& surface);
+
+    /// Tries to load a surface by decoding it on the GPU, returns false if it can't be done
+    bool LoadSurfaceWithCompute(const Surface& surface);
+
+    /// Tries to load a surface straight into the upload buffer, returns false if it can't be done
+    bool LoadSurfaceWithUploadBuffer(const Surface& surface);
+
+    /// Loads a scaled surface at the guest resolution into another surface, and upscales it
+    void LoadScaledSurface(const Surface& surface);
+
+    /**
+     * Tries to load a surface by sharing the texture of a surface loaded from identical guest
+     * data, returns false if there is none. Otherwise content_hash is set to the hash the texture
+     * has to be registered with once it is loaded, or 0 if it can't be shared.
+     */
+    bool LoadDeduplicatedSurface(const Surface& surface, u64& content_hash);
     Surface GetSurface(const SurfaceParams& params, bool preserve_contents = true);
 
     /// Gets an uncached surface, creating it if need be
@@ -809,14 +441,45 @@ private:
     /// Tries to get a reserved surface for the specified parameters
     Surface TryGetReservedSurface(const SurfaceParams& params);
 
-    /// The surface reserve is a "backup" cache, this is where we put unique surfaces that have
-    /// previously been used. This is to prevent surfaces from being constantly created and
-    /// destroyed when used with different surface parameters.
-    std::unordered_map<SurfaceReserveKey, Surface> surface_reserve;
+    /// Evicts surfaces, least recently used first, until the textures fit in the given budget
+    void EvictSurfaces(std::size_t budget);
+
+    Core::System& system;
+
+    using SurfaceReserve = std::unordered_multimap<SurfaceReserveKey, Surface>;
+
+    /// The surface reserve holds every surface alive, grouped by the textures they are created
+    /// with. Surfaces that are referenced by nothing else are reused for new surfaces of the same
+    /// group, which prevents textures from being constantly created and destroyed.
+    SurfaceReserve surface_reserve;
+    /// Memory taken by the textures of all the surfaces in the reserve
+    std::size_t reserved_memory = 0;
+
+    /// Number of frames presented so far, used to track when surfaces were last used
+    u64 current_frame = 0;
+
+    /// Factor new render targets are upscaled by
+    u32 resolution_scale = 1;
 
     OGLFramebuffer read_framebuffer;
     OGLFramebuffer draw_framebuffer;
 
+    /// Textures that have been decoded in software, so reloading them doesn't decode them again
+    DecodedTextureCache decoded_cache;
+
+    /// Textures loaded from guest data, by hash of the data and of the surface parameters
+    std::unordered_map<u64, std::weak_ptr<SurfaceTexture>> deduplicated_textures;
+
+    /// Decodes tiled surfaces on the GPU, only created when use_gpu_texture_decoding is enabled
+    std::unique_ptr<ComputeTextureDecoder> texture_decoder;
+
+    /// Surfaces used as render targets by the last draw
+    std::vector<Surface> bound_render_targets;
+
+    /// Persistently mapped pixel unpack buffer that surfaces are unswizzled into before uploading
+    static constexpr GLsizeiptr UPLOAD_BUFFER_SIZE = 64 * 1024 * 1024;
+    OGLStreamBuffer upload_buffer;
+
     /// Use a Pixel Buffer Object to download the previous texture and then upload it to the new one
     /// using the new format.
     OGLBuffer copy_pbo;
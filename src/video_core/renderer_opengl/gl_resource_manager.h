@@ -28,11 +28,12 @@ public:
         return *this;
     }
 
-    /// Creates a new internal OpenGL resource and stores the handle
-    void Create() {
+    /// Creates a new internal OpenGL resource of the given target and stores the handle. The
+    /// target is set on creation so the texture can be bound with the multi-bind functions.
+    void Create(GLenum target) {
         if (handle != 0)
             return;
-        glGenTextures(1, &handle);
+        glCreateTextures(target, 1, &handle);
     }
 
     /// Deletes the internal OpenGL resource
@@ -133,10 +134,10 @@ public:
     }
 
     template <typename... T>
-    void Create(bool separable_program, T... shaders) {
+    void Create(bool separable_program, bool hint_retrievable, T... shaders) {
         if (handle != 0)
             return;
-        handle = GLShader::LoadProgram(separable_program, shaders...);
+        handle = GLShader::LoadProgram(separable_program, hint_retrievable, shaders...);
     }
 
     /// Creates a new internal OpenGL resource and stores the handle
@@ -149,7 +150,7 @@ public:
             geo.Create(geo_shader, GL_GEOMETRY_SHADER);
         if (frag_shader)
             frag.Create(frag_shader, GL_FRAGMENT_SHADER);
-        Create(separable_program, vert.handle, geo.handle, frag.handle);
+        Create(separable_program, false, vert.handle, geo.handle, frag.handle);
     }
 
     /// Deletes the internal OpenGL resource
@@ -264,6 +265,40 @@ public:
     GLsync handle = 0;
 };
 
+class OGLQuery : private NonCopyable {
+public:
+    OGLQuery() = default;
+
+    OGLQuery(OGLQuery&& o) noexcept : handle(std::exchange(o.handle, 0)) {}
+
+    ~OGLQuery() {
+        Release();
+    }
+
+    OGLQuery& operator=(OGLQuery&& o) noexcept {
+        Release();
+        handle = std::exchange(o.handle, 0);
+        return *this;
+    }
+
+    /// Creates a new internal OpenGL resource of the given target and stores the handle
+    void Create(GLenum target) {
+        if (handle != 0)
+            return;
+        glCreateQueries(target, 1, &handle);
+    }
+
+    /// Deletes the internal OpenGL resource
+    void Release() {
+        if (handle == 0)
+            return;
+        glDeleteQueries(1, &handle);
+        handle = 0;
+    }
+
+    GLuint handle = 0;
+};
+
 class OGLVertexArray : private NonCopyable {
 public:
     OGLVertexArray() = default;
@@ -315,11 +350,12 @@ public:
         return *this;
     }
 
-    /// Creates a new internal OpenGL resource and stores the handle
+    /// Creates a new internal OpenGL resource and stores the handle. The framebuffer is created
+    /// as an object right away, so it can be edited with direct state access before being bound.
     void Create() {
         if (handle != 0)
             return;
-        glGenFramebuffers(1, &handle);
+        glCreateFramebuffers(1, &handle);
     }
 
     /// Deletes the internal OpenGL resource
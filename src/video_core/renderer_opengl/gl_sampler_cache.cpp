@@ -0,0 +1,65 @@
+// Copyright 2018 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "video_core/renderer_opengl/gl_sampler_cache.h"
+#include "video_core/renderer_opengl/maxwell_to_gl.h"
+
+namespace OpenGL {
+
+using Tegra::Texture::WrapMode;
+
+SamplerCacheKey SamplerCacheKey::Create(const Tegra::Texture::TSCEntry& config) {
+    SamplerCacheKey key;
+    key.state.wrap_u.Assign(config.wrap_u);
+    key.state.wrap_v.Assign(config.wrap_v);
+    key.state.wrap_p.Assign(config.wrap_p);
+    key.state.mag_filter.Assign(config.mag_filter);
+    key.state.min_filter.Assign(config.min_filter);
+    if (key.UsesBorderColor()) {
+        key.state.border_color_r = config.border_color_r;
+        key.state.border_color_g = config.border_color_g;
+        key.state.border_color_b = config.border_color_b;
+        key.state.border_color_a = config.border_color_a;
+    }
+    return key;
+}
+
+bool SamplerCacheKey::UsesBorderColor() const {
+    return state.wrap_u == WrapMode::Border || state.wrap_v == WrapMode::Border ||
+           state.wrap_p == WrapMode::Border;
+}
+
+GLuint SamplerCacheOpenGL::GetSampler(const Tegra::Texture::TSCEntry& config) {
+    const auto key = SamplerCacheKey::Create(config);
+    auto [iter, is_new] = cache.try_emplace(key);
+    if (is_new) {
+        iter->second = CreateSampler(key);
+    }
+    return iter->second.handle;
+}
+
+OGLSampler SamplerCacheOpenGL::CreateSampler(const SamplerCacheKey& key) {
+    const auto& config = key.state;
+    OGLSampler sampler;
+    sampler.Create();
+
+    const GLuint s = sampler.handle;
+    glSamplerParameteri(s, GL_TEXTURE_MAG_FILTER,
+                        MaxwellToGL::TextureFilterMode(config.mag_filter));
+    glSamplerParameteri(s, GL_TEXTURE_MIN_FILTER,
+                        MaxwellToGL::TextureFilterMode(config.min_filter));
+    glSamplerParameteri(s, GL_TEXTURE_WRAP_S, MaxwellToGL::WrapMode(config.wrap_u));
+    glSamplerParameteri(s, GL_TEXTURE_WRAP_T, MaxwellToGL::WrapMode(config.wrap_v));
+    glSamplerParameteri(s, GL_TEXTURE_WRAP_R, MaxwellToGL::WrapMode(config.wrap_p));
+
+    if (key.UsesBorderColor()) {
+        const GLvec4 border_color = {{config.border_color_r, config.border_color_g,
+                                      config.border_color_b, config.border_color_a}};
+        glSamplerParameterfv(s, GL_TEXTURE_BORDER_COLOR, border_color.data());
+    }
+
+    return sampler;
+}
+
+} // namespace OpenGL
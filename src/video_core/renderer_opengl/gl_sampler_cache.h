@@ -0,0 +1,53 @@
+// Copyright 2018 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <unordered_map>
+
+#include <glad/glad.h>
+
+#include "common/hash.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+#include "video_core/textures/texture.h"
+
+namespace OpenGL {
+
+/**
+ * Hashable variation of TSCEntry, used as the key of the sampler cache. Only the fields the
+ * sampler objects are created with are kept, so that entries which only differ in unused fields
+ * share the same sampler.
+ */
+struct SamplerCacheKey : Common::HashableStruct<Tegra::Texture::TSCEntry> {
+    static SamplerCacheKey Create(const Tegra::Texture::TSCEntry& config);
+
+    bool UsesBorderColor() const;
+};
+
+} // namespace OpenGL
+
+namespace std {
+template <>
+struct hash<OpenGL::SamplerCacheKey> {
+    std::size_t operator()(const OpenGL::SamplerCacheKey& k) const {
+        return k.Hash();
+    }
+};
+} // namespace std
+
+namespace OpenGL {
+
+/// Keeps an immutable sampler object for each sampler configuration used by the guest
+class SamplerCacheOpenGL final {
+public:
+    /// Gets the sampler object for a configuration, creating it if it is not in the cache
+    GLuint GetSampler(const Tegra::Texture::TSCEntry& config);
+
+private:
+    static OGLSampler CreateSampler(const SamplerCacheKey& key);
+
+    std::unordered_map<SamplerCacheKey, OGLSampler> cache;
+};
+
+} // namespace OpenGL
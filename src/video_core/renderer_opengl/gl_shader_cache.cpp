@@ -2,27 +2,66 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <chrono>
+
 #include "common/assert.h"
+#include "common/hash.h"
+#include "common/tracing.h"
 #include "core/core.h"
 #include "core/memory.h"
+#include "core/perf_stats.h"
+#include "core/settings.h"
 #include "video_core/engines/maxwell_3d.h"
+#include "video_core/engines/maxwell_compute.h"
 #include "video_core/renderer_opengl/gl_shader_cache.h"
 #include "video_core/renderer_opengl/gl_shader_manager.h"
 
 namespace OpenGL {
 
 /// Gets the address for the specified shader stage program
-static VAddr GetShaderAddress(Maxwell::ShaderProgram program) {
-    const auto& gpu = Core::System::GetInstance().GPU().Maxwell3D();
+static VAddr GetShaderAddress(Core::System& system, Maxwell::ShaderProgram program) {
+    const auto& gpu = system.GPU().Maxwell3D();
     const auto& shader_config = gpu.regs.shader_config[static_cast<std::size_t>(program)];
     return *gpu.memory_manager.GpuToCpuAddress(gpu.regs.code_address.CodeAddress() +
                                                shader_config.offset);
 }
 
-/// Gets the shader program code from memory for the specified address
-static GLShader::ProgramCode GetShaderCode(VAddr addr) {
+/**
+ * Calculates the number of instructions of a program, by scanning for the padding that follows
+ * its last instruction. Sched instructions are skipped, as they can be zero within a program.
+ */
+static std::size_t CalculateProgramLength(const GLShader::ProgramCode& program_code,
+                                          std::size_t main_offset) {
+    constexpr std::size_t SchedPeriod = 4;
+    constexpr u64 NOP_OPCODE = 0x50b;
+
+    std::size_t offset = main_offset;
+    for (; offset < program_code.size(); ++offset) {
+        const bool is_sched{(offset - main_offset) % SchedPeriod == 0};
+        const u64 instruction{program_code[offset]};
+        if (!is_sched && (instruction == 0 || (instruction >> 52) == NOP_OPCODE)) {
+            break;
+        }
+    }
+
+    // The padding instruction is included, as the program length is always rounded up to it
+    return std::min(offset + 1, program_code.size());
+}
+
+/**
+ * Gets the shader program code from memory for the specified address. Everything past the end of
+ * the program is cleared, so that the code only depends on the program itself.
+ * @param length Set to the number of instructions of the program
+ * @param main_offset Offset of the first instruction, past the shader header if there is one
+ */
+static GLShader::ProgramCode GetShaderCode(VAddr addr, std::size_t& length,
+                                           std::size_t main_offset = GLShader::PROGRAM_OFFSET) {
     GLShader::ProgramCode program_code(GLShader::MAX_PROGRAM_CODE_LENGTH);
     Memory::ReadBlock(addr, program_code.data(), program_code.size() * sizeof(u64));
+
+    length = CalculateProgramLength(program_code, main_offset);
+    std::fill(program_code.begin() + length, program_code.end(), 0);
     return program_code;
 }
 
@@ -51,45 +90,166 @@ static void SetShaderUniformBlockBindings(GLuint shader) {
                                  sizeof(GLShader::MaxwellUniformData));
 }
 
-CachedShader::CachedShader(VAddr addr, Maxwell::ShaderProgram program_type)
-    : addr{addr}, program_type{program_type}, setup{GetShaderCode(addr)} {
+/// Gets the GL shader type that a program of the specified type is compiled as
+static GLenum GetGLShaderType(Maxwell::ShaderProgram program_type) {
+    switch (program_type) {
+    case Maxwell::ShaderProgram::VertexA:
+    case Maxwell::ShaderProgram::VertexB:
+        return GL_VERTEX_SHADER;
+    case Maxwell::ShaderProgram::Fragment:
+        return GL_FRAGMENT_SHADER;
+    case Maxwell::ShaderProgram::Compute:
+        return GL_COMPUTE_SHADER;
+    default:
+        LOG_CRITICAL(HW_GPU, "Unimplemented program_type={}", static_cast<u32>(program_type));
+        UNREACHABLE();
+        return GL_VERTEX_SHADER;
+    }
+}
+
+/// Computes an identifier for a program from its code and the stage it is generated for
+static u64 GetUniqueIdentifier(Maxwell::ShaderProgram program_type,
+                               const GLShader::ShaderSetup& setup, std::size_t length,
+                               std::size_t length_b) {
+    const auto HashCode = [](const GLShader::ProgramCode& code, std::size_t length) {
+        return Common::ComputeHash64(code.data(), length * sizeof(u64));
+    };
 
-    GLShader::ProgramResult program_result;
-    GLenum gl_type{};
+    u64 unique_identifier = HashCode(setup.program.code, length);
+    if (setup.IsDualProgram()) {
+        // Combine the hashes of both programs, the same way boost::hash_combine does
+        unique_identifier ^= HashCode(setup.program.code_b, length_b) + 0x9E3779B97F4A7C15 +
+                             (unique_identifier << 6) + (unique_identifier >> 2);
+    }
+    return unique_identifier ^ static_cast<u64>(program_type);
+}
 
+/// Generates the GLSL code of a program, this does not touch any GL or emulated state
+static GLShader::ProgramResult DecompileProgram(Maxwell::ShaderProgram program_type,
+                                                const GLShader::ShaderSetup& setup) {
     switch (program_type) {
     case Maxwell::ShaderProgram::VertexA:
-        // VertexB is always enabled, so when VertexA is enabled, we have two vertex shaders.
-        // Conventional HW does not support this, so we combine VertexA and VertexB into one
-        // stage here.
-        setup.SetProgramB(GetShaderCode(GetShaderAddress(Maxwell::ShaderProgram::VertexB)));
     case Maxwell::ShaderProgram::VertexB:
-        program_result = GLShader::GenerateVertexShader(setup);
-        gl_type = GL_VERTEX_SHADER;
-        break;
+        return GLShader::GenerateVertexShader(setup);
     case Maxwell::ShaderProgram::Fragment:
-        program_result = GLShader::GenerateFragmentShader(setup);
-        gl_type = GL_FRAGMENT_SHADER;
-        break;
+        return GLShader::GenerateFragmentShader(setup);
+    case Maxwell::ShaderProgram::Compute:
+        return GLShader::GenerateComputeShader(setup);
     default:
         LOG_CRITICAL(HW_GPU, "Unimplemented program_type={}", static_cast<u32>(program_type));
         UNREACHABLE();
-        return;
+        return {};
     }
+}
+
+/// Compiles and links a separable program from GLSL code
+static std::shared_ptr<OGLProgram> CompileProgram(Core::PerfStats& perf_stats,
+                                                  const std::string& code, GLenum gl_type,
+                                                  bool hint_retrievable) {
+    const Core::ScopedStageTimer stage_timer{perf_stats, Core::PerfStage::ShaderCompile};
+    YUZU_TRACE_ZONE("CompileProgram");
+    perf_stats.AddCounter(Core::PerfCounter::ShaderCode, code.size());
+    OGLShader shader;
+    shader.Create(code.c_str(), gl_type);
 
-    entries = program_result.second;
+    auto program = std::make_shared<OGLProgram>();
+    program->Create(true, hint_retrievable, shader.handle);
+    SetShaderUniformBlockBindings(program->handle);
+    return program;
+}
 
+/**
+ * Starts compiling and linking a separable program from GLSL code without waiting for the driver.
+ * With GL_ARB_parallel_shader_compile the driver builds it on its own threads, and the program can
+ * be polled with IsProgramBuilt.
+ */
+static std::shared_ptr<OGLProgram> BeginCompileProgram(Core::PerfStats& perf_stats,
+                                                       const std::string& code, GLenum gl_type,
+                                                       bool hint_retrievable) {
+    perf_stats.AddCounter(Core::PerfCounter::ShaderCode, code.size());
+    const char* const source{code.c_str()};
     OGLShader shader;
-    shader.Create(program_result.first.c_str(), gl_type);
-    program.Create(true, shader.handle);
-    SetShaderUniformBlockBindings(program.handle);
+    shader.handle = glCreateShader(gl_type);
+    glShaderSource(shader.handle, 1, &source, nullptr);
+    glCompileShader(shader.handle);
+
+    auto program = std::make_shared<OGLProgram>();
+    program->handle = glCreateProgram();
+    glAttachShader(program->handle, shader.handle);
+    glProgramParameteri(program->handle, GL_PROGRAM_SEPARABLE, GL_TRUE);
+    if (hint_retrievable) {
+        glProgramParameteri(program->handle, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    glLinkProgram(program->handle);
+    glDetachShader(program->handle, shader.handle);
+    return program;
+}
+
+/// Returns whether the driver finished building a program started with BeginCompileProgram
+static bool IsProgramBuilt(GLuint program) {
+    GLint is_completed{};
+    glGetProgramiv(program, GL_COMPLETION_STATUS_ARB, &is_completed);
+    return is_completed == GL_TRUE;
 }
 
+/// Finishes a program started with BeginCompileProgram, once the driver has built it
+static void EndCompileProgram(GLuint program) {
+    GLint link_status{};
+    glGetProgramiv(program, GL_LINK_STATUS, &link_status);
+    if (link_status != GL_TRUE) {
+        GLint info_log_length{};
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &info_log_length);
+        std::string program_error(std::max(info_log_length, 1), ' ');
+        glGetProgramInfoLog(program, info_log_length, nullptr, &program_error[0]);
+        LOG_ERROR(Render_OpenGL, "Error linking shader:\n{}", program_error);
+    }
+    ASSERT_MSG(link_status == GL_TRUE, "Shader not linked");
+
+    SetShaderUniformBlockBindings(program);
+}
+
+/// Loads a program from a driver binary, returns nullptr if the driver rejected the binary
+static std::shared_ptr<OGLProgram> LoadProgramBinary(GLenum binary_format,
+                                                     const std::vector<u8>& binary) {
+    auto program = std::make_shared<OGLProgram>();
+    program->handle = glCreateProgram();
+    glProgramParameteri(program->handle, GL_PROGRAM_SEPARABLE, GL_TRUE);
+    glProgramBinary(program->handle, binary_format, binary.data(),
+                    static_cast<GLsizei>(binary.size()));
+
+    GLint link_status{};
+    glGetProgramiv(program->handle, GL_LINK_STATUS, &link_status);
+    if (link_status != GL_TRUE) {
+        return nullptr;
+    }
+
+    SetShaderUniformBlockBindings(program->handle);
+    return program;
+}
+
+/// Retrieves the driver binary of a linked program into a disk cache entry
+static void GetProgramBinary(GLuint program, ShaderDiskCacheEntry& entry) {
+    GLint binary_length{};
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binary_length);
+    if (binary_length <= 0) {
+        entry.binary.clear();
+        return;
+    }
+
+    entry.binary.resize(static_cast<std::size_t>(binary_length));
+    glGetProgramBinary(program, binary_length, nullptr, &entry.binary_format, entry.binary.data());
+}
+
+CachedShader::CachedShader(VAddr addr, std::size_t size, Maxwell::ShaderProgram program_type,
+                           std::shared_ptr<OGLProgram> program, GLShader::ShaderEntries entries)
+    : addr{addr}, size{size}, program_type{program_type}, entries{std::move(entries)},
+      program{std::move(program)} {}
+
 GLuint CachedShader::GetProgramResourceIndex(const GLShader::ConstBufferEntry& buffer) {
     const auto search{resource_cache.find(buffer.GetHash())};
     if (search == resource_cache.end()) {
         const GLuint index{
-            glGetProgramResourceIndex(program.handle, GL_UNIFORM_BLOCK, buffer.GetName().c_str())};
+            glGetProgramResourceIndex(program->handle, GL_UNIFORM_BLOCK, buffer.GetName().c_str())};
         resource_cache[buffer.GetHash()] = index;
         return index;
     }
@@ -100,7 +260,7 @@ GLuint CachedShader::GetProgramResourceIndex(const GLShader::ConstBufferEntry& b
 GLint CachedShader::GetUniformLocation(const GLShader::SamplerEntry& sampler) {
     const auto search{uniform_cache.find(sampler.GetHash())};
     if (search == uniform_cache.end()) {
-        const GLint index{glGetUniformLocation(program.handle, sampler.GetName().c_str())};
+        const GLint index{glGetUniformLocation(program->handle, sampler.GetName().c_str())};
         uniform_cache[sampler.GetHash()] = index;
         return index;
     }
@@ -108,19 +268,366 @@ GLint CachedShader::GetUniformLocation(const GLShader::SamplerEntry& sampler) {
     return search->second;
 }
 
+void CachedShader::SetUberShaderOperations(std::shared_ptr<OGLBuffer> operations,
+                                           const std::vector<GLuint>& block_indices) {
+    const auto& const_buffers{entries.const_buffer_entries};
+    ASSERT(block_indices.size() == const_buffers.size());
+    for (std::size_t slot = 0; slot < const_buffers.size(); ++slot) {
+        resource_cache[const_buffers[slot].GetHash()] = block_indices[slot];
+    }
+    uber_operations = std::move(operations);
+}
+
+AsyncShaderDecompiler::AsyncShaderDecompiler(std::size_t num_workers) {
+    workers.reserve(num_workers);
+    for (std::size_t i = 0; i < num_workers; ++i) {
+        workers.emplace_back([this] { WorkerLoop(); });
+    }
+}
+
+AsyncShaderDecompiler::~AsyncShaderDecompiler() {
+    {
+        std::lock_guard<std::mutex> lock{tasks_mutex};
+        is_stopping = true;
+    }
+    tasks_cv.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+std::future<GLShader::ProgramResult> AsyncShaderDecompiler::Decompile(
+    Maxwell::ShaderProgram program_type, GLShader::ShaderSetup setup) {
+    std::packaged_task<GLShader::ProgramResult()> task{
+        [program_type, setup{std::move(setup)}] { return DecompileProgram(program_type, setup); }};
+    auto future{task.get_future()};
+    {
+        std::lock_guard<std::mutex> lock{tasks_mutex};
+        tasks.push_back(std::move(task));
+    }
+    tasks_cv.notify_one();
+    return future;
+}
+
+void AsyncShaderDecompiler::WorkerLoop() {
+    while (true) {
+        std::packaged_task<GLShader::ProgramResult()> task;
+        {
+            std::unique_lock<std::mutex> lock{tasks_mutex};
+            tasks_cv.wait(lock, [this] { return is_stopping || !tasks.empty(); });
+            if (is_stopping) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+ShaderCacheOpenGL::ShaderCacheOpenGL(VideoCore::RasterizerInterface& rasterizer,
+                                     Core::System& system)
+    : RasterizerCache{rasterizer}, system{system} {}
+
 Shader ShaderCacheOpenGL::GetStageProgram(Maxwell::ShaderProgram program) {
-    const VAddr program_addr{GetShaderAddress(program)};
+    const VAddr program_addr{GetShaderAddress(system, program)};
 
     // Look up shader in the cache based on address
     Shader shader{TryGet(program_addr)};
 
     if (!shader) {
-        // No shader found - create a new one
-        shader = std::make_shared<CachedShader>(program_addr, program);
+        LoadDiskCache();
+        if (!uber_shader && Settings::values.use_asynchronous_shaders &&
+            Settings::values.use_uber_shaders) {
+            uber_shader = std::make_unique<UberShaderOpenGL>();
+            if (uber_shader->IsSupported()) {
+                SetShaderUniformBlockBindings(uber_shader->GetProgram()->handle);
+            }
+        }
+
+        // No shader found - create a new one, reusing an already built program with the same code
+        std::size_t length{};
+        std::size_t length_b{};
+        GLShader::ShaderSetup setup{GetShaderCode(program_addr, length)};
+        if (program == Maxwell::ShaderProgram::VertexA) {
+            // VertexB is always enabled, so when VertexA is enabled, we have two vertex shaders.
+            // Conventional HW does not support this, so we combine VertexA and VertexB into one
+            // stage here.
+            const VAddr program_b_addr{GetShaderAddress(system, Maxwell::ShaderProgram::VertexB)};
+            setup.SetProgramB(GetShaderCode(program_b_addr, length_b));
+        }
+
+        const u64 unique_identifier{GetUniqueIdentifier(program, setup, length, length_b)};
+        const bool is_uber_candidate{program == Maxwell::ShaderProgram::VertexB};
+        const GLShader::ProgramCode program_code{is_uber_candidate ? setup.program.code
+                                                                   : GLShader::ProgramCode{}};
+        const CachedProgram* const cached{GetProgram(unique_identifier, program, std::move(setup))};
+        if (cached == nullptr) {
+            if (!is_uber_candidate) {
+                return nullptr;
+            }
+            // Draw with the uber shader until the specialized program is ready. It is not
+            // registered, so that the specialized program is looked up again on the next draw.
+            return GetUberShader(program_addr, length * sizeof(u64), unique_identifier,
+                                 program_code);
+        }
+        uber_shaders.erase(unique_identifier);
+
+        shader = std::make_shared<CachedShader>(program_addr, length * sizeof(u64), program,
+                                                cached->program, cached->entries);
         Register(shader);
     }
 
     return shader;
 }
 
+Shader ShaderCacheOpenGL::GetComputeKernel(Tegra::GPUVAddr code_addr) {
+    const auto& compute{system.GPU().MaxwellCompute()};
+    const auto& launch{compute.launch_description};
+    const std::array<u32, 3> local_size{launch.block_dim_x, launch.block_dim_y,
+                                        launch.block_dim_z};
+    const VAddr kernel_addr{*compute.memory_manager.GpuToCpuAddress(code_addr)};
+
+    // The local size is part of the GLSL code, so a kernel launched with another block size is
+    // looked up again
+    Shader kernel{TryGet(kernel_addr)};
+    if (kernel && kernel->GetLocalSize() == local_size) {
+        return kernel;
+    }
+    if (kernel) {
+        Unregister(kernel);
+    }
+    LoadDiskCache();
+
+    std::size_t length{};
+    GLShader::ShaderSetup setup{GetShaderCode(kernel_addr, length, 0)};
+    setup.local_size = local_size;
+
+    u64 unique_identifier{GetUniqueIdentifier(Maxwell::ShaderProgram::Compute, setup, length, 0)};
+    const u64 local_size_hash{Common::ComputeHash64(local_size.data(), sizeof(local_size))};
+    unique_identifier ^= local_size_hash + 0x9E3779B97F4A7C15 + (unique_identifier << 6) +
+                         (unique_identifier >> 2);
+
+    // Kernels are always built synchronously, as a launch can't be skipped the way a draw can
+    auto search{programs.find(unique_identifier)};
+    if (search == programs.end()) {
+        search = programs
+                     .emplace(unique_identifier,
+                              LinkProgram(unique_identifier, Maxwell::ShaderProgram::Compute,
+                                          DecompileProgram(Maxwell::ShaderProgram::Compute, setup)))
+                     .first;
+    }
+
+    kernel = std::make_shared<CachedShader>(kernel_addr, length * sizeof(u64),
+                                            Maxwell::ShaderProgram::Compute,
+                                            search->second.program, search->second.entries);
+    kernel->SetLocalSize(local_size);
+    Register(kernel);
+    return kernel;
+}
+
+const ShaderCacheOpenGL::CachedProgram* ShaderCacheOpenGL::GetProgram(
+    u64 unique_identifier, Maxwell::ShaderProgram program_type, GLShader::ShaderSetup setup) {
+
+    const auto search{programs.find(unique_identifier)};
+    if (search != programs.end()) {
+        return &search->second;
+    }
+
+    const auto building{building_programs.find(unique_identifier)};
+    if (building != building_programs.end()) {
+        BuildingProgram& pending = building->second;
+        if (!IsProgramBuilt(pending.program->handle)) {
+            return nullptr;
+        }
+        EndCompileProgram(pending.program->handle);
+
+        const auto inserted{programs.emplace(
+            unique_identifier,
+            StoreProgram(unique_identifier, pending.program_type, std::move(pending.program),
+                         std::move(pending.program_result)))};
+        building_programs.erase(building);
+        return &inserted.first->second;
+    }
+
+    GLShader::ProgramResult program_result;
+    if (Settings::values.use_asynchronous_shaders) {
+        auto pending{pending_programs.find(unique_identifier)};
+        if (pending == pending_programs.end()) {
+            if (!async_decompiler) {
+                const std::size_t num_workers{
+                    std::max<std::size_t>(std::thread::hardware_concurrency() / 2, 1)};
+                async_decompiler = std::make_unique<AsyncShaderDecompiler>(num_workers);
+            }
+            pending_programs.emplace(unique_identifier,
+                                     async_decompiler->Decompile(program_type, std::move(setup)));
+            return nullptr;
+        }
+
+        if (pending->second.wait_for(std::chrono::seconds::zero()) != std::future_status::ready) {
+            return nullptr;
+        }
+        program_result = pending->second.get();
+        pending_programs.erase(pending);
+
+        if (GLAD_GL_ARB_parallel_shader_compile) {
+            // Let the driver compile the GLSL code on its own threads, instead of stalling here
+            auto program{BeginCompileProgram(system.GetPerfStats(), program_result.first,
+                                             GetGLShaderType(program_type),
+                                             Settings::values.use_disk_shader_cache)};
+            building_programs.emplace(unique_identifier,
+                                      BuildingProgram{std::move(program), program_type,
+                                                      std::move(program_result)});
+            return nullptr;
+        }
+    } else {
+        program_result = DecompileProgram(program_type, setup);
+    }
+
+    const auto inserted{programs.emplace(
+        unique_identifier, LinkProgram(unique_identifier, program_type, std::move(program_result)))};
+    return &inserted.first->second;
+}
+
+void ShaderCacheOpenGL::ResetDiskCache() {
+    // The built programs are kept, titles sharing some of them don't have to build them again
+    disk_cache = {};
+    is_disk_cache_loaded = false;
+}
+
+void ShaderCacheOpenGL::LoadDiskCache(const VideoCore::DiskResourceLoadCallback& callback) {
+    if (is_disk_cache_loaded) {
+        return;
+    }
+    is_disk_cache_loaded = true;
+    if (!Settings::values.use_disk_shader_cache) {
+        return;
+    }
+
+    if (callback) {
+        callback(VideoCore::LoadCallbackStage::Prepare, 0, 0);
+    }
+
+    std::vector<ShaderDiskCacheEntry> entries = disk_cache.Load();
+    const bool needs_rewrite = disk_cache.NeedsRewrite();
+
+    std::size_t num_built{};
+    const auto add_program = [&](ShaderDiskCacheEntry& entry, std::shared_ptr<OGLProgram> program,
+                                 bool is_rebuilt) {
+        if (needs_rewrite || is_rebuilt) {
+            disk_cache.Save(entry);
+        }
+        programs.insert_or_assign(entry.unique_identifier,
+                                  CachedProgram{std::move(program), std::move(entry.entries)});
+        if (callback) {
+            callback(VideoCore::LoadCallbackStage::Build, ++num_built, entries.size());
+        }
+    };
+
+    // Loading the binaries the driver still accepts is quick, which leaves the programs that have
+    // to be rebuilt from their GLSL code, e.g. after a driver update, to be built all at once
+    std::vector<ShaderDiskCacheEntry*> rebuilt_entries;
+    for (auto& entry : entries) {
+        std::shared_ptr<OGLProgram> program;
+        if (!entry.binary.empty()) {
+            program = LoadProgramBinary(entry.binary_format, entry.binary);
+        }
+        if (program) {
+            add_program(entry, std::move(program), false);
+        } else {
+            rebuilt_entries.push_back(&entry);
+        }
+    }
+
+    if (!rebuilt_entries.empty()) {
+        LOG_INFO(Render_OpenGL, "Rebuilding {} of {} programs of the disk shader cache",
+                 rebuilt_entries.size(), entries.size());
+    }
+
+    // Start every rebuild before waiting for the first one, so that the driver builds them in
+    // parallel on its own threads when it supports it
+    std::vector<std::shared_ptr<OGLProgram>> rebuilt_programs;
+    rebuilt_programs.reserve(rebuilt_entries.size());
+    if (GLAD_GL_ARB_parallel_shader_compile) {
+        for (const auto* entry : rebuilt_entries) {
+            rebuilt_programs.push_back(BeginCompileProgram(
+                system.GetPerfStats(), entry->code, GetGLShaderType(entry->program_type), true));
+        }
+    }
+
+    for (std::size_t i = 0; i < rebuilt_entries.size(); ++i) {
+        auto& entry = *rebuilt_entries[i];
+        std::shared_ptr<OGLProgram> program;
+        if (i < rebuilt_programs.size()) {
+            program = std::move(rebuilt_programs[i]);
+            EndCompileProgram(program->handle);
+        } else {
+            program = CompileProgram(system.GetPerfStats(), entry.code,
+                                     GetGLShaderType(entry.program_type), true);
+        }
+        GetProgramBinary(program->handle, entry);
+        add_program(entry, std::move(program), true);
+    }
+
+    if (callback) {
+        callback(VideoCore::LoadCallbackStage::Complete, entries.size(), entries.size());
+    }
+}
+
+ShaderCacheOpenGL::CachedProgram ShaderCacheOpenGL::LinkProgram(
+    u64 unique_identifier, Maxwell::ShaderProgram program_type,
+    GLShader::ProgramResult program_result) {
+
+    auto program{CompileProgram(system.GetPerfStats(), program_result.first,
+                                GetGLShaderType(program_type),
+                                Settings::values.use_disk_shader_cache)};
+    return StoreProgram(unique_identifier, program_type, std::move(program),
+                        std::move(program_result));
+}
+
+Shader ShaderCacheOpenGL::GetUberShader(VAddr program_addr, std::size_t size,
+                                        u64 unique_identifier,
+                                        const GLShader::ProgramCode& program_code) {
+    if (!uber_shader || !uber_shader->IsSupported()) {
+        return nullptr;
+    }
+
+    const auto [iter, inserted]{uber_shaders.emplace(unique_identifier, nullptr)};
+    if (!inserted) {
+        return iter->second;
+    }
+
+    auto translation{uber_shader->Translate(program_code)};
+    if (!translation) {
+        return nullptr;
+    }
+
+    const std::size_t num_slots{translation->entries.const_buffer_entries.size()};
+    auto shader{std::make_shared<CachedShader>(program_addr, size,
+                                               Maxwell::ShaderProgram::VertexB,
+                                               uber_shader->GetProgram(),
+                                               std::move(translation->entries))};
+    shader->SetUberShaderOperations(std::move(translation->operations),
+                                    uber_shader->GetConstBufferBlockIndices(num_slots));
+    iter->second = shader;
+    return shader;
+}
+
+ShaderCacheOpenGL::CachedProgram ShaderCacheOpenGL::StoreProgram(
+    u64 unique_identifier, Maxwell::ShaderProgram program_type,
+    std::shared_ptr<OGLProgram> program, GLShader::ProgramResult program_result) {
+
+    if (Settings::values.use_disk_shader_cache) {
+        ShaderDiskCacheEntry entry;
+        entry.unique_identifier = unique_identifier;
+        entry.program_type = program_type;
+        entry.code = std::move(program_result.first);
+        entry.entries = program_result.second;
+        GetProgramBinary(program->handle, entry);
+        disk_cache.Save(entry);
+    }
+
+    return {std::move(program), std::move(program_result.second)};
+}
+
 } // namespace OpenGL
@@ -4,13 +4,27 @@
 
 #pragma once
 
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <future>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 #include "common/common_types.h"
 #include "video_core/rasterizer_cache.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
+#include "video_core/renderer_opengl/gl_shader_disk_cache.h"
 #include "video_core/renderer_opengl/gl_shader_gen.h"
+#include "video_core/renderer_opengl/gl_uber_shader.h"
+
+namespace Core {
+class System;
+}
 
 namespace OpenGL {
 
@@ -20,7 +34,8 @@ using Maxwell = Tegra::Engines::Maxwell3D::Regs;
 
 class CachedShader final {
 public:
-    CachedShader(VAddr addr, Maxwell::ShaderProgram program_type);
+    CachedShader(VAddr addr, std::size_t size, Maxwell::ShaderProgram program_type,
+                 std::shared_ptr<OGLProgram> program, GLShader::ShaderEntries entries);
 
     /// Gets the address of the shader in guest memory, required for cache management
     VAddr GetAddr() const {
@@ -29,7 +44,7 @@ public:
 
     /// Gets the size of the shader in guest memory, required for cache management
     std::size_t GetSizeInBytes() const {
-        return GLShader::MAX_PROGRAM_CODE_LENGTH * sizeof(u64);
+        return size;
     }
 
     /// Gets the shader entries for the shader
@@ -39,7 +54,7 @@ public:
 
     /// Gets the GL program handle for the shader
     GLuint GetProgramHandle() const {
-        return program.handle;
+        return program->handle;
     }
 
     /// Gets the GL program resource location for the specified resource, caching as needed
@@ -48,21 +63,136 @@ public:
     /// Gets the GL uniform location for the specified resource, caching as needed
     GLint GetUniformLocation(const GLShader::SamplerEntry& sampler);
 
+    /**
+     * Makes the shader interpret its guest program with the uber shader, whose const buffer
+     * blocks are not named after the buffers they hold.
+     * @param block_indices Uniform block indices of the const buffer entries, in entry order
+     */
+    void SetUberShaderOperations(std::shared_ptr<OGLBuffer> operations,
+                                 const std::vector<GLuint>& block_indices);
+
+    /// Gets the operation table interpreted by the uber shader, 0 for specialized programs
+    GLuint GetUberShaderOperations() const {
+        return uber_operations ? uber_operations->handle : 0;
+    }
+
+    /// Gets the work group size a compute kernel was built with
+    const std::array<u32, 3>& GetLocalSize() const {
+        return local_size;
+    }
+
+    void SetLocalSize(const std::array<u32, 3>& size) {
+        local_size = size;
+    }
+
 private:
     VAddr addr;
+    std::size_t size;
     Maxwell::ShaderProgram program_type;
-    GLShader::ShaderSetup setup;
     GLShader::ShaderEntries entries;
-    OGLProgram program;
+    std::shared_ptr<OGLProgram> program;
+    std::shared_ptr<OGLBuffer> uber_operations;
+    std::array<u32, 3> local_size{};
 
     std::map<u32, GLuint> resource_cache;
     std::map<u32, GLint> uniform_cache;
 };
 
+/// Decompiles guest programs into GLSL on a pool of host threads
+class AsyncShaderDecompiler final {
+public:
+    explicit AsyncShaderDecompiler(std::size_t num_workers);
+    ~AsyncShaderDecompiler();
+
+    /// Queues a program to be decompiled, the result is available through the returned future
+    std::future<GLShader::ProgramResult> Decompile(Maxwell::ShaderProgram program_type,
+                                                   GLShader::ShaderSetup setup);
+
+private:
+    void WorkerLoop();
+
+    std::vector<std::thread> workers;
+    std::deque<std::packaged_task<GLShader::ProgramResult()>> tasks;
+    std::mutex tasks_mutex;
+    std::condition_variable tasks_cv;
+    bool is_stopping{};
+};
+
 class ShaderCacheOpenGL final : public RasterizerCache<Shader> {
 public:
-    /// Gets the current specified shader stage program
+    explicit ShaderCacheOpenGL(VideoCore::RasterizerInterface& rasterizer, Core::System& system);
+
+    /**
+     * Gets the current specified shader stage program. When asynchronous shaders are enabled,
+     * this returns nullptr while the program is still being decompiled.
+     */
     Shader GetStageProgram(Maxwell::ShaderProgram program);
+
+    /// Gets the kernel of the latest MaxwellCompute launch, building it if needed
+    Shader GetComputeKernel(Tegra::GPUVAddr code_addr);
+
+    /**
+     * Builds all the programs stored in the disk cache, so they don't have to be built in-game.
+     * Only the first call does anything, the programs are otherwise loaded on the first draw.
+     */
+    void LoadDiskCache(const VideoCore::DiskResourceLoadCallback& callback = {});
+
+    /// Lets the next call to LoadDiskCache load the disk cache of the title running by then
+    void ResetDiskCache();
+
+private:
+    /// A linked GL program along with the entries it was generated with
+    struct CachedProgram {
+        std::shared_ptr<OGLProgram> program;
+        GLShader::ShaderEntries entries;
+    };
+
+    /**
+     * Gets the program with the specified code, building it if needed. Returns nullptr when the
+     * program is being decompiled asynchronously and is not ready yet.
+     */
+    const CachedProgram* GetProgram(u64 unique_identifier, Maxwell::ShaderProgram program_type,
+                                    GLShader::ShaderSetup setup);
+
+    /// A program whose GLSL code is being compiled by the driver in the background
+    struct BuildingProgram {
+        std::shared_ptr<OGLProgram> program;
+        Maxwell::ShaderProgram program_type;
+        GLShader::ProgramResult program_result;
+    };
+
+    /// Compiles and links a decompiled program, storing it in the disk cache
+    CachedProgram LinkProgram(u64 unique_identifier, Maxwell::ShaderProgram program_type,
+                              GLShader::ProgramResult program_result);
+
+    /// Gets a shader that interprets the program with the uber shader, nullptr if it can't
+    Shader GetUberShader(VAddr program_addr, std::size_t size, u64 unique_identifier,
+                         const GLShader::ProgramCode& program_code);
+
+    /// Stores a linked program in the disk cache
+    CachedProgram StoreProgram(u64 unique_identifier, Maxwell::ShaderProgram program_type,
+                               std::shared_ptr<OGLProgram> program,
+                               GLShader::ProgramResult program_result);
+
+    Core::System& system;
+
+    ShaderDiskCacheOpenGL disk_cache;
+    bool is_disk_cache_loaded{};
+
+    /// Programs that have been built, by unique identifier of their program code
+    std::unordered_map<u64, CachedProgram> programs;
+
+    /// Programs that are being decompiled asynchronously, by unique identifier
+    std::unordered_map<u64, std::future<GLShader::ProgramResult>> pending_programs;
+    std::unique_ptr<AsyncShaderDecompiler> async_decompiler;
+
+    /// Decompiled programs that the driver is building in parallel, by unique identifier
+    std::unordered_map<u64, BuildingProgram> building_programs;
+
+    /// Generic program drawing with vertex programs that are still being built
+    std::unique_ptr<UberShaderOpenGL> uber_shader;
+    /// Uber shader translations of pending programs by unique identifier, nullptr if unsupported
+    std::unordered_map<u64, Shader> uber_shaders;
 };
 
 } // namespace OpenGL
@@ -2,10 +2,14 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <bitset>
+#include <cctype>
 #include <map>
 #include <set>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include <fmt/format.h>
 
@@ -29,6 +33,11 @@ using Tegra::Shader::SubOp;
 constexpr u32 PROGRAM_END = MAX_PROGRAM_CODE_LENGTH;
 constexpr u32 PROGRAM_HEADER_SIZE = sizeof(Tegra::Shader::Header);
 
+/// Maximum number of times a program is decompiled to eliminate dead register writes
+constexpr u32 MAX_DECOMPILE_PASSES = 3;
+
+using RegisterSet = std::bitset<Register::NumRegisters>;
+
 class DecompileFail : public std::runtime_error {
 public:
     using std::runtime_error::runtime_error;
@@ -159,6 +168,427 @@ private:
     }
 };
 
+/// Node of the structured control flow of a subroutine.
+struct ControlFlowNode {
+    enum class Type {
+        Code, ///< Straight-line range of instructions.
+        If,   ///< Two-way conditional on a predicate.
+        Loop, ///< Loop whose condition is evaluated at the end of the body.
+    };
+
+    Type type;
+    u32 begin{};       ///< First instruction of a Code node.
+    u32 end{};         ///< Instruction after the last one of a Code node.
+    u64 pred_index{};  ///< Predicate of the condition of If and Loop nodes.
+    bool negate_pred{};
+    std::vector<ControlFlowNode> body;      ///< Taken path of an If, body of a Loop.
+    std::vector<ControlFlowNode> else_body; ///< Not taken path of an If.
+};
+
+/**
+ * Recovers if/else and loop constructs from the branches of a subroutine. SSY/SYNC pairs are
+ * resolved statically, so structured programs need neither the jump dispatcher nor the SSY stack.
+ * Control flow that can't be expressed with these constructs is rejected, in which case the
+ * subroutine has to be emitted with the jump dispatcher.
+ */
+class ControlFlowStructurizer {
+public:
+    ControlFlowStructurizer(const ProgramCode& program_code, u32 main_offset)
+        : program_code(program_code), main_offset(main_offset) {}
+
+    /// Returns the structured control flow starting at begin, if there is one.
+    boost::optional<std::vector<ControlFlowNode>> Structurize(u32 begin) {
+        if (!FindBlocks(begin) || !ResolveSyncTargets(begin) || !FindLoops()) {
+            return boost::none;
+        }
+        ComputePostDominators();
+
+        std::vector<ControlFlowNode> nodes;
+        if (!BuildRegion(begin, PROGRAM_END, PROGRAM_END, false, nodes)) {
+            return boost::none;
+        }
+        return nodes;
+    }
+
+private:
+    /// Basic block of the subroutine, instructions are in [begin, end).
+    struct Block {
+        enum class Exit {
+            Fallthrough, ///< Continues on the next block.
+            Jump,        ///< Unconditionally jumps to target.
+            Branch,      ///< Jumps to target if the predicate is met, otherwise continues on next.
+            Return,      ///< Ends the program.
+        };
+
+        u32 begin{};
+        u32 end{};
+        u32 code_end{}; ///< End of the instructions emitted as code, excludes BRA and SYNC.
+        Exit exit{};
+        bool is_sync{}; ///< The terminator is a SYNC, its target is set by the matching SSY.
+        u32 target{PROGRAM_END};
+        u32 next{PROGRAM_END};
+        u64 pred_index{};
+        bool negate_pred{};
+        u32 ipdom{PROGRAM_END}; ///< Immediate post dominator, ignoring loop back edges.
+    };
+
+    bool IsSchedInstruction(u32 offset) const {
+        return ((offset - main_offset) % 4) == 0;
+    }
+
+    static bool IsPredicated(Instruction instr) {
+        return instr.pred.pred_index != static_cast<u64>(Tegra::Shader::Pred::UnusedIndex);
+    }
+
+    /// Returns whether a block ends at this instruction. Fails on exits that can't be structured.
+    bool IsTerminator(Instruction instr, OpCode::Id id, bool& is_valid) const {
+        switch (id) {
+        case OpCode::Id::EXIT:
+            if (IsPredicated(instr)) {
+                return false;
+            }
+            is_valid = instr.flow.cond == Tegra::Shader::FlowCondition::Always;
+            return true;
+        case OpCode::Id::BRA:
+            is_valid = instr.bra.constant_buffer == 0;
+            return true;
+        case OpCode::Id::SYNC:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    /// Splits the code reachable from begin into basic blocks.
+    bool FindBlocks(u32 begin) {
+        std::set<u32> leaders{begin};
+        std::set<u32> visited;
+        std::vector<u32> pending{begin};
+
+        while (!pending.empty()) {
+            u32 offset = pending.back();
+            pending.pop_back();
+
+            for (; visited.count(offset) == 0; ++offset) {
+                if (offset >= PROGRAM_END) {
+                    return false;
+                }
+                visited.insert(offset);
+                if (IsSchedInstruction(offset)) {
+                    continue;
+                }
+
+                const Instruction instr = {program_code[offset]};
+                const auto opcode = OpCode::Decode(instr);
+                if (!opcode) {
+                    continue;
+                }
+
+                const OpCode::Id id = opcode->GetId();
+                if (id == OpCode::Id::SSY) {
+                    if (instr.bra.constant_buffer != 0) {
+                        return false;
+                    }
+                    const u32 target = offset + instr.bra.GetBranchTarget();
+                    leaders.insert(target);
+                    pending.push_back(target);
+                    continue;
+                }
+
+                bool is_valid = true;
+                if (!IsTerminator(instr, id, is_valid)) {
+                    continue;
+                }
+                if (!is_valid) {
+                    return false;
+                }
+                if (id == OpCode::Id::BRA) {
+                    const u32 target = offset + instr.bra.GetBranchTarget();
+                    leaders.insert(target);
+                    pending.push_back(target);
+                }
+                if (id != OpCode::Id::EXIT && IsPredicated(instr)) {
+                    leaders.insert(offset + 1);
+                    pending.push_back(offset + 1);
+                }
+                break;
+            }
+        }
+
+        for (const u32 leader : leaders) {
+            Block block;
+            block.begin = leader;
+
+            for (u32 offset = leader;; ++offset) {
+                if (offset != leader && leaders.count(offset) != 0) {
+                    block.end = block.code_end = offset;
+                    block.exit = Block::Exit::Fallthrough;
+                    block.next = offset;
+                    break;
+                }
+                if (IsSchedInstruction(offset)) {
+                    continue;
+                }
+
+                const Instruction instr = {program_code[offset]};
+                const auto opcode = OpCode::Decode(instr);
+                bool is_valid = true;
+                if (!opcode || !IsTerminator(instr, opcode->GetId(), is_valid)) {
+                    continue;
+                }
+
+                block.end = offset + 1;
+                if (opcode->GetId() == OpCode::Id::EXIT) {
+                    block.code_end = block.end;
+                    block.exit = Block::Exit::Return;
+                    break;
+                }
+
+                block.code_end = offset;
+                block.is_sync = opcode->GetId() == OpCode::Id::SYNC;
+                if (!block.is_sync) {
+                    block.target = offset + instr.bra.GetBranchTarget();
+                }
+                if (IsPredicated(instr)) {
+                    block.exit = Block::Exit::Branch;
+                    block.next = offset + 1;
+                    block.pred_index = instr.pred.pred_index;
+                    block.negate_pred = instr.negate_pred != 0;
+                } else {
+                    block.exit = Block::Exit::Jump;
+                }
+                break;
+            }
+            blocks.emplace(leader, block);
+        }
+        return true;
+    }
+
+    /// Resolves the targets of SYNC instructions by tracking the SSY stack along every path.
+    bool ResolveSyncTargets(u32 begin) {
+        std::map<u32, std::vector<u32>> entry_stacks{{begin, {}}};
+        std::vector<u32> pending{begin};
+
+        const auto visit = [&](u32 successor, const std::vector<u32>& stack) {
+            const auto [iter, inserted] = entry_stacks.emplace(successor, stack);
+            if (inserted) {
+                pending.push_back(successor);
+            }
+            return iter->second == stack;
+        };
+
+        while (!pending.empty()) {
+            Block& block = blocks.at(pending.back());
+            pending.pop_back();
+
+            std::vector<u32> stack = entry_stacks.at(block.begin);
+            for (u32 offset = block.begin; offset < block.code_end; ++offset) {
+                if (IsSchedInstruction(offset)) {
+                    continue;
+                }
+                const Instruction instr = {program_code[offset]};
+                const auto opcode = OpCode::Decode(instr);
+                if (opcode && opcode->GetId() == OpCode::Id::SSY) {
+                    stack.push_back(offset + instr.bra.GetBranchTarget());
+                }
+            }
+
+            if (block.exit == Block::Exit::Return) {
+                continue;
+            }
+            if (block.exit == Block::Exit::Branch || block.exit == Block::Exit::Fallthrough) {
+                if (!visit(block.next, stack)) {
+                    return false;
+                }
+            }
+            if (block.exit == Block::Exit::Fallthrough) {
+                continue;
+            }
+            if (block.is_sync) {
+                if (stack.empty()) {
+                    return false;
+                }
+                block.target = stack.back();
+                stack.pop_back();
+            }
+            if (!visit(block.target, stack)) {
+                return false;
+            }
+        }
+
+        // Drop the blocks that are only reachable through SYNC targets that were never taken.
+        for (auto iter = blocks.begin(); iter != blocks.end();) {
+            iter = entry_stacks.count(iter->first) == 0 ? blocks.erase(iter) : std::next(iter);
+        }
+        return true;
+    }
+
+    /// Returns the successors of a block, ignoring loop back edges.
+    std::vector<u32> GetForwardSuccessors(const Block& block) const {
+        std::vector<u32> successors;
+        if (block.exit == Block::Exit::Fallthrough || block.exit == Block::Exit::Branch) {
+            successors.push_back(block.next);
+        }
+        if ((block.exit == Block::Exit::Jump || block.exit == Block::Exit::Branch) &&
+            block.target > block.begin) {
+            successors.push_back(block.target);
+        }
+        return successors;
+    }
+
+    /**
+     * Finds the loops of the subroutine. Every backward branch has to be the conditional latch of
+     * a loop whose body is the contiguous range of blocks between the header and the latch, that
+     * is only entered through the header and only left through the latch or by ending the program.
+     */
+    bool FindLoops() {
+        for (const auto& [begin, block] : blocks) {
+            const bool has_target =
+                block.exit == Block::Exit::Jump || block.exit == Block::Exit::Branch;
+            if (!has_target || block.target > begin) {
+                continue;
+            }
+            if (block.exit != Block::Exit::Branch || !loops.emplace(block.target, begin).second) {
+                return false;
+            }
+        }
+
+        for (const auto& loop : loops) {
+            const u32 header = loop.first;
+            const u32 latch = loop.second;
+            const auto in_body = [&](u32 offset) { return offset >= header && offset <= latch; };
+            const u32 loop_exit = blocks.at(latch).next;
+
+            for (const auto& [begin, block] : blocks) {
+                for (const u32 successor : GetForwardSuccessors(block)) {
+                    if (in_body(begin) && !in_body(successor) &&
+                        !(begin == latch && successor == loop_exit)) {
+                        return false;
+                    }
+                    if (!in_body(begin) && in_body(successor) && successor != header) {
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    /// Computes the immediate post dominator of every block on the graph without back edges.
+    void ComputePostDominators() {
+        std::map<u32, std::set<u32>> post_dominators;
+
+        // Forward edges always go to higher addresses, so visiting the blocks backwards handles
+        // all the successors of a block before the block itself.
+        for (auto iter = blocks.rbegin(); iter != blocks.rend(); ++iter) {
+            auto& [begin, block] = *iter;
+
+            std::set<u32> dominators;
+            bool first = true;
+            for (const u32 successor : GetForwardSuccessors(block)) {
+                const std::set<u32>& successor_dominators = post_dominators.at(successor);
+                if (first) {
+                    dominators = successor_dominators;
+                    first = false;
+                    continue;
+                }
+                std::set<u32> intersection;
+                std::set_intersection(dominators.begin(), dominators.end(),
+                                      successor_dominators.begin(), successor_dominators.end(),
+                                      std::inserter(intersection, intersection.begin()));
+                dominators = std::move(intersection);
+            }
+
+            // Post dominators are ordered along every path, so the closest one has the lowest
+            // address. Blocks that only end the program are post dominated by the program end.
+            block.ipdom = dominators.empty() ? PROGRAM_END : *dominators.begin();
+            dominators.insert(begin);
+            post_dominators.emplace(begin, std::move(dominators));
+        }
+    }
+
+    /**
+     * Builds the nodes of the code executed from current until stop is reached.
+     * @param latch Latch of the loop being built, where its body ends.
+     * @param is_loop_entry Whether current is the header of the loop being built.
+     * @return false if the code is not structured.
+     */
+    bool BuildRegion(u32 current, u32 stop, u32 latch, bool is_loop_entry,
+                     std::vector<ControlFlowNode>& nodes) {
+        for (; current != stop; is_loop_entry = false) {
+            if (current == PROGRAM_END) {
+                // Every path of the region ended the program.
+                return true;
+            }
+
+            const auto loop = loops.find(current);
+            if (loop != loops.end() && !is_loop_entry) {
+                const Block& loop_latch = blocks.at(loop->second);
+                ControlFlowNode node{ControlFlowNode::Type::Loop};
+                node.pred_index = loop_latch.pred_index;
+                node.negate_pred = loop_latch.negate_pred;
+                if (!BuildRegion(current, PROGRAM_END, loop->second, true, node.body)) {
+                    return false;
+                }
+                nodes.push_back(std::move(node));
+                current = loop_latch.next;
+                continue;
+            }
+
+            // Blocks reached through more than one path would have to be duplicated.
+            if (!emitted_blocks.insert(current).second) {
+                return false;
+            }
+
+            const Block& block = blocks.at(current);
+            if (block.code_end > block.begin) {
+                ControlFlowNode node{ControlFlowNode::Type::Code};
+                node.begin = block.begin;
+                node.end = block.code_end;
+                nodes.push_back(std::move(node));
+            }
+
+            if (current == latch) {
+                // The back edge is the condition of the loop node.
+                return true;
+            }
+
+            switch (block.exit) {
+            case Block::Exit::Return:
+                return true;
+            case Block::Exit::Fallthrough:
+                current = block.next;
+                break;
+            case Block::Exit::Jump:
+                current = block.target;
+                break;
+            case Block::Exit::Branch: {
+                ControlFlowNode node{ControlFlowNode::Type::If};
+                node.pred_index = block.pred_index;
+                node.negate_pred = block.negate_pred;
+                if (!BuildRegion(block.target, block.ipdom, latch, false, node.body) ||
+                    !BuildRegion(block.next, block.ipdom, latch, false, node.else_body)) {
+                    return false;
+                }
+                if (!node.body.empty() || !node.else_body.empty()) {
+                    nodes.push_back(std::move(node));
+                }
+                current = block.ipdom;
+                break;
+            }
+            }
+        }
+        return true;
+    }
+
+    const ProgramCode& program_code;
+    const u32 main_offset;
+
+    std::map<u32, Block> blocks;
+    std::map<u32, u32> loops; ///< Maps loop headers to their latches.
+    std::set<u32> emitted_blocks;
+};
+
 class ShaderWriter {
 public:
     void AddLine(std::string_view text) {
@@ -253,8 +683,10 @@ enum class InternalFlag : u64 {
 class GLSLRegisterManager {
 public:
     GLSLRegisterManager(ShaderWriter& shader, ShaderWriter& declarations,
-                        const Maxwell3D::Regs::ShaderStage& stage, const std::string& suffix)
-        : shader{shader}, declarations{declarations}, stage{stage}, suffix{suffix} {
+                        const Maxwell3D::Regs::ShaderStage& stage, const std::string& suffix,
+                        const RegisterSet& live_registers)
+        : shader{shader}, declarations{declarations}, stage{stage}, suffix{suffix},
+          live_registers{live_registers} {
         BuildRegisterList();
         BuildInputList();
     }
@@ -343,8 +775,15 @@ public:
 
         const std::string func{is_signed ? "intBitsToFloat" : "uintBitsToFloat"};
 
-        SetRegister(reg, elem, func + '(' + ConvertIntegerSize(value, size) + ')',
-                    dest_num_components, value_num_components, dest_elem);
+        // Registers read as integers are written back as they were, without the round trip
+        // through the conversion functions
+        std::string converted_value = ConvertIntegerSize(value, size);
+        if (!StripFunctionCall(converted_value, "floatBitsToInt") &&
+            !StripFunctionCall(converted_value, "floatBitsToUint")) {
+            converted_value = func + '(' + converted_value + ')';
+        }
+        SetRegister(reg, elem, converted_value, dest_num_components, value_num_components,
+                    dest_elem);
 
         if (sets_cc) {
             const std::string zero_condition = "( " + ConvertIntegerSize(value, size) + " == 0 )";
@@ -361,6 +800,9 @@ public:
      */
     void SetRegisterToInputAttibute(const Register& reg, u64 elem, Attribute::Index attribute,
                                     const Tegra::Shader::IpaMode& input_mode) {
+        if (!IsLive(reg, 0)) {
+            return;
+        }
         const std::string dest = GetRegisterAsFloat(reg);
         const std::string src = GetInputAttribute(attribute, input_mode) + GetSwizzle(elem);
         shader.AddLine(dest + " = " + src + ';');
@@ -441,9 +883,12 @@ public:
         }
     }
 
-    /// Add declarations for registers
-    void GenerateDeclarations(const std::string& suffix) {
+    /// Add declarations for registers, only the given registers are declared
+    void GenerateDeclarations(const std::string& suffix, const RegisterSet& used_registers) {
         for (const auto& reg : regs) {
+            if (!used_registers[reg.GetIndex()]) {
+                continue;
+            }
             declarations.AddLine(GLSLRegister::GetTypeString() + ' ' + reg.GetPrefixString() +
                                  std::to_string(reg.GetIndex()) + '_' + suffix + " = 0;");
         }
@@ -529,6 +974,35 @@ public:
     }
 
 private:
+    /**
+     * Removes a call to a function wrapping a whole expression.
+     * @param value Expression to remove the call from, modified in place.
+     * @param func Name of the function.
+     * @returns True if the expression was a call to the function and it was removed.
+     */
+    static bool StripFunctionCall(std::string& value, std::string_view func) {
+        if (value.size() < func.size() + 2 || value.compare(0, func.size(), func) != 0 ||
+            value[func.size()] != '(' || value.back() != ')') {
+            return false;
+        }
+        // The parenthesis after the function name has to be the one closed at the end
+        int depth = 0;
+        for (std::size_t i = func.size(); i < value.size() - 1; ++i) {
+            depth += value[i] == '(' ? 1 : value[i] == ')' ? -1 : 0;
+            if (depth == 0) {
+                return false;
+            }
+        }
+        value = value.substr(func.size() + 1, value.size() - func.size() - 2);
+        return true;
+    }
+
+    /// Returns whether the register is read anywhere in the program, writes to it can be skipped
+    /// otherwise.
+    bool IsLive(const Register& reg, u64 elem) const {
+        return reg == Register::ZeroIndex || live_registers[reg.GetSwizzledIndex(elem)];
+    }
+
     /// Generates code representing a temporary (GPR) register.
     std::string GetRegister(const Register& reg, unsigned elem) {
         if (reg == Register::ZeroIndex) {
@@ -554,6 +1028,9 @@ private:
             UNREACHABLE();
             return;
         }
+        if (!IsLive(reg, dest_elem)) {
+            return;
+        }
 
         std::string dest = GetRegister(reg, static_cast<u32>(dest_elem));
         if (dest_num_components > 1) {
@@ -707,20 +1184,27 @@ private:
     std::vector<SamplerEntry> used_samplers;
     const Maxwell3D::Regs::ShaderStage& stage;
     const std::string& suffix;
+    const RegisterSet& live_registers;
 };
 
 class GLSLGenerator {
 public:
     GLSLGenerator(const std::set<Subroutine>& subroutines, const ProgramCode& program_code,
-                  u32 main_offset, Maxwell3D::Regs::ShaderStage stage, const std::string& suffix)
+                  u32 main_offset, Maxwell3D::Regs::ShaderStage stage, const std::string& suffix,
+                  const RegisterSet& live_registers)
         : subroutines(subroutines), program_code(program_code), main_offset(main_offset),
-          stage(stage), suffix(suffix) {
+          stage(stage), suffix(suffix), live_registers(live_registers) {
         std::memcpy(&header, program_code.data(), sizeof(Tegra::Shader::Header));
         Generate(suffix);
     }
 
     std::string GetShaderCode() {
-        return declarations.GetResult() + shader.GetResult();
+        return declarations.GetResult() + code;
+    }
+
+    /// Returns the registers that are read by the generated code
+    const RegisterSet& GetReadRegisters() const {
+        return read_registers;
     }
 
     /// Returns entries in the shader that are useful for external functions
@@ -1029,6 +1513,35 @@ private:
         shader.AddLine('}');
     }
 
+    /// Returns the GLSL expression of the system variable read by S2R, as an unsigned integer.
+    std::string GetSystemVariable(Tegra::Shader::SystemVariable variable) const {
+        using Tegra::Shader::SystemVariable;
+        if (stage == Maxwell3D::Regs::ShaderStage::Compute) {
+            switch (variable) {
+            case SystemVariable::Tid:
+                return "(gl_LocalInvocationID.x | (gl_LocalInvocationID.y << 16) | "
+                       "(gl_LocalInvocationID.z << 26))";
+            case SystemVariable::TidX:
+                return "gl_LocalInvocationID.x";
+            case SystemVariable::TidY:
+                return "gl_LocalInvocationID.y";
+            case SystemVariable::TidZ:
+                return "gl_LocalInvocationID.z";
+            case SystemVariable::CtaIdX:
+                return "gl_WorkGroupID.x";
+            case SystemVariable::CtaIdY:
+                return "gl_WorkGroupID.y";
+            case SystemVariable::CtaIdZ:
+                return "gl_WorkGroupID.z";
+            default:
+                break;
+            }
+        }
+        LOG_CRITICAL(HW_GPU, "Unhandled system variable {} in shader stage {}",
+                     static_cast<u32>(variable), static_cast<u32>(stage));
+        return "0u";
+    }
+
     /// Writes the output values from a fragment shader to the corresponding GLSL output variables.
     void EmitFragmentOutputsWrite() {
         ASSERT(stage == Maxwell3D::Regs::ShaderStage::Fragment);
@@ -2611,6 +3124,11 @@ private:
                 }
                 break;
             }
+            case OpCode::Id::S2R: {
+                regs.SetRegisterToInteger(instr.gpr0, false, 0, GetSystemVariable(instr.sys20), 1,
+                                          1);
+                break;
+            }
             case OpCode::Id::SSY: {
                 // The SSY opcode tells the GPU where to re-converge divergent execution paths, it
                 // sets the target of the jump that the SYNC instruction will make. The SSY opcode
@@ -2667,6 +3185,50 @@ private:
         return program_counter;
     }
 
+    /// Compiles the structured control flow of a subroutine from Tegra to GLSL.
+    void CompileNodes(const std::vector<ControlFlowNode>& nodes) {
+        for (const auto& node : nodes) {
+            switch (node.type) {
+            case ControlFlowNode::Type::Code:
+                for (u32 offset = node.begin; offset < node.end; ++offset) {
+                    // SSY only sets the target of SYNC, which is already resolved in the nodes.
+                    if (IsSchedInstruction(offset) ||
+                        !IsSsyInstruction(Instruction{program_code[offset]})) {
+                        CompileInstr(offset);
+                    }
+                }
+                break;
+            case ControlFlowNode::Type::If:
+                shader.AddLine("if (" + GetPredicateCondition(node.pred_index, node.negate_pred) +
+                               ") {");
+                ++shader.scope;
+                CompileNodes(node.body);
+                --shader.scope;
+                if (!node.else_body.empty()) {
+                    shader.AddLine("} else {");
+                    ++shader.scope;
+                    CompileNodes(node.else_body);
+                    --shader.scope;
+                }
+                shader.AddLine('}');
+                break;
+            case ControlFlowNode::Type::Loop:
+                shader.AddLine("do {");
+                ++shader.scope;
+                CompileNodes(node.body);
+                --shader.scope;
+                shader.AddLine("} while (" +
+                               GetPredicateCondition(node.pred_index, node.negate_pred) + ");");
+                break;
+            }
+        }
+    }
+
+    static bool IsSsyInstruction(Instruction instr) {
+        const auto opcode = OpCode::Decode(instr);
+        return opcode && opcode->GetId() == OpCode::Id::SSY;
+    }
+
     void Generate(const std::string& suffix) {
         // Add declarations for all subroutines
         for (const auto& subroutine : subroutines) {
@@ -2692,6 +3254,10 @@ private:
                 if (CompileRange(subroutine.begin, subroutine.end) != PROGRAM_END) {
                     shader.AddLine("return false;");
                 }
+            } else if (const auto nodes = ControlFlowStructurizer(program_code, main_offset)
+                                              .Structurize(subroutine.begin)) {
+                CompileNodes(*nodes);
+                shader.AddLine("return false;");
             } else {
                 labels.insert(subroutine.begin);
                 shader.AddLine("uint jmp_to = " + std::to_string(subroutine.begin) + "u;");
@@ -2740,12 +3306,60 @@ private:
             DEBUG_ASSERT(shader.scope == 0);
         }
 
+        code = shader.GetResult();
+        ScanRegisterUses();
         GenerateDeclarations();
     }
 
+    /**
+     * Finds the registers referenced by the generated code. A reference at the start of a line
+     * followed by an assignment is a write, any other one is a read.
+     */
+    void ScanRegisterUses() {
+        const std::string prefix = GLSLRegister::GetPrefixString();
+        const std::string name_suffix = '_' + suffix;
+        const auto is_identifier = [](char c) {
+            return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+        };
+
+        for (std::size_t pos = code.find(prefix); pos != std::string::npos;
+             pos = code.find(prefix, pos + 1)) {
+            if (pos > 0 && is_identifier(code[pos - 1])) {
+                continue;
+            }
+            std::size_t end = pos + prefix.size();
+            const std::size_t digits_begin = end;
+            while (end < code.size() && std::isdigit(static_cast<unsigned char>(code[end]))) {
+                ++end;
+            }
+            if (end == digits_begin || code.compare(end, name_suffix.size(), name_suffix) != 0) {
+                continue;
+            }
+            const std::size_t index = std::stoul(code.substr(digits_begin, end - digits_begin));
+            end += name_suffix.size();
+            if (index >= Register::NumRegisters ||
+                (end < code.size() && is_identifier(code[end]))) {
+                continue;
+            }
+            used_registers.set(index);
+
+            const std::size_t line_begin = code.rfind('\n', pos) + 1;
+            const bool at_line_start = code.find_first_not_of(' ', line_begin) == pos;
+            std::size_t assign = end;
+            if (assign < code.size() && code[assign] == '.') {
+                assign = code.find_first_not_of("xyzw", assign + 1);
+            }
+            const bool is_write =
+                at_line_start && assign != std::string::npos && code.compare(assign, 3, " = ") == 0;
+            if (!is_write) {
+                read_registers.set(index);
+            }
+        }
+    }
+
     /// Add declarations for registers
     void GenerateDeclarations() {
-        regs.GenerateDeclarations(suffix);
+        regs.GenerateDeclarations(suffix, used_registers);
 
         for (const auto& pred : declr_predicates) {
             declarations.AddLine("bool " + pred + " = false;");
@@ -2761,9 +3375,18 @@ private:
     Maxwell3D::Regs::ShaderStage stage;
     const std::string& suffix;
 
+    const RegisterSet& live_registers;
+
     ShaderWriter shader;
     ShaderWriter declarations;
-    GLSLRegisterManager regs{shader, declarations, stage, suffix};
+    GLSLRegisterManager regs{shader, declarations, stage, suffix, live_registers};
+
+    /// Generated code, without the declarations
+    std::string code;
+    /// Registers referenced by the generated code
+    RegisterSet used_registers;
+    /// Registers read by the generated code
+    RegisterSet read_registers;
 
     // Declarations
     std::set<std::string> declr_predicates;
@@ -2780,8 +3403,21 @@ boost::optional<ProgramResult> DecompileProgram(const ProgramCode& program_code,
     try {
         const auto subroutines =
             ControlFlowAnalyzer(program_code, main_offset, suffix).GetSubroutines();
-        GLSLGenerator generator(subroutines, program_code, main_offset, stage, suffix);
-        return ProgramResult{generator.GetShaderCode(), generator.GetEntries()};
+
+        // Writes to registers that are never read are skipped, which can leave other registers
+        // only read by the skipped writes. The program is decompiled again without them until no
+        // more registers become dead.
+        RegisterSet live_registers;
+        live_registers.set();
+        for (u32 pass = 1;; ++pass) {
+            GLSLGenerator generator(subroutines, program_code, main_offset, stage, suffix,
+                                    live_registers);
+            const RegisterSet& read_registers = generator.GetReadRegisters();
+            if (read_registers == live_registers || pass == MAX_DECOMPILE_PASSES) {
+                return ProgramResult{generator.GetShaderCode(), generator.GetEntries()};
+            }
+            live_registers = read_registers;
+        }
     } catch (const DecompileFail& exception) {
         LOG_ERROR(HW_GPU, "Shader decompilation failed: {}", exception.what());
     }
@@ -0,0 +1,278 @@
+// Copyright 2018 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <type_traits>
+#include <fmt/format.h>
+
+#include "common/common_paths.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/scm_rev.h"
+#include "core/core.h"
+#include "core/hle/kernel/process.h"
+#include "video_core/renderer_opengl/gl_shader_disk_cache.h"
+
+namespace OpenGL {
+
+namespace {
+
+constexpr u64 CACHE_MAGIC = 0x48434153414E4947; // "GINASACH"
+
+/// Bump this whenever the layout of the cache file or the hash of the shader identifiers changes
+constexpr u32 CACHE_FORMAT_VERSION = 2;
+
+/// Serializes values into a byte buffer, so that an entry is written to the file in one go
+class EntryWriter {
+public:
+    template <typename T>
+    void Write(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const auto* const bytes = reinterpret_cast<const u8*>(&value);
+        data.insert(data.end(), bytes, bytes + sizeof(T));
+    }
+
+    void WriteBlob(const void* blob, std::size_t size) {
+        Write(static_cast<u32>(size));
+        const auto* const bytes = static_cast<const u8*>(blob);
+        data.insert(data.end(), bytes, bytes + size);
+    }
+
+    const std::vector<u8>& GetData() const {
+        return data;
+    }
+
+private:
+    std::vector<u8> data;
+};
+
+template <typename T>
+bool Read(const FileUtil::IOFile& file, T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    return file.ReadBytes(&value, sizeof(T)) == sizeof(T);
+}
+
+bool ReadString(const FileUtil::IOFile& file, std::string& value) {
+    u32 size{};
+    if (!Read(file, size) || size > file.GetSize()) {
+        return false;
+    }
+    value.resize(size);
+    return file.ReadBytes(value.data(), size) == size;
+}
+
+bool ReadBinary(const FileUtil::IOFile& file, std::vector<u8>& value) {
+    u32 size{};
+    if (!Read(file, size) || size > file.GetSize()) {
+        return false;
+    }
+    value.resize(size);
+    return file.ReadBytes(value.data(), size) == size;
+}
+
+bool ReadEntry(const FileUtil::IOFile& file, ShaderDiskCacheEntry& entry) {
+    u32 program_type{};
+    if (!Read(file, entry.unique_identifier) || !Read(file, program_type) ||
+        !ReadString(file, entry.code)) {
+        return false;
+    }
+    if (program_type > static_cast<u32>(Maxwell::ShaderProgram::Compute)) {
+        return false;
+    }
+    entry.program_type = static_cast<Maxwell::ShaderProgram>(program_type);
+
+    u32 num_const_buffers{};
+    if (!Read(file, num_const_buffers) || num_const_buffers > Maxwell::MaxConstBuffers) {
+        return false;
+    }
+    for (u32 i = 0; i < num_const_buffers; ++i) {
+        u32 index{};
+        u32 size{};
+        u32 stage{};
+        u8 is_indirect{};
+        if (!Read(file, index) || !Read(file, size) || !Read(file, stage) ||
+            !Read(file, is_indirect) || size == 0 ||
+            stage > static_cast<u32>(Maxwell::ShaderStage::Compute)) {
+            return false;
+        }
+
+        GLShader::ConstBufferEntry buffer;
+        buffer.MarkAsUsed(index, size - 1, static_cast<Maxwell::ShaderStage>(stage));
+        if (is_indirect != 0) {
+            buffer.MarkAsUsedIndirect(index, static_cast<Maxwell::ShaderStage>(stage));
+        }
+        entry.entries.const_buffer_entries.push_back(buffer);
+    }
+
+    u32 num_samplers{};
+    if (!Read(file, num_samplers)) {
+        return false;
+    }
+    for (u32 i = 0; i < num_samplers; ++i) {
+        u64 offset{};
+        u64 index{};
+        u32 stage{};
+        u32 type{};
+        u8 is_array{};
+        if (!Read(file, offset) || !Read(file, index) || !Read(file, stage) || !Read(file, type) ||
+            !Read(file, is_array) || stage > static_cast<u32>(Maxwell::ShaderStage::Compute)) {
+            return false;
+        }
+        entry.entries.texture_samplers.emplace_back(
+            static_cast<Maxwell::ShaderStage>(stage), static_cast<std::size_t>(offset),
+            static_cast<std::size_t>(index), static_cast<Tegra::Shader::TextureType>(type),
+            is_array != 0);
+    }
+
+    u32 binary_format{};
+    if (!Read(file, binary_format) || !ReadBinary(file, entry.binary)) {
+        return false;
+    }
+    entry.binary_format = static_cast<GLenum>(binary_format);
+    return true;
+}
+
+std::vector<u8> SerializeEntry(const ShaderDiskCacheEntry& entry) {
+    EntryWriter writer;
+    writer.Write(entry.unique_identifier);
+    writer.Write(static_cast<u32>(entry.program_type));
+    writer.WriteBlob(entry.code.data(), entry.code.size());
+
+    writer.Write(static_cast<u32>(entry.entries.const_buffer_entries.size()));
+    for (const auto& buffer : entry.entries.const_buffer_entries) {
+        writer.Write(static_cast<u32>(buffer.GetIndex()));
+        writer.Write(static_cast<u32>(buffer.GetSize()));
+        writer.Write(static_cast<u32>(buffer.GetStage()));
+        writer.Write(static_cast<u8>(buffer.IsIndirect() ? 1 : 0));
+    }
+
+    writer.Write(static_cast<u32>(entry.entries.texture_samplers.size()));
+    for (const auto& sampler : entry.entries.texture_samplers) {
+        writer.Write(static_cast<u64>(sampler.GetOffset()));
+        writer.Write(static_cast<u64>(sampler.GetIndex()));
+        writer.Write(static_cast<u32>(sampler.GetStage()));
+        writer.Write(static_cast<u32>(sampler.GetType()));
+        writer.Write(static_cast<u8>(sampler.IsArray() ? 1 : 0));
+    }
+
+    writer.Write(static_cast<u32>(entry.binary_format));
+    writer.WriteBlob(entry.binary.data(), entry.binary.size());
+    return writer.GetData();
+}
+
+} // Anonymous namespace
+
+std::vector<ShaderDiskCacheEntry> ShaderDiskCacheOpenGL::Load() {
+    is_writable = false;
+    binaries_usable = false;
+
+    FileUtil::IOFile file(GetCacheFilePath(), "rb");
+    if (!file.IsOpen()) {
+        LOG_INFO(Render_OpenGL, "No shader disk cache found for the current title");
+        return {};
+    }
+
+    u64 magic{};
+    u32 format_version{};
+    std::string scm_rev;
+    std::string driver;
+    if (!Read(file, magic) || !Read(file, format_version) || !ReadString(file, scm_rev) ||
+        !ReadString(file, driver) || magic != CACHE_MAGIC ||
+        format_version != CACHE_FORMAT_VERSION || scm_rev != Common::g_scm_rev) {
+        // Programs generated by another build may differ, they have to be built again
+        LOG_INFO(Render_OpenGL, "Shader disk cache is outdated, discarding it");
+        return {};
+    }
+
+    binaries_usable = driver == GetDriverIdentifier();
+    if (!binaries_usable) {
+        LOG_INFO(Render_OpenGL, "GL driver changed, shader disk cache binaries will be rebuilt");
+    }
+
+    std::vector<ShaderDiskCacheEntry> entries;
+    while (file.Tell() < file.GetSize()) {
+        ShaderDiskCacheEntry entry;
+        if (!ReadEntry(file, entry)) {
+            // Most likely a partially written entry, keep what was read so far
+            LOG_WARNING(Render_OpenGL, "Shader disk cache is corrupted, truncating it");
+            binaries_usable = false;
+            break;
+        }
+        if (!binaries_usable) {
+            entry.binary.clear();
+        }
+        entries.push_back(std::move(entry));
+    }
+
+    // Only keep appending to the file when its whole contents are still valid, otherwise it gets
+    // recreated on the next save.
+    is_writable = binaries_usable;
+
+    LOG_INFO(Render_OpenGL, "Loaded {} programs from the shader disk cache", entries.size());
+    return entries;
+}
+
+void ShaderDiskCacheOpenGL::Save(const ShaderDiskCacheEntry& entry) {
+    if (!EnsureWritable()) {
+        return;
+    }
+
+    FileUtil::IOFile file(GetCacheFilePath(), "ab");
+    const std::vector<u8> data = SerializeEntry(entry);
+    if (!file.IsOpen() || file.WriteBytes(data.data(), data.size()) != data.size()) {
+        LOG_ERROR(Render_OpenGL, "Failed to write to the shader disk cache");
+        has_failed = true;
+    }
+}
+
+bool ShaderDiskCacheOpenGL::EnsureWritable() {
+    if (is_writable || has_failed) {
+        return !has_failed;
+    }
+
+    const std::string path = GetCacheFilePath();
+    if (!FileUtil::CreateFullPath(path)) {
+        LOG_ERROR(Render_OpenGL, "Failed to create the shader disk cache directory");
+        has_failed = true;
+        return false;
+    }
+
+    FileUtil::IOFile file(path, "wb");
+    if (!file.IsOpen()) {
+        LOG_ERROR(Render_OpenGL, "Failed to create the shader disk cache at {}", path);
+        has_failed = true;
+        return false;
+    }
+
+    const std::string scm_rev = Common::g_scm_rev;
+    const std::string driver = GetDriverIdentifier();
+
+    EntryWriter header;
+    header.Write(CACHE_MAGIC);
+    header.Write(CACHE_FORMAT_VERSION);
+    header.WriteBlob(scm_rev.data(), scm_rev.size());
+    header.WriteBlob(driver.data(), driver.size());
+    file.WriteBytes(header.GetData().data(), header.GetData().size());
+
+    is_writable = true;
+    binaries_usable = true;
+    return true;
+}
+
+std::string ShaderDiskCacheOpenGL::GetCacheFilePath() const {
+    return fmt::format("{}opengl" DIR_SEP "{:016X}.bin",
+                       FileUtil::GetUserPath(FileUtil::UserPath::CacheDir),
+                       Core::CurrentProcess()->program_id);
+}
+
+std::string ShaderDiskCacheOpenGL::GetDriverIdentifier() {
+    const auto GetString = [](GLenum name) {
+        const auto* const value = reinterpret_cast<const char*>(glGetString(name));
+        return value != nullptr ? std::string(value) : std::string{};
+    };
+    return fmt::format("{} {} {}", GetString(GL_VENDOR), GetString(GL_RENDERER),
+                       GetString(GL_VERSION));
+}
+
+} // namespace OpenGL
@@ -0,0 +1,71 @@
+// Copyright 2018 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+
+#include "common/common_types.h"
+#include "video_core/engines/maxwell_3d.h"
+#include "video_core/renderer_opengl/gl_shader_gen.h"
+
+namespace OpenGL {
+
+using Maxwell = Tegra::Engines::Maxwell3D::Regs;
+
+/// Describes a single shader program as it is stored in the disk cache
+struct ShaderDiskCacheEntry {
+    /// Hash of the guest program code and the state it was generated with
+    u64 unique_identifier{};
+    Maxwell::ShaderProgram program_type{};
+
+    /// Generated GLSL code, used when the driver binary can't be loaded
+    std::string code;
+    GLShader::ShaderEntries entries;
+
+    /// Driver specific program binary, as returned by glGetProgramBinary. May be empty.
+    GLenum binary_format{};
+    std::vector<u8> binary;
+};
+
+/**
+ * Persists generated shader programs across sessions, so that they don't have to be decompiled
+ * and compiled again on every boot. There is one cache file per title. A cache file is discarded
+ * when it was written by a different build, and its program binaries are ignored when they were
+ * created by a different GL driver.
+ */
+class ShaderDiskCacheOpenGL {
+public:
+    /// Loads all the cached programs of the title that is currently running
+    std::vector<ShaderDiskCacheEntry> Load();
+
+    /// Appends a newly built program to the cache of the title that is currently running
+    void Save(const ShaderDiskCacheEntry& entry);
+
+    /**
+     * Returns whether the cache file is going to be recreated on the next save, in which case all
+     * programs that were loaded from it have to be saved again to be kept.
+     */
+    bool NeedsRewrite() const {
+        return !is_writable;
+    }
+
+private:
+    /// Opens the cache file for appending, writing a new header if it is invalid or missing
+    bool EnsureWritable();
+
+    /// Gets the path of the cache file of the title that is currently running
+    std::string GetCacheFilePath() const;
+
+    /// Returns the identification string of the GL driver in use
+    static std::string GetDriverIdentifier();
+
+    bool binaries_usable{};
+    bool is_writable{};
+    bool has_failed{};
+};
+
+} // namespace OpenGL
@@ -11,8 +11,6 @@ namespace OpenGL::GLShader {
 
 using Tegra::Engines::Maxwell3D;
 
-static constexpr u32 PROGRAM_OFFSET{10};
-
 ProgramResult GenerateVertexShader(const ShaderSetup& setup) {
     std::string out = "#version 430 core\n";
     out += "#extension GL_ARB_separate_shader_objects : enable\n\n";
@@ -111,4 +109,27 @@ void main() {
     return {out, program.second};
 }
 
+ProgramResult GenerateComputeShader(const ShaderSetup& setup) {
+    std::string out = "#version 430 core\n";
+    out += "layout (local_size_x = " + std::to_string(setup.local_size[0]) +
+           ", local_size_y = " + std::to_string(setup.local_size[1]) +
+           ", local_size_z = " + std::to_string(setup.local_size[2]) + ") in;\n\n";
+    out += Decompiler::GetCommonDeclarations();
+    out += "bool exec_compute();\n";
+
+    // Compute kernels have no shader header, their code starts at the launch's program address
+    ProgramResult program =
+        Decompiler::DecompileProgram(setup.program.code, 0,
+                                     Maxwell3D::Regs::ShaderStage::Compute, "compute")
+            .get_value_or({});
+    out += R"(
+void main() {
+    exec_compute();
+}
+
+)";
+    out += program.first;
+    return {out, program.second};
+}
+
 } // namespace OpenGL::GLShader
@@ -14,6 +14,7 @@
 namespace OpenGL::GLShader {
 
 constexpr std::size_t MAX_PROGRAM_CODE_LENGTH{0x1000};
+constexpr u32 PROGRAM_OFFSET{10};
 using ProgramCode = std::vector<u64>;
 
 class ConstBufferEntry {
@@ -50,6 +51,10 @@ public:
         return max_offset + 1;
     }
 
+    Maxwell::ShaderStage GetStage() const {
+        return stage;
+    }
+
     std::string GetName() const {
         return BufferBaseNames[static_cast<std::size_t>(stage)] + std::to_string(index);
     }
@@ -59,8 +64,10 @@ public:
     }
 
 private:
-    static constexpr std::array<const char*, Maxwell::MaxShaderStage> BufferBaseNames = {
+    // Compute kernels don't belong to the 3D pipeline, so their stage is past MaxShaderStage
+    static constexpr std::array<const char*, Maxwell::MaxShaderStage + 1> BufferBaseNames = {
         "buffer_vs_c", "buffer_tessc_c", "buffer_tesse_c", "buffer_gs_c", "buffer_fs_c",
+        "buffer_cs_c",
     };
 
     bool is_used{};
@@ -137,8 +144,8 @@ public:
     }
 
 private:
-    static constexpr std::array<const char*, Maxwell::MaxShaderStage> TextureSamplerNames = {
-        "tex_vs", "tex_tessc", "tex_tesse", "tex_gs", "tex_fs",
+    static constexpr std::array<const char*, Maxwell::MaxShaderStage + 1> TextureSamplerNames = {
+        "tex_vs", "tex_tessc", "tex_tesse", "tex_gs", "tex_fs", "tex_cs",
     };
 
     /// Offset in TSC memory from which to read the sampler object, as specified by the sampling
@@ -177,6 +184,9 @@ struct ShaderSetup {
         return has_program_b;
     }
 
+    /// Size of the work groups of a compute kernel
+    std::array<u32, 3> local_size{1, 1, 1};
+
 private:
     bool has_program_b{};
 };
@@ -193,4 +203,10 @@ ProgramResult GenerateVertexShader(const ShaderSetup& setup);
  */
 ProgramResult GenerateFragmentShader(const ShaderSetup& setup);
 
+/**
+ * Generates the GLSL compute shader program source code for the given compute kernel
+ * @returns String of the shader source code
+ */
+ProgramResult GenerateComputeShader(const ShaderSetup& setup);
+
 } // namespace OpenGL::GLShader
@@ -2,7 +2,10 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
 #include <iterator>
+#include <tuple>
 #include <glad/glad.h>
 #include "common/logging/log.h"
 #include "video_core/renderer_opengl/gl_state.h"
@@ -195,28 +198,9 @@ void OpenGLState::Apply() const {
         glLogicOp(logic_op.operation);
     }
 
-    // Textures
-    for (std::size_t i = 0; i < std::size(texture_units); ++i) {
-        const auto& texture_unit = texture_units[i];
-        const auto& cur_state_texture_unit = cur_state.texture_units[i];
-
-        if (texture_unit.texture != cur_state_texture_unit.texture) {
-            glActiveTexture(TextureUnits::MaxwellTexture(static_cast<int>(i)).Enum());
-            glBindTexture(texture_unit.target, texture_unit.texture);
-        }
-        if (texture_unit.sampler != cur_state_texture_unit.sampler) {
-            glBindSampler(static_cast<GLuint>(i), texture_unit.sampler);
-        }
-        // Update the texture swizzle
-        if (texture_unit.swizzle.r != cur_state_texture_unit.swizzle.r ||
-            texture_unit.swizzle.g != cur_state_texture_unit.swizzle.g ||
-            texture_unit.swizzle.b != cur_state_texture_unit.swizzle.b ||
-            texture_unit.swizzle.a != cur_state_texture_unit.swizzle.a) {
-            std::array<GLint, 4> mask = {texture_unit.swizzle.r, texture_unit.swizzle.g,
-                                         texture_unit.swizzle.b, texture_unit.swizzle.a};
-            glTexParameteriv(texture_unit.target, GL_TEXTURE_SWIZZLE_RGBA, mask.data());
-        }
-    }
+    // Textures and samplers, each bound with a single call over the range of units that changed
+    ApplyTextures();
+    ApplySamplers();
 
     // Framebuffer
     if (draw.read_framebuffer != cur_state.draw.read_framebuffer) {
@@ -294,6 +278,61 @@ OpenGLState& OpenGLState::UnbindTexture(GLuint handle) {
     return *this;
 }
 
+void OpenGLState::ApplyTextures() const {
+    std::size_t first = std::size(texture_units);
+    std::size_t last = 0;
+    for (std::size_t i = 0; i < std::size(texture_units); ++i) {
+        const auto& texture_unit = texture_units[i];
+        const auto& cur_state_texture_unit = cur_state.texture_units[i];
+
+        if (texture_unit.texture != cur_state_texture_unit.texture) {
+            first = std::min(first, i);
+            last = i + 1;
+        }
+        // Update the texture swizzle
+        if (texture_unit.texture != 0 &&
+            (texture_unit.swizzle.r != cur_state_texture_unit.swizzle.r ||
+             texture_unit.swizzle.g != cur_state_texture_unit.swizzle.g ||
+             texture_unit.swizzle.b != cur_state_texture_unit.swizzle.b ||
+             texture_unit.swizzle.a != cur_state_texture_unit.swizzle.a)) {
+            std::array<GLint, 4> mask = {texture_unit.swizzle.r, texture_unit.swizzle.g,
+                                         texture_unit.swizzle.b, texture_unit.swizzle.a};
+            glTextureParameteriv(texture_unit.texture, GL_TEXTURE_SWIZZLE_RGBA, mask.data());
+        }
+    }
+    if (first >= last) {
+        return;
+    }
+
+    std::array<GLuint, std::tuple_size_v<decltype(texture_units)>> textures;
+    for (std::size_t i = first; i < last; ++i) {
+        textures[i] = texture_units[i].texture;
+    }
+    glBindTextures(static_cast<GLuint>(first), static_cast<GLsizei>(last - first),
+                   &textures[first]);
+}
+
+void OpenGLState::ApplySamplers() const {
+    std::size_t first = std::size(texture_units);
+    std::size_t last = 0;
+    for (std::size_t i = 0; i < std::size(texture_units); ++i) {
+        if (texture_units[i].sampler != cur_state.texture_units[i].sampler) {
+            first = std::min(first, i);
+            last = i + 1;
+        }
+    }
+    if (first >= last) {
+        return;
+    }
+
+    std::array<GLuint, std::tuple_size_v<decltype(texture_units)>> samplers;
+    for (std::size_t i = first; i < last; ++i) {
+        samplers[i] = texture_units[i].sampler;
+    }
+    glBindSamplers(static_cast<GLuint>(first), static_cast<GLsizei>(last - first),
+                   &samplers[first]);
+}
+
 OpenGLState& OpenGLState::ResetSampler(GLuint handle) {
     for (auto& unit : texture_units) {
         if (unit.sampler == handle) {
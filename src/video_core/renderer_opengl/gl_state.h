@@ -167,6 +167,11 @@ public:
     OpenGLState& ResetFramebuffer(GLuint handle);
 
 private:
+    /// Binds the textures of the range of units that changed with a single call
+    void ApplyTextures() const;
+    /// Binds the samplers of the range of units that changed with a single call
+    void ApplySamplers() const;
+
     static OpenGLState cur_state;
 };
 
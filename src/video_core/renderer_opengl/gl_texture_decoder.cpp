@@ -0,0 +1,148 @@
+// Copyright 2018 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <tuple>
+
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "core/memory.h"
+#include "video_core/renderer_opengl/gl_state.h"
+#include "video_core/renderer_opengl/gl_texture_decoder.h"
+
+namespace OpenGL {
+
+/// Each invocation copies one 16-byte chunk, a work group covers exactly one GOB
+static const char unswizzle_shader[] = R"(
+#version 430 core
+
+layout (local_size_x = 4, local_size_y = 8) in;
+
+layout (std430, binding = 0) readonly buffer SwizzledData {
+    uvec4 swizzled[];
+};
+
+layout (std430, binding = 1) writeonly buffer LinearData {
+    uvec4 linear[];
+};
+
+layout (location = 0) uniform uvec2 size_in_chunks;
+layout (location = 1) uniform uint width_in_gobs;
+layout (location = 2) uniform uint block_height;
+layout (location = 3) uniform uint conversion;
+
+void main() {
+    const uvec2 position = gl_GlobalInvocationID.xy;
+    if (position.x >= size_in_chunks.x || position.y >= size_in_chunks.y) {
+        return;
+    }
+
+    // Same layout as Tegra::Texture::GetSwizzleOffset, in units of 16 bytes
+    const uint x = position.x * 16;
+    const uint y = position.y;
+    const uint gob_y = y / 8;
+    const uint gob_address = (gob_y / block_height) * 512 * block_height * width_in_gobs +
+                             (x / 64) * 512 * block_height + (gob_y % block_height) * 512;
+    const uint offset = gob_address + ((x % 64) / 32) * 256 + ((y % 8) / 2) * 64 +
+                        ((x % 32) / 16) * 32 + (y % 2) * 16;
+
+    uvec4 value = swizzled[offset / 16];
+    if (conversion == 1) {
+        // S8Z24 to Z24S8
+        value = (value << 8) | (value >> 24);
+    } else if (conversion == 2) {
+        // G8R8 to R8G8
+        value = ((value & 0x00FF00FFu) << 8) | ((value >> 8) & 0x00FF00FFu);
+    }
+    linear[y * size_in_chunks.x + position.x] = value;
+}
+)";
+
+ComputeTextureDecoder::ComputeTextureDecoder()
+    : input_buffer(GL_SHADER_STORAGE_BUFFER, INPUT_BUFFER_SIZE) {
+    OGLShader shader;
+    shader.Create(unswizzle_shader, GL_COMPUTE_SHADER);
+    program.Create(false, false, shader.handle);
+
+    output_buffer.Create();
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &input_buffer_alignment);
+}
+
+ComputeTextureDecoder::~ComputeTextureDecoder() = default;
+
+bool ComputeTextureDecoder::IsSupported() {
+    return GLAD_GL_ARB_compute_shader && GLAD_GL_ARB_shader_storage_buffer_object &&
+           GLAD_GL_ARB_explicit_uniform_location;
+}
+
+MICROPROFILE_DEFINE(OpenGL_ComputeDecode, "OpenGL", "Compute Texture Decode",
+                    MP_RGB(128, 64, 192));
+bool ComputeTextureDecoder::Decode(VAddr addr, u32 stride, u32 height, u32 block_height,
+                                   TextureConversion conversion) {
+    ASSERT(stride % 16 == 0);
+
+    constexpr std::size_t gob_size{512};
+    const std::size_t width_in_gobs{(stride + 63) / 64};
+    const std::size_t height_in_gobs{(height + 7) / 8};
+    const std::size_t height_in_blocks{(height_in_gobs + block_height - 1) / block_height};
+    const std::size_t block_size{gob_size * block_height};
+
+    // The last row of blocks is only read up to its last used GOB
+    const std::size_t swizzled_size{(height_in_blocks - 1) * block_size * width_in_gobs +
+                                    (width_in_gobs - 1) * block_size +
+                                    ((height_in_gobs - 1) % block_height + 1) * gob_size};
+    const std::size_t linear_size{static_cast<std::size_t>(stride) * height};
+    if (swizzled_size + input_buffer_alignment > static_cast<std::size_t>(INPUT_BUFFER_SIZE)) {
+        return false;
+    }
+
+    const u8* const swizzled_data{Memory::GetPointer(addr)};
+    if (swizzled_data == nullptr) {
+        return false;
+    }
+
+    MICROPROFILE_SCOPE(OpenGL_ComputeDecode);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, input_buffer.GetHandle());
+    u8* input_ptr;
+    GLintptr input_offset;
+    std::tie(input_ptr, input_offset, std::ignore) =
+        input_buffer.Map(static_cast<GLsizeiptr>(swizzled_size), input_buffer_alignment);
+    std::memcpy(input_ptr, swizzled_data, swizzled_size);
+    input_buffer.Unmap(static_cast<GLsizeiptr>(swizzled_size));
+
+    if (static_cast<GLsizeiptr>(linear_size) > output_buffer_size) {
+        output_buffer_size = static_cast<GLsizeiptr>(linear_size);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, output_buffer.handle);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, output_buffer_size, nullptr, GL_STREAM_COPY);
+    }
+
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, input_buffer.GetHandle(), input_offset,
+                      static_cast<GLsizeiptr>(swizzled_size));
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 1, output_buffer.handle, 0,
+                      static_cast<GLsizeiptr>(linear_size));
+
+    OpenGLState state{OpenGLState::GetCurState()};
+    const GLuint previous_program{state.draw.shader_program};
+    state.draw.shader_program = program.handle;
+    state.Apply();
+
+    const u32 stride_in_chunks{stride / 16};
+    glUniform2ui(0, stride_in_chunks, height);
+    glUniform1ui(1, static_cast<GLuint>(width_in_gobs));
+    glUniform1ui(2, block_height);
+    glUniform1ui(3, static_cast<GLuint>(conversion));
+    glDispatchCompute((stride_in_chunks + 3) / 4, (height + 7) / 8, 1);
+
+    state.draw.shader_program = previous_program;
+    state.Apply();
+
+    // The result is read back as pixel data by the following texture upload
+    glMemoryBarrier(GL_PIXEL_BUFFER_BARRIER_BIT);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, output_buffer.handle);
+    return true;
+}
+
+} // namespace OpenGL
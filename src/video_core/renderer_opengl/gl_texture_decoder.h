@@ -0,0 +1,54 @@
+// Copyright 2018 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <glad/glad.h>
+
+#include "common/common_types.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+#include "video_core/renderer_opengl/gl_stream_buffer.h"
+
+namespace OpenGL {
+
+/// Format conversions that can be applied while a texture is unswizzled on the GPU
+enum class TextureConversion : u32 {
+    None = 0,
+    S8Z24ToZ24S8 = 1,
+    G8R8ToR8G8 = 2,
+};
+
+/**
+ * Unswizzles block linear textures with a compute shader, so that their guest data is only copied
+ * once into a staging buffer instead of being deswizzled and converted in host memory.
+ */
+class ComputeTextureDecoder final {
+public:
+    ComputeTextureDecoder();
+    ~ComputeTextureDecoder();
+
+    /// Returns whether the GL implementation supports decoding textures with compute shaders
+    static bool IsSupported();
+
+    /**
+     * Unswizzles a block linear texture from guest memory, applying the specified conversion. On
+     * success the linear result is left bound to GL_PIXEL_UNPACK_BUFFER at offset zero.
+     * @param stride Size in bytes of a row of the texture, it has to be a multiple of 16
+     * @returns false when the texture has to be decoded on the CPU instead
+     */
+    bool Decode(VAddr addr, u32 stride, u32 height, u32 block_height,
+                TextureConversion conversion);
+
+private:
+    /// Size of the buffer the swizzled guest data is streamed into
+    static constexpr GLsizeiptr INPUT_BUFFER_SIZE = 64 * 1024 * 1024;
+
+    OGLProgram program;
+    OGLStreamBuffer input_buffer;
+    OGLBuffer output_buffer;
+    GLsizeiptr output_buffer_size{};
+    GLint input_buffer_alignment{};
+};
+
+} // namespace OpenGL
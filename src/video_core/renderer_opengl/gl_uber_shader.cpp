@@ -0,0 +1,605 @@
+// Copyright 2018 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <string>
+
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "video_core/engines/shader_bytecode.h"
+#include "video_core/renderer_opengl/gl_shader_decompiler.h"
+#include "video_core/renderer_opengl/gl_uber_shader.h"
+
+namespace OpenGL {
+
+using Tegra::Shader::Attribute;
+using Tegra::Shader::Instruction;
+using Tegra::Shader::OpCode;
+using Tegra::Shader::Register;
+using Tegra::Shader::SubOp;
+
+/// Number of vertex attributes that translated programs can read
+constexpr u32 NumInputAttributes = 16;
+/// Number of generic attributes that translated programs can write
+constexpr u32 NumOutputAttributes = 12;
+
+/// Operations of the uber shader, each one is stored as two uvec4 in the operation table:
+/// (operation | saturate flag, destination, operand a, operand b, operand c). Operands are stored
+/// as a descriptor and a value.
+enum class Operation : u32 {
+    Exit,
+    Move,
+    LoadAttribute,
+    StoreAttribute,
+    Add,
+    Multiply,
+    FusedMultiplyAdd,
+    Cos,
+    Sin,
+    Exp2,
+    Log2,
+    Reciprocal,
+    ReciprocalSqrt,
+    Sqrt,
+};
+
+constexpr u32 OperationSaturate = 1 << 8;
+
+constexpr u32 OperandRegister = 0;
+constexpr u32 OperandConstBuffer = 1;
+constexpr u32 OperandImmediate = 2;
+constexpr u32 OperandNegate = 1 << 2;
+constexpr u32 OperandAbs = 1 << 3;
+
+/// Generates the GLSL code of the uber shader
+static std::string GenerateUberShader() {
+    const auto Define = [](const char* name, u32 value) {
+        return "#define " + std::string(name) + ' ' + std::to_string(value) + "u\n";
+    };
+
+    std::string out = "#version 430 core\n";
+    out += "#extension GL_ARB_separate_shader_objects : enable\n\n";
+    out += GLShader::Decompiler::GetCommonDeclarations();
+    out += "#define NUM_CBUF_SLOTS " +
+           std::to_string(UberShaderOpenGL::NumConstBufferSlots) + '\n';
+    out += "#define OPERATIONS_BINDING " +
+           std::to_string(UberShaderOpenGL::OperationsBinding) + '\n';
+    out += Define("OP_EXIT", static_cast<u32>(Operation::Exit));
+    out += Define("OP_MOVE", static_cast<u32>(Operation::Move));
+    out += Define("OP_LOAD_ATTRIBUTE", static_cast<u32>(Operation::LoadAttribute));
+    out += Define("OP_STORE_ATTRIBUTE", static_cast<u32>(Operation::StoreAttribute));
+    out += Define("OP_ADD", static_cast<u32>(Operation::Add));
+    out += Define("OP_MULTIPLY", static_cast<u32>(Operation::Multiply));
+    out += Define("OP_FMA", static_cast<u32>(Operation::FusedMultiplyAdd));
+    out += Define("OP_COS", static_cast<u32>(Operation::Cos));
+    out += Define("OP_SIN", static_cast<u32>(Operation::Sin));
+    out += Define("OP_EXP2", static_cast<u32>(Operation::Exp2));
+    out += Define("OP_LOG2", static_cast<u32>(Operation::Log2));
+    out += Define("OP_RCP", static_cast<u32>(Operation::Reciprocal));
+    out += Define("OP_RSQ", static_cast<u32>(Operation::ReciprocalSqrt));
+    out += Define("OP_SQRT", static_cast<u32>(Operation::Sqrt));
+    out += Define("OP_SATURATE", OperationSaturate);
+    out += Define("OPERAND_REGISTER", OperandRegister);
+    out += Define("OPERAND_CONST_BUFFER", OperandConstBuffer);
+    out += Define("OPERAND_NEGATE", OperandNegate);
+    out += Define("OPERAND_ABS", OperandAbs);
+    out += Define("ZERO_REGISTER", static_cast<u32>(Register::ZeroIndex));
+    out += '\n';
+
+    for (u32 index = 0; index < NumInputAttributes; ++index) {
+        out += "layout(location = " + std::to_string(index) + ") in vec4 input_attribute_" +
+               std::to_string(index) + ";\n";
+    }
+    for (u32 index = 0; index < NumOutputAttributes; ++index) {
+        out += "layout(location = " + std::to_string(index) + ") out vec4 output_attribute_" +
+               std::to_string(index) + ";\n";
+    }
+
+    out += R"(
+out gl_PerVertex {
+    vec4 gl_Position;
+};
+
+out vec4 position;
+
+layout (std140) uniform vs_config {
+    vec4 viewport_flip;
+    uvec4 instance_id;
+};
+
+layout (std140) uniform UberConstBuffer {
+    vec4 data[MAX_CONSTBUFFER_ELEMENTS];
+} uber_cbufs[NUM_CBUF_SLOTS];
+
+layout (std430, binding = OPERATIONS_BINDING) readonly buffer UberOperations {
+    uvec4 operations[];
+};
+
+uint regs[256];
+
+float ReadConstBuffer(uint slot, uint offset) {
+    const uint element = offset >> 2;
+    const uint component = offset & 3u;
+    switch (slot) {
+)";
+    for (std::size_t slot = 0; slot < UberShaderOpenGL::NumConstBufferSlots; ++slot) {
+        out += "    case " + std::to_string(slot) + "u: return uber_cbufs[" + std::to_string(slot) +
+               "].data[element][component];\n";
+    }
+    out += R"(    }
+    return 0.0;
+}
+
+uint GetOperandBits(uint descriptor, uint value) {
+    switch (descriptor & 3u) {
+    case OPERAND_REGISTER:
+        return regs[value];
+    case OPERAND_CONST_BUFFER:
+        return floatBitsToUint(ReadConstBuffer(value >> 16, value & 0xFFFFu));
+    }
+    return value;
+}
+
+float GetOperand(uint descriptor, uint value) {
+    float operand = uintBitsToFloat(GetOperandBits(descriptor, value));
+    if ((descriptor & OPERAND_ABS) != 0u) {
+        operand = abs(operand);
+    }
+    if ((descriptor & OPERAND_NEGATE) != 0u) {
+        operand = -operand;
+    }
+    return operand;
+}
+
+vec4 ReadInputAttribute(uint index) {
+    switch (index) {
+)";
+    out += "    case " + std::to_string(static_cast<u32>(Attribute::Index::Position)) +
+           "u: return position;\n";
+    for (u32 index = 0; index < NumInputAttributes; ++index) {
+        out += "    case " +
+               std::to_string(static_cast<u32>(Attribute::Index::Attribute_0) + index) +
+               "u: return input_attribute_" + std::to_string(index) + ";\n";
+    }
+    out += "    case " +
+           std::to_string(static_cast<u32>(Attribute::Index::TessCoordInstanceIDVertexID)) +
+           "u: return vec4(0, 0, uintBitsToFloat(instance_id.x), "
+           "uintBitsToFloat(uint(gl_VertexID)));\n";
+    out += R"(    }
+    return vec4(0.0);
+}
+
+void WriteOutputAttribute(uint index, uint element, float value) {
+    switch (index) {
+)";
+    out += "    case " + std::to_string(static_cast<u32>(Attribute::Index::Position)) +
+           "u: position[element] = value; break;\n";
+    for (u32 index = 0; index < NumOutputAttributes; ++index) {
+        out += "    case " +
+               std::to_string(static_cast<u32>(Attribute::Index::Attribute_0) + index) +
+               "u: output_attribute_" + std::to_string(index) + "[element] = value; break;\n";
+    }
+    out += R"(    }
+}
+
+void main() {
+    position = vec4(0.0);
+)";
+    for (u32 index = 0; index < NumOutputAttributes; ++index) {
+        out += "    output_attribute_" + std::to_string(index) + " = vec4(0.0);\n";
+    }
+    out += R"(    for (uint i = 0u; i < 256u; ++i) {
+        regs[i] = 0u;
+    }
+
+    for (uint pc = 0u;; pc += 2u) {
+        const uvec4 header = operations[pc];
+        const uvec4 operands = operations[pc + 1u];
+        const uint operation = header.x & 0xFFu;
+        if (operation == OP_EXIT) {
+            break;
+        }
+        if (operation == OP_STORE_ATTRIBUTE) {
+            WriteOutputAttribute(header.y >> 2, header.y & 3u, GetOperand(header.z, header.w));
+            continue;
+        }
+        if (operation == OP_MOVE) {
+            if (header.y != ZERO_REGISTER) {
+                regs[header.y] = GetOperandBits(header.z, header.w);
+            }
+            continue;
+        }
+
+        float result = 0.0;
+        switch (operation) {
+        case OP_LOAD_ATTRIBUTE:
+            result = ReadInputAttribute(header.w >> 2)[header.w & 3u];
+            break;
+        case OP_ADD:
+            result = GetOperand(header.z, header.w) + GetOperand(operands.x, operands.y);
+            break;
+        case OP_MULTIPLY:
+            result = GetOperand(header.z, header.w) * GetOperand(operands.x, operands.y);
+            break;
+        case OP_FMA:
+            result = GetOperand(header.z, header.w) * GetOperand(operands.x, operands.y) +
+                     GetOperand(operands.z, operands.w);
+            break;
+        case OP_COS:
+            result = cos(GetOperand(header.z, header.w));
+            break;
+        case OP_SIN:
+            result = sin(GetOperand(header.z, header.w));
+            break;
+        case OP_EXP2:
+            result = exp2(GetOperand(header.z, header.w));
+            break;
+        case OP_LOG2:
+            result = log2(GetOperand(header.z, header.w));
+            break;
+        case OP_RCP:
+            result = 1.0 / GetOperand(header.z, header.w);
+            break;
+        case OP_RSQ:
+            result = inversesqrt(GetOperand(header.z, header.w));
+            break;
+        case OP_SQRT:
+            result = sqrt(GetOperand(header.z, header.w));
+            break;
+        }
+        if ((header.x & OP_SATURATE) != 0u) {
+            result = clamp(result, 0.0, 1.0);
+        }
+        if (header.y != ZERO_REGISTER) {
+            regs[header.y] = floatBitsToUint(result);
+        }
+    }
+
+    // Viewport can be flipped, which is unsupported by glViewport
+    position.xy *= viewport_flip.xy;
+    gl_Position = position;
+
+    // Same as the specialized vertex programs, see GenerateVertexShader
+    position.w = 1.0;
+}
+)";
+    return out;
+}
+
+namespace {
+
+/// Source operand of an operation, as read by the uber shader
+struct Operand {
+    u32 descriptor{};
+    u32 value{};
+};
+
+/// Builds the operation table of a guest program
+class UberShaderTranslator {
+public:
+    /// Returns an operand that reads a register
+    static Operand Reg(u64 reg, bool negate = false, bool abs = false) {
+        return {OperandRegister | (negate ? OperandNegate : 0) | (abs ? OperandAbs : 0),
+                static_cast<u32>(reg)};
+    }
+
+    /// Returns an operand with an immediate value, as raw bits
+    static Operand Imm(u32 value, bool negate = false, bool abs = false) {
+        return {OperandImmediate | (negate ? OperandNegate : 0) | (abs ? OperandAbs : 0), value};
+    }
+
+    /// Returns an operand that reads a const buffer, assigning it a slot on first use
+    boost::optional<Operand> Cbuf(u64 index, u64 offset, bool negate = false) {
+        auto slot = slots[index];
+        if (!slot) {
+            if (entries.const_buffer_entries.size() == UberShaderOpenGL::NumConstBufferSlots) {
+                return boost::none;
+            }
+            slot = static_cast<u32>(entries.const_buffer_entries.size());
+            slots[index] = slot;
+            entries.const_buffer_entries.emplace_back();
+        }
+        entries.const_buffer_entries[*slot].MarkAsUsed(index, offset,
+                                                       Maxwell::ShaderStage::Vertex);
+        return Operand{OperandConstBuffer | (negate ? OperandNegate : 0),
+                       (*slot << 16) | static_cast<u32>(offset)};
+    }
+
+    void Emit(Operation operation, bool saturate, u32 destination, Operand a = {},
+              Operand b = {}, Operand c = {}) {
+        operations.insert(operations.end(),
+                          {static_cast<u32>(operation) | (saturate ? OperationSaturate : 0),
+                           destination, a.descriptor, a.value, b.descriptor, b.value,
+                           c.descriptor, c.value});
+    }
+
+    /// Translates an instruction, returns false if it can't be interpreted
+    bool Translate(Instruction instr) {
+        const auto opcode = OpCode::Decode(instr);
+        if (!opcode) {
+            return false;
+        }
+        if (OpCode::IsPredicatedInstruction(opcode->GetId()) &&
+            (instr.pred.pred_index != static_cast<u64>(Tegra::Shader::Pred::UnusedIndex) ||
+             instr.negate_pred != 0)) {
+            return false;
+        }
+
+        // Second operand of arithmetic instructions with a 19-bit immediate form
+        const auto OperandB = [&](bool negate, bool abs) -> boost::optional<Operand> {
+            if (instr.is_b_imm) {
+                return Imm(instr.alu.GetImm20_19(), negate, abs);
+            }
+            if (instr.is_b_gpr) {
+                return Reg(instr.gpr20.Value(), negate, abs);
+            }
+            if (abs) {
+                return boost::none;
+            }
+            return Cbuf(instr.cbuf34.index, instr.cbuf34.offset, negate);
+        };
+
+        const bool saturate = instr.alu.saturate_d != 0;
+        switch (opcode->GetId()) {
+        case OpCode::Id::EXIT:
+            if (instr.flow.cond != Tegra::Shader::FlowCondition::Always) {
+                return false;
+            }
+            Emit(Operation::Exit, false, 0);
+            has_exited = true;
+            return true;
+        case OpCode::Id::DEPBAR:
+            return true;
+        case OpCode::Id::MOV_C:
+        case OpCode::Id::MOV_R: {
+            const auto b = OperandB(false, false);
+            if (!b) {
+                return false;
+            }
+            Emit(Operation::Move, false, static_cast<u32>(instr.gpr0.Value()), *b);
+            return true;
+        }
+        case OpCode::Id::MOV32_IMM:
+            Emit(Operation::Move, false, static_cast<u32>(instr.gpr0.Value()),
+                 Imm(instr.alu.GetImm20_32()));
+            return true;
+        case OpCode::Id::FADD_C:
+        case OpCode::Id::FADD_R:
+        case OpCode::Id::FADD_IMM: {
+            const auto b = OperandB(instr.alu.negate_b != 0, instr.alu.abs_b != 0);
+            if (!b) {
+                return false;
+            }
+            Emit(Operation::Add, saturate, static_cast<u32>(instr.gpr0.Value()),
+                 Reg(instr.gpr8.Value(), instr.alu.negate_a != 0, instr.alu.abs_a != 0), *b);
+            return true;
+        }
+        case OpCode::Id::FADD32I:
+            Emit(Operation::Add, false, static_cast<u32>(instr.gpr0.Value()),
+                 Reg(instr.gpr8.Value(), instr.fadd32i.negate_a != 0, instr.fadd32i.abs_a != 0),
+                 Imm(instr.alu.GetImm20_32(), instr.fadd32i.negate_b != 0,
+                     instr.fadd32i.abs_b != 0));
+            return true;
+        case OpCode::Id::FMUL_C:
+        case OpCode::Id::FMUL_R:
+        case OpCode::Id::FMUL_IMM: {
+            if (instr.fmul.tab5cb8_2 != 0 || instr.fmul.tab5c68_1 != 0 ||
+                instr.fmul.tab5c68_0 != 1 || instr.fmul.cc != 0) {
+                return false;
+            }
+            const auto b = OperandB(instr.fmul.negate_b != 0, false);
+            if (!b) {
+                return false;
+            }
+            Emit(Operation::Multiply, saturate, static_cast<u32>(instr.gpr0.Value()),
+                 Reg(instr.gpr8.Value()), *b);
+            return true;
+        }
+        case OpCode::Id::FMUL32_IMM:
+            Emit(Operation::Multiply, false, static_cast<u32>(instr.gpr0.Value()),
+                 Reg(instr.gpr8.Value()), Imm(instr.alu.GetImm20_32()));
+            return true;
+        case OpCode::Id::FFMA_CR:
+        case OpCode::Id::FFMA_RC:
+        case OpCode::Id::FFMA_RR:
+        case OpCode::Id::FFMA_IMM:
+            return TranslateFfma(instr, opcode->GetId());
+        case OpCode::Id::MUFU:
+            return TranslateMufu(instr);
+        case OpCode::Id::LD_A:
+        case OpCode::Id::ST_A:
+            return TranslateAttribute(instr, opcode->GetId() == OpCode::Id::ST_A);
+        default:
+            return false;
+        }
+    }
+
+    bool HasExited() const {
+        return has_exited;
+    }
+
+    std::vector<u32> operations;
+    GLShader::ShaderEntries entries;
+
+private:
+    using Maxwell = Tegra::Engines::Maxwell3D::Regs;
+
+    bool TranslateFfma(Instruction instr, OpCode::Id id) {
+        if (instr.ffma.cc != 0 || instr.ffma.tab5980_0 != 1 || instr.ffma.tab5980_1 != 0) {
+            return false;
+        }
+
+        const bool negate_b = instr.ffma.negate_b != 0;
+        const bool negate_c = instr.ffma.negate_c != 0;
+        boost::optional<Operand> b;
+        boost::optional<Operand> c;
+        switch (id) {
+        case OpCode::Id::FFMA_CR:
+            b = Cbuf(instr.cbuf34.index, instr.cbuf34.offset, negate_b);
+            c = Reg(instr.gpr39.Value(), negate_c);
+            break;
+        case OpCode::Id::FFMA_RC:
+            b = Reg(instr.gpr39.Value(), negate_b);
+            c = Cbuf(instr.cbuf34.index, instr.cbuf34.offset, negate_c);
+            break;
+        case OpCode::Id::FFMA_RR:
+            b = Reg(instr.gpr20.Value(), negate_b);
+            c = Reg(instr.gpr39.Value(), negate_c);
+            break;
+        default:
+            b = Imm(instr.alu.GetImm20_19(), negate_b);
+            c = Reg(instr.gpr39.Value(), negate_c);
+            break;
+        }
+        if (!b || !c) {
+            return false;
+        }
+        Emit(Operation::FusedMultiplyAdd, instr.alu.saturate_d != 0,
+             static_cast<u32>(instr.gpr0.Value()), Reg(instr.gpr8.Value()), *b, *c);
+        return true;
+    }
+
+    bool TranslateMufu(Instruction instr) {
+        Operation operation;
+        switch (instr.sub_op) {
+        case SubOp::Cos:
+            operation = Operation::Cos;
+            break;
+        case SubOp::Sin:
+            operation = Operation::Sin;
+            break;
+        case SubOp::Ex2:
+            operation = Operation::Exp2;
+            break;
+        case SubOp::Lg2:
+            operation = Operation::Log2;
+            break;
+        case SubOp::Rcp:
+            operation = Operation::Reciprocal;
+            break;
+        case SubOp::Rsq:
+            operation = Operation::ReciprocalSqrt;
+            break;
+        case SubOp::Sqrt:
+            operation = Operation::Sqrt;
+            break;
+        default:
+            return false;
+        }
+        Emit(operation, instr.alu.saturate_d != 0, static_cast<u32>(instr.gpr0.Value()),
+             Reg(instr.gpr8.Value(), instr.alu.negate_a != 0, instr.alu.abs_a != 0));
+        return true;
+    }
+
+    bool TranslateAttribute(Instruction instr, bool is_store) {
+        if (instr.gpr8.Value() != Register::ZeroIndex ||
+            (instr.attribute.fmt20.immediate.Value() % sizeof(u32)) != 0) {
+            return false;
+        }
+
+        const auto IsValidAttribute = [is_store](u64 index) {
+            const u64 first_generic = static_cast<u64>(Attribute::Index::Attribute_0);
+            if (index == static_cast<u64>(Attribute::Index::Position)) {
+                return true;
+            }
+            if (!is_store &&
+                index == static_cast<u64>(Attribute::Index::TessCoordInstanceIDVertexID)) {
+                return true;
+            }
+            const u32 num_generics = is_store ? NumOutputAttributes : NumInputAttributes;
+            return index >= first_generic && index < first_generic + num_generics;
+        };
+
+        u64 element = instr.attribute.fmt20.element;
+        u64 index = static_cast<u64>(instr.attribute.fmt20.index.Value());
+        const u64 num_words = static_cast<u64>(instr.attribute.fmt20.size.Value()) + 1;
+        for (u64 word = 0; word < num_words; ++word) {
+            const u64 reg = instr.gpr0.Value() + word;
+            if (!IsValidAttribute(index) || reg >= Register::NumRegisters) {
+                return false;
+            }
+
+            const u32 attribute = static_cast<u32>((index << 2) | element);
+            if (is_store) {
+                Emit(Operation::StoreAttribute, false, attribute, Reg(reg));
+            } else {
+                Emit(Operation::LoadAttribute, false, static_cast<u32>(reg), Imm(attribute));
+            }
+
+            // Consecutive words continue on the next attribute, like in the decompiler
+            element = (element + 1) % 4;
+            index += element == 0 ? 1 : 0;
+        }
+        return true;
+    }
+
+    std::array<boost::optional<u32>, Maxwell::MaxConstBuffers> slots;
+    bool has_exited{};
+};
+
+} // Anonymous namespace
+
+UberShaderOpenGL::UberShaderOpenGL() {
+    GLint max_storage_blocks{};
+    GLint max_uniform_blocks{};
+    GLint max_output_components{};
+    glGetIntegerv(GL_MAX_VERTEX_SHADER_STORAGE_BLOCKS, &max_storage_blocks);
+    glGetIntegerv(GL_MAX_VERTEX_UNIFORM_BLOCKS, &max_uniform_blocks);
+    glGetIntegerv(GL_MAX_VERTEX_OUTPUT_COMPONENTS, &max_output_components);
+
+    // The stage configuration block is used along with the const buffer slots, and the position
+    // is written both to gl_Position and to a generic output
+    if (max_storage_blocks < 1 ||
+        max_uniform_blocks < static_cast<GLint>(NumConstBufferSlots + 1) ||
+        max_output_components < static_cast<GLint>((NumOutputAttributes + 2) * 4)) {
+        LOG_WARNING(Render_OpenGL, "Uber shader is not supported by the driver");
+        return;
+    }
+
+    const std::string source = GenerateUberShader();
+    program = std::make_shared<OGLProgram>();
+    program->CreateFromSource(source.c_str(), nullptr, nullptr, true);
+
+    for (std::size_t slot = 0; slot < NumConstBufferSlots; ++slot) {
+        const std::string name = "UberConstBuffer[" + std::to_string(slot) + ']';
+        block_indices[slot] =
+            glGetProgramResourceIndex(program->handle, GL_UNIFORM_BLOCK, name.c_str());
+    }
+}
+
+std::vector<GLuint> UberShaderOpenGL::GetConstBufferBlockIndices(std::size_t num_slots) const {
+    ASSERT(num_slots <= NumConstBufferSlots);
+    return {block_indices.begin(), block_indices.begin() + num_slots};
+}
+
+boost::optional<UberShaderProgram> UberShaderOpenGL::Translate(
+    const GLShader::ProgramCode& program_code) const {
+    constexpr std::size_t SchedPeriod = 4;
+
+    UberShaderTranslator translator;
+    for (std::size_t offset = GLShader::PROGRAM_OFFSET; offset < program_code.size(); ++offset) {
+        if ((offset - GLShader::PROGRAM_OFFSET) % SchedPeriod == 0) {
+            continue;
+        }
+        if (!translator.Translate(Instruction{program_code[offset]})) {
+            return boost::none;
+        }
+        if (translator.HasExited()) {
+            break;
+        }
+    }
+    if (!translator.HasExited()) {
+        return boost::none;
+    }
+
+    UberShaderProgram result;
+    result.operations = std::make_shared<OGLBuffer>();
+    glCreateBuffers(1, &result.operations->handle);
+    glNamedBufferStorage(result.operations->handle,
+                         static_cast<GLsizeiptr>(translator.operations.size() * sizeof(u32)),
+                         translator.operations.data(), 0);
+    result.entries = std::move(translator.entries);
+    return result;
+}
+
+} // namespace OpenGL
@@ -0,0 +1,66 @@
+// Copyright 2018 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <vector>
+#include <boost/optional.hpp>
+#include <glad/glad.h>
+
+#include "common/common_types.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+#include "video_core/renderer_opengl/gl_shader_gen.h"
+
+namespace OpenGL {
+
+/// A guest vertex program translated into the operation table of the uber shader
+struct UberShaderProgram {
+    /// Storage buffer with the operations of the program
+    std::shared_ptr<OGLBuffer> operations;
+    /// Const buffers read by the program, in the order of the slots they are bound to
+    GLShader::ShaderEntries entries;
+};
+
+/**
+ * Generic vertex program that interprets guest vertex programs, so that draws can be rendered
+ * while the specialized program of their shader is being built. Guest programs are translated on
+ * the CPU into a table of simple operations, which the uber shader reads from a storage buffer.
+ * Only straight-line programs made of common arithmetic and attribute instructions can be
+ * translated, others have to wait for their specialized program.
+ */
+class UberShaderOpenGL {
+public:
+    /// Storage buffer binding point of the operation table of the program being drawn
+    static constexpr GLuint OperationsBinding = 2;
+
+    /// Number of distinct const buffers that a translated program can read
+    static constexpr std::size_t NumConstBufferSlots = 8;
+
+    /// Builds the uber shader program, if the driver supports it
+    UberShaderOpenGL();
+
+    /// Returns whether the uber shader can be used with the driver in use
+    bool IsSupported() const {
+        return program != nullptr;
+    }
+
+    /// Gets the GL program of the uber shader
+    const std::shared_ptr<OGLProgram>& GetProgram() const {
+        return program;
+    }
+
+    /// Gets the uniform block indices of the const buffer slots, in slot order
+    std::vector<GLuint> GetConstBufferBlockIndices(std::size_t num_slots) const;
+
+    /// Translates a guest vertex program, returns boost::none if it can't be interpreted
+    boost::optional<UberShaderProgram> Translate(const GLShader::ProgramCode& program_code) const;
+
+private:
+    std::shared_ptr<OGLProgram> program;
+    std::array<GLuint, NumConstBufferSlots> block_indices{};
+};
+
+} // namespace OpenGL
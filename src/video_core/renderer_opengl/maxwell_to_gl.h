@@ -117,6 +117,12 @@ inline GLenum PrimitiveTopology(Maxwell::PrimitiveTopology topology) {
         return GL_TRIANGLES;
     case Maxwell::PrimitiveTopology::TriangleStrip:
         return GL_TRIANGLE_STRIP;
+    case Maxwell::PrimitiveTopology::Quads:
+        // Drawn as triangles with the indices generated by IndexConverterOpenGL
+        return GL_TRIANGLES;
+    case Maxwell::PrimitiveTopology::QuadStrip:
+        // A triangle strip with the same vertices covers the same quads
+        return GL_TRIANGLE_STRIP;
     }
     LOG_CRITICAL(Render_OpenGL, "Unimplemented topology={}", static_cast<u32>(topology));
     UNREACHABLE();
@@ -7,6 +7,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <memory>
+#include <tuple>
 #include <glad/glad.h>
 #include "common/assert.h"
 #include "common/logging/log.h"
@@ -18,7 +19,7 @@
 #include "core/perf_stats.h"
 #include "core/settings.h"
 #include "core/telemetry_session.h"
-#include "core/tracer/recorder.h"
+#include "video_core/engines/maxwell_3d.h"
 #include "video_core/renderer_opengl/gl_rasterizer.h"
 #include "video_core/renderer_opengl/renderer_opengl.h"
 #include "video_core/utils.h"
@@ -99,18 +100,19 @@ static std::array<GLfloat, 3 * 2> MakeOrthographicMatrix(const float width, cons
 
 ScopeAcquireGLContext::ScopeAcquireGLContext(Core::Frontend::EmuWindow& emu_window_)
     : emu_window{emu_window_} {
-    if (Settings::values.use_multi_core) {
+    // The GPU thread keeps the context current for the whole emulation session
+    if (Settings::values.use_multi_core && !Settings::values.use_asynchronous_gpu_emulation) {
         emu_window.MakeCurrent();
     }
 }
 ScopeAcquireGLContext::~ScopeAcquireGLContext() {
-    if (Settings::values.use_multi_core) {
+    if (Settings::values.use_multi_core && !Settings::values.use_asynchronous_gpu_emulation) {
         emu_window.DoneCurrent();
     }
 }
 
-RendererOpenGL::RendererOpenGL(Core::Frontend::EmuWindow& window)
-    : VideoCore::RendererBase{window} {}
+RendererOpenGL::RendererOpenGL(Core::Frontend::EmuWindow& window, Core::System& system)
+    : VideoCore::RendererBase{window, system} {}
 
 RendererOpenGL::~RendererOpenGL() = default;
 
@@ -118,11 +120,12 @@ RendererOpenGL::~RendererOpenGL() = default;
 void RendererOpenGL::SwapBuffers(boost::optional<const Tegra::FramebufferConfig&> framebuffer) {
     ScopeAcquireGLContext acquire_context{render_window};
 
-    Core::System::GetInstance().GetPerfStats().EndSystemFrame();
+    system.GetPerfStats().EndSystemFrame();
 
     // Maintain the rasterizer's state as a priority
     OpenGLState prev_state = OpenGLState::GetCurState();
     state.Apply();
+    rasterizer->NotifyPresent();
 
     if (framebuffer != boost::none) {
         // If framebuffer is provided, reload it from memory to a texture
@@ -136,6 +139,8 @@ void RendererOpenGL::SwapBuffers(boost::optional<const Tegra::FramebufferConfig&
         }
 
         // Load the framebuffer from memory, draw it to the screen, and swap buffers
+        const Core::ScopedStageTimer stage_timer{system.GetPerfStats(),
+                                                 Core::PerfStage::Present};
         LoadFBToScreenInfo(*framebuffer);
         DrawScreen();
         render_window.SwapBuffers();
@@ -143,8 +148,18 @@ void RendererOpenGL::SwapBuffers(boost::optional<const Tegra::FramebufferConfig&
 
     render_window.PollEvents();
 
-    Core::System::GetInstance().FrameLimiter().DoFrameLimiting(CoreTiming::GetGlobalTimeUs());
-    Core::System::GetInstance().GetPerfStats().BeginSystemFrame();
+    rasterizer->TickFrame();
+
+    // Macro parameters are expected to fit in their inline storage, report when they don't
+    const u32 macro_parameter_allocations{
+        system.GPU().Maxwell3D().GetAndResetMacroParameterAllocations()};
+    if (macro_parameter_allocations > 0) {
+        LOG_DEBUG(Render_OpenGL, "Macro parameters were allocated {} times during the frame",
+                  macro_parameter_allocations);
+    }
+
+    system.FrameLimiter().DoFrameLimiting(CoreTiming::GetGlobalTimeUs());
+    system.GetPerfStats().BeginSystemFrame();
 
     // Restore the rasterizer state
     prev_state.Apply();
@@ -166,37 +181,56 @@ void RendererOpenGL::LoadFBToScreenInfo(const Tegra::FramebufferConfig& framebuf
     // only allows rows to have a memory alignement of 4.
     ASSERT(framebuffer.stride % 4 == 0);
 
-    if (!rasterizer->AccelerateDisplay(framebuffer, framebuffer_addr, framebuffer.stride)) {
-        // Reset the screen info's display texture to its own permanent texture
-        screen_info.display_texture = screen_info.texture.resource.handle;
+    if (rasterizer->AccelerateDisplay(framebuffer, framebuffer_addr, framebuffer.stride)) {
+        // The framebuffer was rendered by the GPU, its cached surface is sampled directly
+        return;
+    }
+
+    // Reset the screen info's display texture to its own permanent texture
+    screen_info.display_texture = screen_info.texture.resource.handle;
+
+    Memory::RasterizerFlushVirtualRegion(framebuffer_addr, size_in_bytes,
+                                         Memory::FlushMode::Flush);
 
-        Memory::RasterizerFlushVirtualRegion(framebuffer_addr, size_in_bytes,
-                                             Memory::FlushMode::Flush);
+    // Room for a few frames, so that a frame is unswizzled while the previous ones are still being
+    // uploaded by the driver
+    constexpr u64 num_upload_frames = 3;
+    if (!framebuffer_upload_buffer ||
+        framebuffer_upload_buffer->GetSize() < static_cast<GLsizeiptr>(size_in_bytes)) {
+        framebuffer_upload_buffer = std::make_unique<OGLStreamBuffer>(
+            GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(size_in_bytes * num_upload_frames));
+    }
 
-        VideoCore::MortonCopyPixels128(framebuffer.width, framebuffer.height, bytes_per_pixel, 4,
-                                       Memory::GetPointer(framebuffer_addr),
-                                       gl_framebuffer_data.data(), true);
+    // Unswizzle straight into the mapped buffer, the rows keep the stride of the framebuffer
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, framebuffer_upload_buffer->GetHandle());
+    u8* pointer{};
+    GLintptr offset{};
+    std::tie(pointer, offset, std::ignore) =
+        framebuffer_upload_buffer->Map(static_cast<GLsizeiptr>(size_in_bytes), 4);
+    VideoCore::MortonCopyPixels128(framebuffer.stride, framebuffer.height, bytes_per_pixel, 4,
+                                   Memory::GetPointer(framebuffer_addr), pointer, true);
+    framebuffer_upload_buffer->Unmap(static_cast<GLsizeiptr>(size_in_bytes));
 
-        state.texture_units[0].texture = screen_info.texture.resource.handle;
-        state.Apply();
+    state.texture_units[0].texture = screen_info.texture.resource.handle;
+    state.Apply();
 
-        glActiveTexture(GL_TEXTURE0);
-        glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(framebuffer.stride));
+    glActiveTexture(GL_TEXTURE0);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(framebuffer.stride));
 
-        // Update existing texture
-        // TODO: Test what happens on hardware when you change the framebuffer dimensions so that
-        //       they differ from the LCD resolution.
-        // TODO: Applications could theoretically crash yuzu here by specifying too large
-        //       framebuffer sizes. We should make sure that this cannot happen.
-        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, framebuffer.width, framebuffer.height,
-                        screen_info.texture.gl_format, screen_info.texture.gl_type,
-                        gl_framebuffer_data.data());
+    // Update existing texture
+    // TODO: Test what happens on hardware when you change the framebuffer dimensions so that
+    //       they differ from the LCD resolution.
+    // TODO: Applications could theoretically crash yuzu here by specifying too large
+    //       framebuffer sizes. We should make sure that this cannot happen.
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, framebuffer.width, framebuffer.height,
+                    screen_info.texture.gl_format, screen_info.texture.gl_type,
+                    reinterpret_cast<const void*>(offset));
 
-        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 
-        state.texture_units[0].texture = 0;
-        state.Apply();
-    }
+    state.texture_units[0].texture = 0;
+    state.Apply();
 }
 
 /**
@@ -255,7 +289,7 @@ void RendererOpenGL::InitOpenGLObjects() {
     glEnableVertexAttribArray(attrib_tex_coord);
 
     // Allocate textures for the screen
-    screen_info.texture.resource.Create();
+    screen_info.texture.resource.Create(GL_TEXTURE_2D);
 
     // Allocation of storage is deferred until the first frame, when we
     // know the framebuffer size.
@@ -284,7 +318,7 @@ void RendererOpenGL::CreateRasterizer() {
         return;
     }
 
-    rasterizer = std::make_unique<RasterizerOpenGL>(render_window, screen_info);
+    rasterizer = std::make_unique<RasterizerOpenGL>(render_window, system, screen_info);
 }
 
 void RendererOpenGL::ConfigureFramebufferTexture(TextureInfo& texture,
@@ -299,7 +333,6 @@ void RendererOpenGL::ConfigureFramebufferTexture(TextureInfo& texture,
         internal_format = GL_RGBA;
         texture.gl_format = GL_RGBA;
         texture.gl_type = GL_UNSIGNED_INT_8_8_8_8_REV;
-        gl_framebuffer_data.resize(texture.width * texture.height * 4);
         break;
     default:
         UNREACHABLE();
@@ -4,13 +4,14 @@
 
 #pragma once
 
-#include <vector>
+#include <memory>
 #include <glad/glad.h>
 #include "common/common_types.h"
 #include "common/math_util.h"
 #include "video_core/renderer_base.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
 #include "video_core/renderer_opengl/gl_state.h"
+#include "video_core/renderer_opengl/gl_stream_buffer.h"
 
 namespace Core::Frontend {
 class EmuWindow;
@@ -47,7 +48,7 @@ private:
 
 class RendererOpenGL : public VideoCore::RendererBase {
 public:
-    explicit RendererOpenGL(Core::Frontend::EmuWindow& window);
+    explicit RendererOpenGL(Core::Frontend::EmuWindow& window, Core::System& system);
     ~RendererOpenGL() override;
 
     /// Swap buffers (render frame)
@@ -85,8 +86,8 @@ private:
     /// Display information for Switch screen
     ScreenInfo screen_info;
 
-    /// OpenGL framebuffer data
-    std::vector<u8> gl_framebuffer_data;
+    /// Persistently mapped buffer the framebuffers read from guest memory are unswizzled into
+    std::unique_ptr<OGLStreamBuffer> framebuffer_upload_buffer;
 
     // Shader uniform location indices
     GLuint uniform_modelview_matrix;
@@ -21,6 +21,7 @@
 #include <cstring>
 #include <vector>
 
+#include "common/thread_pool.h"
 #include "video_core/textures/astc.h"
 
 class BitStream {
@@ -1597,14 +1598,17 @@ static void DecompressBlock(uint8_t inBuf[16], const uint32_t blockWidth,
 
 namespace Tegra::Texture::ASTC {
 
-std::vector<uint8_t> Decompress(std::vector<uint8_t>& data, uint32_t width, uint32_t height,
-                                uint32_t block_width, uint32_t block_height) {
-    uint32_t blockIdx = 0;
-    std::vector<uint8_t> outData(height * width * 4);
-    for (uint32_t j = 0; j < height; j += block_height) {
+/// Decodes the blocks in the given range of block rows into the output image
+static void DecompressBlockRows(uint8_t* data, uint8_t* out_data, uint32_t width, uint32_t height,
+                                uint32_t block_width, uint32_t block_height,
+                                uint32_t first_block_row, uint32_t last_block_row) {
+    const uint32_t blocks_per_row = (width + block_width - 1) / block_width;
+    for (uint32_t block_row = first_block_row; block_row < last_block_row; ++block_row) {
+        const uint32_t j = block_row * block_height;
+        uint32_t blockIdx = block_row * blocks_per_row;
         for (uint32_t i = 0; i < width; i += block_width) {
 
-            uint8_t* blockPtr = data.data() + blockIdx * 16;
+            uint8_t* blockPtr = data + blockIdx * 16;
 
             // Blocks can be at most 12x12
             uint32_t uncompData[144];
@@ -1613,7 +1617,7 @@ std::vector<uint8_t> Decompress(std::vector<uint8_t>& data, uint32_t width, uint
             uint32_t decompWidth = std::min(block_width, width - i);
             uint32_t decompHeight = std::min(block_height, height - j);
 
-            uint8_t* outRow = outData.data() + (j * width + i) * 4;
+            uint8_t* outRow = out_data + (j * width + i) * 4;
             for (uint32_t jj = 0; jj < decompHeight; jj++) {
                 memcpy(outRow + jj * width * 4, uncompData + jj * block_width, decompWidth * 4);
             }
@@ -1621,6 +1625,33 @@ std::vector<uint8_t> Decompress(std::vector<uint8_t>& data, uint32_t width, uint
             blockIdx++;
         }
     }
+}
+
+std::vector<uint8_t> Decompress(std::vector<uint8_t>& data, uint32_t width, uint32_t height,
+                                uint32_t block_width, uint32_t block_height) {
+    // Each thread gets at least this many blocks, as handing out less work would take longer than
+    // decoding it
+    constexpr uint32_t MinBlocksPerThread = 4096;
+
+    std::vector<uint8_t> outData(height * width * 4);
+    const uint32_t blocks_per_row = (width + block_width - 1) / block_width;
+    const uint32_t block_rows = (height + block_height - 1) / block_height;
+    const uint32_t min_rows = std::max(MinBlocksPerThread / std::max(blocks_per_row, 1U), 1U);
+
+    // Block rows are decoded in parallel on the shared pool, small textures on this thread only
+    if (block_rows <= min_rows) {
+        DecompressBlockRows(data.data(), outData.data(), width, height, block_width, block_height,
+                            0, block_rows);
+        return outData;
+    }
+    Common::ThreadPool::GetInstance().ParallelFor(
+        0, block_rows,
+        [&](std::size_t row) {
+            const auto block_row = static_cast<uint32_t>(row);
+            DecompressBlockRows(data.data(), outData.data(), width, height, block_width,
+                                block_height, block_row, block_row + 1);
+        },
+        min_rows);
 
     return outData;
 }
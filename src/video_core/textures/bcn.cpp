@@ -0,0 +1,692 @@
+// Copyright 2018 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include "common/assert.h"
+#include "common/thread_pool.h"
+#include "video_core/textures/bcn.h"
+
+namespace Tegra::Texture::BCn {
+
+namespace {
+
+constexpr u32 BlockDimension = 4;
+constexpr std::size_t TexelsPerBlock = BlockDimension * BlockDimension;
+constexpr std::size_t MaxTexelSize = 8;
+
+/// Decodes a block into its 16 texels, in row-major order
+using BlockDecoder = void (*)(const u8* block, u8* texels);
+
+/// Reads the fields of a 128-bit block, from the least significant bit up
+class BitReader {
+public:
+    explicit BitReader(const u8* block) {
+        std::memcpy(&low, block, sizeof(low));
+        std::memcpy(&high, block + sizeof(low), sizeof(high));
+    }
+
+    u32 Read(u32 count) {
+        if (count == 0) {
+            return 0;
+        }
+        u64 bits;
+        if (position >= 64) {
+            bits = high >> (position - 64);
+        } else if (position + count <= 64) {
+            bits = low >> position;
+        } else {
+            bits = (low >> position) | (high << (64 - position));
+        }
+        position += count;
+        return static_cast<u32>(bits & ((u64{1} << count) - 1));
+    }
+
+private:
+    u64 low{};
+    u64 high{};
+    u32 position{};
+};
+
+template <typename T>
+T Load(const u8* data) {
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+void StoreRGBA8(u8* texel, u32 r, u32 g, u32 b, u32 a) {
+    texel[0] = static_cast<u8>(r);
+    texel[1] = static_cast<u8>(g);
+    texel[2] = static_cast<u8>(b);
+    texel[3] = static_cast<u8>(a);
+}
+
+/// Divides, rounding to the nearest integer away from zero
+constexpr s32 DivideRounded(s32 value, s32 divisor) {
+    return (value + (value >= 0 ? divisor / 2 : -divisor / 2)) / divisor;
+}
+
+/**
+ * Decodes the color block of BC1, BC2 and BC3. Only BC1 blocks switch to three colors and a
+ * transparent black when their first endpoint isn't the larger one.
+ */
+void DecodeColorBlock(const u8* block, bool has_punchthrough, u8* texels) {
+    const u16 color0{Load<u16>(block)};
+    const u16 color1{Load<u16>(block + 2)};
+    const u32 indices{Load<u32>(block + 4)};
+
+    const auto expand = [](u16 color) -> std::array<u32, 4> {
+        const u32 r{static_cast<u32>(color >> 11)};
+        const u32 g{static_cast<u32>((color >> 5) & 0x3F)};
+        const u32 b{static_cast<u32>(color & 0x1F)};
+        return {(r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2), 0xFF};
+    };
+
+    std::array<std::array<u32, 4>, 4> palette{expand(color0), expand(color1)};
+    if (color0 > color1 || !has_punchthrough) {
+        for (std::size_t c = 0; c < 3; ++c) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+        }
+        palette[2][3] = palette[3][3] = 0xFF;
+    } else {
+        for (std::size_t c = 0; c < 3; ++c) {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+        }
+        palette[2][3] = 0xFF;
+        palette[3] = {};
+    }
+
+    for (std::size_t i = 0; i < TexelsPerBlock; ++i) {
+        const auto& color{palette[(indices >> (2 * i)) & 3]};
+        StoreRGBA8(texels + i * 4, color[0], color[1], color[2], color[3]);
+    }
+}
+
+/// Decodes the blocks of a single component, used for BC3 alpha, BC4 and BC5
+template <bool is_signed>
+std::array<u8, TexelsPerBlock> DecodeComponentBlock(const u8* block) {
+    constexpr s32 min{is_signed ? -127 : 0};
+    constexpr s32 max{is_signed ? 127 : 255};
+
+    // Signed blocks map both -128 and -127 to -1.0
+    s32 value0{block[0]};
+    s32 value1{block[1]};
+    if constexpr (is_signed) {
+        value0 = std::max<s32>(static_cast<s8>(block[0]), min);
+        value1 = std::max<s32>(static_cast<s8>(block[1]), min);
+    }
+
+    std::array<s32, 8> palette{value0, value1};
+    if (value0 > value1) {
+        for (s32 i = 1; i < 7; ++i) {
+            palette[i + 1] = DivideRounded((7 - i) * value0 + i * value1, 7);
+        }
+    } else {
+        for (s32 i = 1; i < 5; ++i) {
+            palette[i + 1] = DivideRounded((5 - i) * value0 + i * value1, 5);
+        }
+        palette[6] = min;
+        palette[7] = max;
+    }
+
+    const u64 indices{Load<u64>(block) >> 16};
+    std::array<u8, TexelsPerBlock> values;
+    for (std::size_t i = 0; i < TexelsPerBlock; ++i) {
+        values[i] = static_cast<u8>(palette[(indices >> (3 * i)) & 7]);
+    }
+    return values;
+}
+
+void DecodeBC1(const u8* block, u8* texels) {
+    DecodeColorBlock(block, true, texels);
+}
+
+void DecodeBC2(const u8* block, u8* texels) {
+    DecodeColorBlock(block + 8, false, texels);
+    const u64 alphas{Load<u64>(block)};
+    for (std::size_t i = 0; i < TexelsPerBlock; ++i) {
+        texels[i * 4 + 3] = static_cast<u8>(((alphas >> (4 * i)) & 0xF) * 0x11);
+    }
+}
+
+void DecodeBC3(const u8* block, u8* texels) {
+    DecodeColorBlock(block + 8, false, texels);
+    const auto alphas{DecodeComponentBlock<false>(block)};
+    for (std::size_t i = 0; i < TexelsPerBlock; ++i) {
+        texels[i * 4 + 3] = alphas[i];
+    }
+}
+
+void DecodeBC4(const u8* block, u8* texels) {
+    const auto reds{DecodeComponentBlock<false>(block)};
+    for (std::size_t i = 0; i < TexelsPerBlock; ++i) {
+        StoreRGBA8(texels + i * 4, reds[i], 0, 0, 0xFF);
+    }
+}
+
+template <bool is_signed>
+void DecodeBC5(const u8* block, u8* texels) {
+    const auto reds{DecodeComponentBlock<is_signed>(block)};
+    const auto greens{DecodeComponentBlock<is_signed>(block + 8)};
+    for (std::size_t i = 0; i < TexelsPerBlock; ++i) {
+        StoreRGBA8(texels + i * 4, reds[i], greens[i], 0, is_signed ? 0x7F : 0xFF);
+    }
+}
+
+// Partitions of the blocks with two subsets, a set bit places its texel in the second subset
+constexpr std::array<u16, 64> Partitions2{{
+    0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80, 0xC800, 0xFFEC, 0xFE80,
+    0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000, 0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310,
+    0x3100, 0x8CCE, 0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C, 0xAAAA,
+    0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A, 0x73CE, 0x13C8, 0x324C, 0x3BDC,
+    0x6996, 0xC33C, 0x9966, 0x0660, 0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6,
+    0x639C, 0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22,
+}};
+
+// Partitions of the blocks with three subsets, with two bits holding the subset of each texel
+constexpr std::array<u32, 64> Partitions3{{
+    0xAA685050, 0x6A5A5040, 0x5A5A4200, 0x5450A0A8, 0xA5A50000, 0xA0A05050, 0x5555A0A0,
+    0x5A5A5050, 0xAA550000, 0xAA555500, 0xAAAA5500, 0x90909090, 0x94949494, 0xA4A4A4A4,
+    0xA9A59450, 0x2A0A4250, 0xA5945040, 0x0A425054, 0xA5A5A500, 0x55A0A0A0, 0xA8A85454,
+    0x6A6A4040, 0xA4A45000, 0x1A1A0500, 0x0050A4A4, 0xAAA59090, 0x14696914, 0x69691400,
+    0xA08585A0, 0xAA821414, 0x50A4A450, 0x6A5A0200, 0xA9A58000, 0x5090A0A8, 0xA8A09050,
+    0x24242424, 0x00AA5500, 0x24924924, 0x24499224, 0x50A50A50, 0x500AA550, 0xAAAA4444,
+    0x66660000, 0xA5A0A5A0, 0x50A050A0, 0x69286928, 0x44AAAA44, 0x66666600, 0xAA444444,
+    0x54A854A8, 0x95809580, 0x96969600, 0xA85454A8, 0x80959580, 0xAA141414, 0x96960000,
+    0xAAAA1414, 0xA05050A0, 0xA0A5A5A0, 0x96000000, 0x40804080, 0xA9A8A9A8, 0xAAAAAA44,
+    0x2A4A5254,
+}};
+
+// Texels whose index has one bit less, for the second subset of the two subset partitions
+constexpr std::array<u8, 64> Anchors2{{
+    15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 2,  8,  2,  2,  8,
+    8,  15, 2,  8,  2,  2,  8,  8,  2,  2,  15, 15, 6,  8,  2,  8,  15, 15, 2,  8,  2,  2,
+    2,  15, 15, 6,  6,  2,  6,  8,  15, 15, 2,  2,  15, 15, 15, 15, 15, 2,  2,  15,
+}};
+
+// Same for the second and third subsets of the three subset partitions
+constexpr std::array<u8, 64> Anchors3Second{{
+    3,  3,  15, 15, 8,  3,  15, 15, 8,  8,  6,  6,  6,  5,  3,  3,  3,  3,  8,  15, 3,  3,
+    6,  10, 5,  8,  8,  6,  8,  5,  15, 15, 8,  15, 3,  5,  6,  10, 8,  15, 15, 3,  15, 5,
+    15, 15, 15, 15, 3,  15, 5,  5,  5,  8,  5,  10, 5,  10, 8,  13, 15, 12, 3,  3,
+}};
+constexpr std::array<u8, 64> Anchors3Third{{
+    15, 8,  8,  3,  15, 15, 3,  8,  15, 15, 15, 15, 15, 15, 15, 8,  15, 8,  15, 3,  15, 8,
+    15, 8,  3,  15, 6,  10, 15, 15, 10, 8,  15, 3,  15, 10, 10, 8,  9,  10, 6,  15, 8,  15,
+    3,  6,  6,  8,  15, 3,  15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 3,  15, 15, 8,
+}};
+
+constexpr std::array<u32, 4> Weights2{0, 21, 43, 64};
+constexpr std::array<u32, 8> Weights3{0, 9, 18, 27, 37, 46, 55, 64};
+constexpr std::array<u32, 16> Weights4{0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+constexpr u32 GetWeight(u32 index_bits, u32 index) {
+    switch (index_bits) {
+    case 2:
+        return Weights2[index];
+    case 3:
+        return Weights3[index];
+    default:
+        return Weights4[index];
+    }
+}
+
+template <typename T>
+constexpr T Interpolate(T value0, T value1, u32 weight) {
+    return static_cast<T>(((64 - static_cast<T>(weight)) * value0 +
+                           static_cast<T>(weight) * value1 + 32) >>
+                          6);
+}
+
+/// Returns the subset of a texel in a partition of a block with the given number of subsets
+u32 GetSubset(u32 num_subsets, u32 partition, std::size_t texel) {
+    switch (num_subsets) {
+    case 2:
+        return (Partitions2[partition] >> texel) & 1;
+    case 3:
+        return (Partitions3[partition] >> (2 * texel)) & 3;
+    default:
+        return 0;
+    }
+}
+
+/// Returns whether a texel is the anchor of its subset, whose index has its top bit implied
+bool IsAnchor(u32 num_subsets, u32 partition, std::size_t texel) {
+    if (texel == 0) {
+        return true;
+    }
+    switch (num_subsets) {
+    case 2:
+        return texel == Anchors2[partition];
+    case 3:
+        return texel == Anchors3Second[partition] || texel == Anchors3Third[partition];
+    default:
+        return false;
+    }
+}
+
+struct BC7Mode {
+    u32 num_subsets;
+    u32 partition_bits;
+    u32 rotation_bits;
+    u32 index_selection_bits;
+    u32 color_bits;
+    u32 alpha_bits;
+    u32 endpoint_pbits;
+    u32 shared_pbits;
+    u32 index_bits;
+    u32 secondary_index_bits;
+};
+
+constexpr std::array<BC7Mode, 8> BC7Modes{{
+    {3, 4, 0, 0, 4, 0, 1, 0, 3, 0},
+    {2, 6, 0, 0, 6, 0, 0, 1, 3, 0},
+    {3, 6, 0, 0, 5, 0, 0, 0, 2, 0},
+    {2, 6, 0, 0, 7, 0, 1, 0, 2, 0},
+    {1, 0, 2, 1, 5, 6, 0, 0, 2, 3},
+    {1, 0, 2, 0, 7, 8, 0, 0, 2, 2},
+    {1, 0, 0, 0, 7, 7, 1, 0, 4, 0},
+    {2, 6, 0, 0, 5, 5, 1, 0, 2, 0},
+}};
+
+void DecodeBC7(const u8* block, u8* texels) {
+    // The mode is given by the position of the lowest set bit, blocks without one are reserved
+    u32 mode{};
+    while (mode < 8 && (block[0] & (1U << mode)) == 0) {
+        ++mode;
+    }
+    if (mode == 8) {
+        std::memset(texels, 0, TexelsPerBlock * 4);
+        return;
+    }
+    const BC7Mode& info{BC7Modes[mode]};
+
+    BitReader reader{block};
+    reader.Read(mode + 1);
+    const u32 partition{reader.Read(info.partition_bits)};
+    const u32 rotation{reader.Read(info.rotation_bits)};
+    const u32 index_selection{reader.Read(info.index_selection_bits)};
+
+    // Endpoints are stored channel by channel, then get their p-bits as their lowest bit
+    const u32 num_endpoints{info.num_subsets * 2};
+    const u32 num_channels{info.alpha_bits != 0 ? 4U : 3U};
+    std::array<std::array<u32, 4>, 6> endpoints{};
+    for (u32 channel = 0; channel < num_channels; ++channel) {
+        const u32 bits{channel < 3 ? info.color_bits : info.alpha_bits};
+        for (u32 endpoint = 0; endpoint < num_endpoints; ++endpoint) {
+            endpoints[endpoint][channel] = reader.Read(bits);
+        }
+    }
+
+    u32 color_bits{info.color_bits};
+    u32 alpha_bits{info.alpha_bits};
+    if (info.endpoint_pbits != 0 || info.shared_pbits != 0) {
+        std::array<u32, 6> pbits{};
+        for (u32 endpoint = 0; endpoint < num_endpoints; ++endpoint) {
+            if (info.endpoint_pbits != 0) {
+                pbits[endpoint] = reader.Read(1);
+            } else if (endpoint % 2 == 0) {
+                pbits[endpoint] = pbits[endpoint + 1] = reader.Read(1);
+            }
+        }
+        for (u32 endpoint = 0; endpoint < num_endpoints; ++endpoint) {
+            for (u32 channel = 0; channel < num_channels; ++channel) {
+                endpoints[endpoint][channel] = endpoints[endpoint][channel] << 1 | pbits[endpoint];
+            }
+        }
+        ++color_bits;
+        alpha_bits += alpha_bits != 0 ? 1 : 0;
+    }
+
+    // Endpoints are expanded to 8 bits by replicating their top bits
+    const auto expand = [](u32 value, u32 bits) {
+        value <<= 8 - bits;
+        return value | (value >> bits);
+    };
+    for (u32 endpoint = 0; endpoint < num_endpoints; ++endpoint) {
+        for (u32 channel = 0; channel < 3; ++channel) {
+            endpoints[endpoint][channel] = expand(endpoints[endpoint][channel], color_bits);
+        }
+        endpoints[endpoint][3] =
+            alpha_bits != 0 ? expand(endpoints[endpoint][3], alpha_bits) : 0xFF;
+    }
+
+    std::array<u32, TexelsPerBlock> indices;
+    for (std::size_t texel = 0; texel < TexelsPerBlock; ++texel) {
+        const bool is_anchor{IsAnchor(info.num_subsets, partition, texel)};
+        indices[texel] = reader.Read(info.index_bits - (is_anchor ? 1 : 0));
+    }
+    std::array<u32, TexelsPerBlock> secondary_indices{};
+    if (info.secondary_index_bits != 0) {
+        for (std::size_t texel = 0; texel < TexelsPerBlock; ++texel) {
+            const u32 bits{info.secondary_index_bits - (texel == 0 ? 1 : 0)};
+            secondary_indices[texel] = reader.Read(bits);
+        }
+    }
+
+    for (std::size_t texel = 0; texel < TexelsPerBlock; ++texel) {
+        const u32 subset{GetSubset(info.num_subsets, partition, texel)};
+        const auto& endpoint0{endpoints[subset * 2]};
+        const auto& endpoint1{endpoints[subset * 2 + 1]};
+
+        // Modes with two sets of indices use one set for the color and the other for alpha
+        u32 color_weight{GetWeight(info.index_bits, indices[texel])};
+        u32 alpha_weight{color_weight};
+        if (info.secondary_index_bits != 0) {
+            const u32 secondary_weight{
+                GetWeight(info.secondary_index_bits, secondary_indices[texel])};
+            if (index_selection != 0) {
+                alpha_weight = color_weight;
+                color_weight = secondary_weight;
+            } else {
+                alpha_weight = secondary_weight;
+            }
+        }
+
+        std::array<u32, 4> color;
+        for (u32 channel = 0; channel < 4; ++channel) {
+            color[channel] = Interpolate(endpoint0[channel], endpoint1[channel],
+                                         channel < 3 ? color_weight : alpha_weight);
+        }
+        if (rotation != 0) {
+            std::swap(color[3], color[rotation - 1]);
+        }
+        StoreRGBA8(texels + texel * 4, color[0], color[1], color[2], color[3]);
+    }
+}
+
+/// Endpoint fields of BC6H blocks, W is the base endpoint that X, Y and Z can be deltas to
+enum BC6HField : u8 { RW, GW, BW, RX, GX, BX, RY, GY, BY, RZ, GZ, BZ, D };
+
+/// Bits of a field stored next in a BC6H block, from the given bit of the field up
+struct BC6HFieldBits {
+    BC6HField field;
+    u8 shift;
+    u8 count;
+};
+
+struct BC6HMode {
+    u32 value;
+    u32 num_subsets;
+    bool is_transformed;
+    u32 endpoint_bits;
+    std::array<u32, 3> delta_bits;
+    /// Fields in the order they are stored after the mode, unused entries are empty
+    std::array<BC6HFieldBits, 24> layout;
+};
+
+constexpr std::array<BC6HMode, 14> BC6HModes{{
+    {0x00, 2, true, 10, {5, 5, 5}, {{{GY, 4, 1}, {BY, 4, 1}, {BZ, 4, 1}, {RW, 0, 10}, {GW, 0, 10},
+                                     {BW, 0, 10}, {RX, 0, 5}, {GZ, 4, 1}, {GY, 0, 4}, {GX, 0, 5},
+                                     {BZ, 0, 1}, {GZ, 0, 4}, {BX, 0, 5}, {BZ, 1, 1}, {BY, 0, 4},
+                                     {RY, 0, 5}, {BZ, 2, 1}, {RZ, 0, 5}, {BZ, 3, 1}, {D, 0, 5}}}},
+    {0x01, 2, true, 7, {6, 6, 6}, {{{GY, 5, 1}, {GZ, 4, 1}, {GZ, 5, 1}, {RW, 0, 7}, {BZ, 0, 1},
+                                    {BZ, 1, 1}, {BY, 4, 1}, {GW, 0, 7}, {BY, 5, 1}, {BZ, 2, 1},
+                                    {GY, 4, 1}, {BW, 0, 7}, {BZ, 3, 1}, {BZ, 5, 1}, {BZ, 4, 1},
+                                    {RX, 0, 6}, {GY, 0, 4}, {GX, 0, 6}, {GZ, 0, 4}, {BX, 0, 6},
+                                    {BY, 0, 4}, {RY, 0, 6}, {RZ, 0, 6}, {D, 0, 5}}}},
+    {0x02, 2, true, 11, {5, 4, 4}, {{{RW, 0, 10}, {GW, 0, 10}, {BW, 0, 10}, {RX, 0, 5}, {RW, 10, 1},
+                                     {GY, 0, 4}, {GX, 0, 4}, {GW, 10, 1}, {BZ, 0, 1}, {GZ, 0, 4},
+                                     {BX, 0, 4}, {BW, 10, 1}, {BZ, 1, 1}, {BY, 0, 4}, {RY, 0, 5},
+                                     {BZ, 2, 1}, {RZ, 0, 5}, {BZ, 3, 1}, {D, 0, 5}}}},
+    {0x06, 2, true, 11, {4, 5, 4}, {{{RW, 0, 10}, {GW, 0, 10}, {BW, 0, 10}, {RX, 0, 4}, {RW, 10, 1},
+                                     {GZ, 4, 1}, {GY, 0, 4}, {GX, 0, 5}, {GW, 10, 1}, {GZ, 0, 4},
+                                     {BX, 0, 4}, {BW, 10, 1}, {BZ, 1, 1}, {BY, 0, 4}, {RY, 0, 4},
+                                     {BZ, 0, 1}, {BZ, 2, 1}, {RZ, 0, 4}, {GY, 4, 1}, {BZ, 3, 1},
+                                     {D, 0, 5}}}},
+    {0x0A, 2, true, 11, {4, 4, 5}, {{{RW, 0, 10}, {GW, 0, 10}, {BW, 0, 10}, {RX, 0, 4}, {RW, 10, 1},
+                                     {BY, 4, 1}, {GY, 0, 4}, {GX, 0, 4}, {GW, 10, 1}, {BZ, 0, 1},
+                                     {GZ, 0, 4}, {BX, 0, 5}, {BW, 10, 1}, {BY, 0, 4}, {RY, 0, 4},
+                                     {BZ, 1, 1}, {BZ, 2, 1}, {RZ, 0, 4}, {BZ, 4, 1}, {BZ, 3, 1},
+                                     {D, 0, 5}}}},
+    {0x0E, 2, true, 9, {5, 5, 5}, {{{RW, 0, 9}, {BY, 4, 1}, {GW, 0, 9}, {GY, 4, 1}, {BW, 0, 9},
+                                    {BZ, 4, 1}, {RX, 0, 5}, {GZ, 4, 1}, {GY, 0, 4}, {GX, 0, 5},
+                                    {BZ, 0, 1}, {GZ, 0, 4}, {BX, 0, 5}, {BZ, 1, 1}, {BY, 0, 4},
+                                    {RY, 0, 5}, {BZ, 2, 1}, {RZ, 0, 5}, {BZ, 3, 1}, {D, 0, 5}}}},
+    {0x12, 2, true, 8, {6, 5, 5}, {{{RW, 0, 8}, {GZ, 4, 1}, {BY, 4, 1}, {GW, 0, 8}, {BZ, 2, 1},
+                                    {GY, 4, 1}, {BW, 0, 8}, {BZ, 3, 1}, {BZ, 4, 1}, {RX, 0, 6},
+                                    {GY, 0, 4}, {GX, 0, 5}, {BZ, 0, 1}, {GZ, 0, 4}, {BX, 0, 5},
+                                    {BZ, 1, 1}, {BY, 0, 4}, {RY, 0, 6}, {RZ, 0, 6}, {D, 0, 5}}}},
+    {0x16, 2, true, 8, {5, 6, 5}, {{{RW, 0, 8}, {BZ, 0, 1}, {BY, 4, 1}, {GW, 0, 8}, {GY, 5, 1},
+                                    {GY, 4, 1}, {BW, 0, 8}, {GZ, 5, 1}, {BZ, 4, 1}, {RX, 0, 5},
+                                    {GZ, 4, 1}, {GY, 0, 4}, {GX, 0, 6}, {GZ, 0, 4}, {BX, 0, 5},
+                                    {BZ, 1, 1}, {BY, 0, 4}, {RY, 0, 5}, {BZ, 2, 1}, {RZ, 0, 5},
+                                    {BZ, 3, 1}, {D, 0, 5}}}},
+    {0x1A, 2, true, 8, {5, 5, 6}, {{{RW, 0, 8}, {BZ, 1, 1}, {BY, 4, 1}, {GW, 0, 8}, {BY, 5, 1},
+                                    {GY, 4, 1}, {BW, 0, 8}, {BZ, 5, 1}, {BZ, 4, 1}, {RX, 0, 5},
+                                    {GZ, 4, 1}, {GY, 0, 4}, {GX, 0, 5}, {BZ, 0, 1}, {GZ, 0, 4},
+                                    {BX, 0, 6}, {BY, 0, 4}, {RY, 0, 5}, {BZ, 2, 1}, {RZ, 0, 5},
+                                    {BZ, 3, 1}, {D, 0, 5}}}},
+    {0x1E, 2, false, 6, {6, 6, 6}, {{{RW, 0, 6}, {GZ, 4, 1}, {BZ, 0, 1}, {BZ, 1, 1}, {BY, 4, 1},
+                                     {GW, 0, 6}, {GY, 5, 1}, {BY, 5, 1}, {BZ, 2, 1}, {GY, 4, 1},
+                                     {BW, 0, 6}, {GZ, 5, 1}, {BZ, 3, 1}, {BZ, 5, 1}, {BZ, 4, 1},
+                                     {RX, 0, 6}, {GY, 0, 4}, {GX, 0, 6}, {GZ, 0, 4}, {BX, 0, 6},
+                                     {BY, 0, 4}, {RY, 0, 6}, {RZ, 0, 6}, {D, 0, 5}}}},
+    {0x03, 1, false, 10, {10, 10, 10}, {{{RW, 0, 10}, {GW, 0, 10}, {BW, 0, 10}, {RX, 0, 10},
+                                         {GX, 0, 10}, {BX, 0, 10}}}},
+    {0x07, 1, true, 11, {9, 9, 9}, {{{RW, 0, 10}, {GW, 0, 10}, {BW, 0, 10}, {RX, 0, 9}, {RW, 10, 1},
+                                     {GX, 0, 9}, {GW, 10, 1}, {BX, 0, 9}, {BW, 10, 1}}}},
+    // The top bits of the base endpoints of the last two modes are stored reversed
+    {0x0B, 1, true, 12, {8, 8, 8}, {{{RW, 0, 10}, {GW, 0, 10}, {BW, 0, 10}, {RX, 0, 8}, {RW, 11, 1},
+                                     {RW, 10, 1}, {GX, 0, 8}, {GW, 11, 1}, {GW, 10, 1}, {BX, 0, 8},
+                                     {BW, 11, 1}, {BW, 10, 1}}}},
+    {0x0F, 1, true, 16, {4, 4, 4}, {{{RW, 0, 10}, {GW, 0, 10}, {BW, 0, 10}, {RX, 0, 4}, {RW, 15, 1},
+                                     {RW, 14, 1}, {RW, 13, 1}, {RW, 12, 1}, {RW, 11, 1},
+                                     {RW, 10, 1}, {GX, 0, 4}, {GW, 15, 1}, {GW, 14, 1},
+                                     {GW, 13, 1}, {GW, 12, 1}, {GW, 11, 1}, {GW, 10, 1},
+                                     {BX, 0, 4}, {BW, 15, 1}, {BW, 14, 1}, {BW, 13, 1},
+                                     {BW, 12, 1}, {BW, 11, 1}, {BW, 10, 1}}}},
+}};
+
+constexpr s32 SignExtend(u32 value, u32 bits) {
+    return static_cast<s32>(value << (32 - bits)) >> (32 - bits);
+}
+
+/// Scales an endpoint component to the 16-bit range that endpoints are interpolated in
+s32 Unquantize(s32 value, u32 bits, bool is_signed) {
+    if (!is_signed) {
+        if (bits >= 15 || value == 0) {
+            return value;
+        }
+        if (value == (1 << bits) - 1) {
+            return 0xFFFF;
+        }
+        return ((value << 15) + 0x4000) >> (bits - 1);
+    }
+    if (bits >= 16 || value == 0) {
+        return value;
+    }
+    const bool is_negative{value < 0};
+    const s32 magnitude{is_negative ? -value : value};
+    const s32 unquantized{magnitude >= (1 << (bits - 1)) - 1
+                              ? 0x7FFF
+                              : ((magnitude << 15) + 0x4000) >> (bits - 1)};
+    return is_negative ? -unquantized : unquantized;
+}
+
+/// Scales an interpolated component to the half float with the same bits
+u16 FinishUnquantize(s32 value, bool is_signed) {
+    if (!is_signed) {
+        return static_cast<u16>((value * 31) >> 6);
+    }
+    if (value < 0) {
+        return static_cast<u16>(0x8000 | (((-value) * 31) >> 5));
+    }
+    return static_cast<u16>((value * 31) >> 5);
+}
+
+template <bool is_signed>
+void DecodeBC6H(const u8* block, u8* texels) {
+    BitReader reader{block};
+    u32 mode_value{reader.Read(2)};
+    if (mode_value >= 2) {
+        mode_value |= reader.Read(3) << 2;
+    }
+    const auto mode = std::find_if(BC6HModes.begin(), BC6HModes.end(),
+                                   [mode_value](const auto& mode) {
+                                       return mode.value == mode_value;
+                                   });
+    if (mode == BC6HModes.end()) {
+        // Reserved modes decode to zero
+        std::memset(texels, 0, TexelsPerBlock * 8);
+        return;
+    }
+
+    std::array<u32, 13> fields{};
+    for (const auto& bits : mode->layout) {
+        fields[bits.field] |= reader.Read(bits.count) << bits.shift;
+    }
+
+    // Endpoints are W, X for one subset and W, X, Y, Z for two, in RGB order
+    const u32 num_endpoints{mode->num_subsets * 2};
+    std::array<std::array<s32, 3>, 4> endpoints;
+    for (u32 endpoint = 0; endpoint < num_endpoints; ++endpoint) {
+        for (u32 channel = 0; channel < 3; ++channel) {
+            const u32 value{fields[endpoint * 3 + channel]};
+            if (endpoint == 0 || !mode->is_transformed) {
+                endpoints[endpoint][channel] =
+                    is_signed ? SignExtend(value, mode->endpoint_bits) : static_cast<s32>(value);
+                continue;
+            }
+            // Transformed endpoints are signed deltas to the base endpoint
+            const s32 delta{SignExtend(value, mode->delta_bits[channel])};
+            const u32 sum{static_cast<u32>(endpoints[0][channel] + delta) &
+                          ((1U << mode->endpoint_bits) - 1)};
+            endpoints[endpoint][channel] =
+                is_signed ? SignExtend(sum, mode->endpoint_bits) : static_cast<s32>(sum);
+        }
+    }
+    for (u32 endpoint = 0; endpoint < num_endpoints; ++endpoint) {
+        for (auto& component : endpoints[endpoint]) {
+            component = Unquantize(component, mode->endpoint_bits, is_signed);
+        }
+    }
+
+    const u32 partition{fields[D]};
+    const u32 index_bits{mode->num_subsets == 1 ? 4U : 3U};
+    for (std::size_t texel = 0; texel < TexelsPerBlock; ++texel) {
+        const bool is_anchor{IsAnchor(mode->num_subsets, partition, texel)};
+        const u32 index{reader.Read(index_bits - (is_anchor ? 1 : 0))};
+        const u32 weight{GetWeight(index_bits, index)};
+        const u32 subset{GetSubset(mode->num_subsets, partition, texel)};
+
+        // Half float 1.0 for alpha
+        std::array<u16, 4> color{0, 0, 0, 0x3C00};
+        for (u32 channel = 0; channel < 3; ++channel) {
+            const s32 value{Interpolate(endpoints[subset * 2][channel],
+                                        endpoints[subset * 2 + 1][channel], weight)};
+            color[channel] = FinishUnquantize(value, is_signed);
+        }
+        std::memcpy(texels + texel * 8, color.data(), sizeof(color));
+    }
+}
+
+BlockDecoder GetBlockDecoder(Format format) {
+    switch (format) {
+    case Format::BC1:
+        return DecodeBC1;
+    case Format::BC2:
+        return DecodeBC2;
+    case Format::BC3:
+        return DecodeBC3;
+    case Format::BC4:
+        return DecodeBC4;
+    case Format::BC5U:
+        return DecodeBC5<false>;
+    case Format::BC5S:
+        return DecodeBC5<true>;
+    case Format::BC6HU:
+        return DecodeBC6H<false>;
+    case Format::BC6HS:
+        return DecodeBC6H<true>;
+    case Format::BC7:
+        return DecodeBC7;
+    }
+    UNREACHABLE();
+    return DecodeBC1;
+}
+
+void DecompressBlockRows(const u8* data, u8* output, Format format, u32 width, u32 height,
+                         u32 first_row, u32 last_row) {
+    const BlockDecoder decode{GetBlockDecoder(format)};
+    const std::size_t block_size{GetBlockSize(format)};
+    const std::size_t texel_size{GetDecodedBytesPerPixel(format)};
+    const u32 blocks_per_row{(width + BlockDimension - 1) / BlockDimension};
+
+    std::array<u8, TexelsPerBlock * MaxTexelSize> texels;
+    for (u32 block_y = first_row; block_y < last_row; ++block_y) {
+        const u8* block{data + static_cast<std::size_t>(block_y) * blocks_per_row * block_size};
+        const u32 y{block_y * BlockDimension};
+        const u32 num_rows{std::min(BlockDimension, height - y)};
+        for (u32 block_x = 0; block_x < blocks_per_row; ++block_x, block += block_size) {
+            decode(block, texels.data());
+
+            // Blocks on the right and bottom edges can stick out of the image
+            const u32 x{block_x * BlockDimension};
+            const std::size_t row_size{std::min(BlockDimension, width - x) * texel_size};
+            for (u32 row = 0; row < num_rows; ++row) {
+                const std::size_t offset{(static_cast<std::size_t>(y + row) * width + x) *
+                                         texel_size};
+                std::memcpy(output + offset, texels.data() + row * BlockDimension * texel_size,
+                            row_size);
+            }
+        }
+    }
+}
+
+} // Anonymous namespace
+
+std::size_t GetBlockSize(Format format) {
+    switch (format) {
+    case Format::BC1:
+    case Format::BC4:
+        return 8;
+    default:
+        return 16;
+    }
+}
+
+std::size_t GetEncodedSize(Format format, u32 width, u32 height) {
+    const std::size_t blocks_per_row{(width + BlockDimension - 1) / BlockDimension};
+    const std::size_t block_rows{(height + BlockDimension - 1) / BlockDimension};
+    return blocks_per_row * block_rows * GetBlockSize(format);
+}
+
+std::size_t GetDecodedBytesPerPixel(Format format) {
+    switch (format) {
+    case Format::BC6HU:
+    case Format::BC6HS:
+        return 8;
+    default:
+        return 4;
+    }
+}
+
+void Decompress(const u8* data, u8* output, Format format, u32 width, u32 height) {
+    // Each thread gets at least this many blocks, as handing out less work would take longer than
+    // decoding it
+    constexpr u32 MinBlocksPerThread = 4096;
+
+    const u32 blocks_per_row{(width + BlockDimension - 1) / BlockDimension};
+    const u32 block_rows{(height + BlockDimension - 1) / BlockDimension};
+    const u32 min_rows{std::max(MinBlocksPerThread / std::max(blocks_per_row, 1U), 1U)};
+
+    // Block rows are decoded in parallel on the shared pool, small textures on this thread only
+    if (block_rows <= min_rows) {
+        DecompressBlockRows(data, output, format, width, height, 0, block_rows);
+        return;
+    }
+    Common::ThreadPool::GetInstance().ParallelFor(
+        0, block_rows,
+        [&](std::size_t row) {
+            const auto block_row = static_cast<u32>(row);
+            DecompressBlockRows(data, output, format, width, height, block_row, block_row + 1);
+        },
+        min_rows);
+}
+
+} // namespace Tegra::Texture::BCn
@@ -0,0 +1,45 @@
+// Copyright 2018 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include "common/common_types.h"
+
+namespace Tegra::Texture::BCn {
+
+/// Block compressed formats that can be decoded in software, each block encodes 4x4 texels
+enum class Format {
+    BC1,   ///< DXT1
+    BC2,   ///< DXT23
+    BC3,   ///< DXT45
+    BC4,   ///< DXN1
+    BC5U,  ///< DXN2, unsigned normalized
+    BC5S,  ///< DXN2, signed normalized
+    BC6HU, ///< Unsigned half float
+    BC6HS, ///< Signed half float
+    BC7,
+};
+
+/// Returns the size of an encoded block
+std::size_t GetBlockSize(Format format);
+
+/// Returns the size of the blocks encoding an image of width x height texels
+std::size_t GetEncodedSize(Format format, u32 width, u32 height);
+
+/**
+ * Returns the size of a decoded texel. BC6H is decoded to RGBA16F and the other formats to RGBA8,
+ * signed for BC5S. The components missing from BC4 and BC5 are set to 0, and alpha to 1.
+ */
+std::size_t GetDecodedBytesPerPixel(Format format);
+
+/**
+ * Decodes an image made of rows of 4x4 blocks into tightly packed texels. Large images are decoded
+ * on the shared thread pool, a few rows of blocks at a time.
+ * @param data Encoded blocks, GetEncodedSize(format, width, height) bytes
+ * @param output Buffer with room for width * height decoded texels
+ */
+void Decompress(const u8* data, u8* output, Format format, u32 width, u32 height);
+
+} // namespace Tegra::Texture::BCn
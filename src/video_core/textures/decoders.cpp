@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstring>
 #include "common/assert.h"
@@ -30,22 +32,6 @@ static u32 GetSwizzleOffset(u32 x, u32 y, u32 image_width, u32 bytes_per_pixel,
     return address;
 }
 
-void CopySwizzledData(u32 width, u32 height, u32 bytes_per_pixel, u32 out_bytes_per_pixel,
-                      u8* swizzled_data, u8* unswizzled_data, bool unswizzle, u32 block_height) {
-    u8* data_ptrs[2];
-    for (unsigned y = 0; y < height; ++y) {
-        for (unsigned x = 0; x < width; ++x) {
-            u32 swizzle_offset = GetSwizzleOffset(x, y, width, bytes_per_pixel, block_height);
-            u32 pixel_index = (x + y * width) * out_bytes_per_pixel;
-
-            data_ptrs[unswizzle] = swizzled_data + swizzle_offset;
-            data_ptrs[!unswizzle] = &unswizzled_data[pixel_index];
-
-            std::memcpy(data_ptrs[0], data_ptrs[1], bytes_per_pixel);
-        }
-    }
-}
-
 template <std::size_t N, std::size_t M>
 struct alignas(64) SwizzleTable {
     constexpr SwizzleTable() {
@@ -65,25 +51,93 @@ struct alignas(64) SwizzleTable {
 
 constexpr auto swizzle_table = SwizzleTable<8, 4>();
 
+/**
+ * Copies the first rows and 16-byte columns of a GOB between its swizzled and linear layouts.
+ * When called with a full GOB, 8 rows of 4 columns, the loops are unrolled into plain 16-byte
+ * vector moves.
+ */
+template <bool unswizzle>
+static void CopyGob(u8* swizzled_gob, u8* linear_data, std::size_t stride, std::size_t rows,
+                    std::size_t columns) {
+    constexpr std::size_t copy_size{16};
+    for (std::size_t row = 0; row < rows; ++row) {
+        const auto& table = swizzle_table[row];
+        u8* const linear_row{linear_data + row * stride};
+        for (std::size_t column = 0; column < columns; ++column) {
+            u8* const swizzled{swizzled_gob + table[column]};
+            u8* const linear{linear_row + column * copy_size};
+            if constexpr (unswizzle) {
+                std::memcpy(linear, swizzled, copy_size);
+            } else {
+                std::memcpy(swizzled, linear, copy_size);
+            }
+        }
+    }
+}
+
+/// Swizzles or unswizzles a texture one GOB at a time, requires a stride multiple of 16 bytes
+template <bool unswizzle>
+static void SwizzleGobs(u32 width, u32 height, u32 bytes_per_pixel, u8* swizzled_data,
+                        u8* unswizzled_data, u32 block_height) {
+    constexpr std::size_t gob_size{512};
+    constexpr std::size_t gob_width{64};
+    constexpr std::size_t gob_height{8};
+    const std::size_t stride{width * bytes_per_pixel};
+    const std::size_t image_width_in_gobs{(stride + gob_width - 1) / gob_width};
+    const std::size_t image_height_in_gobs{(height + gob_height - 1) / gob_height};
+    const std::size_t block_size{gob_size * block_height};
+
+    for (std::size_t gob_y = 0; gob_y < image_height_in_gobs; ++gob_y) {
+        const std::size_t y{gob_y * gob_height};
+        const std::size_t rows{std::min<std::size_t>(gob_height, height - y)};
+        u8* const block_row{swizzled_data + (gob_y / block_height) * block_size *
+                                                image_width_in_gobs +
+                            (gob_y % block_height) * gob_size};
+        u8* const linear_row{unswizzled_data + y * stride};
+
+        for (std::size_t gob_x = 0; gob_x < image_width_in_gobs; ++gob_x) {
+            const std::size_t x{gob_x * gob_width};
+            const std::size_t columns{std::min<std::size_t>(gob_width, stride - x) / 16};
+            u8* const swizzled_gob{block_row + gob_x * block_size};
+            if (rows == gob_height && columns == 4) {
+                CopyGob<unswizzle>(swizzled_gob, linear_row + x, stride, gob_height, 4);
+            } else {
+                CopyGob<unswizzle>(swizzled_gob, linear_row + x, stride, rows, columns);
+            }
+        }
+    }
+}
+
 void FastSwizzleData(u32 width, u32 height, u32 bytes_per_pixel, u8* swizzled_data,
                      u8* unswizzled_data, bool unswizzle, u32 block_height) {
-    std::array<u8*, 2> data_ptrs;
-    const std::size_t stride{width * bytes_per_pixel};
-    const std::size_t image_width_in_gobs{(stride + 63) / 64};
-    const std::size_t copy_size{16};
-    for (std::size_t y = 0; y < height; ++y) {
-        const std::size_t initial_gob =
-            (y / (8 * block_height)) * 512 * block_height * image_width_in_gobs +
-            (y % (8 * block_height) / 8) * 512;
-        const std::size_t pixel_base{y * width * bytes_per_pixel};
-        const auto& table = swizzle_table[y % 8];
-        for (std::size_t xb = 0; xb < stride; xb += copy_size) {
-            const std::size_t gob_address{initial_gob + (xb / 64) * 512 * block_height};
-            const std::size_t swizzle_offset{gob_address + table[(xb / 16) % 4]};
-            const std::size_t pixel_index{xb + pixel_base};
+    if (unswizzle) {
+        SwizzleGobs<true>(width, height, bytes_per_pixel, swizzled_data, unswizzled_data,
+                          block_height);
+    } else {
+        SwizzleGobs<false>(width, height, bytes_per_pixel, swizzled_data, unswizzled_data,
+                           block_height);
+    }
+}
+
+void CopySwizzledData(u32 width, u32 height, u32 bytes_per_pixel, u32 out_bytes_per_pixel,
+                      u8* swizzled_data, u8* unswizzled_data, bool unswizzle, u32 block_height) {
+    if (bytes_per_pixel == out_bytes_per_pixel && bytes_per_pixel % 3 != 0 &&
+        (width * bytes_per_pixel) % 16 == 0) {
+        FastSwizzleData(width, height, bytes_per_pixel, swizzled_data, unswizzled_data, unswizzle,
+                        block_height);
+        return;
+    }
+
+    u8* data_ptrs[2];
+    for (unsigned y = 0; y < height; ++y) {
+        for (unsigned x = 0; x < width; ++x) {
+            u32 swizzle_offset = GetSwizzleOffset(x, y, width, bytes_per_pixel, block_height);
+            u32 pixel_index = (x + y * width) * out_bytes_per_pixel;
+
             data_ptrs[unswizzle] = swizzled_data + swizzle_offset;
-            data_ptrs[!unswizzle] = unswizzled_data + pixel_index;
-            std::memcpy(data_ptrs[0], data_ptrs[1], copy_size);
+            data_ptrs[!unswizzle] = &unswizzled_data[pixel_index];
+
+            std::memcpy(data_ptrs[0], data_ptrs[1], bytes_per_pixel);
         }
     }
 }
@@ -134,16 +188,17 @@ u32 BytesPerPixel(TextureFormat format) {
 std::vector<u8> UnswizzleTexture(VAddr address, u32 tile_size, u32 bytes_per_pixel, u32 width,
                                  u32 height, u32 block_height) {
     std::vector<u8> unswizzled_data(width * height * bytes_per_pixel);
-    if (bytes_per_pixel % 3 != 0 && (width * bytes_per_pixel) % 16 == 0) {
-        FastSwizzleData(width / tile_size, height / tile_size, bytes_per_pixel,
-                        Memory::GetPointer(address), unswizzled_data.data(), true, block_height);
-    } else {
-        CopySwizzledData(width / tile_size, height / tile_size, bytes_per_pixel, bytes_per_pixel,
-                         Memory::GetPointer(address), unswizzled_data.data(), true, block_height);
-    }
+    UnswizzleTexture(unswizzled_data.data(), address, tile_size, bytes_per_pixel, width, height,
+                     block_height);
     return unswizzled_data;
 }
 
+void UnswizzleTexture(u8* unswizzled_data, VAddr address, u32 tile_size, u32 bytes_per_pixel,
+                      u32 width, u32 height, u32 block_height) {
+    CopySwizzledData(width / tile_size, height / tile_size, bytes_per_pixel, bytes_per_pixel,
+                     Memory::GetPointer(address), unswizzled_data, true, block_height);
+}
+
 std::vector<u8> DecodeTexture(const std::vector<u8>& texture_data, TextureFormat format, u32 width,
                               u32 height) {
     std::vector<u8> rgba_data;
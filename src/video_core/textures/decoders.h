@@ -6,6 +6,7 @@
 
 #include <vector>
 #include "common/common_types.h"
+#include "video_core/gpu.h"
 #include "video_core/textures/texture.h"
 
 namespace Tegra::Texture {
@@ -16,12 +17,26 @@ namespace Tegra::Texture {
 std::vector<u8> UnswizzleTexture(VAddr address, u32 tile_size, u32 bytes_per_pixel, u32 width,
                                  u32 height, u32 block_height = TICEntry::DefaultBlockHeight);
 
+/**
+ * Unswizzles a swizzled texture without changing its format into the given buffer, which must have
+ * room for (width / tile_size) * (height / tile_size) * bytes_per_pixel bytes.
+ */
+void UnswizzleTexture(u8* unswizzled_data, VAddr address, u32 tile_size, u32 bytes_per_pixel,
+                      u32 width, u32 height, u32 block_height = TICEntry::DefaultBlockHeight);
+
 /**
  * Unswizzles a swizzled depth texture without changing its format.
  */
 std::vector<u8> UnswizzleDepthTexture(VAddr address, DepthFormat format, u32 width, u32 height,
                                       u32 block_height = TICEntry::DefaultBlockHeight);
 
+/**
+ * Swizzles or unswizzles a texture 16 bytes of a GOB at a time. Requires rows whose size is a
+ * multiple of 16 bytes, CopySwizzledData picks it when the texture allows it.
+ */
+void FastSwizzleData(u32 width, u32 height, u32 bytes_per_pixel, u8* swizzled_data,
+                     u8* unswizzled_data, bool unswizzle, u32 block_height);
+
 /// Copies texture data from a buffer and performs swizzling/unswizzling as necessary.
 void CopySwizzledData(u32 width, u32 height, u32 bytes_per_pixel, u32 out_bytes_per_pixel,
                       u8* swizzled_data, u8* unswizzled_data, bool unswizzle, u32 block_height);
@@ -162,6 +162,8 @@ struct TICEntry {
     };
     union {
         BitField<3, 3, u32> block_height;
+        // Index of the last mipmap level, the texture has max_mip_level + 1 levels
+        BitField<28, 4, u32> max_mip_level;
 
         // High 16 bits of the pitch value
         BitField<0, 16, u32> pitch_high;
@@ -200,6 +202,12 @@ struct TICEntry {
         return depth_minus_1 + 1;
     }
 
+    u32 NumLevels() const {
+        ASSERT(header_version == TICHeaderVersion::BlockLinear ||
+               header_version == TICHeaderVersion::BlockLinearColorKey);
+        return max_mip_level + 1;
+    }
+
     u32 BlockHeight() const {
         ASSERT(header_version == TICHeaderVersion::BlockLinear ||
                header_version == TICHeaderVersion::BlockLinearColorKey);
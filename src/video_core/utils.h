@@ -145,12 +145,29 @@ static inline u32 GetMortonOffset128(u32 x, u32 y, u32 bytes_per_pixel) {
 static inline void MortonCopyPixels128(u32 width, u32 height, u32 bytes_per_pixel,
                                        u32 gl_bytes_per_pixel, u8* morton_data, u8* gl_data,
                                        bool morton_to_gl) {
+    // Four horizontally adjacent pixels starting at a multiple of four are contiguous in Morton
+    // order, with 32-bit pixels each of these runs is copied as a single 16 byte move
+    const bool copy_runs = bytes_per_pixel == 4 && gl_bytes_per_pixel == 4;
+    constexpr u32 run_length = 4;
+
     u8* data_ptrs[2];
     for (unsigned y = 0; y < height; ++y) {
-        for (unsigned x = 0; x < width; ++x) {
-            const u32 coarse_y = y & ~127;
-            u32 morton_offset =
-                GetMortonOffset128(x, y, bytes_per_pixel) + coarse_y * width * bytes_per_pixel;
+        const u32 coarse_y = y & ~127;
+        const u32 row_offset = coarse_y * width * bytes_per_pixel;
+        unsigned x = 0;
+        if (copy_runs) {
+            for (; x + run_length <= width; x += run_length) {
+                const u32 morton_offset = GetMortonOffset128(x, y, 4) + row_offset;
+                const u32 gl_pixel_index = (x + y * width) * 4;
+
+                data_ptrs[morton_to_gl] = morton_data + morton_offset;
+                data_ptrs[!morton_to_gl] = &gl_data[gl_pixel_index];
+
+                memcpy(data_ptrs[0], data_ptrs[1], run_length * 4);
+            }
+        }
+        for (; x < width; ++x) {
+            u32 morton_offset = GetMortonOffset128(x, y, bytes_per_pixel) + row_offset;
             u32 gl_pixel_index = (x + y * width) * gl_bytes_per_pixel;
 
             data_ptrs[morton_to_gl] = morton_data + morton_offset;
@@ -3,14 +3,23 @@
 // Refer to the license.txt file included.
 
 #include <memory>
+#include "core/settings.h"
 #include "video_core/renderer_base.h"
+#include "video_core/renderer_null/renderer_null.h"
 #include "video_core/renderer_opengl/renderer_opengl.h"
 #include "video_core/video_core.h"
 
 namespace VideoCore {
 
-std::unique_ptr<RendererBase> CreateRenderer(Core::Frontend::EmuWindow& emu_window) {
-    return std::make_unique<OpenGL::RendererOpenGL>(emu_window);
+std::unique_ptr<RendererBase> CreateRenderer(Core::Frontend::EmuWindow& emu_window,
+                                             Core::System& system) {
+    switch (Settings::values.renderer_backend) {
+    case Settings::RendererBackend::Null:
+        return std::make_unique<Null::RendererNull>(emu_window, system);
+    case Settings::RendererBackend::OpenGL:
+    default:
+        return std::make_unique<OpenGL::RendererOpenGL>(emu_window, system);
+    }
 }
 
 } // namespace VideoCore
@@ -9,6 +9,7 @@
 #include "common/microprofile.h"
 #include "common/scm_rev.h"
 #include "common/string_util.h"
+#include "common/thread.h"
 #include "core/core.h"
 #include "core/frontend/framebuffer_layout.h"
 #include "core/settings.h"
@@ -20,13 +21,21 @@
 EmuThread::EmuThread(GRenderWindow* render_window) : render_window(render_window) {}
 
 void EmuThread::run() {
-    if (!Settings::values.use_multi_core) {
-        // Single core mode must acquire OpenGL context for entire emulation session
+    if (!Settings::values.use_multi_core && !Settings::values.use_asynchronous_gpu_emulation) {
+        // Single core mode must acquire OpenGL context for entire emulation session, unless the
+        // GPU thread owns it
         render_window->MakeCurrent();
     }
 
+    Common::SetCurrentThreadName("yuzu:EmuThread");
     MicroProfileOnThreadCreate("EmuThread");
 
+    // Build the cached shaders before the title runs, so that it doesn't stutter on them
+    Core::System::GetInstance().GPU().LoadDiskResources(
+        [this](VideoCore::LoadCallbackStage stage, std::size_t value, std::size_t total) {
+            emit LoadProgress(stage, value, total);
+        });
+
     stop_run = false;
 
     // holds whether the cpu was running during the last iteration,
@@ -64,7 +73,11 @@ void EmuThread::run() {
     }
 
     // Shutdown the core emulation
-    Core::System::GetInstance().Shutdown();
+    if (keep_renderer) {
+        Core::System::GetInstance().ShutdownForRestart();
+    } else {
+        Core::System::GetInstance().Shutdown();
+    }
 
 #if MICROPROFILE_ENABLED
     MicroProfileOnThreadExit();
@@ -12,6 +12,7 @@
 #include "common/thread.h"
 #include "core/core.h"
 #include "core/frontend/emu_window.h"
+#include "video_core/gpu.h"
 
 class QKeyEvent;
 class QScreen;
@@ -64,8 +65,11 @@ public:
 
     /**
      * Requests for the emulation thread to stop running
+     * @param keep_renderer Whether the renderer is kept for the next title to be loaded, see
+     *                      Core::System::ShutdownForRestart
      */
-    void RequestStop() {
+    void RequestStop(bool keep_renderer = false) {
+        this->keep_renderer = keep_renderer;
         stop_run = true;
         SetRunning(false);
     }
@@ -74,6 +78,7 @@ private:
     bool exec_step = false;
     bool running = false;
     std::atomic<bool> stop_run{false};
+    std::atomic<bool> keep_renderer{false};
     std::mutex running_mutex;
     std::condition_variable running_cv;
 
@@ -99,6 +104,12 @@ signals:
     void DebugModeLeft();
 
     void ErrorThrown(Core::System::ResultStatus, std::string);
+
+    /**
+     * Emitted while the resources stored on disk, such as the shader cache, are being built
+     * before the emulation starts
+     */
+    void LoadProgress(VideoCore::LoadCallbackStage stage, std::size_t value, std::size_t total);
 };
 
 class GRenderWindow : public QWidget, public Core::Frontend::EmuWindow {
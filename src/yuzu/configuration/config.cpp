@@ -79,6 +79,15 @@ void Config::ReadValues() {
     qt_config->beginGroup("Core");
     Settings::values.use_cpu_jit = qt_config->value("use_cpu_jit", true).toBool();
     Settings::values.use_multi_core = qt_config->value("use_multi_core", false).toBool();
+    Settings::values.pin_emulation_threads =
+        qt_config->value("pin_emulation_threads", false).toBool();
+    Settings::values.use_host_timing = qt_config->value("use_host_timing", false).toBool();
+    Settings::values.use_hle_libc = qt_config->value("use_hle_libc", false).toBool();
+    Settings::values.simd_level_limit = static_cast<Common::SIMDLevel>(
+        qt_config->value("simd_level_limit", static_cast<u32>(Common::MAX_SIMD_LEVEL)).toUInt());
+    Settings::values.rewind_interval = qt_config->value("rewind_interval", 0).toUInt();
+    Settings::values.rewind_memory_budget =
+        qt_config->value("rewind_memory_budget", 512).toUInt();
     qt_config->endGroup();
 
     qt_config->beginGroup("Renderer");
@@ -87,6 +96,31 @@ void Config::ReadValues() {
     Settings::values.frame_limit = qt_config->value("frame_limit", 100).toInt();
     Settings::values.use_accurate_framebuffers =
         qt_config->value("use_accurate_framebuffers", false).toBool();
+    Settings::values.use_disk_shader_cache =
+        qt_config->value("use_disk_shader_cache", true).toBool();
+    Settings::values.use_asynchronous_shaders =
+        qt_config->value("use_asynchronous_shaders", false).toBool();
+    Settings::values.skip_draws_with_pending_shaders =
+        qt_config->value("skip_draws_with_pending_shaders", true).toBool();
+    Settings::values.use_uber_shaders = qt_config->value("use_uber_shaders", true).toBool();
+    Settings::values.use_gpu_texture_decoding =
+        qt_config->value("use_gpu_texture_decoding", false).toBool();
+    Settings::values.use_texture_deduplication =
+        qt_config->value("use_texture_deduplication", false).toBool();
+    Settings::values.use_deferred_cache_invalidation =
+        qt_config->value("use_deferred_cache_invalidation", false).toBool();
+    Settings::values.use_resident_vertex_buffers =
+        qt_config->value("use_resident_vertex_buffers", false).toBool();
+    Settings::values.use_gpu_memory_aliasing =
+        qt_config->value("use_gpu_memory_aliasing", false).toBool();
+    Settings::values.use_draw_batching = qt_config->value("use_draw_batching", false).toBool();
+    Settings::values.use_asynchronous_gpu_emulation =
+        qt_config->value("use_asynchronous_gpu_emulation", false).toBool();
+    Settings::values.use_frame_skip = qt_config->value("use_frame_skip", false).toBool();
+    Settings::values.renderer_backend =
+        static_cast<Settings::RendererBackend>(qt_config->value("renderer_backend", 0).toInt());
+    Settings::values.skip_gpu_commands = qt_config->value("skip_gpu_commands", false).toBool();
+    Settings::values.texture_cache_budget = qt_config->value("texture_cache_budget", 1024).toUInt();
 
     Settings::values.bg_red = qt_config->value("bg_red", 0.0).toFloat();
     Settings::values.bg_green = qt_config->value("bg_green", 0.0).toFloat();
@@ -97,6 +131,8 @@ void Config::ReadValues() {
     Settings::values.sink_id = qt_config->value("output_engine", "auto").toString().toStdString();
     Settings::values.enable_audio_stretching =
         qt_config->value("enable_audio_stretching", true).toBool();
+    Settings::values.audio_latency = qt_config->value("audio_latency", 50).toInt();
+    Settings::values.audio_stretch_quality = qt_config->value("audio_stretch_quality", 1).toInt();
     Settings::values.audio_device_id =
         qt_config->value("output_device", "auto").toString().toStdString();
     Settings::values.volume = qt_config->value("volume", 1).toFloat();
@@ -134,6 +170,10 @@ void Config::ReadValues() {
     qt_config->beginGroup("Debugging");
     Settings::values.use_gdbstub = qt_config->value("use_gdbstub", false).toBool();
     Settings::values.gdbstub_port = qt_config->value("gdbstub_port", 24689).toInt();
+    Settings::values.profile_svcs = qt_config->value("profile_svcs", false).toBool();
+    Settings::values.record_memory_stats =
+        qt_config->value("record_memory_stats", false).toBool();
+    Settings::values.profile_guest = qt_config->value("profile_guest", false).toBool();
     qt_config->endGroup();
 
     qt_config->beginGroup("UI");
@@ -141,6 +181,7 @@ void Config::ReadValues() {
 
     qt_config->beginGroup("UIGameList");
     UISettings::values.show_unknown = qt_config->value("show_unknown", true).toBool();
+    UISettings::values.cache_game_list = qt_config->value("cache_game_list", true).toBool();
     UISettings::values.icon_size = qt_config->value("icon_size", 64).toUInt();
     UISettings::values.row_1_text_id = qt_config->value("row_1_text_id", 3).toUInt();
     UISettings::values.row_2_text_id = qt_config->value("row_2_text_id", 2).toUInt();
@@ -216,6 +257,12 @@ void Config::SaveValues() {
     qt_config->beginGroup("Core");
     qt_config->setValue("use_cpu_jit", Settings::values.use_cpu_jit);
     qt_config->setValue("use_multi_core", Settings::values.use_multi_core);
+    qt_config->setValue("pin_emulation_threads", Settings::values.pin_emulation_threads);
+    qt_config->setValue("use_host_timing", Settings::values.use_host_timing);
+    qt_config->setValue("use_hle_libc", Settings::values.use_hle_libc);
+    qt_config->setValue("simd_level_limit", static_cast<u32>(Settings::values.simd_level_limit));
+    qt_config->setValue("rewind_interval", Settings::values.rewind_interval);
+    qt_config->setValue("rewind_memory_budget", Settings::values.rewind_memory_budget);
     qt_config->endGroup();
 
     qt_config->beginGroup("Renderer");
@@ -223,6 +270,25 @@ void Config::SaveValues() {
     qt_config->setValue("use_frame_limit", Settings::values.use_frame_limit);
     qt_config->setValue("frame_limit", Settings::values.frame_limit);
     qt_config->setValue("use_accurate_framebuffers", Settings::values.use_accurate_framebuffers);
+    qt_config->setValue("use_disk_shader_cache", Settings::values.use_disk_shader_cache);
+    qt_config->setValue("use_asynchronous_shaders", Settings::values.use_asynchronous_shaders);
+    qt_config->setValue("skip_draws_with_pending_shaders",
+                        Settings::values.skip_draws_with_pending_shaders);
+    qt_config->setValue("use_uber_shaders", Settings::values.use_uber_shaders);
+    qt_config->setValue("use_gpu_texture_decoding", Settings::values.use_gpu_texture_decoding);
+    qt_config->setValue("use_texture_deduplication", Settings::values.use_texture_deduplication);
+    qt_config->setValue("use_deferred_cache_invalidation",
+                        Settings::values.use_deferred_cache_invalidation);
+    qt_config->setValue("use_resident_vertex_buffers",
+                        Settings::values.use_resident_vertex_buffers);
+    qt_config->setValue("use_gpu_memory_aliasing", Settings::values.use_gpu_memory_aliasing);
+    qt_config->setValue("use_draw_batching", Settings::values.use_draw_batching);
+    qt_config->setValue("use_asynchronous_gpu_emulation",
+                        Settings::values.use_asynchronous_gpu_emulation);
+    qt_config->setValue("use_frame_skip", Settings::values.use_frame_skip);
+    qt_config->setValue("renderer_backend", static_cast<int>(Settings::values.renderer_backend));
+    qt_config->setValue("skip_gpu_commands", Settings::values.skip_gpu_commands);
+    qt_config->setValue("texture_cache_budget", Settings::values.texture_cache_budget);
 
     // Cast to double because Qt's written float values are not human-readable
     qt_config->setValue("bg_red", (double)Settings::values.bg_red);
@@ -233,6 +299,8 @@ void Config::SaveValues() {
     qt_config->beginGroup("Audio");
     qt_config->setValue("output_engine", QString::fromStdString(Settings::values.sink_id));
     qt_config->setValue("enable_audio_stretching", Settings::values.enable_audio_stretching);
+    qt_config->setValue("audio_latency", Settings::values.audio_latency);
+    qt_config->setValue("audio_stretch_quality", Settings::values.audio_stretch_quality);
     qt_config->setValue("output_device", QString::fromStdString(Settings::values.audio_device_id));
     qt_config->setValue("volume", Settings::values.volume);
     qt_config->endGroup();
@@ -259,6 +327,9 @@ void Config::SaveValues() {
     qt_config->beginGroup("Debugging");
     qt_config->setValue("use_gdbstub", Settings::values.use_gdbstub);
     qt_config->setValue("gdbstub_port", Settings::values.gdbstub_port);
+    qt_config->setValue("profile_svcs", Settings::values.profile_svcs);
+    qt_config->setValue("record_memory_stats", Settings::values.record_memory_stats);
+    qt_config->setValue("profile_guest", Settings::values.profile_guest);
     qt_config->endGroup();
 
     qt_config->beginGroup("UI");
@@ -266,6 +337,7 @@ void Config::SaveValues() {
 
     qt_config->beginGroup("UIGameList");
     qt_config->setValue("show_unknown", UISettings::values.show_unknown);
+    qt_config->setValue("cache_game_list", UISettings::values.cache_game_list);
     qt_config->setValue("icon_size", UISettings::values.icon_size);
     qt_config->setValue("row_1_text_id", UISettings::values.row_1_text_id);
     qt_config->setValue("row_2_text_id", UISettings::values.row_2_text_id);
@@ -0,0 +1,195 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <QCheckBox>
+#include <QColor>
+#include <QFile>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QStandardItemModel>
+#include <QTreeView>
+#include <QVBoxLayout>
+#include "core/memory_stats.h"
+#include "core/settings.h"
+#include "yuzu/debugger/memory_stats.h"
+
+namespace {
+enum Column {
+    COLUMN_NAME,
+    COLUMN_TOTAL,
+    COLUMN_READS,
+    COLUMN_WRITES,
+    COLUMN_FLUSHES,
+    COLUMN_INVALIDATIONS,
+    COLUMN_VMA_LOOKUPS,
+    COLUMN_COUNT,
+};
+
+/// Number of pages listed, the report is sorted so these are the most accessed ones
+constexpr std::size_t MAX_LISTED_PAGES = 256;
+
+/// Makes a row with the given counters, the columns left empty don't apply to it
+QList<QStandardItem*> MakeRow(const QString& name, const QStringList& values) {
+    QList<QStandardItem*> row{new QStandardItem(name)};
+    for (const QString& value : values) {
+        row.append(new QStandardItem(value));
+    }
+    while (row.size() < COLUMN_COUNT) {
+        row.append(new QStandardItem);
+    }
+    for (QStandardItem* item : row) {
+        item->setEditable(false);
+    }
+    return row;
+}
+
+QStandardItem* MakeGroup(const QString& name) {
+    QStandardItem* item = new QStandardItem(name);
+    item->setEditable(false);
+    return item;
+}
+} // Anonymous namespace
+
+MemoryStatsWidget::MemoryStatsWidget(QWidget* parent)
+    : QDockWidget(tr("Memory Access Statistics"), parent) {
+    setObjectName("MemoryStatsWidget");
+
+    enable_checkbox = new QCheckBox(tr("Record accesses"));
+    enable_checkbox->setChecked(Settings::values.record_memory_stats);
+    connect(enable_checkbox, &QCheckBox::toggled,
+            [](bool checked) { Settings::values.record_memory_stats = checked; });
+
+    QPushButton* reset_button = new QPushButton(tr("Reset"));
+    connect(reset_button, &QPushButton::clicked, this, &MemoryStatsWidget::Reset);
+    QPushButton* export_button = new QPushButton(tr("Export..."));
+    connect(export_button, &QPushButton::clicked, this, &MemoryStatsWidget::Export);
+
+    model = new QStandardItemModel(0, COLUMN_COUNT, this);
+    model->setHorizontalHeaderLabels({tr("Name"), tr("Total"), tr("Slow reads"),
+                                      tr("Slow writes"), tr("Flushes"), tr("Invalidations"),
+                                      tr("VMA lookups")});
+
+    view = new QTreeView;
+    view->setModel(model);
+    view->setUniformRowHeights(true);
+    view->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+    QHBoxLayout* controls = new QHBoxLayout;
+    controls->addWidget(enable_checkbox);
+    controls->addStretch();
+    controls->addWidget(reset_button);
+    controls->addWidget(export_button);
+
+    QWidget* contents = new QWidget;
+    QVBoxLayout* layout = new QVBoxLayout(contents);
+    layout->addLayout(controls);
+    layout->addWidget(view);
+    setWidget(contents);
+
+    update_timer.setInterval(1000);
+    connect(&update_timer, &QTimer::timeout, this, &MemoryStatsWidget::Refresh);
+}
+
+MemoryStatsWidget::~MemoryStatsWidget() = default;
+
+void MemoryStatsWidget::showEvent(QShowEvent* ev) {
+    enable_checkbox->setChecked(Settings::values.record_memory_stats);
+    Refresh();
+    update_timer.start();
+    QDockWidget::showEvent(ev);
+}
+
+void MemoryStatsWidget::hideEvent(QHideEvent* ev) {
+    update_timer.stop();
+    QDockWidget::hideEvent(ev);
+}
+
+void MemoryStatsWidget::Refresh() {
+    const Memory::MemoryAccessReport report = Memory::AccessStats::GetReport();
+
+    // Keep the groups that were collapsed closed across refreshes
+    QList<bool> expanded;
+    for (int row = 0; row < model->rowCount(); ++row) {
+        expanded.append(view->isExpanded(model->index(row, COLUMN_NAME)));
+    }
+
+    model->removeRows(0, model->rowCount());
+
+    static const std::array<const char*, 4> page_type_names{
+        QT_TR_NOOP("Unmapped"), QT_TR_NOOP("Memory (watched)"),
+        QT_TR_NOOP("Rasterizer cached"), QT_TR_NOOP("Special")};
+    QStandardItem* page_types = MakeGroup(tr("Slow accesses by page type"));
+    for (std::size_t type = 0; type < page_type_names.size(); ++type) {
+        page_types->appendRow(MakeRow(tr(page_type_names[type]),
+                                      {QString::number(report.accesses_by_page_type[type])}));
+    }
+    model->appendRow(page_types);
+
+    QStandardItem* caches = MakeGroup(tr("Cached objects"));
+    for (const Memory::CachedObjectStats& stats : report.cached_objects) {
+        caches->appendRow(MakeRow(QString::fromStdString(stats.cache_name),
+                                  {QString::number(stats.flushed + stats.invalidated), QString(),
+                                   QString(), QString::number(stats.flushed),
+                                   QString::number(stats.invalidated)}));
+    }
+    model->appendRow(caches);
+
+    // Shade the pages by how often they're accessed relative to the hottest one
+    QStandardItem* pages =
+        MakeGroup(tr("Pages (%1 most accessed of %2)")
+                      .arg(std::min(report.pages.size(), MAX_LISTED_PAGES))
+                      .arg(report.pages.size()));
+    const u64 hottest = report.pages.empty() ? 1 : std::max<u64>(report.pages[0].GetTotal(), 1);
+    const std::size_t num_listed = std::min(report.pages.size(), MAX_LISTED_PAGES);
+    for (std::size_t i = 0; i < num_listed; ++i) {
+        const Memory::PageAccessStats& stats = report.pages[i];
+        QList<QStandardItem*> row =
+            MakeRow(QStringLiteral("0x%1").arg(stats.address, 16, 16, QLatin1Char('0')),
+                    {QString::number(stats.GetTotal()), QString::number(stats.slow_reads),
+                     QString::number(stats.slow_writes), QString::number(stats.rasterizer_flushes),
+                     QString::number(stats.rasterizer_invalidations),
+                     QString::number(stats.vma_lookups)});
+        const int heat = static_cast<int>(stats.GetTotal() * 160 / hottest);
+        row[COLUMN_TOTAL]->setBackground(QColor(255, 255 - heat, 255 - heat));
+        pages->appendRow(row);
+    }
+    model->appendRow(pages);
+
+    for (int row = 0; row < model->rowCount(); ++row) {
+        const bool is_expanded = row < expanded.size() ? expanded[row] : true;
+        view->setExpanded(model->index(row, COLUMN_NAME), is_expanded);
+    }
+}
+
+void MemoryStatsWidget::Reset() {
+    Memory::AccessStats::Reset();
+    Refresh();
+}
+
+void MemoryStatsWidget::Export() {
+    const QString path =
+        QFileDialog::getSaveFileName(this, tr("Export Memory Access Statistics"), QString(),
+                                     tr("CSV (*.csv);;JSON (*.json)"));
+    if (path.isEmpty()) {
+        return;
+    }
+
+    const auto report = Memory::AccessStats::GetReport();
+    const bool is_json = path.endsWith(QStringLiteral(".json"), Qt::CaseInsensitive);
+    const std::string stats = is_json ? Memory::AccessStats::FormatJSON(report)
+                                      : Memory::AccessStats::FormatCSV(report);
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+        file.write(stats.data(), static_cast<qint64>(stats.size())) !=
+            static_cast<qint64>(stats.size())) {
+        QMessageBox::critical(this, tr("Export Memory Access Statistics"),
+                              tr("Failed to write the statistics to %1.").arg(path));
+    }
+}
@@ -0,0 +1,161 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <QCheckBox>
+#include <QFile>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QSet>
+#include <QStandardItemModel>
+#include <QTreeView>
+#include <QVBoxLayout>
+#include "core/hle/kernel/svc_profiler.h"
+#include "core/settings.h"
+#include "yuzu/debugger/svc_profiler.h"
+
+namespace {
+enum Column {
+    COLUMN_NAME,
+    COLUMN_CALLS,
+    COLUMN_RUN_TIME,
+    COLUMN_LOCK_WAIT_TIME,
+    COLUMN_BLOCKED_TIME,
+    COLUMN_COUNT,
+};
+
+QList<QStandardItem*> MakeRow(const QString& name, const Kernel::SVCProfileEntry& entry) {
+    const auto milliseconds = [](std::chrono::nanoseconds time) {
+        return QString::number(std::chrono::duration<double, std::milli>(time).count(), 'f', 3);
+    };
+
+    QList<QStandardItem*> row{
+        new QStandardItem(name),
+        new QStandardItem(QString::number(entry.calls)),
+        new QStandardItem(milliseconds(entry.run_time)),
+        new QStandardItem(milliseconds(entry.lock_wait_time)),
+        new QStandardItem(milliseconds(entry.blocked_time)),
+    };
+    for (QStandardItem* item : row) {
+        item->setEditable(false);
+    }
+    return row;
+}
+} // Anonymous namespace
+
+SVCProfilerWidget::SVCProfilerWidget(QWidget* parent)
+    : QDockWidget(tr("SVC Profiler"), parent) {
+    setObjectName("SVCProfilerWidget");
+
+    enable_checkbox = new QCheckBox(tr("Profile SVCs"));
+    enable_checkbox->setChecked(Settings::values.profile_svcs);
+    connect(enable_checkbox, &QCheckBox::toggled,
+            [](bool checked) { Settings::values.profile_svcs = checked; });
+
+    QPushButton* reset_button = new QPushButton(tr("Reset"));
+    connect(reset_button, &QPushButton::clicked, this, &SVCProfilerWidget::Reset);
+    QPushButton* export_button = new QPushButton(tr("Export..."));
+    connect(export_button, &QPushButton::clicked, this, &SVCProfilerWidget::Export);
+
+    model = new QStandardItemModel(0, COLUMN_COUNT, this);
+    model->setHorizontalHeaderLabels({tr("SVC / Thread"), tr("Calls"), tr("Run (ms)"),
+                                      tr("Lock wait (ms)"), tr("Blocked (ms)")});
+
+    view = new QTreeView;
+    view->setModel(model);
+    view->setUniformRowHeights(true);
+    view->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+    QHBoxLayout* controls = new QHBoxLayout;
+    controls->addWidget(enable_checkbox);
+    controls->addStretch();
+    controls->addWidget(reset_button);
+    controls->addWidget(export_button);
+
+    QWidget* contents = new QWidget;
+    QVBoxLayout* layout = new QVBoxLayout(contents);
+    layout->addLayout(controls);
+    layout->addWidget(view);
+    setWidget(contents);
+
+    update_timer.setInterval(1000);
+    connect(&update_timer, &QTimer::timeout, this, &SVCProfilerWidget::Refresh);
+}
+
+SVCProfilerWidget::~SVCProfilerWidget() = default;
+
+void SVCProfilerWidget::showEvent(QShowEvent* ev) {
+    enable_checkbox->setChecked(Settings::values.profile_svcs);
+    Refresh();
+    update_timer.start();
+    QDockWidget::showEvent(ev);
+}
+
+void SVCProfilerWidget::hideEvent(QHideEvent* ev) {
+    update_timer.stop();
+    QDockWidget::hideEvent(ev);
+}
+
+void SVCProfilerWidget::Refresh() {
+    const auto entries = Kernel::SVCProfiler::GetEntries();
+    const auto totals = Kernel::SVCProfiler::GetTotals(entries);
+
+    // Keep the SVCs that were expanded open across refreshes
+    QSet<QString> expanded;
+    for (int row = 0; row < model->rowCount(); ++row) {
+        const QModelIndex index = model->index(row, COLUMN_NAME);
+        if (view->isExpanded(index)) {
+            expanded.insert(index.data().toString());
+        }
+    }
+
+    model->removeRows(0, model->rowCount());
+    for (const auto& total : totals) {
+        const QString name = QString::fromStdString(total.svc_name);
+        QList<QStandardItem*> row = MakeRow(name, total);
+        for (const auto& entry : entries) {
+            if (entry.svc_id != total.svc_id) {
+                continue;
+            }
+            const QString thread = QStringLiteral("%1 (%2)")
+                                       .arg(QString::fromStdString(entry.thread_name))
+                                       .arg(entry.thread_id);
+            row.first()->appendRow(MakeRow(thread, entry));
+        }
+        model->appendRow(row);
+
+        if (expanded.contains(name)) {
+            view->setExpanded(model->indexFromItem(row.first()), true);
+        }
+    }
+}
+
+void SVCProfilerWidget::Reset() {
+    Kernel::SVCProfiler::Reset();
+    Refresh();
+}
+
+void SVCProfilerWidget::Export() {
+    const QString path = QFileDialog::getSaveFileName(this, tr("Export SVC Profile"), QString(),
+                                                      tr("CSV (*.csv);;JSON (*.json)"));
+    if (path.isEmpty()) {
+        return;
+    }
+
+    const auto entries = Kernel::SVCProfiler::GetEntries();
+    const bool is_json = path.endsWith(QStringLiteral(".json"), Qt::CaseInsensitive);
+    const std::string profile = is_json ? Kernel::SVCProfiler::FormatJSON(entries)
+                                        : Kernel::SVCProfiler::FormatCSV(entries);
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+        file.write(profile.data(), static_cast<qint64>(profile.size())) !=
+            static_cast<qint64>(profile.size())) {
+        QMessageBox::critical(this, tr("Export SVC Profile"),
+                              tr("Failed to write the profile to %1.").arg(path));
+    }
+}
@@ -0,0 +1,37 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <QDockWidget>
+#include <QTimer>
+
+class QCheckBox;
+class QStandardItemModel;
+class QTreeView;
+
+/// Shows the statistics gathered by Kernel::SVCProfiler, per SVC and per guest thread
+class SVCProfilerWidget : public QDockWidget {
+    Q_OBJECT
+
+public:
+    explicit SVCProfilerWidget(QWidget* parent = nullptr);
+    ~SVCProfilerWidget() override;
+
+protected:
+    void showEvent(QShowEvent* ev) override;
+    void hideEvent(QHideEvent* ev) override;
+
+private:
+    void Refresh();
+    void Reset();
+    void Export();
+
+    QCheckBox* enable_checkbox;
+    QTreeView* view;
+    QStandardItemModel* model;
+
+    /// Refreshes the statistics periodically, only runs while the widget is visible
+    QTimer update_timer;
+};
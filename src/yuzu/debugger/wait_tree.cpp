@@ -2,6 +2,10 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <mutex>
+#include <typeinfo>
+
 #include "yuzu/debugger/wait_tree.h"
 #include "yuzu/util/util.h"
 
@@ -15,6 +19,7 @@
 #include "core/hle/kernel/thread.h"
 #include "core/hle/kernel/timer.h"
 #include "core/hle/kernel/wait_object.h"
+#include "core/hle/lock.h"
 
 WaitTreeItem::WaitTreeItem() = default;
 WaitTreeItem::~WaitTreeItem() = default;
@@ -27,17 +32,35 @@ std::vector<std::unique_ptr<WaitTreeItem>> WaitTreeItem::GetChildren() const {
     return {};
 }
 
+std::uintptr_t WaitTreeItem::GetIdentity() const {
+    return 0;
+}
+
 void WaitTreeItem::Expand() {
     if (IsExpandable() && !expanded) {
         children = GetChildren();
         for (std::size_t i = 0; i < children.size(); ++i) {
             children[i]->parent = this;
             children[i]->row = i;
+            children[i]->Snapshot();
         }
         expanded = true;
     }
 }
 
+void WaitTreeItem::Snapshot() {
+    text = GetText();
+    color = GetColor();
+}
+
+const QString& WaitTreeItem::CachedText() const {
+    return text;
+}
+
+const QColor& WaitTreeItem::CachedColor() const {
+    return color;
+}
+
 WaitTreeItem* WaitTreeItem::Parent() const {
     return parent;
 }
@@ -54,13 +77,14 @@ std::size_t WaitTreeItem::Row() const {
     return row;
 }
 
-std::vector<std::unique_ptr<WaitTreeThread>> WaitTreeItem::MakeThreadItemList() {
-    std::vector<std::unique_ptr<WaitTreeThread>> item_list;
+std::vector<std::unique_ptr<WaitTreeItem>> WaitTreeItem::MakeThreadItemList() {
+    std::vector<std::unique_ptr<WaitTreeItem>> item_list;
     std::size_t row = 0;
     auto add_threads = [&](const std::vector<Kernel::SharedPtr<Kernel::Thread>>& threads) {
         for (std::size_t i = 0; i < threads.size(); ++i) {
             item_list.push_back(std::make_unique<WaitTreeThread>(*threads[i]));
             item_list.back()->row = row;
+            item_list.back()->Snapshot();
             ++row;
         }
     };
@@ -107,6 +131,10 @@ std::vector<std::unique_ptr<WaitTreeItem>> WaitTreeMutexInfo::GetChildren() cons
     return list;
 }
 
+std::uintptr_t WaitTreeMutexInfo::GetIdentity() const {
+    return mutex_address;
+}
+
 WaitTreeCallstack::WaitTreeCallstack(const Kernel::Thread& thread) : thread(thread) {}
 WaitTreeCallstack::~WaitTreeCallstack() = default;
 
@@ -132,6 +160,10 @@ std::vector<std::unique_ptr<WaitTreeItem>> WaitTreeCallstack::GetChildren() cons
     return list;
 }
 
+std::uintptr_t WaitTreeCallstack::GetIdentity() const {
+    return reinterpret_cast<std::uintptr_t>(&thread);
+}
+
 WaitTreeWaitObject::WaitTreeWaitObject(const Kernel::WaitObject& o) : object(o) {}
 WaitTreeWaitObject::~WaitTreeWaitObject() = default;
 
@@ -174,6 +206,10 @@ std::vector<std::unique_ptr<WaitTreeItem>> WaitTreeWaitObject::GetChildren() con
     return list;
 }
 
+std::uintptr_t WaitTreeWaitObject::GetIdentity() const {
+    return reinterpret_cast<std::uintptr_t>(&object);
+}
+
 QString WaitTreeWaitObject::GetResetTypeQString(Kernel::ResetType reset_type) {
     switch (reset_type) {
     case Kernel::ResetType::OneShot:
@@ -187,8 +223,7 @@ QString WaitTreeWaitObject::GetResetTypeQString(Kernel::ResetType reset_type) {
     return {};
 }
 
-WaitTreeObjectList::WaitTreeObjectList(
-    const std::vector<Kernel::SharedPtr<Kernel::WaitObject>>& list, bool w_all)
+WaitTreeObjectList::WaitTreeObjectList(const Kernel::Thread::ThreadWaitObjects& list, bool w_all)
     : object_list(list), wait_all(w_all) {}
 
 WaitTreeObjectList::~WaitTreeObjectList() = default;
@@ -378,7 +413,7 @@ QModelIndex WaitTreeModel::index(int row, int column, const QModelIndex& parent)
 
     if (parent.isValid()) {
         WaitTreeItem* parent_item = static_cast<WaitTreeItem*>(parent.internalPointer());
-        parent_item->Expand();
+        ExpandItem(parent_item);
         return createIndex(row, column, parent_item->Children()[row].get());
     }
 
@@ -401,7 +436,7 @@ int WaitTreeModel::rowCount(const QModelIndex& parent) const {
         return static_cast<int>(thread_items.size());
 
     WaitTreeItem* parent_item = static_cast<WaitTreeItem*>(parent.internalPointer());
-    parent_item->Expand();
+    ExpandItem(parent_item);
     return static_cast<int>(parent_item->Children().size());
 }
 
@@ -409,26 +444,120 @@ int WaitTreeModel::columnCount(const QModelIndex&) const {
     return 1;
 }
 
+bool WaitTreeModel::hasChildren(const QModelIndex& parent) const {
+    // Answered without building the children, which only happens once the item is expanded
+    if (!parent.isValid())
+        return !thread_items.empty();
+
+    const WaitTreeItem* item = static_cast<WaitTreeItem*>(parent.internalPointer());
+    return item->IsExpandable() && (!item->Children().empty() || !is_frozen);
+}
+
 QVariant WaitTreeModel::data(const QModelIndex& index, int role) const {
     if (!index.isValid())
         return {};
 
     switch (role) {
     case Qt::DisplayRole:
-        return static_cast<WaitTreeItem*>(index.internalPointer())->GetText();
+        return static_cast<WaitTreeItem*>(index.internalPointer())->CachedText();
     case Qt::ForegroundRole:
-        return static_cast<WaitTreeItem*>(index.internalPointer())->GetColor();
+        return static_cast<WaitTreeItem*>(index.internalPointer())->CachedColor();
     default:
         return {};
     }
 }
 
-void WaitTreeModel::ClearItems() {
-    thread_items.clear();
+void WaitTreeModel::RefreshItems() {
+    std::lock_guard<std::recursive_mutex> lock(HLE::g_hle_lock);
+    is_frozen = false;
+    UpdateItems(nullptr, {}, thread_items, WaitTreeItem::MakeThreadItemList());
+}
+
+void WaitTreeModel::FreezeItems() {
+    is_frozen = true;
+}
+
+void WaitTreeModel::ExpandItem(WaitTreeItem* item) const {
+    if (is_frozen)
+        return;
+
+    std::lock_guard<std::recursive_mutex> lock(HLE::g_hle_lock);
+    item->Expand();
 }
 
-void WaitTreeModel::InitItems() {
-    thread_items = WaitTreeItem::MakeThreadItemList();
+void WaitTreeModel::UpdateItems(WaitTreeItem* parent_item, const QModelIndex& parent_index,
+                                std::vector<std::unique_ptr<WaitTreeItem>>& items,
+                                std::vector<std::unique_ptr<WaitTreeItem>> new_items) {
+    const auto renumber = [&](std::size_t first) {
+        for (std::size_t i = first; i < items.size(); ++i) {
+            items[i]->row = i;
+        }
+    };
+
+    // Walk both lists in order, keeping the items that are still there and inserting or removing
+    // rows around them. Kernel lists keep their order, so this matches nearly every item.
+    for (std::size_t row = 0; row < new_items.size(); ++row) {
+        auto& new_item = new_items[row];
+        new_item->parent = parent_item;
+        new_item->row = row;
+        new_item->Snapshot();
+
+        const auto match =
+            std::find_if(items.begin() + row, items.end(), [&new_item](const auto& item) {
+                return typeid(*item) == typeid(*new_item) &&
+                       item->GetIdentity() == new_item->GetIdentity();
+            });
+        const int first = static_cast<int>(row);
+        if (match == items.end()) {
+            beginInsertRows(parent_index, first, first);
+            items.insert(items.begin() + row, std::move(new_item));
+            renumber(row);
+            endInsertRows();
+            continue;
+        }
+
+        const auto num_removed = static_cast<int>(std::distance(items.begin() + row, match));
+        if (num_removed > 0) {
+            beginRemoveRows(parent_index, first, first + num_removed - 1);
+            items.erase(items.begin() + row, match);
+            renumber(row);
+            endRemoveRows();
+        }
+        ReplaceItem(items[row], std::move(new_item));
+    }
+
+    if (items.size() > new_items.size()) {
+        beginRemoveRows(parent_index, static_cast<int>(new_items.size()),
+                        static_cast<int>(items.size() - 1));
+        items.resize(new_items.size());
+        endRemoveRows();
+    }
+}
+
+void WaitTreeModel::ReplaceItem(std::unique_ptr<WaitTreeItem>& item,
+                                std::unique_ptr<WaitTreeItem> new_item) {
+    const int row = static_cast<int>(item->row);
+    const bool changed = item->text != new_item->text || item->color != new_item->color;
+
+    // Children that were shown are carried over, and refreshed below, so the view keeps them open
+    if (item->expanded) {
+        new_item->expanded = true;
+        new_item->children = std::move(item->children);
+        for (auto& child : new_item->children) {
+            child->parent = new_item.get();
+        }
+    }
+
+    const QModelIndex index = createIndex(row, 0, new_item.get());
+    changePersistentIndex(createIndex(row, 0, item.get()), index);
+    item = std::move(new_item);
+
+    if (changed) {
+        emit dataChanged(index, index);
+    }
+    if (item->expanded) {
+        UpdateItems(item.get(), index, item->children, item->GetChildren());
+    }
 }
 
 WaitTreeWidget::WaitTreeWidget(QWidget* parent) : QDockWidget(tr("Wait Tree"), parent) {
@@ -444,15 +573,13 @@ WaitTreeWidget::~WaitTreeWidget() = default;
 void WaitTreeWidget::OnDebugModeEntered() {
     if (!Core::System::GetInstance().IsPoweredOn())
         return;
-    model->InitItems();
-    view->setModel(model);
+    model->RefreshItems();
     setEnabled(true);
 }
 
 void WaitTreeWidget::OnDebugModeLeft() {
     setEnabled(false);
-    view->setModel(nullptr);
-    model->ClearItems();
+    model->FreezeItems();
 }
 
 void WaitTreeWidget::OnEmulationStarting(EmuThread* emu_thread) {
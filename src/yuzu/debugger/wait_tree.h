@@ -5,6 +5,7 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <vector>
 
@@ -14,6 +15,7 @@
 #include <boost/container/flat_set.hpp>
 #include "common/common_types.h"
 #include "core/hle/kernel/object.h"
+#include "core/hle/kernel/thread.h"
 
 class EmuThread;
 
@@ -36,18 +38,29 @@ public:
     virtual std::vector<std::unique_ptr<WaitTreeItem>> GetChildren() const;
     virtual QString GetText() const = 0;
     virtual QColor GetColor() const;
+    /// Tells apart the siblings of the same type, so that refreshes can match them to the new state
+    virtual std::uintptr_t GetIdentity() const;
 
     void Expand();
     WaitTreeItem* Parent() const;
     const std::vector<std::unique_ptr<WaitTreeItem>>& Children() const;
     std::size_t Row() const;
-    static std::vector<std::unique_ptr<WaitTreeThread>> MakeThreadItemList();
+    /// Text and color of the item at the time it was created, which are safe to show at any time
+    const QString& CachedText() const;
+    const QColor& CachedColor() const;
+    static std::vector<std::unique_ptr<WaitTreeItem>> MakeThreadItemList();
 
 private:
+    friend class WaitTreeModel;
+
+    void Snapshot();
+
     std::size_t row;
     bool expanded = false;
     WaitTreeItem* parent = nullptr;
     std::vector<std::unique_ptr<WaitTreeItem>> children;
+    QString text;
+    QColor color;
 };
 
 class WaitTreeText : public WaitTreeItem {
@@ -79,6 +92,7 @@ public:
 
     QString GetText() const override;
     std::vector<std::unique_ptr<WaitTreeItem>> GetChildren() const override;
+    std::uintptr_t GetIdentity() const override;
 
 private:
     VAddr mutex_address;
@@ -95,6 +109,7 @@ public:
 
     QString GetText() const override;
     std::vector<std::unique_ptr<WaitTreeItem>> GetChildren() const override;
+    std::uintptr_t GetIdentity() const override;
 
 private:
     const Kernel::Thread& thread;
@@ -109,6 +124,7 @@ public:
     static std::unique_ptr<WaitTreeWaitObject> make(const Kernel::WaitObject& object);
     QString GetText() const override;
     std::vector<std::unique_ptr<WaitTreeItem>> GetChildren() const override;
+    std::uintptr_t GetIdentity() const override;
 
 protected:
     const Kernel::WaitObject& object;
@@ -119,15 +135,14 @@ protected:
 class WaitTreeObjectList : public WaitTreeExpandableItem {
     Q_OBJECT
 public:
-    WaitTreeObjectList(const std::vector<Kernel::SharedPtr<Kernel::WaitObject>>& list,
-                       bool wait_all);
+    WaitTreeObjectList(const Kernel::Thread::ThreadWaitObjects& list, bool wait_all);
     ~WaitTreeObjectList() override;
 
     QString GetText() const override;
     std::vector<std::unique_ptr<WaitTreeItem>> GetChildren() const override;
 
 private:
-    const std::vector<Kernel::SharedPtr<Kernel::WaitObject>>& object_list;
+    const Kernel::Thread::ThreadWaitObjects& object_list;
     bool wait_all;
 };
 
@@ -185,12 +200,26 @@ public:
     QModelIndex parent(const QModelIndex& index) const override;
     int rowCount(const QModelIndex& parent) const override;
     int columnCount(const QModelIndex& parent) const override;
+    bool hasChildren(const QModelIndex& parent) const override;
+
+    /**
+     * Updates the items to the current state of the kernel while emulation is paused. Only the rows
+     * that changed are updated, and the items that were expanded stay expanded.
+     */
+    void RefreshItems();
 
-    void ClearItems();
-    void InitItems();
+    /// Stops building the children of items, which would read the kernel state while it runs
+    void FreezeItems();
 
 private:
-    std::vector<std::unique_ptr<WaitTreeThread>> thread_items;
+    void UpdateItems(WaitTreeItem* parent_item, const QModelIndex& parent_index,
+                     std::vector<std::unique_ptr<WaitTreeItem>>& items,
+                     std::vector<std::unique_ptr<WaitTreeItem>> new_items);
+    void ReplaceItem(std::unique_ptr<WaitTreeItem>& item, std::unique_ptr<WaitTreeItem> new_item);
+    void ExpandItem(WaitTreeItem* item) const;
+
+    std::vector<std::unique_ptr<WaitTreeItem>> thread_items;
+    bool is_frozen = true;
 };
 
 class WaitTreeWidget : public QDockWidget {
@@ -21,6 +21,7 @@
 #include "core/file_sys/patch_manager.h"
 #include "yuzu/compatibility_list.h"
 #include "yuzu/game_list.h"
+#include "yuzu/game_list_icon_cache.h"
 #include "yuzu/game_list_p.h"
 #include "yuzu/game_list_worker.h"
 #include "yuzu/main.h"
@@ -234,9 +235,18 @@ GameList::GameList(FileSys::VirtualFilesystem vfs, GMainWindow* parent)
     connect(tree_view, &QTreeView::activated, this, &GameList::ValidateEntry);
     connect(tree_view, &QTreeView::customContextMenuRequested, this, &GameList::PopupContextMenu);
 
+    icon_cache = new GameListIconCache(
+        QString::fromStdString(FileUtil::GetUserPath(FileUtil::UserPath::CacheDir) +
+                               "game_list_icons" DIR_SEP),
+        this);
+    // The visible rows ask for their icons again when they're repainted
+    connect(icon_cache, &GameListIconCache::IconLoaded, this,
+            [this] { tree_view->viewport()->update(); });
+
     // We must register all custom types with the Qt Automoc system so that we are able to use it
     // with signals/slots. In this case, QList falls under the umbrells of custom types.
     qRegisterMetaType<QList<QStandardItem*>>("QList<QStandardItem*>");
+    qRegisterMetaType<QList<QList<QStandardItem*>>>("QList<QList<QStandardItem*>>");
 
     layout->setContentsMargins(0, 0, 0, 0);
     layout->setSpacing(0);
@@ -263,8 +273,10 @@ void GameList::clearFilter() {
     search_field->clear();
 }
 
-void GameList::AddEntry(const QList<QStandardItem*>& entry_items) {
-    item_model->invisibleRootItem()->appendRow(entry_items);
+void GameList::AddEntries(const QList<QList<QStandardItem*>>& entries) {
+    for (const auto& entry_items : entries) {
+        item_model->invisibleRootItem()->appendRow(entry_items);
+    }
 }
 
 void GameList::ValidateEntry(const QModelIndex& item) {
@@ -399,9 +411,11 @@ void GameList::PopulateAsync(const QString& dir_path, bool deep_scan) {
 
     emit ShouldCancelWorker();
 
-    GameListWorker* worker = new GameListWorker(vfs, dir_path, deep_scan, compatibility_list);
+    GameListWorker* worker =
+        new GameListWorker(vfs, dir_path, deep_scan, compatibility_list, icon_cache);
 
-    connect(worker, &GameListWorker::EntryReady, this, &GameList::AddEntry, Qt::QueuedConnection);
+    connect(worker, &GameListWorker::EntriesReady, this, &GameList::AddEntries,
+            Qt::QueuedConnection);
     connect(worker, &GameListWorker::Finished, this, &GameList::DonePopulating,
             Qt::QueuedConnection);
     // Use DirectConnection here because worker->Cancel() is thread-safe and we want it to cancel
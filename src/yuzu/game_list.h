@@ -21,6 +21,7 @@
 #include "common/common_types.h"
 #include "yuzu/compatibility_list.h"
 
+class GameListIconCache;
 class GameListWorker;
 class GMainWindow;
 
@@ -97,7 +98,7 @@ private slots:
     void onFilterCloseClicked();
 
 private:
-    void AddEntry(const QList<QStandardItem*>& entry_items);
+    void AddEntries(const QList<QList<QStandardItem*>>& entries);
     void ValidateEntry(const QModelIndex& item);
     void DonePopulating(QStringList watch_list);
 
@@ -111,6 +112,7 @@ private:
     QTreeView* tree_view = nullptr;
     QStandardItemModel* item_model = nullptr;
     GameListWorker* current_worker = nullptr;
+    GameListIconCache* icon_cache = nullptr;
     QFileSystemWatcher* watcher = nullptr;
     CompatibilityList compatibility_list;
 };
@@ -0,0 +1,104 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+
+#include "common/logging/log.h"
+#include "core/loader/loader.h"
+#include "yuzu/game_list_cache.h"
+
+namespace {
+QByteArray ToByteArray(const std::vector<u8>& data) {
+    return QByteArray(reinterpret_cast<const char*>(data.data()), static_cast<int>(data.size()));
+}
+
+std::vector<u8> FromByteArray(const QByteArray& data) {
+    return std::vector<u8>(data.begin(), data.end());
+}
+} // Anonymous namespace
+
+GameListCache::GameListCache(QString file_path_) : file_path(std::move(file_path_)) {
+    QFile file(file_path);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    QDataStream stream(&file);
+    quint32 magic = 0;
+    quint32 version = 0;
+    stream >> magic >> version;
+    if (magic != MAGIC || version != VERSION) {
+        LOG_INFO(Frontend, "Ignoring outdated game list cache at {}", file_path.toStdString());
+        return;
+    }
+
+    quint32 count = 0;
+    stream >> count;
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QString path;
+        Record record{};
+        QString name;
+        QByteArray icon;
+        quint64 program_id = 0;
+        quint32 file_type = 0;
+        stream >> path >> record.size >> record.last_modified >> program_id >> name >> icon >>
+            file_type >> record.entry.romfs_updatable;
+
+        record.entry.program_id = program_id;
+        record.entry.name = name.toStdString();
+        record.entry.icon = FromByteArray(icon);
+        record.entry.file_type = static_cast<Loader::FileType>(file_type);
+        records.insert(path, std::move(record));
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        LOG_WARNING(Frontend, "Game list cache at {} is corrupted", file_path.toStdString());
+        records.clear();
+    }
+}
+
+const GameListCacheEntry* GameListCache::Find(const QFileInfo& file_info) {
+    const auto iter = records.find(file_info.absoluteFilePath());
+    if (iter == records.end() || iter->size != file_info.size() ||
+        iter->last_modified != file_info.lastModified().toMSecsSinceEpoch()) {
+        return nullptr;
+    }
+
+    iter->used = true;
+    return &iter->entry;
+}
+
+void GameListCache::Insert(const QFileInfo& file_info, GameListCacheEntry entry) {
+    records.insert(file_info.absoluteFilePath(),
+                   {file_info.size(), file_info.lastModified().toMSecsSinceEpoch(),
+                    std::move(entry), true});
+}
+
+void GameListCache::Save() const {
+    QFile file(file_path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        LOG_ERROR(Frontend, "Could not write the game list cache to {}", file_path.toStdString());
+        return;
+    }
+
+    // Files that weren't seen by the scan were removed or are outside of the game directory
+    quint32 count = 0;
+    for (const auto& record : records) {
+        count += record.used ? 1 : 0;
+    }
+
+    QDataStream stream(&file);
+    stream << MAGIC << VERSION << count;
+    for (auto iter = records.begin(); iter != records.end(); ++iter) {
+        if (!iter->used)
+            continue;
+        const auto& entry = iter->entry;
+        stream << iter.key() << iter->size << iter->last_modified
+               << static_cast<quint64>(entry.program_id) << QString::fromStdString(entry.name) << ToByteArray(entry.icon)
+               << static_cast<quint32>(entry.file_type) << entry.romfs_updatable;
+    }
+}
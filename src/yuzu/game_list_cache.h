@@ -0,0 +1,60 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <QHash>
+#include <QString>
+
+#include "common/common_types.h"
+
+class QFileInfo;
+
+namespace Loader {
+enum class FileType;
+} // namespace Loader
+
+/// The metadata the game list shows for a file, as read by its loader.
+struct GameListCacheEntry {
+    u64 program_id = 0;
+    std::string name;
+    std::vector<u8> icon;
+    Loader::FileType file_type{};
+    bool romfs_updatable = true;
+};
+
+/**
+ * A persistent cache of game list metadata, keyed by the path, size and modification time of each
+ * file, so that populating the game list only opens and parses the files that changed.
+ */
+class GameListCache {
+public:
+    /// Loads the cache from file_path, starting empty if it doesn't exist or is outdated.
+    explicit GameListCache(QString file_path);
+
+    /// Returns the entry for the file, or nullptr if the file changed since it was cached.
+    const GameListCacheEntry* Find(const QFileInfo& file_info);
+
+    void Insert(const QFileInfo& file_info, GameListCacheEntry entry);
+
+    /// Writes the entries that were found or inserted since the cache was loaded back to disk.
+    void Save() const;
+
+private:
+    struct Record {
+        qint64 size;
+        qint64 last_modified;
+        GameListCacheEntry entry;
+        bool used;
+    };
+
+    static constexpr u32 MAGIC = 0x43474C59; // "YLGC"
+    static constexpr u32 VERSION = 1;
+
+    QString file_path;
+    QHash<QString, Record> records;
+};
@@ -0,0 +1,101 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <utility>
+
+#include <QDir>
+#include <QFileInfo>
+#include <QRunnable>
+
+#include "common/logging/log.h"
+#include "yuzu/game_list_icon_cache.h"
+#include "yuzu/ui_settings.h"
+
+namespace {
+/// Loads an icon from its thumbnail, or decodes and scales it and then writes the thumbnail.
+class IconLoader : public QRunnable {
+public:
+    IconLoader(GameListIconCache* cache, QString key, QString thumbnail_path,
+               std::vector<u8> icon_data, int size, bool write_thumbnail)
+        : cache(cache), key(std::move(key)), thumbnail_path(std::move(thumbnail_path)),
+          icon_data(std::move(icon_data)), size(size), write_thumbnail(write_thumbnail) {}
+
+    void run() override {
+        QImage image;
+        if (!thumbnail_path.isEmpty() && image.load(thumbnail_path) &&
+            image.size() == QSize(size, size)) {
+            emit cache->IconDecoded(key, image);
+            return;
+        }
+
+        if (!image.loadFromData(icon_data.data(), static_cast<int>(icon_data.size()))) {
+            // Broken icons show as an empty one, without a thumbnail so that they're retried
+            image = QImage(size, size, QImage::Format_ARGB32_Premultiplied);
+            image.fill(Qt::transparent);
+            emit cache->IconDecoded(key, image);
+            return;
+        }
+
+        image = image.scaled(size, size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        if (write_thumbnail && (!QDir().mkpath(QFileInfo(thumbnail_path).path()) ||
+                                !image.save(thumbnail_path, "PNG"))) {
+            LOG_WARNING(Frontend, "Could not write the icon thumbnail {}",
+                        thumbnail_path.toStdString());
+        }
+        emit cache->IconDecoded(key, image);
+    }
+
+private:
+    GameListIconCache* cache;
+    QString key;
+    QString thumbnail_path;
+    std::vector<u8> icon_data;
+    int size;
+    bool write_thumbnail;
+};
+} // Anonymous namespace
+
+GameListIconCache::GameListIconCache(QString cache_dir_, QObject* parent)
+    : QObject(parent), cache_dir(std::move(cache_dir_)) {
+    // Decoding is kept to a couple of threads, so that scrolling doesn't starve the emulator
+    pool.setMaxThreadCount(2);
+    connect(this, &GameListIconCache::IconDecoded, this, &GameListIconCache::OnIconDecoded,
+            Qt::QueuedConnection);
+}
+
+GameListIconCache::~GameListIconCache() {
+    pool.clear();
+    pool.waitForDone();
+}
+
+QPixmap GameListIconCache::Request(u64 program_id, u64 icon_hash,
+                                   const std::vector<u8>& icon_data, u32 size) {
+    const QString key = QStringLiteral("%1/%2_%3.png")
+                            .arg(size)
+                            .arg(static_cast<qulonglong>(program_id), 16, 16, QLatin1Char('0'))
+                            .arg(static_cast<qulonglong>(icon_hash), 16, 16, QLatin1Char('0'));
+    const auto iter = icons.constFind(key);
+    if (iter != icons.constEnd())
+        return *iter;
+
+    if (pending.contains(key))
+        return {};
+    pending.insert(key);
+
+    // The thumbnails follow the game list cache, without it icons are decoded on every start
+    const bool use_thumbnails = UISettings::values.cache_game_list;
+    QString thumbnail_path;
+    if (use_thumbnails) {
+        thumbnail_path = cache_dir + key;
+    }
+    pool.start(new IconLoader(this, key, thumbnail_path, icon_data, static_cast<int>(size),
+                              use_thumbnails));
+    return {};
+}
+
+void GameListIconCache::OnIconDecoded(const QString& key, const QImage& image) {
+    pending.remove(key);
+    icons.insert(key, QPixmap::fromImage(image));
+    emit IconLoaded();
+}
@@ -0,0 +1,52 @@
+// Copyright 2018 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <vector>
+
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QPixmap>
+#include <QSet>
+#include <QString>
+#include <QThreadPool>
+
+#include "common/common_types.h"
+
+/**
+ * Loads the icons of the game list on threads of its own, scaled to the icon size, and keeps them
+ * in memory and as thumbnails on disk. Icons are keyed by the program ID of their title and a hash
+ * of their data, so a thumbnail is only decoded again when an update ships a different icon.
+ */
+class GameListIconCache : public QObject {
+    Q_OBJECT
+
+public:
+    /// Thumbnails are stored in cache_dir, in a subdirectory for each icon size.
+    explicit GameListIconCache(QString cache_dir, QObject* parent = nullptr);
+    ~GameListIconCache() override;
+
+    /**
+     * Returns the icon if it's loaded. Otherwise starts loading it, from its thumbnail or by
+     * decoding icon_data, and returns a null pixmap until IconLoaded is emitted. GUI thread only.
+     */
+    QPixmap Request(u64 program_id, u64 icon_hash, const std::vector<u8>& icon_data, u32 size);
+
+signals:
+    /// Emitted once icons that were requested can be returned by Request.
+    void IconLoaded();
+
+    /// Emitted by the loading threads with the scaled icon.
+    void IconDecoded(QString key, QImage image);
+
+private:
+    void OnIconDecoded(const QString& key, const QImage& image);
+
+    QString cache_dir;
+    QHash<QString, QPixmap> icons;
+    QSet<QString> pending;
+    QThreadPool pool;
+};
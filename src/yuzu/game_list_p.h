@@ -10,6 +10,7 @@
 #include <string>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include <QCoreApplication>
 #include <QImage>
@@ -18,8 +19,10 @@
 #include <QString>
 
 #include "common/common_types.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/string_util.h"
+#include "yuzu/game_list_icon_cache.h"
 #include "yuzu/ui_settings.h"
 #include "yuzu/util/util.h"
 
@@ -56,24 +59,38 @@ public:
 
     GameListItemPath() = default;
     GameListItemPath(const QString& game_path, const std::vector<u8>& picture_data,
-                     const QString& game_name, const QString& game_type, u64 program_id) {
+                     const QString& game_name, const QString& game_type, u64 program_id,
+                     GameListIconCache* icon_cache)
+        : picture_data(picture_data),
+          picture_hash(Common::ComputeHash64(picture_data.data(), picture_data.size())),
+          icon_cache(icon_cache) {
         setData(game_path, FullPathRole);
         setData(game_name, TitleRole);
         setData(qulonglong(program_id), ProgramIdRole);
         setData(game_type, FileTypeRole);
-
-        const u32 size = UISettings::values.icon_size;
-
-        QPixmap picture;
-        if (!picture.loadFromData(picture_data.data(), static_cast<u32>(picture_data.size()))) {
-            picture = GetDefaultIcon(size);
-        }
-        picture = picture.scaled(size, size);
-
-        setData(picture, Qt::DecorationRole);
     }
 
     QVariant data(int role) const override {
+        if (role == Qt::DecorationRole) {
+            // Icons are requested the first time the item is drawn, so only the rows that are
+            // scrolled into view are ever loaded. The icon cache decodes them off the GUI thread.
+            if (!icon.isValid()) {
+                const u32 size = UISettings::values.icon_size;
+                if (picture_data.empty()) {
+                    icon = GetDefaultIcon(size);
+                    return icon;
+                }
+
+                const QPixmap picture = icon_cache->Request(
+                    data(ProgramIdRole).toULongLong(), picture_hash, picture_data, size);
+                if (picture.isNull())
+                    return GetDefaultIcon(size);
+                icon = picture;
+                picture_data = {};
+            }
+            return icon;
+        }
+
         if (role == Qt::DisplayRole) {
             std::string filename;
             Common::SplitPath(data(FullPathRole).toString().toStdString(), nullptr, &filename,
@@ -99,6 +116,12 @@ public:
 
         return GameListItem::data(role);
     }
+
+private:
+    mutable std::vector<u8> picture_data;
+    u64 picture_hash = 0;
+    GameListIconCache* icon_cache = nullptr;
+    mutable QVariant icon;
 };
 
 class GameListItemCompat : public GameListItem {
@@ -2,13 +2,18 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <condition_variable>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include <QDir>
 #include <QFileInfo>
+#include <QRunnable>
+#include <QThreadPool>
 
 #include "common/common_paths.h"
 #include "common/file_util.h"
@@ -22,6 +27,7 @@
 #include "core/loader/loader.h"
 #include "yuzu/compatibility_list.h"
 #include "yuzu/game_list.h"
+#include "yuzu/game_list_cache.h"
 #include "yuzu/game_list_p.h"
 #include "yuzu/game_list_worker.h"
 #include "yuzu/ui_settings.h"
@@ -74,12 +80,25 @@ QString FormatPatchNameVersions(const FileSys::PatchManager& patch_manager, bool
     out.chop(1);
     return out;
 }
+
+class FunctionRunnable : public QRunnable {
+public:
+    explicit FunctionRunnable(std::function<void()> function) : function(std::move(function)) {}
+
+    void run() override {
+        function();
+    }
+
+private:
+    std::function<void()> function;
+};
 } // Anonymous namespace
 
 GameListWorker::GameListWorker(FileSys::VirtualFilesystem vfs, QString dir_path, bool deep_scan,
-                               const CompatibilityList& compatibility_list)
+                               const CompatibilityList& compatibility_list,
+                               GameListIconCache* icon_cache)
     : vfs(std::move(vfs)), dir_path(std::move(dir_path)), deep_scan(deep_scan),
-      compatibility_list(compatibility_list) {}
+      compatibility_list(compatibility_list), icon_cache(icon_cache) {}
 
 GameListWorker::~GameListWorker() = default;
 
@@ -111,11 +130,11 @@ void GameListWorker::AddInstalledTitlesToGameList() {
         if (it != compatibility_list.end())
             compatibility = it->second.first;
 
-        emit EntryReady({
+        PushEntry({
             new GameListItemPath(
                 FormatGameName(file->GetFullPath()), icon, QString::fromStdString(name),
                 QString::fromStdString(Loader::GetFileTypeString(loader->GetFileType())),
-                program_id),
+                program_id, icon_cache),
             new GameListItemCompat(compatibility),
             new GameListItem(FormatPatchNameVersions(patch)),
             new GameListItem(
@@ -147,8 +166,9 @@ void GameListWorker::FillControlMap(const std::string& dir_path) {
         if (!is_dir && file_info.suffix().toStdString() == "nca") {
             auto nca =
                 std::make_shared<FileSys::NCA>(vfs->OpenFile(physical_name, FileSys::Mode::Read));
+            // Installed titles are read first and take priority over the game directory
             if (nca->GetType() == FileSys::NCAContentType::Control)
-                nca_control_map.insert_or_assign(nca->GetTitleId(), nca);
+                nca_control_map.emplace(nca->GetTitleId(), nca);
         }
         return true;
     };
@@ -156,9 +176,40 @@ void GameListWorker::FillControlMap(const std::string& dir_path) {
     FileUtil::ForeachDirectoryEntry(nullptr, dir_path, nca_control_callback);
 }
 
-void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsigned int recursion) {
-    const auto callback = [this, recursion](u64* num_entries_out, const std::string& directory,
-                                            const std::string& virtual_name) -> bool {
+bool GameListWorker::ReadGameListEntry(const FileSys::VirtualFile& file,
+                                       GameListCacheEntry& entry) {
+    std::unique_ptr<Loader::AppLoader> loader = Loader::GetLoader(file);
+    if (!loader)
+        return false;
+
+    entry.file_type = loader->GetFileType();
+    entry.romfs_updatable = loader->IsRomFSUpdatable();
+
+    const auto res1 = loader->ReadIcon(entry.icon);
+    const auto res2 = loader->ReadProgramId(entry.program_id);
+
+    entry.name = " ";
+    const auto res3 = loader->ReadTitle(entry.name);
+
+    if (res1 != Loader::ResultStatus::Success && res3 != Loader::ResultStatus::Success &&
+        res2 == Loader::ResultStatus::Success) {
+        // Use from metadata pool. The control NCAs are shared by all the parsing threads.
+        std::lock_guard<std::mutex> lock{control_map_mutex};
+        if (nca_control_map.find(entry.program_id) != nca_control_map.end()) {
+            const FileSys::PatchManager patch{entry.program_id};
+            const auto nca = nca_control_map[entry.program_id];
+            GetMetadataFromControlNCA(patch, nca, entry.icon, entry.name);
+        }
+    }
+
+    return true;
+}
+
+void GameListWorker::ScanGameDirectory(const std::string& dir_path, unsigned int recursion,
+                                       std::vector<std::string>& game_files) {
+    const auto callback = [this, recursion, &game_files](u64* num_entries_out,
+                                                         const std::string& directory,
+                                                         const std::string& virtual_name) -> bool {
         std::string physical_name = directory + DIR_SEP + virtual_name;
 
         if (stop_processing)
@@ -167,54 +218,10 @@ void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsign
         bool is_dir = FileUtil::IsDirectory(physical_name);
         if (!is_dir &&
             (HasSupportedFileExtension(physical_name) || IsExtractedNCAMain(physical_name))) {
-            std::unique_ptr<Loader::AppLoader> loader =
-                Loader::GetLoader(vfs->OpenFile(physical_name, FileSys::Mode::Read));
-            if (!loader || ((loader->GetFileType() == Loader::FileType::Unknown ||
-                             loader->GetFileType() == Loader::FileType::Error) &&
-                            !UISettings::values.show_unknown))
-                return true;
-
-            std::vector<u8> icon;
-            const auto res1 = loader->ReadIcon(icon);
-
-            u64 program_id = 0;
-            const auto res2 = loader->ReadProgramId(program_id);
-
-            std::string name = " ";
-            const auto res3 = loader->ReadTitle(name);
-
-            const FileSys::PatchManager patch{program_id};
-
-            if (res1 != Loader::ResultStatus::Success && res3 != Loader::ResultStatus::Success &&
-                res2 == Loader::ResultStatus::Success) {
-                // Use from metadata pool.
-                if (nca_control_map.find(program_id) != nca_control_map.end()) {
-                    const auto nca = nca_control_map[program_id];
-                    GetMetadataFromControlNCA(patch, nca, icon, name);
-                }
-            }
-
-            auto it = FindMatchingCompatibilityEntry(compatibility_list, program_id);
-
-            // The game list uses this as compatibility number for untested games
-            QString compatibility("99");
-            if (it != compatibility_list.end())
-                compatibility = it->second.first;
-
-            emit EntryReady({
-                new GameListItemPath(
-                    FormatGameName(physical_name), icon, QString::fromStdString(name),
-                    QString::fromStdString(Loader::GetFileTypeString(loader->GetFileType())),
-                    program_id),
-                new GameListItemCompat(compatibility),
-                new GameListItem(FormatPatchNameVersions(patch, loader->IsRomFSUpdatable())),
-                new GameListItem(
-                    QString::fromStdString(Loader::GetFileTypeString(loader->GetFileType()))),
-                new GameListItemSize(FileUtil::GetSize(physical_name)),
-            });
+            game_files.push_back(std::move(physical_name));
         } else if (is_dir && recursion > 0) {
             watch_list.append(QString::fromStdString(physical_name));
-            AddFstEntriesToGameList(physical_name, recursion - 1);
+            ScanGameDirectory(physical_name, recursion - 1, game_files);
         }
 
         return true;
@@ -223,13 +230,144 @@ void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsign
     FileUtil::ForeachDirectoryEntry(nullptr, dir_path, callback);
 }
 
+void GameListWorker::AddFstEntry(const std::string& physical_name,
+                                 const GameListCacheEntry& entry) {
+    if ((entry.file_type == Loader::FileType::Unknown ||
+         entry.file_type == Loader::FileType::Error) &&
+        !UISettings::values.show_unknown)
+        return;
+
+    const FileSys::PatchManager patch{entry.program_id};
+
+    auto it = FindMatchingCompatibilityEntry(compatibility_list, entry.program_id);
+
+    // The game list uses this as compatibility number for untested games
+    QString compatibility("99");
+    if (it != compatibility_list.end())
+        compatibility = it->second.first;
+
+    const auto file_type = QString::fromStdString(Loader::GetFileTypeString(entry.file_type));
+    PushEntry({
+        new GameListItemPath(FormatGameName(physical_name), entry.icon,
+                             QString::fromStdString(entry.name), file_type, entry.program_id,
+                             icon_cache),
+        new GameListItemCompat(compatibility),
+        new GameListItem(FormatPatchNameVersions(patch, entry.romfs_updatable)),
+        new GameListItem(file_type),
+        new GameListItemSize(FileUtil::GetSize(physical_name)),
+    });
+}
+
+void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsigned int recursion) {
+    std::vector<std::string> game_files;
+    ScanGameDirectory(dir_path, recursion, game_files);
+
+    struct ParseResult {
+        std::size_t index;
+        bool valid;
+        GameListCacheEntry entry;
+    };
+
+    std::mutex results_mutex;
+    std::condition_variable results_ready;
+    std::vector<ParseResult> results;
+    std::size_t pending = 0;
+
+    // The global pool is running this worker, so the files are parsed on a pool of their own
+    QThreadPool parse_pool;
+
+    for (std::size_t i = 0; i < game_files.size() && !stop_processing; ++i) {
+        const QFileInfo file_info(QString::fromStdString(game_files[i]));
+        if (cache != nullptr) {
+            if (const auto* cached = cache->Find(file_info)) {
+                AddFstEntry(game_files[i], *cached);
+                continue;
+            }
+        }
+
+        // The control NCAs in the game directory are only needed by files that are missing their
+        // own metadata, so they're only read when some file has to be parsed.
+        if (!control_map_filled) {
+            FillControlMap(dir_path);
+            control_map_filled = true;
+        }
+
+        // Opening files goes through the VFS' shared file cache, so it stays on this thread.
+        // Parsing them only touches the file itself.
+        auto file = vfs->OpenFile(game_files[i], FileSys::Mode::Read);
+        ++pending;
+        parse_pool.start(new FunctionRunnable([this, i, file = std::move(file), &results_mutex,
+                                               &results_ready, &results] {
+            ParseResult result{i, false, {}};
+            if (!stop_processing)
+                result.valid = ReadGameListEntry(file, result.entry);
+
+            std::lock_guard<std::mutex> lock{results_mutex};
+            results.push_back(std::move(result));
+            results_ready.notify_one();
+        }));
+    }
+    FlushEntries();
+
+    // Entries are added as their files finish parsing, in batches of whatever is ready
+    std::vector<ParseResult> finished;
+    while (pending > 0 && !stop_processing) {
+        {
+            std::unique_lock<std::mutex> lock{results_mutex};
+            results_ready.wait(lock, [&results] { return !results.empty(); });
+            finished.swap(results);
+        }
+
+        for (auto& result : finished) {
+            --pending;
+            if (!result.valid)
+                continue;
+
+            const auto& physical_name = game_files[result.index];
+            if (cache != nullptr)
+                cache->Insert(QFileInfo(QString::fromStdString(physical_name)), result.entry);
+            AddFstEntry(physical_name, result.entry);
+        }
+        finished.clear();
+        FlushEntries();
+    }
+
+    parse_pool.waitForDone();
+}
+
+void GameListWorker::PushEntry(QList<QStandardItem*> entry_items) {
+    pending_entries.append(std::move(entry_items));
+    if (pending_entries.size() >= ENTRY_BATCH_SIZE)
+        FlushEntries();
+}
+
+void GameListWorker::FlushEntries() {
+    if (pending_entries.isEmpty())
+        return;
+    emit EntriesReady(pending_entries);
+    pending_entries.clear();
+}
+
 void GameListWorker::run() {
     stop_processing = false;
     watch_list.append(dir_path);
-    FillControlMap(dir_path.toStdString());
+    if (UISettings::values.cache_game_list) {
+        const auto cache_dir = FileUtil::GetUserPath(FileUtil::UserPath::CacheDir);
+        FileUtil::CreateFullPath(cache_dir);
+        cache =
+            std::make_unique<GameListCache>(QString::fromStdString(cache_dir + "game_list.bin"));
+    }
+
+    control_map_filled = false;
     AddInstalledTitlesToGameList();
+    FlushEntries();
     AddFstEntriesToGameList(dir_path.toStdString(), deep_scan ? 256 : 0);
     nca_control_map.clear();
+
+    // A cancelled scan didn't see every file, saving it would drop the ones it missed
+    if (cache && !stop_processing)
+        cache->Save();
+    cache.reset();
     emit Finished(watch_list);
 }
 
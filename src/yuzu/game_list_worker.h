@@ -7,8 +7,10 @@
 #include <atomic>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <QList>
 #include <QObject>
@@ -18,10 +20,14 @@
 #include "common/common_types.h"
 #include "yuzu/compatibility_list.h"
 
+class GameListCache;
+class GameListIconCache;
 class QStandardItem;
+struct GameListCacheEntry;
 
 namespace FileSys {
 class NCA;
+class VfsFile;
 class VfsFilesystem;
 } // namespace FileSys
 
@@ -34,7 +40,7 @@ class GameListWorker : public QObject, public QRunnable {
 
 public:
     GameListWorker(std::shared_ptr<FileSys::VfsFilesystem> vfs, QString dir_path, bool deep_scan,
-                   const CompatibilityList& compatibility_list);
+                   const CompatibilityList& compatibility_list, GameListIconCache* icon_cache);
     ~GameListWorker() override;
 
     /// Starts the processing of directory tree information.
@@ -45,11 +51,12 @@ public:
 
 signals:
     /**
-     * The `EntryReady` signal is emitted once an entry has been prepared and is ready
+     * The `EntriesReady` signal is emitted once a batch of entries has been prepared and is ready
      * to be added to the game list.
-     * @param entry_items a list with `QStandardItem`s that make up the columns of the new entry.
+     * @param entries a list of entries, each a list with the `QStandardItem`s that make up the
+     * columns of the entry.
      */
-    void EntryReady(QList<QStandardItem*> entry_items);
+    void EntriesReady(QList<QList<QStandardItem*>> entries);
 
     /**
      * After the worker has traversed the game directory looking for entries, this signal is emitted
@@ -60,13 +67,32 @@ signals:
 private:
     void AddInstalledTitlesToGameList();
     void FillControlMap(const std::string& dir_path);
+    /// Parses the file with its loader to read the metadata shown by the game list. Thread-safe.
+    bool ReadGameListEntry(const std::shared_ptr<FileSys::VfsFile>& file,
+                           GameListCacheEntry& entry);
+    /// Collects the supported files in the directory, and in its subdirectories up to recursion.
+    void ScanGameDirectory(const std::string& dir_path, unsigned int recursion,
+                           std::vector<std::string>& game_files);
+    /// Adds the files of the directory, parsing the ones missing from the cache in parallel.
     void AddFstEntriesToGameList(const std::string& dir_path, unsigned int recursion = 0);
+    void AddFstEntry(const std::string& physical_name, const GameListCacheEntry& entry);
+
+    /// Queues an entry for the next EntriesReady batch, emitting it once it's full.
+    void PushEntry(QList<QStandardItem*> entry_items);
+    void FlushEntries();
+
+    static constexpr int ENTRY_BATCH_SIZE = 32;
 
     std::shared_ptr<FileSys::VfsFilesystem> vfs;
     std::map<u64, std::shared_ptr<FileSys::NCA>> nca_control_map;
+    std::mutex control_map_mutex;
+    bool control_map_filled = false;
+    std::unique_ptr<GameListCache> cache;
+    QList<QList<QStandardItem*>> pending_entries;
     QStringList watch_list;
     QString dir_path;
     bool deep_scan;
     const CompatibilityList& compatibility_list;
+    GameListIconCache* icon_cache;
     std::atomic_bool stop_processing;
 };
@@ -28,6 +28,7 @@
 #include "common/scope_exit.h"
 #include "common/string_util.h"
 #include "common/telemetry.h"
+#include "common/tracing.h"
 #include "core/core.h"
 #include "core/crypto/key_manager.h"
 #include "core/file_sys/card_image.h"
@@ -38,10 +39,12 @@
 #include "core/file_sys/savedata_factory.h"
 #include "core/file_sys/submission_package.h"
 #include "core/file_sys/vfs_real.h"
+#include "core/guest_profiler.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/service/filesystem/filesystem.h"
 #include "core/loader/loader.h"
 #include "core/perf_stats.h"
+#include "core/savestate.h"
 #include "core/settings.h"
 #include "core/telemetry_session.h"
 #include "video_core/debug_utils/debug_utils.h"
@@ -53,7 +56,9 @@
 #include "yuzu/debugger/console.h"
 #include "yuzu/debugger/graphics/graphics_breakpoints.h"
 #include "yuzu/debugger/graphics/graphics_surface.h"
+#include "yuzu/debugger/memory_stats.h"
 #include "yuzu/debugger/profiler.h"
+#include "yuzu/debugger/svc_profiler.h"
 #include "yuzu/debugger/wait_tree.h"
 #include "yuzu/game_list.h"
 #include "yuzu/game_list_p.h"
@@ -191,8 +196,9 @@ void GMainWindow::InitializeWidgets() {
     emu_frametime_label->setToolTip(
         tr("Time taken to emulate a Switch frame, not counting framelimiting or v-sync. For "
            "full-speed emulation this should be at most 16.67 ms."));
+    frame_lows_label = new QLabel();
 
-    for (auto& label : {emu_speed_label, game_fps_label, emu_frametime_label}) {
+    for (auto& label : {emu_speed_label, game_fps_label, emu_frametime_label, frame_lows_label}) {
         label->setVisible(false);
         label->setFrameStyle(QFrame::NoFrame);
         label->setContentsMargins(4, 0, 4, 0);
@@ -229,6 +235,34 @@ void GMainWindow::InitializeDebugWidgets() {
             &WaitTreeWidget::OnEmulationStarting);
     connect(this, &GMainWindow::EmulationStopping, waitTreeWidget,
             &WaitTreeWidget::OnEmulationStopping);
+
+    svcProfilerWidget = new SVCProfilerWidget(this);
+    addDockWidget(Qt::LeftDockWidgetArea, svcProfilerWidget);
+    svcProfilerWidget->hide();
+    debug_menu->addAction(svcProfilerWidget->toggleViewAction());
+
+    memoryStatsWidget = new MemoryStatsWidget(this);
+    addDockWidget(Qt::LeftDockWidgetArea, memoryStatsWidget);
+    memoryStatsWidget->hide();
+    debug_menu->addAction(memoryStatsWidget->toggleViewAction());
+
+    debug_menu->addSeparator();
+    QAction* action_export_frame_stats = new QAction(tr("Export Frame Statistics..."), this);
+    connect(action_export_frame_stats, &QAction::triggered, this,
+            &GMainWindow::OnExportFrameStats);
+    debug_menu->addAction(action_export_frame_stats);
+
+    QAction* action_profile_guest = new QAction(tr("Profile Guest Functions"), this);
+    action_profile_guest->setCheckable(true);
+    action_profile_guest->setChecked(Settings::values.profile_guest);
+    connect(action_profile_guest, &QAction::toggled,
+            [](bool checked) { Settings::values.profile_guest = checked; });
+    debug_menu->addAction(action_profile_guest);
+
+    QAction* action_export_guest_profile = new QAction(tr("Export Guest Profile..."), this);
+    connect(action_export_guest_profile, &QAction::triggered, this,
+            &GMainWindow::OnExportGuestProfile);
+    debug_menu->addAction(action_export_guest_profile);
 }
 
 void GMainWindow::InitializeRecentFileMenuActions() {
@@ -256,6 +290,9 @@ void GMainWindow::InitializeHotkeys() {
     hotkey_registry.RegisterHotkey("Main Window", "Start Emulation");
     hotkey_registry.RegisterHotkey("Main Window", "Continue/Pause", QKeySequence(Qt::Key_F4));
     hotkey_registry.RegisterHotkey("Main Window", "Restart", QKeySequence(Qt::Key_F5));
+    hotkey_registry.RegisterHotkey("Main Window", "Save State", QKeySequence(Qt::Key_F6));
+    hotkey_registry.RegisterHotkey("Main Window", "Load State", QKeySequence(Qt::Key_F7));
+    hotkey_registry.RegisterHotkey("Main Window", "Rewind", QKeySequence(Qt::Key_F8));
     hotkey_registry.RegisterHotkey("Main Window", "Fullscreen", QKeySequence::FullScreen);
     hotkey_registry.RegisterHotkey("Main Window", "Exit Fullscreen", QKeySequence(Qt::Key_Escape),
                                    Qt::ApplicationShortcut);
@@ -287,6 +324,24 @@ void GMainWindow::InitializeHotkeys() {
                     return;
                 BootGame(QString(game_path));
             });
+    connect(hotkey_registry.GetHotkey("Main Window", "Save State", this), &QShortcut::activated,
+            this, [this] {
+                if (emulation_running) {
+                    Core::System::GetInstance().SaveStates().RequestSave();
+                }
+            });
+    connect(hotkey_registry.GetHotkey("Main Window", "Load State", this), &QShortcut::activated,
+            this, [this] {
+                if (emulation_running) {
+                    Core::System::GetInstance().SaveStates().RequestLoad();
+                }
+            });
+    connect(hotkey_registry.GetHotkey("Main Window", "Rewind", this), &QShortcut::activated, this,
+            [this] {
+                if (emulation_running) {
+                    Core::System::GetInstance().SaveStates().RequestRewind();
+                }
+            });
     connect(hotkey_registry.GetHotkey("Main Window", "Fullscreen", render_window),
             &QShortcut::activated, ui.action_Fullscreen, &QAction::trigger);
     connect(hotkey_registry.GetHotkey("Main Window", "Fullscreen", render_window),
@@ -391,7 +446,7 @@ void GMainWindow::ConnectMenuEvents() {
     connect(ui.action_Start, &QAction::triggered, this, &GMainWindow::OnStartGame);
     connect(ui.action_Pause, &QAction::triggered, this, &GMainWindow::OnPauseGame);
     connect(ui.action_Stop, &QAction::triggered, this, &GMainWindow::OnStopGame);
-    connect(ui.action_Restart, &QAction::triggered, this, [this] { BootGame(QString(game_path)); });
+    connect(ui.action_Restart, &QAction::triggered, this, &GMainWindow::OnRestartGame);
     connect(ui.action_Configure, &QAction::triggered, this, &GMainWindow::OnConfigure);
 
     // View
@@ -473,7 +528,10 @@ bool GMainWindow::LoadROM(const QString& filename) {
     if (emu_thread != nullptr)
         ShutdownGame();
 
-    render_window->InitRenderTarget();
+    // A restart keeps the render target, the kept renderer still uses its context
+    if (!Core::System::GetInstance().HasKeptRenderer()) {
+        render_window->InitRenderTarget();
+    }
     render_window->MakeCurrent();
 
     if (!gladLoadGL()) {
@@ -581,6 +639,10 @@ void GMainWindow::BootGame(const QString& filename) {
 
     // Create and start the emulation thread
     emu_thread = std::make_unique<EmuThread>(render_window);
+    qRegisterMetaType<VideoCore::LoadCallbackStage>("VideoCore::LoadCallbackStage");
+    qRegisterMetaType<std::size_t>("std::size_t");
+    connect(emu_thread.get(), &EmuThread::LoadProgress, this, &GMainWindow::OnLoadProgress,
+            Qt::QueuedConnection);
     emit EmulationStarting(emu_thread.get());
     render_window->moveContext();
     emu_thread->start();
@@ -626,8 +688,8 @@ void GMainWindow::BootGame(const QString& filename) {
     OnStartGame();
 }
 
-void GMainWindow::ShutdownGame() {
-    emu_thread->RequestStop();
+void GMainWindow::ShutdownGame(bool keep_renderer) {
+    emu_thread->RequestStop(keep_renderer);
 
     emit EmulationStopping();
 
@@ -656,6 +718,7 @@ void GMainWindow::ShutdownGame() {
     emu_speed_label->setVisible(false);
     game_fps_label->setVisible(false);
     emu_frametime_label->setVisible(false);
+    frame_lows_label->setVisible(false);
 
     emulation_running = false;
 
@@ -793,31 +856,20 @@ void GMainWindow::OnMenuInstallToNAND() {
     const auto qt_raw_copy = [this](FileSys::VirtualFile src, FileSys::VirtualFile dest) {
         if (src == nullptr || dest == nullptr)
             return false;
-        if (!dest->Resize(src->GetSize()))
-            return false;
 
-        std::array<u8, 0x1000> buffer{};
-        const int progress_maximum = static_cast<int>(src->GetSize() / buffer.size());
+        // Progress is counted in MiB, so that the maximum fits in an int for large files
+        static constexpr std::size_t progress_unit = 0x100000;
+        const int progress_maximum = static_cast<int>(src->GetSize() / progress_unit);
 
         QProgressDialog progress(
             tr("Installing file \"%1\"...").arg(QString::fromStdString(src->GetName())),
             tr("Cancel"), 0, progress_maximum, this);
         progress.setWindowModality(Qt::WindowModal);
 
-        for (std::size_t i = 0; i < src->GetSize(); i += buffer.size()) {
-            if (progress.wasCanceled()) {
-                dest->Resize(0);
-                return false;
-            }
-
-            const int progress_value = static_cast<int>(i / buffer.size());
-            progress.setValue(progress_value);
-
-            const auto read = src->Read(buffer.data(), buffer.size(), i);
-            dest->Write(buffer.data(), read, i);
-        }
-
-        return true;
+        return FileSys::VfsPipelinedCopy(src, dest, [&progress](std::size_t copied, std::size_t) {
+            progress.setValue(static_cast<int>(copied / progress_unit));
+            return !progress.wasCanceled();
+        });
     };
 
     const auto success = [this]() {
@@ -1010,6 +1062,12 @@ void GMainWindow::OnStopGame() {
     ShutdownGame();
 }
 
+void GMainWindow::OnRestartGame() {
+    // Only the state of the title is rebuilt, the renderer and its shader programs are kept
+    ShutdownGame(true);
+    BootGame(QString(game_path));
+}
+
 void GMainWindow::ToggleFullscreen() {
     if (!emulation_running) {
         return;
@@ -1088,6 +1146,51 @@ void GMainWindow::OnAbout() {
     aboutDialog.exec();
 }
 
+void GMainWindow::OnExportFrameStats() {
+    // Taken before the dialog is opened, so that the frames are the ones leading up to the export
+    const auto frames = Core::System::GetInstance().GetPerfStats().GetFrameHistory();
+    const QString path =
+        QFileDialog::getSaveFileName(this, tr("Export Frame Statistics"), QString(),
+                                     tr("Chrome Trace (*.json);;CSV (*.csv)"));
+    if (path.isEmpty()) {
+        return;
+    }
+
+    const bool is_json = path.endsWith(QStringLiteral(".json"), Qt::CaseInsensitive);
+    const std::string stats =
+        is_json ? Core::FormatFrameHistoryTrace(frames) : Core::FormatFrameHistoryCSV(frames);
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+        file.write(stats.data(), static_cast<qint64>(stats.size())) !=
+            static_cast<qint64>(stats.size())) {
+        QMessageBox::critical(this, tr("Export Frame Statistics"),
+                              tr("Failed to write the statistics to %1.").arg(path));
+    }
+}
+
+void GMainWindow::OnExportGuestProfile() {
+    const QString path = QFileDialog::getSaveFileName(
+        this, tr("Export Guest Profile"), QString(),
+        tr("Folded Stacks (*.folded *.txt);;Flat Profile CSV (*.csv)"));
+    if (path.isEmpty()) {
+        return;
+    }
+
+    const bool is_csv = path.endsWith(QStringLiteral(".csv"), Qt::CaseInsensitive);
+    const std::string profile =
+        is_csv ? Core::GuestProfiler::FormatFlatCSV(Core::GuestProfiler::GetFlatProfile())
+               : Core::GuestProfiler::FormatFoldedStacks();
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+        file.write(profile.data(), static_cast<qint64>(profile.size())) !=
+            static_cast<qint64>(profile.size())) {
+        QMessageBox::critical(this, tr("Export Guest Profile"),
+                              tr("Failed to write the profile to %1.").arg(path));
+    }
+}
+
 void GMainWindow::OnToggleFilterBar() {
     game_list->setFilterVisible(ui.action_Show_Filter_Bar->isChecked());
     if (ui.action_Show_Filter_Bar->isChecked()) {
@@ -1114,10 +1217,31 @@ void GMainWindow::UpdateStatusBar() {
     }
     game_fps_label->setText(tr("Game: %1 FPS").arg(results.game_fps, 0, 'f', 0));
     emu_frametime_label->setText(tr("Frame: %1 ms").arg(results.frametime * 1000.0, 0, 'f', 2));
+    frame_lows_label->setText(tr("Lows: %1 / %2 ms")
+                                  .arg(results.frame_length_p99 * 1000.0, 0, 'f', 2)
+                                  .arg(results.frame_length_p999 * 1000.0, 0, 'f', 2));
+
+    // The tooltip breaks the average frame down into the time spent in each stage
+    QString stage_times = tr("Length of the slowest 1% and 0.1% of the frames. Average time "
+                             "spent per frame:");
+    for (std::size_t stage = 0; stage < Core::NumPerfStages; ++stage) {
+        stage_times += QStringLiteral("\n%1: %2 ms")
+                           .arg(QString::fromLatin1(
+                               Core::GetPerfStageName(static_cast<Core::PerfStage>(stage))))
+                           .arg(results.stage_times[stage] * 1000.0, 0, 'f', 2);
+    }
+    frame_lows_label->setToolTip(stage_times);
+    emu_speed_label->setToolTip(
+        tr("Current emulation speed. Values higher or lower than 100% "
+           "indicate emulation is running faster or slower than a Switch.\n"
+           "Audio latency: %1 ms, underruns: %2")
+            .arg(results.audio_latency * 1000.0, 0, 'f', 0)
+            .arg(results.audio_underruns));
 
     emu_speed_label->setVisible(true);
     game_fps_label->setVisible(true);
     emu_frametime_label->setVisible(true);
+    frame_lows_label->setVisible(true);
 }
 
 void GMainWindow::OnCoreError(Core::System::ResultStatus result, std::string details) {
@@ -1184,6 +1308,22 @@ void GMainWindow::OnCoreError(Core::System::ResultStatus result, std::string det
     }
 }
 
+void GMainWindow::OnLoadProgress(VideoCore::LoadCallbackStage stage, std::size_t value,
+                                 std::size_t total) {
+    switch (stage) {
+    case VideoCore::LoadCallbackStage::Prepare:
+        message_label->setText(tr("Loading the shader cache..."));
+        break;
+    case VideoCore::LoadCallbackStage::Build:
+        message_label->setText(tr("Building shaders %1 / %2").arg(value).arg(total));
+        break;
+    case VideoCore::LoadCallbackStage::Complete:
+        message_label->setVisible(false);
+        return;
+    }
+    message_label->setVisible(true);
+}
+
 bool GMainWindow::ConfirmClose() {
     if (emu_thread == nullptr || !UISettings::values.confirm_before_closing)
         return true;
@@ -1297,6 +1437,7 @@ void GMainWindow::UpdateUITheme() {
 #endif
 
 int main(int argc, char* argv[]) {
+    Common::Tracing::Initialize();
     MicroProfileOnThreadCreate("Frontend");
     SCOPE_EXIT({ MicroProfileShutdown(); });
 
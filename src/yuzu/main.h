@@ -23,8 +23,10 @@ class GImageInfo;
 class GraphicsBreakPointsWidget;
 class GraphicsSurfaceWidget;
 class GRenderWindow;
+class MemoryStatsWidget;
 class MicroProfileDialog;
 class ProfilerWidget;
+class SVCProfilerWidget;
 class WaitTreeWidget;
 enum class GameListOpenTarget;
 
@@ -36,6 +38,10 @@ namespace Tegra {
 class DebugContext;
 }
 
+namespace VideoCore {
+enum class LoadCallbackStage;
+}
+
 enum class EmulatedDirectoryTarget {
     NAND,
     SDMC,
@@ -97,7 +103,8 @@ private:
     QStringList GetUnsupportedGLExtensions();
     bool LoadROM(const QString& filename);
     void BootGame(const QString& filename);
-    void ShutdownGame();
+    /// @param keep_renderer Whether the renderer is kept for the game booted next
+    void ShutdownGame(bool keep_renderer = false);
 
     void ShowCallouts();
 
@@ -135,6 +142,7 @@ private slots:
     void OnStartGame();
     void OnPauseGame();
     void OnStopGame();
+    void OnRestartGame();
     /// Called whenever a user selects a game in the game list widget.
     void OnGameListLoadFile(QString game_path);
     void OnGameListOpenFolder(u64 program_id, GameListOpenTarget target);
@@ -150,6 +158,8 @@ private slots:
     void OnMenuRecentFile();
     void OnConfigure();
     void OnAbout();
+    void OnExportFrameStats();
+    void OnExportGuestProfile();
     void OnToggleFilterBar();
     void OnDisplayTitleBars(bool);
     void ToggleFullscreen();
@@ -157,6 +167,7 @@ private slots:
     void HideFullscreen();
     void ToggleWindowMode();
     void OnCoreError(Core::System::ResultStatus, std::string);
+    void OnLoadProgress(VideoCore::LoadCallbackStage stage, std::size_t value, std::size_t total);
 
 private:
     void UpdateStatusBar();
@@ -173,6 +184,7 @@ private:
     QLabel* emu_speed_label = nullptr;
     QLabel* game_fps_label = nullptr;
     QLabel* emu_frametime_label = nullptr;
+    QLabel* frame_lows_label = nullptr;
     QTimer status_bar_update_timer;
 
     std::unique_ptr<Config> config;
@@ -192,6 +204,8 @@ private:
     GraphicsBreakPointsWidget* graphicsBreakpointsWidget;
     GraphicsSurfaceWidget* graphicsSurfaceWidget;
     WaitTreeWidget* waitTreeWidget;
+    SVCProfilerWidget* svcProfilerWidget;
+    MemoryStatsWidget* memoryStatsWidget;
 
     QAction* actions_recent_files[max_recent_files_item];
 
@@ -57,6 +57,7 @@ struct Values {
 
     // Game List
     bool show_unknown;
+    bool cache_game_list;
     uint32_t icon_size;
     uint8_t row_1_text_id;
     uint8_t row_2_text_id;
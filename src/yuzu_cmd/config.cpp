@@ -92,6 +92,16 @@ void Config::ReadValues() {
     // Core
     Settings::values.use_cpu_jit = sdl2_config->GetBoolean("Core", "use_cpu_jit", true);
     Settings::values.use_multi_core = sdl2_config->GetBoolean("Core", "use_multi_core", false);
+    Settings::values.pin_emulation_threads =
+        sdl2_config->GetBoolean("Core", "pin_emulation_threads", false);
+    Settings::values.use_host_timing = sdl2_config->GetBoolean("Core", "use_host_timing", false);
+    Settings::values.use_hle_libc = sdl2_config->GetBoolean("Core", "use_hle_libc", false);
+    Settings::values.simd_level_limit = static_cast<Common::SIMDLevel>(sdl2_config->GetInteger(
+        "Core", "simd_level_limit", static_cast<long>(Common::MAX_SIMD_LEVEL)));
+    Settings::values.rewind_interval =
+        static_cast<u16>(sdl2_config->GetInteger("Core", "rewind_interval", 0));
+    Settings::values.rewind_memory_budget =
+        static_cast<u32>(sdl2_config->GetInteger("Core", "rewind_memory_budget", 512));
 
     // Renderer
     Settings::values.resolution_factor =
@@ -101,6 +111,35 @@ void Config::ReadValues() {
         static_cast<u16>(sdl2_config->GetInteger("Renderer", "frame_limit", 100));
     Settings::values.use_accurate_framebuffers =
         sdl2_config->GetBoolean("Renderer", "use_accurate_framebuffers", false);
+    Settings::values.use_disk_shader_cache =
+        sdl2_config->GetBoolean("Renderer", "use_disk_shader_cache", true);
+    Settings::values.use_asynchronous_shaders =
+        sdl2_config->GetBoolean("Renderer", "use_asynchronous_shaders", false);
+    Settings::values.skip_draws_with_pending_shaders =
+        sdl2_config->GetBoolean("Renderer", "skip_draws_with_pending_shaders", true);
+    Settings::values.use_uber_shaders =
+        sdl2_config->GetBoolean("Renderer", "use_uber_shaders", true);
+    Settings::values.use_gpu_texture_decoding =
+        sdl2_config->GetBoolean("Renderer", "use_gpu_texture_decoding", false);
+    Settings::values.use_texture_deduplication =
+        sdl2_config->GetBoolean("Renderer", "use_texture_deduplication", false);
+    Settings::values.use_deferred_cache_invalidation =
+        sdl2_config->GetBoolean("Renderer", "use_deferred_cache_invalidation", false);
+    Settings::values.use_resident_vertex_buffers =
+        sdl2_config->GetBoolean("Renderer", "use_resident_vertex_buffers", false);
+    Settings::values.use_gpu_memory_aliasing =
+        sdl2_config->GetBoolean("Renderer", "use_gpu_memory_aliasing", false);
+    Settings::values.use_draw_batching =
+        sdl2_config->GetBoolean("Renderer", "use_draw_batching", false);
+    Settings::values.use_asynchronous_gpu_emulation =
+        sdl2_config->GetBoolean("Renderer", "use_asynchronous_gpu_emulation", false);
+    Settings::values.use_frame_skip = sdl2_config->GetBoolean("Renderer", "use_frame_skip", false);
+    Settings::values.renderer_backend = static_cast<Settings::RendererBackend>(
+        sdl2_config->GetInteger("Renderer", "renderer_backend", 0));
+    Settings::values.skip_gpu_commands =
+        sdl2_config->GetBoolean("Renderer", "skip_gpu_commands", false);
+    Settings::values.texture_cache_budget =
+        static_cast<u32>(sdl2_config->GetInteger("Renderer", "texture_cache_budget", 1024));
 
     Settings::values.bg_red = (float)sdl2_config->GetReal("Renderer", "bg_red", 0.0);
     Settings::values.bg_green = (float)sdl2_config->GetReal("Renderer", "bg_green", 0.0);
@@ -110,6 +149,10 @@ void Config::ReadValues() {
     Settings::values.sink_id = sdl2_config->Get("Audio", "output_engine", "auto");
     Settings::values.enable_audio_stretching =
         sdl2_config->GetBoolean("Audio", "enable_audio_stretching", true);
+    Settings::values.audio_latency =
+        static_cast<u16>(sdl2_config->GetInteger("Audio", "audio_latency", 50));
+    Settings::values.audio_stretch_quality =
+        sdl2_config->GetInteger("Audio", "audio_stretch_quality", 1);
     Settings::values.audio_device_id = sdl2_config->Get("Audio", "output_device", "auto");
     Settings::values.volume = sdl2_config->GetReal("Audio", "volume", 1);
 
@@ -138,6 +181,10 @@ void Config::ReadValues() {
     Settings::values.use_gdbstub = sdl2_config->GetBoolean("Debugging", "use_gdbstub", false);
     Settings::values.gdbstub_port =
         static_cast<u16>(sdl2_config->GetInteger("Debugging", "gdbstub_port", 24689));
+    Settings::values.profile_svcs = sdl2_config->GetBoolean("Debugging", "profile_svcs", false);
+    Settings::values.record_memory_stats =
+        sdl2_config->GetBoolean("Debugging", "record_memory_stats", false);
+    Settings::values.profile_guest = sdl2_config->GetBoolean("Debugging", "profile_guest", false);
 }
 
 void Config::Reload() {
@@ -84,6 +84,34 @@ use_cpu_jit =
 # 0 (default): Disabled, 1: Enabled
 use_multi_core=
 
+# Whether to pin the emulated CPU cores and the GPU thread to their own physical host cores,
+# preferring the fastest ones on hybrid CPUs. Can hurt if the host is busy with other programs.
+# 0 (default): Disabled, 1: Enabled
+pin_emulation_threads =
+
+# Whether guest time follows the host clock, scaled by the frame limit, instead of the number of
+# instructions executed. Smooths the frame pacing of titles that limit their own frame rate.
+# 0 (default): Disabled, 1: Enabled
+use_host_timing =
+
+# Whether memcpy, memmove, memset, memcmp and strlen of the guest libc run as host code instead of
+# being emulated. Only applies to the functions named in the dynamic symbol table of a module.
+# 0 (default): Disabled, 1: Enabled
+use_hle_libc =
+
+# Highest SIMD instruction set the optimized host code may use, to compare its variants on the same
+# machine. Lower limits fall back to slower code, levels the CPU lacks are never used.
+# 0: Scalar, 1: SSE2, 2: SSSE3, 3: AVX2, 4: AVX-512, 5 (default): No limit, including NEON
+simd_level_limit =
+
+# Number of frames between the snapshots of the rewind buffer, the shorter the finer rewinding is
+# 0 (default): Rewinding is disabled
+rewind_interval =
+
+# Memory the rewind buffer may use in MiB, the oldest snapshots are dropped beyond it
+# Default: 512
+rewind_memory_budget =
+
 [Renderer]
 # Whether to use software or hardware rendering.
 # 0: Software, 1 (default): Hardware
@@ -114,6 +142,73 @@ frame_limit =
 # 0 (default): Off (fast), 1 : On (slow)
 use_accurate_framebuffers =
 
+# Whether to store compiled shaders on disk, reducing stutter when a game is booted again
+# 0: Off, 1: On (default)
+use_disk_shader_cache =
+
+# Whether to decompile new shaders on worker threads instead of stalling emulation
+# 0 (default): Off, 1: On
+use_asynchronous_shaders =
+
+# What to do with draws whose shaders are still being built asynchronously
+# 0: Draw with the previous shader of the stage, 1 (default): Skip the draw
+skip_draws_with_pending_shaders =
+
+# Whether to draw with a generic vertex shader while vertex shaders are built asynchronously
+# 0: Off, 1 (default): On
+use_uber_shaders =
+
+# Whether to unswizzle and convert textures with compute shaders instead of on the CPU
+# 0 (default): Off, 1: On
+use_gpu_texture_decoding =
+
+# Whether large textures loaded from identical guest data share a single host texture, which is
+# only copied when one of them is rendered to
+# 0 (default): Off, 1: On
+use_texture_deduplication =
+
+# Whether guest writes to cached GPU resources only mark their pages, invalidating the resources
+# the next time the GPU needs them. Keeps frequently written pages on the fast memory path.
+# 0 (default): Off, 1: On
+use_deferred_cache_invalidation =
+
+# Whether large vertex buffers are kept resident on the GPU, only uploading the parts written by the
+# guest, instead of being copied again on every draw.
+# 0 (default): Off, 1: On
+use_resident_vertex_buffers =
+
+# Whether large nvmap buffers are backed by GPU visible memory that the guest writes to directly,
+# so vertex arrays in them are never uploaded. Needs ARB_buffer_storage.
+# 0 (default): Off, 1: On
+use_gpu_memory_aliasing =
+
+# Whether consecutive draws that only differ in their vertex ranges are submitted together
+# 0 (default): Off, 1: On
+use_draw_batching =
+
+# Whether to emulate the GPU on its own thread, which takes over the OpenGL context
+# 0 (default): Off, 1: On
+use_asynchronous_gpu_emulation =
+
+# Whether the GPU thread skips drawing to the presented images of frames that are already behind
+# a newer one, when the host GPU can't keep up. Needs asynchronous GPU emulation.
+# 0 (default): Off, 1: On
+use_frame_skip =
+
+# Which renderer to use. The null renderer displays nothing and needs no GPU, to benchmark the CPU
+# and the HLE services. It can also be selected with --null-renderer.
+# 0 (default): OpenGL, 1: Null
+renderer_backend =
+
+# Whether to drop the GPU command lists instead of running them through the GPU engines.
+# Titles waiting on GPU semaphores or syncpoints may stall.
+# 0 (default): Off, 1: On
+skip_gpu_commands =
+
+# Amount of video memory in MiB that cached textures may use before the least recently used ones
+# are evicted. 0: Unlimited, 1024 (default)
+texture_cache_budget =
+
 # The clear color for the renderer. What shows up on the sides of the bottom screen.
 # Must be in range of 0.0-1.0. Defaults to 1.0 for all.
 bg_red =
@@ -156,6 +251,15 @@ output_engine =
 # 0: No, 1 (default): Yes
 enable_audio_stretching =
 
+# How much audio is buffered ahead of playback, in milliseconds.
+# Higher values cover longer emulation stalls without audio stutter, at the cost of latency.
+# Default is 50
+audio_latency =
+
+# Trade-off between CPU usage and sound quality of the audio-stretching effect.
+# 0: Fast, for slow CPUs, 1 (default): Balanced, 2: High
+audio_stretch_quality =
+
 # Which audio device to use.
 # auto (default): Auto-select
 output_device =
@@ -197,6 +301,20 @@ log_filter = *:Trace
 # Port for listening to GDB connections.
 use_gdbstub=false
 gdbstub_port=24689
+# Gathers per-thread statistics of the SVCs: calls, run time, HLE lock waits and blocked time.
+# They're logged when emulation stops, and can be exported with --svc-profile.
+# 0 (default): Off, 1: On
+profile_svcs =
+# Counts the guest memory accesses which miss the fast path, per page and per page type, and the
+# rasterizer cache objects they flush or invalidate. They're logged when emulation stops, and can
+# be exported with --memory-stats.
+# 0 (default): Off, 1: On
+record_memory_stats =
+# Samples the guest PC and call stack of each core a thousand times per emulated second, to find
+# the guest functions the CPU spends its time in. The functions with the most samples are logged
+# when emulation stops, and the call stacks can be exported with --guest-profile.
+# 0 (default): Off, 1: On
+profile_guest =
 
 [WebService]
 # Whether or not to enable telemetry
@@ -53,6 +53,9 @@ bool EmuWindow_SDL2::IsOpen() const {
 }
 
 void EmuWindow_SDL2::OnResize() {
+    if (render_window == nullptr) {
+        return;
+    }
     int width, height;
     SDL_GetWindowSize(render_window, &width, &height);
     UpdateCurrentFramebufferLayout(width, height);
@@ -115,17 +118,26 @@ bool EmuWindow_SDL2::SupportsRequiredGLExtensions() {
     return unsupported_ext.empty();
 }
 
-EmuWindow_SDL2::EmuWindow_SDL2(bool fullscreen) {
+EmuWindow_SDL2::EmuWindow_SDL2(bool fullscreen, bool hidden, bool headless) {
     InputCommon::Init();
 
     SDL_SetMainReady();
 
     // Initialize the window
-    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_JOYSTICK) < 0) {
+    if (SDL_Init(headless ? SDL_INIT_JOYSTICK : SDL_INIT_VIDEO | SDL_INIT_JOYSTICK) < 0) {
         LOG_CRITICAL(Frontend, "Failed to initialize SDL2! Exiting...");
         exit(1);
     }
 
+    if (headless) {
+        // Nothing is displayed, the layout only has to be valid for the renderer
+        UpdateCurrentFramebufferLayout(Layout::ScreenUndocked::Width,
+                                       Layout::ScreenUndocked::Height);
+        LOG_INFO(Frontend, "yuzu Version: {} | {}-{}", Common::g_build_fullname,
+                 Common::g_scm_branch, Common::g_scm_desc);
+        return;
+    }
+
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
@@ -137,19 +149,22 @@ EmuWindow_SDL2::EmuWindow_SDL2(bool fullscreen) {
 
     std::string window_title = fmt::format("yuzu {} | {}-{}", Common::g_build_fullname,
                                            Common::g_scm_branch, Common::g_scm_desc);
-    render_window =
-        SDL_CreateWindow(window_title.c_str(),
-                         SDL_WINDOWPOS_UNDEFINED, // x position
-                         SDL_WINDOWPOS_UNDEFINED, // y position
-                         Layout::ScreenUndocked::Width, Layout::ScreenUndocked::Height,
-                         SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI);
+    u32 window_flags = SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI;
+    if (hidden) {
+        window_flags |= SDL_WINDOW_HIDDEN;
+    }
+    render_window = SDL_CreateWindow(window_title.c_str(),
+                                     SDL_WINDOWPOS_UNDEFINED, // x position
+                                     SDL_WINDOWPOS_UNDEFINED, // y position
+                                     Layout::ScreenUndocked::Width, Layout::ScreenUndocked::Height,
+                                     window_flags);
 
     if (render_window == nullptr) {
         LOG_CRITICAL(Frontend, "Failed to create SDL2 window! {}", SDL_GetError());
         exit(1);
     }
 
-    if (fullscreen) {
+    if (fullscreen && !hidden) {
         Fullscreen();
     }
 
@@ -182,14 +197,18 @@ EmuWindow_SDL2::EmuWindow_SDL2(bool fullscreen) {
 
 EmuWindow_SDL2::~EmuWindow_SDL2() {
     InputCommon::SDL::CloseSDLJoysticks();
-    SDL_GL_DeleteContext(gl_context);
+    if (gl_context != nullptr) {
+        SDL_GL_DeleteContext(gl_context);
+    }
     SDL_Quit();
 
     InputCommon::Shutdown();
 }
 
 void EmuWindow_SDL2::SwapBuffers() {
-    SDL_GL_SwapWindow(render_window);
+    if (render_window != nullptr) {
+        SDL_GL_SwapWindow(render_window);
+    }
 }
 
 void EmuWindow_SDL2::PollEvents() {
@@ -234,15 +253,22 @@ void EmuWindow_SDL2::PollEvents() {
 }
 
 void EmuWindow_SDL2::MakeCurrent() {
-    SDL_GL_MakeCurrent(render_window, gl_context);
+    if (gl_context != nullptr) {
+        SDL_GL_MakeCurrent(render_window, gl_context);
+    }
 }
 
 void EmuWindow_SDL2::DoneCurrent() {
-    SDL_GL_MakeCurrent(render_window, nullptr);
+    if (gl_context != nullptr) {
+        SDL_GL_MakeCurrent(render_window, nullptr);
+    }
 }
 
 void EmuWindow_SDL2::OnMinimalClientAreaChangeRequest(
     const std::pair<unsigned, unsigned>& minimal_size) {
+    if (render_window == nullptr) {
+        return;
+    }
 
     SDL_SetWindowMinimumSize(render_window, minimal_size.first, minimal_size.second);
 }
@@ -12,7 +12,11 @@ struct SDL_Window;
 
 class EmuWindow_SDL2 : public Core::Frontend::EmuWindow {
 public:
-    explicit EmuWindow_SDL2(bool fullscreen);
+    /**
+     * A hidden window is never shown, and only provides the GL context for offscreen rendering.
+     * A headless one creates neither a window nor a GL context, for the null renderer.
+     */
+    explicit EmuWindow_SDL2(bool fullscreen, bool hidden = false, bool headless = false);
     ~EmuWindow_SDL2();
 
     /// Swap buffers to display the next frame
@@ -56,10 +60,10 @@ private:
     /// Is the window still open?
     bool is_open = true;
 
-    /// Internal SDL2 render window
-    SDL_Window* render_window;
+    /// Internal SDL2 render window, nullptr when headless
+    SDL_Window* render_window = nullptr;
 
     using SDL_GLContext = void*;
-    /// The OpenGL context associated with the window
-    SDL_GLContext gl_context;
+    /// The OpenGL context associated with the window, nullptr when headless
+    SDL_GLContext gl_context = nullptr;
 };
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <chrono>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -19,12 +20,19 @@
 #include "common/scope_exit.h"
 #include "common/string_util.h"
 #include "common/telemetry.h"
+#include "common/thread.h"
+#include "common/tracing.h"
 #include "core/core.h"
 #include "core/file_sys/vfs_real.h"
 #include "core/gdbstub/gdbstub.h"
+#include "core/guest_profiler.h"
+#include "core/hle/kernel/svc_profiler.h"
 #include "core/loader/loader.h"
+#include "core/memory_stats.h"
+#include "core/perf_stats.h"
 #include "core/settings.h"
 #include "core/telemetry_session.h"
+#include "video_core/gpu.h"
 #include "yuzu_cmd/config.h"
 #include "yuzu_cmd/emu_window/emu_window_sdl2.h"
 
@@ -55,6 +63,26 @@ static void PrintHelp(const char* argv0) {
               << " [options] <filename>\n"
                  "-g, --gdbport=NUMBER  Enable gdb stub on port NUMBER\n"
                  "-f, --fullscreen     Start in fullscreen mode\n"
+                 "-p, --svc-profile=FILE  Profile the SVCs and write the statistics to FILE,\n"
+                 "                        as JSON if it ends in .json or as CSV otherwise\n"
+                 "-P, --guest-profile=FILE  Sample the guest call stacks and write them to FILE\n"
+                 "                        as folded stacks, or the flat profile as CSV if it\n"
+                 "                        ends in .csv\n"
+                 "-m, --memory-stats=FILE  Count the guest memory accesses which miss the fast\n"
+                 "                        path and write them per page to FILE, as JSON if it\n"
+                 "                        ends in .json or as CSV otherwise\n"
+                 "-s, --frame-stats=FILE  Write the times and counters of the last frames to FILE\n"
+                 "                        on exit, as a Chrome trace if it ends in .json or as\n"
+                 "                        CSV otherwise\n"
+                 "-b, --benchmark=LIMIT   Run unthrottled in a hidden window for LIMIT frames,\n"
+                 "                        or LIMIT seconds if it ends in s, then exit\n"
+                 "-r, --benchmark-report=FILE  Write the benchmark report as JSON to FILE\n"
+                 "                        instead of the standard output\n"
+                 "-n, --null-renderer   Display nothing and create no window or GL context,\n"
+                 "                        to benchmark the CPU and HLE without a GPU\n"
+                 "-t, --gpu-trace=FILE  Record the commands sent to the GPU to FILE\n"
+                 "-T, --replay-gpu-trace  Replay <filename> as a GPU trace, without running\n"
+                 "                        the CPU\n"
                  "-h, --help            Display this help and exit\n"
                  "-v, --version         Output version information and exit\n";
 }
@@ -75,6 +103,125 @@ static void InitializeLogging() {
     Log::AddBackend(std::make_unique<Log::FileBackend>(log_dir + LOG_FILE));
 }
 
+/// Writes the guest memory access statistics, in the format given by the file extension
+static void WriteMemoryStats(const std::string& path) {
+    const auto report = Memory::AccessStats::GetReport();
+    const bool is_json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+    const std::string stats = is_json ? Memory::AccessStats::FormatJSON(report)
+                                      : Memory::AccessStats::FormatCSV(report);
+
+    FileUtil::IOFile file(path, "w");
+    if (!file.IsOpen() || file.WriteBytes(stats.data(), stats.size()) != stats.size()) {
+        LOG_ERROR(Frontend, "Failed to write the memory statistics to {}", path);
+        return;
+    }
+    LOG_INFO(Frontend, "Wrote the memory statistics of {} pages to {}", report.pages.size(), path);
+}
+
+/// Writes the SVC statistics of each guest thread, in the format given by the file extension
+static void WriteSVCProfile(const std::string& path) {
+    const auto entries = Kernel::SVCProfiler::GetEntries();
+    const bool is_json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+    const std::string profile = is_json ? Kernel::SVCProfiler::FormatJSON(entries)
+                                        : Kernel::SVCProfiler::FormatCSV(entries);
+
+    FileUtil::IOFile file(path, "w");
+    if (!file.IsOpen() || file.WriteBytes(profile.data(), profile.size()) != profile.size()) {
+        LOG_ERROR(Frontend, "Failed to write the SVC profile to {}", path);
+        return;
+    }
+    LOG_INFO(Frontend, "Wrote the statistics of {} SVC entries to {}", entries.size(), path);
+}
+
+/// Writes the sampled guest call stacks as folded stacks, or the flat profile as CSV
+static void WriteGuestProfile(const std::string& path) {
+    const bool is_csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+    const std::string profile =
+        is_csv ? Core::GuestProfiler::FormatFlatCSV(Core::GuestProfiler::GetFlatProfile())
+               : Core::GuestProfiler::FormatFoldedStacks();
+
+    FileUtil::IOFile file(path, "w");
+    if (!file.IsOpen() || file.WriteBytes(profile.data(), profile.size()) != profile.size()) {
+        LOG_ERROR(Frontend, "Failed to write the guest profile to {}", path);
+        return;
+    }
+    LOG_INFO(Frontend, "Wrote the guest profile of {} samples to {}",
+             Core::GuestProfiler::GetSampleCount(), path);
+}
+
+/// Writes the performance of the most recent frames as a Chrome trace or as CSV
+static void WriteFrameStats(const std::string& path) {
+    const auto frames = Core::System::GetInstance().GetPerfStats().GetFrameHistory();
+    const bool is_json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+    const std::string stats =
+        is_json ? Core::FormatFrameHistoryTrace(frames) : Core::FormatFrameHistoryCSV(frames);
+
+    FileUtil::IOFile file(path, "w");
+    if (!file.IsOpen() || file.WriteBytes(stats.data(), stats.size()) != stats.size()) {
+        LOG_ERROR(Frontend, "Failed to write the frame statistics to {}", path);
+        return;
+    }
+    LOG_INFO(Frontend, "Wrote the statistics of {} frames to {}", frames.size(), path);
+}
+
+/// Limit of a benchmark run, in system frames or in seconds of walltime
+struct BenchmarkLimit {
+    u64 frames = 0;
+    std::chrono::seconds duration{};
+};
+
+/// Parses a benchmark limit, a number of frames or a number of seconds followed by 's'
+static bool ParseBenchmarkLimit(const char* text, BenchmarkLimit& limit) {
+    char* end;
+    errno = 0;
+    const u64 value = std::strtoull(text, &end, 10);
+    if (end == text || errno != 0 || value == 0) {
+        return false;
+    }
+    if (end[0] == 's' && end[1] == '\0') {
+        limit.duration = std::chrono::seconds(value);
+        return true;
+    }
+    limit.frames = value;
+    return end[0] == '\0';
+}
+
+/// Formats the results of a benchmark run as a JSON object
+static std::string FormatBenchmarkReport(const Core::PerfStatsResults& results, u64 frames,
+                                         double seconds) {
+    std::string json = fmt::format(
+        "{{\n  \"frames\": {},\n  \"seconds\": {:.3f},\n  \"system_fps\": {:.3f},\n"
+        "  \"game_fps\": {:.3f},\n  \"emulation_speed\": {:.4f},\n  \"frametime_ms\": {:.3f},\n"
+        "  \"frame_length_ms\": {{\"median\": {:.3f}, \"p99\": {:.3f}, \"p999\": {:.3f}, "
+        "\"stddev\": {:.3f}}},\n",
+        frames, seconds, results.system_fps, results.game_fps, results.emulation_speed,
+        results.frametime * 1000.0, results.frame_length_median * 1000.0,
+        results.frame_length_p99 * 1000.0, results.frame_length_p999 * 1000.0,
+        results.frame_length_stddev * 1000.0);
+
+    const auto stage_calls = Core::System::GetInstance().GetPerfStats().GetTotalStageCalls();
+    json += "  \"stages\": {\n";
+    for (std::size_t stage = 0; stage < Core::NumPerfStages; ++stage) {
+        json += fmt::format("    \"{}\": {{\"ms_per_frame\": {:.3f}, \"calls\": {}}}{}\n",
+                            Core::GetPerfStageName(static_cast<Core::PerfStage>(stage)),
+                            results.stage_times[stage] * 1000.0, stage_calls[stage],
+                            stage + 1 < Core::NumPerfStages ? "," : "");
+    }
+    json += "  },\n";
+
+    const auto svc_totals = Kernel::SVCProfiler::GetTotals(Kernel::SVCProfiler::GetEntries());
+    json += "  \"svcs\": [\n";
+    for (std::size_t i = 0; i < svc_totals.size(); ++i) {
+        const auto& total = svc_totals[i];
+        json += fmt::format("    {{\"name\": \"{}\", \"calls\": {}, \"run_ms\": {:.3f}}}{}\n",
+                            total.svc_name, total.calls,
+                            std::chrono::duration<double, std::milli>(total.run_time).count(),
+                            i + 1 < svc_totals.size() ? "," : "");
+    }
+    json += "  ]\n}\n";
+    return json;
+}
+
 /// Application entry point
 int main(int argc, char** argv) {
     Config config;
@@ -98,17 +245,36 @@ int main(int argc, char** argv) {
     std::string filepath;
 
     bool fullscreen = false;
+    std::string svc_profile_path;
+    std::string guest_profile_path;
+    std::string memory_stats_path;
+    std::string frame_stats_path;
+    bool benchmark = false;
+    bool null_renderer = false;
+    BenchmarkLimit benchmark_limit;
+    std::string benchmark_report_path;
+    std::string gpu_trace_path;
+    bool replay_gpu_trace = false;
 
     static struct option long_options[] = {
         {"gdbport", required_argument, 0, 'g'},
         {"fullscreen", no_argument, 0, 'f'},
+        {"svc-profile", required_argument, 0, 'p'},
+        {"guest-profile", required_argument, 0, 'P'},
+        {"memory-stats", required_argument, 0, 'm'},
+        {"frame-stats", required_argument, 0, 's'},
+        {"benchmark", required_argument, 0, 'b'},
+        {"benchmark-report", required_argument, 0, 'r'},
+        {"null-renderer", no_argument, 0, 'n'},
+        {"gpu-trace", required_argument, 0, 't'},
+        {"replay-gpu-trace", no_argument, 0, 'T'},
         {"help", no_argument, 0, 'h'},
         {"version", no_argument, 0, 'v'},
         {0, 0, 0, 0},
     };
 
     while (optind < argc) {
-        char arg = getopt_long(argc, argv, "g:fhv", long_options, &option_index);
+        char arg = getopt_long(argc, argv, "g:fp:P:m:s:b:r:nt:Thv", long_options, &option_index);
         if (arg != -1) {
             switch (arg) {
             case 'g':
@@ -126,6 +292,37 @@ int main(int argc, char** argv) {
                 fullscreen = true;
                 LOG_INFO(Frontend, "Starting in fullscreen mode...");
                 break;
+            case 'p':
+                svc_profile_path = optarg;
+                break;
+            case 'P':
+                guest_profile_path = optarg;
+                break;
+            case 'm':
+                memory_stats_path = optarg;
+                break;
+            case 's':
+                frame_stats_path = optarg;
+                break;
+            case 'b':
+                if (!ParseBenchmarkLimit(optarg, benchmark_limit)) {
+                    std::cerr << "--benchmark: Invalid limit " << optarg << std::endl;
+                    exit(1);
+                }
+                benchmark = true;
+                break;
+            case 'r':
+                benchmark_report_path = optarg;
+                break;
+            case 'n':
+                null_renderer = true;
+                break;
+            case 't':
+                gpu_trace_path = optarg;
+                break;
+            case 'T':
+                replay_gpu_trace = true;
+                break;
             case 'h':
                 PrintHelp(argv[0]);
                 return 0;
@@ -147,6 +344,8 @@ int main(int argc, char** argv) {
     LocalFree(argv_w);
 #endif
 
+    Common::Tracing::Initialize();
+    Common::SetCurrentThreadName("yuzu:EmuThread");
     MicroProfileOnThreadCreate("EmuThread");
     SCOPE_EXIT({ MicroProfileShutdown(); });
 
@@ -158,12 +357,33 @@ int main(int argc, char** argv) {
     // Apply the command line arguments
     Settings::values.gdbstub_port = gdb_port;
     Settings::values.use_gdbstub = use_gdbstub;
+    if (!svc_profile_path.empty()) {
+        Settings::values.profile_svcs = true;
+    }
+    if (!guest_profile_path.empty()) {
+        Settings::values.profile_guest = true;
+    }
+    if (!memory_stats_path.empty()) {
+        Settings::values.record_memory_stats = true;
+    }
+    if (benchmark) {
+        // The report counts the SVCs, and the frame limiter would only measure itself
+        Settings::values.profile_svcs = true;
+        Settings::values.use_frame_limit = false;
+    }
+    if (null_renderer) {
+        Settings::values.renderer_backend = Settings::RendererBackend::Null;
+    }
     Settings::Apply();
 
-    std::unique_ptr<EmuWindow_SDL2> emu_window{std::make_unique<EmuWindow_SDL2>(fullscreen)};
+    const bool headless{Settings::values.renderer_backend == Settings::RendererBackend::Null};
+    std::unique_ptr<EmuWindow_SDL2> emu_window{
+        std::make_unique<EmuWindow_SDL2>(fullscreen, benchmark, headless)};
 
-    if (!Settings::values.use_multi_core) {
-        // Single core mode must acquire OpenGL context for entire emulation session
+    if (!Settings::values.use_multi_core || Settings::values.use_asynchronous_gpu_emulation ||
+        replay_gpu_trace) {
+        // Single core mode must acquire OpenGL context for entire emulation session. The GPU thread
+        // takes it over after the title is loaded. GPU traces are replayed from this thread.
         emu_window->MakeCurrent();
     }
 
@@ -172,7 +392,9 @@ int main(int argc, char** argv) {
 
     SCOPE_EXIT({ system.Shutdown(); });
 
-    const Core::System::ResultStatus load_result{system.Load(*emu_window, filepath)};
+    const Core::System::ResultStatus load_result{replay_gpu_trace
+                                                     ? system.LoadGPUTrace(*emu_window, filepath)
+                                                     : system.Load(*emu_window, filepath)};
 
     switch (load_result) {
     case Core::System::ResultStatus::ErrorGetLoader:
@@ -190,6 +412,9 @@ int main(int argc, char** argv) {
     case Core::System::ResultStatus::ErrorVideoCore:
         LOG_CRITICAL(Frontend, "Failed to initialize VideoCore!");
         return -1;
+    case Core::System::ResultStatus::ErrorGPUTrace:
+        LOG_CRITICAL(Frontend, "Failed to load GPU trace!");
+        return -1;
     case Core::System::ResultStatus::Success:
         break; // Expected case
     default:
@@ -207,8 +432,72 @@ int main(int argc, char** argv) {
 
     Core::Telemetry().AddField(Telemetry::FieldType::App, "Frontend", "SDL");
 
+    if (!gpu_trace_path.empty() && !system.GPU().StartTraceRecording(gpu_trace_path)) {
+        LOG_ERROR(Frontend, "Failed to start recording the GPU trace to {}", gpu_trace_path);
+    }
+
+    if (Settings::values.use_asynchronous_gpu_emulation) {
+        emu_window->DoneCurrent();
+    }
+
+    // Build the cached shaders before the title runs, reporting every tenth of them
+    std::size_t last_reported_tenth = 0;
+    system.GPU().LoadDiskResources(
+        [&](VideoCore::LoadCallbackStage stage, std::size_t value, std::size_t total) {
+            if (stage != VideoCore::LoadCallbackStage::Build) {
+                return;
+            }
+            const std::size_t tenth = value * 10 / total;
+            if (tenth != last_reported_tenth || value == total) {
+                last_reported_tenth = tenth;
+                LOG_INFO(Frontend, "Building shaders {} / {}", value, total);
+            }
+        });
+
+    using BenchmarkClock = std::chrono::steady_clock;
+    const auto benchmark_start = BenchmarkClock::now();
+    const auto is_benchmark_done = [&] {
+        if (benchmark_limit.frames != 0) {
+            return system.GetPerfStats().GetTotalSystemFrames() >= benchmark_limit.frames;
+        }
+        return BenchmarkClock::now() - benchmark_start >= benchmark_limit.duration;
+    };
+
     while (emu_window->IsOpen()) {
         system.RunLoop();
+        if (benchmark && is_benchmark_done()) {
+            break;
+        }
+    }
+
+    if (benchmark) {
+        const double seconds =
+            std::chrono::duration<double>(BenchmarkClock::now() - benchmark_start).count();
+        const u64 frames = system.GetPerfStats().GetTotalSystemFrames();
+        const std::string report =
+            FormatBenchmarkReport(system.GetAndResetPerfStats(), frames, seconds);
+        if (benchmark_report_path.empty()) {
+            std::cout << report;
+        } else {
+            FileUtil::IOFile file(benchmark_report_path, "w");
+            if (!file.IsOpen() || file.WriteBytes(report.data(), report.size()) != report.size()) {
+                LOG_ERROR(Frontend, "Failed to write the benchmark report to {}",
+                          benchmark_report_path);
+            }
+        }
+    }
+
+    if (!svc_profile_path.empty()) {
+        WriteSVCProfile(svc_profile_path);
+    }
+    if (!guest_profile_path.empty()) {
+        WriteGuestProfile(guest_profile_path);
+    }
+    if (!memory_stats_path.empty()) {
+        WriteMemoryStats(memory_stats_path);
+    }
+    if (!frame_stats_path.empty()) {
+        WriteFrameStats(frame_stats_path);
     }
 
     return 0;